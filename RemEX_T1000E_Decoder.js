@@ -3,20 +3,112 @@ function decodeUplink (input) {
     const fPort = parseInt(input.fPort)
     const payload = bytes2HexString(bytes)
 
+    if (fPort === 12) {
+        return { data: decodeCrewPacked(bytes, payload, fPort) }
+    }
+    if (fPort === 13) {
+        return { data: decodeCrewBacklog(bytes, payload, fPort) }
+    }
+    return { data: decodeCrewRecord(bytes, payload, fPort) }
+}
+
+function decodeCrewRecord (bytes, payload, fPort) {
     if (fPort === 5 || fPort === 7) {
-        return { data: decodeCrewPresenceCompact(bytes, payload, fPort) }
+        return decodeCrewPresenceCompact(bytes, payload, fPort)
     }
     if (fPort === 6) {
-        return { data: decodeCrewAlert(bytes, payload, fPort) }
+        return decodeCrewAlert(bytes, payload, fPort)
     }
     if (fPort === 8) {
-        return { data: decodeCrewHealthEvent(bytes, payload, fPort) }
+        return decodeCrewHealthEvent(bytes, payload, fPort)
     }
     if (fPort === 11) {
-        return { data: decodeCrewRfFingerprint(bytes, payload, fPort) }
+        return decodeCrewRfFingerprint(bytes, payload, fPort)
+    }
+
+    return invalid(payload, fPort, `Unsupported RemEX fPort ${fPort}`)
+}
+
+// FPort 12: records of the other FPorts, each behind a header byte holding (FPort - 4) << 5 | length
+function decodeCrewPacked (bytes, payload, fPort) {
+    const decoded = baseDecoded(payload, fPort)
+    decoded.records = []
+    let offset = 0
+
+    while (offset < bytes.length) {
+        const header = u8(bytes, offset)
+        const recordPort = ((header >> 5) & 0x07) + 4
+        const length = header & 0x1F
+        if (length === 0 || offset + 1 + length > bytes.length) {
+            return invalid(payload, fPort, `Truncated packed record ${decoded.records.length}`)
+        }
+
+        const recordBytes = bytes.slice(offset + 1, offset + 1 + length)
+        const record = decodeCrewRecord(recordBytes, bytes2HexString(recordBytes), recordPort)
+        if (record.valid === false) {
+            return invalid(payload, fPort, `Packed record ${decoded.records.length}: ${record.errMessage}`)
+        }
+
+        decoded.records.push({ fPort: recordPort, payload: record.payload })
+        decoded.messages = decoded.messages.concat(record.messages)
+        offset += 1 + length
+    }
+
+    if (decoded.records.length === 0) {
+        return invalid(payload, fPort, 'Empty packed payload')
+    }
+    return decoded
+}
+
+// FPort 13: stored records sent late. u32 timestamp of the first record, u8 records still stored,
+// then per record a packed record header, a zigzag LEB128 delta in seconds from the previous record and the data
+function decodeCrewBacklog (bytes, payload, fPort) {
+    const decoded = baseDecoded(payload, fPort)
+    if (bytes.length < 5) {
+        return invalid(payload, fPort, 'Truncated backlog header')
+    }
+
+    let timestamp = u32le(bytes, 0)
+    decoded.remaining = u8(bytes, 4)
+    decoded.records = []
+    let offset = 5
+
+    while (offset < bytes.length) {
+        const header = u8(bytes, offset)
+        const recordPort = ((header >> 5) & 0x07) + 4
+        const length = header & 0x1F
+        let zigzag = 0
+        let shift = 0
+        offset++
+        while (offset < bytes.length && shift < 35) {
+            const b = u8(bytes, offset++)
+            zigzag += (b & 0x7F) * Math.pow(2, shift)
+            shift += 7
+            if ((b & 0x80) === 0) {
+                break
+            }
+        }
+        if (length === 0 || offset + length > bytes.length) {
+            return invalid(payload, fPort, `Truncated backlog record ${decoded.records.length}`)
+        }
+        timestamp += (zigzag % 2 === 0) ? zigzag / 2 : -(zigzag + 1) / 2
+
+        const recordBytes = bytes.slice(offset, offset + length)
+        const record = decodeCrewRecord(recordBytes, bytes2HexString(recordBytes), recordPort)
+        if (record.valid === false) {
+            return invalid(payload, fPort, `Backlog record ${decoded.records.length}: ${record.errMessage}`)
+        }
+
+        decoded.records.push({ fPort: recordPort, timestamp: timestamp, payload: record.payload })
+        decoded.messages = decoded.messages.concat(record.messages.map(message =>
+            message.map(entry => Object.assign({}, entry, { timestamp: timestamp * 1000 }))))
+        offset += length
     }
 
-    return { data: invalid(payload, fPort, `Unsupported RemEX fPort ${fPort}`) }
+    if (decoded.records.length === 0) {
+        return invalid(payload, fPort, 'Empty backlog payload')
+    }
+    return decoded
 }
 
 function baseDecoded (payload, fPort) {
@@ -223,24 +315,30 @@ function decodeCrewAlert (bytes, payload, fPort) {
 }
 
 function decodeMobPosition (bytes, payload, fPort) {
-    if (bytes.length !== 13 && bytes.length !== 16) {
-        return invalid(payload, fPort, 'MOB position payload must be 13 or 16 bytes')
+    if (bytes.length !== 13 && bytes.length !== 16 && bytes.length !== 22) {
+        return invalid(payload, fPort, 'MOB position payload must be 13, 16 or 22 bytes')
     }
 
     const modeRaw = u8(bytes, 1)
     const qualityFlags = u8(bytes, 11)
-    const vectorPresent = bytes.length === 16
+    const vectorPresent = bytes.length >= 16
     const cogRaw = vectorPresent ? u16le(bytes, 13) : 0xFFFF
     const sogRaw = vectorPresent ? u8(bytes, 15) : 0xFF
     const vectorValid = vectorPresent && (qualityFlags & 0x08) !== 0 && cogRaw !== 0xFFFF && sogRaw !== 0xFF
+    const radiusRaw = bytes.length === 22 ? u16le(bytes, 20) : 0xFFFF
+    const predictionValid = bytes.length === 22 && (qualityFlags & 0x10) !== 0 && radiusRaw !== 0xFFFF
+    const latitude = i32le(bytes, 2) / 1000000
+    const longitude = i32le(bytes, 6) / 1000000
+    const predictedNorthM = predictionValid ? i16le(bytes, 16) : 0
+    const predictedEastM = predictionValid ? i16le(bytes, 18) : 0
 
     const alert = {
         msgType: 0x20,
         msgTypeName: 'MOB position',
         modeRaw,
         mode: modeRaw & 0x7F,
-        latitude: i32le(bytes, 2) / 1000000,
-        longitude: i32le(bytes, 6) / 1000000,
+        latitude,
+        longitude,
         hdop: u8(bytes, 10) / 10,
         qualityFlags,
         fixValid: (qualityFlags & 0x01) !== 0,
@@ -248,6 +346,12 @@ function decodeMobPosition (bytes, payload, fPort) {
         vectorValid,
         cog: vectorValid ? cogRaw / 2 : null,
         sog: vectorValid ? Math.min(sogRaw, 0xFE) / 10 : null,
+        predictionValid,
+        predictedLatitude: predictionValid ? roundCoord(latitude + predictedNorthM / 111195) : null,
+        predictedLongitude: predictionValid
+            ? roundCoord(longitude + predictedEastM / (111195 * Math.cos(latitude * Math.PI / 180)))
+            : null,
+        predictionRadiusM: predictionValid ? radiusRaw : null,
         onCharge: ((modeRaw & 0x80) !== 0) || ((qualityFlags & 0x04) !== 0),
         battery: s8(bytes, 12)
     }
@@ -272,11 +376,12 @@ function decodeMobCancelled (bytes, payload, fPort) {
 }
 
 function decodeMobNoFix (bytes, payload, fPort) {
-    if (bytes.length !== 5) {
-        return invalid(payload, fPort, 'MOB no-fix payload must be 5 bytes')
+    if (bytes.length !== 5 && bytes.length !== 15) {
+        return invalid(payload, fPort, 'MOB no-fix payload must be 5 or 15 bytes')
     }
 
     const modeRaw = u8(bytes, 1)
+    const predictionValid = bytes.length === 15
     return alertDecoded(payload, fPort, {
         msgType: 0x22,
         msgTypeName: 'MOB no fix',
@@ -285,7 +390,11 @@ function decodeMobNoFix (bytes, payload, fPort) {
         elapsedS: u16be(bytes, 2),
         battery: s8(bytes, 4),
         onCharge: (modeRaw & 0x80) !== 0,
-        gpsValid: false
+        gpsValid: false,
+        predictionValid,
+        predictedLatitude: predictionValid ? i32le(bytes, 5) / 1000000 : null,
+        predictedLongitude: predictionValid ? i32le(bytes, 9) / 1000000 : null,
+        predictionRadiusM: predictionValid ? u16le(bytes, 13) : null
     })
 }
 
@@ -591,6 +700,11 @@ function u16le (bytes, offset) {
     return u8(bytes, offset) | (u8(bytes, offset + 1) << 8)
 }
 
+function i16le (bytes, offset) {
+    const value = u16le(bytes, offset)
+    return value > 32767 ? value - 65536 : value
+}
+
 function u16be (bytes, offset) {
     return (u8(bytes, offset) << 8) | u8(bytes, offset + 1)
 }
@@ -610,6 +724,10 @@ function u32le (bytes, offset) {
         (u8(bytes, offset + 3) << 24)) >>> 0
 }
 
+function roundCoord (value) {
+    return Math.round(value * 1000000) / 1000000
+}
+
 if (typeof module !== 'undefined') {
     module.exports = { decodeUplink }
 }
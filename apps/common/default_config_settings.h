@@ -71,8 +71,13 @@
  *   A fix is rejected from the final fit only when its residual from the
  *   provisional fitted track is greater than sigma * OUTLIER_SIGMA + MARGIN.
  * - MAX_TRACK_SPEED_MPS: final sanity limit for PIW drift.
+ * - REBUILD_UPDATES: the fit is maintained incrementally from running sums;
+ *   every this many accepted fixes it is rebuilt exactly from the window,
+ *   re-anchoring the local frame and re-gating every fix against the track.
  */
+#ifndef REMEX_PIW_DRIFT_FIX_WINDOW
 #define REMEX_PIW_DRIFT_FIX_WINDOW             10
+#endif
 #define REMEX_PIW_DRIFT_MIN_FIXES              3
 #define REMEX_PIW_DRIFT_MIN_BASELINE_S         90
 #define REMEX_PIW_DRIFT_DUPLICATE_FIX_S        15
@@ -83,6 +88,85 @@
 #define REMEX_PIW_DRIFT_OUTLIER_SIGMA          3.0f
 #define REMEX_PIW_DRIFT_OUTLIER_MARGIN_M       15.0f
 #define REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS    5.0f
+#define REMEX_PIW_DRIFT_REBUILD_UPDATES        REMEX_PIW_DRIFT_FIX_WINDOW
+
+/*
+ * PIW position/velocity track knobs.
+ *
+ * Every MOB/PIW fix also feeds a constant-velocity Kalman filter, run
+ * independently on the east and north axes of a local frame. Its prediction
+ * is dead-reckoned to the uplink time and sent with every position and no-fix
+ * report, so searchers get a position and uncertainty radius even on cycles
+ * where GNSS times out.
+ *
+ * - ACCEL_PSD: white-acceleration spectral density in m^2/s^3. It sets how
+ *   fast the filter lets the drift velocity change (wind shifts, current).
+ * - INIT_SPEED_SIGMA_MPS: 1-sigma velocity uncertainty of a new track.
+ * - GATE_CHI2: 2-DOF innovation gate (99.9% at 13.8). A fix further than this
+ *   from the prediction is skipped.
+ * - RESET_REJECTS: consecutive gated fixes after which the track restarts on
+ *   the latest fix, so a wrong track cannot lock out good fixes.
+ * - MAX_PREDICT_S: no prediction is reported once the last accepted fix is
+ *   older than this.
+ */
+#define REMEX_PIW_TRACK_ACCEL_PSD              0.0005f
+#define REMEX_PIW_TRACK_INIT_SPEED_SIGMA_MPS   1.0f
+#define REMEX_PIW_TRACK_GATE_CHI2              13.8f
+#define REMEX_PIW_TRACK_RESET_REJECTS          3
+#define REMEX_PIW_TRACK_MAX_PREDICT_S          3600
+
+/*
+ * Adaptive GNSS scan budget learned from this device's own time-to-fix
+ * history (gnss_ttff_stats.c). Samples are binned per start type, gateway
+ * assistance quality and almanac SV count.
+ *
+ * - PERCENTILE: share of past acquisitions in the same context the budget
+ *   should cover.
+ * - MARGIN_MS: added to the upper edge of the percentile bin.
+ * - MIN_SAMPLES: fixes a context needs before its learned budget replaces
+ *   the fixed default.
+ * - FAIL_PCT: share of scans ending without a fix at or above which the
+ *   learned budget is capped at the fixed default.
+ * - SAVE_SAMPLES / SAVE_INTERVAL_S: the histogram record is rewritten after
+ *   this many new samples, at most once per interval, to bound flash wear.
+ */
+#define REMEX_GNSS_TTFF_PERCENTILE             90
+#define REMEX_GNSS_TTFF_MARGIN_MS              3000
+#define REMEX_GNSS_TTFF_MIN_SAMPLES            8
+#define REMEX_GNSS_TTFF_FAIL_PCT               50
+#define REMEX_GNSS_TTFF_SAVE_SAMPLES           16
+#define REMEX_GNSS_TTFF_SAVE_INTERVAL_S        3600
+
+/*
+ * PIW blocked-sky abort (gnss_set_sky_abort in ag3335.c). Under water or in a
+ * pocket the receiver hears only a few weak satellites and a fix will not
+ * come however long the scan runs. After CHECK_MS of a PIW scan, the scan ends
+ * when no satellite reaches 30 dB-Hz and the mean C/N0 of the 4 strongest is
+ * below MIN_TOP4_CN0. CHECK_MS 0 disables it.
+ */
+#define REMEX_PIW_SKY_CHECK_MS                 8000
+#define REMEX_PIW_SKY_MIN_TOP4_CN0             20
+
+/*
+ * GNSS fix prediction (gnss_fix_predict.c), for PIW scans and tracker proof
+ * scans. After OBSERVE_MS of GSV, the top-4 C/N0 and strong-satellite trends
+ * are projected over the rest of the budget; the scan stops when the chance
+ * of a quality fix drops below MIN_PROB_PCT. MIN_PROB_PCT 0 disables it.
+ * Off until the model weights have been fitted on recorded captures with
+ * t1000_e/tracker/tools/gnss_predict_replay.c: the hand-set ones would end
+ * cold starts that are still acquiring.
+ */
+#define REMEX_GNSS_PREDICT_MIN_PROB_PCT        0
+#define REMEX_GNSS_PREDICT_OBSERVE_MS          6000
+
+/*
+ * Deferred log formatting (log_filter.c). When set, LOG_* lines go out on the
+ * USB CDC port as binary records holding the format string address and the
+ * raw arguments; decode_tracker_log.py expands them back to text using the
+ * firmware .elf of the same build. The 'D' serial key toggles it at run time.
+ * Lines whose format string is not in flash are still formatted on the device.
+ */
+#define REMEX_LOG_DEFERRED                     0
 
 /*
  * Wi-Fi BSSID prefixes that should be treated as fixed vessel/gateway APs even
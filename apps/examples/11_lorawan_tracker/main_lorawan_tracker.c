@@ -36,7 +36,10 @@
 #include "wifi_scan.h"
 #include "gateway_assistance.h"
 #include "marine_gnss.h"
+#include "gnss_fix_predict.h"
 #include "crew_payload_schema.h"
+#include "crew_uplink_packer.h"
+#include "crew_store_forward.h"
 #include "ag3335.h"
 #include "firmware_version.h"
 #include "log_filter.h"
@@ -60,6 +63,7 @@
 #define CREW_SOS_CONTEXT_SCHEMA     0x10
 #define STARTUP_SERIAL_DELAY_MS     5000
 #define CREW_FCNT_DOWN_SYNC_RETRY_S 60
+#define GNSS_PROOF_CHECK_STEP_S     2
 
 /* Fleet de-synchronisation windows. All are deterministic per DevEUI, so a tag keeps
  * the same phase across reboots while the fleet is spread across the available window.
@@ -70,6 +74,12 @@
 #define CREW_LINKCHECK_RETRY_FIRST_JITTER_S     30
 #define CREW_LINKCHECK_RETRY_UPLINK_INTERVAL    10
 
+/* Consecutive LinkCheck answers missing before uplinks are also kept in the store-and-forward ring. */
+#define CREW_STORE_LINK_LOST_MISSES             2
+
+/* Frames of an SOS/MOB DR burst: normal, persistence and sos_low DR. */
+#define CREW_DR_BURST_FRAMES                    3
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -161,6 +171,7 @@ static bool device_time_req_pending = false;
 static bool sos_gnss_prestarted = false;
 static bool app_gnss_initialized = false;
 static bool gnss_proof_scan_active = false;
+static uint32_t gnss_proof_scan_start_ms = 0;
 static bool gnss_proof_pending = false;
 static bool gnss_proof_quality_ok = false;
 static gnss_fix_t gnss_proof_fix = { 0 };
@@ -185,9 +196,12 @@ uint8_t adr_custom_list_region[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 static crew_dr_config_t crew_dr = { 0 };
 static bool crew_dr_ready = false;
 static uint8_t crew_linkcheck_good_streak = 0;
+static uint8_t crew_linkcheck_miss_streak = 0;
 static uint16_t crew_uplinks_since_linkcheck = 0;
 static uint32_t crew_vessel_uplink_count = 0;
 static bool crew_linkcheck_pending = false;
+static bool app_send_stored = false;  // Last refused frame was kept in the store-and-forward ring
+static bool app_send_repeat = false;  // Next frame repeats the previous one, see app_send_mark_repeat
 static crew_ble_hint_state_t crew_ble_hint = { 0 };
 static bool crew_linkcheck_retry_active = false;
 static uint8_t crew_linkcheck_retry_probe_dr = 0;
@@ -302,6 +316,7 @@ static bool app_send_frame_on_port_ext( uint8_t port, const uint8_t* buffer, con
                                         bool emergency, uint8_t extended_id );
 static bool crew_send_dr_burst_on_port( uint8_t port, const uint8_t* buffer, const uint8_t length, bool tx_confirmed,
                                         bool emergency );
+static uint8_t crew_plan_dr_burst( const uint8_t* burst_dr, bool* keep, uint8_t count, uint8_t length );
 static void crew_dr_configure_for_region( smtc_modem_region_t region );
 static bool crew_dr_apply_fixed( uint8_t dr );
 static bool crew_dr_prepare_next_uplink( uint8_t dr );
@@ -327,10 +342,16 @@ static bool app_tracker_payload_is_sos_context( const uint8_t* buffer, uint8_t l
 static bool app_tracker_send_compact_presence( uint8_t outgoing_event_state, int8_t battery, bool confirm );
 static bool app_tracker_send_gnss_proof( uint8_t outgoing_event_state, int8_t battery, bool confirm );
 static bool app_tracker_send_sos_context( uint8_t outgoing_event_state, int8_t battery, bool confirm );
-static bool app_tracker_send_fcnt_down_sync( uint8_t outgoing_event_state, int8_t battery );
-static void app_tracker_maybe_send_fcnt_down_sync( uint8_t outgoing_event_state, int8_t battery );
+static bool app_tracker_queue_fcnt_down_sync( int8_t battery );
+static void app_tracker_maybe_queue_fcnt_down_sync( int8_t battery );
+static bool app_tracker_flush_records( uint8_t extended_id, bool persistence_dr );
+static bool app_tracker_send_backlog( uint8_t extended_id );
+static bool app_store_frame( uint8_t port, const uint8_t* buffer, uint8_t length );
+static bool app_link_lost( void );
+static void app_routine_uplink_prepare( void );
 static void app_tracker_sos_gnss_prestart( void );
 static uint32_t app_tracker_gnss_next_delay( void );
+static bool app_tracker_gnss_proof_continues( void );
 static void app_tracker_u16_le( uint8_t* buffer, uint16_t value );
 static void app_tracker_u32_le( uint8_t* buffer, uint32_t value );
 static void app_tracker_i32_le( uint8_t* buffer, int32_t value );
@@ -373,6 +394,7 @@ int main( void )
     /* Init board and peripherals */
     hal_mcu_init( );
     fds_init_write( );
+    crew_store_init( );
     smtc_board_init_periph( );
     remex_prepare_abp_config_for_ble_app( );
     app_lora_packet_params_load( );
@@ -425,6 +447,11 @@ int main( void )
         qma6100p_init( );
     }
 
+    hal_mcu_wait_stats_t wait_stats;
+    hal_mcu_get_wait_stats( &wait_stats );
+    HAL_DBG_TRACE_INFO( "Boot delays: %lu ms asleep in %lu waits, %lu ms spinning in %lu waits\n",
+                        wait_stats.sleep_ms, wait_stats.sleep_waits, wait_stats.busy_ms, wait_stats.busy_waits );
+
 APP_MAIN:
     /* Init the Lora Basics Modem event callbacks */
     apps_modem_event_init( &smtc_event_callback );
@@ -1208,6 +1235,10 @@ static void crew_dr_handle_link_status( smtc_modem_event_link_check_status_t sta
     if(( status != SMTC_MODEM_EVENT_LINK_CHECK_RECEIVED ) || ( gw_cnt == 0 ))
     {
         crew_linkcheck_good_streak = 0;
+        if( crew_linkcheck_miss_streak < UINT8_MAX )
+        {
+            crew_linkcheck_miss_streak++;
+        }
         LOG_LORA( "Crew LinkCheck inconclusive: status=%u margin=%u gw=%u, keep DR%u\n",
                   status, margin, gw_cnt, crew_dr.vessel_current );
         crew_linkcheck_retry_schedule_missing_ans( );
@@ -1215,6 +1246,7 @@ static void crew_dr_handle_link_status( smtc_modem_event_link_check_status_t sta
     }
 
     crew_linkcheck_retry_reset( );
+    crew_linkcheck_miss_streak = 0;
 
     if( margin <= CREW_DR_LINKCHECK_LOW_MARGIN_DB )
     {
@@ -1845,6 +1877,8 @@ static bool app_tracker_gnss_scan_begin( void )
     {
         LOG_GNSS( "GNSS proof begin - local RF failed, checking vessel geofence position\n\n" );
         gnss_proof_scan_active = gnss_scan_start( );
+        gnss_proof_scan_start_ms = hal_rtc_get_time_ms( );
+        gnss_fix_predict_start( );
         gnss_proof_pending = false;
         gnss_proof_quality_ok = false;
         memset( &gnss_proof_fix, 0, sizeof( gnss_proof_fix ));
@@ -1943,9 +1977,44 @@ static uint32_t app_tracker_gnss_next_delay( void )
         return mob_tracker_process( );
     }
 
+    // Proof scans wake up in steps so the fix predictor can end them early
+    if( gnss_proof_scan_active )
+    {
+        uint32_t elapsed_s = ( hal_rtc_get_time_ms( ) - gnss_proof_scan_start_ms ) / 1000;
+        uint32_t remaining_s = ( gnss_scan_duration > elapsed_s ) ? gnss_scan_duration - elapsed_s : 1;
+
+        return remaining_s < GNSS_PROOF_CHECK_STEP_S ? remaining_s : GNSS_PROOF_CHECK_STEP_S;
+    }
+
     return gnss_scan_duration > 0 ? gnss_scan_duration : 1;
 }
 
+static bool app_tracker_gnss_proof_continues( void )
+{
+    gnss_sky_metrics_t sky;
+    uint32_t elapsed_ms = 0;
+    uint32_t budget_ms = gnss_scan_duration * 1000;
+
+    if( !gnss_proof_scan_active )
+    {
+        return false;
+    }
+
+    elapsed_ms = hal_rtc_get_time_ms( ) - gnss_proof_scan_start_ms;
+    if( elapsed_ms >= budget_ms )
+    {
+        return false;
+    }
+
+    gnss_sky_get_metrics( &sky );
+    if( gnss_fix_predict_update( elapsed_ms, budget_ms, &sky, NULL ))
+    {
+        LOG_GNSS( "GNSS proof ended early at %lu ms, a quality fix is unlikely\n", elapsed_ms );
+        return false;
+    }
+    return true;
+}
+
 static void app_tracker_scan_result_send( void )
 {
     bool send_ok = false;
@@ -1968,6 +2037,12 @@ static void app_tracker_scan_result_send( void )
     PRINTF( "tracker_ble_scan_len: %d\r\n", tracker_ble_scan_len );
     PRINTF( "scan_result_num: %d\r\n", scan_result_num );
 
+    /* Queued first, so a pending sync rides in the same frame as the presence record. */
+    if( app_tracker_is_sos_event( ) == false )
+    {
+        app_tracker_maybe_queue_fcnt_down_sync( battery );
+    }
+
     if( app_tracker_is_sos_event( ))
     {
         scan_result_num = 1;
@@ -2006,9 +2081,17 @@ static void app_tracker_scan_result_send( void )
 
     crew_dr_after_vessel_uplink( send_ok );
 
-    if( send_ok && ( app_tracker_is_sos_event( ) == false ) )
+    /* Records the frame above had no room for go out on their own once due. */
+    if( send_ok && ( app_tracker_is_sos_event( ) == false ) && crew_uplink_packer_due( hal_rtc_get_time_ms( )))
     {
-        app_tracker_maybe_send_fcnt_down_sync( outgoing_event_state, battery );
+        app_tracker_flush_records( 1, false );
+    }
+
+    /* Back in coverage: one backlog frame per routine uplink, so the ring drains without a burst. */
+    if( send_ok && ( app_tracker_is_sos_event( ) == false ) && ( app_link_lost( ) == false ) &&
+        ( crew_store_pending( ) > 0 ))
+    {
+        app_tracker_send_backlog( 2 );
     }
 
     if( send_ok ) scan_result_num -= 1;
@@ -2094,14 +2177,17 @@ static bool app_tracker_send_compact_presence( uint8_t outgoing_event_state, int
     LOG_LORA( "Compact presence uplink: phase=%u source=%u len=%u loc_age=%u\n",
               phase, source_type, len, payload[3] );
 
-    return app_send_frame( payload, len, confirm, false );
+    crew_uplink_packer_push( CREW_UPLINK_RECORD_PRESENCE,
+                             gateway_assistance_is_charging( ) ? CREW_CHARGER_APP_PORT : LORAWAN_APP_PORT,
+                             payload, len, CREW_UPLINK_PRIORITY_ROUTINE, hal_rtc_get_time_ms( ), confirm );
+    return app_tracker_flush_records( 0, false );
 }
 
-static bool app_tracker_send_fcnt_down_sync( uint8_t outgoing_event_state, int8_t battery )
+static bool app_tracker_queue_fcnt_down_sync( int8_t battery )
 {
-    static uint8_t payload[sizeof( crew_fcnt_down_sync_t )];
-    uint8_t        len       = 0;
-    uint32_t       fcnt_down = lorawan_api_fcnt_down_get( );
+    uint8_t  payload[sizeof( crew_fcnt_down_sync_t )];
+    uint8_t  len       = 0;
+    uint32_t fcnt_down = lorawan_api_fcnt_down_get( );
 
     if( fcnt_down == 0xFFFFFFFF )
     {
@@ -2115,19 +2201,14 @@ static bool app_tracker_send_fcnt_down_sync( uint8_t outgoing_event_state, int8_
     app_tracker_u32_le( payload + len, fcnt_down );
     len += 4;
 
-    if( crew_dr_ready )
-    {
-        crew_dr_prepare_next_uplink( crew_dr.vessel_current );
-    }
-
-    LOG_LORA( "Request FPort %u fCntDown sync: flags=0x%02x fCntDown=%lu\n",
+    LOG_LORA( "Queue FPort %u fCntDown sync: flags=0x%02x fCntDown=%lu\n",
               CREW_HEALTH_EVENT_APP_PORT, payload[1], fcnt_down );
 
-    UNUSED( outgoing_event_state );
-    return app_send_frame_on_port_ext( CREW_HEALTH_EVENT_APP_PORT, payload, len, false, false, 1 );
+    return crew_uplink_packer_push( CREW_UPLINK_RECORD_FCNT_DOWN_SYNC, CREW_HEALTH_EVENT_APP_PORT, payload, len,
+                                    CREW_UPLINK_PRIORITY_LOW, hal_rtc_get_time_ms( ), false );
 }
 
-static void app_tracker_maybe_send_fcnt_down_sync( uint8_t outgoing_event_state, int8_t battery )
+static void app_tracker_maybe_queue_fcnt_down_sync( int8_t battery )
 {
     static uint32_t last_sync_uplink_s = 0;
     uint32_t        now_s              = hal_rtc_get_time_s( );
@@ -2143,12 +2224,123 @@ static void app_tracker_maybe_send_fcnt_down_sync( uint8_t outgoing_event_state,
         return;
     }
 
-    if( app_tracker_send_fcnt_down_sync( outgoing_event_state, battery ) )
+    if( app_tracker_queue_fcnt_down_sync( battery ) )
     {
         last_sync_uplink_s = now_s;
     }
 }
 
+static bool app_tracker_flush_records( uint8_t extended_id, bool persistence_dr )
+{
+    uint8_t frame[CREW_UPLINK_PACKER_FRAME_MAX];
+    uint8_t tx_max_payload = 0;
+    uint8_t port = 0;
+    uint8_t len = 0;
+    bool confirmed = false;
+
+    /* The DR is set first, the frame is then packed to what that DR can carry. */
+    app_routine_uplink_prepare( );
+    if( persistence_dr && crew_dr_ready )
+    {
+        crew_dr_prepare_next_uplink( crew_dr_for_mob_policy( APP_MOB_DR_PERSISTENCE ) );
+    }
+
+    ASSERT_SMTC_MODEM_RC( smtc_modem_get_next_tx_max_payload( stack_id, &tx_max_payload ) );
+    len = crew_uplink_packer_build( tx_max_payload, frame, &port, &confirmed );
+    if( len == 0 )
+    {
+        LOG_LORA( "WARN: No pending record fits in %u bytes\n", tx_max_payload );
+        return false;
+    }
+
+    if( port == CREW_CHARGER_APP_PORT )
+    {
+        LOG_LORA( "Routine uplink on charger: route FPort %u\n", CREW_CHARGER_APP_PORT );
+    }
+
+    app_send_stored = false;
+    if( app_send_frame_on_port_ext( port, frame, len, confirmed, false, extended_id ) == false )
+    {
+        /* Kept in flash with their timestamp, a newer presence must not wait behind them. */
+        if( app_send_stored )
+        {
+            crew_uplink_packer_commit( );
+        }
+        return false;
+    }
+    crew_uplink_packer_commit( );
+    return true;
+}
+
+static bool app_tracker_send_backlog( uint8_t extended_id )
+{
+    uint8_t frame[CREW_UPLINK_PACKER_FRAME_MAX];
+    uint8_t tx_max_payload = 0;
+    uint8_t len = 0;
+
+    app_routine_uplink_prepare( );
+
+    ASSERT_SMTC_MODEM_RC( smtc_modem_get_next_tx_max_payload( stack_id, &tx_max_payload ) );
+    if( tx_max_payload > sizeof( frame ))
+    {
+        tx_max_payload = sizeof( frame );
+    }
+    len = crew_store_build_batch( tx_max_payload, frame );
+    if( len == 0 )
+    {
+        return false;
+    }
+
+    LOG_LORA( "Backlog uplink: %u bytes, %u records stored\n", len, crew_store_pending( ));
+    if( app_send_frame_on_port_ext( CREW_BACKLOG_APP_PORT, frame, len, false, false, extended_id ) == false )
+    {
+        return false;
+    }
+    crew_store_commit_batch( );
+    return true;
+}
+
+static bool app_link_lost( void )
+{
+    return crew_linkcheck_miss_streak >= CREW_STORE_LINK_LOST_MISSES;
+}
+
+static bool app_store_frame( uint8_t port, const uint8_t* buffer, uint8_t length )
+{
+    uint32_t timestamp_s = gateway_assistance_get_estimated_time( );
+    bool stored = false;
+
+    if( port == CREW_PACKED_APP_PORT )
+    {
+        // Packed frames are split back into their records, each stored under its own FPort
+        uint8_t pos = 0;
+
+        while( pos < length )
+        {
+            uint8_t rec_port = CREW_PACKED_RECORD_PORT_GET( buffer[pos] );
+            uint8_t rec_len = CREW_PACKED_RECORD_LEN_GET( buffer[pos] );
+
+            if( pos + 1 + rec_len > length )
+            {
+                break;
+            }
+            stored |= crew_store_append( rec_port, buffer + pos + 1, rec_len, timestamp_s,
+                                         rec_port == CREW_ALERT_APP_PORT );
+            pos += 1 + rec_len;
+        }
+    }
+    else if(( port >= CREW_ROUTINE_APP_PORT ) && ( port <= CREW_RF_FINGERPRINT_PORT ))
+    {
+        stored = crew_store_append( port, buffer, length, timestamp_s, port == CREW_ALERT_APP_PORT );
+    }
+
+    if( stored )
+    {
+        LOG_LORA( "FPort %u frame stored for later, %u records pending\n", port, crew_store_pending( ));
+    }
+    return stored;
+}
+
 static bool app_tracker_send_gnss_proof( uint8_t outgoing_event_state, int8_t battery, bool confirm )
 {
     uint8_t payload[sizeof( crew_gnss_proof_t )] = { 0 };
@@ -2186,7 +2378,10 @@ static bool app_tracker_send_gnss_proof( uint8_t outgoing_event_state, int8_t ba
               quality_flags,
               len );
 
-    return app_send_mob_frame( payload, len, confirm, APP_MOB_DR_PERSISTENCE );
+    /* Due now; a pending fCntDown sync rides along, at the persistence DR the proof needs. */
+    crew_uplink_packer_push( CREW_UPLINK_RECORD_GNSS_PROOF, CREW_ALERT_APP_PORT, payload, len,
+                             CREW_UPLINK_PRIORITY_HIGH, hal_rtc_get_time_ms( ), confirm );
+    return app_tracker_flush_records( 0, true );
 }
 
 static uint8_t app_tracker_live_event_state_get( void )
@@ -2444,7 +2639,7 @@ static void app_tracker_scan_process( void )
         else if( tracker_scan_status == 1 )
         {
             // Process marine_gnss state machine
-            if( mob_tracker_is_active( ))
+            if( mob_tracker_is_active( ) || app_tracker_gnss_proof_continues( ))
             {
                 uint32_t marine_delay = app_tracker_gnss_next_delay( );
                 smtc_modem_alarm_start_timer( marine_delay );
@@ -2533,7 +2728,7 @@ static void app_tracker_scan_process( void )
         else if( tracker_scan_status == 2 )
         {
             // Process marine_gnss state machine
-            if( mob_tracker_is_active( ))
+            if( mob_tracker_is_active( ) || app_tracker_gnss_proof_continues( ))
             {
                 uint32_t marine_delay = app_tracker_gnss_next_delay( );
                 smtc_modem_alarm_start_timer( marine_delay );
@@ -2569,7 +2764,7 @@ static void app_tracker_scan_process( void )
         }
         else if( tracker_scan_status == 1 )
         {
-            if( mob_tracker_is_active( ))
+            if( mob_tracker_is_active( ) || app_tracker_gnss_proof_continues( ))
             {
                 uint32_t marine_delay = app_tracker_gnss_next_delay( );
                 smtc_modem_alarm_start_timer( marine_delay );
@@ -2720,7 +2915,7 @@ static void app_tracker_scan_process( void )
         }
         else if( tracker_scan_status == 2 )
         {
-            if( mob_tracker_is_active( ))
+            if( mob_tracker_is_active( ) || app_tracker_gnss_proof_continues( ))
             {
                 uint32_t marine_delay = app_tracker_gnss_next_delay( );
                 smtc_modem_alarm_start_timer( marine_delay );
@@ -2805,7 +3000,7 @@ static void app_tracker_scan_process( void )
         }
         else if( tracker_scan_status == 3 )
         {
-            if( mob_tracker_is_active( ))
+            if( mob_tracker_is_active( ) || app_tracker_gnss_proof_continues( ))
             {
                 uint32_t marine_delay = app_tracker_gnss_next_delay( );
                 smtc_modem_alarm_start_timer( marine_delay );
@@ -2833,12 +3028,16 @@ static bool app_send_frame_on_port( uint8_t port, const uint8_t* buffer, const u
 {
     uint8_t tx_max_payload;
     int32_t duty_cycle;
+    bool repeat = app_send_repeat;
+
+    app_send_repeat = false;
 
     /* Check if duty cycle is available */
     ASSERT_SMTC_MODEM_RC( smtc_modem_get_duty_cycle_status( &duty_cycle ) );
     if( duty_cycle < 0 )
     {
         LOG_LORA( "WARN: Duty-cycle limitation - next possible uplink in %d ms \n\n", duty_cycle );
+        app_send_stored = !repeat && app_store_frame( port, buffer, length );
         return false;
     }
 
@@ -2860,6 +3059,12 @@ static bool app_send_frame_on_port( uint8_t port, const uint8_t* buffer, const u
         {
             ASSERT_SMTC_MODEM_RC( smtc_modem_request_uplink( stack_id, port, tx_confirmed, buffer, length ));
         }
+
+        /* Without a gateway in reach the copy in flash is what gets through, once back in coverage. */
+        if( app_link_lost( ) && !repeat )
+        {
+            app_store_frame( port, buffer, length );
+        }
         return true;
     }
 }
@@ -2918,6 +3123,19 @@ bool app_send_frame( const uint8_t* buffer, const uint8_t length, bool tx_confir
         return app_send_frame_on_port( CREW_ALERT_APP_PORT, buffer, length, tx_confirmed, true );
     }
 
+    app_routine_uplink_prepare( );
+
+    if( on_charge )
+    {
+        LOG_LORA( "Routine uplink on charger: route FPort %u\n", CREW_CHARGER_APP_PORT );
+        return app_send_frame_on_port( CREW_CHARGER_APP_PORT, buffer, length, tx_confirmed, emergency );
+    }
+
+    return app_send_frame_on_port( LORAWAN_APP_PORT, buffer, length, tx_confirmed, emergency );
+}
+
+static void app_routine_uplink_prepare( void )
+{
     /*
      * Normal vessel uplinks must re-tag the queued modem task with the current crew DR.
      * Background MAC tasks such as DeviceTimeReq/LinkCheckReq can otherwise advance or alter the
@@ -2946,14 +3164,6 @@ bool app_send_frame( const uint8_t* buffer, const uint8_t length, bool tx_confir
         gnss_proof_scan_active = false;
         sos_gnss_prestarted = false;
     }
-
-    if( on_charge )
-    {
-        LOG_LORA( "Routine uplink on charger: route FPort %u\n", CREW_CHARGER_APP_PORT );
-        return app_send_frame_on_port( CREW_CHARGER_APP_PORT, buffer, length, tx_confirmed, emergency );
-    }
-
-    return app_send_frame_on_port( LORAWAN_APP_PORT, buffer, length, tx_confirmed, emergency );
 }
 
 bool app_send_mob_frame( const uint8_t* buffer, const uint8_t length, bool tx_confirmed, app_mob_dr_policy_t policy )
@@ -2966,6 +3176,11 @@ bool app_send_mob_frame( const uint8_t* buffer, const uint8_t length, bool tx_co
     return app_send_frame_on_port( CREW_ALERT_APP_PORT, buffer, length, tx_confirmed, false );
 }
 
+void app_send_mark_repeat( void )
+{
+    app_send_repeat = true;
+}
+
 bool app_send_mob_initial_burst( const uint8_t* buffer, const uint8_t length, bool tx_confirmed )
 {
     if( crew_dr_ready == false )
@@ -2979,7 +3194,9 @@ bool app_send_mob_initial_burst( const uint8_t* buffer, const uint8_t length, bo
 static bool crew_send_dr_burst_on_port( uint8_t port, const uint8_t* buffer, const uint8_t length, bool tx_confirmed,
                                         bool emergency )
 {
-    uint8_t burst_dr[3];
+    uint8_t burst_dr[CREW_DR_BURST_FRAMES];
+    bool burst_keep[CREW_DR_BURST_FRAMES];
+    uint8_t sent = 0;
     bool send_ok = true;
 
     if( crew_dr_ready == false )
@@ -2992,23 +3209,137 @@ static bool crew_send_dr_burst_on_port( uint8_t port, const uint8_t* buffer, con
     burst_dr[1] = crew_dr.persistence;
     burst_dr[2] = crew_dr.sos_low;
 
-    for( uint8_t i = 0; i < 3; i++ )
+    if( crew_plan_dr_burst( burst_dr, burst_keep, CREW_DR_BURST_FRAMES, length ) == 0 )
     {
-        crew_dr_prepare_next_uplink( burst_dr[i] );
-        send_ok &= app_send_frame_on_port_ext( port, buffer, length, tx_confirmed, emergency, i );
+        app_store_frame( port, buffer, length );
+        return false;
+    }
 
-        if( i < 2 )
+    for( uint8_t i = 0; i < CREW_DR_BURST_FRAMES; i++ )
+    {
+        if( burst_keep[i] == false )
+        {
+            continue;
+        }
+
+        if( sent > 0 )
         {
             /* Jitter reduces self-collision with queued radio work and avoids fixed burst timing. */
             uint32_t jitter_ms = smtc_modem_hal_get_random_nb_in_range( 1000, 2000 );
             hal_mcu_wait_ms( jitter_ms );
         }
+
+        /* Extended ids follow the frames actually sent, so the first one keeps emergency priority. */
+        crew_dr_prepare_next_uplink( burst_dr[i] );
+        send_ok &= app_send_frame_on_port_ext( port, buffer, length, tx_confirmed, emergency, sent );
+        sent++;
     }
 
     crew_dr_apply_fixed( crew_dr.normal );
     return send_ok;
 }
 
+static uint8_t crew_plan_dr_burst( const uint8_t* burst_dr, bool* keep, uint8_t count, uint8_t length )
+{
+    smtc_modem_airtime_plan_t plan[CREW_DR_BURST_FRAMES];
+    bool valid[CREW_DR_BURST_FRAMES];
+    int32_t used_ms = 0;
+    uint8_t robust = count;
+    uint8_t kept = 0;
+
+    for( uint8_t i = 0; i < count; i++ )
+    {
+        keep[i] = false;
+        valid[i] = smtc_modem_get_airtime_plan( stack_id, burst_dr[i], length, 1, &plan[i] ) == SMTC_MODEM_RC_OK;
+        if( !valid[i] )
+        {
+            LOG_LORA( "WARN: DR%u burst frame of %u bytes is not valid in this region, skipped\n", burst_dr[i], length );
+            continue;
+        }
+        if(( robust == count ) || ( burst_dr[i] < burst_dr[robust] ))
+        {
+            robust = i;
+        }
+    }
+
+    if( robust == count )
+    {
+        return 0;
+    }
+
+    /*
+     * The most robust frame (sos_low) is always sent, the modem takes it as long as the band has any airtime left.
+     * The other frames are kept in burst order only while, once they are sent, the band still has airtime left
+     * for every later kept frame, the same "available > 0" test the modem applies, so none is refused.
+     */
+    keep[robust] = true;
+    kept = 1;
+    for( uint8_t i = 0; i < count; i++ )
+    {
+        if( i == robust )
+        {
+            used_ms += plan[i].toa_ms;
+            continue;
+        }
+        if( !valid[i] )
+        {
+            continue;
+        }
+
+        if( plan[i].band_budget_ms != INT32_MAX )
+        {
+            // Frames before the robust one must leave airtime for it, frames after it only need some left
+            int32_t needed_ms = ( i < robust ) ? used_ms + ( int32_t ) plan[i].toa_ms : used_ms;
+
+            if( plan[i].band_budget_ms - needed_ms <= 0 )
+            {
+                LOG_LORA( "WARN: DR%u burst frame needs %lu ms, %ld ms of duty cycle left, skipped\n", burst_dr[i],
+                          plan[i].toa_ms, plan[i].band_budget_ms - used_ms );
+                continue;
+            }
+        }
+
+        used_ms += plan[i].toa_ms;
+        keep[i] = true;
+        kept++;
+    }
+
+    LOG_LORA( "DR burst: %u of %u frames, %ld ms ToA, DR%u always sent\n", kept, count, used_ms, burst_dr[robust] );
+    return kept;
+}
+
+uint8_t app_mob_frames_fit( const uint8_t length, uint8_t count, app_mob_dr_policy_t policy )
+{
+    for( ; count > 0; count-- )
+    {
+        if( app_mob_airtime_wait_ms( length, count, policy ) == 0 )
+        {
+            break;
+        }
+    }
+    return count;
+}
+
+int32_t app_mob_airtime_wait_ms( const uint8_t length, uint8_t count, app_mob_dr_policy_t policy )
+{
+    smtc_modem_airtime_plan_t plan;
+    uint8_t dr;
+
+    if( crew_dr_ready == false )
+    {
+        return 0;
+    }
+
+    /* Planning must not advance the phase 3 alternation, its usual frame is at persistence DR. */
+    dr = ( policy == APP_MOB_DR_PHASE3_ALTERNATING ) ? crew_dr.persistence : crew_dr_for_mob_policy( policy );
+
+    if( smtc_modem_get_airtime_plan( stack_id, dr, length, count, &plan ) != SMTC_MODEM_RC_OK )
+    {
+        return -1;
+    }
+    return plan.earliest_send_ms;
+}
+
 static void crew_extended_uplink_done( void )
 {
 }
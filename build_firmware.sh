@@ -73,6 +73,14 @@ VERSIONED_HEX="$FIRMWARE_DIR/t1000_e_tracker_v${VERSION_STRING}.hex"
 cp "$HEX_FILE" "$VERSIONED_HEX"
 echo -e "${GREEN}Created: $VERSIONED_HEX${NC}"
 
+# Keep the ELF of every build, decode_tracker_log.py reads deferred log format strings from it
+ELF_FILE="$BUILD_OUTPUT/t1000_e_dev_kit_pca10056.elf"
+VERSIONED_ELF="$FIRMWARE_DIR/t1000_e_tracker_v${VERSION_STRING}.elf"
+if [ -f "$ELF_FILE" ]; then
+    cp "$ELF_FILE" "$VERSIONED_ELF"
+    echo -e "${GREEN}Created: $VERSIONED_ELF${NC}"
+fi
+
 # Convert to UF2
 VERSIONED_UF2="$FIRMWARE_DIR/t1000_e_tracker_v${VERSION_STRING}.uf2"
 echo -e "${GREEN}Converting to UF2...${NC}"
@@ -98,7 +106,13 @@ echo -e "${BLUE}========================================${NC}"
 # Create symlinks for "latest" versions
 ln -sf "$(basename "$VERSIONED_HEX")" "$FIRMWARE_DIR/t1000_e_tracker_latest.hex"
 ln -sf "$(basename "$VERSIONED_UF2")" "$FIRMWARE_DIR/t1000_e_tracker_latest.uf2"
+if [ -f "$VERSIONED_ELF" ]; then
+    ln -sf "$(basename "$VERSIONED_ELF")" "$FIRMWARE_DIR/t1000_e_tracker_latest.elf"
+fi
 
 echo -e "${GREEN}Symlinks created for latest version${NC}"
 echo -e "  → $FIRMWARE_DIR/t1000_e_tracker_latest.hex"
 echo -e "  → $FIRMWARE_DIR/t1000_e_tracker_latest.uf2"
+if [ -f "$VERSIONED_ELF" ]; then
+    echo -e "  → $FIRMWARE_DIR/t1000_e_tracker_latest.elf"
+fi
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""
+Expand T1000-E deferred log records back to text.
+
+With REMEX_LOG_DEFERRED (or the 'D' serial key) the firmware sends LOG_* lines
+as binary frames mixed with ordinary text:
+
+    0x00, length (u16 LE), RTC2 ticks (u32 LE), category (u8),
+    format string address (u32 LE), packed arguments
+
+Arguments follow the format string: 32-bit integers and pointers, 64-bit for
+%ll and doubles, %s as a length byte and its characters. The format strings
+themselves are read from the firmware .elf of the same build (build_firmware.sh
+keeps one next to each .hex).
+
+Usage:
+    ./decode_tracker_log.py firmware/t1000_e_tracker_latest.elf /dev/cu.usbmodem14201
+    ./decode_tracker_log.py firmware/t1000_e_tracker_latest.elf tracker.log
+    cat /dev/cu.usbmodem14201 | ./decode_tracker_log.py firmware/t1000_e_tracker_latest.elf
+
+No third-party modules are needed.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0x00
+RTC_TICK_S = 3.0 / 32768.0   # RTC2 runs with prescaler 2
+
+# Same order, prefixes and aliases as log_filter.c
+CATEGORIES = [
+    ("LORA: ", ("LORA:",)),
+    ("[NMEA] ", ("[NMEA]",)),
+    ("GNSS: ", ("GNSS:",)),
+    ("BLE: ", ()),
+    ("WIFI: ", ()),
+]
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|z|j|t)?([diuxXocpfFeEgGs%])")
+
+
+class Elf:
+    """Just enough ELF32 little endian to read strings at load addresses."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s is not a little endian ELF32 file" % path)
+        phoff, = struct.unpack_from("<I", self.data, 28)
+        phentsize, phnum = struct.unpack_from("<HH", self.data, 42)
+        self.segments = []
+        for i in range(phnum):
+            p_type, p_offset, p_vaddr, _, p_filesz = struct.unpack_from("<IIIII", self.data, phoff + i * phentsize)
+            if p_type == 1 and p_filesz > 0:  # PT_LOAD
+                self.segments.append((p_vaddr, p_filesz, p_offset))
+        self.cache = {}
+
+    def string(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        for vaddr, size, offset in self.segments:
+            if vaddr <= addr < vaddr + size:
+                start = offset + addr - vaddr
+                end = self.data.find(b"\0", start, offset + size)
+                if end < 0:
+                    break
+                text = self.data[start:end].decode("latin-1")
+                self.cache[addr] = text
+                return text
+        return None
+
+
+def expand(fmt, args):
+    """printf the packed arguments with fmt, consuming them as the firmware packed them."""
+    out = []
+    pos = 0
+    last = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+
+        def take(fmt_char, size):
+            nonlocal pos
+            value, = struct.unpack_from(fmt_char, args, pos)
+            pos += size
+            return value
+
+        if width == "*":
+            width = str(take("<i", 4))
+        if prec == "*":
+            prec = str(take("<i", 4))
+        spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+
+        if conv in "di":
+            value = take("<q", 8) if length == "ll" else take("<i", 4)
+            out.append((spec + "d") % value)
+        elif conv in "uxXo":
+            value = take("<Q", 8) if length == "ll" else take("<I", 4)
+            if length == "hh":
+                value &= 0xFF
+            elif length == "h":
+                value &= 0xFFFF
+            out.append((spec + ("d" if conv == "u" else conv)) % value)
+        elif conv == "c":
+            out.append((spec + "c") % chr(take("<I", 4) & 0xFF))
+        elif conv == "p":
+            out.append("0x%08x" % take("<I", 4))
+        elif conv in "fFeEgG":
+            out.append((spec + conv) % take("<d", 8))
+        elif conv == "s":
+            n = args[pos]
+            text = args[pos + 1:pos + 1 + n].decode("latin-1")
+            pos += 1 + n
+            out.append((spec + "s") % text)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def format_record(elf, category, body):
+    if len(body) < 4:
+        return "[log: short record]\n"
+    addr, = struct.unpack_from("<I", body, 0)
+    fmt = elf.string(addr)
+    if fmt is None:
+        return "[log: no format string at 0x%08x, wrong .elf?]\n" % addr
+    try:
+        text = expand(fmt, body[4:])
+    except (struct.error, IndexError, TypeError, ValueError):
+        return "[log: arguments do not match \"%s\"]\n" % fmt.rstrip()
+
+    # Same clean-up and prefixing as log_filter_vprintf( )
+    if text.strip() == "":
+        return ""
+    if category >= len(CATEGORIES):
+        return text
+    prefix, aliases = CATEGORIES[category]
+    if category == 0 and text == prefix:
+        return ""
+    if text.startswith(prefix) or any(text.startswith(a) for a in aliases):
+        return text
+    return prefix + text
+
+
+def decode(elf, stream, out, timestamps):
+    buf = bytearray()
+    while True:
+        chunk = stream.read1(4096) if hasattr(stream, "read1") else stream.read(4096)
+        if not chunk:
+            break
+        buf += chunk
+        while buf:
+            sync = buf.find(FRAME_SYNC)
+            if sync != 0:
+                # Text up to the next frame passes through unchanged
+                end = len(buf) if sync < 0 else sync
+                out.write(buf[:end].decode("utf-8", "replace"))
+                del buf[:end]
+                continue
+            if len(buf) < 3:
+                break
+            length, = struct.unpack_from("<H", buf, 1)
+            if len(buf) < 3 + length:
+                break
+            ticks, category = struct.unpack_from("<IB", buf, 3)
+            text = format_record(elf, category, bytes(buf[8:3 + length]))
+            del buf[:3 + length]
+            if text and timestamps:
+                text = "[%10.3f] %s" % (ticks * RTC_TICK_S, text)
+            out.write(text)
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Expand T1000-E deferred log records using the firmware .elf")
+    parser.add_argument("elf", help="firmware .elf of the build running on the tracker")
+    parser.add_argument("input", nargs="?", help="serial port or captured log file (default: stdin)")
+    parser.add_argument("-t", "--timestamps", action="store_true", help="prefix records with the device RTC time in s")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    out = sys.stdout
+    try:
+        if args.input:
+            with open(args.input, "rb", buffering=0) as stream:
+                decode(elf, stream, out, args.timestamps)
+        else:
+            decode(elf, sys.stdin.buffer, out, args.timestamps)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -241,6 +241,18 @@ typedef struct smtc_modem_lorawan_version_s
     uint8_t revision;  //!< Revision value
 } smtc_modem_lorawan_version_t;
 
+/**
+ * @brief Airtime plan of a burst of same-size uplinks
+ */
+typedef struct smtc_modem_airtime_plan_s
+{
+    uint32_t toa_ms;            //!< Time on air of one frame
+    uint32_t burst_toa_ms;      //!< Time on air of the whole burst
+    uint32_t frame_gap_ms;      //!< Minimum gap between two frames required by the network (DutyCycleReq)
+    int32_t  band_budget_ms;    //!< Time on air available now in the enabled bands, INT32_MAX if no duty cycle
+    int32_t  earliest_send_ms;  //!< Delay before the whole burst fits the duty cycle, -1 if it never does
+} smtc_modem_airtime_plan_t;
+
 /**
  * @brief DM uplink reporting internal format
  */
@@ -1746,6 +1758,28 @@ smtc_modem_return_code_t smtc_modem_lorawan_get_lost_connection_counter( uint8_t
  */
 smtc_modem_return_code_t smtc_modem_get_duty_cycle_status( int32_t* duty_cycle_status_ms );
 
+/**
+ * @brief Plan the airtime of a burst of same-size uplinks before sending it
+ *
+ * @remark Time on air includes the LoRaWAN overhead and the MAC answers pending for the next uplink. The earliest send
+ * time accounts for the regional duty cycle of the enabled channels and the network DutyCycleReq time off, so a burst
+ * can be reshaped or delayed instead of being refused by @ref smtc_modem_request_uplink
+ *
+ * @param [in]  stack_id        Stack identifier
+ * @param [in]  datarate        LoRaWAN datarate of the frames
+ * @param [in]  payload_length  Application payload length of each frame
+ * @param [in]  count           Number of frames in the burst
+ * @param [out] plan            Airtime plan as described in @ref smtc_modem_airtime_plan_t
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK                Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID           \p plan is NULL, or \p datarate or \p payload_length is not valid in the region
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode
+ * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
+ */
+smtc_modem_return_code_t smtc_modem_get_airtime_plan( uint8_t stack_id, uint8_t datarate, uint8_t payload_length,
+                                                      uint8_t count, smtc_modem_airtime_plan_t* plan );
+
 /**
  * @brief Get the current state of the stack
  *
@@ -494,6 +494,12 @@ int32_t lorawan_api_next_free_duty_cycle_ms_get( void )
     return lr1mac_core_next_free_duty_cycle_ms_get( &lr1_mac_obj );
 }
 
+status_lorawan_t lorawan_api_airtime_plan_get( uint8_t datarate, uint8_t size, uint8_t count,
+                                               lr1mac_airtime_plan_t* plan )
+{
+    return lr1mac_core_airtime_plan_get( &lr1_mac_obj, datarate, size, count, plan );
+}
+
 status_lorawan_t lorawan_api_duty_cycle_enable_set( smtc_dtc_enablement_type_t dtc_type )
 {
     if( smtc_duty_cycle_enable_set( lr1_mac_obj.dtc_obj, dtc_type ) == true )
@@ -414,6 +414,18 @@ uint32_t lorawan_api_next_join_time_second_get( void );
  */
 int32_t lorawan_api_next_free_duty_cycle_ms_get( void );
 
+/**
+ * @brief Plan the airtime of a burst of same-size uplinks
+ *
+ * @param [in]  datarate Tx datarate of the burst
+ * @param [in]  size     Application payload size of each frame
+ * @param [in]  count    Number of frames in the burst
+ * @param [out] plan     Airtime plan as described in @ref lr1mac_airtime_plan_t
+ * @return status_lorawan_t ERRORLORAWAN if the datarate or the size is not valid in the region
+ */
+status_lorawan_t lorawan_api_airtime_plan_get( uint8_t datarate, uint8_t size, uint8_t count,
+                                               lr1mac_airtime_plan_t* plan );
+
 /**
  * @brief Enable / disable the dutycycle
  *
@@ -1462,17 +1462,92 @@ int32_t lr1_stack_network_next_free_duty_cycle_ms_get( lr1_stack_mac_t* lr1_mac
 }
 
 uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
+{
+    return lr1_stack_toa_get_dr_size( lr1_mac, lr1_mac->tx_data_rate, lr1_mac->tx_payload_size );
+}
+
+void lr1_stack_toa_table_init( lr1_stack_mac_t* lr1_mac )
+{
+    ral_lora_cr_t cr = smtc_real_get_coding_rate( lr1_mac );
+
+    memset( lr1_mac->toa_table, 0, sizeof( lr1_mac->toa_table ) );
+
+    // Long interleaving has its own symbol count, leave it to the radio driver
+    if( cr > RAL_LORA_CR_4_8 )
+    {
+        return;
+    }
+
+    for( uint8_t dr = const_min_tx_dr; ( dr <= const_max_tx_dr ) && ( dr < LR1_STACK_TOA_TABLE_SIZE ); dr++ )
+    {
+        if( ( SMTC_GET_BIT16( &const_dr_bitfield, dr ) == 0 ) ||
+            ( smtc_real_get_modulation_type_from_datarate( lr1_mac, dr ) != LORA ) )
+        {
+            continue;
+        }
+
+        uint8_t            sf;
+        lr1mac_bandwidth_t bw;
+        uint32_t           bw_hz;
+        smtc_real_lora_dr_to_sf_bw( lr1_mac, dr, &sf, &bw );
+
+        switch( bw )
+        {
+        case BW125:
+            bw_hz = 125000UL;
+            break;
+        case BW250:
+            bw_hz = 250000UL;
+            break;
+        case BW500:
+            bw_hz = 500000UL;
+            break;
+        default:
+            // Other bandwidths are radio specific (812 kHz for BW800 on LR112X), ask the driver
+            continue;
+        }
+
+        // Same symbol count as the LoRa modem datasheets for an explicit header and CRC on
+        uint8_t               fine_synch = ( sf <= 6 ) ? 1 : 0;
+        uint8_t               ldro       = ral_compute_lora_ldro( ( ral_lora_sf_t ) sf, ( ral_lora_bw_t ) bw );
+        lr1_stack_toa_coef_t* coef       = &lr1_mac->toa_table[dr];
+
+        coef->bw_hz         = bw_hz;
+        coef->sf            = sf;
+        coef->header_bits   = ( 4 * sf ) + ( 8 * fine_synch ) - 28;
+        coef->bits_per_symb = 4 * ( sf - ( 2 * ( ldro != 0 ? 1 : 0 ) ) );
+        coef->cr_symb       = cr + 4;
+        coef->fixed_symb    = smtc_real_get_preamble_len( lr1_mac, sf ) + 4 + ( 2 * fine_synch ) + 8;
+    }
+}
+
+uint32_t lr1_stack_toa_get_dr_size( lr1_stack_mac_t* lr1_mac, uint8_t dr, uint8_t size )
 {
     uint32_t toa = 0;
 
-    modulation_type_t tx_modulation_type =
-        smtc_real_get_modulation_type_from_datarate( lr1_mac, lr1_mac->tx_data_rate );
+    if( ( dr < LR1_STACK_TOA_TABLE_SIZE ) && ( lr1_mac->toa_table[dr].bw_hz != 0 ) )
+    {
+        const lr1_stack_toa_coef_t* coef         = &lr1_mac->toa_table[dr];
+        int32_t                     payload_bits = ( 8 * ( ( int32_t ) size + 2 ) ) - coef->header_bits;
+        uint32_t                    nb_symb      = coef->fixed_symb;
+
+        if( payload_bits > 0 )
+        {
+            nb_symb += ( ( payload_bits + coef->bits_per_symb - 1 ) / coef->bits_per_symb ) * coef->cr_symb;
+        }
+
+        // Integral ceil() of the symbol time sum, in ms
+        uint32_t numerator = 1000U * ( ( ( 4 * nb_symb + 1 ) << ( coef->sf - 2 ) ) - 1 );
+        return ( numerator + coef->bw_hz - 1 ) / coef->bw_hz;
+    }
+
+    modulation_type_t tx_modulation_type = smtc_real_get_modulation_type_from_datarate( lr1_mac, dr );
 
     if( tx_modulation_type == LORA )
     {
         uint8_t            tx_sf;
         lr1mac_bandwidth_t tx_bw;
-        smtc_real_lora_dr_to_sf_bw( lr1_mac, lr1_mac->tx_data_rate, &tx_sf, &tx_bw );
+        smtc_real_lora_dr_to_sf_bw( lr1_mac, dr, &tx_sf, &tx_bw );
 
         ralf_params_lora_t lora_param;
         memset( &lora_param, 0, sizeof( ralf_params_lora_t ) );
@@ -1484,7 +1559,7 @@ uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
 
         lora_param.pkt_params.crc_is_on            = true;
         lora_param.pkt_params.invert_iq_is_on      = false;
-        lora_param.pkt_params.pld_len_in_bytes     = lr1_mac->tx_payload_size;
+        lora_param.pkt_params.pld_len_in_bytes     = size;
         lora_param.pkt_params.preamble_len_in_symb = smtc_real_get_preamble_len( lr1_mac, lora_param.mod_params.sf );
         lora_param.pkt_params.header_type          = RAL_LORA_PKT_EXPLICIT;
 
@@ -1494,7 +1569,7 @@ uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
     else if( tx_modulation_type == FSK )
     {
         uint8_t tx_bitrate;
-        smtc_real_fsk_dr_to_bitrate( lr1_mac, lr1_mac->tx_data_rate, &tx_bitrate );
+        smtc_real_fsk_dr_to_bitrate( lr1_mac, dr, &tx_bitrate );
 
         ralf_params_gfsk_t gfsk_param;
         memset( &gfsk_param, 0, sizeof( ralf_params_gfsk_t ) );
@@ -1508,7 +1583,7 @@ uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
         gfsk_param.mod_params.fdev_in_hz            = 25000;
         gfsk_param.mod_params.br_in_bps             = tx_bitrate * 1000;
         gfsk_param.mod_params.bw_dsb_in_hz          = 100000;
-        gfsk_param.pkt_params.pld_len_in_bytes      = lr1_mac->tx_payload_size;
+        gfsk_param.pkt_params.pld_len_in_bytes      = size;
         gfsk_param.pkt_params.preamble_len_in_bits  = 40;
         gfsk_param.pkt_params.header_type           = RAL_GFSK_PKT_VAR_LEN;
         gfsk_param.pkt_params.sync_word_len_in_bits = 24;
@@ -1522,7 +1597,7 @@ uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
     {
         lr_fhss_v1_cr_t tx_cr;
         lr_fhss_v1_bw_t tx_bw;
-        smtc_real_lr_fhss_dr_to_cr_bw( lr1_mac, lr1_mac->tx_data_rate, &tx_cr, &tx_bw );
+        smtc_real_lr_fhss_dr_to_cr_bw( lr1_mac, dr, &tx_cr, &tx_bw );
 
         ralf_params_lr_fhss_t lr_fhss_param;
         memset( &lr_fhss_param, 0, sizeof( ralf_params_lr_fhss_t ) );
@@ -1532,7 +1607,7 @@ uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac )
         lr_fhss_param.ral_lr_fhss_params.lr_fhss_params.header_count   = smtc_real_lr_fhss_get_header_count( tx_cr );
 
         ral_lr_fhss_get_time_on_air_in_ms( ( &lr1_mac->rp->radio->ral ), &lr_fhss_param.ral_lr_fhss_params,
-                                           lr1_mac->tx_payload_size, &toa );
+                                           size, &toa );
     }
     else
     {
@@ -49,10 +49,28 @@ extern "C" {
 #define MIN_RX_WINDOW_SYMB 6         // open rx window at least 6 symbols
 #define MAX_RX_WINDOW_SYMB 255       // open rx window at max 225 symbol hardware limitation
 #define MIN_RX_WINDOW_DURATION_MS 60  // open rx window at least 60ms
+#define LR1_STACK_TOA_TABLE_SIZE 16   // one entry per datarate of const_dr_bitfield
 /*
  *-----------------------------------------------------------------------------------
  * --- PUBLIC TYPES -----------------------------------------------------------------
  */
+
+/*!
+ * \brief Time on air coefficients of one LoRa datarate of the current region
+ * \remark Explicit header and CRC on, as every uplink. bw_hz is 0 when the datarate
+ *         is not tabulated (not in the region, not LoRa, long interleaving or
+ *         unusual bandwidth) and the radio driver is asked instead.
+ */
+typedef struct lr1_stack_toa_coef_s
+{
+    uint32_t bw_hz;
+    uint8_t  sf;
+    uint8_t  header_bits;    // payload bits carried by the header symbols
+    uint8_t  bits_per_symb;  // payload bits per block of ( cr + 4 ) symbols
+    uint8_t  cr_symb;        // cr + 4
+    uint8_t  fixed_symb;     // preamble, sync, header symbols
+} lr1_stack_toa_coef_t;
+
 typedef struct lr1_stack_mac_s
 {
     mac_context_t mac_context;
@@ -233,6 +251,9 @@ typedef struct lr1_stack_mac_s
 
     // Downlink Network
     bool push_network_downlink_to_user;
+
+    // Time on air by datarate, rebuilt with the region
+    lr1_stack_toa_coef_t toa_table[LR1_STACK_TOA_TABLE_SIZE];
 } lr1_stack_mac_t;
 
 /*
@@ -381,6 +402,25 @@ int32_t lr1_stack_network_next_free_duty_cycle_ms_get( lr1_stack_mac_t* lr1_mac
  */
 uint32_t lr1_stack_toa_get( lr1_stack_mac_t* lr1_mac );
 
+/*!
+ * \brief lr1_stack_toa_table_init
+ * \remark Tabulate the LoRa time on air coefficients of every datarate of the
+ *         region, call again after each smtc_real_config
+ * \param [IN]  lr1_stack_mac_t
+ */
+void lr1_stack_toa_table_init( lr1_stack_mac_t* lr1_mac );
+
+/*!
+ * \brief lr1_stack_toa_get_dr_size
+ * \remark O(1) from toa_table for LoRa datarates, radio driver computation otherwise.
+ *         The datarate must be a valid tx datarate of the region.
+ * \param [IN]  lr1_stack_mac_t
+ * \param [IN]  dr               tx datarate
+ * \param [IN]  size             PHY payload size in bytes
+ * \return toa in ms
+ */
+uint32_t lr1_stack_toa_get_dr_size( lr1_stack_mac_t* lr1_mac, uint8_t dr, uint8_t size );
+
 /**
  * @brief
  *
@@ -168,6 +168,7 @@ void lr1mac_core_init( lr1_stack_mac_t* lr1_mac_obj, smtc_real_t* real, smtc_lbt
 
     smtc_real_config( lr1_mac_obj );
     SMTC_MODEM_HAL_TRACE_PRINTF_DEBUG( "smtc_real_config done\n" );
+    lr1_stack_toa_table_init( lr1_mac_obj );
     smtc_real_init( lr1_mac_obj );
     SMTC_MODEM_HAL_TRACE_PRINTF_DEBUG( "smtc_real_init done\n" );
 
@@ -857,6 +858,43 @@ int32_t lr1mac_core_next_free_duty_cycle_ms_get( lr1_stack_mac_t* lr1_mac_obj )
     return ret;
 }
 
+status_lorawan_t lr1mac_core_airtime_plan_get( lr1_stack_mac_t* lr1_mac_obj, uint8_t datarate, uint8_t size,
+                                               uint8_t count, lr1mac_airtime_plan_t* plan )
+{
+    uint8_t  number_of_freq = 0;
+    uint8_t  max_size       = 16;
+    uint32_t freq_list[16]  = { 0 };  // Generally region with duty cycle support 16 channels only
+
+    int32_t region_dtc = 0;
+    int32_t nwk_dtc    = lr1_stack_network_next_free_duty_cycle_ms_get( lr1_mac_obj );
+
+    if( ( smtc_real_is_tx_dr_valid( lr1_mac_obj, datarate ) != OKLORAWAN ) ||
+        ( smtc_real_is_payload_size_valid( lr1_mac_obj, datarate, size, lr1_mac_obj->uplink_dwell_time ) !=
+          OKLORAWAN ) )
+    {
+        return ERRORLORAWAN;
+    }
+
+    uint8_t phy_size = size + FHDROFFSET + 1 + lr1_mac_obj->tx_fopts_current_length + MICSIZE;
+
+    plan->toa_ms         = lr1_stack_toa_get_dr_size( lr1_mac_obj, datarate, phy_size );
+    plan->burst_toa_ms   = plan->toa_ms * count;
+    plan->frame_gap_ms   = ( plan->toa_ms << lr1_mac_obj->max_duty_cycle_index ) - plan->toa_ms;
+    plan->band_budget_ms = INT32_MAX;
+
+    if( smtc_real_is_dtc_supported( lr1_mac_obj ) == true )
+    {
+        if( smtc_real_get_current_enabled_frequency_list( lr1_mac_obj, &number_of_freq, freq_list, max_size ) == true )
+        {
+            region_dtc = smtc_duty_cycle_plan_burst_ms( lr1_mac_obj->dtc_obj, number_of_freq, freq_list,
+                                                        plan->toa_ms, count, &plan->band_budget_ms );
+        }
+    }
+
+    plan->earliest_send_ms = ( region_dtc < 0 ) ? region_dtc : MAX( nwk_dtc, region_dtc );
+    return OKLORAWAN;
+}
+
 uint8_t lr1mac_core_rx_ack_bit_get( lr1_stack_mac_t* lr1_mac_obj )
 {
     return ( lr1_mac_obj->rx_ack_bit );
@@ -879,6 +917,7 @@ status_lorawan_t lr1mac_core_set_region( lr1_stack_mac_t* lr1_mac_obj, smtc_real
         lr1_mac_obj->real->region_type = region_type;
         lr1mac_core_context_save( lr1_mac_obj );
         smtc_real_config( lr1_mac_obj );
+        lr1_stack_toa_table_init( lr1_mac_obj );
         smtc_real_init( lr1_mac_obj );
         // After a region change a new join should happen, reset join counter
         lr1_mac_obj->retry_join_cpt = 0;
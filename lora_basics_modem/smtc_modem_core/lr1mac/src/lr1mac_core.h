@@ -402,6 +402,22 @@ uint32_t lr1mac_core_next_join_time_second_get( lr1_stack_mac_t* lr1_mac_obj );
  */
 int32_t lr1mac_core_next_free_duty_cycle_ms_get( lr1_stack_mac_t* lr1_mac_obj );
 
+/**
+ * @brief Plan the airtime of a burst of same-size uplinks
+ *
+ * @remark  The frame size includes the LoRaWAN header, FPort, pending FOpts and MIC. Time on air of LoRa datarates
+ *          comes from the table built with the region, see lr1_stack_toa_table_init.
+ *
+ * @param lr1_mac_obj
+ * @param [in]  datarate   Tx datarate of the burst
+ * @param [in]  size       Application payload size of each frame
+ * @param [in]  count      Number of frames in the burst
+ * @param [out] plan       Airtime plan
+ * @return status_lorawan_t ERRORLORAWAN if the datarate or the size is not valid in the region
+ */
+status_lorawan_t lr1mac_core_airtime_plan_get( lr1_stack_mac_t* lr1_mac_obj, uint8_t datarate, uint8_t size,
+                                               uint8_t count, lr1mac_airtime_plan_t* plan );
+
 /**
  * @brief Get the Rx network ACK bit status
  *
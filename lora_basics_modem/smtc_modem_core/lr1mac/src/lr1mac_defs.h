@@ -499,6 +499,18 @@ typedef struct lr1mac_version_s
     uint8_t revision;
 } lr1mac_version_t;
 
+/********************************************************************************/
+/*                         Airtime plan                                         */
+/********************************************************************************/
+typedef struct lr1mac_airtime_plan_s
+{
+    uint32_t toa_ms;            // Time on air of one frame
+    uint32_t burst_toa_ms;      // Time on air of the whole burst
+    uint32_t frame_gap_ms;      // Minimum gap between two frames required by DutyCycleReq
+    int32_t  band_budget_ms;    // Time on air available now in the enabled bands, INT32_MAX if no duty cycle
+    int32_t  earliest_send_ms;  // Delay before the whole burst is allowed, -1 if it never fits in one period
+} lr1mac_airtime_plan_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -89,24 +89,60 @@ static uint8_t smtc_duty_cycle_get_band( smtc_dtc_t* dtc_obj, uint32_t freq_hz )
 static uint32_t smtc_duty_cycle_get_band_consumed_time_ms( smtc_dtc_t* dtc_obj, uint8_t band );
 
 /**
- * @brief Compute Index in array of TOA with the a given timestamp in millisecond
+ * @brief Remove from a band the uplinks that left the period
  *
- * @param timestamp_ms              Timestamp ms
- * @param idx_previous              the previous index to manage wrapping
- * @return uint8_t                  Return the corresponding index
+ * @param band_obj                  Band to update
+ * @param rtc_ms                    RTC ms
+ */
+static void smtc_duty_cycle_band_expire( smtc_dtc_band_t* band_obj, uint32_t rtc_ms );
+
+/**
+ * @brief Get an uplink of a band log, oldest first
+ *
+ * @param band_obj                  Band requested
+ * @param i                         Position from the oldest uplink
+ * @return smtc_dtc_tx_t*           Return the uplink
+ */
+static inline smtc_dtc_tx_t* smtc_duty_cycle_band_tx( smtc_dtc_band_t* band_obj, uint8_t i );
+
+/**
+ * @brief Find the logged uplink whose merge into the next one spans the least time
+ *
+ * A logged uplink holds the TOA sent after the previous one (tx_floor_ms for the oldest): merged into the next one,
+ * that TOA is held until the next one leaves the period, late by at most the span of the merged entry.
+ *
+ * @param [in] band_obj             Band, with a full log
+ * @param [in] rtc_ms               Current time, the new uplink follows the newest logged one
+ * @return uint8_t                  Index of the uplink to merge, oldest first; tx_count - 1 to merge the new uplink
+ *                                  into the newest one
  */
-static inline uint8_t smtc_duty_cycle_compute_index( uint32_t timestamp_ms, uint8_t idx_previous );
+static uint8_t smtc_duty_cycle_band_merge_candidate( smtc_dtc_band_t* band_obj, uint32_t rtc_ms );
 
 /**
- * @brief Compute Diff between the two timestamp and manage wrapping
+ * @brief Merge a logged uplink into the next one, which keeps its timestamp
  *
- * @remark the Second parameter is rounded to the begin of an index
+ * @param [in] band_obj             Band
+ * @param [in] i                    Index of the older uplink, oldest first
+ */
+static void smtc_duty_cycle_band_merge( smtc_dtc_band_t* band_obj, uint8_t i );
+
+/**
+ * @brief Compute the time before a logged uplink leaves the period
  *
+ * @param tx                        Logged uplink
  * @param rtc_ms                    RTC ms
- * @param timestamp_ms              Timestamp ms
- * @return uint32_t                 Return the time diff
+ * @return uint32_t                 Return the time left in the period
  */
-static inline uint32_t smtc_duty_cycle_time_diff( uint32_t rtc_ms, uint32_t timestamp_ms );
+static inline uint32_t smtc_duty_cycle_tx_time_left( const smtc_dtc_tx_t* tx, uint32_t rtc_ms );
+
+/**
+ * @brief Check if a Time On Air fits in an available Time On Air
+ *
+ * @param available_toa_ms          Available Time On Air, can be negative
+ * @param toa_ms                    Time On Air needed, 0 for any
+ * @return bool
+ */
+static inline bool smtc_duty_cycle_toa_fits( int32_t available_toa_ms, uint32_t toa_ms );
 
 /**
  * @brief Put band number in array if not already present
@@ -172,52 +208,36 @@ void smtc_duty_cycle_sum( smtc_dtc_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms
         return;
     }
 
-    uint32_t rtc_time_now = smtc_modem_hal_get_time_in_ms( );
-    uint8_t  band         = smtc_duty_cycle_get_band( dtc_obj, freq_hz );
-    uint8_t  idx_previous = dtc_obj->bands[band].index_previous;
-
-    // compute index by delta to manage rtc_ms wrapping
-    uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-    uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
+    uint32_t         rtc_time_now = smtc_modem_hal_get_time_in_ms( );
+    smtc_dtc_band_t* band_obj     = &dtc_obj->bands[smtc_duty_cycle_get_band( dtc_obj, freq_hz )];
 
-    // Convert TOA to the resolution
-    toa_ms = ( toa_ms < smtc_dtc_resolution_ms )
-                 ? 1
-                 : ( smtc_dtc_resolution_ms == 1 ) ? toa_ms : ( toa_ms / smtc_dtc_resolution_ms ) + 1;
+    smtc_duty_cycle_band_expire( band_obj, rtc_time_now );
 
-    // More than SMTC_DTC_PERIOD_MS since the last timestamp
-    if( smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms ) >= SMTC_DTC_PERIOD_MS )
+    if( band_obj->tx_count >= SMTC_DTC_TX_LOG_SIZE )
     {
-        // Erase band cumulated TOA
-        memset( dtc_obj->bands[band].toa_sum_ms, 0, sizeof( dtc_obj->bands[band].toa_sum_ms ) );
-    }
-    else
-    {
-        // If we are on the same index since less than the time of one unit
-        if( ( idx_new == idx_previous ) && ( timestamp_diff < ( SMTC_DTC_SECONDS_BY_UNIT * 1000 ) ) )
-        {
-            // Sum TOA in same buffer
-            toa_ms += dtc_obj->bands[band].toa_sum_ms[idx_new];
-        }
-        else
+        uint8_t merge = smtc_duty_cycle_band_merge_candidate( band_obj, rtc_time_now );
+
+        if( merge == ( band_obj->tx_count - 1 ) )
         {
-            // Erase obsolete data between last saved and the current
-            uint8_t i = idx_previous;
-            while( i != idx_new )
-            {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                dtc_obj->bands[band].toa_sum_ms[i] = 0;
-            }
+            // Merging this uplink into the newest one spans the least time: they leave the period together
+            smtc_dtc_tx_t* newest = smtc_duty_cycle_band_tx( band_obj, merge );
+            newest->toa_ms += toa_ms;
+            newest->timestamp_ms = rtc_time_now;
+            band_obj->toa_sum_ms += toa_ms;
+            return;
         }
+        smtc_duty_cycle_band_merge( band_obj, merge );
     }
-    // Save the new TOA
-    dtc_obj->bands[band].toa_sum_ms[idx_new] = toa_ms;
-    dtc_obj->bands[band].toa_timestamp_ms    = rtc_time_now;
-    dtc_obj->bands[band].index_previous      = idx_new;
+    else if( band_obj->tx_count == 0 )
+    {
+        band_obj->tx_floor_ms = rtc_time_now;
+    }
+
+    smtc_dtc_tx_t* tx = smtc_duty_cycle_band_tx( band_obj, band_obj->tx_count );
+    tx->toa_ms        = toa_ms;
+    tx->timestamp_ms  = rtc_time_now;
+    band_obj->tx_count++;
+    band_obj->toa_sum_ms += toa_ms;
 }
 
 void smtc_duty_cycle_update( smtc_dtc_t* dtc_obj )
@@ -230,38 +250,7 @@ void smtc_duty_cycle_update( smtc_dtc_t* dtc_obj )
 
     for( uint8_t band = 0; band < dtc_obj->number_of_bands; band++ )
     {
-        uint8_t idx_previous = dtc_obj->bands[band].index_previous;
-        // compute index by delta to manage rtc_ms wrapping
-        uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-        uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
-
-        // More than SMTC_DTC_PERIOD_MS since the last timestamp
-        if( smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms ) >= SMTC_DTC_PERIOD_MS )
-        {
-            // Erase band cumulated TOA, it's been over 1h
-            memset( dtc_obj->bands[band].toa_sum_ms, 0, sizeof( dtc_obj->bands[band].toa_sum_ms ) );
-            dtc_obj->bands[band].toa_timestamp_ms = rtc_time_now;
-            dtc_obj->bands[band].index_previous   = idx_new;
-        }
-        else
-        {
-            // Erase obsolete data between last saved and the current
-            uint8_t i = idx_previous;
-            while( i != idx_new )
-            {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                // If equal do not erase the TOA
-                if( ( i != idx_new ) ||
-                    ( ( i == idx_new ) && ( timestamp_diff >= ( SMTC_DTC_SECONDS_BY_UNIT * 1000 ) ) ) )
-                {
-                    dtc_obj->bands[band].toa_sum_ms[i] = 0;
-                }
-            }
-        }
+        smtc_duty_cycle_band_expire( &dtc_obj->bands[band], rtc_time_now );
     }
 }
 
@@ -394,58 +383,146 @@ int32_t smtc_duty_cycle_get_next_free_time_ms( smtc_dtc_t* dtc_obj, uint8_t numb
     }
     else
     {
-        // All bands reached the max available TOA, search for the next nearest TOA available slot
-        uint32_t next_available_slot_ms_tmp = ~0;
-        uint32_t rtc_time_now               = smtc_modem_hal_get_time_in_ms( );
+        // All bands reached the max available TOA, search for the first band to get TOA back
+        int32_t next_available_slot_ms_tmp = INT32_MAX;
 
         for( uint8_t j = 0; j < tmp_band_dtc_full_index; j++ )
         {
-            uint8_t band = tmp_band_dtc_full[j];
+            int32_t next_available_slot_ms =
+                smtc_duty_cycle_band_get_next_free_time_ms( dtc_obj, tmp_band_dtc_full[j], 0 );
+
+            if( ( next_available_slot_ms > 0 ) && ( next_available_slot_ms_tmp > next_available_slot_ms ) )
+            {
+                next_available_slot_ms_tmp = next_available_slot_ms;
+            }
+        }
+        if( next_available_slot_ms_tmp == INT32_MAX )
+        {
+            // A full band always has logged uplinks
+            smtc_modem_hal_lr1mac_panic( );
+        }
+        ret = next_available_slot_ms_tmp;
+    }
+
+    return ret;
+}
+
+int32_t smtc_duty_cycle_band_get_next_free_time_ms( smtc_dtc_t* dtc_obj, uint8_t band, uint32_t toa_ms )
+{
+    if( ( dtc_obj->enabled != SMTC_DTC_ENABLED ) || ( dtc_obj->number_of_bands == 0 ) )
+    {
+        return 0;
+    }
+
+    smtc_dtc_band_t* band_obj     = &dtc_obj->bands[band];
+    uint32_t         rtc_time_now = smtc_modem_hal_get_time_in_ms( );
+    int32_t          available_ms = smtc_duty_cycle_band_get_available_toa_ms( dtc_obj, band );
+
+    if( smtc_duty_cycle_toa_fits( available_ms, toa_ms ) == true )
+    {
+        return 0;
+    }
+
+    // The TOA comes back, oldest uplink first, when each uplink leaves the period
+    for( uint8_t i = 0; i < band_obj->tx_count; i++ )
+    {
+        const smtc_dtc_tx_t* tx = smtc_duty_cycle_band_tx( band_obj, i );
+
+        available_ms += tx->toa_ms;
+        if( smtc_duty_cycle_toa_fits( available_ms, toa_ms ) == true )
+        {
+            return ( int32_t ) smtc_duty_cycle_tx_time_left( tx, rtc_time_now );
+        }
+    }
+    return -1;
+}
+
+int32_t smtc_duty_cycle_plan_burst_ms( smtc_dtc_t* dtc_obj, uint8_t number_of_tx_freq, uint32_t* tx_freq_list,
+                                       uint32_t toa_ms, uint8_t count, int32_t* available_toa_ms )
+{
+    if( ( dtc_obj->enabled != SMTC_DTC_ENABLED ) || ( dtc_obj->number_of_bands == 0 ) )
+    {
+        *available_toa_ms = INT32_MAX;
+        return 0;
+    }
+
+    uint8_t tmp_band_index = 0;
+    uint8_t tmp_band[SMTC_DTC_BANDS_MAX];
+    uint8_t next_tx[SMTC_DTC_BANDS_MAX];
+    int32_t band_toa_ms[SMTC_DTC_BANDS_MAX];
+
+    memset( tmp_band, 0xFF, SMTC_DTC_BANDS_MAX );
+
+    // Update duty-cycle timing
+    smtc_duty_cycle_update( dtc_obj );
+
+    for( uint8_t i = 0; i < number_of_tx_freq; i++ )
+    {
+        smtc_duty_cycle_put_band_in_array( dtc_obj, tmp_band, smtc_duty_cycle_get_band( dtc_obj, tx_freq_list[i] ),
+                                           &tmp_band_index );
+    }
+
+    if( tmp_band_index == 0 )
+    {
+        smtc_modem_hal_mcu_panic( "Empty frequency list\n" );
+    }
 
-            uint8_t idx_previous = dtc_obj->bands[band].index_previous;
-            // compute index by delta to manage rtc_ms wrapping
-            uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-            uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
+    uint32_t rtc_time_now = smtc_modem_hal_get_time_in_ms( );
+    uint32_t toa_cost_ms  = ( toa_ms > 0 ) ? toa_ms : 1;
+    uint32_t wait_ms      = 0;
 
-            // compute time between now and the end of this index
-            uint32_t next_available_slot_ms =
-                ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) - ( rtc_time_now % ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) );
+    *available_toa_ms = 0;
+    for( uint8_t j = 0; j < tmp_band_index; j++ )
+    {
+        next_tx[j]     = 0;
+        band_toa_ms[j] = smtc_duty_cycle_band_get_available_toa_ms( dtc_obj, tmp_band[j] );
+        if( band_toa_ms[j] > 0 )
+        {
+            *available_toa_ms += band_toa_ms[j];
+        }
+    }
 
-            uint8_t idx_empty_counter = 0;
+    // Replay the uplinks leaving the period, in time order across the bands
+    while( true )
+    {
+        uint32_t nb_frames = 0;
+        uint8_t  next_band = 0xFF;
+        uint32_t next_ms   = 0;
 
-            uint8_t i = idx_new;
-            do
+        for( uint8_t j = 0; j < tmp_band_index; j++ )
+        {
+            if( smtc_duty_cycle_toa_fits( band_toa_ms[j], toa_ms ) == true )
             {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                if( dtc_obj->bands[band].toa_sum_ms[i] != 0 )
-                {
-                    break;
-                }
-                if( i != idx_previous )
-                {
-                    idx_empty_counter++;
-                }
+                nb_frames += ( ( ( uint32_t ) band_toa_ms[j] - toa_ms ) / toa_cost_ms ) + 1;
+            }
 
-                if( idx_empty_counter > SMTC_DTC_TOA_BUFF_SIZE )
+            smtc_dtc_band_t* band_obj = &dtc_obj->bands[tmp_band[j]];
+            if( next_tx[j] < band_obj->tx_count )
+            {
+                uint32_t time_left_ms =
+                    smtc_duty_cycle_tx_time_left( smtc_duty_cycle_band_tx( band_obj, next_tx[j] ), rtc_time_now );
+                if( ( next_band == 0xFF ) || ( time_left_ms < next_ms ) )
                 {
-                    smtc_modem_hal_lr1mac_panic( );
+                    next_band = j;
+                    next_ms   = time_left_ms;
                 }
-            } while( i != idx_previous );
-
-            next_available_slot_ms += idx_empty_counter * SMTC_DTC_SECONDS_BY_UNIT * 1000UL;
-            if( next_available_slot_ms_tmp > next_available_slot_ms )
-            {
-                next_available_slot_ms_tmp = next_available_slot_ms;
             }
         }
-        ret = next_available_slot_ms_tmp;
-    }
 
-    return ret;
+        if( nb_frames >= count )
+        {
+            return ( int32_t ) wait_ms;
+        }
+        if( next_band == 0xFF )
+        {
+            return -1;
+        }
+
+        smtc_dtc_band_t* band_obj = &dtc_obj->bands[tmp_band[next_band]];
+        band_toa_ms[next_band] += smtc_duty_cycle_band_tx( band_obj, next_tx[next_band] )->toa_ms;
+        next_tx[next_band]++;
+        wait_ms = next_ms;
+    }
 }
 
 /*
@@ -467,31 +544,76 @@ static uint8_t smtc_duty_cycle_get_band( smtc_dtc_t* dtc_obj, uint32_t freq_hz )
 
 static uint32_t smtc_duty_cycle_get_band_consumed_time_ms( smtc_dtc_t* dtc_obj, uint8_t band )
 {
-    uint32_t toa_ms = 0;
-    for( uint8_t i = 0; i < SMTC_DTC_TOA_BUFF_SIZE; i++ )
+    return dtc_obj->bands[band].toa_sum_ms;
+}
+
+static void smtc_duty_cycle_band_expire( smtc_dtc_band_t* band_obj, uint32_t rtc_ms )
+{
+    while( band_obj->tx_count > 0 )
     {
-        toa_ms += dtc_obj->bands[band].toa_sum_ms[i];
+        const smtc_dtc_tx_t* tx = &band_obj->tx_log[band_obj->tx_first];
+
+        if( ( uint32_t )( rtc_ms - tx->timestamp_ms ) < SMTC_DTC_PERIOD_MS )
+        {
+            break;
+        }
+        band_obj->toa_sum_ms -= tx->toa_ms;
+        band_obj->tx_floor_ms = tx->timestamp_ms;
+        band_obj->tx_first = ( band_obj->tx_first + 1 ) % SMTC_DTC_TX_LOG_SIZE;
+        band_obj->tx_count--;
     }
+}
 
-    // Convert to the resolution
-    toa_ms *= smtc_dtc_resolution_ms;
-    return toa_ms;
+static inline smtc_dtc_tx_t* smtc_duty_cycle_band_tx( smtc_dtc_band_t* band_obj, uint8_t i )
+{
+    return &band_obj->tx_log[( band_obj->tx_first + i ) % SMTC_DTC_TX_LOG_SIZE];
 }
 
-static inline uint8_t smtc_duty_cycle_compute_index( uint32_t timestamp_ms, uint8_t idx_previous )
+static uint8_t smtc_duty_cycle_band_merge_candidate( smtc_dtc_band_t* band_obj, uint32_t rtc_ms )
 {
-    uint8_t idx_new =
-        ( ( ( timestamp_ms / 60000UL ) % ( ( ( SMTC_DTC_PERIOD_MS / 1000UL ) + SMTC_DTC_SECONDS_BY_UNIT ) / 60 ) ) /
-          ( SMTC_DTC_SECONDS_BY_UNIT / 60 ) );
+    uint8_t  candidate = 0;
+    uint32_t min_span  = UINT32_MAX;
+    uint32_t start_ms  = band_obj->tx_floor_ms;
+
+    for( uint8_t i = 0; i < band_obj->tx_count; i++ )
+    {
+        uint32_t end_ms = ( ( i + 1 ) < band_obj->tx_count ) ? smtc_duty_cycle_band_tx( band_obj, i + 1 )->timestamp_ms
+                                                             : rtc_ms;
+        uint32_t span   = end_ms - start_ms;
 
-    idx_new += idx_previous;
-    idx_new %= SMTC_DTC_TOA_BUFF_SIZE;
-    return idx_new;
+        if( span < min_span )
+        {
+            min_span  = span;
+            candidate = i;
+        }
+        start_ms = smtc_duty_cycle_band_tx( band_obj, i )->timestamp_ms;
+    }
+    return candidate;
+}
+
+static void smtc_duty_cycle_band_merge( smtc_dtc_band_t* band_obj, uint8_t i )
+{
+    // The older TOA is kept until the newer one leaves: the budget is under-estimated, never over-estimated
+    smtc_duty_cycle_band_tx( band_obj, i + 1 )->toa_ms += smtc_duty_cycle_band_tx( band_obj, i )->toa_ms;
+
+    // Shift the older uplinks one slot towards the newest and drop the first slot
+    for( uint8_t j = i; j > 0; j-- )
+    {
+        *smtc_duty_cycle_band_tx( band_obj, j ) = *smtc_duty_cycle_band_tx( band_obj, j - 1 );
+    }
+    band_obj->tx_first = ( band_obj->tx_first + 1 ) % SMTC_DTC_TX_LOG_SIZE;
+    band_obj->tx_count--;
+}
+
+static inline uint32_t smtc_duty_cycle_tx_time_left( const smtc_dtc_tx_t* tx, uint32_t rtc_ms )
+{
+    uint32_t age_ms = rtc_ms - tx->timestamp_ms;
+    return ( age_ms < SMTC_DTC_PERIOD_MS ) ? ( SMTC_DTC_PERIOD_MS - age_ms ) : 0;
 }
 
-static inline uint32_t smtc_duty_cycle_time_diff( uint32_t rtc_ms, uint32_t timestamp_ms )
+static inline bool smtc_duty_cycle_toa_fits( int32_t available_toa_ms, uint32_t toa_ms )
 {
-    return ( rtc_ms - ( timestamp_ms - ( timestamp_ms % ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) ) ) );
+    return ( available_toa_ms > 0 ) && ( ( uint32_t ) available_toa_ms >= toa_ms );
 }
 
 static void smtc_duty_cycle_put_band_in_array( smtc_dtc_t* dtc_obj, uint8_t* tmp_band, uint8_t band,
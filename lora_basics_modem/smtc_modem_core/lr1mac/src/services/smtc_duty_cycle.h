@@ -58,21 +58,20 @@ extern "C" {
 // clang-format off
 #define SMTC_DTC_BANDS_MAX          ( 6 )                      // Number of ETSI band supported by this algo
 #define SMTC_DTC_PERIOD_MS          ( 3600000UL )              // Number of miliseconds in one period (3600000 for period 1h)
-#define SMTC_DTC_SECONDS_BY_UNIT    ( 120 )                    // Sum TOA by step of N seconds, MIN VALUE IS 60s to avoid division by 0
-#define SMTC_DTC_TOA_BUFF_SIZE      ( ( SMTC_DTC_PERIOD_MS / 1000UL ) / SMTC_DTC_SECONDS_BY_UNIT )  // Buffer size to sum all TOA over one period
-
-#if SMTC_DTC_SECONDS_BY_UNIT < 60
-#warning "SMTC_DTC_SECONDS_BY_UNIT must be greater or equal to 60"
-#undef SMTC_DTC_SECONDS_BY_UNIT
-#define SMTC_DTC_SECONDS_BY_UNIT 60
-#endif
+#define SMTC_DTC_TX_LOG_SIZE        ( 16 )                     // Number of uplinks remembered by band over one period
 
 //
 // Represention of the current configuration
 //
-// index                       0     1     2                  28    29   0
-// 16bits array to save TOA {[    ][    ][    ][    ...    ][    ][    ][    ]}
-// RTC                       0s    120s  240s  360s         3360s 3480s 3600s
+// Each band keeps the uplinks of the last period, oldest first, and their TOA sum
+//
+// tx_log       {[ts0, toa0][ts1, toa1] ... [tsN, toaN]}    toa_sum_ms = toa0 + toa1 + ... + toaN
+// RTC           ts0 + SMTC_DTC_PERIOD_MS: toa0 leaves the period and is removed from toa_sum_ms
+//
+// A logged uplink holds the TOA sent after the previous one, tx_floor_ms for the oldest. When the log is full an
+// uplink is merged into the next one, the new uplink into the newest one, choosing the merge whose entry spans the
+// least time: the merged TOA leaves the period when the newer uplink does, late by at most that span. The budget can
+// only be under-estimated, never over-estimated, and the entries end up spanning about equal slices of the period.
 //
 
 // clang-format on
@@ -87,14 +86,22 @@ typedef enum smtc_dtc_enablement_type_e
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
  */
+typedef struct smtc_dtc_tx_s
+{
+    uint32_t timestamp_ms;  // end of the uplink, it leaves the period SMTC_DTC_PERIOD_MS later
+    uint32_t toa_ms;
+} smtc_dtc_tx_t;
+
 typedef struct smtc_dtc_band_s
 {
-    uint32_t freq_min;
-    uint32_t freq_max;
-    uint16_t duty_cycle_regulation;  // 1000->0.1%, 100->1%, 10->10%
-    uint32_t toa_timestamp_ms;       // last access to the array when adding the TOA or reset all TOA
-    uint8_t  index_previous;
-    uint16_t toa_sum_ms[SMTC_DTC_TOA_BUFF_SIZE];  // Store all TOA by step of SMTC_DTC_SECONDS_BY_UNIT
+    uint32_t      freq_min;
+    uint32_t      freq_max;
+    uint16_t      duty_cycle_regulation;  // 1000->0.1%, 100->1%, 10->10%
+    uint32_t      toa_sum_ms;             // Sum of the TOA in tx_log
+    uint32_t      tx_floor_ms;            // Timestamp the oldest uplink of tx_log started after
+    uint8_t       tx_first;               // Index of the oldest uplink in tx_log
+    uint8_t       tx_count;               // Number of uplinks in tx_log
+    smtc_dtc_tx_t tx_log[SMTC_DTC_TX_LOG_SIZE];
 } smtc_dtc_band_t;
 
 typedef struct smtc_dtc_s
@@ -104,13 +111,6 @@ typedef struct smtc_dtc_s
     smtc_dtc_band_t            bands[SMTC_DTC_BANDS_MAX];
 } smtc_dtc_t;
 
-/**
- * @brief the resolution is the number of bits per SMTC_DTC_SECONDS_BY_UNIT
- * @remark 16 represents the number of bits to save the TOA
- *          ceil(120s/65536) -> ceil(0.001831055) -> 2ms per bit
- */
-static const uint32_t smtc_dtc_resolution_ms = ( ( ( SMTC_DTC_SECONDS_BY_UNIT * 1000 ) / ( 1 << ( 16 ) ) ) + 1 );
-
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -167,9 +167,10 @@ smtc_dtc_enablement_type_t smtc_duty_cycle_enable_get( smtc_dtc_t* dtc_obj );
 void smtc_duty_cycle_sum( smtc_dtc_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms );
 
 /**
- * @brief  Update Time On Air
+ * @brief  Update Time On Air, removing the uplinks that left the period
  *
- * @remark smtc_duty_cycle_update() must be called before check Duty Cycle available
+ * @remark smtc_duty_cycle_update() must be called before check Duty Cycle available. Each uplink is removed once, so
+ *         the cost does not depend on the time elapsed since the previous call
  *
  * @param dtc_obj                   Contains the duty cycle context
  */
@@ -231,6 +232,36 @@ bool smtc_duty_cycle_is_band_free( smtc_dtc_t* dtc_obj, uint8_t band );
  * @return int32_t                  milliseconds, if > 0: the next slot availble, else the available time
  */
 int32_t smtc_duty_cycle_get_next_free_time_ms( smtc_dtc_t* dtc_obj, uint8_t number_of_tx_freq, uint32_t* tx_freq_list );
+
+/**
+ * @brief Get the time until a Time On Air is available in a band
+ *
+ * @remark  smtc_duty_cycle_update() must be called before this function to have a right value. The time is exact: it
+ *          is when enough of the logged uplinks have left the period.
+ *
+ * @param dtc_obj                   Contains the duty cycle context
+ * @param band                      Band id
+ * @param toa_ms                    Time On Air needed in milliseconds, 0 for any
+ * @return int32_t                  milliseconds to wait, 0 if available now, -1 if more than the band allows
+ */
+int32_t smtc_duty_cycle_band_get_next_free_time_ms( smtc_dtc_t* dtc_obj, uint8_t band, uint32_t toa_ms );
+
+/**
+ * @brief Get the time to wait before a burst of same-size uplinks fits the duty cycle
+ *
+ * @remark  Each band takes as many frames as its remaining TOA allows, and that TOA grows back each time one of its
+ *          logged uplinks leaves the period. smtc_duty_cycle_update() is called internally.
+ *
+ * @param dtc_obj                   Contains the duty cycle context
+ * @param number_of_tx_freq         number of tx freq in list
+ * @param tx_freq_list              tx frequency list used by the app to check only duty cycle in these bands
+ * @param toa_ms                    Time On Air of one frame in milliseconds
+ * @param count                     Number of frames in the burst
+ * @param available_toa_ms          [out] Time On Air available now in these bands, INT32_MAX if not enforced
+ * @return int32_t                  milliseconds to wait before the burst fits, -1 if it never fits in one period
+ */
+int32_t smtc_duty_cycle_plan_burst_ms( smtc_dtc_t* dtc_obj, uint8_t number_of_tx_freq, uint32_t* tx_freq_list,
+                                       uint32_t toa_ms, uint8_t count, int32_t* available_toa_ms );
 #ifdef __cplusplus
 }
 #endif
@@ -2258,6 +2258,27 @@ smtc_modem_return_code_t smtc_modem_get_duty_cycle_status( int32_t* duty_cycle_s
     return SMTC_MODEM_RC_OK;
 }
 
+smtc_modem_return_code_t smtc_modem_get_airtime_plan( uint8_t stack_id, uint8_t datarate, uint8_t payload_length,
+                                                      uint8_t count, smtc_modem_airtime_plan_t* plan )
+{
+    UNUSED( stack_id );
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( plan );
+
+    lr1mac_airtime_plan_t lr1mac_plan;
+    if( lorawan_api_airtime_plan_get( datarate, payload_length, count, &lr1mac_plan ) != OKLORAWAN )
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+
+    plan->toa_ms           = lr1mac_plan.toa_ms;
+    plan->burst_toa_ms     = lr1mac_plan.burst_toa_ms;
+    plan->frame_gap_ms     = lr1mac_plan.frame_gap_ms;
+    plan->band_budget_ms   = lr1mac_plan.band_budget_ms;
+    plan->earliest_send_ms = lr1mac_plan.earliest_send_ms;
+    return SMTC_MODEM_RC_OK;
+}
+
 smtc_modem_return_code_t smtc_modem_rp_abort_user_radio_access_task( uint8_t user_task_id )
 {
 #if !defined( LR1110_MODEM_E )
@@ -47,9 +47,26 @@
  * @brief rp_task_free to free a task
  *
  * @param rp  pointer to the radioplaner object itself
- * @param task pointer to the task that function free
+ * @param id id of the task that function free
  */
-static void rp_task_free( const radio_planner_t* rp, rp_task_t* task );
+static void rp_task_free( radio_planner_t* rp, const uint8_t id );
+
+/**
+ * @brief rp_task_set_state change the state of a task and keep the active/aborted masks in sync
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param id id of the targeted task
+ * @param state the new state
+ */
+static void rp_task_set_state( radio_planner_t* rp, const uint8_t id, const rp_task_states_t state );
+
+/**
+ * @brief rp_mask_first_id return the lowest hook id set in a non empty mask
+ *
+ * @param mask a non empty hook mask
+ * @return uint8_t the lowest hook id of the mask
+ */
+static uint8_t rp_mask_first_id( uint32_t mask );
 
 /**
  * @brief rp_task_update_time update task time
@@ -76,11 +93,12 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
 static void rp_irq_get_status( radio_planner_t* rp, const uint8_t hook_id );
 
 /**
- * @brief rp_task_compute_ranking compute the ranking of the different tasks inside the radio planer
+ * @brief rp_task_update_ranking move a task to its place in the ranking after its priority changed
  *
  * @param rp pointer to the radioplaner object itself
+ * @param id id of the task whose priority changed
  */
-static void rp_task_compute_ranking( radio_planner_t* rp );
+static void rp_task_update_ranking( radio_planner_t* rp, const uint8_t id );
 
 /**
  * @brief rp_task_launch_current call  the launch callback of the new running task
@@ -110,13 +128,12 @@ static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now );
 static rp_next_state_status_t rp_task_get_next( radio_planner_t* rp, uint32_t* duration, uint8_t* task_id,
                                                 const uint32_t now );
 /**
- * @brief rp_task_find_highest_priority utilities to classify priority task (value 0 is the highest priority)
+ * @brief rp_task_garbage_collect abort the scheduled tasks whose start time is in the past
  *
- * @param vector a vector of value to classify from the lowest to the highest
- * @param length size of the vector
- * @return uint8_t index of the vector to indicate the position inside the vector of the minimum value
+ * @param rp pointer to the radioplaner object itself
+ * @param now the current time in ms
  */
-static uint8_t rp_task_find_highest_priority( uint8_t* vector, uint8_t length );
+static void rp_task_garbage_collect( radio_planner_t* rp, const uint32_t now );
 
 /**
  * @brief rp_get_pkt_payload get the receive payload
@@ -192,6 +209,13 @@ static void rp_task_print( const radio_planner_t* rp, const rp_task_t* task );
 
 void rp_init( radio_planner_t* rp, const ralf_t* radio )
 {
+    // active_mask and aborted_mask hold one bit per hook
+    if( RP_NB_HOOKS > 32 )
+    {
+        smtc_modem_hal_mcu_panic( );
+        return;
+    }
+
     memset( rp, 0, sizeof( radio_planner_t ) );
     rp->radio = radio;
 
@@ -206,6 +230,8 @@ void rp_init( radio_planner_t* rp, const ralf_t* radio )
         rp->tasks[i].launch_task_callbacks      = NULL;
         rp->hook_callbacks[i]                   = NULL;
         rp->status[i]                           = RP_STATUS_TASK_INIT;
+        // All priorities are 0 here, equal priorities are ranked from the highest hook id
+        rp->rankings[i] = RP_NB_HOOKS - 1 - i;
     }
     rp->priority_task.type  = RP_TASK_TYPE_NONE;
     rp->priority_task.state = RP_TASK_STATE_FINISHED;
@@ -298,6 +324,7 @@ rp_hook_status_t rp_task_enqueue( radio_planner_t* rp, const rp_task_t* task, ui
     }
     rp->status[hook_id]       = RP_STATUS_TASK_INIT;
     rp->tasks[hook_id]        = *task;
+    rp_task_set_state( rp, hook_id, task->state );
     rp->radio_params[hook_id] = *radio_params;
     rp->payload[hook_id]      = payload;
     rp->payload_size[hook_id] = payload_size;
@@ -311,7 +338,7 @@ rp_hook_status_t rp_task_enqueue( radio_planner_t* rp, const rp_task_t* task, ui
     }
     rp->tasks[hook_id].start_time_init_ms = rp->tasks[hook_id].start_time_ms;
     SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: Task #%u enqueue with #%u priority\n", hook_id, rp->tasks[hook_id].priority );
-    rp_task_compute_ranking( rp );
+    rp_task_update_ranking( rp, hook_id );
     if( rp->semaphore_radio == 0 )
     {
         rp_task_arbiter( rp, __func__ );
@@ -343,7 +370,7 @@ rp_hook_status_t rp_task_abort( radio_planner_t* rp, const uint8_t hook_id )
     }
     else
     {
-        rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
+        rp_task_set_state( rp, hook_id, RP_TASK_STATE_ABORTED );
 
         if( rp->semaphore_radio == 0 )
         {
@@ -418,7 +445,7 @@ void rp_radio_irq( radio_planner_t* rp )
 
         // Have to call rp_task_free before rp_hook_callback because the callback can enqueued a task and so call the
         // arbiter
-        rp_task_free( rp, &rp->tasks[rp->radio_task_id] );
+        rp_task_free( rp, rp->radio_task_id );
         smtc_modem_hal_assert( ral_set_sleep( &( rp->radio->ral ), true ) == RAL_STATUS_OK );
         rp_hook_callback( rp, rp->radio_task_id );
 
@@ -440,21 +467,58 @@ void rp_radio_irq( radio_planner_t* rp )
 // Private planner utilities implementation
 //
 
-static void rp_task_free( const radio_planner_t* rp, rp_task_t* task )
+static void rp_task_free( radio_planner_t* rp, const uint8_t id )
 {
+    rp_task_t* task = &rp->tasks[id];
+
     task->hook_id            = RP_NB_HOOKS;
     task->start_time_ms      = 0;
     task->start_time_init_ms = 0;
     task->duration_time_ms   = 0;
     //   task->type               = RP_TASK_TYPE_NONE; doesn't clear for suspend feature
-    task->state                      = RP_TASK_STATE_FINISHED;
+    rp_task_set_state( rp, id, RP_TASK_STATE_FINISHED );
     task->schedule_task_low_priority = false;
 }
 
+static void rp_task_set_state( radio_planner_t* rp, const uint8_t id, const rp_task_states_t state )
+{
+    uint32_t mask = ( uint32_t ) 1 << id;
+
+    rp->tasks[id].state = state;
+    rp->active_mask &= ~mask;
+    rp->aborted_mask &= ~mask;
+    if( state <= RP_TASK_STATE_RUNNING )
+    {
+        rp->active_mask |= mask;
+    }
+    else if( state == RP_TASK_STATE_ABORTED )
+    {
+        rp->aborted_mask |= mask;
+    }
+}
+
+static uint8_t rp_mask_first_id( uint32_t mask )
+{
+#if defined( __GNUC__ )
+    return ( uint8_t ) __builtin_ctz( mask );
+#else
+    uint8_t id = 0;
+
+    while( ( mask & 1 ) == 0 )
+    {
+        mask >>= 1;
+        id++;
+    }
+    return id;
+#endif
+}
+
 static void rp_task_update_time( radio_planner_t* rp, uint32_t now )
 {
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    for( uint32_t active = rp->active_mask; active != 0; active &= active - 1 )
     {
+        uint8_t i = rp_mask_first_id( active );
+
         if( rp->tasks[i].state == RP_TASK_STATE_ASAP )
         {
             if( ( int32_t )( now - rp->tasks[i].start_time_init_ms ) > 0 )
@@ -465,7 +529,7 @@ static void rp_task_update_time( radio_planner_t* rp, uint32_t now )
 
             if( ( int32_t )( now - rp->tasks[i].start_time_init_ms ) > RP_TASK_ASAP_TO_SCHEDULE_TRIG_TIME )
             {
-                rp->tasks[i].state = RP_TASK_STATE_SCHEDULE;
+                rp_task_set_state( rp, i, RP_TASK_STATE_SCHEDULE );
                 // Schedule the task @ now + RP_TASK_RE_SCHEDULE_OFFSET_TIME
                 // seconds
                 rp->tasks[i].start_time_ms = now + RP_TASK_RE_SCHEDULE_OFFSET_TIME;
@@ -479,7 +543,7 @@ static void rp_task_update_time( radio_planner_t* rp, uint32_t now )
                 }
 
                 SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: WARNING - SWITCH TASK FROM ASAP TO SCHEDULE \n" );
-                rp_task_compute_ranking( rp );
+                rp_task_update_ranking( rp, i );
             }
         }
     }
@@ -518,7 +582,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
                 rp->stats.rp_error++;
                 SMTC_MODEM_HAL_TRACE_ERROR( " RP: ERROR - delay #%d - hook #%d\n", delay, rp->priority_task.hook_id );
 
-                rp->tasks[rp->priority_task.hook_id].state = RP_TASK_STATE_ABORTED;
+                rp_task_set_state( rp, rp->priority_task.hook_id, RP_TASK_STATE_ABORTED );
             }
         }
         // Case where the high priority task is in the future
@@ -533,7 +597,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
             {  // Radio is already running
                 if( rp->tasks[rp->radio_task_id].hook_id != rp->priority_task.hook_id )
                 {  // priority task not equal to radio task => abort radio task
-                    rp->tasks[rp->radio_task_id].state = RP_TASK_STATE_ABORTED;
+                    rp_task_set_state( rp, rp->radio_task_id, RP_TASK_STATE_ABORTED );
                     SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: Abort running task with hook #%u\n", rp->radio_task_id );
 
                     smtc_modem_hal_assert( ral_set_standby( &( rp->radio->ral ), RAL_STANDBY_CFG_RC ) ==
@@ -549,15 +613,15 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
 
                     rp_consumption_statistics_updated( rp, rp->radio_task_id, rp_hal_get_time_in_ms( ) );
 
-                    rp->radio_task_id                  = rp->priority_task.hook_id;
-                    rp->tasks[rp->radio_task_id].state = RP_TASK_STATE_RUNNING;
+                    rp->radio_task_id = rp->priority_task.hook_id;
+                    rp_task_set_state( rp, rp->radio_task_id, RP_TASK_STATE_RUNNING );
                     rp_task_launch_current( rp );
                 }  // else case already managed during enqueue task
             }
             else
             {  // Radio is sleeping start priority task on radio
-                rp->radio_task_id                  = rp->priority_task.hook_id;
-                rp->tasks[rp->radio_task_id].state = RP_TASK_STATE_RUNNING;
+                rp->radio_task_id = rp->priority_task.hook_id;
+                rp_task_set_state( rp, rp->radio_task_id, RP_TASK_STATE_RUNNING );
                 rp_task_launch_current( rp );
             }
         }
@@ -572,7 +636,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
             {
                 SMTC_MODEM_HAL_TRACE_WARNING( " RP: Aborted task with hook #%u - not a priority task\n ",
                                               rp->timer_hook_id );
-                rp->tasks[rp->timer_hook_id].state = RP_TASK_STATE_ABORTED;
+                rp_task_set_state( rp, rp->timer_hook_id, RP_TASK_STATE_ABORTED );
             }
         }
         // Execute the garbage collection if the radio isn't running
@@ -680,21 +744,38 @@ static void rp_irq_get_status( radio_planner_t* rp, const uint8_t hook_id )
     }
 }
 
-static void rp_task_compute_ranking( radio_planner_t* rp )
+static void rp_task_update_ranking( radio_planner_t* rp, const uint8_t id )
 {
-    uint8_t rank;
-    uint8_t ranks_temp[RP_NB_HOOKS];
+    uint8_t priority = rp->tasks[id].priority;
+    uint8_t pos      = 0;
+    uint8_t low      = 0;
+    uint8_t high     = RP_NB_HOOKS - 1;
 
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    // The other tasks keep their relative order, take this one out and insert it back at its new place
+    while( rp->rankings[pos] != id )
     {
-        ranks_temp[i] = rp->tasks[i].priority;
+        pos++;
     }
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    memmove( &rp->rankings[pos], &rp->rankings[pos + 1], RP_NB_HOOKS - 1 - pos );
+
+    // Lowest priority value first, equal priorities are ranked from the highest hook id
+    while( low < high )
     {
-        rank             = rp_task_find_highest_priority( &( ranks_temp[0] ), RP_NB_HOOKS );
-        ranks_temp[rank] = 0xFF;
-        rp->rankings[i]  = rank;
+        uint8_t mid   = ( low + high ) / 2;
+        uint8_t other = rp->rankings[mid];
+
+        if( ( rp->tasks[other].priority < priority ) ||
+            ( ( rp->tasks[other].priority == priority ) && ( other > id ) ) )
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
     }
+    memmove( &rp->rankings[low + 1], &rp->rankings[low], RP_NB_HOOKS - 1 - low );
+    rp->rankings[low] = id;
 }
 
 static void rp_task_launch_current( radio_planner_t* rp )
@@ -718,41 +799,43 @@ static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now )
     uint8_t  hook_to_exe_tmp      = 0xFF;
     uint32_t hook_time_to_exe_tmp = 0;
     uint32_t time_tmp             = 0;
+    uint32_t candidates           = 0;
     uint8_t  rank                 = 0;
-    uint8_t  hook_id              = 0;
+    uint8_t  i                    = 0;
 
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
-    {  // Garbage collector
-        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_SCHEDULE ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - now ) < 0 ) ) )
-        {
-            rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
-        }
-    }
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
+    rp_task_garbage_collect( rp, now );
+
+    // Candidates are the running task and the pending tasks which are not in the past
+    for( uint32_t active = rp->active_mask; active != 0; active &= active - 1 )
     {
-        rank = rp->rankings[hook_id];
-        if( ( ( rp->tasks[rank].state < RP_TASK_STATE_RUNNING ) &&
-              ( ( int32_t )( rp->tasks[rank].start_time_ms - now ) >= 0 ) ) ||
-            ( rp->tasks[rank].state == RP_TASK_STATE_RUNNING ) )
+        uint8_t hook_id = rp_mask_first_id( active );
+
+        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_RUNNING ) ||
+            ( ( int32_t )( rp->tasks[hook_id].start_time_ms - now ) >= 0 ) )
         {
-            hook_to_exe_tmp      = rp->tasks[rank].hook_id;
-            hook_time_to_exe_tmp = rp->tasks[rank].start_time_ms;
-            break;
+            candidates |= ( uint32_t ) 1 << hook_id;
         }
     }
-    if( hook_id == RP_NB_HOOKS )
+    if( candidates == 0 )
     {
         return RP_NO_MORE_TASK;
     }
 
-    for( int32_t i = hook_id; i < RP_NB_HOOKS; i++ )
+    // The best ranked candidate is the priority task ...
+    for( i = 0; ( candidates & ( ( uint32_t ) 1 << rp->rankings[i] ) ) == 0; i++ )
+    {
+    }
+    rank                 = rp->rankings[i];
+    hook_to_exe_tmp      = rp->tasks[rank].hook_id;
+    hook_time_to_exe_tmp = rp->tasks[rank].start_time_ms;
+
+    // ... unless a lower ranked candidate can be completed before it starts
+    for( ; ( i < RP_NB_HOOKS ) && ( candidates != 0 ); i++ )
     {
         rank = rp->rankings[i];
-        if( ( ( rp->tasks[rank].state < RP_TASK_STATE_RUNNING ) &&
-              ( ( int32_t )( rp->tasks[rank].start_time_ms - now ) >= 0 ) ) ||
-            ( rp->tasks[rank].state == RP_TASK_STATE_RUNNING ) )
+        if( ( candidates & ( ( uint32_t ) 1 << rank ) ) != 0 )
         {
+            candidates &= ~( ( uint32_t ) 1 << rank );
             time_tmp = rp->tasks[rank].start_time_ms + rp->tasks[rank].duration_time_ms;
 
             int32_t tmp = ( int32_t )( time_tmp - hook_time_to_exe_tmp );
@@ -770,62 +853,46 @@ static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now )
 static rp_next_state_status_t rp_task_get_next( radio_planner_t* rp, uint32_t* duration, uint8_t* task_id,
                                                 const uint32_t now )
 {
-    uint8_t  hook_id  = 0;
-    uint8_t  index    = 0;
+    uint8_t  index    = 0xFF;
     uint32_t time_tmp = now;
 
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
-    {  // Garbage collector
-        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_SCHEDULE ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - time_tmp ) < 0 ) ) )
-        {
-            rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
-        }
-    }
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
+    rp_task_garbage_collect( rp, now );
+
+    // Earliest pending task, the lowest hook id wins on equal start times
+    for( uint32_t active = rp->active_mask; active != 0; active &= active - 1 )
     {
+        uint8_t hook_id = rp_mask_first_id( active );
+
         if( ( rp->tasks[hook_id].state < RP_TASK_STATE_RUNNING ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - time_tmp ) >= 0 ) ) )
+            ( ( int32_t )( rp->tasks[hook_id].start_time_ms - now ) >= 0 ) &&
+            ( ( index == 0xFF ) || ( ( int32_t )( rp->tasks[hook_id].start_time_ms - time_tmp ) < 0 ) ) )
         {
             time_tmp = rp->tasks[hook_id].start_time_ms;
             index    = hook_id;
-            break;
         }
     }
-    if( hook_id == RP_NB_HOOKS )
+    if( index == 0xFF )
     {
         return RP_STATUS_NO_MORE_TASK_SCHEDULE;
     }
 
-    for( uint8_t i = hook_id; i < RP_NB_HOOKS; i++ )
-    {
-        if( ( rp->tasks[i].state < RP_TASK_STATE_RUNNING ) &&
-            ( ( int32_t )( rp->tasks[i].start_time_ms - time_tmp ) < 0 ) &&
-            ( ( int32_t )( rp->tasks[i].start_time_ms - now ) >= 0 ) )
-        {
-            time_tmp = rp->tasks[i].start_time_ms;
-            index    = i;
-        }
-    }
     *task_id  = index;
     *duration = time_tmp - now;
     return RP_STATUS_HAVE_TO_SET_TIMER;
 }
 
-static uint8_t rp_task_find_highest_priority( uint8_t* vector, uint8_t length )
+static void rp_task_garbage_collect( radio_planner_t* rp, const uint32_t now )
 {
-    uint8_t priority_high = 0xFF;
-    uint8_t index         = 0;
-
-    for( int32_t i = 0; i < length; i++ )
+    for( uint32_t active = rp->active_mask; active != 0; active &= active - 1 )
     {
-        if( vector[i] <= priority_high )
+        uint8_t hook_id = rp_mask_first_id( active );
+
+        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_SCHEDULE ) &&
+            ( ( int32_t )( rp->tasks[hook_id].start_time_ms - now ) < 0 ) )
         {
-            priority_high = vector[i];
-            index         = i;
+            rp_task_set_state( rp, hook_id, RP_TASK_STATE_ABORTED );
         }
     }
-    return index;
 }
 
 rp_hook_status_t rp_get_pkt_payload( radio_planner_t* rp, const rp_task_t* task )
@@ -877,16 +944,22 @@ static void rp_timer_irq( radio_planner_t* rp )
 
 static void rp_task_call_aborted( radio_planner_t* rp )
 {
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    // The mask is read again after each callback, as a callback can enqueue or abort other tasks
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
     {
-        if( rp->tasks[i].state == RP_TASK_STATE_ABORTED )
+        uint32_t aborted = rp->aborted_mask >> i;
+
+        if( aborted == 0 )
         {
-            SMTC_MODEM_HAL_RP_TRACE_PRINTF( " RP: INFO - Aborted hook # %d callback\n", i );
-            rp->stats.task_hook_aborted_nb[i]++;
-            rp_task_free( rp, &rp->tasks[i] );
-            rp->status[i] = RP_STATUS_TASK_ABORTED;
-            rp_hook_callback( rp, i );
+            break;
         }
+        i += rp_mask_first_id( aborted );
+
+        SMTC_MODEM_HAL_RP_TRACE_PRINTF( " RP: INFO - Aborted hook # %d callback\n", i );
+        rp->stats.task_hook_aborted_nb[i]++;
+        rp_task_free( rp, i );
+        rp->status[i] = RP_STATUS_TASK_ABORTED;
+        rp_hook_callback( rp, i );
     }
 }
 
@@ -79,6 +79,8 @@ typedef struct radio_planner_s
     uint8_t*          payload[RP_NB_HOOKS];
     uint16_t          payload_size[RP_NB_HOOKS];
     uint8_t           rankings[RP_NB_HOOKS];
+    uint32_t          active_mask;
+    uint32_t          aborted_mask;
     void*             hooks[RP_NB_HOOKS];
     rp_status_t       status[RP_NB_HOOKS];
     ral_irq_t         raw_radio_irq[RP_NB_HOOKS];
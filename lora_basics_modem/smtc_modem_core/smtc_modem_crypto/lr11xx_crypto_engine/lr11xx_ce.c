@@ -326,6 +326,46 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
     return status;
 }
 
+smtc_se_return_code_t smtc_secure_element_aes_ctr_encrypt( const uint8_t* buffer, uint16_t size,
+                                                           smtc_se_key_identifier_t key_id,
+                                                           const uint8_t a_block[16], uint8_t* enc_buffer )
+{
+    if( ( buffer == NULL ) || ( enc_buffer == NULL ) || ( a_block == NULL ) )
+    {
+        return SMTC_SE_RC_ERROR_NPE;
+    }
+
+    uint8_t  ctr_block[16];
+    uint8_t  s_block[16];
+    uint16_t ctr   = ( ( uint16_t ) a_block[14] << 8 ) | a_block[15];
+    uint16_t index = 0;
+
+    memcpy( ctr_block, a_block, 16 );
+
+    // The key stays in the LR11xx, one counter block per request
+    while( index < size )
+    {
+        uint16_t              len = ( ( size - index ) > 16 ) ? 16 : ( size - index );
+        smtc_se_return_code_t rc;
+
+        ctr_block[14] = ( ctr >> 8 ) & 0xFF;
+        ctr_block[15] = ctr & 0xFF;
+        ctr++;
+
+        rc = smtc_secure_element_aes_encrypt( ctr_block, 16, key_id, s_block );
+        if( rc != SMTC_SE_RC_SUCCESS )
+        {
+            return rc;
+        }
+        for( uint16_t i = 0; i < len; i++ )
+        {
+            enc_buffer[index + i] = buffer[index + i] ^ s_block[i];
+        }
+        index += len;
+    }
+    return SMTC_SE_RC_SUCCESS;
+}
+
 smtc_se_return_code_t smtc_secure_element_derive_and_store_key( uint8_t* input, smtc_se_key_identifier_t rootkey_id,
                                                                 smtc_se_key_identifier_t targetkey_id )
 {
@@ -203,6 +203,23 @@ smtc_se_return_code_t smtc_secure_element_verify_aes_cmac( uint8_t* buffer, uint
 smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, uint16_t size,
                                                        smtc_se_key_identifier_t key_id, uint8_t* enc_buffer );
 
+/**
+ * @brief Encrypt or decrypt a buffer in AES-CTR mode
+ *
+ * Key stream block i is the encryption of a_block with i added to its last
+ * two bytes (big endian counter), as in LoRaWAN FRMPayload encryption.
+ *
+ * @param [in] buffer Data buffer
+ * @param [in] size Data buffer size, any length
+ * @param [in] key_id Key identifier to determine the AES key to be used
+ * @param [in] a_block First counter block
+ * @param [out] enc_buffer Encrypted buffer, may be buffer
+ * @return Secure element return code as defined in @ref smtc_se_return_code_t
+ */
+smtc_se_return_code_t smtc_secure_element_aes_ctr_encrypt( const uint8_t* buffer, uint16_t size,
+                                                           smtc_se_key_identifier_t key_id,
+                                                           const uint8_t a_block[16], uint8_t* enc_buffer );
+
 /**
  * @brief Derives and store a key
  *
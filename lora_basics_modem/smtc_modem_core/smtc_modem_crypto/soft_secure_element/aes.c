@@ -64,6 +64,20 @@
 
 #include "aes.h"
 
+/* the byte-oriented rounds are needed unless the table-driven encryption
+   replaces them and no 'on the fly' encryption is enabled */
+#if ( AES_ENC_TTABLES == 0 ) || defined( AES_ENC_128_OTFK ) || defined( AES_ENC_256_OTFK )
+#  define BYTE_ENC_ROUNDS
+#endif
+
+#if ( AES_ENC_TTABLES != 0 ) && ( AES_ENC_TTABLES != 1 ) && ( AES_ENC_TTABLES != 4 )
+#  error AES_ENC_TTABLES must be 0, 1 or 4
+#endif
+
+#if ( AES_ENC_TTABLES != 0 ) && !defined( USE_TABLES )
+#  error AES_ENC_TTABLES needs USE_TABLES
+#endif
+
 //#if defined( HAVE_UINT_32T )
 //  typedef unsigned long uint32_t;
 //#endif
@@ -197,8 +211,10 @@ static const uint8_t sbox[256]  =  sb_data(f1);
 static const uint8_t isbox[256] = isb_data(f1);
 #endif
 
+#if defined( BYTE_ENC_ROUNDS )
 static const uint8_t gfm2_sbox[256] = sb_data(f2);
 static const uint8_t gfm3_sbox[256] = sb_data(f3);
+#endif
 
 #if defined( AES_DEC_PREKEYED )
 static const uint8_t gfmul_9[256] = mm_data(f9);
@@ -373,6 +389,9 @@ static void xor_block( void *d, const void *s )
 #endif
 }
 
+#if defined( BYTE_ENC_ROUNDS ) || defined( AES_DEC_PREKEYED ) \
+ || defined( AES_DEC_128_OTFK ) || defined( AES_DEC_256_OTFK )
+
 static void copy_and_key( void *d, const void *s, const void *k )
 {
 #if defined( HAVE_UINT_32T )
@@ -408,6 +427,10 @@ static void add_round_key( uint8_t d[N_BLOCK], const uint8_t k[N_BLOCK] )
     xor_block(d, k);
 }
 
+#endif
+
+#if defined( BYTE_ENC_ROUNDS )
+
 static void shift_sub_rows( uint8_t st[N_BLOCK] )
 {   uint8_t tt;
 
@@ -424,6 +447,8 @@ static void shift_sub_rows( uint8_t st[N_BLOCK] )
     st[ 7] = s_box(st[ 3]); st[ 3] = s_box( tt );
 }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
@@ -444,6 +469,8 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
 
 #endif
 
+#if defined( BYTE_ENC_ROUNDS )
+
 #if defined( VERSION_1 )
   static void mix_sub_columns( uint8_t dt[N_BLOCK] )
   { uint8_t st[N_BLOCK];
@@ -473,6 +500,69 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
     dt[15] = gfm3_sb(st[12]) ^ s_box(st[1]) ^ s_box(st[6]) ^ gfm2_sb(st[11]);
   }
 
+#endif
+
+#if ( AES_ENC_TTABLES != 0 )
+
+/*  32-bit column rounds. A column is held in a word with row 0 in the
+    low byte, so that the tables read the same on any host. Each table
+    entry combines the S box with one column of the MixColumns matrix:
+    t_fn0[x] = ( 2.s, s, s, 3.s ) for s = S[x] and rows 0 to 3, and
+    t_fn1 to t_fn3 are the same words rotated by one, two and three rows */
+
+#define tw0(x)  ( (uint32_t)f2(x) | ((uint32_t)(x) << 8) | ((uint32_t)(x) << 16) | ((uint32_t)f3(x) << 24) )
+#define tw1(x)  ( (uint32_t)f3(x) | ((uint32_t)f2(x) << 8) | ((uint32_t)(x) << 16) | ((uint32_t)(x) << 24) )
+#define tw2(x)  ( (uint32_t)(x) | ((uint32_t)f3(x) << 8) | ((uint32_t)f2(x) << 16) | ((uint32_t)(x) << 24) )
+#define tw3(x)  ( (uint32_t)(x) | ((uint32_t)(x) << 8) | ((uint32_t)f3(x) << 16) | ((uint32_t)f2(x) << 24) )
+
+static const uint32_t t_fn[AES_ENC_TTABLES][256] =
+{
+    sb_data(tw0),
+#if ( AES_ENC_TTABLES == 4 )
+    sb_data(tw1),
+    sb_data(tw2),
+    sb_data(tw3)
+#endif
+};
+
+#if ( AES_ENC_TTABLES == 4 )
+#  define t_fn0(x)  t_fn[0][(x)]
+#  define t_fn1(x)  t_fn[1][(x)]
+#  define t_fn2(x)  t_fn[2][(x)]
+#  define t_fn3(x)  t_fn[3][(x)]
+#else
+#  define rot_rows(w, n)  ( ((w) << (8 * (n))) | ((w) >> (32 - 8 * (n))) )
+#  define t_fn0(x)  t_fn[0][(x)]
+#  define t_fn1(x)  rot_rows(t_fn[0][(x)], 1)
+#  define t_fn2(x)  rot_rows(t_fn[0][(x)], 2)
+#  define t_fn3(x)  rot_rows(t_fn[0][(x)], 3)
+#endif
+
+#define bval(w, r)      ( (uint8_t)((w) >> (8 * (r))) )
+
+#define word_in(p)      ( (uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) \
+                        | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24) )
+
+#define word_out(p, w)  do { (p)[0] = (uint8_t)(w); (p)[1] = (uint8_t)((w) >> 8); \
+                             (p)[2] = (uint8_t)((w) >> 16); (p)[3] = (uint8_t)((w) >> 24); } while( 0 )
+
+/* one full round: SubBytes, ShiftRows and MixColumns from the tables,
+   then AddRoundKey. Row r of output column c comes from column c + r */
+#define fwd_rnd_col(y, x, k, c)                                             \
+    y[c] = word_in( (k) + 4 * (c) )                                         \
+         ^ t_fn0( bval( x[(c)], 0 ) )           ^ t_fn1( bval( x[((c) + 1) & 3], 1 ) ) \
+         ^ t_fn2( bval( x[((c) + 2) & 3], 2 ) ) ^ t_fn3( bval( x[((c) + 3) & 3], 3 ) )
+
+/* last round: SubBytes and ShiftRows only */
+#define fwd_lrnd_col(y, x, k, c)                                            \
+    y[c] = word_in( (k) + 4 * (c) )                                         \
+         ^ (uint32_t)s_box( bval( x[(c)], 0 ) )                              \
+         ^ ((uint32_t)s_box( bval( x[((c) + 1) & 3], 1 ) ) << 8)            \
+         ^ ((uint32_t)s_box( bval( x[((c) + 2) & 3], 2 ) ) << 16)           \
+         ^ ((uint32_t)s_box( bval( x[((c) + 3) & 3], 3 ) ) << 24)
+
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 #if defined( VERSION_1 )
@@ -565,6 +655,48 @@ return_type aes_set_key( const uint8_t key[], length_type keylen, aes_context ct
 
 /*  Encrypt a single block of 16 bytes */
 
+#if ( AES_ENC_TTABLES != 0 )
+
+return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+{
+    if( ctx->rnd )
+    {
+        uint32_t s1[N_COL], s2[N_COL];
+        const uint8_t *k = ctx->ksch;
+        uint8_t r;
+
+        s1[0] = word_in(in     ) ^ word_in(k     );
+        s1[1] = word_in(in +  4) ^ word_in(k +  4);
+        s1[2] = word_in(in +  8) ^ word_in(k +  8);
+        s1[3] = word_in(in + 12) ^ word_in(k + 12);
+
+        for( r = 1 ; r < ctx->rnd ; ++r )
+        {
+            k += N_BLOCK;
+            fwd_rnd_col(s2, s1, k, 0);
+            fwd_rnd_col(s2, s1, k, 1);
+            fwd_rnd_col(s2, s1, k, 2);
+            fwd_rnd_col(s2, s1, k, 3);
+            s1[0] = s2[0]; s1[1] = s2[1]; s1[2] = s2[2]; s1[3] = s2[3];
+        }
+        k += N_BLOCK;
+        fwd_lrnd_col(s2, s1, k, 0);
+        fwd_lrnd_col(s2, s1, k, 1);
+        fwd_lrnd_col(s2, s1, k, 2);
+        fwd_lrnd_col(s2, s1, k, 3);
+
+        word_out(out     , s2[0]);
+        word_out(out +  4, s2[1]);
+        word_out(out +  8, s2[2]);
+        word_out(out + 12, s2[3]);
+    }
+    else
+        return ( uint8_t )-1;
+    return 0;
+}
+
+#else
+
 return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
 {
     if( ctx->rnd )
@@ -592,6 +724,8 @@ return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const
     return 0;
 }
 
+#endif
+
 /* CBC encrypt a number of blocks (input and return an IV) */
 
 return_type aes_cbc_encrypt( const uint8_t *in, uint8_t *out,
@@ -56,6 +56,20 @@ extern "C" {
 #  define AES_DEC_256_OTFK  /* AES decryption with 'on the fly' 256 bit keying */
 #endif
 
+/*  Encryption round used by aes_encrypt(), chosen at build time:
+
+      0  8-bit operations on the state, 3 x 256 byte tables (default)
+      1  32-bit column operations, one 1 KB table rotated for each row
+      4  32-bit column operations, four 1 KB tables, the fastest
+
+    The key schedule, the context layout and decryption are the same for
+    all of them. t1000_e/tracker/tools/soft_se_bench.c compares speed and
+    table size.
+*/
+#if !defined( AES_ENC_TTABLES )
+#  define AES_ENC_TTABLES   0
+#endif
+
 #define N_ROW                   4
 #define N_COL                   4
 #define N_BLOCK   (N_ROW * N_COL)
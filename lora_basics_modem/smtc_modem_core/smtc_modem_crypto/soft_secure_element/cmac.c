@@ -69,17 +69,48 @@ void AES_CMAC_Init( AES_CMAC_CTX* ctx )
     memset( ctx->X, 0, sizeof ctx->X );
     ctx->M_n = 0;
     memset( ctx->rijndael.ksch, '\0', 240 );
+    ctx->schedule = &ctx->rijndael;
+    ctx->subkeys  = NULL;
 }
 
 void AES_CMAC_SetKey( AES_CMAC_CTX* ctx, const uint8_t key[AES_CMAC_KEY_LENGTH] )
 {
     aes_set_key( key, AES_CMAC_KEY_LENGTH, &ctx->rijndael );
+    ctx->schedule = &ctx->rijndael;
+    ctx->subkeys  = NULL;
+}
+
+/* Derive the subkeys K1 and K2 of a key (RFC 4493 2.3), once per key */
+void AES_CMAC_Subkeys( const aes_context* schedule, AES_CMAC_SUBKEYS* subkeys )
+{
+    uint8_t L[16];
+
+    memset( L, '\0', 16 );
+    aes_encrypt( L, L, schedule );
+
+    LSHIFT( L, subkeys->K1 );
+    if( L[0] & 0x80 )
+        subkeys->K1[15] ^= 0x87;
+
+    LSHIFT( subkeys->K1, subkeys->K2 );
+    if( subkeys->K1[0] & 0x80 )
+        subkeys->K2[15] ^= 0x87;
+
+    memset( L, 0, sizeof L );
+}
+
+/* Same as AES_CMAC_SetKey, with a key schedule expanded beforehand and
+   optionally its subkeys. Both are used in place, not copied, and must
+   stay unchanged until AES_CMAC_Final */
+void AES_CMAC_SetKeySchedule( AES_CMAC_CTX* ctx, const aes_context* schedule, const AES_CMAC_SUBKEYS* subkeys )
+{
+    ctx->schedule = schedule;
+    ctx->subkeys  = subkeys;
 }
 
 void AES_CMAC_Update( AES_CMAC_CTX* ctx, const uint8_t* data, uint32_t len )
 {
     uint32_t mlen;
-    uint8_t  in[16];
 
     if( ctx->M_n > 0 )
     {
@@ -89,22 +120,16 @@ void AES_CMAC_Update( AES_CMAC_CTX* ctx, const uint8_t* data, uint32_t len )
         if( ctx->M_n < 16 || len == mlen )
             return;
         XOR( ctx->M_last, ctx->X );
-
-        memcpy( in, &ctx->X[0], 16 );  // Otherwise it does not look good
-        aes_encrypt( in, in, &ctx->rijndael );
-        memcpy( &ctx->X[0], in, 16 );
+        aes_encrypt( ctx->X, ctx->X, ctx->schedule );
 
         data += mlen;
         len -= mlen;
     }
     while( len > 16 )
-    { /* not last block */
+    { /* not last block, chained straight from the input */
 
         XOR( data, ctx->X );
-
-        memcpy( in, &ctx->X[0], 16 );  // Otherwise it does not look good
-        aes_encrypt( in, in, &ctx->rijndael );
-        memcpy( &ctx->X[0], in, 16 );
+        aes_encrypt( ctx->X, ctx->X, ctx->schedule );
 
         data += 16;
         len -= 16;
@@ -116,47 +141,31 @@ void AES_CMAC_Update( AES_CMAC_CTX* ctx, const uint8_t* data, uint32_t len )
 
 void AES_CMAC_Final( uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX* ctx )
 {
-    uint8_t K[16];
-    uint8_t in[16];
-    /* generate subkey K1 */
-    memset( K, '\0', 16 );
+    AES_CMAC_SUBKEYS        local_subkeys;
+    const AES_CMAC_SUBKEYS* subkeys = ctx->subkeys;
 
-    aes_encrypt( K, K, &ctx->rijndael );
-
-    if( K[0] & 0x80 )
+    if( subkeys == NULL )
     {
-        LSHIFT( K, K );
-        K[15] ^= 0x87;
+        AES_CMAC_Subkeys( ctx->schedule, &local_subkeys );
+        subkeys = &local_subkeys;
     }
-    else
-        LSHIFT( K, K );
 
     if( ctx->M_n == 16 )
     {
         /* last block was a complete block */
-        XOR( K, ctx->M_last );
+        XOR( subkeys->K1, ctx->M_last );
     }
     else
     {
-        /* generate subkey K2 */
-        if( K[0] & 0x80 )
-        {
-            LSHIFT( K, K );
-            K[15] ^= 0x87;
-        }
-        else
-            LSHIFT( K, K );
-
         /* padding(M_last) */
         ctx->M_last[ctx->M_n] = 0x80;
         while( ++ctx->M_n < 16 )
             ctx->M_last[ctx->M_n] = 0;
 
-        XOR( K, ctx->M_last );
+        XOR( subkeys->K2, ctx->M_last );
     }
     XOR( ctx->M_last, ctx->X );
 
-    memcpy( in, &ctx->X[0], 16 );  // Otherwise it does not look good
-    aes_encrypt( in, digest, &ctx->rijndael );
-    memset( K, 0, sizeof K );
+    aes_encrypt( ctx->X, digest, ctx->schedule );
+    memset( &local_subkeys, 0, sizeof local_subkeys );
 }
@@ -45,8 +45,16 @@ extern "C" {
 #define AES_CMAC_KEY_LENGTH     16
 #define AES_CMAC_DIGEST_LENGTH  16
  
+/* CMAC subkeys K1 and K2 of one key, see AES_CMAC_Subkeys */
+typedef struct _AES_CMAC_SUBKEYS {
+            uint8_t        K1[16];
+            uint8_t        K2[16];
+    } AES_CMAC_SUBKEYS;
+
 typedef struct _AES_CMAC_CTX {
             aes_context    rijndael;
+            const aes_context * schedule;       /* rijndael, or a schedule owned by the caller */
+            const AES_CMAC_SUBKEYS * subkeys;   /* NULL: derived in AES_CMAC_Final */
             uint8_t        X[16];
             uint8_t        M_last[16];
             uint32_t       M_n;
@@ -57,6 +65,9 @@ typedef struct _AES_CMAC_CTX {
 //__BEGIN_DECLS
 void     AES_CMAC_Init(AES_CMAC_CTX * ctx);
 void     AES_CMAC_SetKey(AES_CMAC_CTX * ctx, const uint8_t key[AES_CMAC_KEY_LENGTH]);
+void     AES_CMAC_Subkeys(const aes_context * schedule, AES_CMAC_SUBKEYS * subkeys);
+void     AES_CMAC_SetKeySchedule(AES_CMAC_CTX * ctx, const aes_context * schedule,
+                                 const AES_CMAC_SUBKEYS * subkeys);
 void     AES_CMAC_Update(AES_CMAC_CTX * ctx, const uint8_t * data, uint32_t len);
           //          __attribute__((__bounded__(__string__,2,3)));
 void     AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX  * ctx);
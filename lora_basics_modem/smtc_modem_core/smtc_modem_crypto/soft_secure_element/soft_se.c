@@ -65,6 +65,13 @@
  */
 #define SOFT_SE_NUMBER_OF_KEYS 23
 
+/*!
+ * Number of expanded AES key schedules kept between calls
+ */
+#ifndef SOFT_SE_KEY_CACHE_SIZE
+#define SOFT_SE_KEY_CACHE_SIZE 4
+#endif
+
 /*!
  * JoinAccept frame maximum size
  */
@@ -304,6 +311,20 @@ typedef struct soft_se_data_s
     soft_se_key_t key_list[SOFT_SE_NUMBER_OF_KEYS];  //!< The key list
 } soft_se_data_t;
 
+/**
+ * @brief Expanded AES key schedule and CMAC subkeys of one key
+ *
+ * @struct soft_se_key_cache_t
+ */
+typedef struct soft_se_key_cache_s
+{
+    bool                     valid;         //!< Entry in use
+    smtc_se_key_identifier_t key_id;        //!< Key identifier
+    uint32_t                 last_use;      //!< Use stamp for least recently used replacement
+    aes_context              aes_ctx;       //!< Key schedule
+    AES_CMAC_SUBKEYS         cmac_subkeys;  //!< CMAC subkeys K1 and K2
+} soft_se_key_cache_t;
+
 /**
  * @brief Struture for soft secure element context saving in NVM
  *
@@ -322,6 +343,9 @@ typedef struct soft_se_context_nvm_s
 
 static soft_se_data_t soft_se_data = { 0 };
 
+static soft_se_key_cache_t soft_se_key_cache[SOFT_SE_KEY_CACHE_SIZE];
+static uint32_t            soft_se_key_cache_stamp = 0;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
@@ -340,6 +364,22 @@ static soft_se_data_t soft_se_data = { 0 };
  */
 static smtc_se_return_code_t get_key_by_id( smtc_se_key_identifier_t key_id, soft_se_key_t** key_item );
 
+/**
+ * @brief Gets the expanded AES key schedule and CMAC subkeys of a key, computing them on a cache miss
+ *
+ * @param [in] key_id Key identifier
+ * @param [out] entry Cache entry, valid until the next call or key change
+ * @return smtc_se_return_code_t
+ */
+static smtc_se_return_code_t get_key_schedule( smtc_se_key_identifier_t key_id, const soft_se_key_cache_t** entry );
+
+/**
+ * @brief Drops the cached key schedule of a key
+ *
+ * @param [in] key_id Key identifier, SMTC_SE_NO_KEY drops them all
+ */
+static void key_cache_invalidate( smtc_se_key_identifier_t key_id );
+
 /**
  * @brief Computes a CMAC of a message using provided initial Bx block
  *
@@ -377,6 +417,7 @@ smtc_se_return_code_t smtc_secure_element_init( void )
                                   .key_list = SOFT_SE_KEY_LIST };
     // init soft secure element data euis and pin to 0 and key_list with empty lut
     memcpy( ( uint8_t* ) &soft_se_data, ( uint8_t* ) &local_data, sizeof( local_data ) );
+    key_cache_invalidate( SMTC_SE_NO_KEY );
 
     SMTC_MODEM_HAL_TRACE_INFO( "Use soft secure element for cryptographic functionalities\n" );
 
@@ -395,6 +436,8 @@ smtc_se_return_code_t smtc_secure_element_set_key( smtc_se_key_identifier_t key_
     {
         if( soft_se_data.key_list[i].key_id == key_id )
         {
+            key_cache_invalidate( key_id );
+
             if( ( key_id == SMTC_SE_MC_KEY_0 ) || ( key_id == SMTC_SE_MC_KEY_1 ) || ( key_id == SMTC_SE_MC_KEY_2 ) ||
                 ( key_id == SMTC_SE_MC_KEY_3 ) )
             {  // Decrypt the key if its a Mckey
@@ -469,21 +512,16 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
         return SMTC_SE_RC_ERROR_BUF_SIZE;
     }
 
-    aes_context aes_ctx;
-    memset( &aes_ctx, 0, sizeof( aes_context ) );
-
-    soft_se_key_t*        key_item;
-    smtc_se_return_code_t rc = get_key_by_id( key_id, &key_item );
+    const soft_se_key_cache_t* key_entry;
+    smtc_se_return_code_t      rc = get_key_schedule( key_id, &key_entry );
 
     if( rc == SMTC_SE_RC_SUCCESS )
     {
-        aes_set_key( key_item->key_value, 16, &aes_ctx );
-
-        uint8_t block = 0;
+        uint16_t block = 0;
 
         while( size != 0 )
         {
-            aes_encrypt( &buffer[block], &enc_buffer[block], &aes_ctx );
+            aes_encrypt( &buffer[block], &enc_buffer[block], &key_entry->aes_ctx );
             block = block + 16;
             size  = size - 16;
         }
@@ -491,6 +529,47 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
     return rc;
 }
 
+smtc_se_return_code_t smtc_secure_element_aes_ctr_encrypt( const uint8_t* buffer, uint16_t size,
+                                                           smtc_se_key_identifier_t key_id,
+                                                           const uint8_t a_block[16], uint8_t* enc_buffer )
+{
+    if( buffer == NULL || enc_buffer == NULL || a_block == NULL )
+    {
+        return SMTC_SE_RC_ERROR_NPE;
+    }
+
+    const soft_se_key_cache_t* key_entry;
+    smtc_se_return_code_t      rc = get_key_schedule( key_id, &key_entry );
+
+    if( rc == SMTC_SE_RC_SUCCESS )
+    {
+        uint8_t  ctr_block[16];
+        uint8_t  s_block[16];
+        uint16_t ctr   = ( ( uint16_t ) a_block[14] << 8 ) | a_block[15];
+        uint16_t index = 0;
+
+        memcpy( ctr_block, a_block, 16 );
+
+        while( index < size )
+        {
+            uint16_t len = ( ( size - index ) > 16 ) ? 16 : ( size - index );
+
+            ctr_block[14] = ( ctr >> 8 ) & 0xFF;
+            ctr_block[15] = ctr & 0xFF;
+            ctr++;
+
+            aes_encrypt( ctr_block, s_block, &key_entry->aes_ctx );
+            for( uint16_t i = 0; i < len; i++ )
+            {
+                enc_buffer[index + i] = buffer[index + i] ^ s_block[i];
+            }
+            index += len;
+        }
+        memset( s_block, 0, sizeof( s_block ) );
+    }
+    return rc;
+}
+
 smtc_se_return_code_t smtc_secure_element_derive_and_store_key( uint8_t* input, smtc_se_key_identifier_t rootkey_id,
                                                                 smtc_se_key_identifier_t targetkey_id )
 {
@@ -672,6 +751,7 @@ smtc_se_return_code_t smtc_secure_element_restore_context( void )
 {
     soft_se_context_nvm_t ctx;
     smtc_modem_hal_context_restore( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    key_cache_invalidate( SMTC_SE_NO_KEY );
     if( soft_ce_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
     {
         soft_se_data = ctx.data;
@@ -707,6 +787,56 @@ static smtc_se_return_code_t get_key_by_id( smtc_se_key_identifier_t key_id, sof
     return SMTC_SE_RC_ERROR_INVALID_KEY_ID;
 }
 
+static smtc_se_return_code_t get_key_schedule( smtc_se_key_identifier_t key_id, const soft_se_key_cache_t** entry )
+{
+    soft_se_key_t*        key_item;
+    soft_se_key_cache_t*  victim = &soft_se_key_cache[0];
+    smtc_se_return_code_t rc     = get_key_by_id( key_id, &key_item );
+
+    if( rc != SMTC_SE_RC_SUCCESS )
+    {
+        return rc;
+    }
+
+    soft_se_key_cache_stamp++;
+    for( uint8_t i = 0; i < SOFT_SE_KEY_CACHE_SIZE; i++ )
+    {
+        soft_se_key_cache_t* item = &soft_se_key_cache[i];
+
+        if( item->valid && ( item->key_id == key_id ) )
+        {
+            item->last_use = soft_se_key_cache_stamp;
+            *entry         = item;
+            return SMTC_SE_RC_SUCCESS;
+        }
+        // Replace a free entry first, then the least recently used one
+        if( victim->valid &&
+            ( !item->valid || ( ( int32_t )( item->last_use - victim->last_use ) < 0 ) ) )
+        {
+            victim = item;
+        }
+    }
+
+    aes_set_key( key_item->key_value, 16, &victim->aes_ctx );
+    AES_CMAC_Subkeys( &victim->aes_ctx, &victim->cmac_subkeys );
+    victim->valid    = true;
+    victim->key_id   = key_id;
+    victim->last_use = soft_se_key_cache_stamp;
+    *entry           = victim;
+    return SMTC_SE_RC_SUCCESS;
+}
+
+static void key_cache_invalidate( smtc_se_key_identifier_t key_id )
+{
+    for( uint8_t i = 0; i < SOFT_SE_KEY_CACHE_SIZE; i++ )
+    {
+        if( ( key_id == SMTC_SE_NO_KEY ) || ( soft_se_key_cache[i].key_id == key_id ) )
+        {
+            memset( &soft_se_key_cache[i], 0, sizeof( soft_se_key_cache_t ) );
+        }
+    }
+}
+
 static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t* buffer, uint16_t size,
                                            smtc_se_key_identifier_t key_id, uint32_t* cmac )
 {
@@ -720,13 +850,13 @@ static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t
 
     AES_CMAC_Init( aes_cmac_ctx );
 
-    soft_se_key_t* key_item;
+    const soft_se_key_cache_t* key_entry;
 
-    smtc_se_return_code_t rc = get_key_by_id( key_id, &key_item );
+    smtc_se_return_code_t rc = get_key_schedule( key_id, &key_entry );
 
     if( rc == SMTC_SE_RC_SUCCESS )
     {
-        AES_CMAC_SetKey( aes_cmac_ctx, key_item->key_value );
+        AES_CMAC_SetKeySchedule( aes_cmac_ctx, &key_entry->aes_ctx, &key_entry->cmac_subkeys );
 
         if( mic_bx_buffer != NULL )
         {
@@ -1393,10 +1393,11 @@
 #endif
 
 // <q> TIMER2_ENABLED  - Enable TIMER2 instance
+// <i> Owned by lr11xx_hal.c (LR11XX_HAL_BUSY_TIMER), keep disabled for nrfx_timer.
  
 
 #ifndef TIMER2_ENABLED
-#define TIMER2_ENABLED 1
+#define TIMER2_ENABLED 0
 #endif
 
 // <q> TIMER3_ENABLED  - Enable TIMER3 instance
@@ -17,6 +17,14 @@
 #define ADDR_FLASH_DEVNONCE_CONTEXT ADDR_FLASH_PAGE(241)
 #define ADDR_FLASH_SECURE_ELEMENT_CONTEXT ADDR_FLASH_PAGE(240)
 
+// Store-and-forward uplink ring (crew_store_forward.c), below the 3 FDS pages at 237-239
+// (config_sd/sdk_config.h: FDS_VIRTUAL_PAGES 3, FDS_VIRTUAL_PAGES_RESERVED 4).
+// The tracker project ends its application flash at 0xEA000 to leave these pages free.
+#define ADDR_FLASH_STORE_FORWARD ADDR_FLASH_PAGE(234)
+#define ADDR_FLASH_STORE_FORWARD_PAGES 3
+#define STORE_FLASH_ADDR_START  ADDR_FLASH_STORE_FORWARD
+#define STORE_FLASH_ADDR_END    ( ADDR_FLASH_PAGE(234 + ADDR_FLASH_STORE_FORWARD_PAGES) - 1 )
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -16,6 +16,23 @@ extern "C" {
 
 #define TRACE_PRINTF( ... ) hal_trace_print_var( __VA_ARGS__ )
 
+/*!
+ * Shorter hal_mcu_wait_ms delays spin, longer ones sleep on the RTC
+ */
+#define HAL_MCU_WAIT_SLEEP_MIN_MS   2
+
+/*!
+ * @brief hal_mcu_wait_ms accounting: how much delay time ran asleep instead of spinning
+ */
+typedef struct
+{
+    uint32_t sleep_ms;      // delay time spent in System ON sleep
+    uint32_t busy_ms;       // delay time spent in the NOP loop (short, in an IRQ or before hal_mcu_init)
+    uint32_t sleep_waits;   // delays that slept
+    uint32_t busy_waits;    // delays that spun
+    uint32_t wakeups;       // core wake-ups during sleeping delays, timer included
+} hal_mcu_wait_stats_t;
+
 /*!
  * Panic function for mcu issues
  */
@@ -68,11 +85,25 @@ void hal_mcu_reset( void );
 void hal_mcu_wait_us( const int32_t microseconds );
 
 /*!
- * @brief Software delay
+ * @brief Delay, sleeping on the RTC when possible
  * @param [in] delay time in ms
  */
 void hal_mcu_wait_ms( const int32_t ms );
 
+/*!
+ * @brief Delay that also ends when an event flag is set
+ * @param [in] ms maximum delay time in ms
+ * @param [in] event flag set from an interrupt, NULL to always wait the full delay
+ * @return true if the event ended the delay
+ */
+bool hal_mcu_wait_ms_or_event( const int32_t ms, const volatile bool *event );
+
+/*!
+ * @brief Get the delay accounting since boot
+ * @param [out] stats copy of the counters
+ */
+void hal_mcu_get_wait_stats( hal_mcu_wait_stats_t *stats );
+
 /*!
  * @brief Enable or disable partial sleep
  * @param [in] enable enable or disable
@@ -8,6 +8,10 @@
 #define RTC_2_PER_TICK	0.091552734375
 #define RTC_2_MAX_TICKS	0xffffff
 
+// Exact tick period is 3 / 32768 s, rounded up so a wait never ends early
+#define RTC_2_MS_TO_TICKS( ms )   (( uint32_t )((( uint64_t )( ms ) * 32768 + 2999 ) / 3000 ))
+#define RTC_2_TICKS_TO_MS( tick ) (( uint32_t )(( uint64_t )( tick ) * 3000 / 32768 ))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -69,6 +73,25 @@ void hal_rtc_cc1_timer_set_ms( const int32_t milliseconds );
  */
 void hal_rtc_cc1_timer_stop( void );
 
+/*!
+ * @brief Get rtc counter
+ * 
+ * @return Counter value in tick, wraps at RTC_2_MAX_TICKS
+ */
+uint32_t hal_rtc_get_ticks( void );
+
+/*!
+ * @brief Arm rtc cc2 timer, used by hal_mcu_wait_ms to wake the core
+ * 
+ * @param [in] ticks Absolute counter value, at least 2 ticks ahead of the counter
+ */
+void hal_rtc_cc2_timer_set_ticks( const uint32_t ticks );
+
+/*!
+ * @brief Stop rtc cc2 timer
+ */
+void hal_rtc_cc2_timer_stop( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,83 @@
+
+#ifndef __SMTC_HAL_SIM_H
+#define __SMTC_HAL_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Host simulation seam
+ *
+ * When SMTC_HAL_SIM is defined, smtc_hal_sim.c replaces the time keeping parts
+ * of smtc_hal_rtc.c and smtc_hal_mcu.c with a virtual clock: waits and sleeps
+ * advance virtual time instead of spinning or entering System ON sleep, and the
+ * RTC2 compare channels (CC0 wakeup, CC1 lp timer) fire from that clock.
+ * A 24 h duty cycle therefore replays as fast as the application code runs.
+ *
+ * Peripheral models (radio, GNSS, BLE) register a step hook and inject their
+ * events when virtual time crosses their deadlines.
+ */
+
+/*!
+ * @brief Peripheral model hook, called after each virtual time step
+ *
+ * @param [in] now_ms Virtual time after the step, in milliseconds
+ */
+typedef void ( *hal_sim_step_hook_t )( uint64_t now_ms );
+
+/*!
+ * @brief Virtual time accounting, reset by hal_sim_reset
+ */
+typedef struct hal_sim_stats_s
+{
+    uint64_t sleep_ms;       // time spent in hal_mcu_set_sleep_for_ms
+    uint64_t busy_ms;        // time spent in hal_mcu_wait_ms / hal_mcu_wait_us
+    uint64_t wait_sleep_ms;  // part of busy_ms the target spends asleep (hal_mcu_wait_ms from HAL_MCU_WAIT_SLEEP_MIN_MS)
+    uint32_t sleep_count;    // number of sleep requests
+    uint32_t sleep_breaks;   // sleeps cut short by hal_sleep_exit or a lp timer
+    uint32_t lp_timer_fired; // lp timer (RTC2 CC1) expirations
+    uint32_t reset_count;    // hal_mcu_reset requests
+} hal_sim_stats_t;
+
+/*!
+ * @brief Reset virtual time to zero and clear all pending timers and statistics
+ */
+void hal_sim_reset( void );
+
+/*!
+ * @brief Get virtual time without 32-bit wrap
+ *
+ * @return Time in millisecond
+ */
+uint64_t hal_sim_get_time_ms( void );
+
+/*!
+ * @brief Advance virtual time, firing any timer that expires on the way
+ *
+ * @param [in] milliseconds Amount of virtual time to advance
+ */
+void hal_sim_advance_ms( uint32_t milliseconds );
+
+/*!
+ * @brief Register the peripheral model hook
+ *
+ * @param [in] hook Called after every time step, NULL to remove
+ */
+void hal_sim_set_step_hook( hal_sim_step_hook_t hook );
+
+/*!
+ * @brief Get virtual time accounting
+ *
+ * @param [out] stats Copy of the current statistics
+ */
+void hal_sim_get_stats( hal_sim_stats_t *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
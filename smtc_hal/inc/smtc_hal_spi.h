@@ -8,6 +8,26 @@
 extern "C" {
 #endif
 
+/*!
+ * @brief One segment of a scatter/gather transaction
+ */
+typedef struct
+{
+    const uint8_t* tx;      // Bytes to send, NULL to clock out the fill byte
+    uint8_t* rx;            // Where to store the bytes clocked in, NULL to drop them
+    uint16_t length;        // Segment length in bytes
+} hal_spi_segment_t;
+
+/*!
+ * @brief SPIM transfer counters
+ */
+typedef struct
+{
+    uint32_t transfers;     // EasyDMA transfers started
+    uint32_t bytes;         // Bytes clocked by those transfers
+    uint16_t max_transfer;  // Largest single transfer in bytes
+} hal_spi_stats_t;
+
 /*!
  * @brief Init spi peripheral
  */
@@ -60,6 +80,29 @@ void hal_spi_read_with_dummy_byte( uint8_t* buffer, uint16_t length, uint8_t dum
  */
 uint16_t hal_spi_in_out( const uint32_t id, const uint16_t out_data );
 
+/*!
+ * @brief Clock several buffers back to back, as one EasyDMA transfer when they fit
+ *
+ * Chip select is left to the caller, so the segments form one transaction on the bus.
+ * 
+ * @param [in] segments Segments in bus order
+ * @param [in] segment_count Number of segments
+ * @param [in] fill_byte Byte sent for segments without TX data
+ */
+void hal_spi_transfer( const hal_spi_segment_t* segments, uint8_t segment_count, uint8_t fill_byte );
+
+/*!
+ * @brief Get the transfer counters
+ * 
+ * @param [out] stats Counters since boot or the last reset
+ */
+void hal_spi_get_stats( hal_spi_stats_t* stats );
+
+/*!
+ * @brief Clear the transfer counters
+ */
+void hal_spi_reset_stats( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,4 +1,3 @@
-
 #ifndef __SMTC_HAL_TRACE_H
 #define __SMTC_HAL_TRACE_H
 
@@ -11,6 +10,41 @@
 extern "C" {
 #endif
 
+/*
+ * Traces are not written to USB CDC by the caller. They are queued as records
+ * (length, category, RTC2 timestamp, text) in a RAM ring and sent from
+ * hal_trace_flush( ), called by the USB timer tick and the idle loop, one
+ * transfer at a time. A record that does not fit is dropped and counted,
+ * logging never waits for the host. A record is at most one transfer (512
+ * bytes): longer text is truncated, a longer binary record dropped.
+ *
+ * Binary records (deferred log formatting) are sent as frames mixed with the
+ * text: 0x00, length (u16 LE, bytes after this field), RTC2 timestamp (u32 LE),
+ * category (u8), record bytes. Text never contains 0x00.
+ */
+
+#define HAL_TRACE_CATEGORY_NONE 0xFF
+
+// One USB CDC transfer, holds several records
+#define HAL_TRACE_TX_SIZE 512
+
+// Binary frame header: sync (1) + length (2) + timestamp (4) + category (1)
+#define HAL_TRACE_FRAME_HDR_SIZE 8
+
+// Longest binary record, the frame must fit one transfer
+#define HAL_TRACE_BINARY_MAX_SIZE ( HAL_TRACE_TX_SIZE - HAL_TRACE_FRAME_HDR_SIZE )
+
+/*!
+ * @brief Trace pipeline counters since boot
+ */
+typedef struct
+{
+    uint32_t records;       // records queued
+    uint32_t dropped;       // records lost because the ring was full or the record too long
+    uint32_t bytes;         // bytes handed to USB CDC
+    uint32_t high_water;    // highest ring fill in bytes
+} hal_trace_stats_t;
+
 /*!
  * @brief Trace print api
  */
@@ -21,8 +55,41 @@ void hal_trace_print( const char* fmt, va_list argp );
  */
 void hal_trace_print_var( const char* fmt, ... );
 
+/*!
+ * @brief Queue formatted text, safe from any context
+ * @param [in] category log category kept with the record, HAL_TRACE_CATEGORY_NONE for plain traces
+ * @param [in] text text to send, no terminator needed
+ * @param [in] len text length
+ */
+void hal_trace_write( uint8_t category, const char* text, uint16_t len );
+
+/*!
+ * @brief Queue a binary record, safe from any context
+ * @param [in] category log category sent with the frame
+ * @param [in] data record bytes, at most HAL_TRACE_BINARY_MAX_SIZE, a longer record is dropped and counted
+ * @param [in] len record length
+ */
+void hal_trace_write_binary( uint8_t category, const uint8_t* data, uint16_t len );
+
+/*!
+ * @brief Start the next USB CDC transfer if the previous one is done
+ */
+void hal_trace_flush( void );
+
+/*!
+ * @brief Send everything queued before a reset, bounded wait
+ * @param [in] timeout_ms longest time to wait for the host
+ */
+void hal_trace_flush_sync( uint32_t timeout_ms );
+
+/*!
+ * @brief Get the trace pipeline counters
+ * @param [out] stats copy of the counters
+ */
+void hal_trace_get_stats( hal_trace_stats_t* stats );
+
 #endif
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
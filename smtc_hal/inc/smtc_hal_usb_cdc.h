@@ -32,6 +32,30 @@ void hal_usb_cdc_deinit( void );
  */
 void hal_usb_cdc_write( uint8_t* buff, uint16_t len );
 
+/*!
+ * @brief Start a usb cdc write without waiting for it
+ * 
+ * @param [in] buff Pointer to buffer to be transmitted, must stay valid until hal_usb_cdc_is_tx_busy( ) is false
+ * @param [in] len buffer length to be transmitted
+ * 
+ * @return true if the transfer started
+ */
+bool hal_usb_cdc_write_async( const uint8_t* buff, uint16_t len );
+
+/*!
+ * @brief Get usb cdc port status
+ * 
+ * @return true while a terminal has the port open
+ */
+bool hal_usb_cdc_is_port_open( void );
+
+/*!
+ * @brief Get usb cdc transmit status
+ * 
+ * @return true until the last write is acknowledged (TX_DONE)
+ */
+bool hal_usb_cdc_is_tx_busy( void );
+
 /*!
  * @brief Usb cdc read buffer
  * 
@@ -21,6 +21,40 @@ NRF_FSTORAGE_DEF( nrf_fstorage_t fstorage ) =
     .end_addr       = APP_FLASH_ADDR_END,
 };
 
+NRF_FSTORAGE_DEF( nrf_fstorage_t store_fstorage ) =
+{
+    .evt_handler    = fstorage_evt_handler,
+    .start_addr     = STORE_FLASH_ADDR_START,
+    .end_addr       = STORE_FLASH_ADDR_END,
+};
+
+// Instance owning [addr, addr + size), NULL outside both regions
+static nrf_fstorage_t* hal_flash_instance( uint32_t addr, uint32_t size )
+{
+    if( addr >= APP_FLASH_ADDR_START && addr <= APP_FLASH_ADDR_END && size <= APP_FLASH_SIZE_MAX )
+    {
+        return &fstorage;
+    }
+    if( addr >= STORE_FLASH_ADDR_START && addr <= STORE_FLASH_ADDR_END &&
+        size <= STORE_FLASH_ADDR_END + 1 - addr )
+    {
+        return &store_fstorage;
+    }
+    return NULL;
+}
+
+static void hal_flash_wait( nrf_fstorage_t* p_fs )
+{
+    while( nrf_fstorage_is_busy( p_fs ))
+    {
+#ifdef SOFTDEVICE_PRESENT
+        ( void )sd_app_evt_wait( );
+#else
+        __WFE();
+#endif
+    }
+}
+
 smtc_hal_status_t hal_flash_init( void )
 {
     nrf_fstorage_api_t * p_fs_api;
@@ -32,45 +66,38 @@ smtc_hal_status_t hal_flash_init( void )
 #endif
 
     nrf_fstorage_init( &fstorage, p_fs_api, NULL );
+    nrf_fstorage_init( &store_fstorage, p_fs_api, NULL );
 }
 
 smtc_hal_status_t hal_flash_erase_page( uint32_t addr, uint8_t nb_page )
 {
-    if( addr >= APP_FLASH_ADDR_START && addr <= APP_FLASH_ADDR_END && nb_page <= APP_FLASH_PAGE_MAX )
+    nrf_fstorage_t* p_fs = hal_flash_instance( addr, ( uint32_t ) nb_page * ADDR_FLASH_PAGE_SIZE );
+
+    if( p_fs != NULL && nb_page <= APP_FLASH_PAGE_MAX )
     {
-        nrf_fstorage_erase( &fstorage, addr, nb_page, NULL );
-        while( nrf_fstorage_is_busy( &fstorage ))
-        {
-#ifdef SOFTDEVICE_PRESENT
-            ( void )sd_app_evt_wait( );
-#else
-            __WFE();
-#endif
-        }
+        nrf_fstorage_erase( p_fs, addr, nb_page, NULL );
+        hal_flash_wait( p_fs );
     }
 }
 
 smtc_hal_status_t hal_flash_write_buffer( uint32_t addr, const uint8_t* buffer, uint32_t size )
 {
-    if( addr >= APP_FLASH_ADDR_START && addr <= APP_FLASH_ADDR_END && size <= APP_FLASH_SIZE_MAX )
+    nrf_fstorage_t* p_fs = hal_flash_instance( addr, size );
+
+    if( p_fs != NULL )
     {
-        nrf_fstorage_write( &fstorage, addr, buffer, size, NULL );
-        while( nrf_fstorage_is_busy( &fstorage ))
-        {
-#ifdef SOFTDEVICE_PRESENT
-            ( void )sd_app_evt_wait( );
-#else
-            __WFE();
-#endif
-        }
+        nrf_fstorage_write( p_fs, addr, buffer, size, NULL );
+        hal_flash_wait( p_fs );
     }
 }
 
 void hal_flash_read_buffer( uint32_t addr, uint8_t* buffer, uint32_t size )
 {
-    if( addr >= APP_FLASH_ADDR_START && addr <= APP_FLASH_ADDR_END && size <= APP_FLASH_SIZE_MAX )
+    nrf_fstorage_t* p_fs = hal_flash_instance( addr, size );
+
+    if( p_fs != NULL )
     {
-        nrf_fstorage_read( &fstorage, addr, buffer, size );
+        nrf_fstorage_read( p_fs, addr, buffer, size );
     }
 }
 
@@ -82,4 +109,5 @@ static void fstorage_evt_handler( nrf_fstorage_evt_t * p_evt )
 smtc_hal_status_t hal_flash_deinit( void )
 {
     nrf_fstorage_uninit( &fstorage,  NULL );
+    nrf_fstorage_uninit( &store_fstorage,  NULL );
 }
@@ -123,7 +123,8 @@ void hal_gpio_init( void )
     hal_mcu_wait_ms( 500 ); // re-power up LR1110
 
     hal_gpio_init_out( LR1110_SPI_NSS_PIN, HAL_GPIO_SET );
-    hal_gpio_init_in( LR1110_BUSY_PIN, HAL_GPIO_PULL_MODE_NONE, HAL_GPIO_IRQ_MODE_OFF, NULL );
+    // No callback, the falling edge event only wakes lr11xx_hal_wait_on_busy( ) out of __WFE( )
+    hal_gpio_init_in( LR1110_BUSY_PIN, HAL_GPIO_PULL_MODE_NONE, HAL_GPIO_IRQ_MODE_FALLING, NULL );
     hal_gpio_init_in( LR1110_IRQ_PIN, HAL_GPIO_PULL_MODE_DOWN, HAL_GPIO_IRQ_MODE_RISING, NULL );
     hal_gpio_set_value( LR1110_NRESER_PIN, HAL_GPIO_SET );
 
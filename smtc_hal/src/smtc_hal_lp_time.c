@@ -1,9 +1,11 @@
 
 
 #include "smtc_hal_dbg_trace.h"
+#ifndef SMTC_HAL_SIM
 #include "nrf_drv_timer.h"
 #include "nrf_drv_rtc.h"
 #include "nrf_drv_clock.h"
+#endif
 #include "smtc_hal_rtc.h"
 #include "smtc_hal_lp_time.h"
 
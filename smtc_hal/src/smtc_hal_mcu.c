@@ -1,9 +1,13 @@
 
+#ifndef SMTC_HAL_SIM
 #include "nrf_nvic.h"
 #include "nrf52840.h"
+#endif
 #include "smtc_hal.h"
+#ifndef SMTC_HAL_SIM
 #include "nrf_pwr_mgmt.h"
 #include "nrf_drv_clock.h"
+#endif
 #include "smtc_hal_rtc.h"
 
 #include <stdarg.h>
@@ -11,13 +15,23 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#ifndef SMTC_HAL_SIM
 #include "hardfault.h"
+#endif
 #include "app_led.h"
 #include "app_user_timer.h"
 
+// Host simulation builds take the board bring-up, clock and sleep code below from smtc_hal_sim.c and the
+// simulated board instead
+#ifndef SMTC_HAL_SIM
 static bool m_sleep_enable = false;
 static uint32_t m_usb_detect = false;
-static bool m_hal_sleep_break = false;
+static volatile bool m_hal_sleep_break = false;
+static bool m_wait_sleep_ready = false;
+static hal_mcu_wait_stats_t m_wait_stats = { 0 };
+
+// Longest single RTC sleep, well inside the 24-bit counter range
+#define HAL_MCU_WAIT_CHUNK_MS   60000
 
 void usb_irq_handler( void *obj );
 hal_gpio_irq_t usb_irq = {
@@ -60,6 +74,7 @@ void hal_mcu_init( void )
     hal_flash_init( );
     hal_gpio_init( );
     hal_rtc_init( );
+    m_wait_sleep_ready = true;
     hal_spi_init( );
     hal_i2c_init( );
     hal_rng_init( );
@@ -82,6 +97,7 @@ void hal_mcu_enable_irq( void )
 
 void hal_mcu_reset( void )
 {
+    hal_trace_flush_sync( 100 ); // panic and reset messages are still queued
     sd_nvic_SystemReset( );
 }
 
@@ -95,10 +111,89 @@ void __attribute__(( optimize( "O0" ))) hal_mcu_wait_us( const int32_t microseco
     }
 }
 
-void hal_mcu_wait_ms( const int32_t ms )
+static bool hal_mcu_wait_event_set( const volatile bool *event )
 {
-    for( uint32_t i = 0; i < ms; i++ )
+    return ( event != NULL ) && *event;
+}
+
+static bool hal_mcu_wait_can_sleep( void )
+{
+    // Needs RTC2 running, and nrf_pwr_mgmt_run( ) may end in an SVC call: not from an IRQ or with IRQs masked
+    return m_wait_sleep_ready && ( __get_IPSR( ) == 0 ) && ( __get_PRIMASK( ) == 0 );
+}
+
+static bool hal_mcu_wait_spin_ms( const int32_t ms, const volatile bool *event )
+{
+    for( int32_t i = 0; i < ms; i++ )
+    {
+        if( hal_mcu_wait_event_set( event )) return true;
         hal_mcu_wait_us( 1000 );
+    }
+    return hal_mcu_wait_event_set( event );
+}
+
+static bool hal_mcu_wait_sleep_ticks( const uint32_t start, const uint32_t ticks, const volatile bool *event )
+{
+    uint32_t elapsed = 0;
+
+    while( elapsed < ticks && !hal_mcu_wait_event_set( event ))
+    {
+        hal_rtc_cc2_timer_set_ticks( start + ticks );
+
+        // The compare only fires if it was written at least 2 ticks ahead, spin out the last ones
+        elapsed = ( hal_rtc_get_ticks( ) - start ) & RTC_2_MAX_TICKS;
+        if( elapsed + 2 <= ticks )
+        {
+            nrf_pwr_mgmt_run( );
+            m_wait_stats.wakeups++;
+        }
+        elapsed = ( hal_rtc_get_ticks( ) - start ) & RTC_2_MAX_TICKS;
+    }
+    hal_rtc_cc2_timer_stop( );
+
+    m_wait_stats.sleep_ms += RTC_2_TICKS_TO_MS( elapsed < ticks ? elapsed : ticks );
+    return elapsed < ticks;
+}
+
+void hal_mcu_wait_ms( const int32_t ms )
+{
+    hal_mcu_wait_ms_or_event( ms, NULL );
+}
+
+bool hal_mcu_wait_ms_or_event( const int32_t ms, const volatile bool *event )
+{
+    int32_t remaining = ms;
+    uint32_t start = 0, ticks = 0;
+
+    if( ms <= 0 ) return hal_mcu_wait_event_set( event );
+
+    if( ms < HAL_MCU_WAIT_SLEEP_MIN_MS || !hal_mcu_wait_can_sleep( ))
+    {
+        m_wait_stats.busy_waits++;
+        m_wait_stats.busy_ms += ms;
+        return hal_mcu_wait_spin_ms( ms, event );
+    }
+
+    // The start is read anywhere inside a tick, one more tick so the delay never ends early.
+    // Each chunk starts at the deadline of the previous one so the error does not add up.
+    start = hal_rtc_get_ticks( );
+    ticks = 1;
+    m_wait_stats.sleep_waits++;
+    while( remaining > 0 )
+    {
+        int32_t chunk = remaining > HAL_MCU_WAIT_CHUNK_MS ? HAL_MCU_WAIT_CHUNK_MS : remaining;
+        ticks += RTC_2_MS_TO_TICKS( chunk );
+        if( hal_mcu_wait_sleep_ticks( start, ticks, event )) return true;
+        start += ticks;
+        ticks = 0;
+        remaining -= chunk;
+    }
+    return false;
+}
+
+void hal_mcu_get_wait_stats( hal_mcu_wait_stats_t *stats )
+{
+    if( stats != NULL ) *stats = m_wait_stats;
 }
 
 void hal_mcu_partial_sleep_enable( bool enable )
@@ -113,6 +208,9 @@ void hal_mcu_set_sleep_for_ms( const int32_t milliseconds )
 
     if( milliseconds <= 0 ) return;
 
+    // Idle point of the main loop: hand queued traces to USB before sleeping
+    hal_trace_flush( );
+
     do
     {
         int32_t time_sleep = 0;
@@ -165,18 +263,32 @@ void hal_mcu_set_sleep_for_ms( const int32_t milliseconds )
                 app_user_run_process( );
 #endif
                 hal_usb_timer_uninit( );
-                hal_rtc_wakeup_timer_set_ms( time_sleep );
-                nrf_pwr_mgmt_run( );
+#ifdef APP_TRACKER
+                // A break raised on battery is consumed here too, or it would cut the next USB-powered sleep short
+                if( !m_hal_sleep_break )
+#endif
+                {
+                    hal_rtc_wakeup_timer_set_ms( time_sleep );
+                    nrf_pwr_mgmt_run( );
+                }
+#ifdef APP_TRACKER
+                if( m_hal_sleep_break )
+                {
+                    m_hal_sleep_break = false;
+                    last_sleep_loop = true;
+                }
+#endif
             }
         }
     } while( last_sleep_loop == false );
 }
+#endif // SMTC_HAL_SIM
 
 void hal_hex_to_bin( char *input, uint8_t *dst, int len )
 {
     char tmp[3];
     uint16_t length = strlen( input );
-    tmp[2] = NULL;
+    tmp[2] = '\0';
     for( int i = 0; i < length; i+=2 )
     {
         tmp[0] = input[i];
@@ -204,6 +316,7 @@ void memcpyr( uint8_t *dst, const uint8_t *src, uint16_t size )
     }
 }
 
+#ifndef SMTC_HAL_SIM
 void hal_sleep_exit( void )
 {
     m_hal_sleep_break = true;
@@ -214,3 +327,4 @@ void app_error_fault_handler( uint32_t id, uint32_t pc, uint32_t info )
     hal_mcu_wait_ms( 200 );
     NVIC_SystemReset( );
 }
+#endif // SMTC_HAL_SIM
@@ -1,3 +1,5 @@
+// Host simulation builds take the virtual clock of smtc_hal_sim.c instead
+#ifndef SMTC_HAL_SIM
 
 #include "nrf_drv_rtc.h"
 #include "nrf_drv_clock.h"
@@ -146,4 +148,21 @@ void hal_rtc_cc1_timer_stop( void )
     nrf_drv_rtc_cc_disable( &rtc_2, 1 );  // disable compare counter 1
 }
 
+uint32_t hal_rtc_get_ticks( void )
+{
+    return nrf_drv_rtc_counter_get( &rtc_2 );
+}
+
+void hal_rtc_cc2_timer_set_ticks( const uint32_t ticks )
+{
+    nrf_drv_rtc_cc_set( &rtc_2, 2, ticks & RTC_2_MAX_TICKS, true ); // enable compare counter 2, only wakes the core
+}
+
+void hal_rtc_cc2_timer_stop( void )
+{
+    nrf_drv_rtc_cc_disable( &rtc_2, 2 );  // disable compare counter 2
+}
+
 #endif
+
+#endif // SMTC_HAL_SIM
@@ -0,0 +1,318 @@
+
+#ifdef SMTC_HAL_SIM
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "smtc_hal_mcu.h"
+#include "smtc_hal_rtc.h"
+#include "smtc_hal_lp_time.h"
+#include "smtc_hal_sim.h"
+
+#ifdef APP_TRACKER
+#include "app_user_timer.h"
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+// Longest single step, bounds the latency of the peripheral model hook
+#ifndef HAL_SIM_MAX_STEP_MS
+#define HAL_SIM_MAX_STEP_MS     100
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint64_t sim_now_us = 0;
+
+static bool     sim_cc0_armed = false;
+static uint64_t sim_cc0_deadline_us = 0;
+static bool     sim_cc1_armed = false;
+static uint64_t sim_cc1_deadline_us = 0;
+
+static volatile bool sim_irq_enabled = true;
+static volatile bool sim_sleep_break = false;
+static volatile bool sim_wakeup = false;
+
+static hal_sim_step_hook_t sim_step_hook = NULL;
+static hal_sim_stats_t sim_stats = { 0 };
+static hal_mcu_wait_stats_t sim_wait_stats = { 0 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void hal_sim_fire_timers( void )
+{
+    if( sim_cc0_armed && sim_now_us >= sim_cc0_deadline_us )
+    {
+        sim_cc0_armed = false;
+        sim_wakeup = true;
+    }
+
+    if( sim_cc1_armed && sim_now_us >= sim_cc1_deadline_us && sim_irq_enabled )
+    {
+        sim_cc1_armed = false;
+        sim_wakeup = true;
+        sim_stats.lp_timer_fired++;
+        hal_lp_timer_event_handler( );
+    }
+}
+
+/*!
+ * @brief Advance virtual time
+ *
+ * @param [in] us Time to advance in microsecond
+ * @param [in] wake_stops When true, return as soon as a timer or hal_sleep_exit wakes the core
+ *
+ * @return Time actually advanced in microsecond
+ */
+static uint64_t hal_sim_step_us( uint64_t us, bool wake_stops )
+{
+    uint64_t done = 0;
+
+    while( us > 0 )
+    {
+        uint64_t step = us;
+        if( step > HAL_SIM_MAX_STEP_MS * 1000ULL ) step = HAL_SIM_MAX_STEP_MS * 1000ULL;
+
+        // Stop exactly on the next compare event so timers fire on time
+        if( sim_cc0_armed && sim_cc0_deadline_us > sim_now_us && sim_cc0_deadline_us - sim_now_us < step )
+        {
+            step = sim_cc0_deadline_us - sim_now_us;
+        }
+        if( sim_cc1_armed && sim_cc1_deadline_us > sim_now_us && sim_cc1_deadline_us - sim_now_us < step )
+        {
+            step = sim_cc1_deadline_us - sim_now_us;
+        }
+
+        sim_now_us += step;
+        done += step;
+        us -= step;
+
+        hal_sim_fire_timers( );
+        if( sim_step_hook != NULL ) sim_step_hook( sim_now_us / 1000 );
+
+        if( wake_stops && ( sim_wakeup || sim_sleep_break )) break;
+    }
+
+    return done;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATION API ----------------------------------------------------------
+ */
+
+void hal_sim_reset( void )
+{
+    sim_now_us = 0;
+    sim_cc0_armed = false;
+    sim_cc1_armed = false;
+    sim_irq_enabled = true;
+    sim_sleep_break = false;
+    sim_wakeup = false;
+    memset( &sim_stats, 0, sizeof( sim_stats ));
+    memset( &sim_wait_stats, 0, sizeof( sim_wait_stats ));
+}
+
+uint64_t hal_sim_get_time_ms( void )
+{
+    return sim_now_us / 1000;
+}
+
+void hal_sim_advance_ms( uint32_t milliseconds )
+{
+    hal_sim_step_us(( uint64_t )milliseconds * 1000, false );
+}
+
+void hal_sim_set_step_hook( hal_sim_step_hook_t hook )
+{
+    sim_step_hook = hook;
+}
+
+void hal_sim_get_stats( hal_sim_stats_t *stats )
+{
+    if( stats != NULL ) *stats = sim_stats;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- RTC REPLACEMENT (smtc_hal_rtc.c) ----------------------------------------
+ */
+
+void hal_rtc_init( void )
+{
+    hal_sim_reset( );
+}
+
+uint32_t hal_rtc_get_time_s( void )
+{
+    return sim_now_us / 1000000;
+}
+
+uint32_t hal_rtc_get_time_ms( void )
+{
+    return sim_now_us / 1000;
+}
+
+uint32_t hal_rtc_get_time_100us( void )
+{
+    return sim_now_us / 100;
+}
+
+uint32_t hal_rtc_get_max_ticks( void )
+{
+    return RTC_2_MAX_TICKS;
+}
+
+void hal_rtc_wakeup_timer_set_ms( const int32_t milliseconds )
+{
+    sim_cc0_deadline_us = sim_now_us + ( uint64_t )( milliseconds > 0 ? milliseconds : 0 ) * 1000;
+    sim_cc0_armed = true;
+}
+
+void hal_rtc_wakeup_timer_stop( void )
+{
+    sim_cc0_armed = false;
+}
+
+void hal_rtc_cc1_timer_set_ms( const int32_t milliseconds )
+{
+    sim_cc1_deadline_us = sim_now_us + ( uint64_t )( milliseconds > 0 ? milliseconds : 0 ) * 1000;
+    sim_cc1_armed = true;
+}
+
+void hal_rtc_cc1_timer_stop( void )
+{
+    sim_cc1_armed = false;
+}
+
+uint32_t hal_rtc_get_ticks( void )
+{
+    return RTC_2_MS_TO_TICKS( sim_now_us / 1000 ) & RTC_2_MAX_TICKS;
+}
+
+void hal_rtc_cc2_timer_set_ticks( const uint32_t ticks )
+{
+    ( void )ticks; // hal_mcu_wait_ms advances virtual time itself
+}
+
+void hal_rtc_cc2_timer_stop( void )
+{
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MCU REPLACEMENT (smtc_hal_mcu.c timing) ---------------------------------
+ */
+
+void hal_mcu_disable_irq( void )
+{
+    sim_irq_enabled = false;
+}
+
+void hal_mcu_enable_irq( void )
+{
+    sim_irq_enabled = true;
+    hal_sim_fire_timers( ); // deliver a compare event that was held off
+}
+
+void hal_mcu_reset( void )
+{
+    sim_stats.reset_count++;
+}
+
+void hal_mcu_wait_us( const int32_t microseconds )
+{
+    if( microseconds <= 0 ) return;
+    hal_sim_step_us( microseconds, false );
+    sim_stats.busy_ms += microseconds / 1000;
+}
+
+bool hal_mcu_wait_ms_or_event( const int32_t ms, const volatile bool *event )
+{
+    int32_t waited = 0;
+
+    if( ms <= 0 ) return ( event != NULL ) && *event;
+
+    // 1 ms steps so a peripheral model can set the event from its step hook
+    while( waited < ms && !(( event != NULL ) && *event ))
+    {
+        hal_sim_step_us( 1000, false );
+        waited++;
+    }
+    sim_stats.busy_ms += waited;
+
+    // The target sleeps through these instead of spinning
+    if( ms >= HAL_MCU_WAIT_SLEEP_MIN_MS )
+    {
+        sim_stats.wait_sleep_ms += waited;
+        sim_wait_stats.sleep_ms += waited;
+        sim_wait_stats.sleep_waits++;
+        sim_wait_stats.wakeups++;
+    }
+    else
+    {
+        sim_wait_stats.busy_ms += waited;
+        sim_wait_stats.busy_waits++;
+    }
+    return waited < ms;
+}
+
+void hal_mcu_wait_ms( const int32_t ms )
+{
+    hal_mcu_wait_ms_or_event( ms, NULL );
+}
+
+void hal_mcu_get_wait_stats( hal_mcu_wait_stats_t *stats )
+{
+    if( stats != NULL ) *stats = sim_wait_stats;
+}
+
+void hal_mcu_partial_sleep_enable( bool enable )
+{
+    ( void )enable;
+}
+
+void hal_mcu_set_sleep_for_ms( const int32_t milliseconds )
+{
+    // Same 50 ms floor as the target: shorter requests return immediately
+    if( milliseconds <= 50 ) return;
+
+    sim_stats.sleep_count++;
+#ifdef APP_TRACKER
+    app_user_run_process( );
+#endif
+
+    uint64_t slept_us = 0;
+
+    sim_wakeup = false;
+    hal_rtc_wakeup_timer_set_ms( milliseconds );
+
+    // Any interrupt ends the sleep on the target, mirror that here
+    slept_us = hal_sim_step_us(( uint64_t )milliseconds * 1000, true );
+    if( sim_sleep_break || slept_us < ( uint64_t )milliseconds * 1000 )
+    {
+        sim_stats.sleep_breaks++;
+    }
+    sim_sleep_break = false;
+    sim_wakeup = false;
+
+    hal_rtc_wakeup_timer_stop( );
+    sim_stats.sleep_ms += slept_us / 1000;
+}
+
+void hal_sleep_exit( void )
+{
+    sim_sleep_break = true;
+}
+
+#endif // SMTC_HAL_SIM
@@ -5,11 +5,29 @@
 #include <string.h>
 // Avoid pulling in stdio to keep libc small; use PRINTF from trace if needed
 
+// EasyDMA staging, sized for a 255-byte radio buffer plus command, dummy and CRC bytes
+#define HAL_SPI_DMA_BUF_SIZE    264
+
 static const nrfx_spim_t spi = NRFX_SPIM_INSTANCE( 3 );
-static uint8_t m_tx_buf[256] = { 0 };
-static uint8_t m_rx_buf[256] = { 0 };
+static uint8_t m_tx_buf[HAL_SPI_DMA_BUF_SIZE] = { 0 };
+static uint8_t m_rx_buf[HAL_SPI_DMA_BUF_SIZE] = { 0 };
 
 static bool spi_init = false;
+static hal_spi_stats_t spi_stats = { 0 };
+
+static void hal_spi_xfer( const nrfx_spim_xfer_desc_t* xfer_desc )
+{
+    uint16_t length = ( xfer_desc->tx_length > xfer_desc->rx_length ) ? xfer_desc->tx_length : xfer_desc->rx_length;
+
+    nrfx_spim_xfer( &spi, xfer_desc, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER );
+
+    spi_stats.transfers++;
+    spi_stats.bytes += length;
+    if( length > spi_stats.max_transfer )
+    {
+        spi_stats.max_transfer = length;
+    }
+}
 
 void hal_spi_init( void )
 {
@@ -45,7 +63,7 @@ void hal_spi_write( const uint8_t* buffer, uint16_t length )
     if( spi_init == true )
     {
         nrfx_spim_xfer_desc_t xfer_desc = NRFX_SPIM_XFER_TX( buffer, length );
-        nrfx_spim_xfer( &spi, &xfer_desc, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER );
+        hal_spi_xfer( &xfer_desc );
     }
 }
 
@@ -63,7 +81,7 @@ void hal_spi_write_read( const uint8_t* cbuffer, uint8_t* rbuffer, uint16_t leng
     if( spi_init == true )
     {
         nrfx_spim_xfer_desc_t xfer_desc = NRFX_SPIM_XFER_TRX( cbuffer, length, rbuffer, length );
-        nrfx_spim_xfer( &spi, &xfer_desc, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER );
+        hal_spi_xfer( &xfer_desc );
     }
 }
 
@@ -75,7 +93,7 @@ void hal_spi_read_with_dummy_byte( uint8_t* buffer, uint16_t length, uint8_t dum
         { 
             memset( m_tx_buf, dummy_byte, length );
             nrfx_spim_xfer_desc_t xfer_desc = NRFX_SPIM_XFER_TRX( m_tx_buf, length, buffer, length );
-            nrfx_spim_xfer( &spi, &xfer_desc, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER );
+            hal_spi_xfer( &xfer_desc );
         }
         else
         {
@@ -91,7 +109,88 @@ uint16_t hal_spi_in_out( const uint32_t id, const uint16_t out_data )
     {
         tv = ( uint8_t )( out_data & 0xFF );
         nrfx_spim_xfer_desc_t xfer_desc = NRFX_SPIM_XFER_TRX(( uint8_t *)(&tv), 1, ( uint8_t *)(&rv), 1 );
-        nrfx_spim_xfer( &spi, &xfer_desc, NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER );
+        hal_spi_xfer( &xfer_desc );
     }
 	return rv;
 }
+
+void hal_spi_transfer( const hal_spi_segment_t* segments, uint8_t segment_count, uint8_t fill_byte )
+{
+    uint8_t tx_seg = 0, rx_seg = 0;
+    uint16_t tx_offset = 0, rx_offset = 0;
+
+    if( spi_init == false )
+    {
+        return;
+    }
+
+    while( tx_seg < segment_count )
+    {
+        uint16_t chunk = 0, pos = 0;
+
+        // Gather the segments into one EasyDMA transfer, in buffer-sized pieces if they do not fit.
+        // The staging copy also makes flash-resident TX data safe for EasyDMA.
+        while(( tx_seg < segment_count ) && ( chunk < sizeof( m_tx_buf )))
+        {
+            uint16_t n = segments[tx_seg].length - tx_offset;
+
+            if( n > sizeof( m_tx_buf ) - chunk )
+            {
+                n = sizeof( m_tx_buf ) - chunk;
+            }
+            if( segments[tx_seg].tx != NULL )
+            {
+                memcpy( &m_tx_buf[chunk], &segments[tx_seg].tx[tx_offset], n );
+            }
+            else
+            {
+                memset( &m_tx_buf[chunk], fill_byte, n );
+            }
+            chunk += n;
+            tx_offset += n;
+            if( tx_offset == segments[tx_seg].length )
+            {
+                tx_seg++;
+                tx_offset = 0;
+            }
+        }
+
+        if( chunk > 0 )
+        {
+            nrfx_spim_xfer_desc_t xfer_desc = NRFX_SPIM_XFER_TRX( m_tx_buf, chunk, m_rx_buf, chunk );
+            hal_spi_xfer( &xfer_desc );
+        }
+
+        // Scatter what was clocked in back to the segments that want it
+        while( pos < chunk )
+        {
+            uint16_t n = segments[rx_seg].length - rx_offset;
+
+            if( n > chunk - pos )
+            {
+                n = chunk - pos;
+            }
+            if( segments[rx_seg].rx != NULL )
+            {
+                memcpy( &segments[rx_seg].rx[rx_offset], &m_rx_buf[pos], n );
+            }
+            pos += n;
+            rx_offset += n;
+            if( rx_offset == segments[rx_seg].length )
+            {
+                rx_seg++;
+                rx_offset = 0;
+            }
+        }
+    }
+}
+
+void hal_spi_get_stats( hal_spi_stats_t* stats )
+{
+    *stats = spi_stats;
+}
+
+void hal_spi_reset_stats( void )
+{
+    memset( &spi_stats, 0, sizeof( spi_stats ));
+}
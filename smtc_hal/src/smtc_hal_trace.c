@@ -1,13 +1,66 @@
-
 #include <stdint.h>   // C99 types
 #include <stdbool.h>  // bool type
 #include <string.h>
+#include "app_util_platform.h"
 #include "smtc_hal_uart.h"
 #include "smtc_hal_usb_cdc.h"
+#include "smtc_hal_rtc.h"
+#include "smtc_hal_mcu.h"
 #include "smtc_hal_trace.h"
 
 #define PRINT_BUFFER_SIZE 256
 
+// Record ring, must be a power of 2
+#ifndef HAL_TRACE_RING_SIZE
+#define HAL_TRACE_RING_SIZE 4096
+#endif
+
+#define HAL_TRACE_FLAG_BINARY 0x01
+
+// Binary records go out as a frame: sync, length, timestamp, category, then the record bytes
+#define HAL_TRACE_FRAME_SYNC      0x00  // never part of text output
+
+#if( HAL_TRACE_RING_SIZE & ( HAL_TRACE_RING_SIZE - 1 ))
+#error "HAL_TRACE_RING_SIZE must be a power of 2"
+#endif
+
+typedef struct
+{
+    uint16_t length;    // bytes following the header
+    uint8_t  category;
+    uint8_t  flags;     // HAL_TRACE_FLAG_*
+    uint32_t timestamp; // RTC2 ticks
+} hal_trace_record_t;
+
+static uint8_t trace_ring[HAL_TRACE_RING_SIZE];
+static volatile uint32_t trace_head = 0;    // written by producers only
+static volatile uint32_t trace_tail = 0;    // written by the drain only
+static volatile bool trace_draining = false;
+static hal_trace_stats_t trace_stats = { 0 };
+static uint32_t trace_dropped_reported = 0;
+
+static uint8_t trace_tx_buf[HAL_TRACE_TX_SIZE];
+
+static void hal_trace_ring_put( uint32_t pos, const void* data, uint32_t len )
+{
+    uint32_t offset = pos & ( HAL_TRACE_RING_SIZE - 1 );
+    uint32_t first = HAL_TRACE_RING_SIZE - offset;
+
+    if( first > len ) first = len;
+    memcpy( &trace_ring[offset], data, first );
+    memcpy( trace_ring, ( const uint8_t* ) data + first, len - first );
+}
+
+static void hal_trace_ring_get( uint32_t pos, void* data, uint32_t len )
+{
+    uint32_t offset = pos & ( HAL_TRACE_RING_SIZE - 1 );
+    uint32_t first = HAL_TRACE_RING_SIZE - offset;
+
+    if( first > len ) first = len;
+    memcpy( data, &trace_ring[offset], first );
+    memcpy(( uint8_t* ) data + first, trace_ring, len - first );
+}
+
 void hal_trace_print_var( const char* fmt, ... )
 {
     va_list args;
@@ -16,15 +69,162 @@ void hal_trace_print_var( const char* fmt, ... )
     va_end( args );
 }
 
-char string[PRINT_BUFFER_SIZE];
 void hal_trace_print( const char* fmt, va_list argp )
 {
-    if( 0 < vsprintf( string, fmt, argp ) )  // build string
+    char string[PRINT_BUFFER_SIZE];
+    int len = 0;
+
+    // Nothing would read the ring, skip the formatting too
+    if( !hal_usb_cdc_is_connected( )) return;
+
+    len = vsnprintf( string, sizeof( string ), fmt, argp );
+    if( len <= 0 ) return;
+    if( len >= ( int ) sizeof( string )) len = sizeof( string ) - 1;
+
+    hal_trace_write( HAL_TRACE_CATEGORY_NONE, string, len );
+}
+
+static void hal_trace_put_record( uint8_t category, uint8_t flags, const void* data, uint16_t len )
+{
+    hal_trace_record_t record;
+    uint32_t need;
+
+    if( !hal_usb_cdc_is_connected( ) || len == 0 ) return;
+
+    // A record must fit one transfer on its own, or the flush would stall on it
+    if( flags & HAL_TRACE_FLAG_BINARY )
+    {
+        if( len > HAL_TRACE_BINARY_MAX_SIZE )
+        {
+            trace_stats.dropped++;
+            return;
+        }
+    }
+    else if( len > HAL_TRACE_TX_SIZE )
+    {
+        len = HAL_TRACE_TX_SIZE;
+    }
+    need = sizeof( record ) + len;
+
+    record.length = len;
+    record.category = category;
+    record.flags = flags;
+    record.timestamp = hal_rtc_get_ticks( );
+
+    // Any context may log: the claim and the copy are one short critical region, never a wait on the output
+    CRITICAL_REGION_ENTER( );
+    uint32_t used = trace_head - trace_tail;
+    if( need > HAL_TRACE_RING_SIZE - used )
+    {
+        trace_stats.dropped++;
+    }
+    else
+    {
+        hal_trace_ring_put( trace_head, &record, sizeof( record ));
+        hal_trace_ring_put( trace_head + sizeof( record ), data, len );
+        trace_head += need;
+        trace_stats.records++;
+        if( used + need > trace_stats.high_water ) trace_stats.high_water = used + need;
+    }
+    CRITICAL_REGION_EXIT( );
+}
+
+void hal_trace_write( uint8_t category, const char* text, uint16_t len )
+{
+    hal_trace_put_record( category, 0, text, len );
+}
+
+void hal_trace_write_binary( uint8_t category, const uint8_t* data, uint16_t len )
+{
+    hal_trace_put_record( category, HAL_TRACE_FLAG_BINARY, data, len );
+}
+
+void hal_trace_flush( void )
+{
+    bool owner = false;
+    uint32_t tail = 0;
+    uint32_t head = 0;
+    uint16_t tx_len = 0;
+
+    CRITICAL_REGION_ENTER( );
+    if( !trace_draining )
+    {
+        trace_draining = true;
+        owner = true;
+    }
+    CRITICAL_REGION_EXIT( );
+    if( !owner ) return;
+
+    tail = trace_tail;
+    head = trace_head;
+
+    if( !hal_usb_cdc_is_port_open( ))
+    {
+        // Same as the former blocking write: output is lost while no terminal listens
+        trace_tail = head;
+    }
+    else if( tail != head && !hal_usb_cdc_is_tx_busy( ))
+    {
+        uint32_t dropped = trace_stats.dropped;
+
+        if( dropped != trace_dropped_reported )
+        {
+            tx_len = snprintf(( char* ) trace_tx_buf, HAL_TRACE_TX_SIZE, "\r\n[trace: %lu dropped]\r\n",
+                              dropped - trace_dropped_reported );
+        }
+
+        // Batch whole records, each fits one transfer with its frame header (hal_trace_put_record)
+        while( tail != head )
+        {
+            hal_trace_record_t record;
+            uint16_t frame_len = 0;
+
+            hal_trace_ring_get( tail, &record, sizeof( record ));
+            if( record.flags & HAL_TRACE_FLAG_BINARY ) frame_len = HAL_TRACE_FRAME_HDR_SIZE;
+            if( tx_len + frame_len + record.length > HAL_TRACE_TX_SIZE ) break;
+
+            if( frame_len > 0 )
+            {
+                uint16_t body_len = record.length + 5; // timestamp + category + record bytes
+
+                trace_tx_buf[tx_len++] = HAL_TRACE_FRAME_SYNC;
+                trace_tx_buf[tx_len++] = body_len & 0xFF;
+                trace_tx_buf[tx_len++] = body_len >> 8;
+                memcpy( &trace_tx_buf[tx_len], &record.timestamp, 4 ); // little endian, as the host expects
+                tx_len += 4;
+                trace_tx_buf[tx_len++] = record.category;
+            }
+            hal_trace_ring_get( tail + sizeof( record ), &trace_tx_buf[tx_len], record.length );
+            tx_len += record.length;
+            tail += sizeof( record ) + record.length;
+        }
+
+        // Records and the banner only leave the ring once USB CDC took them, a refused transfer is retried
+        if( tx_len > 0 && hal_usb_cdc_write_async( trace_tx_buf, tx_len ))
+        {
+            trace_tail = tail;
+            trace_dropped_reported = dropped;
+            trace_stats.bytes += tx_len;
+        }
+    }
+
+    trace_draining = false;
+}
+
+void hal_trace_flush_sync( uint32_t timeout_ms )
+{
+    uint32_t waited_us = 0;
+
+    while( trace_tail != trace_head && waited_us < timeout_ms * 1000 )
     {
-        // hal_uart_1_init( );
-        // hal_uart_1_tx(( uint8_t* ) string, strlen( string ));
-        // hal_uart_1_deinit( );
-        
-        hal_usb_cdc_write(( uint8_t* ) string, strlen( string ));
+        hal_usb_cdc_event_queue_process( );
+        hal_trace_flush( );
+        hal_mcu_wait_us( 100 );
+        waited_us += 100;
     }
-}
\ No newline at end of file
+}
+
+void hal_trace_get_stats( hal_trace_stats_t* stats )
+{
+    if( stats != NULL ) *stats = trace_stats;
+}
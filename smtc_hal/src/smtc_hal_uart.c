@@ -45,9 +45,6 @@ static app_uart_comm_params_t const commParams_1 =
 };
 
 uint8_t g_rx1_data[1]={ 0 };
-uint8_t g_rx1_buffer[256] = { 0 };
-uint16_t g_rx1_len = 0;
-uint8_t g_rx1_line = 0;
 
 void hal_uart_0_init( void )
 {	
@@ -192,23 +189,11 @@ static void uart0_handleEvent( app_uart_evt_t *pEvent )
     {
         case APP_UART_DATA_READY:
         {
-            app_uart_get( &uart0, g_rx1_data );
-            g_rx1_buffer[g_rx1_len ++] = g_rx1_data[0];
-            if(( g_rx1_len >= sizeof( g_rx1_buffer )) || ( g_rx1_buffer[0]!='$' ))
+            // Drain the FIFO into the NMEA tokenizer, it only queues complete sentences here
+            while( app_uart_get( &uart0, g_rx1_data ) == NRF_SUCCESS )
             {
-                g_rx1_len = 0;
+                gnss_parse_byte( g_rx1_data[0] );
             }
-            if(( g_rx1_data[0] == '\n' ) && ( g_rx1_len != 0 ))
-            {
-                g_rx1_line ++;
-                if( g_rx1_line >= 2 )
-                {
-                    gnss_parse_handler( g_rx1_buffer );
-                    memset( g_rx1_buffer, 0, sizeof( g_rx1_buffer ));
-                    g_rx1_line = 0;
-                    g_rx1_len = 0;
-                }
-            } 
             break;
         } 
 
@@ -42,6 +42,8 @@ static bool m_send_flag = 0;
 
 static bool m_usb_init = false;
 static bool m_usb_connected = false;
+static volatile bool m_port_open = false;
+static volatile bool m_tx_busy = false;
 
 #ifdef APP_TRACKER
 uint16_t g_usb_rec_index = 0;
@@ -59,6 +61,9 @@ static void cdc_acm_user_ev_handler( app_usbd_class_inst_t const * p_inst, app_u
     {
         case APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN:
         {
+            m_port_open = true;
+            m_tx_busy = false;
+
             /*Setup first transfer*/
             ret_code_t ret = app_usbd_cdc_acm_read( &m_app_cdc_acm, m_rx_buffer, READ_SIZE );
             UNUSED_VARIABLE(ret);
@@ -66,9 +71,12 @@ static void cdc_acm_user_ev_handler( app_usbd_class_inst_t const * p_inst, app_u
         }
 
         case APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE:
+            m_port_open = false;
+            m_tx_busy = false;
             break;
 
         case APP_USBD_CDC_ACM_USER_EVT_TX_DONE:
+            m_tx_busy = false;
             break;
         
         case APP_USBD_CDC_ACM_USER_EVT_RX_DONE:
@@ -139,6 +147,8 @@ static void usbd_user_ev_handler( app_usbd_event_type_t event )
             NRF_LOG_INFO( "USB power removed" );
             app_usbd_stop( );
             m_usb_connected = false;
+            m_port_open = false;
+            m_tx_busy = false;
             break;
         case APP_USBD_EVT_POWER_READY:
             NRF_LOG_INFO( "USB ready" );
@@ -191,6 +201,32 @@ void hal_usb_cdc_write( uint8_t* buff, uint16_t len )
     }
 }
 
+bool hal_usb_cdc_write_async( const uint8_t* buff, uint16_t len )
+{
+    if( !m_usb_connected || !m_port_open || m_tx_busy )
+    {
+        return false;
+    }
+
+    m_tx_busy = true;
+    if( app_usbd_cdc_acm_write( &m_app_cdc_acm, buff, len ) != NRF_SUCCESS )
+    {
+        m_tx_busy = false;
+        return false;
+    }
+    return true;
+}
+
+bool hal_usb_cdc_is_port_open( void )
+{
+    return m_usb_connected && m_port_open;
+}
+
+bool hal_usb_cdc_is_tx_busy( void )
+{
+    return m_tx_busy;
+}
+
 void hal_usb_cdc_read( uint8_t* buff, uint16_t len )
 {
     if( m_usb_connected )
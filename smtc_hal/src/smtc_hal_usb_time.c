@@ -3,6 +3,7 @@
 #include "nrf_drv_timer.h"
 #include "app_error.h"
 #include "smtc_hal_usb_cdc.h"
+#include "smtc_hal_trace.h"
 
 const nrf_drv_timer_t TIMER_USB = NRF_DRV_TIMER_INSTANCE(3);
 
@@ -18,6 +19,7 @@ void timer_usb_event_handler( nrf_timer_event_t event_type, void* p_context )
         case NRF_TIMER_EVENT_COMPARE0:
         {
             hal_usb_cdc_event_queue_process( );
+            hal_trace_flush( );
         }
         break;
 
@@ -39,6 +39,7 @@
 
 #include <stdint.h>   // C99 types
 #include <stdbool.h>  // bool type
+#include <string.h>   // memset
 
 #include "lr11xx_hal.h"
 #include "smtc_hal_gpio.h"
@@ -47,16 +48,29 @@
 
 #include "lr11xx_hal_context.h"
 
+#include "nrf.h"
+#include "app_util_platform.h"
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE MACROS-----------------------------------------------------------
  */
 
+#define LR11XX_HAL_SEGMENT_NUM( segments ) ( sizeof( segments ) / sizeof( segments[0] ) )
+
+// Free running 1 MHz timer measuring BUSY and waking the core on timeout, TIMER0 belongs to the SoftDevice
+#define LR11XX_HAL_BUSY_TIMER       NRF_TIMER2
+#define LR11XX_HAL_BUSY_TIMER_IRQn  TIMER2_IRQn
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+#define LR11XX_HAL_BUSY_TIMEOUT_US  3000000     // Same limit as the former 3000 x 1 ms poll
+#define LR11XX_HAL_BUSY_SPIN_US     20          // Most commands release BUSY within this, not worth a sleep
+#define LR11XX_HAL_BUSY_TICK_US     1000        // Backup wake-up in case the BUSY edge event is missed
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -75,6 +89,16 @@ typedef enum
 
 static volatile radio_mode_t radio_mode = RADIO_AWAKE;
 
+static lr11xx_hal_stats_t hal_stats = { 0 };
+static bool irq_mask_timing = false;
+static bool irq_mask_timed = false;
+static uint32_t irq_mask_start = 0;
+static uint16_t irq_mask_opcode = 0;
+
+static lr11xx_hal_busy_stats_t busy_stats[LR11XX_HAL_BUSY_STATS_NUM] = { 0 };
+static uint16_t busy_opcode = LR11XX_HAL_OPCODE_NONE;
+static volatile bool busy_timer_used = false;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
@@ -82,9 +106,26 @@ static volatile radio_mode_t radio_mode = RADIO_AWAKE;
 
 /**
  * @brief Wait until radio busy pin returns to 0
+ *
+ * Sleeps until the BUSY falling edge instead of polling, and charges the time to the previous opcode
  */
 static void lr11xx_hal_wait_on_busy( const uint32_t busy_pin );
 
+/**
+ * @brief Sleep until BUSY falls or the timeout expires
+ *
+ * @param [in] busy_pin BUSY pin
+ * @param [out] busy_us Time BUSY stayed high, in microseconds
+ *
+ * @returns true if BUSY fell before the timeout
+ */
+static bool lr11xx_hal_sleep_on_busy( const uint32_t busy_pin, uint32_t* busy_us );
+
+/**
+ * @brief Add one BUSY wait to the statistics of an opcode
+ */
+static void lr11xx_hal_busy_stats_add( const uint16_t opcode, const uint32_t busy_us );
+
 /**
  * @brief Check if device is ready to receive spi transaction.
  * @remark If the device is in sleep mode, it will awake it and wait until it is ready
@@ -93,8 +134,10 @@ static void lr11xx_hal_check_device_ready( const lr11xx_hal_context_t* lr11xx_co
 
 /**
  * @brief Disables interruptions used in Modem (radio_dio and timer)
+ *
+ * @param [in] opcode Opcode of the command about to be sent, for the statistics
  */
-static void modem_disable_irq( void );
+static void modem_disable_irq( const uint16_t opcode );
 
 /**
  * @brief Enables interruptions used in Modem (radio_dio and timer)
@@ -116,27 +159,23 @@ lr11xx_hal_status_t lr11xx_hal_write( const void* context, const uint8_t* comman
 #endif
 
     const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) context;
+    const hal_spi_segment_t     segments[]     = {
+        { .tx = command, .rx = NULL, .length = command_length },
+        { .tx = data, .rx = NULL, .length = data_length },
+#if defined( USE_LR11XX_CRC_OVER_SPI )
+        // Send the CRC byte at the end of the transaction
+        { .tx = &cmd_crc, .rx = NULL, .length = 1 },
+#endif
+    };
 
     lr11xx_hal_check_device_ready( lr11xx_context );
 
     // Disable IRQ to secure LR11XX concurrent access
-    modem_disable_irq( );
+    modem_disable_irq( ( ( uint16_t ) command[0] << 8 ) | command[1] );
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-    for( uint16_t i = 0; i < command_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
-    }
-    for( uint16_t i = 0; i < data_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, data[i] );
-    }
-
-#if defined( USE_LR11XX_CRC_OVER_SPI )
-    // Send the CRC byte at the end of the transaction
-    hal_spi_in_out( lr11xx_context->spi_id, cmd_crc );
-#endif
+    hal_spi_transfer( segments, LR11XX_HAL_SEGMENT_NUM( segments ), LR11XX_NOP );
 
     // Put NSS high as the spi transaction is finished
     hal_gpio_set_value( lr11xx_context->nss, 1 );
@@ -165,51 +204,47 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* context, const uint8_t* command
 #if defined( USE_LR11XX_CRC_OVER_SPI )
     // Compute the CRC over command array
     uint8_t cmd_crc = lr11xx_hal_compute_crc( 0xFF, command, command_length );
+    uint8_t dummy   = 0;
+    uint8_t rx_crc  = 0;
 #endif
 
     const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) context;
+    const hal_spi_segment_t     cmd_segments[] = {
+        { .tx = command, .rx = NULL, .length = command_length },
+#if defined( USE_LR11XX_CRC_OVER_SPI )
+        // Send the CRC byte at the end of the transaction
+        { .tx = &cmd_crc, .rx = NULL, .length = 1 },
+#endif
+    };
+    const hal_spi_segment_t data_segments[] = {
+#if defined( USE_LR11XX_CRC_OVER_SPI )
+        // dummy read, saved for crc calculation
+        { .tx = NULL, .rx = &dummy, .length = 1 },
+        { .tx = NULL, .rx = data, .length = data_length },
+        // read crc sent by lr11xx at the end of the transaction
+        { .tx = NULL, .rx = &rx_crc, .length = 1 },
+#else
+        // dummy read
+        { .tx = NULL, .rx = NULL, .length = 1 },
+        { .tx = NULL, .rx = data, .length = data_length },
+#endif
+    };
 
     lr11xx_hal_check_device_ready( lr11xx_context );
 
     // Disable IRQ to secure LR11XX concurrent access (temporary workaround)
-    modem_disable_irq( );
+    modem_disable_irq( ( ( uint16_t ) command[0] << 8 ) | command[1] );
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-    for( uint16_t i = 0; i < command_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
-    }
-
-#if defined( USE_LR11XX_CRC_OVER_SPI )
-    // Send the CRC byte at the end of the transaction
-    hal_spi_in_out( RADIO_SPI_ID, cmd_crc );
-#endif
-
+    hal_spi_transfer( cmd_segments, LR11XX_HAL_SEGMENT_NUM( cmd_segments ), LR11XX_NOP );
     hal_gpio_set_value( lr11xx_context->nss, 1 );
 
     if( data_length > 0 )
     {
         lr11xx_hal_check_device_ready( lr11xx_context );
         hal_gpio_set_value( lr11xx_context->nss, 0 );
-
-        // dummy read
-#if defined( USE_LR11XX_CRC_OVER_SPI )
-        // save dummy for crc calculation
-        const uint8_t dummy = hal_spi_in_out( RADIO_SPI_ID, LR11XX_NOP );
-#else
-        hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-#endif
-
-        for( uint16_t i = 0; i < data_length; i++ )
-        {
-            data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-        }
-
-#if defined( USE_LR11XX_CRC_OVER_SPI )
-        // read crc sent by lr11xx at the end of the transaction
-        const uint8_t rx_crc = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-#endif
+        hal_spi_transfer( data_segments, LR11XX_HAL_SEGMENT_NUM( data_segments ), LR11XX_NOP );
 
         // Put NSS high as the spi transaction is finished
         hal_gpio_set_value( lr11xx_context->nss, 1 );
@@ -236,25 +271,27 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* context, const uint8_t* command
 
 lr11xx_hal_status_t lr11xx_hal_direct_read( const void* radio, uint8_t* data, const uint16_t data_length )
 {
+#if defined( USE_LR11XX_CRC_OVER_SPI )
+    uint8_t rx_crc = 0;
+#endif
+
     const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) radio;
+    const hal_spi_segment_t     segments[]     = {
+        { .tx = NULL, .rx = data, .length = data_length },
+#if defined( USE_LR11XX_CRC_OVER_SPI )
+        // read crc sent by lr11xx by sending one more NOP
+        { .tx = NULL, .rx = &rx_crc, .length = 1 },
+#endif
+    };
 
     lr11xx_hal_check_device_ready( lr11xx_context );
 
     // Disable IRQ to secure LR11XX concurrent access
-    modem_disable_irq( );
+    modem_disable_irq( LR11XX_HAL_OPCODE_DIRECT_READ );
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-
-    for( uint16_t i = 0; i < data_length; i++ )
-    {
-        data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-    }
-
-#if defined( USE_LR11XX_CRC_OVER_SPI )
-    // read crc sent by lr11xx by sending one more NOP
-    const uint8_t rx_crc = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-#endif
+    hal_spi_transfer( segments, LR11XX_HAL_SEGMENT_NUM( segments ), LR11XX_NOP );
 
     hal_gpio_set_value( lr11xx_context->nss, 1 );
 
@@ -287,7 +324,8 @@ lr11xx_hal_status_t lr11xx_hal_reset( const void* context )
     // Wait until internal lr11xx fw is ready
     hal_mcu_wait_ms( 250 );
 
-    radio_mode = RADIO_AWAKE;
+    radio_mode  = RADIO_AWAKE;
+    busy_opcode = LR11XX_HAL_OPCODE_NONE;
 
     return LR11XX_HAL_STATUS_OK;
 }
@@ -299,6 +337,50 @@ lr11xx_hal_status_t lr11xx_hal_wakeup( const void* context )
     return LR11XX_HAL_STATUS_OK;
 }
 
+void lr11xx_hal_get_stats( lr11xx_hal_stats_t* stats )
+{
+    *stats = hal_stats;
+}
+
+bool lr11xx_hal_get_busy_stat( uint8_t index, lr11xx_hal_busy_stats_t* stats )
+{
+    bool used = false;
+
+    if( index >= LR11XX_HAL_BUSY_STATS_NUM )
+    {
+        return false;
+    }
+    CRITICAL_REGION_ENTER( );
+    used = busy_stats[index].count != 0;
+    *stats = busy_stats[index];
+    CRITICAL_REGION_EXIT( );
+    return used;
+}
+
+void lr11xx_hal_reset_stats( void )
+{
+    CRITICAL_REGION_ENTER( );
+    memset( &hal_stats, 0, sizeof( hal_stats ) );
+    memset( busy_stats, 0, sizeof( busy_stats ) );
+    CRITICAL_REGION_EXIT( );
+}
+
+void lr11xx_hal_enable_irq_mask_timing( bool enable )
+{
+    if( enable )
+    {
+        // The DWT cycle counter is only powered while measuring
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    else
+    {
+        DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+    }
+    irq_mask_timing = enable;
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
@@ -306,17 +388,132 @@ lr11xx_hal_status_t lr11xx_hal_wakeup( const void* context )
 
 static void lr11xx_hal_wait_on_busy( const uint32_t busy_pin )
 {
-    uint32_t cnt = 0;
-    while( hal_gpio_get_value( busy_pin ) == 1 )
+    uint32_t busy_us = 0;
+
+    if( hal_gpio_get_value( busy_pin ) == 1 )
     {
-        hal_mcu_wait_us( 1000 );
-        cnt ++;
-        if( cnt >= 3000 )
+        if( !lr11xx_hal_sleep_on_busy( busy_pin, &busy_us ) )
         {
+            hal_stats.busy_timeouts++;
             printf( "lr1110_hal_wait_on_busy\r\n" );
+        }
+    }
+
+    lr11xx_hal_busy_stats_add( busy_opcode, busy_us );
+}
+
+static bool lr11xx_hal_sleep_on_busy( const uint32_t busy_pin, uint32_t* busy_us )
+{
+    NRF_TIMER_Type* timer  = LR11XX_HAL_BUSY_TIMER;
+    uint32_t        start  = 0;
+    uint32_t        now    = 0;
+    uint32_t        scr    = 0;
+    bool            nested = false;
+
+    // Claim and start the timer in one step: an IRQ wait landing in between would find it claimed but stopped
+    CRITICAL_REGION_ENTER( );
+    nested = busy_timer_used;
+    if( !nested )
+    {
+        busy_timer_used    = true;
+        timer->TASKS_STOP  = 1;
+        timer->MODE        = TIMER_MODE_MODE_Timer;
+        timer->BITMODE     = TIMER_BITMODE_BITMODE_32Bit;
+        timer->PRESCALER   = 4;  // 16 MHz / 2^4
+        timer->TASKS_CLEAR = 1;
+        timer->TASKS_START = 1;
+    }
+    CRITICAL_REGION_EXIT( );
+    timer->TASKS_CAPTURE[1] = 1;
+    start = timer->CC[1];
+
+    // Short spin first, a sleep costs more than most commands keep BUSY high
+    do
+    {
+        timer->TASKS_CAPTURE[1] = 1;
+        now = timer->CC[1] - start;
+    } while( hal_gpio_get_value( busy_pin ) == 1 && now < LR11XX_HAL_BUSY_SPIN_US );
+
+    if( nested )
+    {
+        // Called from an IRQ that preempted another wait: the timer is already running, just poll it
+        while( hal_gpio_get_value( busy_pin ) == 1 && now < LR11XX_HAL_BUSY_TIMEOUT_US )
+        {
+            timer->TASKS_CAPTURE[1] = 1;
+            now = timer->CC[1] - start;
+        }
+        *busy_us = now;
+        return now < LR11XX_HAL_BUSY_TIMEOUT_US;
+    }
+
+    // BUSY falling edge is a GPIOTE event (see hal_gpio_init) and the compare a pending TIMER2 IRQ.
+    // SEVONPEND makes either of them end __WFE, even when called from an IRQ of the same priority.
+    scr = SCB->SCR;
+    SCB->SCR = scr | SCB_SCR_SEVONPEND_Msk;
+    timer->EVENTS_COMPARE[0] = 0;
+    timer->CC[0] = start + now + LR11XX_HAL_BUSY_TICK_US;
+    timer->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+
+    while( hal_gpio_get_value( busy_pin ) == 1 && now < LR11XX_HAL_BUSY_TIMEOUT_US )
+    {
+        if( timer->EVENTS_COMPARE[0] != 0 )
+        {
+            timer->EVENTS_COMPARE[0] = 0;
+            ( void ) timer->EVENTS_COMPARE[0];
+            NVIC_ClearPendingIRQ( LR11XX_HAL_BUSY_TIMER_IRQn );
+            timer->CC[0] += LR11XX_HAL_BUSY_TICK_US;
+        }
+        __WFE( );
+        timer->TASKS_CAPTURE[1] = 1;
+        now = timer->CC[1] - start;
+    }
+
+    // Stop and release together, for the same reason as the claim
+    CRITICAL_REGION_ENTER( );
+    timer->INTENCLR = TIMER_INTENCLR_COMPARE0_Msk;
+    timer->TASKS_STOP = 1;
+    timer->EVENTS_COMPARE[0] = 0;
+    ( void ) timer->EVENTS_COMPARE[0];
+    NVIC_ClearPendingIRQ( LR11XX_HAL_BUSY_TIMER_IRQn );
+    busy_timer_used = false;
+    CRITICAL_REGION_EXIT( );
+    SCB->SCR = scr;
+
+    *busy_us = now;
+    return now < LR11XX_HAL_BUSY_TIMEOUT_US;
+}
+
+static void lr11xx_hal_busy_stats_add( const uint16_t opcode, const uint32_t busy_us )
+{
+    lr11xx_hal_busy_stats_t* entry = &busy_stats[LR11XX_HAL_BUSY_STATS_NUM - 1];
+
+    // A radio IRQ wait may preempt a main context one right here
+    CRITICAL_REGION_ENTER( );
+    for( uint8_t i = 0; i < LR11XX_HAL_BUSY_STATS_NUM - 1; i++ )
+    {
+        if( busy_stats[i].count == 0 || busy_stats[i].opcode == opcode )
+        {
+            entry = &busy_stats[i];
             break;
         }
-    };
+    }
+
+    if( entry->count == 0 )
+    {
+        entry->opcode = ( entry == &busy_stats[LR11XX_HAL_BUSY_STATS_NUM - 1] ) ? LR11XX_HAL_OPCODE_OTHER : opcode;
+        entry->min_us = busy_us;
+    }
+    else if( busy_us < entry->min_us )
+    {
+        entry->min_us = busy_us;
+    }
+    if( busy_us > entry->max_us )
+    {
+        entry->max_us = busy_us;
+    }
+    entry->count++;
+    entry->total_us += busy_us;
+    CRITICAL_REGION_EXIT( );
 }
 
 static void lr11xx_hal_check_device_ready( const lr11xx_hal_context_t* lr11xx_context )
@@ -337,14 +534,35 @@ static void lr11xx_hal_check_device_ready( const lr11xx_hal_context_t* lr11xx_co
     }
 }
 
-static void modem_disable_irq( void )
+static void modem_disable_irq( const uint16_t opcode )
 {
     hal_gpio_irq_disable( );
     hal_lp_timer_irq_disable( );
+
+    hal_stats.commands++;
+    irq_mask_opcode = opcode;
+    busy_opcode     = opcode;
+    irq_mask_timed  = irq_mask_timing;
+    if( irq_mask_timed )
+    {
+        irq_mask_start = DWT->CYCCNT;
+    }
 }
 
 static void modem_enable_irq( void )
 {
+    if( irq_mask_timed )
+    {
+        uint32_t masked_us = ( DWT->CYCCNT - irq_mask_start ) / ( SystemCoreClock / 1000000 );
+
+        hal_stats.irq_masked_us += masked_us;
+        if( masked_us > hal_stats.irq_masked_max_us )
+        {
+            hal_stats.irq_masked_max_us     = masked_us;
+            hal_stats.irq_masked_max_opcode = irq_mask_opcode;
+        }
+    }
+
     hal_gpio_irq_enable( );
     hal_lp_timer_irq_enable( );
 }
@@ -44,6 +44,7 @@ extern "C" {
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*
  * -----------------------------------------------------------------------------
@@ -55,6 +56,12 @@ extern "C" {
  * --- PUBLIC CONSTANTS --------------------------------------------------------
  */
 
+#define LR11XX_HAL_BUSY_STATS_NUM       32      // Opcodes tracked, the last entry collects the others
+
+#define LR11XX_HAL_OPCODE_NONE          0x0000  // No command sent since boot or reset
+#define LR11XX_HAL_OPCODE_OTHER         0xFFFE  // Opcodes past the end of the table
+#define LR11XX_HAL_OPCODE_DIRECT_READ   0xFFFF  // Direct read, which has no command
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -68,11 +75,71 @@ typedef struct
     uint32_t             spi_id;
 } lr11xx_hal_context_t;
 
+/*!
+ * @brief SPI command statistics of the LR11xx HAL
+ */
+typedef struct
+{
+    uint32_t commands;               // Write, read and direct read transactions
+    uint32_t irq_masked_us;          // Time spent with the modem IRQs masked, while timing is enabled
+    uint32_t irq_masked_max_us;      // Longest single masked section
+    uint16_t irq_masked_max_opcode;  // Opcode of that section, 0xFFFF for a direct read
+    uint32_t busy_timeouts;          // BUSY waits abandoned after 3 s
+} lr11xx_hal_stats_t;
+
+/*!
+ * @brief BUSY time following one LR11xx command
+ *
+ * Each wait for BUSY low is charged to the opcode of the command sent just
+ * before, so a wait right after wake-up lands on the sleep command (0x011B).
+ */
+typedef struct
+{
+    uint16_t opcode;
+    uint32_t count;     // Waits, including those where BUSY was already low
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} lr11xx_hal_busy_stats_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
  */
 
+/*!
+ * @brief Get the SPI command statistics
+ *
+ * @param [out] stats Statistics since boot or the last reset
+ */
+void lr11xx_hal_get_stats( lr11xx_hal_stats_t* stats );
+
+/*!
+ * @brief Get one entry of the per-opcode BUSY statistics
+ *
+ * Entries are kept in first-seen order, the used ones first.
+ *
+ * @param [in]  index Entry index, from 0 to LR11XX_HAL_BUSY_STATS_NUM - 1
+ * @param [out] stats Entry copy
+ *
+ * @return false if the entry is unused or index is out of range
+ */
+bool lr11xx_hal_get_busy_stat( uint8_t index, lr11xx_hal_busy_stats_t* stats );
+
+/*!
+ * @brief Clear the SPI command and BUSY statistics
+ */
+void lr11xx_hal_reset_stats( void );
+
+/*!
+ * @brief Measure how long each command keeps the modem IRQs masked
+ *
+ * Runs the DWT cycle counter while enabled, keep it off in the field.
+ *
+ * @param [in] enable true to start measuring, false to stop
+ */
+void lr11xx_hal_enable_irq_mask_timing( bool enable );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,218 @@
+/*
+ * Host benchmark: minmea_parse_* against the fixed-point decoders in
+ * t1000_e/peripherals/src/nmea_parse.c, on one AG3335 epoch of sentences.
+ *
+ * Both paths start from sentences already tokenized by nmea_stream, as in
+ * the firmware, and end with the values ag3335.c uses (coordinates, speed,
+ * HDOP, GST errors, satellites).
+ *
+ *   gcc -O2 -I. -I../../peripherals/inc bench.c minmea.c \
+ *       ../../peripherals/src/nmea_stream.c ../../peripherals/src/nmea_parse.c -lm -o bench
+ *   ./bench [seconds per path]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "minmea.h"
+#include "nmea_stream.h"
+#include "nmea_parse.h"
+
+static const char *epoch_sentences[] = {
+    "$GNRMC,082153.000,A,2232.6402,N,11355.5826,E,0.36,154.84,170924,,,A,V*0C\r\n",
+    "$GNGGA,082153.000,2232.6402,N,11355.5826,E,1,14,0.86,52.4,M,-3.2,M,,*50\r\n",
+    "$GNGST,082153.000,7.3,4.1,3.2,35.1,3.9,3.5,6.8*41\r\n",
+    "$GNVTG,154.84,T,,M,0.36,N,0.67,K,A*2B\r\n",
+    "$GNZDA,082153.000,17,09,2024,,*4E\r\n",
+    "$GPGSV,3,1,10,02,50,321,38,05,18,052,31,10,27,187,33,12,78,053,42,1*64\r\n",
+    "$GPGSV,3,2,10,15,09,083,26,18,36,023,35,23,31,151,36,24,48,257,40,1*60\r\n",
+    "$GPGSV,3,3,10,25,61,346,41,32,12,297,28,1*65\r\n",
+    "$BDGSV,2,1,06,07,55,190,37,10,59,199,39,21,42,034,35,22,70,305,43,1*7F\r\n",
+    "$BDGSV,2,2,06,34,34,113,33,39,63,171,38,1*73\r\n",
+};
+
+#define EPOCH_MAX 16
+
+static nmea_stream_slot_t epoch[EPOCH_MAX];
+static nmea_stream_id_t epoch_id[EPOCH_MAX];
+static int epoch_len;
+
+static volatile double sink_float;
+static volatile int32_t sink_int;
+
+static void collect(const nmea_sentence_t *sentence)
+{
+    if (epoch_len == EPOCH_MAX)
+        return;
+    strcpy(epoch[epoch_len].line, sentence->line);
+    memcpy(epoch[epoch_len].field, sentence->field, sentence->field_count + 1);
+    epoch[epoch_len].field_count = sentence->field_count;
+    epoch_id[epoch_len] = sentence->id;
+    epoch_len++;
+}
+
+static int run_minmea(void)
+{
+    int parsed = 0;
+
+    for (int i = 0; i < epoch_len; i++) {
+        const char *line = epoch[i].line;
+        switch (minmea_sentence_id(line, false)) {
+            case MINMEA_SENTENCE_RMC: {
+                struct minmea_sentence_rmc frame;
+                if (minmea_parse_rmc(&frame, line)) {
+                    sink_float = minmea_tocoord(&frame.latitude) + minmea_tocoord(&frame.longitude) +
+                                 minmea_tofloat(&frame.speed);
+                    parsed++;
+                }
+            } break;
+            case MINMEA_SENTENCE_GGA: {
+                struct minmea_sentence_gga frame;
+                if (minmea_parse_gga(&frame, line)) {
+                    sink_float = minmea_tocoord(&frame.latitude) + minmea_tocoord(&frame.longitude) +
+                                 minmea_tofloat(&frame.hdop) + minmea_tofloat(&frame.altitude);
+                    parsed++;
+                }
+            } break;
+            case MINMEA_SENTENCE_GST: {
+                struct minmea_sentence_gst frame;
+                if (minmea_parse_gst(&frame, line)) {
+                    sink_float = minmea_tofloat(&frame.latitude_error_deviation) +
+                                 minmea_tofloat(&frame.longitude_error_deviation);
+                    parsed++;
+                }
+            } break;
+            case MINMEA_SENTENCE_GSV: {
+                struct minmea_sentence_gsv frame;
+                if (minmea_parse_gsv(&frame, line)) {
+                    sink_int = frame.sats[0].snr + frame.sats[3].snr;
+                    parsed++;
+                }
+            } break;
+            case MINMEA_SENTENCE_VTG: {
+                struct minmea_sentence_vtg frame;
+                if (minmea_parse_vtg(&frame, line)) {
+                    sink_float = minmea_tofloat(&frame.speed_knots);
+                    parsed++;
+                }
+            } break;
+            case MINMEA_SENTENCE_ZDA: {
+                struct minmea_sentence_zda frame;
+                if (minmea_parse_zda(&frame, line)) {
+                    sink_int = frame.date.year;
+                    parsed++;
+                }
+            } break;
+            default:
+                break;
+        }
+    }
+    return parsed;
+}
+
+static int run_fast(void)
+{
+    int parsed = 0;
+
+    for (int i = 0; i < epoch_len; i++) {
+        const nmea_sentence_t sentence = {
+            .id = epoch_id[i],
+            .line = epoch[i].line,
+            .field = epoch[i].field,
+            .field_count = epoch[i].field_count,
+        };
+        switch (sentence.id) {
+            case NMEA_ID_RMC: {
+                nmea_rmc_t rmc;
+                if (nmea_parse_rmc(&sentence, &rmc)) {
+                    sink_int = rmc.latitude + rmc.longitude + rmc.speed_ukn;
+                    parsed++;
+                }
+            } break;
+            case NMEA_ID_GGA: {
+                nmea_gga_t gga;
+                if (nmea_parse_gga(&sentence, &gga)) {
+                    sink_int = gga.latitude + gga.longitude + gga.hdop_x100 + gga.altitude_cm;
+                    parsed++;
+                }
+            } break;
+            case NMEA_ID_GST: {
+                nmea_gst_t gst;
+                if (nmea_parse_gst(&sentence, &gst)) {
+                    sink_int = gst.latitude_err_cm + gst.longitude_err_cm;
+                    parsed++;
+                }
+            } break;
+            case NMEA_ID_GSV: {
+                nmea_gsv_t gsv;
+                if (nmea_parse_gsv(&sentence, &gsv)) {
+                    sink_int = gsv.sats[0].snr + gsv.sats[3].snr;
+                    parsed++;
+                }
+            } break;
+            case NMEA_ID_VTG: {
+                nmea_vtg_t vtg;
+                if (nmea_parse_vtg(&sentence, &vtg)) {
+                    sink_int = vtg.speed_ukn;
+                    parsed++;
+                }
+            } break;
+            case NMEA_ID_ZDA: {
+                nmea_zda_t zda;
+                if (nmea_parse_zda(&sentence, &zda)) {
+                    sink_int = zda.year;
+                    parsed++;
+                }
+            } break;
+            default:
+                break;
+        }
+    }
+    return parsed;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench(const char *name, int (*run)(void), double seconds)
+{
+    long sentences = 0;
+    double start = now();
+    double elapsed;
+
+    do {
+        for (int i = 0; i < 1000; i++)
+            sentences += run();
+        elapsed = now() - start;
+    } while (elapsed < seconds);
+
+    printf("%-10s %12.0f sentences/s\n", name, sentences / elapsed);
+    return sentences / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    nmea_stream_t stream;
+
+    nmea_stream_init(&stream, collect);
+    for (size_t i = 0; i < sizeof(epoch_sentences) / sizeof(epoch_sentences[0]); i++)
+        nmea_stream_feed_buffer(&stream, (const uint8_t *) epoch_sentences[i], strlen(epoch_sentences[i]));
+
+    if (run_minmea() != epoch_len || run_fast() != epoch_len) {
+        fprintf(stderr, "%d sentences tokenized, minmea parsed %d, nmea_parse parsed %d\n",
+                epoch_len, run_minmea(), run_fast());
+        return 1;
+    }
+
+    double slow = bench("minmea", run_minmea, seconds);
+    double fast = bench("nmea_parse", run_fast, seconds);
+    printf("%-10s %12.2fx\n", "speedup", fast / slow);
+    return 0;
+}
@@ -14,6 +14,8 @@
 #include <check.h>
 
 #include "minmea.h"
+#include "nmea_stream.h"
+#include "nmea_parse.h"
 
 static const char *valid_sentences_nochecksum[] = {
     "$GPTXT,xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx",
@@ -956,6 +958,297 @@ START_TEST(test_minmea_parse_zda1)
 }
 END_TEST
 
+/* Specialized fixed-point path (nmea_stream + nmea_parse) against minmea_parse_*.
+ * Both must accept and reject the same sentences and decode the same values. */
+
+static const char *fast_parse_sentences[] = {
+    "$GPRMC,081836,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*62",
+    "$GPRMC,123205.00,A,5106.94085,N,01701.51689,E,0.016,,280214,,,A*7B",
+    "$GNRMC,225446.123,A,4916.4512345,N,12311.1234567,W,000.5,054.7,191194,020.3,E,A",
+    "$GPRMC,,V,,,,,,,,,,N",
+    "$GPRMC,081836,A,3751.65,X,14507.36,E,000.0,360.0,130998,011.3,E",
+    "$GPRMC,08183,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E",
+    "$GPRMC,081836,A,37-51.65,S,14507.36,E,000.0,360.0,130998,011.3,E",
+    "$GPRMC,081836,A,  3751.65,S,14507.36,E,000.0,360.0,1309,011.3,E",
+    "$GPRMC,081836,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3",
+    "$GPRMC,081836,A,-3751.65,S,+14507.36,E,.5,360.,130998,011.3,W",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,",
+    "$GPGGA,123204.00,5106.94086,N,01701.51680,E,1,06,3.86,127.9,M,40.5,M,,",
+    "$GNGGA,000000.999,0000.0000001,S,00000.00,W,2, 12,0.55,-12.345,M,-4.5,M,1.2,0000",
+    "$GPGGA,,,,,,0,00,99.99,,,,,,",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,8a,0.9,545.4,M,46.9,M,,",
+    "$GPGGA,123519,4807.038,N,01131.000,E,+,08,0.9,545.4,M,46.9,M,,",
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M",
+    "$GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6,22.0",
+    "$GNGST,024603.00,0.987654,,,,0.0123,12345.67891,",
+    "$GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6",
+    "$GPGST,024603.00,3.2,6.6,4.7,47.3,5.8.1,5.6,22.0",
+    "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00",
+    "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00,,,,",
+    "$GPGSV,4,4,13,39,31,170,27",
+    "$GPGSV,4,4,13",
+    "$GPGSV,4,4",
+    "$GPGSV,4,4,13,39,31,170,2x",
+    "$GPGSV,4,4,13,39,-3,170, 27",
+    "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K",
+    "$GPVTG,188.36,T,,M,0.820,N,1.519,K,A",
+    "$GPVTG,096.5,M,083.5,T,0.0,K,0.0,N,D",
+    "$GPVTG",
+    "$GPVTG,1.2.3,T",
+    "$GPZDA,201530.00,04,07,2002,00,00",
+    "$GPZDA,160012.71,11,03,2004,-1,00",
+    "$GPZDA,160012.71,11,03,2004,-14,00",
+    "$GPZDA,160012.71,11,03,2004,13,60",
+    "$GPZDA,160012.71,11,03,2004,1",
+    NULL,
+};
+
+static struct {
+    bool seen;
+    nmea_stream_id_t id;
+    bool ok;
+    nmea_rmc_t rmc;
+    nmea_gga_t gga;
+    nmea_gst_t gst;
+    nmea_gsv_t gsv;
+    nmea_vtg_t vtg;
+    nmea_zda_t zda;
+} fast;
+
+static void fast_handler(const nmea_sentence_t *sentence)
+{
+    fast.seen = true;
+    fast.id = sentence->id;
+    switch (sentence->id) {
+        case NMEA_ID_RMC: fast.ok = nmea_parse_rmc(sentence, &fast.rmc); break;
+        case NMEA_ID_GGA: fast.ok = nmea_parse_gga(sentence, &fast.gga); break;
+        case NMEA_ID_GST: fast.ok = nmea_parse_gst(sentence, &fast.gst); break;
+        case NMEA_ID_GSV: fast.ok = nmea_parse_gsv(sentence, &fast.gsv); break;
+        case NMEA_ID_VTG: fast.ok = nmea_parse_vtg(sentence, &fast.vtg); break;
+        case NMEA_ID_ZDA: fast.ok = nmea_parse_zda(sentence, &fast.zda); break;
+        default: fast.ok = false; break;
+    }
+}
+
+/* Tokenize one sentence, adding the checksum when it has none. */
+static bool fast_tokenize(const char *sentence, char *line, size_t size)
+{
+    nmea_stream_t stream;
+    const char *star = strchr(sentence, '*');
+
+    if (star)
+        snprintf(line, size, "%s\r\n", sentence);
+    else
+        snprintf(line, size, "%s*%02X\r\n", sentence, minmea_checksum(sentence));
+
+    memset(&fast, 0, sizeof(fast));
+    nmea_stream_init(&stream, fast_handler);
+    for (const char *c = line; *c; c++)
+        nmea_stream_feed(&stream, (uint8_t) *c);
+    return fast.seen;
+}
+
+static int32_t fast_time(const struct minmea_time *t)
+{
+    if (t->hours < 0)
+        return -1;
+    return ((t->hours * 60 + t->minutes) * 60 + t->seconds) * 1000 + t->microseconds / 1000;
+}
+
+static int32_t fast_scaled(const struct minmea_float *f, int32_t unit)
+{
+    return f->scale ? minmea_rescale(f, unit) : NMEA_PARSE_NONE;
+}
+
+/* Reference microdegrees in double, the fixed-point path may differ by rounding only. */
+static void fast_coord_eq(int32_t fast_value, const struct minmea_float *f)
+{
+    if (f->scale == 0) {
+        ck_assert_int_eq(fast_value, NMEA_PARSE_NONE);
+        return;
+    }
+    double degrees = (double) (f->value / (f->scale * 100));
+    double minutes = (double) (f->value % (f->scale * 100)) / f->scale;
+    double micro = (degrees + minutes / 60.0) * 1e6;
+    long expected = fabs(micro) >= INT32_MAX ? (micro < 0 ? -INT32_MAX : INT32_MAX) : lround(micro);
+    ck_assert_msg(labs(fast_value - expected) <= 1, "coordinate %d, expected %ld", fast_value, expected);
+}
+
+static void fast_compare(const char *sentence)
+{
+    char line[NMEA_STREAM_MAX_LENGTH + 8];
+    bool ok;
+
+    if (!fast_tokenize(sentence, line, sizeof(line)))
+        return; /* beyond what the tokenizer keeps, nothing to compare */
+
+    switch (fast.id) {
+        case NMEA_ID_RMC: {
+            struct minmea_sentence_rmc frame = {};
+            ok = minmea_parse_rmc(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.rmc.time_ms, fast_time(&frame.time));
+            ck_assert_int_eq(fast.rmc.valid, frame.valid);
+            fast_coord_eq(fast.rmc.latitude, &frame.latitude);
+            fast_coord_eq(fast.rmc.longitude, &frame.longitude);
+            ck_assert_int_eq(fast.rmc.speed_ukn, fast_scaled(&frame.speed, 1000000));
+            ck_assert_int_eq(fast.rmc.course_cdeg, fast_scaled(&frame.course, 100));
+            ck_assert_int_eq(fast.rmc.variation_cdeg, fast_scaled(&frame.variation, 100));
+            ck_assert_int_eq(fast.rmc.day, frame.date.day);
+            ck_assert_int_eq(fast.rmc.month, frame.date.month);
+            ck_assert_int_eq(fast.rmc.year, frame.date.year);
+        } break;
+
+        case NMEA_ID_GGA: {
+            struct minmea_sentence_gga frame = {};
+            ok = minmea_parse_gga(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.gga.time_ms, fast_time(&frame.time));
+            fast_coord_eq(fast.gga.latitude, &frame.latitude);
+            fast_coord_eq(fast.gga.longitude, &frame.longitude);
+            ck_assert_int_eq(fast.gga.fix_quality, frame.fix_quality);
+            ck_assert_int_eq(fast.gga.satellites, frame.satellites_tracked);
+            ck_assert_int_eq(fast.gga.hdop_x100, fast_scaled(&frame.hdop, 100));
+            ck_assert_int_eq(fast.gga.altitude_cm, fast_scaled(&frame.altitude, 100));
+            ck_assert_int_eq(fast.gga.altitude_units, frame.altitude_units);
+            ck_assert_int_eq(fast.gga.height_cm, fast_scaled(&frame.height, 100));
+            ck_assert_int_eq(fast.gga.height_units, frame.height_units);
+        } break;
+
+        case NMEA_ID_GST: {
+            struct minmea_sentence_gst frame = {};
+            ok = minmea_parse_gst(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.gst.time_ms, fast_time(&frame.time));
+            ck_assert_int_eq(fast.gst.rms_cm, fast_scaled(&frame.rms_deviation, 100));
+            ck_assert_int_eq(fast.gst.semi_major_cm, fast_scaled(&frame.semi_major_deviation, 100));
+            ck_assert_int_eq(fast.gst.semi_minor_cm, fast_scaled(&frame.semi_minor_deviation, 100));
+            ck_assert_int_eq(fast.gst.orientation_cdeg, fast_scaled(&frame.semi_major_orientation, 100));
+            ck_assert_int_eq(fast.gst.latitude_err_cm, fast_scaled(&frame.latitude_error_deviation, 100));
+            ck_assert_int_eq(fast.gst.longitude_err_cm, fast_scaled(&frame.longitude_error_deviation, 100));
+            ck_assert_int_eq(fast.gst.altitude_err_cm, fast_scaled(&frame.altitude_error_deviation, 100));
+        } break;
+
+        case NMEA_ID_GSV: {
+            struct minmea_sentence_gsv frame = {};
+            ok = minmea_parse_gsv(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.gsv.total_msgs, frame.total_msgs);
+            ck_assert_int_eq(fast.gsv.msg_nr, frame.msg_nr);
+            ck_assert_int_eq(fast.gsv.total_sats, frame.total_sats);
+            for (int i = 0; i < 4; i++) {
+                ck_assert_int_eq(fast.gsv.sats[i].nr, frame.sats[i].nr);
+                ck_assert_int_eq(fast.gsv.sats[i].elevation, frame.sats[i].elevation);
+                ck_assert_int_eq(fast.gsv.sats[i].azimuth, frame.sats[i].azimuth);
+                ck_assert_int_eq(fast.gsv.sats[i].snr, frame.sats[i].snr);
+            }
+        } break;
+
+        case NMEA_ID_VTG: {
+            struct minmea_sentence_vtg frame = {};
+            ok = minmea_parse_vtg(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.vtg.true_track_cdeg, fast_scaled(&frame.true_track_degrees, 100));
+            ck_assert_int_eq(fast.vtg.magnetic_track_cdeg, fast_scaled(&frame.magnetic_track_degrees, 100));
+            ck_assert_int_eq(fast.vtg.speed_ukn, fast_scaled(&frame.speed_knots, 1000000));
+            ck_assert_int_eq(fast.vtg.speed_kph_x1000, fast_scaled(&frame.speed_kph, 1000));
+            ck_assert_int_eq(fast.vtg.faa_mode, (char) frame.faa_mode);
+        } break;
+
+        case NMEA_ID_ZDA: {
+            struct minmea_sentence_zda frame = {};
+            ok = minmea_parse_zda(&frame, line);
+            ck_assert_msg(ok == fast.ok, "accept/reject differs: %s", line);
+            if (!ok)
+                break;
+            ck_assert_int_eq(fast.zda.time_ms, fast_time(&frame.time));
+            ck_assert_int_eq(fast.zda.day, frame.date.day);
+            ck_assert_int_eq(fast.zda.month, frame.date.month);
+            ck_assert_int_eq(fast.zda.year, frame.date.year);
+            ck_assert_int_eq(fast.zda.hour_offset, frame.hour_offset);
+            ck_assert_int_eq(fast.zda.minute_offset, frame.minute_offset);
+        } break;
+
+        default:
+            break;
+    }
+}
+
+START_TEST(test_fast_parse_sentences)
+{
+    for (const char **sentence=fast_parse_sentences; *sentence; sentence++)
+        fast_compare(*sentence);
+    for (const char **sentence=valid_sentences_checksum; *sentence; sentence++)
+        fast_compare(*sentence);
+}
+END_TEST
+
+START_TEST(test_fast_parse_values)
+{
+    char line[NMEA_STREAM_MAX_LENGTH + 8];
+
+    ck_assert(fast_tokenize("$GPRMC,081836.5,A,3751.65,S,14507.36,E,000.5,360.0,130998,011.3,E", line, sizeof(line)));
+    ck_assert(fast.ok);
+    ck_assert_int_eq(fast.rmc.time_ms, ((8 * 60 + 18) * 60 + 36) * 1000 + 500);
+    ck_assert_int_eq(fast.rmc.latitude, -37860833);
+    ck_assert_int_eq(fast.rmc.longitude, 145122667);
+    ck_assert_int_eq(fast.rmc.speed_ukn, 500000);
+
+    ck_assert(fast_tokenize("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,", line, sizeof(line)));
+    ck_assert(fast.ok);
+    ck_assert_int_eq(fast.gga.latitude, 48117300);
+    ck_assert_int_eq(fast.gga.longitude, 11516667);
+    ck_assert_int_eq(fast.gga.hdop_x100, 90);
+    ck_assert_int_eq(fast.gga.altitude_cm, 54540);
+
+    ck_assert(fast_tokenize("$GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6,22.0", line, sizeof(line)));
+    ck_assert(fast.ok);
+    ck_assert_int_eq(fast.gst.latitude_err_cm, 580);
+    ck_assert_int_eq(fast.gst.longitude_err_cm, 560);
+
+    ck_assert(fast_tokenize("$GPRMC,,V,,,,,,,,,,N", line, sizeof(line)));
+    ck_assert(fast.ok);
+    ck_assert_int_eq(fast.rmc.time_ms, -1);
+    ck_assert_int_eq(fast.rmc.latitude, NMEA_PARSE_NONE);
+    ck_assert_int_eq(fast.rmc.day, -1);
+}
+END_TEST
+
+/* Random single-character edits of known sentences, re-checksummed so both parsers see them. */
+START_TEST(test_fast_parse_mutations)
+{
+    static const char alphabet[] = "0123456789.,-+ NSEWAVTMKx";
+    uint32_t seed = 12345;
+
+    for (int round = 0; round < 20000; round++) {
+        const char *base = fast_parse_sentences[round % 11];
+        char sentence[NMEA_STREAM_MAX_LENGTH];
+        size_t len = strlen(base);
+
+        if (len >= sizeof(sentence))
+            continue;
+        memcpy(sentence, base, len + 1);
+        for (int edits = 0; edits < 1 + round % 3; edits++) {
+            seed = seed * 1103515245 + 12345;
+            size_t pos = 7 + (seed >> 8) % (len - 7);
+            seed = seed * 1103515245 + 12345;
+            sentence[pos] = alphabet[(seed >> 8) % (sizeof(alphabet) - 1)];
+        }
+        fast_compare(sentence);
+    }
+}
+END_TEST
+
 START_TEST(test_minmea_usage1)
 {
     const char *sentences[] = {
@@ -1179,6 +1472,12 @@ static Suite *minmea_suite(void)
     tcase_add_test(tc_parse, test_minmea_parse_zda1);
     suite_add_tcase(s, tc_parse);
 
+    TCase *tc_fast = tcase_create("nmea_parse");
+    tcase_add_test(tc_fast, test_fast_parse_sentences);
+    tcase_add_test(tc_fast, test_fast_parse_values);
+    tcase_add_test(tc_fast, test_fast_parse_mutations);
+    suite_add_tcase(s, tc_fast);
+
     TCase *tc_usage = tcase_create("minmea_usage");
     tcase_add_test(tc_usage, test_minmea_usage1);
     suite_add_tcase(s, tc_usage);
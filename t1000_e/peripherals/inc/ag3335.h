@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "gnss_sky.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,9 +26,37 @@ typedef struct {
     float    hacc;               // Horizontal accuracy estimate in meters (from GST)
     uint8_t  fix_quality;        // GGA fix quality (0=invalid, 1=GPS, 2=DGPS, etc.)
     uint8_t  satellites;         // Number of satellites tracked
+    int32_t  utc_ms;             // UTC time of day of the epoch in ms (-1 if unknown)
+    uint32_t timestamp_ms;       // RTC time (hal_rtc_get_time_ms) the epoch was assembled
     bool     valid;              // Overall fix validity
 } gnss_fix_t;
 
+/*!
+ * @brief Timing of the last gnss_scan_until_good acquisition
+ *
+ * All times are milliseconds from the start of the acquisition, 0 if the event never happened.
+ */
+typedef struct {
+    uint32_t start_ms;           // RTC time the acquisition was armed
+    uint32_t ttff_ms;            // Time to first valid fix (complete RMC+GGA+GST epoch)
+    uint32_t ttgf_ms;            // Time to first fix meeting the HDOP/HACC gates
+    uint32_t on_ms;              // Total time spent in the acquisition
+    uint32_t epochs;             // Complete NMEA epochs seen
+    bool     ble_abort;          // Acquisition ended by a BLE beacon
+    bool     sky_abort;          // Acquisition ended because the sky looked blocked
+    bool     check_abort;        // Acquisition ended by the gnss_set_scan_check( ) callback
+} gnss_acq_stats_t;
+
+/*!
+ * @brief Check run by gnss_scan_until_good( ) on every wake-up, see gnss_set_scan_check( )
+ *
+ * @param [in] elapsed_ms Time since the scan started
+ * @param [in] max_ms     Scan budget
+ * @param [in] sky        Current sky summary
+ * @returns true to end the scan now
+ */
+typedef bool ( *gnss_scan_check_t )( uint32_t elapsed_ms, uint32_t max_ms, const gnss_sky_metrics_t *sky );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -75,10 +104,39 @@ void gnss_get_position( int32_t *lat, int32_t *lon );
  */
 void gnss_parse_handler( char *nmea );
 
+/*!
+ * @brief Feed one byte received from the gnss uart
+ * 
+ * Sentences are tokenized and checksum-checked as the bytes arrive, then
+ * queued for gnss_nmea_process( ). Safe from the UART interrupt.
+ * 
+ * @param [in] c Received byte
+ */
+void gnss_parse_byte( uint8_t c );
+
+/*!
+ * @brief Parse the queued gnss sentences
+ * 
+ * Deferred worker of gnss_parse_byte( ), called from app_user_run_process( )
+ * and from the gnss waits. Must not be called from an interrupt.
+ */
+void gnss_nmea_process( void );
+
+/*!
+ * @brief Wait while parsing gnss sentences as they arrive
+ * 
+ * Use instead of hal_mcu_wait_ms( ) whenever the gnss uart is on, so the
+ * sentence queue keeps draining.
+ * 
+ * @param [in] ms Wait time in milliseconds
+ */
+void gnss_wait_ms( uint32_t ms );
+
 /*!
  * @brief Get current fix with quality metrics
  * 
- * Retrieves position along with HDOP and horizontal accuracy estimate.
+ * Retrieves the newest complete epoch: position, HDOP and horizontal
+ * accuracy from RMC, GGA and GST sentences sharing the same UTC time.
  * Use this for quality-driven scanning decisions.
  * 
  * @param [out] fix Pointer to gnss_fix_t structure to populate
@@ -86,11 +144,36 @@ void gnss_parse_handler( char *nmea );
  */
 bool gnss_get_quality_fix( gnss_fix_t *fix );
 
+/*!
+ * @brief Get a recent complete epoch
+ * 
+ * @param [in]  index 0 for the newest epoch, 1 for the one before, ...
+ * @param [out] fix   Pointer to gnss_fix_t to store the epoch
+ * @returns true if that epoch exists (it may still be an invalid fix)
+ */
+bool gnss_get_fix_history( uint8_t index, gnss_fix_t *fix );
+
+/*!
+ * @brief Get number of complete epochs held since the last scan start
+ * 
+ * @returns Number of epochs available to gnss_get_fix_history
+ */
+uint8_t gnss_get_fix_history_count( void );
+
+/*!
+ * @brief Get age of a fix
+ * 
+ * @param [in] fix Fix returned by gnss_get_quality_fix or gnss_get_fix_history
+ * @returns Milliseconds since the epoch was assembled
+ */
+uint32_t gnss_fix_age_ms( const gnss_fix_t *fix );
+
 /*!
  * @brief Quality-driven GNSS scan with early exit
  * 
- * Runs GNSS scan with 1 Hz quality checks. Exits early when fix meets
- * quality thresholds or timeout is reached.
+ * Each complete RMC+GGA+GST epoch is evaluated as soon as it is parsed; the
+ * MCU sleeps in between and is woken when an epoch meets the quality
+ * thresholds, a BLE beacon is found or the timeout is reached.
  * 
  * @param [in]  max_ms                Maximum scan duration in milliseconds
  * @param [in]  max_hdop              Maximum acceptable HDOP (e.g., 3.0)
@@ -101,6 +184,55 @@ bool gnss_get_quality_fix( gnss_fix_t *fix );
  */
 bool gnss_scan_until_good( uint32_t max_ms, float max_hdop, float max_hacc, gnss_fix_t *fix, bool skip_power_management );
 
+/*!
+ * @brief Get timing statistics of the last quality-driven scan
+ *
+ * @param [out] stats Pointer to gnss_acq_stats_t to store the result
+ */
+void gnss_get_acq_stats( gnss_acq_stats_t *stats );
+
+/*!
+ * @brief Get the sky summary of the current scan
+ *
+ * Built from every GSV part of every constellation. Satellites not listed
+ * for GNSS_SKY_STALE_MS are left out.
+ *
+ * @param [out] metrics Pointer to gnss_sky_metrics_t to store the result
+ */
+void gnss_sky_get_metrics( gnss_sky_metrics_t *metrics );
+
+/*!
+ * @brief Copy the current sky table
+ *
+ * @param [out] sats Array receiving the satellites
+ * @param [in]  max  Size of sats
+ * @returns Number of satellites copied
+ */
+uint8_t gnss_sky_get_satellites( gnss_sky_sat_t *sats, uint8_t max );
+
+/*!
+ * @brief Let the next quality-driven scan give up under a blocked sky
+ *
+ * Once check_ms have passed and GSV has been received, the scan ends when
+ * no satellite reaches GNSS_SKY_STRONG_CN0 and the top-4 mean C/N0 is below
+ * min_top4_cn0 (under water, in a pocket). Applies to the next
+ * gnss_scan_until_good( ) only.
+ *
+ * @param [in] check_ms     Time from the scan start before the sky is judged, 0 to disable
+ * @param [in] min_top4_cn0 Top-4 mean C/N0 in dB-Hz below which the sky counts as blocked
+ */
+void gnss_set_sky_abort( uint32_t check_ms, uint8_t min_top4_cn0 );
+
+/*!
+ * @brief Let the caller end the next quality-driven scan
+ *
+ * check runs at least every GNSS_ACQ_SLEEP_SLICE_MS while the next
+ * gnss_scan_until_good( ) waits for a good fix. Applies to that scan only.
+ *
+ * @param [in] check Callback, NULL for none
+ */
+void gnss_set_scan_check( gnss_scan_check_t check );
+
 /*!
  * @brief Check if BLE beacon was found (for scan interruption)
  * 
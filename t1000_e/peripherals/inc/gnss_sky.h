@@ -0,0 +1,125 @@
+#ifndef __PERIPHERAL_GNSS_SKY_H__
+#define __PERIPHERAL_GNSS_SKY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nmea_stream.h"
+#include "nmea_parse.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+#ifndef GNSS_SKY_STRONG_CN0
+#define GNSS_SKY_STRONG_CN0     30      // dB-Hz, a satellite usable for a good fix
+#endif
+
+#ifndef GNSS_SKY_STALE_MS
+#define GNSS_SKY_STALE_MS       3000    // A satellite not listed in GSV for this long leaves the sky table
+#endif
+
+#ifndef GNSS_SKY_MAX_SATS
+#define GNSS_SKY_MAX_SATS       48
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Constellation of a satellite reported in GSV, from the talker ID
+ */
+typedef enum {
+    GNSS_SKY_GPS,                // GP
+    GNSS_SKY_GLONASS,            // GL
+    GNSS_SKY_GALILEO,            // GA
+    GNSS_SKY_BEIDOU,             // GB, BD
+    GNSS_SKY_QZSS,               // GQ
+    GNSS_SKY_OTHER,
+    GNSS_SKY_CONSTELLATION_NUM
+} gnss_sky_constellation_t;
+
+/*!
+ * @brief One satellite of the GSV sky table
+ */
+typedef struct {
+    uint8_t  constellation;      // gnss_sky_constellation_t
+    uint8_t  prn;
+    int8_t   elevation;          // Degrees, 0 if not reported
+    uint16_t azimuth;            // Degrees, 0 if not reported
+    uint8_t  cn0;                // dB-Hz, 0 if not tracked
+    uint32_t seen_ms;            // Time of the last GSV listing it
+} gnss_sky_sat_t;
+
+/*!
+ * @brief Sky summary over the satellites listed in the last GNSS_SKY_STALE_MS of GSV
+ */
+typedef struct {
+    uint8_t  in_view;            // Satellites listed
+    uint8_t  tracked;            // Satellites with a C/N0
+    uint8_t  strong;             // Satellites at or above GNSS_SKY_STRONG_CN0 dB-Hz
+    uint8_t  top4_cn0;           // Mean C/N0 of the 4 strongest, untracked slots count as 0
+    uint8_t  quadrant_mask;      // Bit n set: a strong satellite with azimuth in [90n, 90n + 90)
+    uint8_t  quadrants;          // Bits set in quadrant_mask
+    uint8_t  tracked_by_constellation[GNSS_SKY_CONSTELLATION_NUM];
+    uint32_t gsv_count;          // GSV sentences since the last gnss_sky_table_reset( )
+} gnss_sky_metrics_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Empty the sky table
+ */
+void gnss_sky_table_reset( void );
+
+/*!
+ * @brief Constellation of a GSV talker ID
+ *
+ * @param [in] talker Two talker characters of the sentence
+ */
+uint8_t gnss_sky_constellation( const char* talker );
+
+/*!
+ * @brief Add the satellites of one GSV part
+ *
+ * Satellites are keyed by constellation and PRN; a full table replaces the
+ * satellite listed longest ago. Only whole 4-field blocks are read, so the
+ * NMEA 4.10 signal ID after the last one is not taken for a PRN.
+ *
+ * @param [in] sentence GSV sentence from the nmea_stream handler
+ * @param [in] gsv      The same sentence decoded by nmea_parse_gsv( )
+ * @param [in] now_ms   Current time in ms, any monotonic clock
+ */
+void gnss_sky_table_update( const nmea_sentence_t* sentence, const nmea_gsv_t* gsv, uint32_t now_ms );
+
+/*!
+ * @brief Summarise the satellites listed in the last GNSS_SKY_STALE_MS
+ *
+ * @param [out] metrics Sky summary
+ * @param [in]  now_ms  Current time on the clock given to gnss_sky_table_update( )
+ */
+void gnss_sky_table_metrics( gnss_sky_metrics_t* metrics, uint32_t now_ms );
+
+/*!
+ * @brief Read the sky table in place
+ *
+ * @param [out] count Entries in the table, stale ones included
+ *
+ * @return First entry, check seen_ms against GNSS_SKY_STALE_MS
+ */
+const gnss_sky_sat_t* gnss_sky_table_get( uint8_t* count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef __PERIPHERAL_NMEA_PARSE_H__
+#define __PERIPHERAL_NMEA_PARSE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nmea_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+#define NMEA_PARSE_NONE         INT32_MIN   // numeric field was empty
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Decoded sentences, fixed point only
+ *
+ * Coordinates are signed microdegrees, distances centimetres, angles
+ * centidegrees, speeds knots * 1e6 (same unit as gnss_fix_t.speed).
+ * Empty numeric fields are NMEA_PARSE_NONE, empty times -1. A coordinate
+ * without its N/S/E/W letter decodes to 0, as with minmea.
+ */
+typedef struct {
+    int32_t time_ms;            // UTC time of day in ms
+    bool    valid;              // status 'A'
+    int32_t latitude;
+    int32_t longitude;
+    int32_t speed_ukn;
+    int32_t course_cdeg;
+    int8_t  day;                // -1 if the date is empty
+    int8_t  month;
+    int8_t  year;               // two digits
+    int32_t variation_cdeg;
+} nmea_rmc_t;
+
+typedef struct {
+    int32_t time_ms;
+    int32_t latitude;
+    int32_t longitude;
+    int32_t fix_quality;
+    int32_t satellites;
+    int32_t hdop_x100;
+    int32_t altitude_cm;
+    char    altitude_units;
+    int32_t height_cm;
+    char    height_units;
+} nmea_gga_t;
+
+typedef struct {
+    int32_t time_ms;
+    int32_t rms_cm;
+    int32_t semi_major_cm;
+    int32_t semi_minor_cm;
+    int32_t orientation_cdeg;
+    int32_t latitude_err_cm;
+    int32_t longitude_err_cm;
+    int32_t altitude_err_cm;
+} nmea_gst_t;
+
+typedef struct {
+    int32_t nr;
+    int32_t elevation;
+    int32_t azimuth;
+    int32_t snr;
+} nmea_gsv_sat_t;
+
+typedef struct {
+    int32_t        total_msgs;
+    int32_t        msg_nr;
+    int32_t        total_sats;
+    nmea_gsv_sat_t sats[4];     // 0 when absent
+} nmea_gsv_t;
+
+typedef struct {
+    int32_t true_track_cdeg;    // NMEA_PARSE_NONE unless followed by 'T'
+    int32_t magnetic_track_cdeg;
+    int32_t speed_ukn;
+    int32_t speed_kph_x1000;
+    char    faa_mode;
+} nmea_vtg_t;
+
+typedef struct {
+    int32_t time_ms;
+    int32_t day;
+    int32_t month;
+    int32_t year;
+    int32_t hour_offset;
+    int32_t minute_offset;
+} nmea_zda_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Decode sentences tokenized by nmea_stream
+ *
+ * Each decoder accepts and rejects exactly the sentences the matching
+ * minmea_parse_*( ) does, reading the fields in place without a format
+ * interpreter or float math. The sentence type is not checked again, the
+ * caller dispatches on sentence->id.
+ *
+ * @param [in]  sentence Sentence passed to the nmea_stream handler
+ * @param [out] out      Decoded fields, undefined when false is returned
+ *
+ * @return true if every field is well formed
+ */
+bool nmea_parse_rmc( const nmea_sentence_t* sentence, nmea_rmc_t* out );
+bool nmea_parse_gga( const nmea_sentence_t* sentence, nmea_gga_t* out );
+bool nmea_parse_gst( const nmea_sentence_t* sentence, nmea_gst_t* out );
+bool nmea_parse_gsv( const nmea_sentence_t* sentence, nmea_gsv_t* out );
+bool nmea_parse_vtg( const nmea_sentence_t* sentence, nmea_vtg_t* out );
+bool nmea_parse_zda( const nmea_sentence_t* sentence, nmea_zda_t* out );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef __PERIPHERAL_NMEA_STREAM_H__
+#define __PERIPHERAL_NMEA_STREAM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+#define NMEA_STREAM_MAX_LENGTH  128 // longest sentence kept, including '$' and "*CS"
+#define NMEA_STREAM_MAX_FIELDS  24  // address field included
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Sentence identifiers resolved by the tokenizer
+ */
+typedef enum {
+    NMEA_ID_UNKNOWN = 0,
+    NMEA_ID_GGA,
+    NMEA_ID_GLL,
+    NMEA_ID_GSA,
+    NMEA_ID_GSV,
+    NMEA_ID_GST,
+    NMEA_ID_RMC,
+    NMEA_ID_VTG,
+    NMEA_ID_ZDA,
+    NMEA_ID_TXT,
+    NMEA_ID_PAIR,                // Airoha PAIR command/response, number in pair_id
+} nmea_stream_id_t;
+
+/*!
+ * @brief Checksum-valid sentence, valid only for the duration of the handler call
+ *
+ * line points into the tokenizer buffer: "$TTSSS,...*CS" NUL terminated.
+ * field[i] is the offset of field i in line, field 0 being the address field;
+ * field[field_count] is the offset just past '*'.
+ */
+typedef struct {
+    nmea_stream_id_t id;
+    char             talker[2];  // "GP", "GN", "GL"... ("PA" for PAIR)
+    uint16_t         pair_id;    // PAIR number when id is NMEA_ID_PAIR
+    const char*      line;
+    const uint8_t*   field;
+    uint8_t          field_count;
+} nmea_sentence_t;
+
+typedef void ( *nmea_stream_handler_t )( const nmea_sentence_t* sentence );
+
+/*!
+ * @brief Queued checksum-valid sentence, see nmea_stream_set_queue( )
+ */
+typedef struct {
+    char     line[NMEA_STREAM_MAX_LENGTH];
+    uint8_t  field[NMEA_STREAM_MAX_FIELDS + 1];
+    uint8_t  field_count;
+} nmea_stream_slot_t;
+
+/*!
+ * @brief Tokenizer state, one per byte stream
+ */
+typedef struct {
+    nmea_stream_handler_t handler;
+    char     buf[NMEA_STREAM_MAX_LENGTH];
+    uint8_t  field[NMEA_STREAM_MAX_FIELDS + 1]; // +1 for the '*' sentinel
+    uint8_t  len;
+    uint8_t  field_count;
+    uint8_t  state;
+    uint8_t  chk;
+    uint8_t  rx_chk;
+    uint32_t sentences;          // sentences dispatched
+    uint32_t checksum_errors;    // sentences dropped on checksum mismatch
+    uint32_t overruns;           // sentences dropped for length, field count or bad characters
+    volatile bool reset_request; // set by nmea_stream_reset( ), acted on by the next nmea_stream_feed( )
+
+    nmea_stream_slot_t* queue;   // NULL: the handler runs from nmea_stream_feed( )
+    uint8_t  queue_size;         // power of 2
+    volatile uint8_t queue_head; // written by nmea_stream_feed( ) only
+    volatile uint8_t queue_tail; // written by nmea_stream_process( ) only
+    uint8_t  queue_high_water;   // most sentences waiting at once
+    uint32_t queue_overruns;     // complete sentences dropped because the queue was full
+} nmea_stream_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Reset a tokenizer and bind its sentence handler
+ *
+ * @param [in] stream  Tokenizer state
+ * @param [in] handler Called once per checksum-valid sentence
+ */
+void nmea_stream_init( nmea_stream_t* stream, nmea_stream_handler_t handler );
+
+/*!
+ * @brief Drop any partial or queued sentence, keeping handler and counters
+ *
+ * Safe to call from the consumer context while the feed runs in an interrupt:
+ * the partial sentence is dropped by the feed itself on its next byte.
+ *
+ * @param [in] stream Tokenizer state
+ */
+void nmea_stream_reset( nmea_stream_t* stream );
+
+/*!
+ * @brief Queue complete sentences instead of running the handler from the feed
+ *
+ * nmea_stream_feed( ) can then run in interrupt context at the cost of a copy
+ * per sentence; the handler runs from nmea_stream_process( ) in the context
+ * that calls it. The feed is the only producer and nmea_stream_process( )
+ * the only consumer, so the queue needs no lock.
+ *
+ * @param [in] stream Tokenizer state
+ * @param [in] slots  Sentence slots, owned by the stream from now on
+ * @param [in] count  Number of slots, a power of 2 up to 128
+ */
+void nmea_stream_set_queue( nmea_stream_t* stream, nmea_stream_slot_t* slots, uint8_t count );
+
+/*!
+ * @brief Run the handler on every queued sentence, oldest first
+ *
+ * @param [in] stream Tokenizer state
+ *
+ * @return Number of sentences handled
+ */
+uint8_t nmea_stream_process( nmea_stream_t* stream );
+
+/*!
+ * @brief Check for queued sentences
+ *
+ * @param [in] stream Tokenizer state
+ *
+ * @return true if nmea_stream_process( ) has work
+ */
+bool nmea_stream_pending( const nmea_stream_t* stream );
+
+/*!
+ * @brief Feed one received byte
+ *
+ * Checksum and field boundaries are computed as the bytes arrive; the handler
+ * runs from this call as soon as the second checksum digit is received, or
+ * the sentence is queued when the stream has a queue.
+ *
+ * @param [in] stream Tokenizer state
+ * @param [in] c      Received byte
+ */
+void nmea_stream_feed( nmea_stream_t* stream, uint8_t c );
+
+/*!
+ * @brief Feed a block of received bytes
+ *
+ * @param [in] stream Tokenizer state
+ * @param [in] data   Received bytes
+ * @param [in] len    Number of bytes
+ */
+void nmea_stream_feed_buffer( nmea_stream_t* stream, const uint8_t* data, uint16_t len );
+
+/*!
+ * @brief Get field length
+ *
+ * @param [in] sentence Sentence passed to the handler
+ * @param [in] index    Field index, 0 is the address field
+ *
+ * @return Field length in bytes, 0 if empty or absent
+ */
+uint8_t nmea_stream_field_len( const nmea_sentence_t* sentence, uint8_t index );
+
+/*!
+ * @brief Parse a signed decimal integer field in place
+ *
+ * @param [in]  sentence Sentence passed to the handler
+ * @param [in]  index    Field index
+ * @param [out] value    Parsed value
+ *
+ * @return true if the field is present and numeric
+ */
+bool nmea_stream_field_int( const nmea_sentence_t* sentence, uint8_t index, int32_t* value );
+
+/*!
+ * @brief Parse an unsigned hexadecimal field in place
+ *
+ * @param [in]  sentence Sentence passed to the handler
+ * @param [in]  index    Field index
+ * @param [out] value    Parsed value
+ *
+ * @return true if the field is present and hexadecimal
+ */
+bool nmea_stream_field_hex( const nmea_sentence_t* sentence, uint8_t index, uint32_t* value );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -3,13 +3,8 @@
 #include "smtc_hal_dbg_trace.h"
 #include "log_filter.h"
 #include <math.h>
-// Silence redefinition warning and keep local buffer size choice
-#ifdef MINMEA_MAX_SENTENCE_LENGTH
-#undef MINMEA_MAX_SENTENCE_LENGTH
-#endif
-#include "minmea.h"
-// Override header's default length with local choice
-#undef MINMEA_MAX_SENTENCE_LENGTH
+#include "nmea_stream.h"
+#include "nmea_parse.h"
 
 // Lightweight, easily toggled troubleshooting tracing for GNSS power lifecycle.
 // To disable at build time, pass -DGNSS_TRACE=0 in your project defines.
@@ -31,22 +26,68 @@
 
 #define GPS_INFO_PRINTF false
 
-// Local parsing buffer size
-#define MINMEA_MAX_SENTENCE_LENGTH  128
-static char gps_nmea_line[MINMEA_MAX_SENTENCE_LENGTH] = { 0 };
+// Sentences received but not parsed yet; a full queue drops whole sentences and counts them
+#ifndef GNSS_NMEA_QUEUE_SLOTS
+#define GNSS_NMEA_QUEUE_SLOTS 16
+#endif
 
-static struct minmea_sentence_rmc frame_rmc;
-static struct minmea_sentence_gga frame_gga;
-static struct minmea_sentence_gst frame_gst;
-static struct minmea_sentence_gsv frame_gsv;
-static struct minmea_sentence_vtg frame_vtg;
-static struct minmea_sentence_zda frame_zda;
+static void gnss_nmea_sentence_handler( const nmea_sentence_t *sentence );
+
+// Byte-fed tokenizer for the AG3335 UART. The UART event only tokenizes and queues,
+// sentences are parsed by gnss_nmea_process( ) from the main context.
+static nmea_stream_slot_t gnss_queue[GNSS_NMEA_QUEUE_SLOTS];
+static nmea_stream_t gnss_stream = {
+    .handler    = gnss_nmea_sentence_handler,
+    .queue      = gnss_queue,
+    .queue_size = GNSS_NMEA_QUEUE_SLOTS,
+};
+static volatile bool gnss_nmea_pending = false;
+
+static nmea_rmc_t frame_rmc = { .latitude = NMEA_PARSE_NONE, .longitude = NMEA_PARSE_NONE, .speed_ukn = NMEA_PARSE_NONE };
+static nmea_gga_t frame_gga;
+static nmea_gst_t frame_gst;
+static nmea_gsv_t frame_gsv;
+static nmea_vtg_t frame_vtg;
+static nmea_zda_t frame_zda;
 
 static int32_t latitude_i32 = 0, longitude_i32 = 0, speed_i32 = 0;
 
 // BLE interrupt flag for quality-driven scanning
 static volatile bool ble_beacon_found = false;
 
+// NMEA epoch tracking: RMC, GGA and GST carrying the same UTC time form one epoch
+#define GNSS_EPOCH_RMC      0x01
+#define GNSS_EPOCH_GGA      0x02
+#define GNSS_EPOCH_GST      0x04
+#define GNSS_EPOCH_COMPLETE ( GNSS_EPOCH_RMC | GNSS_EPOCH_GGA | GNSS_EPOCH_GST )
+
+static int32_t epoch_time_ms = -1;
+static uint8_t epoch_mask = 0;
+static bool epoch_gst_seen = false; // without GST output an epoch is RMC+GGA (HACC from HDOP)
+static gnss_fix_t epoch_fix = { 0 }; // fields collected so far for epoch_time_ms
+
+// Completed epochs, newest at fix_ring_head - 1. Written by gnss_nmea_process( ) and
+// read by the fix getters, all in main context, so no reader can see a partial epoch.
+#define GNSS_FIX_RING_SIZE  8
+static gnss_fix_t fix_ring[GNSS_FIX_RING_SIZE];
+static uint8_t fix_ring_head = 0;
+static uint8_t fix_ring_count = 0;
+
+// Event-driven quality acquisition, evaluated on each completed epoch
+static volatile bool acq_armed = false;
+static volatile bool acq_good = false;
+static float acq_max_hdop = 0.0f;
+static float acq_max_hacc = 0.0f;
+static gnss_fix_t acq_fix = { 0 };
+static gnss_acq_stats_t acq_stats = { 0 };
+
+static const char *const sky_names[GNSS_SKY_CONSTELLATION_NUM] = { "GPS", "GLO", "GAL", "BDS", "QZS", "??" };
+
+// Blocked-sky gate and caller check for the next gnss_scan_until_good( )
+static uint32_t sky_abort_check_ms = 0;
+static uint8_t sky_abort_min_top4 = 0;
+static gnss_scan_check_t scan_check = NULL;
+
 // NMEA debug flag for MOB/PIW quality verification
 static bool nmea_debug_enabled = false;
 
@@ -65,7 +106,7 @@ static void gnss_scan_lock_sleep( void );
 static void gnss_scan_unlock_sleep( void );
 static void gnss_scan_enter_rtc_mode( void );
 static void gnss_set_navigation_mode( uint8_t mode );
-void gnss_parse_pair550_response( const char* response );
+static void gnss_parse_pair550_response( const nmea_sentence_t *sentence );
 
 static uint8_t app_nmea_check_sum( char *buf )
 {
@@ -81,6 +122,11 @@ static uint8_t app_nmea_check_sum( char *buf )
 	return chk;
 }
 
+// Longest sleep slice while waiting for a quality epoch, bounds watchdog and timeout latency
+#ifndef GNSS_ACQ_SLEEP_SLICE_MS
+#define GNSS_ACQ_SLEEP_SLICE_MS 1000
+#endif
+
 // Command retry configuration
 #define GNSS_CMD_RETRIES        3
 #define GNSS_CMD_RETRY_DELAY_MS 200
@@ -99,34 +145,208 @@ bool gnss_send_command( const char* command )
     for( uint8_t i = 0; i < GNSS_CMD_RETRIES; i++ )
     {
         hal_uart_0_tx( (uint8_t*)full_command, strlen( full_command ) );
-        hal_mcu_wait_ms( GNSS_CMD_RETRY_DELAY_MS );
+        gnss_wait_ms( GNSS_CMD_RETRY_DELAY_MS );
     }
     
     return true;
 }
 
-void gnss_nmea_parse_line( char *line )
+static void gnss_epoch_clear( int32_t key )
+{
+    memset( &epoch_fix, 0, sizeof( epoch_fix ));
+    epoch_fix.hdop = 99.9f;  // Invalid HDOP
+    epoch_fix.hacc = 999.0f; // Invalid accuracy
+    epoch_fix.utc_ms = key;
+    epoch_time_ms = key;
+    epoch_mask = 0;
+}
+
+static void gnss_epoch_collect( uint8_t sentence )
+{
+    switch( sentence )
+    {
+        case GNSS_EPOCH_RMC:
+        {
+            if( frame_rmc.latitude != NMEA_PARSE_NONE && frame_rmc.longitude != NMEA_PARSE_NONE &&
+                frame_rmc.latitude <= 180000000 && frame_rmc.longitude <= 360000000 )
+            {
+                epoch_fix.latitude = frame_rmc.latitude;
+                epoch_fix.longitude = frame_rmc.longitude;
+                epoch_fix.speed = ( frame_rmc.speed_ukn != NMEA_PARSE_NONE ) ? frame_rmc.speed_ukn : 0;
+            }
+            break;
+        }
+
+        case GNSS_EPOCH_GGA:
+        {
+            if( frame_gga.hdop_x100 != NMEA_PARSE_NONE )
+            {
+                epoch_fix.hdop = frame_gga.hdop_x100 / 100.0f;
+            }
+            epoch_fix.fix_quality = frame_gga.fix_quality;
+            epoch_fix.satellites = frame_gga.satellites;
+            break;
+        }
+
+        case GNSS_EPOCH_GST:
+        {
+            // HACC ≈ sqrt(lat_err² + lon_err²) in meters
+            if( frame_gst.latitude_err_cm != NMEA_PARSE_NONE && frame_gst.longitude_err_cm != NMEA_PARSE_NONE )
+            {
+                float lat_err = frame_gst.latitude_err_cm / 100.0f;
+                float lon_err = frame_gst.longitude_err_cm / 100.0f;
+                epoch_fix.hacc = sqrtf( lat_err * lat_err + lon_err * lon_err );
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static void gnss_epoch_publish( void )
+{
+    bool has_position = ( epoch_mask & GNSS_EPOCH_RMC ) && ( epoch_fix.latitude != 0 || epoch_fix.longitude != 0 );
+
+    if( epoch_fix.hacc >= 999.0f && epoch_fix.hdop < 99.0f )
+    {
+        // Estimate HACC from HDOP if GST not available
+        // Typical GPS error ≈ HDOP * 5 meters (conservative)
+        epoch_fix.hacc = epoch_fix.hdop * 5.0f;
+    }
+    // Valid if we have a real GPS fix (quality >= 1) and a position from the same second
+    epoch_fix.valid = has_position && ( epoch_fix.fix_quality >= 1 );
+    epoch_fix.timestamp_ms = hal_rtc_get_time_ms( );
+
+    fix_ring[fix_ring_head] = epoch_fix;
+    fix_ring_head = ( fix_ring_head + 1 ) % GNSS_FIX_RING_SIZE;
+    if( fix_ring_count < GNSS_FIX_RING_SIZE )
+    {
+        fix_ring_count++;
+    }
+
+    if( epoch_fix.valid )
+    {
+        // Update legacy static variables for backward compatibility
+        latitude_i32 = epoch_fix.latitude;
+        longitude_i32 = epoch_fix.longitude;
+        speed_i32 = epoch_fix.speed;
+    }
+}
+
+static void gnss_epoch_evaluate( const gnss_fix_t *fix )
+{
+    uint32_t elapsed = hal_rtc_get_time_ms( ) - acq_stats.start_ms;
+
+    acq_stats.epochs++;
+    if( !acq_armed || acq_good )
+    {
+        return;
+    }
+
+    if( fix->valid )
+    {
+        if( acq_stats.ttff_ms == 0 )
+        {
+            acq_stats.ttff_ms = elapsed ? elapsed : 1;
+        }
+        acq_fix = *fix;
+
+        if( fix->hdop <= acq_max_hdop && fix->hacc <= acq_max_hacc )
+        {
+            acq_stats.ttgf_ms = elapsed ? elapsed : 1;
+            acq_good = true;
+            hal_sleep_exit( );
+        }
+    }
+}
+
+static void gnss_epoch_add( uint8_t sentence, int32_t key )
+{
+    if( key < 0 )
+    {
+        return;
+    }
+    if( key != epoch_time_ms )
+    {
+        gnss_epoch_clear( key );
+    }
+    if( epoch_mask == 0xFF )
+    {
+        return; // already published, ignore repeated sentences of the same second
+    }
+
+    if( sentence == GNSS_EPOCH_GST )
+    {
+        epoch_gst_seen = true;
+    }
+
+    gnss_epoch_collect( sentence );
+    epoch_mask |= sentence;
+    if( epoch_mask == ( epoch_gst_seen ? GNSS_EPOCH_COMPLETE : ( GNSS_EPOCH_RMC | GNSS_EPOCH_GGA )))
+    {
+        gnss_epoch_publish( );
+        epoch_mask = 0xFF; // publish each epoch once
+        gnss_epoch_evaluate( &epoch_fix );
+    }
+}
+
+static bool gnss_sky_is_listed( const gnss_sky_sat_t *sat, uint8_t constellation, uint32_t now )
+{
+    return sat->constellation == constellation && sat->cn0 > 0 && ( now - sat->seen_ms ) <= GNSS_SKY_STALE_MS;
+}
+
+static void gnss_sky_log_constellation( uint8_t constellation, int32_t total_sats )
 {
-    // PRINTF( "%s\r\n", line );
-    switch( minmea_sentence_id( line, false ))
+    uint32_t now = hal_rtc_get_time_ms( );
+    uint8_t sky_count = 0;
+    const gnss_sky_sat_t *sky_sats = gnss_sky_table_get( &sky_count );
+    char nmea_line[160];
+    int nmea_len = 0;
+    int with_signal = 0;
+
+    for( uint8_t i = 0; i < sky_count; i++ )
     {
-        case MINMEA_SENTENCE_RMC: // use for app
+        if( gnss_sky_is_listed( &sky_sats[i], constellation, now ))
         {
-            if( minmea_parse_rmc( &frame_rmc, line ))
+            with_signal++;
+        }
+    }
+
+    nmea_len = snprintf( nmea_line, sizeof( nmea_line ), "[NMEA] %s: %ld SVs, %d with signal - ",
+                         sky_names[constellation], total_sats, with_signal );
+    for( uint8_t i = 0; i < sky_count && nmea_len < ( int ) sizeof( nmea_line ); i++ )
+    {
+        // Only show satellites with signal
+        if( gnss_sky_is_listed( &sky_sats[i], constellation, now ))
+        {
+            nmea_len += snprintf( nmea_line + nmea_len, sizeof( nmea_line ) - nmea_len,
+                                  "%u:%udB ", sky_sats[i].prn, sky_sats[i].cn0 );
+        }
+    }
+    LOG_NMEA( "%s\r\n", nmea_line );
+}
+
+static bool gnss_sky_is_blocked( uint32_t gsv_at_start, uint8_t min_top4_cn0, const gnss_sky_metrics_t *metrics )
+{
+    // Without GSV output nothing is known about the sky
+    return metrics->gsv_count != gsv_at_start && metrics->strong == 0 && metrics->top4_cn0 < min_top4_cn0;
+}
+
+static void gnss_nmea_parse_line( const nmea_sentence_t *sentence )
+{
+    // PRINTF( "%s\r\n", sentence->line );
+    switch( sentence->id )
+    {
+        case NMEA_ID_RMC: // use for app
+        {
+            if( nmea_parse_rmc( sentence, &frame_rmc ))
             {
+                gnss_epoch_add( GNSS_EPOCH_RMC, frame_rmc.time_ms );
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxRMC: raw coordinates and speed: (%d/%d,%d/%d) %d/%d\r\n",
-                        frame_rmc.latitude.value, frame_rmc.latitude.scale,
-                        frame_rmc.longitude.value, frame_rmc.longitude.scale,
-                        frame_rmc.speed.value, frame_rmc.speed.scale );
-                PRINTF( "$xxRMC fixed-point coordinates and speed scaled to three decimal places: (%d,%d) %d\r\n",
-                        minmea_rescale( &frame_rmc.latitude, 1000 ),
-                        minmea_rescale( &frame_rmc.longitude, 1000 ),
-                        minmea_rescale( &frame_rmc.speed, 1000 ));
-                PRINTF( "$xxRMC floating point degree coordinates and speed: (%f,%f) %f\r\n",
-                        minmea_tocoord( &frame_rmc.latitude ),
-                        minmea_tocoord( &frame_rmc.longitude ),
-                        minmea_tofloat( &frame_rmc.speed ));
+                PRINTF( "$xxRMC: coordinates (%ld,%ld) udeg, speed %ld uknots\r\n",
+                        frame_rmc.latitude, frame_rmc.longitude, frame_rmc.speed_ukn );
 #endif
             }
             else
@@ -138,34 +358,35 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_SENTENCE_GGA: // use for app
+        case NMEA_ID_GGA: // use for app
         {
-            if( minmea_parse_gga( &frame_gga, line ))
+            if( nmea_parse_gga( sentence, &frame_gga ))
             {
+                gnss_epoch_add( GNSS_EPOCH_GGA, frame_gga.time_ms );
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxGGA: fix quality: %d\r\n", frame_gga.fix_quality );
+                PRINTF( "$xxGGA: fix quality: %ld\r\n", frame_gga.fix_quality );
 #endif
                 // Dynamic NMEA debug for MOB/PIW modes
                 if( nmea_debug_enabled )
                 {
                     if( frame_gga.fix_quality > 0 )
                     {
-                        LOG_NMEA( "[NMEA] GGA: FIX=%d, sats=%d, HDOP=%.1f, lat=%.6f, lon=%.6f\r\n",
+                        LOG_NMEA( "[NMEA] GGA: FIX=%ld, sats=%ld, HDOP=%ld.%02ld, lat=%ld, lon=%ld udeg\r\n",
                                 frame_gga.fix_quality,
-                                frame_gga.satellites_tracked,
-                                minmea_tofloat( &frame_gga.hdop ),
-                                minmea_tocoord( &frame_gga.latitude ),
-                                minmea_tocoord( &frame_gga.longitude ));
+                                frame_gga.satellites,
+                                frame_gga.hdop_x100 / 100, frame_gga.hdop_x100 % 100,
+                                frame_gga.latitude,
+                                frame_gga.longitude );
                     }
                     else
                     {
                         // Show no-fix status periodically (every ~5 seconds based on satellite count changes)
                         static int last_sats = -1;
-                        if( frame_gga.satellites_tracked != last_sats )
+                        if( frame_gga.satellites != last_sats )
                         {
-                            LOG_NMEA( "[NMEA] GGA: NO FIX (sats tracked=%d, waiting for ephemeris)\r\n",
-                                    frame_gga.satellites_tracked );
-                            last_sats = frame_gga.satellites_tracked;
+                            LOG_NMEA( "[NMEA] GGA: NO FIX (sats tracked=%ld, waiting for ephemeris)\r\n",
+                                    frame_gga.satellites );
+                            last_sats = frame_gga.satellites;
                         }
                     }
                 }
@@ -179,33 +400,26 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_SENTENCE_GST:
+        case NMEA_ID_GST:
         {
-            if( minmea_parse_gst( &frame_gst, line ))
+            if( nmea_parse_gst( sentence, &frame_gst ))
             {
+                gnss_epoch_add( GNSS_EPOCH_GST, frame_gst.time_ms );
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxGST: raw latitude,longitude and altitude error deviation: (%d/%d,%d/%d,%d/%d)\r\n",
-                        frame_gst.latitude_error_deviation.value, frame_gst.latitude_error_deviation.scale,
-                        frame_gst.longitude_error_deviation.value, frame_gst.longitude_error_deviation.scale,
-                        frame_gst.altitude_error_deviation.value, frame_gst.altitude_error_deviation.scale );
-                PRINTF( "$xxGST fixed point latitude,longitude and altitude error deviation"
-                        " scaled to one decimal place: (%d,%d,%d)\r\n",
-                        minmea_rescale( &frame_gst.latitude_error_deviation, 10 ),
-                        minmea_rescale( &frame_gst.longitude_error_deviation, 10 ),
-                        minmea_rescale( &frame_gst.altitude_error_deviation, 10 ));
-                PRINTF( "$xxGST floating point degree latitude, longitude and altitude error deviation: (%f,%f,%f)\r\n",
-                        minmea_tofloat( &frame_gst.latitude_error_deviation ),
-                        minmea_tofloat( &frame_gst.longitude_error_deviation ),
-                        minmea_tofloat( &frame_gst.altitude_error_deviation ));
+                PRINTF( "$xxGST: latitude, longitude and altitude error deviation: (%ld,%ld,%ld) cm\r\n",
+                        frame_gst.latitude_err_cm,
+                        frame_gst.longitude_err_cm,
+                        frame_gst.altitude_err_cm );
 #endif
                 // Dynamic NMEA debug for MOB/PIW modes - show horizontal accuracy
-                if( nmea_debug_enabled )
+                if( nmea_debug_enabled && frame_gst.latitude_err_cm != NMEA_PARSE_NONE &&
+                    frame_gst.longitude_err_cm != NMEA_PARSE_NONE )
                 {
-                    float lat_err = minmea_tofloat( &frame_gst.latitude_error_deviation );
-                    float lon_err = minmea_tofloat( &frame_gst.longitude_error_deviation );
-                    float hacc = sqrtf( lat_err * lat_err + lon_err * lon_err );
-                    LOG_NMEA( "[NMEA] GST: HACC=%.1fm (lat_err=%.1f, lon_err=%.1f)\r\n",
-                            hacc, lat_err, lon_err );
+                    int32_t lat_err = frame_gst.latitude_err_cm / 10;
+                    int32_t lon_err = frame_gst.longitude_err_cm / 10;
+                    int32_t hacc = ( int32_t ) sqrtf(( float ) lat_err * lat_err + ( float ) lon_err * lon_err );
+                    LOG_NMEA( "[NMEA] GST: HACC=%ld.%ldm (lat_err=%ld.%ld, lon_err=%ld.%ld)\r\n",
+                            hacc / 10, hacc % 10, lat_err / 10, lat_err % 10, lon_err / 10, lon_err % 10 );
                 }
             }
             else
@@ -217,54 +431,28 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_SENTENCE_GSV:
+        case NMEA_ID_GSV:
         {
-            if( minmea_parse_gsv( &frame_gsv, line ))
+            if( nmea_parse_gsv( sentence, &frame_gsv ))
             {
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxGSV: message %d of %d\r\n", frame_gsv.msg_nr, frame_gsv.total_msgs );
-                PRINTF( "$xxGSV: satellites in view: %d\r\n", frame_gsv.total_sats );
+                PRINTF( "$xxGSV: message %ld of %ld\r\n", frame_gsv.msg_nr, frame_gsv.total_msgs );
+                PRINTF( "$xxGSV: satellites in view: %ld\r\n", frame_gsv.total_sats );
                 for( int i = 0; i < 4; i++ )
-                    PRINTF( "$xxGSV: sat nr %d, elevation: %d, azimuth: %d, snr: %d dbm\r\n",
+                    PRINTF( "$xxGSV: sat nr %ld, elevation: %ld, azimuth: %ld, snr: %ld dbm\r\n",
                         frame_gsv.sats[i].nr,
                         frame_gsv.sats[i].elevation,
                         frame_gsv.sats[i].azimuth,
                         frame_gsv.sats[i].snr );
 #endif
-                // Dynamic NMEA debug - show satellite signal strengths
-                // Only show first message of each constellation and only sats with signal
-                if( nmea_debug_enabled && frame_gsv.msg_nr == 1 && frame_gsv.total_sats > 0 )
+                // GSV talker ID gives the constellation: GP = GPS, GL = GLONASS, GA = Galileo, GB/BD = BeiDou
+                uint8_t constellation = gnss_sky_constellation( sentence->talker );
+                gnss_sky_table_update( sentence, &frame_gsv, hal_rtc_get_time_ms( ));
+
+                // Dynamic NMEA debug - signal strengths of the whole constellation, once its last part is in
+                if( nmea_debug_enabled && frame_gsv.msg_nr == frame_gsv.total_msgs && frame_gsv.total_sats > 0 )
                 {
-                    // Determine constellation from NMEA talker ID in the original line
-                    // GP = GPS, GL = GLONASS, GA = Galileo, GB/BD = BeiDou
-                    const char* constellation = "??";
-                    if( strncmp( line, "$GP", 3 ) == 0 ) constellation = "GPS";
-                    else if( strncmp( line, "$GL", 3 ) == 0 ) constellation = "GLO";
-                    else if( strncmp( line, "$GA", 3 ) == 0 ) constellation = "GAL";
-                    else if( strncmp( line, "$GB", 3 ) == 0 || strncmp( line, "$BD", 3 ) == 0 ) constellation = "BDS";
-                    
-                    // Count satellites with actual signal (SNR > 0)
-                    int with_signal = 0;
-                    for( int i = 0; i < 4; i++ )
-                    {
-                        if( frame_gsv.sats[i].nr > 0 && frame_gsv.sats[i].snr > 0 )
-                            with_signal++;
-                    }
-                    
-                    char nmea_line[96];
-                    int nmea_len = snprintf( nmea_line, sizeof( nmea_line ),
-                                             "[NMEA] %s: %d SVs, %d with signal - ",
-                                             constellation, frame_gsv.total_sats, with_signal );
-                    for( int i = 0; i < 4; i++ )
-                    {
-                        // Only show satellites with valid PRN and signal
-                        if( frame_gsv.sats[i].nr > 0 && frame_gsv.sats[i].snr > 0 )
-                        {
-                            nmea_len += snprintf( nmea_line + nmea_len, sizeof( nmea_line ) - nmea_len,
-                                                  "%d:%ddB ", frame_gsv.sats[i].nr, frame_gsv.sats[i].snr );
-                        }
-                    }
-                    LOG_NMEA( "%s\r\n", nmea_line );
+                    gnss_sky_log_constellation( constellation, frame_gsv.total_sats );
                 }
             }
             else
@@ -276,19 +464,15 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_SENTENCE_VTG:
+        case NMEA_ID_VTG:
         {
-            if( minmea_parse_vtg( &frame_vtg, line ))
+            if( nmea_parse_vtg( sentence, &frame_vtg ))
             {
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxVTG: true track degrees = %f\r\n",
-                        minmea_tofloat( &frame_vtg.true_track_degrees ));
-                PRINTF( "        magnetic track degrees = %f\r\n",
-                        minmea_tofloat( &frame_vtg.magnetic_track_degrees ));
-                PRINTF( "        speed knots = %f\r\n",
-                        minmea_tofloat( &frame_vtg.speed_knots ));
-                PRINTF( "        speed kph = %f\r\n",
-                        minmea_tofloat( &frame_vtg.speed_kph ));
+                PRINTF( "$xxVTG: true track = %ld cdeg, magnetic track = %ld cdeg\r\n",
+                        frame_vtg.true_track_cdeg, frame_vtg.magnetic_track_cdeg );
+                PRINTF( "        speed = %ld uknots, %ld m/h\r\n",
+                        frame_vtg.speed_ukn, frame_vtg.speed_kph_x1000 );
 #endif
             }
             else
@@ -300,18 +484,18 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_SENTENCE_ZDA: // use for app
+        case NMEA_ID_ZDA: // use for app
         {
-            if( minmea_parse_zda( &frame_zda, line ))
+            if( nmea_parse_zda( sentence, &frame_zda ))
             {
 #if GPS_INFO_PRINTF
-                PRINTF( "$xxZDA: %d:%d:%d %02d.%02d.%d UTC%+03d:%02d\r\n",
-                        frame_zda.time.hours,
-                        frame_zda.time.minutes,
-                        frame_zda.time.seconds,
-                        frame_zda.date.day,
-                        frame_zda.date.month,
-                        frame_zda.date.year,
+                PRINTF( "$xxZDA: %ld:%ld:%ld %02ld.%02ld.%ld UTC%+03ld:%02ld\r\n",
+                        frame_zda.time_ms / 3600000,
+                        frame_zda.time_ms / 60000 % 60,
+                        frame_zda.time_ms / 1000 % 60,
+                        frame_zda.day,
+                        frame_zda.month,
+                        frame_zda.year,
                         frame_zda.hour_offset,
                         frame_zda.minute_offset );
 #endif
@@ -325,7 +509,7 @@ void gnss_nmea_parse_line( char *line )
             break;
         }
 
-        case MINMEA_INVALID:
+        case NMEA_ID_UNKNOWN:
         {
 #if GPS_INFO_PRINTF
             PRINTF( "$xxxxx sentence is not valid\r\n" );
@@ -343,83 +527,93 @@ void gnss_nmea_parse_line( char *line )
     }
 }
 
-void gnss_nmea_parse( char *str )
+static void gnss_pair_parse( const nmea_sentence_t *sentence )
 {
-    uint16_t len = strlen( str );
-    uint16_t begin = 0, end = 0;
-    for( uint16_t i = 0; i < len; i++ )
-    {
-        if( str[i] == '$' ) begin = i;
-        if( str[i] == '\r' ) end = i;
+    const char *line = sentence->line;
 
-        if( end && end > begin )
+    switch( sentence->pair_id )
+    {
+        case 1:
         {
-            memset( gps_nmea_line, 0, sizeof( gps_nmea_line ));
-            memcpy( gps_nmea_line, str + begin, end - begin );
-            if( strncmp( gps_nmea_line,"$PAIR",5 ) == 0 ) // ag3335 cmd parse
+            // Parse PAIR command responses (acknowledgments)
+            // Format: $PAIR001,<cmd>,<status>*CS
+            // Example: $PAIR001,590,0*37 (PAIR590 success)
+            // Status: 0 = success, non-zero = error
+            int32_t cmd_num = 0;
+            int32_t status = -1;  // Default to -1 to detect parse issues
+            if( nmea_stream_field_int( sentence, 1, &cmd_num ) && nmea_stream_field_int( sentence, 2, &status ))
             {
-                // Parse PAIR command responses (acknowledgments)
-                // Format: $PAIR001,<cmd>,<status>*CS
-                // Example: $PAIR001,590,0*37 (PAIR590 success)
-                // Status: 0 = success, non-zero = error
-                if( strncmp( gps_nmea_line, "$PAIR001", 8 ) == 0 )
+                if( status == 0 )
                 {
-                    // Extract command number and status
-                    int cmd_num = 0;
-                    int status = -1;  // Default to -1 to detect parse issues
-                    if( sscanf( gps_nmea_line, "$PAIR001,%d,%d", &cmd_num, &status ) == 2 )
-                    {
-                        if( status == 0 )
-                        {
-                            GNSS_TRACE_INFO( "AG3335 ACK: PAIR%03d OK: %s\n", cmd_num, gps_nmea_line );
-                        }
-                        else
-                        {
-                            GNSS_TRACE_INFO( "AG3335 ACK: PAIR%03d FAILED (status=%d): %s\n", cmd_num, status, gps_nmea_line );
-                        }
-                    }
-                    else
-                    {
-                        GNSS_TRACE_INFO( "AG3335 ACK: Parse failed: %s\n", gps_nmea_line );
-                    }
-                }
-                else if( strncmp( gps_nmea_line, "$PAIR550", 8 ) == 0 )
-                {
-                    // Parse almanac status response (data line, not ACK)
-                    // Format: $PAIR550,<Constellation>,<L1_SV>,<Midi_SV>*CS
-                    GNSS_TRACE_INFO( "GNSS: PAIR550 data received: %s\n", gps_nmea_line );
-                    gnss_parse_pair550_response( gps_nmea_line );
-                }
-                else if( strncmp( gps_nmea_line, "$PAIR081", 8 ) == 0 )
-                {
-                    // Parse navigation mode query response
-                    // Format: $PAIR081,<mode>*CS
-                    int nav_mode = -1;
-                    if( sscanf( gps_nmea_line, "$PAIR081,%d", &nav_mode ) == 1 )
-                    {
-                        GNSS_TRACE_INFO( "GNSS: Current navigation mode = %d\n", nav_mode );
-                    }
-                    else
-                    {
-                        GNSS_TRACE_INFO( "GNSS: PAIR081 response: %s\n", gps_nmea_line );
-                    }
+                    GNSS_TRACE_INFO( "AG3335 ACK: PAIR%03ld OK: %s\n", cmd_num, line );
                 }
                 else
                 {
-                    // Log other PAIR responses for debugging
-                    GNSS_TRACE_INFO( "AG3335: %s\n", gps_nmea_line );
+                    GNSS_TRACE_INFO( "AG3335 ACK: PAIR%03ld FAILED (status=%ld): %s\n", cmd_num, status, line );
                 }
             }
             else
             {
-                gnss_nmea_parse_line( gps_nmea_line );  //          
+                GNSS_TRACE_INFO( "AG3335 ACK: Parse failed: %s\n", line );
             }
-            begin = 0;
-            end = 0;
+            break;
+        }
+
+        case 550:
+        {
+            // Parse almanac status response (data line, not ACK)
+            // Format: $PAIR550,<Constellation>,<L1_SV>,<Midi_SV>*CS
+            GNSS_TRACE_INFO( "GNSS: PAIR550 data received: %s\n", line );
+            gnss_parse_pair550_response( sentence );
+            break;
+        }
+
+        case 81:
+        {
+            // Parse navigation mode query response
+            // Format: $PAIR081,<mode>*CS
+            int32_t nav_mode = -1;
+            if( nmea_stream_field_int( sentence, 1, &nav_mode ))
+            {
+                GNSS_TRACE_INFO( "GNSS: Current navigation mode = %ld\n", nav_mode );
+            }
+            else
+            {
+                GNSS_TRACE_INFO( "GNSS: PAIR081 response: %s\n", line );
+            }
+            break;
         }
+
+        default:
+        {
+            // Log other PAIR responses for debugging
+            GNSS_TRACE_INFO( "AG3335: %s\n", line );
+            break;
+        }
+    }
+}
+
+static void gnss_nmea_sentence_handler( const nmea_sentence_t *sentence )
+{
+    if( sentence->id == NMEA_ID_PAIR ) // ag3335 cmd parse
+    {
+        gnss_pair_parse( sentence );
+    }
+    else
+    {
+        gnss_nmea_parse_line( sentence );
     }
 }
 
+void gnss_nmea_parse( char *str )
+{
+    while( *str != '\0' )
+    {
+        nmea_stream_feed( &gnss_stream, ( uint8_t )*str++ );
+    }
+    gnss_nmea_process( );
+}
+
 static void gnss_enable_nvram_auto_save( void )
 {
     // PAIR510,1 - Enable NVRAM auto save for ephemeris/almanac persistence
@@ -430,7 +624,7 @@ static void gnss_enable_nvram_auto_save( void )
 static volatile bool pair550_pending = false;
 static volatile bool pair550_received = false;
 
-void gnss_parse_pair550_response( const char* response )
+static void gnss_parse_pair550_response( const nmea_sentence_t *sentence )
 {
     // PAIR550 response format per manual:
     // $PAIR550,<Constellation>,<L1_SV>,<Midi_SV>*CS
@@ -440,15 +634,24 @@ void gnss_parse_pair550_response( const char* response )
     // Example: $PAIR550,0,FEC0BFFF,00000FFF*24
     //   Constellation 0 (GPS), L1=FEC0BFFF, Midi=00000FFF
     
-    int constellation = -1;
+    int32_t constellation = -1;
     uint32_t l1_sv = 0, midi_sv = 0;
+    int parsed = 0;
     
     // Try parsing with both L1 and Midi fields
-    int parsed = sscanf( response, "$PAIR550,%d,%lX,%lX", &constellation, &l1_sv, &midi_sv );
+    if( nmea_stream_field_int( sentence, 1, &constellation ))
+    {
+        parsed = 1;
+        if( nmea_stream_field_hex( sentence, 2, &l1_sv ))
+        {
+            parsed = 2;
+            if( nmea_stream_field_hex( sentence, 3, &midi_sv )) parsed = 3;
+        }
+    }
     
     if( parsed >= 2 )  // At minimum need constellation and L1_SV
     {
-        GNSS_TRACE_INFO( "GNSS: PAIR550 response - Constellation=%d, L1_SV=0x%08lX, Midi_SV=0x%08lX\n", 
+        GNSS_TRACE_INFO( "GNSS: PAIR550 response - Constellation=%ld, L1_SV=0x%08lX, Midi_SV=0x%08lX\n", 
                          constellation, l1_sv, midi_sv );
         
         // Store based on constellation type
@@ -464,7 +667,7 @@ void gnss_parse_pair550_response( const char* response )
                 almanac_beidou_valid = l1_sv;
                 break;
             default:
-                GNSS_TRACE_INFO( "GNSS: Unknown constellation type %d\n", constellation );
+                GNSS_TRACE_INFO( "GNSS: Unknown constellation type %ld\n", constellation );
                 break;
         }
         
@@ -508,7 +711,7 @@ void gnss_parse_pair550_response( const char* response )
     }
     else
     {
-        GNSS_TRACE_INFO( "GNSS: Failed to parse PAIR550 response: %s\n", response );
+        GNSS_TRACE_INFO( "GNSS: Failed to parse PAIR550 response: %s\n", sentence->line );
         almanac_status_valid = false;
         pair550_received = true;  // Mark as received even if parse failed
     }
@@ -534,7 +737,7 @@ static void gnss_check_almanac_status( void )
         uint32_t start_time = hal_rtc_get_time_ms();
         while( !pair550_received && ( hal_rtc_get_time_ms() - start_time ) < 500 )
         {
-            hal_mcu_wait_ms( 50 );
+            gnss_wait_ms( 50 );
         }
     }
     
@@ -622,7 +825,7 @@ bool gnss_scan_start( void )
     
     // Now module is locked and responsive - send configuration commands
     // Use single sends with proper waits (not aggressive retries)
-    hal_mcu_wait_ms( 100 );
+    gnss_wait_ms( 100 );
     
 #if AG3335_ENABLE_SWIMMING_NAV_MODE
     // Query current navigation mode first
@@ -641,7 +844,7 @@ bool gnss_scan_start( void )
     gnss_enable_nvram_auto_save( );
 
     // Wait a bit longer before almanac query - module needs time after wake
-    hal_mcu_wait_ms( 500 );
+    gnss_wait_ms( 500 );
     
     // Query almanac status (1-day horizon check)
     gnss_check_almanac_status( );
@@ -656,7 +859,7 @@ void gnss_scan_stop( void )
     GNSS_TRACE_INFO( "GNSS: unlock sleep\n" );
     gnss_scan_enter_rtc_mode( );
     GNSS_TRACE_INFO( "GNSS: enter RTC mode\n" );
-    hal_mcu_wait_ms( 50 );
+    gnss_wait_ms( 50 );
     hal_gpio_set_value( AG3335_POWER_EN, HAL_GPIO_RESET );
     GNSS_TRACE_INFO( "GNSS: POWER_EN -> OFF (scan_stop)\n" );
     hal_uart_0_deinit( );
@@ -680,7 +883,7 @@ static void gnss_scan_lock_sleep( void )
     for( uint8_t i = 0; i < 25; i++ )
     {
         hal_uart_0_tx( (uint8_t*)full_command, strlen( full_command ) );
-        hal_mcu_wait_ms( 40 );
+        gnss_wait_ms( 40 );
     }
 }
 
@@ -702,39 +905,41 @@ static void gnss_scan_enter_rtc_mode( void )
     for( uint8_t i = 0; i < 25; i++ )
     {
         hal_uart_0_tx( (uint8_t*)full_command, strlen( full_command ) );
-        hal_mcu_wait_ms( 40 );
+        gnss_wait_ms( 40 );
     }
 }
 
 static void gnss_scan_clean( void )
 {
-    memset( &frame_rmc, 0, sizeof( struct minmea_sentence_rmc ));
-    memset( &frame_gga, 0, sizeof( struct minmea_sentence_gga ));
-    memset( &frame_gst, 0, sizeof( struct minmea_sentence_gst ));
-    memset( &frame_gsv, 0, sizeof( struct minmea_sentence_gsv ));
-    memset( &frame_vtg, 0, sizeof( struct minmea_sentence_vtg ));
-    memset( &frame_zda, 0, sizeof( struct minmea_sentence_zda ));
+    memset( &frame_rmc, 0, sizeof( frame_rmc ));
+    memset( &frame_gga, 0, sizeof( frame_gga ));
+    memset( &frame_gst, 0, sizeof( frame_gst ));
+    memset( &frame_gsv, 0, sizeof( frame_gsv ));
+    memset( &frame_vtg, 0, sizeof( frame_vtg ));
+    memset( &frame_zda, 0, sizeof( frame_zda ));
+    frame_rmc.latitude = NMEA_PARSE_NONE; // no position until the next RMC
+    frame_rmc.longitude = NMEA_PARSE_NONE;
+    frame_rmc.speed_ukn = NMEA_PARSE_NONE;
+    gnss_epoch_clear( -1 );
+    epoch_gst_seen = false;
+    fix_ring_head = 0;
+    fix_ring_count = 0;
+    nmea_stream_reset( &gnss_stream );
+    gnss_sky_table_reset( );
 }  
 
 bool gnss_get_fix_status( void )
 {
     bool result = false;
-    float latitude = 0, longitude = 0, speed = 0;
 
-    if( frame_rmc.latitude.scale && frame_rmc.longitude.scale && frame_rmc.speed.scale )
+    if( frame_rmc.latitude != NMEA_PARSE_NONE && frame_rmc.longitude != NMEA_PARSE_NONE &&
+        frame_rmc.speed_ukn != NMEA_PARSE_NONE )
     {
-        latitude = minmea_tocoord( &frame_rmc.latitude );
-        longitude = minmea_tocoord( &frame_rmc.longitude );
-        speed = minmea_tofloat( &frame_rmc.speed );
-        if( latitude <= 180 && longitude <= 360 )
+        if( frame_rmc.latitude <= 180000000 && frame_rmc.longitude <= 360000000 )
         {
-            latitude *= 1000000;
-            longitude *= 1000000;
-            speed *= 1000000;
-
-            latitude_i32 = latitude;
-            longitude_i32 = longitude;
-            speed_i32 = speed;
+            latitude_i32 = frame_rmc.latitude;
+            longitude_i32 = frame_rmc.longitude;
+            speed_i32 = frame_rmc.speed_ukn;
 
             result =  true;
         }
@@ -754,81 +959,88 @@ void gnss_parse_handler( char *nmea )
     gnss_nmea_parse( nmea );
 }
 
+void gnss_parse_byte( uint8_t c )
+{
+    nmea_stream_feed( &gnss_stream, c );
+    if( nmea_stream_pending( &gnss_stream ))
+    {
+        gnss_nmea_pending = true;
+    }
+}
+
+void gnss_nmea_process( void )
+{
+    gnss_nmea_pending = false;
+    nmea_stream_process( &gnss_stream );
+}
+
+void gnss_wait_ms( uint32_t ms )
+{
+    uint32_t start = hal_rtc_get_time_ms( );
+    uint32_t elapsed = 0;
+
+    // Sleep until the wait ends, waking to parse each sentence as it is queued
+    while( elapsed < ms )
+    {
+        gnss_nmea_process( );
+        hal_mcu_wait_ms_or_event( ms - elapsed, &gnss_nmea_pending );
+        elapsed = hal_rtc_get_time_ms( ) - start;
+    }
+    gnss_nmea_process( );
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- QUALITY-DRIVEN GNSS SCANNING FOR MOB/PIW --------------------------------
  * -----------------------------------------------------------------------------
  */
 
-bool gnss_get_quality_fix( gnss_fix_t *fix )
+bool gnss_get_fix_history( uint8_t index, gnss_fix_t *fix )
 {
+    bool found;
+
     if( fix == NULL )
     {
         return false;
     }
-    
-    // Initialize to invalid state
-    memset( fix, 0, sizeof( gnss_fix_t ));
-    fix->valid = false;
-    fix->hdop = 99.9f;  // Invalid HDOP
-    fix->hacc = 999.0f; // Invalid accuracy
-    
-    // Check basic fix validity from RMC
-    if( !frame_rmc.latitude.scale || !frame_rmc.longitude.scale )
-    {
-        return false;
-    }
-    
-    float latitude = minmea_tocoord( &frame_rmc.latitude );
-    float longitude = minmea_tocoord( &frame_rmc.longitude );
-    
-    if( latitude > 180 || longitude > 360 )
-    {
-        return false;
-    }
-    
-    // Populate fix structure
-    fix->latitude = (int32_t)( latitude * 1000000 );
-    fix->longitude = (int32_t)( longitude * 1000000 );
-    fix->speed = (int32_t)( minmea_tofloat( &frame_rmc.speed ) * 1000000 );
-    
-    // Get HDOP from GGA sentence
-    if( frame_gga.hdop.scale > 0 )
-    {
-        fix->hdop = minmea_tofloat( &frame_gga.hdop );
-    }
-    
-    // Get fix quality and satellites from GGA
-    fix->fix_quality = frame_gga.fix_quality;
-    fix->satellites = frame_gga.satellites_tracked;
-    
-    // Calculate horizontal accuracy from GST if available
-    // HACC ≈ sqrt(lat_err² + lon_err²) in meters
-    if( frame_gst.latitude_error_deviation.scale > 0 && 
-        frame_gst.longitude_error_deviation.scale > 0 )
+
+    found = index < fix_ring_count;
+    if( found )
     {
-        float lat_err = minmea_tofloat( &frame_gst.latitude_error_deviation );
-        float lon_err = minmea_tofloat( &frame_gst.longitude_error_deviation );
-        fix->hacc = sqrtf( lat_err * lat_err + lon_err * lon_err );
+        *fix = fix_ring[( fix_ring_head + GNSS_FIX_RING_SIZE - 1 - index ) % GNSS_FIX_RING_SIZE];
     }
-    else if( fix->hdop < 99.0f )
+
+    if( !found )
     {
-        // Estimate HACC from HDOP if GST not available
-        // Typical GPS error ≈ HDOP * 5 meters (conservative)
-        fix->hacc = fix->hdop * 5.0f;
+        // Initialize to invalid state
+        memset( fix, 0, sizeof( gnss_fix_t ));
+        fix->valid = false;
+        fix->hdop = 99.9f;  // Invalid HDOP
+        fix->hacc = 999.0f; // Invalid accuracy
     }
-    
-    // Valid if we have a real GPS fix (quality >= 1)
-    fix->valid = ( fix->fix_quality >= 1 ); 
-    
-    // Update legacy static variables for backward compatibility
-    if( fix->valid )
+
+    return found;
+}
+
+uint8_t gnss_get_fix_history_count( void )
+{
+    return fix_ring_count;
+}
+
+uint32_t gnss_fix_age_ms( const gnss_fix_t *fix )
+{
+    return hal_rtc_get_time_ms( ) - fix->timestamp_ms;
+}
+
+bool gnss_get_quality_fix( gnss_fix_t *fix )
+{
+    if( fix == NULL )
     {
-        latitude_i32 = fix->latitude;
-        longitude_i32 = fix->longitude;
-        speed_i32 = fix->speed;
+        return false;
     }
-    
+
+    // Newest complete epoch: position, HDOP and HACC all come from the same UTC second
+    gnss_get_fix_history( 0, fix );
     return fix->valid;
 }
 
@@ -855,39 +1067,89 @@ bool gnss_scan_until_good( uint32_t max_ms, float max_hdop, float max_hacc, gnss
     uint32_t start_time = hal_rtc_get_time_ms( );
     uint32_t elapsed = 0;
     bool got_good_fix = false;
+    gnss_sky_metrics_t sky = { 0 };
+
+    // The blocked-sky gate and the caller check are armed for this scan only
+    uint32_t sky_check_ms = sky_abort_check_ms;
+    uint8_t sky_min_top4 = sky_abort_min_top4;
+    gnss_scan_check_t check = scan_check;
+    sky_abort_check_ms = 0;
+    scan_check = NULL;
+    gnss_sky_get_metrics( &sky );
+    uint32_t sky_gsv_at_start = sky.gsv_count;
+
+    // Arm the epoch evaluator; sentences parsed from app_user_run_process( ) wake us through hal_sleep_exit( )
+    memset( &acq_stats, 0, sizeof( acq_stats ));
+    memset( &acq_fix, 0, sizeof( acq_fix ));
+    acq_stats.start_ms = start_time;
+    acq_max_hdop = max_hdop;
+    acq_max_hacc = max_hacc;
+    acq_good = false;
+    acq_armed = true;
     
     GNSS_TRACE_INFO( "GNSS quality scan: max %lu ms, HDOP<%.1f, HACC<%.1f m\n", 
                      max_ms, max_hdop, max_hacc );
     
-    // Poll at ~1 Hz until good fix or timeout
+    // Sleep between UART interrupts until an epoch meets the gates, BLE interrupts or timeout
     while( elapsed < max_ms )
     {
-        // Wait 1 second between checks
-        hal_mcu_wait_ms( 1000 );
-        elapsed = hal_rtc_get_time_ms( ) - start_time;
-        
-        // Check for BLE interrupt
-        if( ble_beacon_found )
+        // Epochs are evaluated here, as their sentences are parsed
+        gnss_nmea_process( );
+        if( acq_good || ble_beacon_found )
         {
-            GNSS_TRACE_INFO( "GNSS scan interrupted by BLE beacon at %lu ms\n", elapsed );
             break;
         }
-        
-        // Try to get a quality fix
-        if( gnss_get_quality_fix( fix ))
-        {
-            GNSS_TRACE_INFO( "GNSS fix @ %lu ms: HDOP=%.1f, HACC=%.1f m, sats=%d\n",
-                            elapsed, fix->hdop, fix->hacc, fix->satellites );
-            
-            // Check if fix meets quality thresholds
-            if( fix->hdop <= max_hdop && fix->hacc <= max_hacc )
-            {
-                got_good_fix = true;
-                GNSS_TRACE_INFO( "GNSS GOOD FIX at %lu ms - quality OK!\n", elapsed );
-                break;
-            }
+        gnss_sky_get_metrics( &sky );
+        if( sky_check_ms > 0 && elapsed >= sky_check_ms && gnss_sky_is_blocked( sky_gsv_at_start, sky_min_top4, &sky ))
+        {
+            acq_stats.sky_abort = true;
+            break;
         }
+        if( check != NULL && check( elapsed, max_ms, &sky ))
+        {
+            acq_stats.check_abort = true;
+            break;
+        }
+
+        uint32_t remaining = max_ms - elapsed;
+        if( remaining > GNSS_ACQ_SLEEP_SLICE_MS )
+        {
+            remaining = GNSS_ACQ_SLEEP_SLICE_MS;
+        }
+        if( remaining > 50 )
+        {
+            hal_mcu_set_sleep_for_ms( remaining );
+        }
+        else
+        {
+            gnss_wait_ms( remaining ); // below the sleep floor of hal_mcu_set_sleep_for_ms
+        }
+        elapsed = hal_rtc_get_time_ms( ) - start_time;
     }
+    acq_armed = false;
+
+    if( ble_beacon_found && !acq_good )
+    {
+        acq_stats.ble_abort = true;
+        GNSS_TRACE_INFO( "GNSS scan interrupted by BLE beacon at %lu ms\n", elapsed );
+    }
+    else if( acq_stats.sky_abort )
+    {
+        GNSS_TRACE_INFO( "GNSS scan aborted at %lu ms, sky blocked: %u of %u SVs tracked, top-4 C/N0 %u dB-Hz\n",
+                         elapsed, sky.tracked, sky.in_view, sky.top4_cn0 );
+    }
+    else if( acq_stats.check_abort )
+    {
+        GNSS_TRACE_INFO( "GNSS scan ended by caller check at %lu ms\n", elapsed );
+    }
+    else if( acq_good )
+    {
+        *fix = acq_fix;
+        got_good_fix = true;
+        GNSS_TRACE_INFO( "GNSS GOOD FIX at %lu ms: HDOP=%.1f, HACC=%.1f m, sats=%d\n",
+                         acq_stats.ttgf_ms, fix->hdop, fix->hacc, fix->satellites );
+    }
+    acq_stats.on_ms = hal_rtc_get_time_ms( ) - start_time;
     
     // Stop GNSS module (unless in background mode)
     if( !skip_power_management )
@@ -895,17 +1157,67 @@ bool gnss_scan_until_good( uint32_t max_ms, float max_hdop, float max_hacc, gnss
         gnss_scan_stop( );
     }
     
-    // Get final fix status if we didn't get a good one during polling
+    // Get final fix status if we didn't get a good one during the acquisition
     if( !got_good_fix && !ble_beacon_found )
     {
         gnss_get_quality_fix( fix );
-        GNSS_TRACE_INFO( "GNSS timeout after %lu ms: valid=%d, HDOP=%.1f, HACC=%.1f\n",
-                        elapsed, fix->valid, fix->hdop, fix->hacc );
+        GNSS_TRACE_INFO( "GNSS %s after %lu ms: valid=%d, HDOP=%.1f, HACC=%.1f\n",
+                        ( acq_stats.sky_abort || acq_stats.check_abort ) ? "abort" : "timeout", elapsed, fix->valid, fix->hdop, fix->hacc );
     }
+
+    GNSS_TRACE_INFO( "GNSS acq stats: TTFF=%lu ms, TTGF=%lu ms, on=%lu ms, epochs=%lu\n",
+                     acq_stats.ttff_ms, acq_stats.ttgf_ms, acq_stats.on_ms, acq_stats.epochs );
+    GNSS_TRACE_INFO( "GNSS NMEA queue: max %u of %u, %lu dropped, %lu overruns, %lu checksum errors\n",
+                     gnss_stream.queue_high_water, GNSS_NMEA_QUEUE_SLOTS, gnss_stream.queue_overruns,
+                     gnss_stream.overruns, gnss_stream.checksum_errors );
     
     return got_good_fix;
 }
 
+void gnss_get_acq_stats( gnss_acq_stats_t *stats )
+{
+    if( stats != NULL )
+    {
+        *stats = acq_stats;
+    }
+}
+
+void gnss_sky_get_metrics( gnss_sky_metrics_t *metrics )
+{
+    if( metrics != NULL )
+    {
+        gnss_sky_table_metrics( metrics, hal_rtc_get_time_ms( ));
+    }
+}
+
+uint8_t gnss_sky_get_satellites( gnss_sky_sat_t *sats, uint8_t max )
+{
+    uint32_t now = hal_rtc_get_time_ms( );
+    uint8_t sky_count = 0;
+    const gnss_sky_sat_t *sky_sats = gnss_sky_table_get( &sky_count );
+    uint8_t count = 0;
+
+    for( uint8_t i = 0; i < sky_count && count < max; i++ )
+    {
+        if(( now - sky_sats[i].seen_ms ) <= GNSS_SKY_STALE_MS )
+        {
+            sats[count++] = sky_sats[i];
+        }
+    }
+    return count;
+}
+
+void gnss_set_sky_abort( uint32_t check_ms, uint8_t min_top4_cn0 )
+{
+    sky_abort_check_ms = check_ms;
+    sky_abort_min_top4 = min_top4_cn0;
+}
+
+void gnss_set_scan_check( gnss_scan_check_t check )
+{
+    scan_check = check;
+}
+
 bool gnss_check_ble_interrupt( void )
 {
     return ble_beacon_found;
@@ -916,6 +1228,7 @@ void gnss_set_ble_found( bool found )
     ble_beacon_found = found;
     if( found )
     {
+        hal_sleep_exit( );
         GNSS_TRACE_INFO( "BLE beacon found - GNSS interrupt flag set\n" );
     }
 }
@@ -0,0 +1,142 @@
+#include "gnss_sky.h"
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Every satellite of every GSV part, one entry per constellation and PRN
+static gnss_sky_sat_t sky_sats[GNSS_SKY_MAX_SATS];
+static uint8_t sky_count = 0;
+static uint32_t sky_gsv_count = 0;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool gnss_sky_is_fresh( const gnss_sky_sat_t* sat, uint32_t now_ms )
+{
+    return ( now_ms - sat->seen_ms ) <= GNSS_SKY_STALE_MS;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void gnss_sky_table_reset( void )
+{
+    sky_count = 0;
+    sky_gsv_count = 0;
+}
+
+uint8_t gnss_sky_constellation( const char* talker )
+{
+    if( talker[0] == 'G' && talker[1] == 'P' ) return GNSS_SKY_GPS;
+    if( talker[0] == 'G' && talker[1] == 'L' ) return GNSS_SKY_GLONASS;
+    if( talker[0] == 'G' && talker[1] == 'A' ) return GNSS_SKY_GALILEO;
+    if(( talker[0] == 'G' && talker[1] == 'B' ) || ( talker[0] == 'B' && talker[1] == 'D' )) return GNSS_SKY_BEIDOU;
+    if( talker[0] == 'G' && talker[1] == 'Q' ) return GNSS_SKY_QZSS;
+    return GNSS_SKY_OTHER;
+}
+
+void gnss_sky_table_update( const nmea_sentence_t* sentence, const nmea_gsv_t* gsv, uint32_t now_ms )
+{
+    uint8_t constellation = gnss_sky_constellation( sentence->talker );
+    uint8_t blocks = ( sentence->field_count > 4 ) ? ( sentence->field_count - 4 ) / 4 : 0;
+
+    sky_gsv_count++;
+    for( uint8_t i = 0; i < 4 && i < blocks; i++ )
+    {
+        const nmea_gsv_sat_t* sat = &gsv->sats[i];
+        uint8_t slot = sky_count;
+        uint8_t oldest = 0;
+
+        if( sat->nr <= 0 || sat->nr > UINT8_MAX )
+        {
+            continue;
+        }
+
+        for( uint8_t j = 0; j < sky_count; j++ )
+        {
+            if( sky_sats[j].constellation == constellation && sky_sats[j].prn == sat->nr )
+            {
+                slot = j;
+                break;
+            }
+            if(( int32_t )( sky_sats[j].seen_ms - sky_sats[oldest].seen_ms ) < 0 )
+            {
+                oldest = j;
+            }
+        }
+        if( slot == GNSS_SKY_MAX_SATS )
+        {
+            slot = oldest;
+        }
+        else if( slot == sky_count )
+        {
+            sky_count++;
+        }
+
+        sky_sats[slot].constellation = constellation;
+        sky_sats[slot].prn = sat->nr;
+        sky_sats[slot].elevation = ( sat->elevation < -90 || sat->elevation > 90 ) ? 0 : sat->elevation;
+        sky_sats[slot].azimuth = ( sat->azimuth < 0 || sat->azimuth > 359 ) ? 0 : sat->azimuth;
+        sky_sats[slot].cn0 = ( sat->snr < 0 ) ? 0 : ( sat->snr > 99 ) ? 99 : sat->snr;
+        sky_sats[slot].seen_ms = now_ms;
+    }
+}
+
+void gnss_sky_table_metrics( gnss_sky_metrics_t* metrics, uint32_t now_ms )
+{
+    uint8_t top[4] = { 0 }; // strongest C/N0 first
+
+    memset( metrics, 0, sizeof( gnss_sky_metrics_t ));
+
+    for( uint8_t i = 0; i < sky_count; i++ )
+    {
+        const gnss_sky_sat_t* sat = &sky_sats[i];
+        uint8_t cn0 = sat->cn0;
+
+        if( !gnss_sky_is_fresh( sat, now_ms ))
+        {
+            continue;
+        }
+        metrics->in_view++;
+        if( cn0 == 0 )
+        {
+            continue;
+        }
+        metrics->tracked++;
+        metrics->tracked_by_constellation[sat->constellation]++;
+        if( cn0 >= GNSS_SKY_STRONG_CN0 )
+        {
+            metrics->strong++;
+            metrics->quadrant_mask |= 1 << ( sat->azimuth / 90 );
+        }
+        for( uint8_t j = 0; j < 4; j++ )
+        {
+            if( cn0 > top[j] )
+            {
+                uint8_t swap = top[j];
+                top[j] = cn0;
+                cn0 = swap;
+            }
+        }
+    }
+
+    metrics->top4_cn0 = ( top[0] + top[1] + top[2] + top[3] ) / 4;
+    for( uint8_t q = 0; q < 4; q++ )
+    {
+        metrics->quadrants += ( metrics->quadrant_mask >> q ) & 1;
+    }
+    metrics->gsv_count = sky_gsv_count;
+}
+
+const gnss_sky_sat_t* gnss_sky_table_get( uint8_t* count )
+{
+    *count = sky_count;
+    return sky_sats;
+}
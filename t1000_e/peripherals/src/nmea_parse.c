@@ -0,0 +1,406 @@
+#include "nmea_parse.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Decimal field as read: value / scale, scale 0 when empty (minmea_float)
+typedef struct
+{
+    int32_t value;
+    int32_t scale;
+} nmea_decimal_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static inline const char* nmea_field( const nmea_sentence_t* s, uint8_t index, uint8_t* len )
+{
+    *len = nmea_stream_field_len( s, index );
+    return s->line + s->field[index < s->field_count ? index : 0];
+}
+
+static inline bool nmea_is_digit( char c )
+{
+    return c >= '0' && c <= '9';
+}
+
+// minmea_scan 'f': optional leading spaces, sign, digits with one '.', extra precision truncated
+static bool nmea_field_decimal( const nmea_sentence_t* s, uint8_t index, nmea_decimal_t* out )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+    int8_t sign = 0;
+    int32_t value = -1;
+    int32_t scale = 0;
+
+    for( uint8_t i = 0; i < len; i++ )
+    {
+        char c = p[i];
+
+        if( c == '+' && sign == 0 && value == -1 )
+        {
+            sign = 1;
+        }
+        else if( c == '-' && sign == 0 && value == -1 )
+        {
+            sign = -1;
+        }
+        else if( nmea_is_digit( c ))
+        {
+            int32_t digit = c - '0';
+            if( value == -1 ) value = 0;
+            if( value > ( INT32_MAX - digit ) / 10 || scale > INT32_MAX / 10 )
+            {
+                if( scale != 0 ) break; // out of bits, drop the extra precision
+                return false;
+            }
+            value = value * 10 + digit;
+            if( scale != 0 ) scale *= 10;
+        }
+        else if( c == '.' && scale == 0 )
+        {
+            scale = 1;
+        }
+        else if( c == ' ' )
+        {
+            // Leading spaces only
+            if( sign != 0 || value != -1 || scale != 0 ) return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if(( sign != 0 || scale != 0 ) && value == -1 )
+    {
+        return false;
+    }
+    if( value == -1 )
+    {
+        out->value = 0;
+        out->scale = 0;
+        return true;
+    }
+    out->value = ( sign < 0 ) ? -value : value;
+    out->scale = ( scale == 0 ) ? 1 : scale;
+    return true;
+}
+
+// minmea_scan 'd': 1 for N/E, -1 for S/W, 0 if empty
+static bool nmea_field_direction( const nmea_sentence_t* s, uint8_t index, int8_t* dir )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+
+    *dir = 0;
+    if( len == 0 ) return true;
+    switch( p[0] )
+    {
+        case 'N':
+        case 'E': *dir = 1; return true;
+        case 'S':
+        case 'W': *dir = -1; return true;
+        default:  return false;
+    }
+}
+
+// minmea_scan 'i' (strtol, then nothing else in the field), 0 if empty
+static bool nmea_field_integer( const nmea_sentence_t* s, uint8_t index, int32_t* value )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+    uint8_t i = 0;
+    bool negative = false;
+    uint32_t result = 0;
+
+    *value = 0;
+    if( len == 0 ) return true;
+
+    while( i < len && p[i] == ' ' ) i++;
+    if( i < len && ( p[i] == '+' || p[i] == '-' ))
+    {
+        negative = ( p[i] == '-' );
+        i++;
+    }
+    if( i == len || !nmea_is_digit( p[i] ))
+    {
+        return false; // strtol converted nothing, the field start is left over
+    }
+    for( ; i < len && nmea_is_digit( p[i] ); i++ )
+    {
+        // Saturates like strtol( )
+        result = ( result <= 214748364UL ) ? result * 10 + ( p[i] - '0' ) : 0x80000000UL;
+        if( result > 0x80000000UL ) result = 0x80000000UL;
+    }
+    if( i != len )
+    {
+        return false;
+    }
+    if( negative )
+    {
+        *value = ( result == 0x80000000UL ) ? INT32_MIN : -( int32_t )result;
+    }
+    else
+    {
+        *value = ( result > INT32_MAX ) ? INT32_MAX : ( int32_t )result;
+    }
+    return true;
+}
+
+// minmea_scan 'c': first character, '\0' if empty
+static char nmea_field_char( const nmea_sentence_t* s, uint8_t index )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+    return len > 0 ? p[0] : '\0';
+}
+
+static inline int32_t nmea_two_digits( const char* p )
+{
+    return ( p[0] - '0' ) * 10 + ( p[1] - '0' );
+}
+
+// minmea_scan 'T': hhmmss[.sss], time of day in ms, -1 if empty
+static bool nmea_field_time( const nmea_sentence_t* s, uint8_t index, int32_t* time_ms )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+    int32_t ms = 0;
+
+    *time_ms = -1;
+    if( len == 0 ) return true;
+
+    // Six digits are read even past the field, the ',' or '*' there fails the check
+    for( uint8_t i = 0; i < 6; i++ )
+    {
+        if( !nmea_is_digit( p[i] )) return false;
+    }
+    if( p[6] == '.' )
+    {
+        int32_t scale = 100;
+        for( const char* f = p + 7; nmea_is_digit( *f ) && scale > 0; f++ )
+        {
+            ms += ( *f - '0' ) * scale;
+            scale /= 10;
+        }
+    }
+    *time_ms = (( nmea_two_digits( p ) * 60 + nmea_two_digits( p + 2 )) * 60 + nmea_two_digits( p + 4 )) * 1000 + ms;
+    return true;
+}
+
+// minmea_scan 'D': ddmmyy, -1 if empty
+static bool nmea_field_date( const nmea_sentence_t* s, uint8_t index, int8_t* day, int8_t* month, int8_t* year )
+{
+    uint8_t len;
+    const char* p = nmea_field( s, index, &len );
+
+    *day = *month = *year = -1;
+    if( len == 0 ) return true;
+    for( uint8_t i = 0; i < 6; i++ )
+    {
+        if( !nmea_is_digit( p[i] )) return false;
+    }
+    *day = nmea_two_digits( p );
+    *month = nmea_two_digits( p + 2 );
+    *year = nmea_two_digits( p + 4 );
+    return true;
+}
+
+// value / scale * unit, rounded half away from zero like minmea_rescale( )
+static int32_t nmea_decimal_scaled( const nmea_decimal_t* d, int32_t unit )
+{
+    int32_t value = d->value;
+    int32_t scale = d->scale;
+
+    if( scale == 0 ) return NMEA_PARSE_NONE;
+    if( scale == unit ) return value;
+    if( scale > unit )
+    {
+        int32_t div = scale / unit;
+        int32_t half = div / 2;
+        return ( value >= 0 ) ? ( value + half ) / div : ( value - half ) / div;
+    }
+    int32_t mul = unit / scale;
+    if( value > INT32_MAX / mul ) return INT32_MAX;
+    if( value < -( INT32_MAX / mul )) return -INT32_MAX;
+    return value * mul;
+}
+
+// dddmm.mmmm and its N/S/E/W letter to microdegrees, all in 32-bit integers
+static int32_t nmea_decimal_coord( const nmea_decimal_t* d, int8_t dir )
+{
+    uint32_t value = ( d->value < 0 ) ? -( uint32_t )d->value : ( uint32_t )d->value;
+    uint32_t scale = d->scale;
+    uint32_t degrees;
+    uint32_t minutes;
+    uint32_t micro;
+
+    if( scale == 0 ) return NMEA_PARSE_NONE;
+    if( dir == 0 ) return 0;
+
+    // Precision past a millionth of a minute is below a microdegree
+    while( scale > 1000000 )
+    {
+        value /= 10;
+        scale /= 10;
+    }
+    degrees = value / ( scale * 100 );
+    minutes = value % ( scale * 100 );                   // minutes * scale
+    micro = ( minutes * ( 1000000 / scale ) + 30 ) / 60; // minutes * 1e6 / 60, at most 1e8 before the division
+
+    micro = ( degrees < 2147 ) ? micro + degrees * 1000000 : INT32_MAX;
+    return (( d->value < 0 ) == ( dir < 0 )) ? ( int32_t )micro : -( int32_t )micro;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+bool nmea_parse_rmc( const nmea_sentence_t* sentence, nmea_rmc_t* out )
+{
+    // $GPRMC,081836,A,3751.65,S,14507.36,E,000.0,360.0,130998,011.3,E*62
+    nmea_decimal_t lat, lon, speed, course, variation;
+    int8_t lat_dir, lon_dir, variation_dir;
+
+    if( sentence->field_count < 12 ||
+        !nmea_field_time( sentence, 1, &out->time_ms ) ||
+        !nmea_field_decimal( sentence, 3, &lat ) || !nmea_field_direction( sentence, 4, &lat_dir ) ||
+        !nmea_field_decimal( sentence, 5, &lon ) || !nmea_field_direction( sentence, 6, &lon_dir ) ||
+        !nmea_field_decimal( sentence, 7, &speed ) ||
+        !nmea_field_decimal( sentence, 8, &course ) ||
+        !nmea_field_date( sentence, 9, &out->day, &out->month, &out->year ) ||
+        !nmea_field_decimal( sentence, 10, &variation ) || !nmea_field_direction( sentence, 11, &variation_dir ))
+    {
+        return false;
+    }
+
+    out->valid = ( nmea_field_char( sentence, 2 ) == 'A' );
+    out->latitude = nmea_decimal_coord( &lat, lat_dir );
+    out->longitude = nmea_decimal_coord( &lon, lon_dir );
+    out->speed_ukn = nmea_decimal_scaled( &speed, 1000000 );
+    out->course_cdeg = nmea_decimal_scaled( &course, 100 );
+    out->variation_cdeg = nmea_decimal_scaled( &variation, 100 );
+    if( out->variation_cdeg != NMEA_PARSE_NONE ) out->variation_cdeg *= variation_dir;
+    return true;
+}
+
+bool nmea_parse_gga( const nmea_sentence_t* sentence, nmea_gga_t* out )
+{
+    // $GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47
+    nmea_decimal_t lat, lon, hdop, altitude, height, dgps_age;
+    int8_t lat_dir, lon_dir;
+
+    if( sentence->field_count < 15 ||
+        !nmea_field_time( sentence, 1, &out->time_ms ) ||
+        !nmea_field_decimal( sentence, 2, &lat ) || !nmea_field_direction( sentence, 3, &lat_dir ) ||
+        !nmea_field_decimal( sentence, 4, &lon ) || !nmea_field_direction( sentence, 5, &lon_dir ) ||
+        !nmea_field_integer( sentence, 6, &out->fix_quality ) ||
+        !nmea_field_integer( sentence, 7, &out->satellites ) ||
+        !nmea_field_decimal( sentence, 8, &hdop ) ||
+        !nmea_field_decimal( sentence, 9, &altitude ) ||
+        !nmea_field_decimal( sentence, 11, &height ) ||
+        !nmea_field_decimal( sentence, 13, &dgps_age ))
+    {
+        return false;
+    }
+
+    out->latitude = nmea_decimal_coord( &lat, lat_dir );
+    out->longitude = nmea_decimal_coord( &lon, lon_dir );
+    out->hdop_x100 = nmea_decimal_scaled( &hdop, 100 );
+    out->altitude_cm = nmea_decimal_scaled( &altitude, 100 );
+    out->altitude_units = nmea_field_char( sentence, 10 );
+    out->height_cm = nmea_decimal_scaled( &height, 100 );
+    out->height_units = nmea_field_char( sentence, 12 );
+    return true;
+}
+
+bool nmea_parse_gst( const nmea_sentence_t* sentence, nmea_gst_t* out )
+{
+    // $GPGST,024603.00,3.2,6.6,4.7,47.3,5.8,5.6,22.0*58
+    nmea_decimal_t d[7];
+
+    if( sentence->field_count < 9 || !nmea_field_time( sentence, 1, &out->time_ms ))
+    {
+        return false;
+    }
+    for( uint8_t i = 0; i < 7; i++ )
+    {
+        if( !nmea_field_decimal( sentence, 2 + i, &d[i] )) return false;
+    }
+
+    out->rms_cm = nmea_decimal_scaled( &d[0], 100 );
+    out->semi_major_cm = nmea_decimal_scaled( &d[1], 100 );
+    out->semi_minor_cm = nmea_decimal_scaled( &d[2], 100 );
+    out->orientation_cdeg = nmea_decimal_scaled( &d[3], 100 );
+    out->latitude_err_cm = nmea_decimal_scaled( &d[4], 100 );
+    out->longitude_err_cm = nmea_decimal_scaled( &d[5], 100 );
+    out->altitude_err_cm = nmea_decimal_scaled( &d[6], 100 );
+    return true;
+}
+
+bool nmea_parse_gsv( const nmea_sentence_t* sentence, nmea_gsv_t* out )
+{
+    // $GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74
+    // $GPGSV,4,4,13*7B
+    int32_t* sat = &out->sats[0].nr;
+
+    if( sentence->field_count < 4 ||
+        !nmea_field_integer( sentence, 1, &out->total_msgs ) ||
+        !nmea_field_integer( sentence, 2, &out->msg_nr ) ||
+        !nmea_field_integer( sentence, 3, &out->total_sats ))
+    {
+        return false;
+    }
+    // Satellite blocks are optional, an absent field reads as 0
+    for( uint8_t i = 0; i < 16; i++ )
+    {
+        if( !nmea_field_integer( sentence, 4 + i, &sat[i] )) return false;
+    }
+    return true;
+}
+
+bool nmea_parse_vtg( const nmea_sentence_t* sentence, nmea_vtg_t* out )
+{
+    // $GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48
+    // $GPVTG,188.36,T,,M,0.820,N,1.519,K,A*3F
+    nmea_decimal_t d[4];
+    static const char units[4] = { 'T', 'M', 'N', 'K' };
+    static const int32_t scale[4] = { 100, 100, 1000000, 1000 };
+    int32_t* value[4] = { &out->true_track_cdeg, &out->magnetic_track_cdeg, &out->speed_ukn, &out->speed_kph_x1000 };
+
+    // Every field is optional
+    for( uint8_t i = 0; i < 4; i++ )
+    {
+        if( !nmea_field_decimal( sentence, 1 + 2 * i, &d[i] )) return false;
+    }
+    for( uint8_t i = 0; i < 4; i++ )
+    {
+        // Values only count with their unit letter
+        *value[i] = ( nmea_field_char( sentence, 2 + 2 * i ) == units[i] ) ? nmea_decimal_scaled( &d[i], scale[i] )
+                                                                           : NMEA_PARSE_NONE;
+    }
+    out->faa_mode = nmea_field_char( sentence, 9 );
+    return true;
+}
+
+bool nmea_parse_zda( const nmea_sentence_t* sentence, nmea_zda_t* out )
+{
+    // $GPZDA,201530.00,04,07,2002,00,00*60
+    if( sentence->field_count < 7 ||
+        !nmea_field_time( sentence, 1, &out->time_ms ) ||
+        !nmea_field_integer( sentence, 2, &out->day ) ||
+        !nmea_field_integer( sentence, 3, &out->month ) ||
+        !nmea_field_integer( sentence, 4, &out->year ) ||
+        !nmea_field_integer( sentence, 5, &out->hour_offset ) ||
+        !nmea_field_integer( sentence, 6, &out->minute_offset ))
+    {
+        return false;
+    }
+    return out->hour_offset >= -13 && out->hour_offset <= 13 && out->minute_offset >= 0 && out->minute_offset <= 59;
+}
@@ -0,0 +1,351 @@
+#include "nmea_stream.h"
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS ----------------------------------------------------------
+ */
+
+// Slot contents must be in memory before the index that hands the slot over
+#define NMEA_STREAM_BARRIER( ) __asm volatile( "" ::: "memory" )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+enum
+{
+    NMEA_STATE_IDLE = 0, // waiting for '$'
+    NMEA_STATE_BODY,     // accumulating, checksum running
+    NMEA_STATE_CS_HI,    // first checksum digit expected
+    NMEA_STATE_CS_LO,    // second checksum digit expected
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Perfect hash over the 3-letter sentence type: ((c0 + 5 * c1 + c2) >> 2) & 15
+// Coefficients were searched offline so every supported type lands on its own slot.
+#define NMEA_TYPE_HASH( c0, c1, c2 ) (((( uint8_t )( c0 ) + 5 * ( uint8_t )( c1 ) + ( uint8_t )( c2 )) >> 2 ) & 0x0F )
+
+static const struct
+{
+    char type[3];
+    uint8_t id;
+} nmea_type_table[16] = {
+    [0]  = { "VTG", NMEA_ID_VTG },
+    [3]  = { "GLL", NMEA_ID_GLL },
+    [5]  = { "RMC", NMEA_ID_RMC },
+    [8]  = { "TXT", NMEA_ID_TXT },
+    [9]  = { "GSA", NMEA_ID_GSA },
+    [10] = { "GGA", NMEA_ID_GGA },
+    [11] = { "ZDA", NMEA_ID_ZDA },
+    [14] = { "GST", NMEA_ID_GST },
+    [15] = { "GSV", NMEA_ID_GSV },
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static int8_t nmea_hex_digit( uint8_t c )
+{
+    if( c >= '0' && c <= '9' ) return c - '0';
+    if( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+    if( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+    return -1;
+}
+
+static void nmea_stream_dispatch( nmea_stream_t* stream, const char* line, const uint8_t* field, uint8_t field_count )
+{
+    nmea_sentence_t sentence;
+    const char* addr = line + 1;
+    uint8_t addr_len = 0;
+
+    sentence.id = NMEA_ID_UNKNOWN;
+    sentence.talker[0] = addr[0];
+    sentence.talker[1] = addr[1];
+    sentence.pair_id = 0;
+    sentence.line = line;
+    sentence.field = field;
+    sentence.field_count = field_count;
+    addr_len = nmea_stream_field_len( &sentence, 0 );
+
+    if( addr_len > 4 && addr[0] == 'P' && addr[1] == 'A' && addr[2] == 'I' && addr[3] == 'R' )
+    {
+        uint16_t pair_id = 0;
+        for( uint8_t i = 4; i < addr_len; i++ )
+        {
+            if( addr[i] < '0' || addr[i] > '9' ) return;
+            pair_id = pair_id * 10 + ( addr[i] - '0' );
+        }
+        sentence.id = NMEA_ID_PAIR;
+        sentence.pair_id = pair_id;
+    }
+    else if( addr_len == 5 )
+    {
+        uint8_t slot = NMEA_TYPE_HASH( addr[2], addr[3], addr[4] );
+        if( memcmp( nmea_type_table[slot].type, addr + 2, 3 ) == 0 )
+        {
+            sentence.id = ( nmea_stream_id_t )nmea_type_table[slot].id;
+        }
+    }
+
+    stream->sentences++;
+    if( stream->handler != NULL )
+    {
+        stream->handler( &sentence );
+    }
+}
+
+static void nmea_stream_complete( nmea_stream_t* stream )
+{
+    uint8_t head = stream->queue_head;
+    uint8_t used = ( uint8_t )( head - stream->queue_tail );
+    nmea_stream_slot_t* slot = NULL;
+
+    if( stream->queue == NULL )
+    {
+        nmea_stream_dispatch( stream, stream->buf, stream->field, stream->field_count );
+        return;
+    }
+
+    if( used >= stream->queue_size )
+    {
+        stream->queue_overruns++;
+        return;
+    }
+
+    // The slot is published by the head update, after its copy is complete
+    slot = &stream->queue[head & ( stream->queue_size - 1 )];
+    memcpy( slot->line, stream->buf, stream->len + 1 );
+    memcpy( slot->field, stream->field, stream->field_count + 1 );
+    slot->field_count = stream->field_count;
+    NMEA_STREAM_BARRIER( );
+    stream->queue_head = head + 1;
+
+    if( used + 1 > stream->queue_high_water )
+    {
+        stream->queue_high_water = used + 1;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void nmea_stream_init( nmea_stream_t* stream, nmea_stream_handler_t handler )
+{
+    memset( stream, 0, sizeof( nmea_stream_t ));
+    stream->handler = handler;
+}
+
+void nmea_stream_reset( nmea_stream_t* stream )
+{
+    // The parse state belongs to the feed, it only gets a request. Once the request is visible
+    // no sentence started before it can complete, so the queue can be emptied from this side.
+    stream->reset_request = true;
+    NMEA_STREAM_BARRIER( );
+    stream->queue_tail = stream->queue_head;
+}
+
+void nmea_stream_set_queue( nmea_stream_t* stream, nmea_stream_slot_t* slots, uint8_t count )
+{
+    stream->queue = slots;
+    stream->queue_size = count;
+    stream->queue_head = 0;
+    stream->queue_tail = 0;
+}
+
+uint8_t nmea_stream_process( nmea_stream_t* stream )
+{
+    uint8_t handled = 0;
+
+    if( stream->queue == NULL )
+    {
+        return 0;
+    }
+
+    while( stream->queue_tail != stream->queue_head )
+    {
+        uint8_t tail = stream->queue_tail;
+        const nmea_stream_slot_t* slot = &stream->queue[tail & ( stream->queue_size - 1 )];
+
+        nmea_stream_dispatch( stream, slot->line, slot->field, slot->field_count );
+        NMEA_STREAM_BARRIER( );
+        stream->queue_tail = tail + 1; // frees the slot for the feed
+        handled++;
+    }
+    return handled;
+}
+
+bool nmea_stream_pending( const nmea_stream_t* stream )
+{
+    return stream->queue != NULL && stream->queue_tail != stream->queue_head;
+}
+
+void nmea_stream_feed( nmea_stream_t* stream, uint8_t c )
+{
+    int8_t digit;
+
+    if( stream->reset_request )
+    {
+        stream->reset_request = false;
+        stream->state = NMEA_STATE_IDLE;
+        stream->len = 0;
+    }
+
+    // '$' always starts a new sentence, whatever was pending is dropped
+    if( c == '$' )
+    {
+        if( stream->state != NMEA_STATE_IDLE ) stream->overruns++;
+        stream->buf[0] = '$';
+        stream->len = 1;
+        stream->chk = 0;
+        stream->field[0] = 1;
+        stream->field_count = 1;
+        stream->state = NMEA_STATE_BODY;
+        return;
+    }
+
+    switch( stream->state )
+    {
+        case NMEA_STATE_BODY:
+        {
+            // Keep room for "*CS" and the terminating NUL
+            if( c < 0x20 || c > 0x7E || stream->len >= NMEA_STREAM_MAX_LENGTH - 4 )
+            {
+                stream->overruns++;
+                stream->state = NMEA_STATE_IDLE;
+                break;
+            }
+            stream->buf[stream->len++] = c;
+            if( c == '*' )
+            {
+                stream->field[stream->field_count] = stream->len; // sentinel, closes the last field
+                stream->state = NMEA_STATE_CS_HI;
+                break;
+            }
+            stream->chk ^= c;
+            if( c == ',' )
+            {
+                if( stream->field_count >= NMEA_STREAM_MAX_FIELDS )
+                {
+                    stream->overruns++;
+                    stream->state = NMEA_STATE_IDLE;
+                    break;
+                }
+                stream->field[stream->field_count++] = stream->len;
+            }
+            break;
+        }
+
+        case NMEA_STATE_CS_HI:
+        {
+            digit = nmea_hex_digit( c );
+            if( digit < 0 )
+            {
+                stream->checksum_errors++;
+                stream->state = NMEA_STATE_IDLE;
+                break;
+            }
+            stream->buf[stream->len++] = c;
+            stream->rx_chk = digit << 4;
+            stream->state = NMEA_STATE_CS_LO;
+            break;
+        }
+
+        case NMEA_STATE_CS_LO:
+        {
+            digit = nmea_hex_digit( c );
+            stream->state = NMEA_STATE_IDLE;
+            if( digit < 0 || ( stream->rx_chk | digit ) != stream->chk )
+            {
+                stream->checksum_errors++;
+                break;
+            }
+            stream->buf[stream->len++] = c;
+            stream->buf[stream->len] = '\0';
+            nmea_stream_complete( stream );
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void nmea_stream_feed_buffer( nmea_stream_t* stream, const uint8_t* data, uint16_t len )
+{
+    for( uint16_t i = 0; i < len; i++ )
+    {
+        nmea_stream_feed( stream, data[i] );
+    }
+}
+
+uint8_t nmea_stream_field_len( const nmea_sentence_t* sentence, uint8_t index )
+{
+    if( index >= sentence->field_count )
+    {
+        return 0;
+    }
+
+    // Each field ends one byte before the next start; the '*' sentinel closes the last one
+    return sentence->field[index + 1] - sentence->field[index] - 1;
+}
+
+bool nmea_stream_field_int( const nmea_sentence_t* sentence, uint8_t index, int32_t* value )
+{
+    uint8_t len = nmea_stream_field_len( sentence, index );
+    const char* p = NULL;
+    bool negative = false;
+    int32_t result = 0;
+    uint8_t i = 0;
+
+    if( len == 0 )
+    {
+        return false;
+    }
+    p = sentence->line + sentence->field[index];
+    if( p[0] == '-' || p[0] == '+' )
+    {
+        negative = ( p[0] == '-' );
+        i = 1;
+        if( len == 1 ) return false;
+    }
+    for( ; i < len; i++ )
+    {
+        if( p[i] < '0' || p[i] > '9' ) return false;
+        result = result * 10 + ( p[i] - '0' );
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
+
+bool nmea_stream_field_hex( const nmea_sentence_t* sentence, uint8_t index, uint32_t* value )
+{
+    uint8_t len = nmea_stream_field_len( sentence, index );
+    const char* p = NULL;
+    uint32_t result = 0;
+
+    if( len == 0 || len > 8 )
+    {
+        return false;
+    }
+    p = sentence->line + sentence->field[index];
+    for( uint8_t i = 0; i < len; i++ )
+    {
+        int8_t digit = nmea_hex_digit( p[i] );
+        if( digit < 0 ) return false;
+        result = ( result << 4 ) | digit;
+    }
+
+    *value = result;
+    return true;
+}
@@ -101,6 +101,7 @@ typedef enum eATEerror
 #define AT_TESTMODE_TYPE    "+TESTMODE_TYPE"
 #define AT_DISCONNECT       "+DISCONNECT"      
 #define AT_LBDADDR          "+LBDADDR"  
+#define AT_RADIOSTAT        "+RADIOSTAT"
 
 
 /**
@@ -583,6 +584,20 @@ ATEerror_t AT_WIFI_MAX_get(const char *param);
   */
 ATEerror_t AT_WIFI_MAX_set(const char *param);
 
+/**
+  * @brief  Print the LR1110 SPI and per-opcode BUSY statistics
+  * @param  param String parameter
+  * @retval AT_OK
+  */
+ATEerror_t AT_RADIOSTAT_get(const char *param);
+
+/**
+  * @brief  Clear the LR1110 SPI and per-opcode BUSY statistics
+  * @param  param String parameter
+  * @retval AT_OK
+  */
+ATEerror_t AT_RADIOSTAT_run(const char *param);
+
 #ifdef __cplusplus
 }
 #endif
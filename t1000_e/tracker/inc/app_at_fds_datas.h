@@ -20,6 +20,10 @@ extern "C" {
 #define CONFIG_FILE2    ( 0x4050 )
 #define CONFIG_REC_KEY2 ( 0x7050 )
 
+// GNSS time-to-fix histogram
+#define TTFF_FILE       ( 0x4060 )
+#define TTFF_REC_KEY    ( 0x7060 )
+
 typedef struct fds_access // access
 {
     uint16_t config_file;
@@ -58,6 +62,33 @@ bool update_record_by_desc( fds_record_desc_t * const p_desc, fds_record_t const
  */
 bool write_record_by_desc( fds_record_desc_t * const p_desc, fds_record_t const * const p_record );
 
+/*!
+ * @brief Read a standalone record
+ * 
+ * @param [in] file_id File ID of the record
+ * @param [in] rec_key Record key
+ * @param [out] data Pointer to buffer to read
+ * @param [in] len Buffer length to read
+ * 
+ * @return true if the record exists and holds at least len bytes
+ */
+bool read_fds_record( uint16_t file_id, uint16_t rec_key, void *data, uint16_t len );
+
+/*!
+ * @brief Write or update a standalone record
+ * 
+ * FDS reads the data after this call returns: data must be word aligned and
+ * stay valid, use a static buffer.
+ * 
+ * @param [in] file_id File ID of the record
+ * @param [in] rec_key Record key
+ * @param [in] data Pointer to buffer to write
+ * @param [in] len Data length, rounded up to whole words
+ * 
+ * @return true on success, false on fail
+ */
+bool write_fds_record( uint16_t file_id, uint16_t rec_key, void const *data, uint16_t len );
+
 /*!
  * @brief Waste recycle detect
  */
@@ -0,0 +1,95 @@
+/*!
+ * @file      app_ble_beacon.h
+ *
+ * @brief     iBeacon table filled from the BLE scanner advertising reports
+ *
+ * Each advertising report is parsed for an Apple iBeacon payload, checked
+ * against the approved UUID set frozen at scan start, then folded into a
+ * table of at most 32 beacons keyed by MAC + Major + Minor (open addressing,
+ * FNV-1a). A beacon keeps its strongest and mean RSSI, and the top
+ * BLE_BEACON_SEND_MUM by strongest RSSI are ranked as the reports arrive, so
+ * ble_get_results( ) and the hint getters of ble_scan.h have nothing left to
+ * sort at scan end.
+ *
+ * The module has no SoftDevice dependency: app_ble_all.c hands it the report
+ * data, and t1000_e/tracker/tools/ble_adv_storm_bench.c drives it on the host.
+ */
+
+#ifndef APP_BLE_BEACON_H
+#define APP_BLE_BEACON_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_scan.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define BLE_BEACON_BUF_MAX              32
+#define BLE_BEACON_SEND_MUM             5
+#define BLE_BEACON_UPLINK_RECORD_LEN    5
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+typedef struct {
+    uint16_t adv_reports;           // Advertising reports
+    uint16_t ibeacon_reports;       // Of which carried an iBeacon payload
+    uint16_t approved_reports;      // Of which had an approved UUID
+    uint16_t full_drops;            // Approved reports of a new beacon dropped, table full
+    uint8_t  unique_approved;       // Beacons in the table
+    uint8_t  invalid_minor;         // Of which with a Minor outside the 1..5 DR hints
+    uint8_t  rejected_uuid_logs;
+    uint8_t  name_logs;
+} app_ble_beacon_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Empty the table and freeze the approved UUID set for the coming scan
+ */
+void app_ble_beacon_scan_reset( void );
+
+/*!
+ * @brief Fold one advertising report into the table
+ *
+ * @param [in] adv_data Advertising data
+ * @param [in] adv_len  Advertising data length
+ * @param [in] mac      Advertiser address, 6 bytes
+ * @param [in] rssi     Measured RSSI of this report
+ */
+void app_ble_beacon_adv_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi );
+
+/*!
+ * @brief Log the report counters of the scan that just stopped
+ */
+void app_ble_beacon_scan_done( void );
+
+/*!
+ * @brief Get the report counters of the current or last scan
+ *
+ * @param [out] stats Counters
+ */
+void app_ble_beacon_get_stats( app_ble_beacon_stats_t* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // APP_BLE_BEACON_H
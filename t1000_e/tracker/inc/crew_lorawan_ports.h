@@ -9,6 +9,8 @@
  * FPort 8 is low-rate health/event traffic and should be preserved by the relay shim.
  * FPort 10 is reserved for gateway assistance downlinks.
  * FPort 11 is optional expanded RF fingerprint traffic with deployment-defined filtering.
+ * FPort 12 carries several routine/health records packed in one frame and should be preserved like FPort 8.
+ * FPort 13 carries stored records sent late, after a duty-cycle or coverage gap, and must not be sampled.
  */
 #define CREW_ROUTINE_APP_PORT       5
 #define CREW_ALERT_APP_PORT         6
@@ -16,5 +18,7 @@
 #define CREW_HEALTH_EVENT_APP_PORT  8
 #define GATEWAY_ASSISTANCE_PORT     10
 #define CREW_RF_FINGERPRINT_PORT    11
+#define CREW_PACKED_APP_PORT        12
+#define CREW_BACKLOG_APP_PORT       13
 
 #endif /* CREW_LORAWAN_PORTS_H */
@@ -240,6 +240,29 @@ typedef struct __attribute__( ( packed ) )
     uint8_t flags;
 } crew_rf_wifi_record_t;
 
+/*
+ * Packed frame (FPort 12): a sequence of records, each one header byte then the
+ * unchanged payload it would have had on its own FPort. The header holds the
+ * source FPort minus 4 (FPort 5 to 11) in bits 7-5 and the record length in
+ * bits 4-0.
+ */
+#define CREW_PACKED_RECORD_MAX_LEN               31U
+#define CREW_PACKED_RECORD_HEADER( port, len ) \
+    ( ( uint8_t )( ( ( ( ( port ) - 4U ) & 0x07U ) << 5 ) | \
+                   ( ( len ) & 0x1FU ) ) )
+#define CREW_PACKED_RECORD_PORT_GET( byte )      ( ( uint8_t )( ( ( ( byte ) >> 5 ) & 0x07U ) + 4U ) )
+#define CREW_PACKED_RECORD_LEN_GET( byte )       ( ( uint8_t )( ( byte ) & 0x1FU ) )
+
+/*
+ * Backlog frame (FPort 13): stored records sent once the link is back. A
+ * uint32 little-endian timestamp of the first record and the number of
+ * records still stored after this frame (saturated at 255), then per record
+ * the packed record header byte, the zigzag LEB128 time delta in seconds from
+ * the previous record (0 for the first) and the record payload.
+ */
+#define CREW_BACKLOG_HEADER_LEN                  5U
+#define CREW_BACKLOG_DELTA_MAX_LEN               5U
+
 #ifdef __cplusplus
 }
 #endif
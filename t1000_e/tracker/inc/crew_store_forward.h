@@ -0,0 +1,124 @@
+/*!
+ * @file      crew_store_forward.h
+ *
+ * @brief     Flash-backed store-and-forward queue for uplinks that could not go out
+ *
+ * Records refused by the duty cycle, or sent while the gateway was out of
+ * reach (failed LinkCheck), are appended with their timestamp to a ring of
+ * ADDR_FLASH_STORE_FORWARD_PAGES flash pages. When the link is back they are
+ * uplinked in FPort 13 backlog frames: safety (alert FPort) records newest
+ * first, then routine records oldest first, timestamps delta-coded (see
+ * CREW_BACKLOG_* in crew_payload_schema.h).
+ *
+ * Pages are filled and erased in turn, so wear is spread evenly; when the
+ * ring is full the oldest page is dropped. Every slot and page header ends
+ * with a commit word written last, so a power loss mid-write leaves at most
+ * one torn slot, which is skipped at the next mount. A record is marked sent
+ * only after the modem accepted its backlog frame, so delivery is at least
+ * once. RAM use is a few counters and one batch of slot addresses; the
+ * records themselves are only read back from flash.
+ *
+ * The module touches flash only through hal_flash_*, so it runs on the host
+ * against a simulated flash (t1000_e/tracker/tools/store_forward_sim.c).
+ */
+
+#ifndef CREW_STORE_FORWARD_H
+#define CREW_STORE_FORWARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define CREW_STORE_RECORD_MAX_LEN       28
+#define CREW_STORE_BATCH_MAX            12
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+typedef struct {
+    uint16_t pending;           // Records not yet sent
+    uint16_t pending_safety;    // Of which safety records
+    uint16_t capacity;          // Records the ring holds before dropping the oldest page
+    uint32_t dropped;           // Unsent records lost to page reuse since mount
+    uint32_t torn;              // Torn slots skipped at mount
+    uint32_t repeats;           // Appends skipped as a repeat of the port's last record since mount
+    uint32_t erase_min;         // Least and most erased page of the ring
+    uint32_t erase_max;
+} crew_store_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Mount the ring, formatting it if no page is valid
+ *
+ * Call once after hal_flash_init, and again after a simulated reset.
+ */
+void crew_store_init( void );
+
+/*!
+ * @brief Append a record
+ *
+ * A record equal to the last one appended for the same port, less than
+ * CREW_STORE_REPEAT_WINDOW_S after it, is the same uplink sent again: it is
+ * not stored a second time and counts as stored.
+ *
+ * @param [in] port        FPort the record was meant for, 5 to 11
+ * @param [in] record      Record payload
+ * @param [in] len         Record length, at most CREW_STORE_RECORD_MAX_LEN
+ * @param [in] timestamp_s Time the record was produced, UNIX time when synced
+ * @param [in] safety      Safety record, sent newest first ahead of routine ones
+ *
+ * @returns true if the record is in flash
+ */
+bool crew_store_append( uint8_t port, const uint8_t* record, uint8_t len, uint32_t timestamp_s, bool safety );
+
+/*!
+ * @brief Number of records not yet sent
+ */
+uint16_t crew_store_pending( void );
+
+/*!
+ * @brief Build the next FPort 13 backlog frame
+ *
+ * @param [in]  max_len Largest payload allowed for the next uplink
+ * @param [out] frame   Frame buffer of max_len bytes
+ *
+ * @returns Frame length, 0 if nothing is pending or no record fits
+ */
+uint8_t crew_store_build_batch( uint8_t max_len, uint8_t* frame );
+
+/*!
+ * @brief Mark the records of the last crew_store_build_batch as sent
+ */
+void crew_store_commit_batch( void );
+
+/*!
+ * @brief Get the ring counters
+ *
+ * @param [out] stats Counters
+ */
+void crew_store_get_stats( crew_store_stats_t* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CREW_STORE_FORWARD_H
@@ -0,0 +1,131 @@
+/*!
+ * @file      crew_uplink_packer.h
+ *
+ * @brief     Pending uplink records coalesced into one LoRaWAN frame
+ *
+ * Routine, proof and health records (compact presence, GNSS proof, FCnt-down
+ * sync) are queued here with a priority and a deadline instead of each
+ * paying its own LoRaWAN header, preamble and duty-cycle slot. When the queue
+ * is flushed the records are packed, highest priority and earliest deadline
+ * first, into one FPort 12 frame of at most the payload size allowed at the
+ * current DR (see CREW_PACKED_RECORD_HEADER in crew_payload_schema.h). A
+ * frame holding a single record is sent unchanged on that record's own FPort.
+ *
+ * The module has no radio dependency: the caller builds a frame, sends it and
+ * commits it only when the modem accepted the uplink, so records survive a
+ * refused send.
+ */
+
+#ifndef CREW_UPLINK_PACKER_H
+#define CREW_UPLINK_PACKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define CREW_UPLINK_PACKER_SLOTS        6
+#define CREW_UPLINK_PACKER_FRAME_MAX    ( CREW_UPLINK_PACKER_SLOTS * 32 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Record identity, a new record replaces a pending one with the same key
+ */
+typedef enum
+{
+    CREW_UPLINK_RECORD_PRESENCE = 0,
+    CREW_UPLINK_RECORD_FCNT_DOWN_SYNC,
+    CREW_UPLINK_RECORD_GNSS_PROOF,
+} crew_uplink_record_key_t;
+
+/*!
+ * @brief Record priority, the packing order when a frame cannot carry everything
+ */
+typedef enum
+{
+    CREW_UPLINK_PRIORITY_LOW = 0,
+    CREW_UPLINK_PRIORITY_ROUTINE,
+    CREW_UPLINK_PRIORITY_HIGH,
+} crew_uplink_priority_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Drop every pending record
+ */
+void crew_uplink_packer_clear( void );
+
+/*!
+ * @brief Queue a record
+ *
+ * When the queue is full the lowest ranked record is evicted if the new one
+ * ranks above it.
+ *
+ * @param [in] key         Record identity, see crew_uplink_record_key_t
+ * @param [in] port        FPort the record would use on its own, 5 to 11
+ * @param [in] record      Record payload
+ * @param [in] len         Record length, at most CREW_PACKED_RECORD_MAX_LEN
+ * @param [in] priority    See crew_uplink_priority_t
+ * @param [in] deadline_ms RTC time by which the record should be sent
+ * @param [in] confirmed   The record needs a confirmed uplink
+ *
+ * @returns true if the record is queued
+ */
+bool crew_uplink_packer_push( uint8_t key, uint8_t port, const uint8_t* record, uint8_t len, uint8_t priority,
+                              uint32_t deadline_ms, bool confirmed );
+
+/*!
+ * @brief Number of pending records
+ */
+uint8_t crew_uplink_packer_pending( void );
+
+/*!
+ * @brief Tell whether a pending record has reached its deadline
+ *
+ * @param [in] now_ms Current RTC time
+ */
+bool crew_uplink_packer_due( uint32_t now_ms );
+
+/*!
+ * @brief Pack the pending records into one frame
+ *
+ * Records that do not fit are left for the next frame.
+ *
+ * @param [in]  max_len   Largest payload allowed for the next uplink
+ * @param [out] frame     Frame buffer, CREW_UPLINK_PACKER_FRAME_MAX bytes
+ * @param [out] port      FPort to send the frame on
+ * @param [out] confirmed At least one packed record needs a confirmed uplink
+ *
+ * @returns Frame length, 0 if no record fits
+ */
+uint8_t crew_uplink_packer_build( uint8_t max_len, uint8_t* frame, uint8_t* port, bool* confirmed );
+
+/*!
+ * @brief Drop the records packed by the last crew_uplink_packer_build, once sent
+ */
+void crew_uplink_packer_commit( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CREW_UPLINK_PACKER_H
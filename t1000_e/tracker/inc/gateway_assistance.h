@@ -155,6 +155,10 @@ uint32_t gateway_assistance_get_time_uncertainty(void);
 /*!
  * @brief Get recommended GNSS scan duration based on assistance quality
  *
+ * The assistance age bucket gives the default; once the TTFF histogram holds
+ * enough samples for the current start type, assistance quality and almanac
+ * state, its percentile budget is used instead (see gnss_ttff_stats.h).
+ *
  * @returns Recommended scan duration in seconds
  */
 uint32_t gateway_assistance_get_recommended_scan_duration(void);
@@ -0,0 +1,94 @@
+/*!
+ * @file      gnss_fix_predict.h
+ *
+ * @brief     Early stop of hopeless GNSS scans from the C/N0 and SV trends
+ *
+ * Once per second of a scan the sky summary (top-4 mean C/N0, strong and
+ * tracked satellites) is sampled. After the observation window the level and
+ * least-squares slope of those series are projected over the rest of the
+ * budget and turned into the probability of a quality fix by a logistic
+ * model. The scan is stopped when that probability falls below
+ * REMEX_GNSS_PREDICT_MIN_PROB_PCT.
+ *
+ * Every evaluation is logged with its inputs, and the module has no hardware
+ * dependency, so recorded NMEA captures can be replayed through it on the
+ * host (t1000_e/tracker/tools/gnss_predict_replay.c) to tune the model.
+ */
+
+#ifndef GNSS_FIX_PREDICT_H
+#define GNSS_FIX_PREDICT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gnss_sky.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief One evaluation of the predictor, inputs included
+ */
+typedef struct {
+    uint32_t elapsed_ms;        // Time since the scan started
+    uint32_t budget_ms;         // Scan budget
+    uint8_t  top4_cn0;          // Latest top-4 mean C/N0, dB-Hz
+    uint8_t  strong;            // Latest satellites at or above GNSS_SKY_STRONG_CN0
+    uint8_t  tracked;           // Latest satellites with a C/N0
+    uint8_t  samples;           // Samples in the trend window
+    float    cn0_slope;         // top4_cn0 trend, dB-Hz per second
+    float    strong_slope;      // strong trend, satellites per second
+    uint8_t  probability;       // Chance of a quality fix within the budget, %
+    bool     evaluated;         // A new sample was taken and judged by this call
+    bool     stop;              // The scan should stop
+} gnss_fix_predict_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Forget the previous scan, call before each scan
+ */
+void gnss_fix_predict_start( void );
+
+/*!
+ * @brief Change the stop threshold, REMEX_GNSS_PREDICT_MIN_PROB_PCT by default
+ *
+ * @param [in] min_prob_pct Stop below this probability of a quality fix, 0 never stops
+ */
+void gnss_fix_predict_set_threshold( uint8_t min_prob_pct );
+
+/*!
+ * @brief Sample the sky and judge the scan
+ *
+ * Call as often as convenient; a sample is taken at most once per second.
+ * The probability is 100 until the observation window is over, and no stop
+ * is ever requested before GSV has been received.
+ *
+ * @param [in]  elapsed_ms Time since the scan started
+ * @param [in]  budget_ms  Scan budget
+ * @param [in]  sky        Current sky summary
+ * @param [out] result     Evaluation and its inputs, may be NULL
+ *
+ * @returns true if the scan should stop now
+ */
+bool gnss_fix_predict_update( uint32_t elapsed_ms, uint32_t budget_ms, const gnss_sky_metrics_t* sky,
+                              gnss_fix_predict_t* result );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // GNSS_FIX_PREDICT_H
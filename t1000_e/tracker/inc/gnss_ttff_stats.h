@@ -0,0 +1,146 @@
+/*!
+ * @file      gnss_ttff_stats.h
+ *
+ * @brief     Persisted AG3335 time-to-fix histogram and adaptive scan budget
+ *
+ * Every quality scan outcome is binned per acquisition context:
+ * - start type: PAIR004 hot, PAIR005 warm, or no assisted start (cold)
+ * - gateway assistance quality (assistance_quality_t)
+ * - PAIR550 almanac valid SV count bucket
+ *
+ * Only fixes are binned. A scan that ends without a fix is a censored sample
+ * ("more than the scan length") and is only counted, so a context that keeps
+ * failing does not stretch its budget. The scan budget is the target
+ * percentile of the fix times plus a margin, clamped by the caller's limits;
+ * it only grows past the scan length when fixes keep arriving near its end.
+ * While censored samples make up REMEX_GNSS_TTFF_FAIL_PCT or more of a
+ * context, the caller's default is used instead, so a budget that learned to
+ * be short sees the slower fixes again.
+ *
+ * The histogram is kept in an FDS record of its own, written back at a
+ * bounded rate to spare the flash.
+ */
+
+#ifndef GNSS_TTFF_STATS_H
+#define GNSS_TTFF_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+#define GNSS_TTFF_BIN_NUM           12      // Histogram bins per context, the last one is open-ended
+#define GNSS_TTFF_SV_BUCKET_NUM     3       // Almanac SV buckets: <4, 4..23, >=24
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Assisted start sent to the AG3335 before an acquisition
+ */
+typedef enum {
+    GNSS_START_COLD = 0,    // No PAIR004/PAIR005 before the scan
+    GNSS_START_WARM,        // PAIR005
+    GNSS_START_HOT,         // PAIR004
+    GNSS_START_TYPE_NUM
+} gnss_start_type_t;
+
+/*!
+ * @brief Summary of the histogram of one acquisition context
+ */
+typedef struct {
+    uint8_t  start_type;
+    uint8_t  quality;
+    uint8_t  sv_bucket;
+    uint16_t samples;           // Weighted fix count, older samples decay
+    uint16_t censored;          // Scans that ended without a fix
+    uint32_t budget_ms;         // Learned budget, 0 while there are too few samples
+} gnss_ttff_context_info_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Load the histogram from flash, or start an empty one
+ *
+ * Must run after fds_init_write( ).
+ */
+void gnss_ttff_stats_init( void );
+
+/*!
+ * @brief Note the assisted start command sent before the next acquisition
+ *
+ * @param [in] start_type Start command accepted by the receiver
+ */
+void gnss_ttff_stats_note_start( gnss_start_type_t start_type );
+
+/*!
+ * @brief Leave the next acquisition out of the statistics
+ *
+ * For scans on a receiver that was already tracking (background GNSS while
+ * charging): their time to fix says nothing about a start.
+ */
+void gnss_ttff_stats_skip_next( void );
+
+/*!
+ * @brief Record the outcome of the last gnss_scan_until_good( ) call
+ *
+ * Reads gnss_get_acq_stats( ). BLE-aborted scans and scans flagged with
+ * gnss_ttff_stats_skip_next( ) are ignored. The start type noted before the
+ * scan is consumed.
+ */
+void gnss_ttff_stats_record_acquisition( void );
+
+/*!
+ * @brief Scan budget for an acquisition started now
+ *
+ * @param [in] default_ms Budget used while the current context has too few samples
+ * @param [in] min_ms     Lower clamp of a learned budget
+ * @param [in] max_ms     Upper clamp of a learned budget
+ *
+ * @return Scan budget in milliseconds
+ */
+uint32_t gnss_ttff_stats_scan_budget_ms( uint32_t default_ms, uint32_t min_ms, uint32_t max_ms );
+
+/*!
+ * @brief Describe the current acquisition context
+ *
+ * @param [out] info Context summary
+ */
+void gnss_ttff_stats_get_context( gnss_ttff_context_info_t *info );
+
+/*!
+ * @brief Write the histogram back to flash if it changed
+ *
+ * @param [in] force Ignore the sample count and interval limits
+ *
+ * @return true if the record was written
+ */
+bool gnss_ttff_stats_save( bool force );
+
+/*!
+ * @brief Forget every sample, in RAM and in flash
+ */
+void gnss_ttff_stats_clear( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GNSS_TTFF_STATS_H
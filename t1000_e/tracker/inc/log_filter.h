@@ -23,6 +23,11 @@ bool log_filter_is_enabled( log_filter_category_t category );
 void log_filter_printf( log_filter_category_t category, const char* fmt, ... );
 void log_filter_vprintf( log_filter_category_t category, const char* fmt, va_list args );
 
+// Deferred mode queues the format string address and raw arguments instead of
+// text; decode_tracker_log.py expands them with the firmware ELF.
+bool log_filter_is_deferred( void );
+void log_filter_set_deferred( bool enable );
+
 // Consumes single-key serial toggles before they enter the AT command buffer.
 // Keys are intentionally sparse so ordinary AT commands are not intercepted.
 bool log_filter_handle_serial_char( uint8_t ch );
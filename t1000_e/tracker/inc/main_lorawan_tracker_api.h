@@ -25,6 +25,15 @@ bool app_send_mob_frame( const uint8_t* buffer, const uint8_t length, bool tx_co
 
 bool app_send_mob_initial_burst( const uint8_t* buffer, const uint8_t length, bool tx_confirmed );
 
+/* The next frame repeats one already sent: out of coverage it is not stored for the backlog again. */
+void app_send_mark_repeat( void );
+
+/* Frames of this length, up to count, the duty cycle lets the MOB/PIW path send now at the policy DR. */
+uint8_t app_mob_frames_fit( const uint8_t length, uint8_t count, app_mob_dr_policy_t policy );
+
+/* Time until count such frames fit: 0 now, -1 never within one duty-cycle period or not valid at the policy DR. */
+int32_t app_mob_airtime_wait_ms( const uint8_t length, uint8_t count, app_mob_dr_policy_t policy );
+
 void app_tracker_new_run( uint8_t event );
 
 void app_radio_set_sleep( void );
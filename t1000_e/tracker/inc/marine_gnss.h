@@ -56,9 +56,13 @@ extern "C" {
 #define PIW_PHASE3_INTERVAL_S       120             // 120 seconds
 
 // Quality thresholds for PIW mode
-#define PIW_GNSS_MAX_SCAN_MS        20000           // 20 second max scan
+#define PIW_GNSS_MAX_SCAN_MS        20000           // 20 second max scan, default until TTFF history exists
+#define PIW_GNSS_LEARN_MIN_MS       8000            // Floor of the TTFF-learned scan budget
+#define PIW_GNSS_LEARN_MAX_MS       45000           // Ceiling of the TTFF-learned scan budget
 #define PIW_GNSS_MAX_HDOP           3.0f            // Maximum acceptable HDOP
 #define PIW_GNSS_MAX_HACC_M         15.0f           // Maximum acceptable HACC (meters)
+#define PIW_GNSS_TIGHT_SCAN_MS      10000           // Max scan when the track prediction is already tight
+#define PIW_TRACK_TIGHT_RADIUS_M    50.0f           // Predicted 95% radius below which the tight scan applies
 
 // BLE scan parameters (runs in parallel)
 #define MOB_BLE_SCAN_DURATION_S     3               // BLE scan duration
@@ -107,10 +111,13 @@ typedef struct __attribute__((packed)) {
     int32_t  latitude;      // Latitude * 1e6
     int32_t  longitude;     // Longitude * 1e6
     uint8_t  hdop_x10;      // HDOP * 10 (e.g., 15 = HDOP 1.5)
-    uint8_t  quality_flags; // Bit 0: fix_valid, Bit 1: quality_ok, Bit 3: COG/SOG valid
+    uint8_t  quality_flags; // Bit 0: fix_valid, Bit 1: quality_ok, Bit 3: COG/SOG valid, Bit 4: prediction valid
     int8_t   battery;       // Battery percentage
     uint16_t cog_x2;        // Firmware-derived course over ground, degrees * 2; 0xFFFF unknown
     uint8_t  sog_dmps;      // Firmware-derived speed over ground, 0.1 m/s; 0xFF unknown
+    int16_t  pred_north_m;  // Track prediction at uplink time, meters north of latitude/longitude
+    int16_t  pred_east_m;   // Track prediction at uplink time, meters east of latitude/longitude
+    uint16_t pred_radius_m; // 95% radius of the prediction in meters; 0xFFFF unknown
 } mob_position_uplink_t;
 
 /*
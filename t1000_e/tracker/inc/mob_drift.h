@@ -0,0 +1,116 @@
+/*!
+ * @file      mob_drift.h
+ *
+ * @brief     PIW drift vector (COG/SOG) fitted over the recent fixes
+ *
+ * The last REMEX_PIW_DRIFT_FIX_WINDOW fixes are fitted to a straight track
+ * in a local east/north frame, weighted by their estimated position error.
+ * Fixes far from the provisional track over the whole window are gated out
+ * of the robust track the vector is taken from. Both tracks are kept as
+ * running moments, so a new fix costs one projection and a re-gate of the
+ * stored decisions; the window is refitted exactly every
+ * REMEX_PIW_DRIFT_REBUILD_UPDATES fixes.
+ *
+ * The module has no hardware dependency: marine_gnss.c feeds it the PIW
+ * fixes with their RTC time, and t1000_e/tracker/tools/drift_fit_replay.c
+ * replays synthetic drift tracks through it on the host.
+ */
+
+#ifndef MOB_DRIFT_H
+#define MOB_DRIFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ag3335.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+#define MOB_DRIFT_EARTH_RADIUS_M        6371000.0f
+#define MOB_DRIFT_DEG_TO_RAD            0.01745329251994329577f
+#define MOB_DRIFT_UNKNOWN_COG_X2        0xFFFFU
+#define MOB_DRIFT_UNKNOWN_SOG_DMPS      0xFFU
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+typedef struct
+{
+    bool     valid;
+    uint16_t cog_x2;                // Course over ground, 0.5 deg
+    uint8_t  sog_dmps;              // Speed over ground, 0.1 m/s
+    float    east_mps;
+    float    north_mps;
+    float    sog_mps;
+    uint8_t  fix_count;             // Fixes in the window
+    uint8_t  used_count;            // Of which inside the residual gate
+    uint8_t  rejected_count;
+    uint32_t baseline_s;            // Oldest to newest used fix
+    float    rms_residual_m;
+} mob_drift_vector_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Forget every fix, call when a MOB starts
+ */
+void mob_drift_reset( void );
+
+/*!
+ * @brief Estimated 1-sigma horizontal error of a fix, from HACC or HDOP
+ *
+ * @param [in] fix GNSS fix
+ *
+ * @returns Error in meters, within the REMEX_PIW_DRIFT_SIGMA_* limits
+ */
+float mob_drift_sigma_m( const gnss_fix_t* fix );
+
+/*!
+ * @brief Add a fix to the window and refit the drift vector
+ *
+ * A fix of the same epoch as the previous one, or at the same position
+ * within REMEX_PIW_DRIFT_DUPLICATE_FIX_S, is ignored.
+ *
+ * @param [in] fix     Valid GNSS fix
+ * @param [in] epoch_s RTC time of the fix epoch, seconds
+ */
+void mob_drift_add_fix( const gnss_fix_t* fix, uint32_t epoch_s );
+
+/*!
+ * @brief Get the drift vector in its uplink encoding
+ *
+ * @param [out] cog_x2   Course over ground, 0.5 deg
+ * @param [out] sog_dmps Speed over ground, 0.1 m/s
+ *
+ * @returns true if the window spans enough time and movement for a vector
+ */
+bool mob_drift_get_vector( uint16_t* cog_x2, uint8_t* sog_dmps );
+
+/*!
+ * @brief Get the last drift vector with its fit details
+ *
+ * @param [out] vector Vector, valid false while unknown
+ */
+void mob_drift_get_result( mob_drift_vector_t* vector );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MOB_DRIFT_H
@@ -8,6 +8,7 @@
 #include "app_config_param.h"
 #include "app_at_fds_datas.h"
 #include "app_ble_all.h"
+#include "lr11xx_hal_context.h"
 
 #define tiny_sscanf sscanf
 
@@ -1268,3 +1269,28 @@ ATEerror_t AT_WIFI_MAX_set(const char *param)
     return AT_OK;
 }
 /*------------------------AT+WIFI_MAX=?\r\n-------------------------------------*/
+
+/*------------------------AT+RADIOSTAT=?\r\n-------------------------------------*/
+ATEerror_t AT_RADIOSTAT_get(const char *param) {
+    lr11xx_hal_stats_t stats;
+    hal_spi_stats_t spi_stats;
+    lr11xx_hal_busy_stats_t busy;
+
+    lr11xx_hal_get_stats(&stats);
+    hal_spi_get_stats(&spi_stats);
+    AT_PRINTF("commands:%lu busy_timeouts:%lu spi_transfers:%lu spi_bytes:%lu\r\n",
+              stats.commands, stats.busy_timeouts, spi_stats.transfers, spi_stats.bytes);
+    AT_PRINTF("opcode count min_us mean_us max_us\r\n");
+    for (uint8_t i = 0; lr11xx_hal_get_busy_stat(i, &busy); i++) {
+        AT_PRINTF("%04X %lu %lu %lu %lu\r\n", busy.opcode, busy.count, busy.min_us,
+                  (uint32_t)(busy.total_us / busy.count), busy.max_us);
+    }
+    return AT_OK;
+}
+
+ATEerror_t AT_RADIOSTAT_run(const char *param) {
+    lr11xx_hal_reset_stats();
+    hal_spi_reset_stats();
+    return AT_OK;
+}
+/*------------------------AT+RADIOSTAT=?\r\n-------------------------------------*/
@@ -425,6 +425,17 @@ static const struct ATCommand_s ATCommand[] =
         .set = AT_return_error,
         .run = AT_return_error,
     },
+
+    {
+        .string = AT_RADIOSTAT,
+        .size_string = sizeof(AT_RADIOSTAT) - 1,
+        #ifndef NO_HELP
+        .help_string = "AT" AT_RADIOSTAT " Get or clear the LR1110 command statistics, BUSY time per opcode in us\r\n",
+        #endif /* !NO_HELP */
+        .get = AT_RADIOSTAT_get,
+        .set = AT_return_error,
+        .run = AT_RADIOSTAT_run,
+    },
 };
 
 /**
@@ -288,6 +288,53 @@ bool write_current_param_config( void )
     return true;
 }
 
+bool read_fds_record( uint16_t file_id, uint16_t rec_key, void *data, uint16_t len )
+{
+    ret_code_t rc;
+    fds_record_desc_t desc = { 0 };
+    fds_find_token_t tok = { 0 };
+    fds_flash_record_t temp = { 0 };
+    uint16_t rec_length = 0;
+
+    rc = fds_record_find( file_id, rec_key, &desc, &tok );
+    if( rc != NRF_SUCCESS )
+    {
+        return false;
+    }
+    rc = fds_record_open( &desc, &temp );
+    if( rc != NRF_SUCCESS )
+    {
+        PRINTF( "open record %04x error,code:%0x\r\n", rec_key, rc );
+        return false;
+    }
+    rec_length = temp.p_header->length_words * sizeof( uint32_t );
+    memcpy( data, temp.p_data, rec_length < len ? rec_length : len );
+    rc = fds_record_close( &desc );
+    APP_ERROR_CHECK( rc );
+    return rec_length >= len;
+}
+
+bool write_fds_record( uint16_t file_id, uint16_t rec_key, void const *data, uint16_t len )
+{
+    fds_record_desc_t desc = { 0 };
+    fds_find_token_t tok = { 0 };
+    fds_record_t record =
+    {
+        .file_id = file_id,
+        .key = rec_key,
+        .data.p_data = data,
+        .data.length_words = ( len + 3 ) / sizeof( uint32_t )
+    };
+
+    waste_detect_recycle( );
+    if( fds_record_find( file_id, rec_key, &desc, &tok ) == NRF_SUCCESS )
+    {
+        return update_record_by_desc( &desc, &record );
+    }
+    memset( &desc, 0, sizeof( desc ));
+    return write_record_by_desc( &desc, &record );
+}
+
 static bool remex_apply_crew_config_defaults_once( void )
 {
     if( app_param.param_version >= REMEX_CREW_CONFIG_VERSION )
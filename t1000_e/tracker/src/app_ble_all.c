@@ -21,6 +21,7 @@
 #include "app_config_param.h"
 #include "app_ble_nus.h"
 #include "app_ble_all.h"
+#include "app_ble_beacon.h"
 #include "app_user_timer.h"
 #include "log_filter.h"
 #include "crew_dr_strategy_config.h"
@@ -62,30 +63,7 @@ static ble_gap_scan_params_t const m_scan_param =
     .scan_phys     = BLE_GAP_PHY_1MBPS,
 };
 
-#define BEACON_DATA_LEN     0x15
-#define BEACON_DATA_TYPE    0x02
-#define COMPANY_IDENTIFIER  0x004C
-
-#define BLE_BEACON_BUF_MAX  16
-#define BLE_BEACON_SEND_MUM 5
-#define BLE_BEACON_UPLINK_RECORD_LEN 5
-#define BLE_SCAN_DEBUG_REJECT_LOG_MAX 8
-#define BLE_SCAN_DEBUG_NAME_LOG_MAX 8
-#define BLE_AD_TYPE_SHORT_LOCAL_NAME 0x08
-#define BLE_AD_TYPE_COMPLETE_LOCAL_NAME 0x09
-
-bool s_filter_flag = false;
-uint8_t ble_beacon_res_num = 0;
-BleBeacons_t ble_beacon_buf[BLE_BEACON_BUF_MAX] = { 0 };
-uint8_t ble_beacon_rssi_array[BLE_BEACON_BUF_MAX] = { 0 };
-uint8_t ble_uuid_filter_array[16] = { 0 };
-uint8_t ble_uuid_filter_num = 0;
 static bool s_ble_scanning = false;                                                     /**< Internal flag tracking if a BLE scan is active */
-static uint16_t s_ble_adv_reports = 0;
-static uint16_t s_ble_ibeacon_seen = 0;
-static uint16_t s_ble_approved_reports = 0;
-static uint8_t s_ble_rejected_uuid_logs = 0;
-static uint8_t s_ble_name_logs = 0;
 
 BLE_NUS_DEF(m_nus, NRF_SDH_BLE_TOTAL_LINK_COUNT);
 
@@ -112,12 +90,6 @@ static ble_uuid_t m_adv_uuids[] =
 
 static void advertising_start( void * p_erase_bonds );
 static void send_data_to_ble( uint8_t* buffer,uint16_t length );
-static bool buf_cmp_value( uint8_t *a, uint8_t *b, uint8_t len );
-static const uint8_t* ble_find_ibeacon_payload( const uint8_t* adv_data, uint16_t adv_len );
-static void ble_log_local_name_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi );
-static bool beacon_uuid_approved( const uint8_t *uuid );
-static void ble_uuid_to_hex( const uint8_t *uuid, char *out, uint8_t out_len );
-static void ble_mac_to_hex( const uint8_t *mac, char *out, uint8_t out_len );
 
 
 /**@brief Function for assert macro callback.
@@ -397,78 +369,9 @@ static void ble_evt_handler( ble_evt_t const * p_ble_evt, void * p_context )
     {
         case BLE_GAP_EVT_ADV_REPORT:
         {
-            s_ble_adv_reports++;
-            if( m_scan.scan_buffer.len )
-            {
-                ble_log_local_name_report( m_scan.scan_buffer.p_data, m_scan.scan_buffer.len,
-                                           p_gap_evt->params.adv_report.peer_addr.addr,
-                                           p_gap_evt->params.adv_report.rssi );
-                const uint8_t *p_data = ble_find_ibeacon_payload( m_scan.scan_buffer.p_data, m_scan.scan_buffer.len );
-                if( p_data != NULL )
-                {
-                            uint16_t company_identifier = COMPANY_IDENTIFIER;
-                            s_filter_flag = true;
-                            s_ble_ibeacon_seen++;
-
-                            if( beacon_uuid_approved(( const uint8_t * )p_data + 4 ) == false )
-                            {
-                                if( s_ble_rejected_uuid_logs < BLE_SCAN_DEBUG_REJECT_LOG_MAX )
-                                {
-                                    char uuid_str[33];
-                                    char mac_str[18];
-                                    ble_uuid_to_hex( p_data + 4, uuid_str, sizeof( uuid_str ));
-                                    ble_mac_to_hex( p_gap_evt->params.adv_report.peer_addr.addr, mac_str, sizeof( mac_str ));
-                                    LOG_BLE( "iBeacon rejected UUID=%s mac=%s rssi=%d dBm\n",
-                                             uuid_str, mac_str, p_gap_evt->params.adv_report.rssi );
-                                    s_ble_rejected_uuid_logs++;
-                                }
-                                return;
-                            }
-
-                            s_ble_approved_reports++;
-
-                            bool res0 = true, res1 = true, res2 = true, res3 = true, res4 = true, res5 = true;
-                            for( uint8_t j = 0; j < BLE_BEACON_BUF_MAX; j++ )
-                            {
-                                res1 = buf_cmp_value( ble_beacon_buf[j].uuid, ( uint8_t *)( p_data + 4 ), 16 );
-                                res2 = buf_cmp_value(( uint8_t *)( &ble_beacon_buf[j].major ), ( uint8_t *)( p_data + 20 ), 2 );
-                                res3 = buf_cmp_value(( uint8_t *)( &ble_beacon_buf[j].minor ), ( uint8_t *)( p_data + 22 ), 2 );
-                                // res4 = buf_cmp_value(( uint8_t *)( &ble_beacon_buf[j].rssi ), ( uint8_t *)( p_gap_evt->params.adv_report.rssi + 24 ), 1 );
-                                res5 = buf_cmp_value(( uint8_t *)( &ble_beacon_buf[j].mac ), ( uint8_t *)( p_gap_evt->params.adv_report.peer_addr.addr ), 6 );
-                                if( res1 && res2 && res3 && res4 && res5 ) // all is same, don't save the scan result
-                                {
-                                    res0 = false;
-                                    break;
-                                }
-                            }
-                            if( res0 )
-                            {
-                                if(( ble_beacon_res_num < BLE_BEACON_BUF_MAX ) && ( ble_beacon_buf[ble_beacon_res_num].company_id == 0 ))
-                                {
-                                    ble_beacon_buf[ble_beacon_res_num].company_id = company_identifier;
-                                    memcpy( ble_beacon_buf[ble_beacon_res_num].uuid, p_data + 4, 16 );
-                                    memcpy(( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].major ), p_data + 20, 2 );
-                                    memcpy(( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].minor ), p_data + 22, 2 );
-                                    memcpy(( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].rssi ), p_data + 24, 1 );
-                                    memcpy(( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].rssi_ ), ( uint8_t *)( &p_gap_evt->params.adv_report.rssi ), 1 );
-                                    memcpy(( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].mac ), ( uint8_t *)( p_gap_evt->params.adv_report.peer_addr.addr ), 6 );
-                                    uint16_t major = 0, minor = 0;
-                                    char uuid_str[33];
-                                    char mac_str[18];
-                                    memcpyr(( uint8_t *)( &major ), ( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].major ), 2 );
-                                    memcpyr(( uint8_t *)( &minor ), ( uint8_t *)( &ble_beacon_buf[ble_beacon_res_num].minor ), 2 );
-                                    ble_uuid_to_hex( ble_beacon_buf[ble_beacon_res_num].uuid, uuid_str, sizeof( uuid_str ));
-                                    ble_mac_to_hex( ble_beacon_buf[ble_beacon_res_num].mac, mac_str, sizeof( mac_str ));
-                                    LOG_BLE( "iBeacon approved #%u UUID=%s major=%u minor=%u tx=%d dBm rssi=%d dBm mac=%s\n",
-                                             ble_beacon_res_num + 1, uuid_str, major, minor,
-                                             ble_beacon_buf[ble_beacon_res_num].rssi,
-                                             ble_beacon_buf[ble_beacon_res_num].rssi_, mac_str );
-                                    ble_beacon_res_num ++;
-                                    break;
-                                }   
-                            }
-                }
-            }
+            app_ble_beacon_adv_report( m_scan.scan_buffer.p_data, m_scan.scan_buffer.len,
+                                       p_gap_evt->params.adv_report.peer_addr.addr,
+                                       p_gap_evt->params.adv_report.rssi );
         } break;
 
         case BLE_GAP_EVT_DISCONNECTED:
@@ -595,181 +498,11 @@ static void scan_init( void )
     APP_ERROR_CHECK( err_code );
 }
 
-static bool buf_cmp_value( uint8_t *a, uint8_t *b, uint8_t len )
-{
-    for( uint8_t i = 0; i < len; i++ )
-    {
-        if( a[i] != b[i] )
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-static const uint8_t* ble_find_ibeacon_payload( const uint8_t* adv_data, uint16_t adv_len )
-{
-    uint16_t offset = 0;
-
-    while( offset < adv_len )
-    {
-        uint8_t field_len = adv_data[offset];
-
-        if( field_len == 0 )
-        {
-            break;
-        }
-
-        if(( offset + field_len ) >= adv_len )
-        {
-            break;
-        }
-
-        uint8_t field_type = adv_data[offset + 1];
-        const uint8_t* field_data = &adv_data[offset + 2];
-        uint8_t field_data_len = field_len - 1;
-
-        if(( field_type == BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA ) &&
-           ( field_data_len >= ( 2 + 2 + BEACON_DATA_LEN )))
-        {
-            uint16_t company_identifier = 0;
-            memcpy(( uint8_t* )( &company_identifier ), field_data, 2 );
-
-            if(( company_identifier == COMPANY_IDENTIFIER ) &&
-               ( field_data[2] == BEACON_DATA_TYPE ) &&
-               ( field_data[3] == BEACON_DATA_LEN ))
-            {
-                return field_data;
-            }
-        }
-
-        offset += field_len + 1;
-    }
-
-    return NULL;
-}
-
-static void ble_log_local_name_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi )
-{
-    uint16_t offset = 0;
-
-    if( s_ble_name_logs >= BLE_SCAN_DEBUG_NAME_LOG_MAX )
-    {
-        return;
-    }
-
-    while( offset < adv_len )
-    {
-        uint8_t field_len = adv_data[offset];
-
-        if( field_len == 0 )
-        {
-            break;
-        }
-
-        if(( offset + field_len ) >= adv_len )
-        {
-            break;
-        }
-
-        uint8_t field_type = adv_data[offset + 1];
-        const uint8_t* field_data = &adv_data[offset + 2];
-        uint8_t field_data_len = field_len - 1;
-
-        if((( field_type == BLE_AD_TYPE_SHORT_LOCAL_NAME ) || ( field_type == BLE_AD_TYPE_COMPLETE_LOCAL_NAME )) &&
-           ( field_data_len > 0 ))
-        {
-            char name[32];
-            char mac_str[18];
-            uint8_t copy_len = ( field_data_len < ( sizeof( name ) - 1 )) ? field_data_len : ( sizeof( name ) - 1 );
-
-            for( uint8_t i = 0; i < copy_len; i++ )
-            {
-                name[i] = (( field_data[i] >= 32 ) && ( field_data[i] <= 126 )) ? (char) field_data[i] : '.';
-            }
-            name[copy_len] = '\0';
-
-            ble_mac_to_hex( mac, mac_str, sizeof( mac_str ));
-            LOG_BLE( "local name mac=%s name=%s rssi=%d dBm type=0x%02X\n",
-                     mac_str, name, rssi, field_type );
-            s_ble_name_logs++;
-            return;
-        }
-
-        offset += field_len + 1;
-    }
-}
-
-static void ble_uuid_to_hex( const uint8_t *uuid, char *out, uint8_t out_len )
-{
-    if(( uuid == NULL ) || ( out == NULL ) || ( out_len < 33 ))
-    {
-        return;
-    }
-
-    for( uint8_t i = 0; i < 16; i++ )
-    {
-        snprintf( out + ( i * 2 ), out_len - ( i * 2 ), "%02X", uuid[i] );
-    }
-    out[32] = '\0';
-}
-
-static void ble_mac_to_hex( const uint8_t *mac, char *out, uint8_t out_len )
-{
-    if(( mac == NULL ) || ( out == NULL ) || ( out_len < 18 ))
-    {
-        return;
-    }
-
-    snprintf( out, out_len, "%02X:%02X:%02X:%02X:%02X:%02X",
-              mac[5], mac[4], mac[3], mac[2], mac[1], mac[0] );
-}
-
-static bool beacon_uuid_approved( const uint8_t *uuid )
-{
-    bool have_whitelist = false;
-
-#if CREW_DR_BLE_UUID_WHITELIST_ENABLE
-    for( uint8_t i = 0; i < CREW_DR_BLE_UUID_WHITELIST_COUNT; i++ )
-    {
-        have_whitelist = true;
-        if( memcmp( uuid, CREW_DR_BLE_UUID_WHITELIST[i], 16 ) == 0 )
-        {
-            return true;
-        }
-    }
-#endif
-
-    /*
-     * The config app field is now an extra approved UUID, not the only filter.
-     * Require a full 16-byte UUID here so a short/prefix value cannot accidentally approve unrelated beacons.
-     */
-    if( ble_uuid_filter_num == 16 )
-    {
-        have_whitelist = true;
-        if( memcmp( uuid, ble_uuid_filter_array, 16 ) == 0 )
-        {
-            return true;
-        }
-    }
-
-    return have_whitelist == false;
-}
-
 bool ble_scan_start( void )
 {
     ret_code_t err_code;
 
-    for( uint8_t i = 0; i < BLE_BEACON_BUF_MAX; i++ )
-    {
-        memset(( uint8_t *)( &ble_beacon_buf[i] ), 0, sizeof( BleBeacons_t ));    
-    }
-    ble_beacon_res_num = 0;
-    s_ble_adv_reports = 0;
-    s_ble_ibeacon_seen = 0;
-    s_ble_approved_reports = 0;
-    s_ble_rejected_uuid_logs = 0;
-    s_ble_name_logs = 0;
+    app_ble_beacon_scan_reset( );
 
     err_code = nrf_ble_scan_params_set( &m_scan, &m_scan_param );
     APP_ERROR_CHECK( err_code );
@@ -790,225 +523,11 @@ bool ble_scan_start( void )
     return true;
 }
 
-bool ble_get_results( uint8_t *result, uint8_t *size )
-{
-    uint8_t beacon_num = 0;
-    int8_t rssi_max_index = 0;
-
-    if( result && size )
-    {
-        *size = 0;
-        if( ble_beacon_res_num == 0 ) return false;
-        
-        for( uint8_t i = 0; i < ble_beacon_res_num; i++ )
-        {
-            ble_beacon_rssi_array[i] = i;
-        }
-
-        for( uint8_t i = 0; i < ble_beacon_res_num; i++ )
-        {
-            for( uint8_t j = i; j < ble_beacon_res_num; j++ )
-            {
-                if( ble_beacon_buf[ble_beacon_rssi_array[i]].rssi_ < ble_beacon_buf[ble_beacon_rssi_array[j]].rssi_ )
-                {
-                    rssi_max_index = ble_beacon_rssi_array[i];
-                    ble_beacon_rssi_array[i] = ble_beacon_rssi_array[j];
-                    ble_beacon_rssi_array[j] = rssi_max_index;
-                }
-            }
-        }
-
-        if( ble_beacon_res_num > BLE_BEACON_SEND_MUM )
-        {
-            beacon_num = BLE_BEACON_SEND_MUM;
-        }
-        else
-        {
-            beacon_num = ble_beacon_res_num;
-        }
-
-        for( uint8_t i = 0; i < beacon_num; i ++ )
-        {
-            uint8_t* record = result + ( i * BLE_BEACON_UPLINK_RECORD_LEN );
-
-            // Custom crew-tag BLE uplinks carry iBeacon identity, not the BLE MAC:
-            // Major is the beacon identifier, Minor is the installer DR hint, RSSI is signed dBm.
-            memcpy( record, ( uint8_t *)( &ble_beacon_buf[ble_beacon_rssi_array[i]].major ), 2 );
-            memcpy( record + 2, ( uint8_t *)( &ble_beacon_buf[ble_beacon_rssi_array[i]].minor ), 2 );
-            memcpy( record + 4, &ble_beacon_buf[ble_beacon_rssi_array[i]].rssi_, 1 );
-            *size += BLE_BEACON_UPLINK_RECORD_LEN;
-        }
-
-        // if( beacon_num < BLE_BEACON_SEND_MUM )
-        // {
-        //     for( uint8_t i = 0; i < ( BLE_BEACON_SEND_MUM - beacon_num ); i++ )
-        //     {
-        //         memset( result + beacon_num * BLE_BEACON_UPLINK_RECORD_LEN + i * BLE_BEACON_UPLINK_RECORD_LEN,
-        //                 0xff, BLE_BEACON_UPLINK_RECORD_LEN );
-        //         *size += 7;
-        //     }
-        // }
-        
-        if( beacon_num ) return true;
-        else return false;
-    }
-    return false;
-}
-
-static bool ble_have_approved_uuid_source( void )
-{
-    bool have_approved_uuid_source = false;
-
-    /*
-     * DR hints must come from an explicitly approved UUID source. That source can be the build-time
-     * whitelist or the config app's extra UUID. Do not require the app UUID when the default whitelist
-     * has already approved the beacon; otherwise production beacons would be logged but ignored.
-     */
-#if CREW_DR_BLE_UUID_WHITELIST_ENABLE
-    have_approved_uuid_source = ( CREW_DR_BLE_UUID_WHITELIST_COUNT > 0 );
-#endif
-    have_approved_uuid_source = have_approved_uuid_source || ( ble_uuid_filter_num == 16 );
-    return have_approved_uuid_source;
-}
-
-static void ble_copy_hint_from_index( ble_beacon_hint_t *hint, uint8_t index )
-{
-    memset( hint, 0, sizeof( *hint ));
-    memcpy( hint->uuid, ble_beacon_buf[index].uuid, sizeof( hint->uuid ));
-    memcpyr(( uint8_t *)( &hint->major ), ( uint8_t *)( &ble_beacon_buf[index].major ), 2 );
-    memcpyr(( uint8_t *)( &hint->minor ), ( uint8_t *)( &ble_beacon_buf[index].minor ), 2 );
-    memcpy( hint->mac, ble_beacon_buf[index].mac, sizeof( hint->mac ));
-    hint->rssi = ble_beacon_buf[index].rssi_;
-}
-
-bool ble_get_strongest_approved_beacon( ble_beacon_hint_t *hint )
-{
-    int8_t best_rssi = -128;
-    int8_t best_index = -1;
-
-    if( hint == NULL )
-    {
-        return false;
-    }
-
-    if( ble_have_approved_uuid_source( ) == false )
-    {
-        LOG_BLE( "BLE movement hint: disabled because no approved UUID source is configured\n" );
-        return false;
-    }
-
-    for( uint8_t i = 0; i < ble_beacon_res_num; i++ )
-    {
-        if(( best_index < 0 ) || ( ble_beacon_buf[i].rssi_ > best_rssi ))
-        {
-            best_index = i;
-            best_rssi = ble_beacon_buf[i].rssi_;
-        }
-    }
-
-    if( best_index < 0 )
-    {
-        return false;
-    }
-
-    ble_copy_hint_from_index( hint, best_index );
-
-    char uuid_str[33];
-    char mac_str[18];
-    ble_uuid_to_hex( hint->uuid, uuid_str, sizeof( uuid_str ));
-    ble_mac_to_hex( hint->mac, mac_str, sizeof( mac_str ));
-    LOG_BLE( "Movement hint: strongest approved UUID=%s major=%u minor=%u rssi=%d dBm mac=%s\n",
-             uuid_str, hint->major, hint->minor, hint->rssi, mac_str );
-
-    return true;
-}
-
-bool ble_get_strongest_hint( ble_beacon_hint_t *hint )
-{
-    int8_t best_rssi = -128;
-    int8_t best_index = -1;
-    uint8_t invalid_minor_count = 0;
-
-    if( hint == NULL )
-    {
-        return false;
-    }
-
-    if( ble_have_approved_uuid_source( ) == false )
-    {
-        LOG_BLE( "DR hint: disabled because no approved UUID source is configured\n" );
-        return false;
-    }
-
-    /*
-     * The scanner has already applied the approved UUID filter. For DR hints, only accept explicit
-     * commissioning values 1..5 and ignore factory/default Minors such as 19641.
-     */
-    for( uint8_t i = 0; i < ble_beacon_res_num; i++ )
-    {
-        uint16_t minor = 0;
-        memcpyr(( uint8_t *)( &minor ), ( uint8_t *)( &ble_beacon_buf[i].minor ), 2 );
-
-        if(( minor < 1 ) || ( minor > 5 ))
-        {
-            invalid_minor_count++;
-            continue;
-        }
-
-        if(( best_index < 0 ) || ( ble_beacon_buf[i].rssi_ > best_rssi ))
-        {
-            best_index = i;
-            best_rssi = ble_beacon_buf[i].rssi_;
-        }
-    }
-
-    if( best_index < 0 )
-    {
-        LOG_BLE( "DR hint: no usable Minor 1..5 found among %u approved beacon(s), invalid_minor=%u\n",
-                 ble_beacon_res_num, invalid_minor_count );
-        return false;
-    }
-
-    ble_copy_hint_from_index( hint, best_index );
-
-    char uuid_str[33];
-    char mac_str[18];
-    ble_uuid_to_hex( hint->uuid, uuid_str, sizeof( uuid_str ));
-    ble_mac_to_hex( hint->mac, mac_str, sizeof( mac_str ));
-    LOG_BLE( "DR hint: strongest UUID=%s major=%u minor=%u rssi=%d dBm mac=%s\n",
-             uuid_str, hint->major, hint->minor, hint->rssi, mac_str );
-
-    return true;
-}
-
 void ble_scan_stop( void )
 {
     nrf_ble_scan_stop( );
     s_ble_scanning = false;
-    LOG_BLE( "scan STOP adv_reports=%u iBeacon_reports=%u approved_reports=%u unique_approved=%u rejected_uuid_logs=%u name_logs=%u\n",
-             s_ble_adv_reports, s_ble_ibeacon_seen, s_ble_approved_reports, ble_beacon_res_num,
-             s_ble_rejected_uuid_logs, s_ble_name_logs );
-}
-
-void ble_display_results( void )
-{
-    LOG_BLE( "iBeacon unique approved: %d\r\n", ble_beacon_res_num );
-    for( uint8_t i = 0; i < ble_beacon_res_num; i ++ )
-    {
-        uint16_t major = 0, minor = 0;
-        char uuid_str[33];
-        char mac_str[18];
-        memcpyr(( uint8_t *)( &major ), ( uint8_t *)( &ble_beacon_buf[ble_beacon_rssi_array[i]].major ), 2 );
-        memcpyr(( uint8_t *)( &minor ), ( uint8_t *)( &ble_beacon_buf[ble_beacon_rssi_array[i]].minor ), 2 );
-        ble_uuid_to_hex( ble_beacon_buf[ble_beacon_rssi_array[i]].uuid, uuid_str, sizeof( uuid_str ));
-        ble_mac_to_hex( ble_beacon_buf[ble_beacon_rssi_array[i]].mac, mac_str, sizeof( mac_str ));
-        LOG_BLE( "  #%u company=0x%04x UUID=%s major=%u minor=%u tx=%d dBm rssi=%d dBm mac=%s\r\n",
-                 i + 1, ble_beacon_buf[ble_beacon_rssi_array[i]].company_id,
-                 uuid_str, major, minor,
-                 ble_beacon_buf[ble_beacon_rssi_array[i]].rssi,
-                 ble_beacon_buf[ble_beacon_rssi_array[i]].rssi_, mac_str );
-    }
-    LOG_BLE( "\n" );
+    app_ble_beacon_scan_done( );
 }
 
 bool ble_scan_is_active( void )
@@ -0,0 +1,673 @@
+/*!
+ * @file      app_ble_beacon.c
+ *
+ * @brief     iBeacon table filled from the BLE scanner advertising reports
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+#include "app_ble_beacon.h"
+#include "smtc_hal_mcu.h"
+#include "log_filter.h"
+#include "crew_dr_strategy_config.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define BEACON_DATA_LEN     0x15
+#define BEACON_DATA_TYPE    0x02
+#define COMPANY_IDENTIFIER  0x004C
+
+#define BLE_SCAN_DEBUG_REJECT_LOG_MAX 8
+#define BLE_SCAN_DEBUG_NAME_LOG_MAX 8
+#define BLE_AD_TYPE_FLAGS 0x01
+#define BLE_AD_TYPE_SHORT_LOCAL_NAME 0x08
+#define BLE_AD_TYPE_COMPLETE_LOCAL_NAME 0x09
+#define BLE_AD_TYPE_MANUFACTURER_SPECIFIC_DATA 0xFF
+#define BLE_BEACON_HASH_SIZE ( BLE_BEACON_BUF_MAX * 2 ) // power of two, load factor <= 0.5
+#define BLE_UUID_APPROVED_MAX ( CREW_DR_BLE_UUID_WHITELIST_COUNT + 1 ) // build-time whitelist + config app UUID
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**@brief Per-beacon RSSI aggregate, parallel to ble_beacon_buf.
+ *
+ * @details ble_beacon_buf[i].rssi_ holds the strongest report so existing consumers rank by max RSSI.
+ */
+typedef struct
+{
+    int32_t rssi_sum;
+    uint16_t count;
+    bool hint_minor;                                                                    /**< Minor is a commissioned DR hint 1..5 */
+} ble_beacon_stat_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+bool s_filter_flag = false;
+uint8_t ble_beacon_res_num = 0;
+BleBeacons_t ble_beacon_buf[BLE_BEACON_BUF_MAX] = { 0 };
+uint8_t ble_uuid_filter_array[16] = { 0 };
+uint8_t ble_uuid_filter_num = 0;
+
+static app_ble_beacon_stats_t s_ble_stats = { 0 };
+static ble_beacon_stat_t s_ble_beacon_stat[BLE_BEACON_BUF_MAX] = { 0 };
+static uint8_t s_ble_beacon_hash[BLE_BEACON_HASH_SIZE] = { 0 }; // index + 1 into ble_beacon_buf, 0 is empty
+
+// Ranking kept up to date as reports arrive. rssi_ only ever grows during a scan,
+// so an entry outside the top-K can only enter it on its own update.
+static uint8_t s_ble_top[BLE_BEACON_SEND_MUM] = { 0 };                                  /**< Indexes into ble_beacon_buf, strongest first */
+static uint8_t s_ble_top_num = 0;
+static int8_t s_ble_best_hint = -1;                                                     /**< Strongest beacon with Minor 1..5, -1 if none */
+
+// Approved UUID set, frozen at scan start so the report path does not walk the config
+static uint8_t s_ble_uuid_approved[BLE_UUID_APPROVED_MAX][16];
+static uint32_t s_ble_uuid_approved_prefix[BLE_UUID_APPROVED_MAX];
+static uint8_t s_ble_uuid_approved_num = 0;
+static bool s_ble_uuid_accept_all = true;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static void ble_beacon_report( const uint8_t *p_data, const uint8_t *mac, int8_t rssi );
+static void ble_beacon_rank_update( uint8_t index );
+static void ble_uuid_to_hex( const uint8_t *uuid, char *out, uint8_t out_len );
+static void ble_mac_to_hex( const uint8_t *mac, char *out, uint8_t out_len );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static const uint8_t* ble_find_ibeacon_payload( const uint8_t* adv_data, uint16_t adv_len )
+{
+    uint16_t offset = 0;
+
+    // Fast path for the canonical iBeacon layout: Flags (3 bytes) then the 0x1A-long Apple manufacturer field
+    if(( adv_len >= 30 ) && ( adv_data[0] == 0x02 ) && ( adv_data[1] == BLE_AD_TYPE_FLAGS ) &&
+       ( adv_data[3] == 0x1A ) && ( adv_data[4] == BLE_AD_TYPE_MANUFACTURER_SPECIFIC_DATA ) &&
+       ( adv_data[5] == ( COMPANY_IDENTIFIER & 0xFF )) && ( adv_data[6] == ( COMPANY_IDENTIFIER >> 8 )) &&
+       ( adv_data[7] == BEACON_DATA_TYPE ) && ( adv_data[8] == BEACON_DATA_LEN ))
+    {
+        return &adv_data[5];
+    }
+
+    while( offset < adv_len )
+    {
+        uint8_t field_len = adv_data[offset];
+
+        if( field_len == 0 )
+        {
+            break;
+        }
+
+        if(( offset + field_len ) >= adv_len )
+        {
+            break;
+        }
+
+        uint8_t field_type = adv_data[offset + 1];
+        const uint8_t* field_data = &adv_data[offset + 2];
+        uint8_t field_data_len = field_len - 1;
+
+        if(( field_type == BLE_AD_TYPE_MANUFACTURER_SPECIFIC_DATA ) &&
+           ( field_data_len >= ( 2 + 2 + BEACON_DATA_LEN )))
+        {
+            uint16_t company_identifier = 0;
+            memcpy(( uint8_t* )( &company_identifier ), field_data, 2 );
+
+            if(( company_identifier == COMPANY_IDENTIFIER ) &&
+               ( field_data[2] == BEACON_DATA_TYPE ) &&
+               ( field_data[3] == BEACON_DATA_LEN ))
+            {
+                return field_data;
+            }
+        }
+
+        offset += field_len + 1;
+    }
+
+    return NULL;
+}
+
+static void ble_log_local_name_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi )
+{
+    uint16_t offset = 0;
+
+    if( s_ble_stats.name_logs >= BLE_SCAN_DEBUG_NAME_LOG_MAX )
+    {
+        return;
+    }
+
+    while( offset < adv_len )
+    {
+        uint8_t field_len = adv_data[offset];
+
+        if( field_len == 0 )
+        {
+            break;
+        }
+
+        if(( offset + field_len ) >= adv_len )
+        {
+            break;
+        }
+
+        uint8_t field_type = adv_data[offset + 1];
+        const uint8_t* field_data = &adv_data[offset + 2];
+        uint8_t field_data_len = field_len - 1;
+
+        if((( field_type == BLE_AD_TYPE_SHORT_LOCAL_NAME ) || ( field_type == BLE_AD_TYPE_COMPLETE_LOCAL_NAME )) &&
+           ( field_data_len > 0 ))
+        {
+            char name[32];
+            char mac_str[18];
+            uint8_t copy_len = ( field_data_len < ( sizeof( name ) - 1 )) ? field_data_len : ( sizeof( name ) - 1 );
+
+            for( uint8_t i = 0; i < copy_len; i++ )
+            {
+                name[i] = (( field_data[i] >= 32 ) && ( field_data[i] <= 126 )) ? (char) field_data[i] : '.';
+            }
+            name[copy_len] = '\0';
+
+            ble_mac_to_hex( mac, mac_str, sizeof( mac_str ));
+            LOG_BLE( "local name mac=%s name=%s rssi=%d dBm type=0x%02X\n",
+                     mac_str, name, rssi, field_type );
+            s_ble_stats.name_logs++;
+            return;
+        }
+
+        offset += field_len + 1;
+    }
+}
+
+static const char ble_hex_digits[] = "0123456789ABCDEF";
+
+static void ble_uuid_to_hex( const uint8_t *uuid, char *out, uint8_t out_len )
+{
+    if(( uuid == NULL ) || ( out == NULL ) || ( out_len < 33 ))
+    {
+        return;
+    }
+
+    // Scan callback path, a nibble lookup instead of 16 snprintf calls
+    for( uint8_t i = 0; i < 16; i++ )
+    {
+        out[i * 2] = ble_hex_digits[uuid[i] >> 4];
+        out[i * 2 + 1] = ble_hex_digits[uuid[i] & 0x0F];
+    }
+    out[32] = '\0';
+}
+
+static void ble_mac_to_hex( const uint8_t *mac, char *out, uint8_t out_len )
+{
+    if(( mac == NULL ) || ( out == NULL ) || ( out_len < 18 ))
+    {
+        return;
+    }
+
+    // Most significant byte first, "AA:BB:CC:DD:EE:FF"
+    for( uint8_t i = 0; i < 6; i++ )
+    {
+        out[i * 3] = ble_hex_digits[mac[5 - i] >> 4];
+        out[i * 3 + 1] = ble_hex_digits[mac[5 - i] & 0x0F];
+        out[i * 3 + 2] = ( i < 5 ) ? ':' : '\0';
+    }
+}
+
+static uint32_t ble_uuid_prefix( const uint8_t *uuid )
+{
+    return (( uint32_t ) uuid[0] << 24 ) | (( uint32_t ) uuid[1] << 16 ) | (( uint32_t ) uuid[2] << 8 ) | uuid[3];
+}
+
+static void beacon_uuid_approved_add( const uint8_t *uuid )
+{
+    for( uint8_t i = 0; i < s_ble_uuid_approved_num; i++ )
+    {
+        if( memcmp( s_ble_uuid_approved[i], uuid, 16 ) == 0 )
+        {
+            return;
+        }
+    }
+    memcpy( s_ble_uuid_approved[s_ble_uuid_approved_num], uuid, 16 );
+    s_ble_uuid_approved_prefix[s_ble_uuid_approved_num] = ble_uuid_prefix( uuid );
+    s_ble_uuid_approved_num++;
+}
+
+/**@brief Freeze the approved UUID set for the coming scan.
+ *
+ * @details Called from ble_scan_start, the report path then compares against at most
+ *          BLE_UUID_APPROVED_MAX entries, rejecting on the first 4 bytes in the common case.
+ */
+static void beacon_uuid_approved_build( void )
+{
+    bool have_whitelist = false;
+
+    s_ble_uuid_approved_num = 0;
+
+#if CREW_DR_BLE_UUID_WHITELIST_ENABLE
+    for( uint8_t i = 0; i < CREW_DR_BLE_UUID_WHITELIST_COUNT; i++ )
+    {
+        have_whitelist = true;
+        beacon_uuid_approved_add( CREW_DR_BLE_UUID_WHITELIST[i] );
+    }
+#endif
+
+    /*
+     * The config app field is now an extra approved UUID, not the only filter.
+     * Require a full 16-byte UUID here so a short/prefix value cannot accidentally approve unrelated beacons.
+     */
+    if( ble_uuid_filter_num == 16 )
+    {
+        have_whitelist = true;
+        beacon_uuid_approved_add( ble_uuid_filter_array );
+    }
+
+    s_ble_uuid_accept_all = ( have_whitelist == false );
+}
+
+static bool beacon_uuid_approved( const uint8_t *uuid )
+{
+    uint32_t prefix = 0;
+
+    if( s_ble_uuid_accept_all )
+    {
+        return true;
+    }
+
+    prefix = ble_uuid_prefix( uuid );
+    for( uint8_t i = 0; i < s_ble_uuid_approved_num; i++ )
+    {
+        if(( s_ble_uuid_approved_prefix[i] == prefix ) && ( memcmp( uuid + 4, s_ble_uuid_approved[i] + 4, 12 ) == 0 ))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint8_t ble_beacon_hash_key( const uint8_t *p_data, const uint8_t *mac )
+{
+    // FNV-1a over MAC, major and minor (raw byte order)
+    uint32_t h = 2166136261u;
+
+    for( uint8_t i = 0; i < 6; i++ )
+    {
+        h = ( h ^ mac[i] ) * 16777619u;
+    }
+    for( uint8_t i = 20; i < 24; i++ )
+    {
+        h = ( h ^ p_data[i] ) * 16777619u;
+    }
+
+    return ( uint8_t )(( h ^ ( h >> 16 )) & ( BLE_BEACON_HASH_SIZE - 1 ));
+}
+
+/**@brief Fold one approved iBeacon report into the scan table.
+ *
+ * @details Open addressing with linear probing keyed by MAC + major + minor. The table never
+ *          holds more than BLE_BEACON_BUF_MAX entries, so a probe always ends on an empty slot.
+ *
+ * @param[in] p_data iBeacon manufacturer data (company id first)
+ * @param[in] mac    Advertiser address
+ * @param[in] rssi   Measured RSSI of this report
+ */
+static void ble_beacon_report( const uint8_t *p_data, const uint8_t *mac, int8_t rssi )
+{
+    uint8_t slot = ble_beacon_hash_key( p_data, mac );
+    uint8_t index = 0;
+
+    while( s_ble_beacon_hash[slot] != 0 )
+    {
+        index = s_ble_beacon_hash[slot] - 1;
+        BleBeacons_t *beacon = &ble_beacon_buf[index];
+
+        if(( memcmp( beacon->mac, mac, 6 ) == 0 ) &&
+           ( memcmp(( uint8_t *)( &beacon->major ), p_data + 20, 2 ) == 0 ) &&
+           ( memcmp(( uint8_t *)( &beacon->minor ), p_data + 22, 2 ) == 0 ) &&
+           ( memcmp( beacon->uuid, p_data + 4, 16 ) == 0 ))
+        {
+            s_ble_beacon_stat[index].rssi_sum += rssi;
+            if( s_ble_beacon_stat[index].count < UINT16_MAX )
+            {
+                s_ble_beacon_stat[index].count++;
+            }
+            if( rssi > beacon->rssi_ )
+            {
+                beacon->rssi_ = rssi;
+                ble_beacon_rank_update( index );
+            }
+            return;
+        }
+        slot = ( slot + 1 ) & ( BLE_BEACON_HASH_SIZE - 1 );
+    }
+
+    if( ble_beacon_res_num >= BLE_BEACON_BUF_MAX )
+    {
+        s_ble_stats.full_drops++;
+        return;
+    }
+
+    index = ble_beacon_res_num;
+    BleBeacons_t *beacon = &ble_beacon_buf[index];
+
+    beacon->company_id = COMPANY_IDENTIFIER;
+    memcpy( beacon->uuid, p_data + 4, 16 );
+    memcpy(( uint8_t *)( &beacon->major ), p_data + 20, 2 );
+    memcpy(( uint8_t *)( &beacon->minor ), p_data + 22, 2 );
+    memcpy(( uint8_t *)( &beacon->rssi ), p_data + 24, 1 );
+    beacon->rssi_ = rssi;
+    memcpy( beacon->mac, mac, 6 );
+    s_ble_beacon_stat[index].rssi_sum = rssi;
+    s_ble_beacon_stat[index].count = 1;
+    s_ble_beacon_hash[slot] = index + 1;
+
+    uint16_t major = 0, minor = 0;
+    char uuid_str[33];
+    char mac_str[18];
+    memcpyr(( uint8_t *)( &major ), ( uint8_t *)( &beacon->major ), 2 );
+    memcpyr(( uint8_t *)( &minor ), ( uint8_t *)( &beacon->minor ), 2 );
+    s_ble_beacon_stat[index].hint_minor = ( minor >= 1 ) && ( minor <= 5 );
+    if( s_ble_beacon_stat[index].hint_minor == false )
+    {
+        s_ble_stats.invalid_minor++;
+    }
+    ble_beacon_rank_update( index );
+    ble_uuid_to_hex( beacon->uuid, uuid_str, sizeof( uuid_str ));
+    ble_mac_to_hex( beacon->mac, mac_str, sizeof( mac_str ));
+    LOG_BLE( "iBeacon approved #%u UUID=%s major=%u minor=%u tx=%d dBm rssi=%d dBm mac=%s\n",
+             index + 1, uuid_str, major, minor, beacon->rssi, beacon->rssi_, mac_str );
+    ble_beacon_res_num++;
+}
+
+/**@brief Re-rank one beacon after it was added or its max RSSI rose.
+ *
+ * @details O(BLE_BEACON_SEND_MUM): ties keep the beacon that reached the value first.
+ *
+ * @param[in] index Index into ble_beacon_buf
+ */
+static void ble_beacon_rank_update( uint8_t index )
+{
+    int8_t rssi = ble_beacon_buf[index].rssi_;
+    uint8_t pos = 0;
+
+    if( s_ble_beacon_stat[index].hint_minor &&
+        (( s_ble_best_hint < 0 ) || ( rssi > ble_beacon_buf[s_ble_best_hint].rssi_ )))
+    {
+        s_ble_best_hint = index;
+    }
+
+    while(( pos < s_ble_top_num ) && ( s_ble_top[pos] != index ))
+    {
+        pos++;
+    }
+    if( pos == s_ble_top_num )
+    {
+        if( s_ble_top_num < BLE_BEACON_SEND_MUM )
+        {
+            s_ble_top_num++;
+        }
+        else if( rssi > ble_beacon_buf[s_ble_top[BLE_BEACON_SEND_MUM - 1]].rssi_ )
+        {
+            pos = BLE_BEACON_SEND_MUM - 1;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    while(( pos > 0 ) && ( ble_beacon_buf[s_ble_top[pos - 1]].rssi_ < rssi ))
+    {
+        s_ble_top[pos] = s_ble_top[pos - 1];
+        pos--;
+    }
+    s_ble_top[pos] = index;
+}
+
+static bool ble_have_approved_uuid_source( void )
+{
+    bool have_approved_uuid_source = false;
+
+    /*
+     * DR hints must come from an explicitly approved UUID source. That source can be the build-time
+     * whitelist or the config app's extra UUID. Do not require the app UUID when the default whitelist
+     * has already approved the beacon; otherwise production beacons would be logged but ignored.
+     */
+#if CREW_DR_BLE_UUID_WHITELIST_ENABLE
+    have_approved_uuid_source = ( CREW_DR_BLE_UUID_WHITELIST_COUNT > 0 );
+#endif
+    have_approved_uuid_source = have_approved_uuid_source || ( ble_uuid_filter_num == 16 );
+    return have_approved_uuid_source;
+}
+
+static void ble_copy_hint_from_index( ble_beacon_hint_t *hint, uint8_t index )
+{
+    memset( hint, 0, sizeof( *hint ));
+    memcpy( hint->uuid, ble_beacon_buf[index].uuid, sizeof( hint->uuid ));
+    memcpyr(( uint8_t *)( &hint->major ), ( uint8_t *)( &ble_beacon_buf[index].major ), 2 );
+    memcpyr(( uint8_t *)( &hint->minor ), ( uint8_t *)( &ble_beacon_buf[index].minor ), 2 );
+    memcpy( hint->mac, ble_beacon_buf[index].mac, sizeof( hint->mac ));
+    hint->rssi = ble_beacon_buf[index].rssi_;
+}
+
+static void ble_display_beacon( uint8_t rank, uint8_t index )
+{
+    const BleBeacons_t *beacon = &ble_beacon_buf[index];
+    const ble_beacon_stat_t *stat = &s_ble_beacon_stat[index];
+    uint16_t major = 0, minor = 0;
+    char uuid_str[33];
+    char mac_str[18];
+
+    memcpyr(( uint8_t *)( &major ), ( uint8_t *)( &beacon->major ), 2 );
+    memcpyr(( uint8_t *)( &minor ), ( uint8_t *)( &beacon->minor ), 2 );
+    ble_uuid_to_hex( beacon->uuid, uuid_str, sizeof( uuid_str ));
+    ble_mac_to_hex( beacon->mac, mac_str, sizeof( mac_str ));
+    LOG_BLE( "  #%u company=0x%04x UUID=%s major=%u minor=%u tx=%d dBm rssi max=%d mean=%d dBm n=%u mac=%s\r\n",
+             rank, beacon->company_id, uuid_str, major, minor, beacon->rssi, beacon->rssi_,
+             ( int )( stat->count ? stat->rssi_sum / stat->count : 0 ), stat->count, mac_str );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void app_ble_beacon_scan_reset( void )
+{
+    for( uint8_t i = 0; i < BLE_BEACON_BUF_MAX; i++ )
+    {
+        memset(( uint8_t *)( &ble_beacon_buf[i] ), 0, sizeof( BleBeacons_t ));
+    }
+    memset( s_ble_beacon_stat, 0, sizeof( s_ble_beacon_stat ));
+    memset( s_ble_beacon_hash, 0, sizeof( s_ble_beacon_hash ));
+    memset( &s_ble_stats, 0, sizeof( s_ble_stats ));
+    s_ble_top_num = 0;
+    s_ble_best_hint = -1;
+    beacon_uuid_approved_build( );
+    ble_beacon_res_num = 0;
+}
+
+void app_ble_beacon_adv_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi )
+{
+    const uint8_t *p_data = NULL;
+
+    s_ble_stats.adv_reports++;
+    if( s_ble_stats.name_logs < BLE_SCAN_DEBUG_NAME_LOG_MAX )
+    {
+        ble_log_local_name_report( adv_data, adv_len, mac, rssi );
+    }
+    p_data = ble_find_ibeacon_payload( adv_data, adv_len );
+    if( p_data == NULL )
+    {
+        return;
+    }
+    s_filter_flag = true;
+    s_ble_stats.ibeacon_reports++;
+
+    if( beacon_uuid_approved( p_data + 4 ) == false )
+    {
+        if( s_ble_stats.rejected_uuid_logs < BLE_SCAN_DEBUG_REJECT_LOG_MAX )
+        {
+            char uuid_str[33];
+            char mac_str[18];
+            ble_uuid_to_hex( p_data + 4, uuid_str, sizeof( uuid_str ));
+            ble_mac_to_hex( mac, mac_str, sizeof( mac_str ));
+            LOG_BLE( "iBeacon rejected UUID=%s mac=%s rssi=%d dBm\n",
+                     uuid_str, mac_str, rssi );
+            s_ble_stats.rejected_uuid_logs++;
+        }
+        return;
+    }
+
+    s_ble_stats.approved_reports++;
+    ble_beacon_report( p_data, mac, rssi );
+}
+
+void app_ble_beacon_scan_done( void )
+{
+    LOG_BLE( "scan STOP adv_reports=%u iBeacon_reports=%u approved_reports=%u unique_approved=%u full_drops=%u rejected_uuid_logs=%u name_logs=%u\n",
+             s_ble_stats.adv_reports, s_ble_stats.ibeacon_reports, s_ble_stats.approved_reports, ble_beacon_res_num,
+             s_ble_stats.full_drops, s_ble_stats.rejected_uuid_logs, s_ble_stats.name_logs );
+}
+
+void app_ble_beacon_get_stats( app_ble_beacon_stats_t* stats )
+{
+    *stats = s_ble_stats;
+    stats->unique_approved = ble_beacon_res_num;
+}
+
+bool ble_get_results( uint8_t *result, uint8_t *size )
+{
+    if( result && size )
+    {
+        *size = 0;
+
+        // s_ble_top is already ranked by max RSSI, nothing left to sort at scan end
+        for( uint8_t i = 0; i < s_ble_top_num; i ++ )
+        {
+            uint8_t* record = result + ( i * BLE_BEACON_UPLINK_RECORD_LEN );
+            const BleBeacons_t* beacon = &ble_beacon_buf[s_ble_top[i]];
+
+            // Custom crew-tag BLE uplinks carry iBeacon identity, not the BLE MAC:
+            // Major is the beacon identifier, Minor is the installer DR hint, RSSI is signed dBm.
+            memcpy( record, ( uint8_t *)( &beacon->major ), 2 );
+            memcpy( record + 2, ( uint8_t *)( &beacon->minor ), 2 );
+            memcpy( record + 4, &beacon->rssi_, 1 );
+            *size += BLE_BEACON_UPLINK_RECORD_LEN;
+        }
+
+        if( s_ble_top_num ) return true;
+        else return false;
+    }
+    return false;
+}
+
+bool ble_get_strongest_approved_beacon( ble_beacon_hint_t *hint )
+{
+    if( hint == NULL )
+    {
+        return false;
+    }
+
+    if( ble_have_approved_uuid_source( ) == false )
+    {
+        LOG_BLE( "BLE movement hint: disabled because no approved UUID source is configured\n" );
+        return false;
+    }
+
+    // Every buffered beacon passed the approved UUID filter, the strongest one heads the ranking
+    if( s_ble_top_num == 0 )
+    {
+        return false;
+    }
+
+    ble_copy_hint_from_index( hint, s_ble_top[0] );
+
+    char uuid_str[33];
+    char mac_str[18];
+    ble_uuid_to_hex( hint->uuid, uuid_str, sizeof( uuid_str ));
+    ble_mac_to_hex( hint->mac, mac_str, sizeof( mac_str ));
+    LOG_BLE( "Movement hint: strongest approved UUID=%s major=%u minor=%u rssi=%d dBm mac=%s\n",
+             uuid_str, hint->major, hint->minor, hint->rssi, mac_str );
+
+    return true;
+}
+
+bool ble_get_strongest_hint( ble_beacon_hint_t *hint )
+{
+    if( hint == NULL )
+    {
+        return false;
+    }
+
+    if( ble_have_approved_uuid_source( ) == false )
+    {
+        LOG_BLE( "DR hint: disabled because no approved UUID source is configured\n" );
+        return false;
+    }
+
+    /*
+     * The scanner has already applied the approved UUID filter. For DR hints, only accept explicit
+     * commissioning values 1..5 and ignore factory/default Minors such as 19641.
+     * Both are tracked per report in ble_beacon_rank_update.
+     */
+    if( s_ble_best_hint < 0 )
+    {
+        LOG_BLE( "DR hint: no usable Minor 1..5 found among %u approved beacon(s), invalid_minor=%u\n",
+                 ble_beacon_res_num, s_ble_stats.invalid_minor );
+        return false;
+    }
+
+    ble_copy_hint_from_index( hint, s_ble_best_hint );
+
+    char uuid_str[33];
+    char mac_str[18];
+    ble_uuid_to_hex( hint->uuid, uuid_str, sizeof( uuid_str ));
+    ble_mac_to_hex( hint->mac, mac_str, sizeof( mac_str ));
+    LOG_BLE( "DR hint: strongest UUID=%s major=%u minor=%u rssi=%d dBm mac=%s\n",
+             uuid_str, hint->major, hint->minor, hint->rssi, mac_str );
+
+    return true;
+}
+
+void ble_display_results( void )
+{
+    uint8_t rank = 0;
+
+    LOG_BLE( "iBeacon unique approved: %d\r\n", ble_beacon_res_num );
+
+    // Ranked top-K first, then the rest in arrival order
+    for( uint8_t i = 0; i < s_ble_top_num; i ++ )
+    {
+        ble_display_beacon( ++rank, s_ble_top[i] );
+    }
+    for( uint8_t i = 0; i < ble_beacon_res_num; i ++ )
+    {
+        bool ranked = false;
+        for( uint8_t j = 0; j < s_ble_top_num; j ++ )
+        {
+            ranked = ranked || ( s_ble_top[j] == i );
+        }
+        if( ranked == false )
+        {
+            ble_display_beacon( ++rank, i );
+        }
+    }
+    LOG_BLE( "\n" );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
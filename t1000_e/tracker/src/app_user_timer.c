@@ -11,6 +11,7 @@
 #include "app_at.h"
 #include "app_at_command.h"
 #include "app_button.h"
+#include "ag3335.h"
 
 APP_TIMER_DEF(m_parse_cmd_timer_id);
 
@@ -61,4 +62,5 @@ void app_user_run_process( void )
 {
     app_user_parse_cmd( );
     app_user_button_det( );
+    gnss_nmea_process( );
 }
\ No newline at end of file
@@ -0,0 +1,549 @@
+/*!
+ * @file      crew_store_forward.c
+ *
+ * @brief     Flash-backed store-and-forward queue for uplinks that could not go out
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "crew_store_forward.h"
+#include "crew_payload_schema.h"
+#include "crew_lorawan_ports.h"
+#include "smtc_hal_def.h"
+#include "smtc_hal_flash.h"
+#include "log_filter.h"
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define STORE_TRACE_INFO(...)       LOG_LORA(__VA_ARGS__)
+
+#define CREW_STORE_PAGES            ADDR_FLASH_STORE_FORWARD_PAGES
+#define CREW_STORE_PAGE_MAGIC       0x52575346UL    // "FSWR"
+#define CREW_STORE_COMMIT           0x544D4F43UL    // "COMT"
+#define CREW_STORE_ERASED           0xFFFFFFFFUL
+#define CREW_STORE_SLOTS_PER_PAGE   (( ADDR_FLASH_PAGE_SIZE - sizeof( crew_store_page_header_t )) / \
+                                     sizeof( crew_store_slot_t ))
+#define CREW_STORE_SLOT_BODY_SIZE   offsetof( crew_store_slot_t, commit )
+#define CREW_STORE_FLAG_SAFETY      0x01
+#define CREW_STORE_PORT_NUM         ( CREW_RF_FINGERPRINT_PORT - CREW_ROUTINE_APP_PORT + 1 )
+
+// A repeat of a port's last record within this time is the same uplink sent again (MOB double uplink)
+#ifndef CREW_STORE_REPEAT_WINDOW_S
+#define CREW_STORE_REPEAT_WINDOW_S  30
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+// Page header, commit written last once the page is erased and numbered
+typedef struct {
+    uint32_t magic;
+    uint32_t page_seq;          // Increases each time a page is opened, the highest is the head
+    uint32_t erase_count;
+    uint32_t commit;
+} crew_store_page_header_t;
+
+// One record, 48 bytes. The body is written first, then commit, then sent once uplinked.
+typedef struct {
+    uint32_t seq;
+    uint32_t timestamp_s;
+    uint8_t  port;
+    uint8_t  len;
+    uint8_t  flags;
+    uint8_t  crc;               // CRC-8 of the body with this byte at 0
+    uint8_t  data[CREW_STORE_RECORD_MAX_LEN];
+    uint32_t commit;
+    uint32_t sent;              // CREW_STORE_ERASED until sent, then 0
+} crew_store_slot_t;
+
+typedef enum {
+    CREW_STORE_SLOT_FREE,
+    CREW_STORE_SLOT_TORN,
+    CREW_STORE_SLOT_PENDING,
+    CREW_STORE_SLOT_SENT,
+} crew_store_slot_state_t;
+
+typedef struct {
+    bool     mounted;
+    uint8_t  head_page;
+    uint16_t head_slot;         // Next free slot of the head page
+    uint32_t head_page_seq;
+    uint32_t next_seq;
+    uint16_t pending;
+    uint16_t pending_safety;
+    uint32_t dropped;
+    uint32_t torn;
+    uint32_t repeats;
+    uint32_t last_hash[CREW_STORE_PORT_NUM];        // Last record appended per port, 0 for none
+    uint32_t last_timestamp_s[CREW_STORE_PORT_NUM];
+    uint32_t erase_count[CREW_STORE_PAGES];
+    bool     page_valid[CREW_STORE_PAGES];
+} crew_store_state_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static crew_store_state_t store;
+static uint32_t store_batch_addr[CREW_STORE_BATCH_MAX];
+static uint32_t store_batch_seq[CREW_STORE_BATCH_MAX];    // Record seq of each slot, tells a reused slot apart
+static uint8_t store_batch_count = 0;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t crew_store_page_addr( uint8_t page )
+{
+    return ADDR_FLASH_STORE_FORWARD + ( uint32_t ) page * ADDR_FLASH_PAGE_SIZE;
+}
+
+static uint32_t crew_store_slot_addr( uint8_t page, uint16_t slot )
+{
+    return crew_store_page_addr( page ) + sizeof( crew_store_page_header_t ) + ( uint32_t ) slot * sizeof( crew_store_slot_t );
+}
+
+static uint8_t crew_store_crc8( const crew_store_slot_t* slot )
+{
+    crew_store_slot_t body = *slot;
+    const uint8_t* bytes = ( const uint8_t* ) &body;
+    uint8_t crc = 0xFF;
+
+    body.crc = 0;
+    for( size_t i = 0; i < CREW_STORE_SLOT_BODY_SIZE; i++ )
+    {
+        crc ^= bytes[i];
+        for( uint8_t bit = 0; bit < 8; bit++ )
+        {
+            crc = ( crc & 0x80 ) ? ( uint8_t )(( crc << 1 ) ^ 0x07 ) : ( uint8_t )( crc << 1 );
+        }
+    }
+    return crc;
+}
+
+// FNV-1a over the length and the payload, never 0
+static uint32_t crew_store_record_hash( const uint8_t* record, uint8_t len )
+{
+    uint32_t hash = 2166136261UL;
+
+    hash = ( hash ^ len ) * 16777619UL;
+    for( uint8_t i = 0; i < len; i++ )
+    {
+        hash = ( hash ^ record[i] ) * 16777619UL;
+    }
+    return ( hash != 0 ) ? hash : 1;
+}
+
+static bool crew_store_read_header( uint8_t page, crew_store_page_header_t* header )
+{
+    hal_flash_read_buffer( crew_store_page_addr( page ), ( uint8_t* ) header, sizeof( *header ));
+    return ( header->magic == CREW_STORE_PAGE_MAGIC ) && ( header->commit == CREW_STORE_COMMIT );
+}
+
+static crew_store_slot_state_t crew_store_read_slot( uint32_t addr, crew_store_slot_t* slot )
+{
+    const uint8_t* bytes = ( const uint8_t* ) slot;
+    bool erased = true;
+
+    hal_flash_read_buffer( addr, ( uint8_t* ) slot, sizeof( *slot ));
+    for( size_t i = 0; i < sizeof( *slot ); i++ )
+    {
+        if( bytes[i] != 0xFF )
+        {
+            erased = false;
+            break;
+        }
+    }
+    if( erased )
+    {
+        return CREW_STORE_SLOT_FREE;
+    }
+    if(( slot->commit != CREW_STORE_COMMIT ) || ( slot->len > CREW_STORE_RECORD_MAX_LEN ) ||
+       ( crew_store_crc8( slot ) != slot->crc ))
+    {
+        return CREW_STORE_SLOT_TORN;
+    }
+    return ( slot->sent == CREW_STORE_ERASED ) ? CREW_STORE_SLOT_PENDING : CREW_STORE_SLOT_SENT;
+}
+
+static void crew_store_count_pending( const crew_store_slot_t* slot, int8_t delta )
+{
+    store.pending += delta;
+    if( slot->flags & CREW_STORE_FLAG_SAFETY )
+    {
+        store.pending_safety += delta;
+    }
+}
+
+// Erase the page after the head and make it the new head, dropping what it still held
+static void crew_store_open_page( uint8_t page )
+{
+    crew_store_page_header_t header;
+    crew_store_slot_t slot;
+    uint32_t dropped = 0;
+
+    if( store.page_valid[page] )
+    {
+        for( uint16_t i = 0; i < CREW_STORE_SLOTS_PER_PAGE; i++ )
+        {
+            if( crew_store_read_slot( crew_store_slot_addr( page, i ), &slot ) == CREW_STORE_SLOT_PENDING )
+            {
+                crew_store_count_pending( &slot, -1 );
+                dropped++;
+            }
+        }
+    }
+    if( dropped > 0 )
+    {
+        store.dropped += dropped;
+        STORE_TRACE_INFO( "Store-and-forward full: %lu unsent records dropped\n", dropped );
+    }
+
+    store.page_valid[page] = false;
+    hal_flash_erase_page( crew_store_page_addr( page ), 1 );
+    store.erase_count[page]++;
+
+    header.magic = CREW_STORE_PAGE_MAGIC;
+    header.page_seq = store.head_page_seq + 1;
+    header.erase_count = store.erase_count[page];
+    header.commit = CREW_STORE_COMMIT;
+    hal_flash_write_buffer( crew_store_page_addr( page ), ( const uint8_t* ) &header, offsetof( crew_store_page_header_t, commit ));
+    hal_flash_write_buffer( crew_store_page_addr( page ) + offsetof( crew_store_page_header_t, commit ),
+                            ( const uint8_t* ) &header.commit, sizeof( header.commit ));
+
+    store.page_valid[page] = true;
+    store.head_page = page;
+    store.head_slot = 0;
+    store.head_page_seq = header.page_seq;
+}
+
+// Keep the n best candidates, ordered by seq: newest first if newest, else oldest first
+static void crew_store_rank( uint32_t* addr, uint32_t* seq, uint8_t* count, uint8_t max, uint32_t slot_addr,
+                             uint32_t slot_seq, bool newest )
+{
+    uint8_t i = *count;
+
+    while(( i > 0 ) && ( newest ? ( int32_t )( slot_seq - seq[i - 1] ) > 0 : ( int32_t )( slot_seq - seq[i - 1] ) < 0 ))
+    {
+        if( i < max )
+        {
+            addr[i] = addr[i - 1];
+            seq[i] = seq[i - 1];
+        }
+        i--;
+    }
+    if( i < max )
+    {
+        addr[i] = slot_addr;
+        seq[i] = slot_seq;
+        if( *count < max )
+        {
+            ( *count )++;
+        }
+    }
+}
+
+static uint8_t crew_store_put_delta( uint8_t* buffer, int32_t delta )
+{
+    uint32_t value = (( uint32_t ) delta << 1 ) ^ ( uint32_t )( delta >> 31 );
+    uint8_t len = 0;
+
+    do
+    {
+        buffer[len] = value & 0x7F;
+        value >>= 7;
+        if( value != 0 )
+        {
+            buffer[len] |= 0x80;
+        }
+        len++;
+    } while( value != 0 );
+    return len;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void crew_store_init( void )
+{
+    crew_store_page_header_t header;
+    crew_store_slot_t slot;
+    uint32_t erase_max = 0;
+    bool found = false;
+
+    memset( &store, 0, sizeof( store ));
+    store_batch_count = 0;
+
+    for( uint8_t page = 0; page < CREW_STORE_PAGES; page++ )
+    {
+        store.page_valid[page] = crew_store_read_header( page, &header );
+        if( !store.page_valid[page] )
+        {
+            continue;
+        }
+        store.erase_count[page] = header.erase_count;
+        erase_max = ( header.erase_count > erase_max ) ? header.erase_count : erase_max;
+        if( !found || ( int32_t )( header.page_seq - store.head_page_seq ) > 0 )
+        {
+            found = true;
+            store.head_page = page;
+            store.head_page_seq = header.page_seq;
+        }
+    }
+
+    // A page without a valid header lost its count to an interrupted erase; it is at least as worn as the rest
+    for( uint8_t page = 0; page < CREW_STORE_PAGES; page++ )
+    {
+        if( !store.page_valid[page] )
+        {
+            store.erase_count[page] = erase_max;
+        }
+    }
+
+    if( !found )
+    {
+        STORE_TRACE_INFO( "Store-and-forward: no valid page, formatting\n" );
+        crew_store_open_page( 0 );
+        store.next_seq = 1;
+        store.mounted = true;
+        return;
+    }
+
+    for( uint8_t page = 0; page < CREW_STORE_PAGES; page++ )
+    {
+        if( !store.page_valid[page] )
+        {
+            continue;
+        }
+        for( uint16_t i = 0; i < CREW_STORE_SLOTS_PER_PAGE; i++ )
+        {
+            crew_store_slot_state_t state = crew_store_read_slot( crew_store_slot_addr( page, i ), &slot );
+
+            if( state == CREW_STORE_SLOT_FREE )
+            {
+                continue;
+            }
+            if( page == store.head_page )
+            {
+                store.head_slot = i + 1;
+            }
+            if( state == CREW_STORE_SLOT_TORN )
+            {
+                store.torn++;
+                continue;
+            }
+            if(( store.next_seq == 0 ) || ( int32_t )( slot.seq - store.next_seq ) >= 0 )
+            {
+                store.next_seq = slot.seq + 1;
+            }
+            if( state == CREW_STORE_SLOT_PENDING )
+            {
+                crew_store_count_pending( &slot, 1 );
+            }
+        }
+    }
+    if( store.next_seq == 0 )
+    {
+        store.next_seq = 1;
+    }
+
+    store.mounted = true;
+    STORE_TRACE_INFO( "Store-and-forward: %u pending (%u safety), head page %u slot %u, %lu torn\n",
+                      store.pending, store.pending_safety, store.head_page, store.head_slot, store.torn );
+}
+
+bool crew_store_append( uint8_t port, const uint8_t* record, uint8_t len, uint32_t timestamp_s, bool safety )
+{
+    crew_store_slot_t slot;
+    uint32_t addr;
+    uint32_t hash;
+    uint8_t port_index;
+
+    if( !store.mounted || ( record == NULL ) || ( len == 0 ) || ( len > CREW_STORE_RECORD_MAX_LEN ) ||
+        ( port < CREW_ROUTINE_APP_PORT ) || ( port > CREW_RF_FINGERPRINT_PORT ))
+    {
+        return false;
+    }
+
+    // The copy already in flash stands for this one
+    port_index = port - CREW_ROUTINE_APP_PORT;
+    hash = crew_store_record_hash( record, len );
+    if(( store.last_hash[port_index] == hash ) &&
+       (( timestamp_s - store.last_timestamp_s[port_index] ) < CREW_STORE_REPEAT_WINDOW_S ))
+    {
+        store.repeats++;
+        return true;
+    }
+
+    if( store.head_slot >= CREW_STORE_SLOTS_PER_PAGE )
+    {
+        crew_store_open_page(( store.head_page + 1 ) % CREW_STORE_PAGES );
+    }
+
+    memset( &slot, 0xFF, sizeof( slot ));
+    slot.seq = store.next_seq;
+    slot.timestamp_s = timestamp_s;
+    slot.port = port;
+    slot.len = len;
+    slot.flags = safety ? CREW_STORE_FLAG_SAFETY : 0;
+    memcpy( slot.data, record, len );
+    slot.crc = crew_store_crc8( &slot );
+    slot.commit = CREW_STORE_COMMIT;
+
+    // The slot is consumed as soon as its first word may be written, torn or not
+    addr = crew_store_slot_addr( store.head_page, store.head_slot );
+    store.head_slot++;
+    store.next_seq++;
+    hal_flash_write_buffer( addr, ( const uint8_t* ) &slot, CREW_STORE_SLOT_BODY_SIZE );
+    hal_flash_write_buffer( addr + offsetof( crew_store_slot_t, commit ), ( const uint8_t* ) &slot.commit,
+                            sizeof( slot.commit ));
+
+    crew_store_count_pending( &slot, 1 );
+    store.last_hash[port_index] = hash;
+    store.last_timestamp_s[port_index] = timestamp_s;
+    return true;
+}
+
+uint16_t crew_store_pending( void )
+{
+    return store.pending;
+}
+
+uint8_t crew_store_build_batch( uint8_t max_len, uint8_t* frame )
+{
+    uint32_t safety_addr[CREW_STORE_BATCH_MAX];
+    uint32_t safety_seq[CREW_STORE_BATCH_MAX];
+    uint32_t routine_addr[CREW_STORE_BATCH_MAX];
+    uint32_t routine_seq[CREW_STORE_BATCH_MAX];
+    uint8_t safety_count = 0;
+    uint8_t routine_count = 0;
+    crew_store_slot_t slot;
+    uint32_t previous_s = 0;
+    uint8_t len = CREW_BACKLOG_HEADER_LEN;
+    uint16_t remaining;
+
+    store_batch_count = 0;
+    if( !store.mounted || ( store.pending == 0 ) || ( max_len <= CREW_BACKLOG_HEADER_LEN ))
+    {
+        return 0;
+    }
+
+    for( uint8_t page = 0; page < CREW_STORE_PAGES; page++ )
+    {
+        if( !store.page_valid[page] )
+        {
+            continue;
+        }
+        for( uint16_t i = 0; i < CREW_STORE_SLOTS_PER_PAGE; i++ )
+        {
+            uint32_t addr = crew_store_slot_addr( page, i );
+
+            if( crew_store_read_slot( addr, &slot ) != CREW_STORE_SLOT_PENDING )
+            {
+                continue;
+            }
+            if( slot.flags & CREW_STORE_FLAG_SAFETY )
+            {
+                crew_store_rank( safety_addr, safety_seq, &safety_count, CREW_STORE_BATCH_MAX, addr, slot.seq, true );
+            }
+            else
+            {
+                crew_store_rank( routine_addr, routine_seq, &routine_count, CREW_STORE_BATCH_MAX, addr, slot.seq, false );
+            }
+        }
+    }
+
+    for( uint8_t i = 0; i < safety_count + routine_count; i++ )
+    {
+        uint32_t addr = ( i < safety_count ) ? safety_addr[i] : routine_addr[i - safety_count];
+        uint8_t delta[CREW_BACKLOG_DELTA_MAX_LEN];
+        uint8_t delta_len;
+
+        if( store_batch_count >= CREW_STORE_BATCH_MAX )
+        {
+            break;
+        }
+        crew_store_read_slot( addr, &slot );
+        if( store_batch_count == 0 )
+        {
+            previous_s = slot.timestamp_s;
+            frame[0] = ( uint8_t )( previous_s );
+            frame[1] = ( uint8_t )( previous_s >> 8 );
+            frame[2] = ( uint8_t )( previous_s >> 16 );
+            frame[3] = ( uint8_t )( previous_s >> 24 );
+        }
+        delta_len = crew_store_put_delta( delta, ( int32_t )( slot.timestamp_s - previous_s ));
+        if( len + 1 + delta_len + slot.len > max_len )
+        {
+            continue;
+        }
+
+        frame[len++] = CREW_PACKED_RECORD_HEADER( slot.port, slot.len );
+        memcpy( frame + len, delta, delta_len );
+        len += delta_len;
+        memcpy( frame + len, slot.data, slot.len );
+        len += slot.len;
+        previous_s = slot.timestamp_s;
+        store_batch_addr[store_batch_count] = addr;
+        store_batch_seq[store_batch_count++] = slot.seq;
+    }
+
+    if( store_batch_count == 0 )
+    {
+        return 0;
+    }
+    remaining = store.pending - store_batch_count;
+    frame[4] = ( remaining > 255 ) ? 255 : ( uint8_t ) remaining;
+    return len;
+}
+
+void crew_store_commit_batch( void )
+{
+    crew_store_slot_t slot;
+    uint32_t sent = 0;
+
+    for( uint8_t i = 0; i < store_batch_count; i++ )
+    {
+        // The page may have been reused by appends since the batch was built, the slot then holds a newer record
+        if(( crew_store_read_slot( store_batch_addr[i], &slot ) != CREW_STORE_SLOT_PENDING ) ||
+           ( slot.seq != store_batch_seq[i] ))
+        {
+            continue;
+        }
+        hal_flash_write_buffer( store_batch_addr[i] + offsetof( crew_store_slot_t, sent ), ( const uint8_t* ) &sent,
+                                sizeof( sent ));
+        crew_store_count_pending( &slot, -1 );
+    }
+    store_batch_count = 0;
+}
+
+void crew_store_get_stats( crew_store_stats_t* stats )
+{
+    memset( stats, 0, sizeof( *stats ));
+    stats->pending = store.pending;
+    stats->pending_safety = store.pending_safety;
+    stats->capacity = ( CREW_STORE_PAGES - 1 ) * CREW_STORE_SLOTS_PER_PAGE;
+    stats->dropped = store.dropped;
+    stats->torn = store.torn;
+    stats->repeats = store.repeats;
+    stats->erase_min = store.erase_count[0];
+    for( uint8_t page = 0; page < CREW_STORE_PAGES; page++ )
+    {
+        stats->erase_min = ( store.erase_count[page] < stats->erase_min ) ? store.erase_count[page] : stats->erase_min;
+        stats->erase_max = ( store.erase_count[page] > stats->erase_max ) ? store.erase_count[page] : stats->erase_max;
+    }
+}
@@ -0,0 +1,243 @@
+/*!
+ * @file      crew_uplink_packer.c
+ *
+ * @brief     Pending uplink records coalesced into one LoRaWAN frame
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "crew_uplink_packer.h"
+#include "crew_payload_schema.h"
+#include "crew_lorawan_ports.h"
+#include "log_filter.h"
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define PACKER_TRACE_INFO(...)      LOG_LORA(__VA_ARGS__)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct {
+    bool     used;
+    bool     in_frame;      // Packed by the last build, dropped on commit
+    bool     confirmed;
+    uint8_t  key;
+    uint8_t  port;
+    uint8_t  priority;
+    uint8_t  len;
+    uint32_t deadline_ms;
+    uint8_t  data[CREW_PACKED_RECORD_MAX_LEN];
+} crew_uplink_record_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static crew_uplink_record_t packer_records[CREW_UPLINK_PACKER_SLOTS];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+// true if a goes out before b: higher priority first, then earlier deadline
+static bool crew_uplink_packer_ranks_before( const crew_uplink_record_t* a, const crew_uplink_record_t* b )
+{
+    if( a->priority != b->priority )
+    {
+        return a->priority > b->priority;
+    }
+    return ( int32_t )( a->deadline_ms - b->deadline_ms ) < 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void crew_uplink_packer_clear( void )
+{
+    memset( packer_records, 0, sizeof( packer_records ));
+}
+
+bool crew_uplink_packer_push( uint8_t key, uint8_t port, const uint8_t* record, uint8_t len, uint8_t priority,
+                              uint32_t deadline_ms, bool confirmed )
+{
+    crew_uplink_record_t* slot = NULL;
+    crew_uplink_record_t incoming;
+
+    if(( record == NULL ) || ( len == 0 ) || ( len > CREW_PACKED_RECORD_MAX_LEN ) ||
+       ( port < CREW_ROUTINE_APP_PORT ) || ( port > CREW_RF_FINGERPRINT_PORT ))
+    {
+        return false;
+    }
+
+    memset( &incoming, 0, sizeof( incoming ));
+    incoming.used = true;
+    incoming.confirmed = confirmed;
+    incoming.key = key;
+    incoming.port = port;
+    incoming.priority = priority;
+    incoming.len = len;
+    incoming.deadline_ms = deadline_ms;
+    memcpy( incoming.data, record, len );
+
+    for( uint8_t i = 0; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+    {
+        if( packer_records[i].used && ( packer_records[i].key == key ))
+        {
+            slot = &packer_records[i];
+            break;
+        }
+        if(( slot == NULL ) && !packer_records[i].used )
+        {
+            slot = &packer_records[i];
+        }
+    }
+
+    if( slot == NULL )
+    {
+        // Full: the lowest ranked record makes room, unless the new one ranks even lower
+        slot = &packer_records[0];
+        for( uint8_t i = 1; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+        {
+            if( crew_uplink_packer_ranks_before( slot, &packer_records[i] ))
+            {
+                slot = &packer_records[i];
+            }
+        }
+        if( !crew_uplink_packer_ranks_before( &incoming, slot ))
+        {
+            PACKER_TRACE_INFO( "Uplink packer full, record key %u dropped\n", key );
+            return false;
+        }
+        PACKER_TRACE_INFO( "Uplink packer full, record key %u evicted\n", slot->key );
+    }
+
+    *slot = incoming;
+    return true;
+}
+
+uint8_t crew_uplink_packer_pending( void )
+{
+    uint8_t count = 0;
+
+    for( uint8_t i = 0; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+    {
+        if( packer_records[i].used )
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool crew_uplink_packer_due( uint32_t now_ms )
+{
+    for( uint8_t i = 0; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+    {
+        const crew_uplink_record_t* rec = &packer_records[i];
+
+        if( rec->used && (( int32_t )( now_ms - rec->deadline_ms ) >= 0 ))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t crew_uplink_packer_build( uint8_t max_len, uint8_t* frame, uint8_t* port, bool* confirmed )
+{
+    crew_uplink_record_t* order[CREW_UPLINK_PACKER_SLOTS];
+    uint8_t count = 0;
+    uint8_t packed = 0;
+    uint8_t len = 0;
+
+    if( max_len > CREW_UPLINK_PACKER_FRAME_MAX )
+    {
+        max_len = CREW_UPLINK_PACKER_FRAME_MAX;
+    }
+    *confirmed = false;
+
+    // Insertion sort of the pending records by rank, the queue is tiny
+    for( uint8_t i = 0; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+    {
+        crew_uplink_record_t* rec = &packer_records[i];
+        uint8_t j = count;
+
+        rec->in_frame = false;
+        if( !rec->used )
+        {
+            continue;
+        }
+        while(( j > 0 ) && crew_uplink_packer_ranks_before( rec, order[j - 1] ))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = rec;
+        count++;
+    }
+
+    for( uint8_t i = 0; i < count; i++ )
+    {
+        crew_uplink_record_t* rec = order[i];
+
+        if( len + 1 + rec->len > max_len )
+        {
+            continue;
+        }
+        frame[len++] = CREW_PACKED_RECORD_HEADER( rec->port, rec->len );
+        memcpy( frame + len, rec->data, rec->len );
+        len += rec->len;
+        rec->in_frame = true;
+        *confirmed |= rec->confirmed;
+        order[packed++] = rec;
+    }
+
+    if( packed == 0 )
+    {
+        // Without its header the best record may still fit alone
+        if(( count == 0 ) || ( order[0]->len > max_len ))
+        {
+            return 0;
+        }
+        packed = 1;
+    }
+
+    // A lone record needs no header and keeps its own FPort
+    if( packed == 1 )
+    {
+        memcpy( frame, order[0]->data, order[0]->len );
+        order[0]->in_frame = true;
+        *port = order[0]->port;
+        *confirmed = order[0]->confirmed;
+        return order[0]->len;
+    }
+
+    *port = CREW_PACKED_APP_PORT;
+    PACKER_TRACE_INFO( "Uplink packer: %u of %u records in %u bytes\n", packed, count, len );
+    return len;
+}
+
+void crew_uplink_packer_commit( void )
+{
+    for( uint8_t i = 0; i < CREW_UPLINK_PACKER_SLOTS; i++ )
+    {
+        if( packer_records[i].in_frame )
+        {
+            memset( &packer_records[i], 0, sizeof( packer_records[i] ));
+        }
+    }
+}
@@ -15,6 +15,7 @@
 #include "smtc_hal_config.h"
 #include "smtc_modem_api.h"
 #include "ag3335.h"
+#include "gnss_ttff_stats.h"
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
@@ -32,7 +33,8 @@
 #define GNSS_SCAN_DURATION_EXCELLENT    10   // Seconds
 #define GNSS_SCAN_DURATION_GOOD         15   // Seconds
 #define GNSS_SCAN_DURATION_FAIR         25   // Seconds
-#define GNSS_SCAN_DURATION_COLD         60   // Seconds
+#define GNSS_SCAN_DURATION_COLD         60   // Seconds, also the ceiling of a learned duration
+#define GNSS_SCAN_DURATION_MIN          5    // Seconds, floor of a learned duration
 
 // GNSS power up timing
 #define GNSS_POWER_UP_DELAY_MS          500  // Time to wait after power on
@@ -81,6 +83,7 @@ void gateway_assistance_init(void)
     memset(&position_cache, 0, sizeof(position_cache));
     position_cache.valid = false;
     position_cache.time_synced = false;
+    gnss_ttff_stats_init();
     
     HAL_DBG_TRACE_INFO("Gateway assistance system initialized\n");
 }
@@ -217,17 +220,28 @@ uint32_t gateway_assistance_get_time_uncertainty(void)
 uint32_t gateway_assistance_get_recommended_scan_duration(void)
 {
     assistance_quality_t quality = gateway_assistance_get_quality();
+    uint32_t default_s;
     
     switch (quality) {
         case ASSISTANCE_EXCELLENT:
-            return GNSS_SCAN_DURATION_EXCELLENT;
+            default_s = GNSS_SCAN_DURATION_EXCELLENT;
+            break;
         case ASSISTANCE_GOOD:
-            return GNSS_SCAN_DURATION_GOOD;
+            default_s = GNSS_SCAN_DURATION_GOOD;
+            break;
         case ASSISTANCE_FAIR:
-            return GNSS_SCAN_DURATION_FAIR;
+            default_s = GNSS_SCAN_DURATION_FAIR;
+            break;
         default:
-            return GNSS_SCAN_DURATION_COLD;
+            default_s = GNSS_SCAN_DURATION_COLD;
+            break;
     }
+
+    // The age buckets are only the starting point; once this device has TTFF history, it decides
+    uint32_t budget_ms = gnss_ttff_stats_scan_budget_ms(default_s * 1000,
+                                                        GNSS_SCAN_DURATION_MIN * 1000,
+                                                        GNSS_SCAN_DURATION_COLD * 1000);
+    return (budget_ms + 999) / 1000;
 }
 
 bool gateway_assistance_is_charging(void)
@@ -465,7 +479,11 @@ bool gateway_assistance_send_warm_start(void)
     
     HAL_DBG_TRACE_INFO("Sending GNSS warm start command (PAIR005)\n");
     
-    return gnss_send_command(warm_start_cmd);
+    if (!gnss_send_command(warm_start_cmd)) {
+        return false;
+    }
+    gnss_ttff_stats_note_start(GNSS_START_WARM);
+    return true;
 }
 
 bool gateway_assistance_send_hot_start(void)
@@ -478,7 +496,11 @@ bool gateway_assistance_send_hot_start(void)
     
     HAL_DBG_TRACE_INFO("Sending GNSS hot start command (PAIR004)\n");
     
-    return gnss_send_command(hot_start_cmd);
+    if (!gnss_send_command(hot_start_cmd)) {
+        return false;
+    }
+    gnss_ttff_stats_note_start(GNSS_START_HOT);
+    return true;
 }
 
 bool gateway_assistance_should_check_almanac(void)
@@ -608,8 +630,8 @@ static void gnss_power_on_for_command(void)
 
 static void gnss_power_off_after_command(void)
 {
-    // Wait for any pending UART transmission
-    hal_mcu_wait_ms(100);
+    // Wait for any pending UART transmission, parsing the command responses
+    gnss_wait_ms(100);
     
     // Deinitialize UART
     hal_uart_0_deinit();
@@ -0,0 +1,212 @@
+/*!
+ * @file      gnss_fix_predict.c
+ *
+ * @brief     Early stop of hopeless GNSS scans from the C/N0 and SV trends
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "gnss_fix_predict.h"
+#include "default_config_settings.h"
+#include "log_filter.h"
+#include <string.h>
+#include <math.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define PREDICT_TRACE_INFO(...)     LOG_GNSS(__VA_ARGS__)
+
+#ifndef REMEX_GNSS_PREDICT_MIN_PROB_PCT
+#define REMEX_GNSS_PREDICT_MIN_PROB_PCT     0
+#endif
+
+#ifndef REMEX_GNSS_PREDICT_OBSERVE_MS
+#define REMEX_GNSS_PREDICT_OBSERVE_MS       6000
+#endif
+
+// Trend window, one sample per second
+#define GNSS_FIX_PREDICT_SAMPLES            8
+#define GNSS_FIX_PREDICT_SAMPLE_MS          1000
+
+// Trends are projected this far at most, and by a bounded amount
+#ifndef GNSS_FIX_PREDICT_HORIZON_S
+#define GNSS_FIX_PREDICT_HORIZON_S          15.0f
+#endif
+#define GNSS_FIX_PREDICT_MAX_CN0_GAIN       10.0f   // dB-Hz
+#define GNSS_FIX_PREDICT_MAX_STRONG_GAIN    8.0f    // satellites
+
+// Logistic model: z = W0 + W_CN0 * (top4 - CN0_REF) + W_STRONG * strong, on the projected values.
+// Top-4 at 20 dB-Hz with no strong satellite gives 2 %, 28 dB-Hz with 2 strong about 45 %,
+// 30 dB-Hz with 4 strong about 80 %.
+#ifndef GNSS_FIX_PREDICT_W0
+#define GNSS_FIX_PREDICT_W0                 -4.0f
+#endif
+#ifndef GNSS_FIX_PREDICT_W_CN0
+#define GNSS_FIX_PREDICT_W_CN0              0.35f
+#endif
+#ifndef GNSS_FIX_PREDICT_CN0_REF
+#define GNSS_FIX_PREDICT_CN0_REF            20.0f
+#endif
+#ifndef GNSS_FIX_PREDICT_W_STRONG
+#define GNSS_FIX_PREDICT_W_STRONG           0.5f
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct {
+    uint32_t elapsed_ms;
+    uint8_t  top4_cn0;
+    uint8_t  strong;
+    uint8_t  tracked;
+} gnss_fix_predict_sample_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static gnss_fix_predict_sample_t predict_samples[GNSS_FIX_PREDICT_SAMPLES];
+static uint8_t predict_head = 0;
+static uint8_t predict_count = 0;
+static bool predict_started = false;
+static uint32_t predict_gsv_at_start = 0;
+static bool predict_stopped = false;
+static uint8_t predict_min_prob_pct = REMEX_GNSS_PREDICT_MIN_PROB_PCT;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static float gnss_fix_predict_clamp( float value, float min, float max )
+{
+    return ( value < min ) ? min : ( value > max ) ? max : value;
+}
+
+// Least-squares slope per second of one sample series over the window
+static float gnss_fix_predict_slope( bool strong )
+{
+    float n = predict_count;
+    float sum_t = 0.0f, sum_y = 0.0f, sum_tt = 0.0f, sum_ty = 0.0f;
+    float denom = 0.0f;
+
+    for( uint8_t i = 0; i < predict_count; i++ )
+    {
+        const gnss_fix_predict_sample_t* sample = &predict_samples[i];
+        float t = sample->elapsed_ms / 1000.0f;
+        float y = strong ? sample->strong : sample->top4_cn0;
+
+        sum_t += t;
+        sum_y += y;
+        sum_tt += t * t;
+        sum_ty += t * y;
+    }
+
+    denom = n * sum_tt - sum_t * sum_t;
+    if( predict_count < 2 || denom <= 0.0f )
+    {
+        return 0.0f;
+    }
+    return ( n * sum_ty - sum_t * sum_y ) / denom;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void gnss_fix_predict_start( void )
+{
+    memset( predict_samples, 0, sizeof( predict_samples ));
+    predict_head = 0;
+    predict_count = 0;
+    predict_started = false;
+    predict_gsv_at_start = 0;
+    predict_stopped = false;
+}
+
+void gnss_fix_predict_set_threshold( uint8_t min_prob_pct )
+{
+    predict_min_prob_pct = min_prob_pct;
+}
+
+bool gnss_fix_predict_update( uint32_t elapsed_ms, uint32_t budget_ms, const gnss_sky_metrics_t* sky,
+                              gnss_fix_predict_t* result )
+{
+    gnss_fix_predict_t eval;
+    const gnss_fix_predict_sample_t* last = NULL;
+
+    memset( &eval, 0, sizeof( eval ));
+    eval.elapsed_ms = elapsed_ms;
+    eval.budget_ms = budget_ms;
+    eval.top4_cn0 = sky->top4_cn0;
+    eval.strong = sky->strong;
+    eval.tracked = sky->tracked;
+    eval.probability = 100;
+    eval.stop = predict_stopped;
+
+    if( !predict_started )
+    {
+        predict_started = true;
+        predict_gsv_at_start = sky->gsv_count;
+    }
+    if( predict_count > 0 )
+    {
+        last = &predict_samples[( predict_head + GNSS_FIX_PREDICT_SAMPLES - 1 ) % GNSS_FIX_PREDICT_SAMPLES];
+    }
+
+    // Nothing is known about the sky before the first GSV of this scan
+    if( predict_min_prob_pct == 0 || predict_stopped || sky->gsv_count == predict_gsv_at_start ||
+        ( last != NULL && elapsed_ms - last->elapsed_ms < GNSS_FIX_PREDICT_SAMPLE_MS ))
+    {
+        if( result != NULL ) *result = eval;
+        return eval.stop;
+    }
+
+    predict_samples[predict_head].elapsed_ms = elapsed_ms;
+    predict_samples[predict_head].top4_cn0 = sky->top4_cn0;
+    predict_samples[predict_head].strong = sky->strong;
+    predict_samples[predict_head].tracked = sky->tracked;
+    predict_head = ( predict_head + 1 ) % GNSS_FIX_PREDICT_SAMPLES;
+    if( predict_count < GNSS_FIX_PREDICT_SAMPLES )
+    {
+        predict_count++;
+    }
+
+    eval.samples = predict_count;
+    eval.cn0_slope = gnss_fix_predict_slope( false );
+    eval.strong_slope = gnss_fix_predict_slope( true );
+
+    if( elapsed_ms >= REMEX_GNSS_PREDICT_OBSERVE_MS && predict_count >= 3 )
+    {
+        float remaining_s = ( budget_ms > elapsed_ms ) ? ( budget_ms - elapsed_ms ) / 1000.0f : 0.0f;
+        float horizon_s = ( remaining_s < GNSS_FIX_PREDICT_HORIZON_S ) ? remaining_s : GNSS_FIX_PREDICT_HORIZON_S;
+        float top4 = sky->top4_cn0 + gnss_fix_predict_clamp( eval.cn0_slope * horizon_s,
+                                                             -GNSS_FIX_PREDICT_MAX_CN0_GAIN, GNSS_FIX_PREDICT_MAX_CN0_GAIN );
+        float strong = sky->strong + gnss_fix_predict_clamp( eval.strong_slope * horizon_s,
+                                                             -( float )sky->strong, GNSS_FIX_PREDICT_MAX_STRONG_GAIN );
+        float z = GNSS_FIX_PREDICT_W0 + GNSS_FIX_PREDICT_W_CN0 * ( top4 - GNSS_FIX_PREDICT_CN0_REF ) +
+                  GNSS_FIX_PREDICT_W_STRONG * strong;
+
+        eval.probability = ( uint8_t )( 100.0f / ( 1.0f + expf( -z )) + 0.5f );
+        eval.stop = eval.probability < predict_min_prob_pct;
+        predict_stopped = eval.stop;
+
+        PREDICT_TRACE_INFO( "GNSS predict: t=%lu/%lu ms top4=%u dB-Hz (%+.2f/s) strong=%u (%+.2f/s) tracked=%u p=%u%% %s\n",
+                            elapsed_ms, budget_ms, eval.top4_cn0, eval.cn0_slope, eval.strong, eval.strong_slope,
+                            eval.tracked, eval.probability, eval.stop ? "STOP" : "continue" );
+    }
+    eval.evaluated = true;
+
+    if( result != NULL ) *result = eval;
+    return eval.stop;
+}
@@ -0,0 +1,367 @@
+/*!
+ * @file      gnss_ttff_stats.c
+ *
+ * @brief     Persisted AG3335 time-to-fix histogram and adaptive scan budget
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "gnss_ttff_stats.h"
+#include "gateway_assistance.h"
+#include "app_at_fds_datas.h"
+#include "default_config_settings.h"
+#include "smtc_hal.h"
+#include "ag3335.h"
+#include "log_filter.h"
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define TTFF_TRACE_INFO(...)        LOG_GNSS(__VA_ARGS__)
+
+#ifndef REMEX_GNSS_TTFF_PERCENTILE
+#define REMEX_GNSS_TTFF_PERCENTILE      90
+#endif
+
+#ifndef REMEX_GNSS_TTFF_MARGIN_MS
+#define REMEX_GNSS_TTFF_MARGIN_MS       3000
+#endif
+
+#ifndef REMEX_GNSS_TTFF_MIN_SAMPLES
+#define REMEX_GNSS_TTFF_MIN_SAMPLES     8
+#endif
+
+#ifndef REMEX_GNSS_TTFF_FAIL_PCT
+#define REMEX_GNSS_TTFF_FAIL_PCT        50
+#endif
+
+#ifndef REMEX_GNSS_TTFF_SAVE_SAMPLES
+#define REMEX_GNSS_TTFF_SAVE_SAMPLES    16
+#endif
+
+#ifndef REMEX_GNSS_TTFF_SAVE_INTERVAL_S
+#define REMEX_GNSS_TTFF_SAVE_INTERVAL_S 3600
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define GNSS_TTFF_RECORD_MAGIC      0x54544602UL    // "TTF" + layout version, bump when the record changes
+#define GNSS_TTFF_QUALITY_NUM       ( ASSISTANCE_POOR + 1 )
+#define GNSS_TTFF_COUNT_MAX         255
+
+// Upper edge of each bin in ms; the last bin holds everything slower
+static const uint32_t ttff_bin_edge_ms[GNSS_TTFF_BIN_NUM] = {
+    3000, 5000, 8000, 12000, 16000, 20000, 25000, 30000, 40000, 60000, 90000, UINT32_MAX
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    uint8_t bins[GNSS_TTFF_BIN_NUM];
+    uint8_t censored;
+} gnss_ttff_hist_t;
+
+/*
+ * FDS record image. Counts are uint8_t: when a bin saturates, the whole
+ * context is halved, which also lets old samples fade as conditions change.
+ */
+typedef struct
+{
+    uint32_t         magic;
+    gnss_ttff_hist_t hist[GNSS_START_TYPE_NUM][GNSS_TTFF_QUALITY_NUM][GNSS_TTFF_SV_BUCKET_NUM];
+} gnss_ttff_record_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// Word aligned and static, FDS reads it after write_fds_record( ) returns
+static gnss_ttff_record_t ttff_record __attribute__(( aligned( 4 )));
+static gnss_start_type_t ttff_start_type = GNSS_START_COLD;
+static uint16_t ttff_unsaved = 0;
+static uint32_t ttff_last_save_s = 0;
+static bool ttff_saved_once = false;
+static bool ttff_skip_next = false;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint8_t gnss_ttff_sv_bucket( uint8_t sv_count )
+{
+    if( sv_count < 4 ) return 0;
+    if( sv_count < 24 ) return 1;
+    return 2;
+}
+
+static gnss_ttff_hist_t *gnss_ttff_current_hist( uint8_t *quality, uint8_t *sv_bucket )
+{
+    assistance_quality_t q = gateway_assistance_get_quality( );
+
+    *quality = ( q < GNSS_TTFF_QUALITY_NUM ) ? ( uint8_t )q : ( uint8_t )ASSISTANCE_POOR;
+    *sv_bucket = gnss_ttff_sv_bucket( gnss_almanac_get_valid_sv_count( ));
+    return &ttff_record.hist[ttff_start_type][*quality][*sv_bucket];
+}
+
+static uint8_t gnss_ttff_bin_index( uint32_t ms )
+{
+    uint8_t i = 0;
+
+    while( i < GNSS_TTFF_BIN_NUM - 1 && ms > ttff_bin_edge_ms[i] )
+    {
+        i++;
+    }
+    return i;
+}
+
+static uint16_t gnss_ttff_hist_total( const gnss_ttff_hist_t *hist )
+{
+    uint16_t total = 0;
+
+    for( uint8_t i = 0; i < GNSS_TTFF_BIN_NUM; i++ )
+    {
+        total += hist->bins[i];
+    }
+    return total;
+}
+
+static void gnss_ttff_hist_add( gnss_ttff_hist_t *hist, uint8_t bin, bool censored )
+{
+    if(( !censored && hist->bins[bin] >= GNSS_TTFF_COUNT_MAX ) || ( censored && hist->censored >= GNSS_TTFF_COUNT_MAX ))
+    {
+        for( uint8_t i = 0; i < GNSS_TTFF_BIN_NUM; i++ )
+        {
+            hist->bins[i] >>= 1;
+        }
+        hist->censored >>= 1;
+    }
+
+    // A scan without a fix only says the fix needs more than the scan, it stays out of the percentile
+    if( censored )
+    {
+        hist->censored++;
+    }
+    else
+    {
+        hist->bins[bin]++;
+    }
+}
+
+static bool gnss_ttff_hist_failing( const gnss_ttff_hist_t *hist )
+{
+    uint32_t attempts = ( uint32_t )gnss_ttff_hist_total( hist ) + hist->censored;
+
+    if( attempts < REMEX_GNSS_TTFF_MIN_SAMPLES )
+    {
+        return false;
+    }
+    return ( uint32_t )hist->censored * 100 >= attempts * REMEX_GNSS_TTFF_FAIL_PCT;
+}
+
+static uint32_t gnss_ttff_hist_budget_ms( const gnss_ttff_hist_t *hist, uint32_t max_ms )
+{
+    uint16_t total = gnss_ttff_hist_total( hist );
+    uint16_t target = 0;
+    uint16_t cumulative = 0;
+
+    if( total < REMEX_GNSS_TTFF_MIN_SAMPLES )
+    {
+        return 0;
+    }
+
+    target = ( uint16_t )((( uint32_t )total * REMEX_GNSS_TTFF_PERCENTILE + 99 ) / 100 );
+    for( uint8_t i = 0; i < GNSS_TTFF_BIN_NUM; i++ )
+    {
+        cumulative += hist->bins[i];
+        if( cumulative >= target )
+        {
+            // The open-ended bin means the percentile is beyond anything observed
+            if( i == GNSS_TTFF_BIN_NUM - 1 )
+            {
+                return max_ms;
+            }
+            return ttff_bin_edge_ms[i] + REMEX_GNSS_TTFF_MARGIN_MS;
+        }
+    }
+    return max_ms;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void gnss_ttff_stats_init( void )
+{
+    if( !read_fds_record( TTFF_FILE, TTFF_REC_KEY, &ttff_record, sizeof( ttff_record )) ||
+        ttff_record.magic != GNSS_TTFF_RECORD_MAGIC )
+    {
+        memset( &ttff_record, 0, sizeof( ttff_record ));
+        ttff_record.magic = GNSS_TTFF_RECORD_MAGIC;
+        TTFF_TRACE_INFO( "GNSS TTFF stats: no saved histogram, starting empty\n" );
+    }
+    else
+    {
+        TTFF_TRACE_INFO( "GNSS TTFF stats: histogram loaded (%u bytes)\n", ( unsigned )sizeof( ttff_record ));
+    }
+
+    ttff_start_type = GNSS_START_COLD;
+    ttff_unsaved = 0;
+    ttff_saved_once = false;
+    ttff_skip_next = false;
+}
+
+void gnss_ttff_stats_note_start( gnss_start_type_t start_type )
+{
+    if( start_type < GNSS_START_TYPE_NUM )
+    {
+        ttff_start_type = start_type;
+    }
+}
+
+void gnss_ttff_stats_skip_next( void )
+{
+    ttff_skip_next = true;
+}
+
+void gnss_ttff_stats_record_acquisition( void )
+{
+    gnss_acq_stats_t acq;
+    gnss_ttff_hist_t *hist = NULL;
+    uint8_t quality = 0;
+    uint8_t sv_bucket = 0;
+    uint8_t bin = 0;
+    bool censored = false;
+
+    gnss_get_acq_stats( &acq );
+    hist = gnss_ttff_current_hist( &quality, &sv_bucket );
+
+    // A blocked sky or a predicted miss says nothing about how long this receiver needs for a fix,
+    // nor does a scan on a receiver that was already tracking
+    if( ttff_skip_next || acq.ble_abort || acq.sky_abort || acq.check_abort || acq.on_ms == 0 )
+    {
+        ttff_start_type = GNSS_START_COLD;
+        ttff_skip_next = false;
+        return;
+    }
+
+    // The scan ends on the first fix meeting the quality gates, that is the time it must budget for
+    if( acq.ttgf_ms != 0 )
+    {
+        bin = gnss_ttff_bin_index( acq.ttgf_ms );
+    }
+    else
+    {
+        // Censored: counted as a failure only, a longer scan is no more likely to fix
+        censored = true;
+    }
+
+    gnss_ttff_hist_add( hist, bin, censored );
+    ttff_unsaved++;
+
+    TTFF_TRACE_INFO( "GNSS TTFF sample: start=%u quality=%u sv_bucket=%u %s=%lu ms bin=%u fixes=%u censored=%u\n",
+                     ttff_start_type, quality, sv_bucket, censored ? "no fix in" : "TTGF",
+                     censored ? acq.on_ms : acq.ttgf_ms, bin, gnss_ttff_hist_total( hist ), hist->censored );
+
+    ttff_start_type = GNSS_START_COLD;
+    gnss_ttff_stats_save( false );
+}
+
+uint32_t gnss_ttff_stats_scan_budget_ms( uint32_t default_ms, uint32_t min_ms, uint32_t max_ms )
+{
+    uint8_t quality = 0;
+    uint8_t sv_bucket = 0;
+    const gnss_ttff_hist_t *hist = gnss_ttff_current_hist( &quality, &sv_bucket );
+    uint32_t budget_ms = gnss_ttff_hist_budget_ms( hist, max_ms );
+
+    if( budget_ms == 0 )
+    {
+        return default_ms;
+    }
+    if( budget_ms < min_ms ) budget_ms = min_ms;
+    if( budget_ms > max_ms ) budget_ms = max_ms;
+
+    // Mostly failing here: fall back to the default both ways. Longer would mostly be spent on fixes
+    // that do not come; shorter would never see the fixes it cuts off, and could not grow back
+    if( gnss_ttff_hist_failing( hist ))
+    {
+        budget_ms = default_ms;
+    }
+    return budget_ms;
+}
+
+void gnss_ttff_stats_get_context( gnss_ttff_context_info_t *info )
+{
+    const gnss_ttff_hist_t *hist = NULL;
+    uint8_t quality = 0;
+    uint8_t sv_bucket = 0;
+
+    if( info == NULL )
+    {
+        return;
+    }
+
+    hist = gnss_ttff_current_hist( &quality, &sv_bucket );
+    info->start_type = ttff_start_type;
+    info->quality = quality;
+    info->sv_bucket = sv_bucket;
+    info->samples = gnss_ttff_hist_total( hist );
+    info->censored = hist->censored;
+    info->budget_ms = gnss_ttff_hist_budget_ms( hist, UINT32_MAX );
+}
+
+bool gnss_ttff_stats_save( bool force )
+{
+    uint32_t now_s = hal_rtc_get_time_s( );
+
+    if( ttff_unsaved == 0 )
+    {
+        return false;
+    }
+    if( !force )
+    {
+        if( ttff_unsaved < REMEX_GNSS_TTFF_SAVE_SAMPLES )
+        {
+            return false;
+        }
+        if( ttff_saved_once && ( now_s - ttff_last_save_s ) < REMEX_GNSS_TTFF_SAVE_INTERVAL_S )
+        {
+            return false;
+        }
+    }
+
+    if( !write_fds_record( TTFF_FILE, TTFF_REC_KEY, &ttff_record, sizeof( ttff_record )))
+    {
+        TTFF_TRACE_INFO( "GNSS TTFF stats: save failed\n" );
+        return false;
+    }
+
+    TTFF_TRACE_INFO( "GNSS TTFF stats: saved %u new samples\n", ttff_unsaved );
+    ttff_unsaved = 0;
+    ttff_last_save_s = now_s;
+    ttff_saved_once = true;
+    return true;
+}
+
+void gnss_ttff_stats_clear( void )
+{
+    memset( &ttff_record, 0, sizeof( ttff_record ));
+    ttff_record.magic = GNSS_TTFF_RECORD_MAGIC;
+    ttff_unsaved = 1;
+    gnss_ttff_stats_save( true );
+}
@@ -1,9 +1,20 @@
 #include "log_filter.h"
 #include "smtc_hal_dbg_trace.h"
+#include "smtc_hal_usb_cdc.h"
+#include "default_config_settings.h"
 #include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 
+#ifndef REMEX_LOG_DEFERRED
+#define REMEX_LOG_DEFERRED 0
+#endif
+
+// Deferred records: format string address, then the raw arguments (see decode_tracker_log.py)
+#define LOG_FILTER_DEFERRED_SIZE    192
+#define LOG_FILTER_DEFERRED_KEY     'D'
+#define LOG_FILTER_FLASH_END        0x00100000UL    // only strings in flash can be found in the ELF
+
 typedef struct
 {
     char key;
@@ -20,6 +31,8 @@ static log_filter_state_t log_filters[LOG_FILTER_COUNT] = {
     [LOG_FILTER_WIFI] = { 'W', "WIFI", "WIFI: ", true },
 };
 
+static bool log_filter_deferred = ( REMEX_LOG_DEFERRED != 0 );
+
 static bool log_filter_has_prefix( const char* text, const char* prefix )
 {
     return strncmp( text, prefix, strlen( prefix ) ) == 0;
@@ -45,9 +58,149 @@ static void log_filter_print_status( void )
     {
         PRINTF( " %c=%s", log_filters[i].key, log_filters[i].enabled ? "ON" : "OFF" );
     }
+    PRINTF( " %c=%s", LOG_FILTER_DEFERRED_KEY, log_filter_deferred ? "ON" : "OFF" );
     PRINTF( "\r\n" );
 }
 
+static bool log_filter_put( uint8_t* out, uint16_t* len, const void* data, uint16_t size )
+{
+    if( *len + size > LOG_FILTER_DEFERRED_SIZE )
+    {
+        return false;
+    }
+    memcpy( &out[*len], data, size );
+    *len += size;
+    return true;
+}
+
+/*
+ * Pack the format string address and the arguments it consumes, the way the
+ * host decoder reads them back: 32-bit integers and pointers, 64-bit for ll
+ * and doubles, strings as a length byte and their characters. Returns 0 when
+ * the line must be formatted on the device instead.
+ */
+static uint16_t log_filter_pack( uint8_t* out, const char* fmt, va_list args )
+{
+    uint32_t addr = ( uint32_t )( uintptr_t )fmt;
+    uint16_t len  = 0;
+
+    if( addr >= LOG_FILTER_FLASH_END )
+    {
+        return 0;
+    }
+    log_filter_put( out, &len, &addr, sizeof( addr ) );
+
+    for( const char* p = fmt; *p != '\0'; p++ )
+    {
+        uint8_t longs = 0;
+        bool    ok    = true;
+
+        if( *p != '%' )
+        {
+            continue;
+        }
+        p++;
+        if( *p == '%' )
+        {
+            continue;
+        }
+
+        while( *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' )
+        {
+            p++;
+        }
+        for( uint8_t field = 0; field < 2; field++ )
+        {
+            if( *p == '*' )
+            {
+                int32_t v = va_arg( args, int );
+                ok = ok && log_filter_put( out, &len, &v, sizeof( v ) );
+                p++;
+            }
+            while( isdigit( ( unsigned char )*p ) )
+            {
+                p++;
+            }
+            if( field == 0 && *p == '.' )
+            {
+                p++;
+            }
+            else
+            {
+                break;
+            }
+        }
+        while( *p == 'l' || *p == 'h' || *p == 'z' || *p == 't' || *p == 'j' )
+        {
+            longs += ( *p == 'l' );
+            p++;
+        }
+
+        switch( *p )
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            if( longs >= 2 )
+            {
+                uint64_t v = va_arg( args, uint64_t );
+                ok = ok && log_filter_put( out, &len, &v, sizeof( v ) );
+            }
+            else
+            {
+                uint32_t v = va_arg( args, uint32_t );
+                ok = ok && log_filter_put( out, &len, &v, sizeof( v ) );
+            }
+            break;
+        case 'p':
+        {
+            uint32_t v = ( uint32_t )( uintptr_t )va_arg( args, void* );
+            ok = ok && log_filter_put( out, &len, &v, sizeof( v ) );
+            break;
+        }
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        {
+            double v = va_arg( args, double );
+            ok = ok && log_filter_put( out, &len, &v, sizeof( v ) );
+            break;
+        }
+        case 's':
+        {
+            const char* s = va_arg( args, const char* );
+            size_t      n = ( s != NULL ) ? strlen( s ) : 0;
+            uint8_t     n8;
+
+            if( s == NULL )
+            {
+                s = "(null)";
+                n = 6;
+            }
+            n8 = ( n > UINT8_MAX ) ? UINT8_MAX : ( uint8_t )n;
+            ok = ok && log_filter_put( out, &len, &n8, 1 ) && log_filter_put( out, &len, s, n8 );
+            break;
+        }
+        default:
+            // %n, %a or a truncated spec
+            return 0;
+        }
+
+        if( !ok )
+        {
+            return 0;
+        }
+    }
+    return len;
+}
+
 bool log_filter_is_enabled( log_filter_category_t category )
 {
     if( category >= LOG_FILTER_COUNT )
@@ -63,33 +216,67 @@ void log_filter_vprintf( log_filter_category_t category, const char* fmt, va_lis
     {
         return;
     }
+    if( !hal_usb_cdc_is_connected( ) )
+    {
+        return;
+    }
+
+    // Deferred: no formatting here, the host expands the record, adds the prefix and drops blank fragments
+    if( log_filter_deferred )
+    {
+        uint8_t  record[LOG_FILTER_DEFERRED_SIZE];
+        uint16_t record_len;
+        va_list  copy;
 
-    char line[256];
-    vsnprintf( line, sizeof( line ), fmt, args );
+        va_copy( copy, args );
+        record_len = log_filter_pack( record, fmt, copy );
+        va_end( copy );
+        if( record_len > 0 )
+        {
+            hal_trace_write_binary( category, record, record_len );
+            return;
+        }
+    }
+
+    // Format once, right after room for the prefix, and queue prefix and text as one record
+    const char* prefix     = log_filters[category].prefix;
+    const size_t prefix_len = strlen( prefix );
+    char   line[256];
+    char*  text = &line[prefix_len];
+    int    len  = vsnprintf( text, sizeof( line ) - prefix_len, fmt, args );
+
+    if( len <= 0 )
+    {
+        return;
+    }
+    if( len >= ( int )( sizeof( line ) - prefix_len ) )
+    {
+        len = sizeof( line ) - prefix_len - 1;
+    }
 
     // Semtech radio-planner traces sometimes write indentation or reset colors as
     // separate fragments. Suppress those by themselves so the next real RF line
     // gets the LORA tag cleanly.
-    if( line[0] == '\0' || log_filter_is_blank_fragment( line ) )
+    if( log_filter_is_blank_fragment( text ) )
     {
         return;
     }
-    if(( category == LOG_FILTER_LORA ) && ( strcmp( line, "LORA: " ) == 0 ))
+    if(( category == LOG_FILTER_LORA ) && ( strcmp( text, "LORA: " ) == 0 ))
     {
         return;
     }
 
-    const char* prefix = log_filters[category].prefix;
-    if( log_filter_has_prefix( line, prefix ) ||
-        ( category == LOG_FILTER_LORA && log_filter_has_prefix( line, "LORA:" ) ) ||
-        ( category == LOG_FILTER_NMEA && log_filter_has_prefix( line, "[NMEA]" ) ) ||
-        ( category == LOG_FILTER_GNSS && log_filter_has_prefix( line, "GNSS:" ) ) )
+    if( log_filter_has_prefix( text, prefix ) ||
+        ( category == LOG_FILTER_LORA && log_filter_has_prefix( text, "LORA:" ) ) ||
+        ( category == LOG_FILTER_NMEA && log_filter_has_prefix( text, "[NMEA]" ) ) ||
+        ( category == LOG_FILTER_GNSS && log_filter_has_prefix( text, "GNSS:" ) ) )
     {
-        PRINTF( "%s", line );
+        hal_trace_write( category, text, len );
     }
     else
     {
-        PRINTF( "%s%s", prefix, line );
+        memcpy( line, prefix, prefix_len );
+        hal_trace_write( category, line, prefix_len + len );
     }
 }
 
@@ -101,6 +288,16 @@ void log_filter_printf( log_filter_category_t category, const char* fmt, ... )
     va_end( args );
 }
 
+bool log_filter_is_deferred( void )
+{
+    return log_filter_deferred;
+}
+
+void log_filter_set_deferred( bool enable )
+{
+    log_filter_deferred = enable;
+}
+
 bool log_filter_handle_serial_char( uint8_t ch )
 {
     if( ch == '?' )
@@ -110,6 +307,12 @@ bool log_filter_handle_serial_char( uint8_t ch )
     }
 
     const char key = ( char )toupper( ch );
+    if( key == LOG_FILTER_DEFERRED_KEY )
+    {
+        log_filter_deferred = !log_filter_deferred;
+        PRINTF( "\r\nLOG FILTER: DEFERRED %s\r\n", log_filter_deferred ? "ON" : "OFF" );
+        return true;
+    }
     for( uint8_t i = 0; i < LOG_FILTER_COUNT; i++ )
     {
         if( key == log_filters[i].key )
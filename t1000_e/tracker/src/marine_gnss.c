@@ -16,6 +16,9 @@
 #include "ag3335.h"
 #include "sensor.h"
 #include "gateway_assistance.h"
+#include "gnss_ttff_stats.h"
+#include "gnss_fix_predict.h"
+#include "mob_drift.h"
 #include "app_ble_all.h"
 #include "main_lorawan_tracker_api.h"
 #include "default_config_settings.h"
@@ -48,6 +51,7 @@ extern uint32_t ble_scan_duration;
 #define MOB_PAYLOAD_FLAG_ON_CHARGE  0x80    // ORed into mode byte for FPort 6 MOB records
 #define MOB_QUALITY_FLAG_ON_CHARGE  0x04    // Position quality flag metadata
 #define MOB_QUALITY_FLAG_VECTOR     0x08    // COG/SOG extension is firmware-derived and valid
+#define MOB_QUALITY_FLAG_PREDICTION 0x10    // Track prediction extension is valid
 #define MOB_CANCEL_FLAG_ON_CHARGE   0x01    // Optional cancellation flags byte metadata
 
 /*
@@ -55,66 +59,59 @@ extern uint32_t ble_scan_duration;
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
-#define MOB_DRIFT_EARTH_RADIUS_M        6371000.0f
-#define MOB_DRIFT_DEG_TO_RAD            0.01745329251994329577f
-#define MOB_DRIFT_RAD_TO_DEG            57.295779513082320876f
-#define MOB_DRIFT_UNKNOWN_COG_X2        0xFFFFU
-#define MOB_DRIFT_UNKNOWN_SOG_DMPS      0xFFU
-#define MOB_DRIFT_SATURATED_SOG_DMPS    0xFEU
-
-#if REMEX_PIW_DRIFT_FIX_WINDOW < REMEX_PIW_DRIFT_MIN_FIXES
-#error "REMEX_PIW_DRIFT_FIX_WINDOW must be >= REMEX_PIW_DRIFT_MIN_FIXES"
-#endif
+#define MOB_FIX_MAX_AGE_MS              5000    // Burst fixes older than this are not reported as current
+#define MOB_TRACK_RADIUS95_SCALE        2.45f   // sqrt(chi2(2 DOF, 95%)), 1-sigma to 95% circle
+#define MOB_TRACK_UNKNOWN_RADIUS_M      0xFFFFU
+#define MOB_TRACK_SATURATED_RADIUS_M    0xFFFEU
 
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
  */
 
+/*
+ * One axis of the constant-velocity track: position, velocity and their
+ * symmetric 2x2 covariance.
+ */
 typedef struct
 {
-    bool     valid;
-    int32_t  latitude;
-    int32_t  longitude;
-    float    hdop;
-    float    hacc;
-    uint32_t timestamp_s;
-    float    sigma_m;
-} mob_drift_fix_t;
+    float    pos_m;
+    float    vel_mps;
+    float    p_pp;
+    float    p_pv;
+    float    p_vv;
+} mob_track_axis_t;
 
+/*
+ * Kalman track over every MOB/PIW fix. East and north are filtered
+ * independently in a local frame anchored on the fix that started the track.
+ */
 typedef struct
 {
-    bool     valid;
-    uint16_t cog_x2;
-    uint8_t  sog_dmps;
-    float    east_mps;
-    float    north_mps;
-    float    sog_mps;
-    uint8_t  fix_count;
-    uint8_t  used_count;
-    uint8_t  rejected_count;
-    uint32_t baseline_s;
-    float    rms_residual_m;
-} mob_drift_vector_t;
+    bool             valid;
+    int32_t          ref_latitude;
+    int32_t          ref_longitude;
+    float            north_m_per_udeg;
+    float            east_m_per_udeg;
+    uint32_t         t_ms;           // time the state refers to, epoch of the last fix
+    uint32_t         epoch_ms;       // gnss_fix_t timestamp of the last fix fed
+    uint8_t          rejects;        // consecutive fixes refused by the innovation gate
+    uint16_t         updates;
+    mob_track_axis_t east;
+    mob_track_axis_t north;
+} mob_track_t;
 
 typedef struct
 {
     bool     valid;
-    float    east0_m;
-    float    north0_m;
+    int32_t  latitude;
+    int32_t  longitude;
+    float    east_m;                 // in the track frame
+    float    north_m;
     float    east_mps;
     float    north_mps;
-    float    ref_lat_rad;
-    float    ref_lon_rad;
-    uint32_t t0_s;
-    uint32_t t_first_s;
-    uint32_t t_last_s;
-    uint32_t baseline_s;
-    uint8_t  fix_count;
-    uint8_t  used_count;
-    uint8_t  rejected_count;
-    float    rms_residual_m;
-} mob_drift_fit_t;
+    float    radius_m;               // 95% horizontal radius
+} mob_track_prediction_t;
 
 /*
  * -----------------------------------------------------------------------------
@@ -135,10 +132,7 @@ static bool gnss_continuous_active = false;
 
 // Stack ID for LoRaWAN operations
 static const uint8_t stack_id = 0;
-static mob_drift_fix_t drift_fixes[REMEX_PIW_DRIFT_FIX_WINDOW];
-static uint8_t drift_fix_next = 0;
-static uint8_t drift_fix_count = 0;
-static mob_drift_vector_t drift_vector;
+static mob_track_t track;
 
 /*
  * -----------------------------------------------------------------------------
@@ -148,7 +142,10 @@ static mob_drift_vector_t drift_vector;
 static void mob_update_elapsed( void );
 static mob_tracker_mode_t mob_get_mode_for_elapsed( uint32_t elapsed_s );
 static uint32_t mob_get_interval_for_mode( mob_tracker_mode_t mode );
+static app_mob_dr_policy_t mob_position_policy( void );
 static bool mob_send_position_uplink( const gnss_fix_t *fix, bool quality_ok, bool confirmed );
+static uint32_t mob_duty_cycle_wait_s( void );
+static bool mob_double_uplink_fits( void );
 static bool mob_send_position_with_policy( const gnss_fix_t *fix, bool quality_ok, bool confirmed,
                                            app_mob_dr_policy_t policy );
 static void mob_send_cancellation_uplink( void );
@@ -157,10 +154,11 @@ static void mob_send_no_fix_with_policy( app_mob_dr_policy_t policy );
 static uint32_t mob_process_burst( void );
 static uint32_t mob_process_piw( void );
 static void mob_run_ble_scan( void );
-static void mob_drift_reset( void );
 static void mob_drift_update( const gnss_fix_t *fix );
-static bool mob_drift_get_vector( uint16_t *cog_x2, uint8_t *sog_dmps );
-static bool mob_drift_fit_history( const mob_drift_fit_t *reject_fit, mob_drift_fit_t *fit );
+static void mob_track_reset( void );
+static void mob_track_update( const gnss_fix_t *fix );
+static bool mob_track_predict( uint32_t now_ms, mob_track_prediction_t *prediction );
+static bool mob_piw_scan_check( uint32_t elapsed_ms, uint32_t max_ms, const gnss_sky_metrics_t *sky );
 
 static bool initial_burst_sent = false;
 
@@ -175,6 +173,7 @@ void mob_tracker_init( void )
     tracker_state.mode = MOB_MODE_IDLE;
     gnss_continuous_active = false;
     mob_drift_reset( );
+    mob_track_reset( );
     
     MOB_TRACE_INFO( "MOB/PIW tracker initialized\n" );
 }
@@ -196,6 +195,7 @@ bool mob_tracker_activate( void )
     tracker_state.elapsed_s = 0;
     gnss_continuous_active = false;
     mob_drift_reset( );
+    mob_track_reset( );
     
     MOB_TRACE_INFO( "========================================\n" );
     MOB_TRACE_INFO( "MOB ACTIVATED - Entering BURST mode\n" );
@@ -248,6 +248,9 @@ void mob_tracker_cancel( void )
     
     // Send cancellation uplink
     mob_send_cancellation_uplink( );
+
+    // Keep what this event taught about time to fix
+    gnss_ttff_stats_save( true );
     
     // Update state
     tracker_state.mode = MOB_MODE_CANCELLED;
@@ -320,6 +323,13 @@ uint32_t mob_tracker_process( void )
         return 60;
     }
     
+    // Nothing could go out before the duty cycle frees up: come back at the first legal slot, a fresher fix included
+    uint32_t dtc_wait_s = mob_duty_cycle_wait_s( );
+    if( dtc_wait_s > 0 )
+    {
+        return dtc_wait_s;
+    }
+
     // Process based on current mode
     uint32_t next_delay;
     if( tracker_state.mode == MOB_MODE_BURST )
@@ -330,6 +340,11 @@ uint32_t mob_tracker_process( void )
     {
         next_delay = mob_process_piw( );
     }
+
+    hal_mcu_wait_stats_t wait_stats;
+    hal_mcu_get_wait_stats( &wait_stats );
+    MOB_TRACE_INFO( "Delays since boot: %lu ms asleep, %lu ms spinning, %lu wake-ups\n",
+                    wait_stats.sleep_ms, wait_stats.busy_ms, wait_stats.wakeups );
     
     return next_delay;
 }
@@ -401,339 +416,253 @@ static uint32_t mob_get_interval_for_mode( mob_tracker_mode_t mode )
     }
 }
 
-static void mob_drift_reset( void )
-{
-    memset( drift_fixes, 0, sizeof( drift_fixes ));
-    drift_fix_next = 0;
-    drift_fix_count = 0;
-    memset( &drift_vector, 0, sizeof( drift_vector ));
-    drift_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
-    drift_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
-}
-
-static float mob_drift_clamp_sigma_m( float sigma_m )
+static void mob_drift_update( const gnss_fix_t *fix )
 {
-    if( sigma_m < REMEX_PIW_DRIFT_SIGMA_FLOOR_M )
-    {
-        return REMEX_PIW_DRIFT_SIGMA_FLOOR_M;
-    }
-
-    if( sigma_m > REMEX_PIW_DRIFT_SIGMA_CEILING_M )
+    if( tracker_state.mode == MOB_MODE_BURST || fix == NULL || !fix->valid )
     {
-        return REMEX_PIW_DRIFT_SIGMA_CEILING_M;
+        return;
     }
 
-    return sigma_m;
-}
-
-static float mob_drift_estimate_sigma_m( const gnss_fix_t *fix )
-{
     /*
-     * sigma_m is the estimated 1-sigma horizontal position error used for
-     * weighting. Poor fixes are not discarded here; they are kept with lower
-     * weight so an older marginal fix can still improve velocity over a long
-     * baseline.
+     * Time-tag the sample with its GNSS epoch, not the uplink time, so a re-sent fix keeps its real age. The epoch
+     * is taken back from the fix age onto the RTC seconds the rest of the drift model uses: the raw millisecond
+     * timestamp would wrap after 49.7 days.
      */
-    if( fix->hacc > 0.0f && fix->hacc < 1000.0f )
-    {
-        return mob_drift_clamp_sigma_m( fix->hacc );
-    }
-
-    if( fix->hdop > 0.0f && fix->hdop < 99.0f )
-    {
-        return mob_drift_clamp_sigma_m( fix->hdop * REMEX_PIW_DRIFT_UERE_M );
-    }
-
-    return REMEX_PIW_DRIFT_SIGMA_CEILING_M;
+    uint32_t epoch_s = ( fix->timestamp_ms != 0 ) ? hal_rtc_get_time_s( ) - gnss_fix_age_ms( fix ) / 1000
+                                                  : hal_rtc_get_time_s( );
+    mob_drift_add_fix( fix, epoch_s );
 }
 
-static uint8_t mob_drift_collect_fixes( mob_drift_fix_t *ordered )
+static void mob_track_reset( void )
 {
-    uint8_t count = 0;
-    if( ordered == NULL )
-    {
-        return 0;
-    }
-
-    for( uint8_t i = 0; i < drift_fix_count; i++ )
-    {
-        uint8_t index = ( drift_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - drift_fix_count + i ) %
-                        REMEX_PIW_DRIFT_FIX_WINDOW;
-        if( drift_fixes[index].valid )
-        {
-            ordered[count++] = drift_fixes[index];
-        }
-    }
+    memset( &track, 0, sizeof( track ));
+}
 
-    return count;
+static void mob_track_axis_start( mob_track_axis_t *axis, float pos_m, float r_m2 )
+{
+    axis->pos_m = pos_m;
+    axis->vel_mps = 0.0f;
+    axis->p_pp = r_m2;
+    axis->p_pv = 0.0f;
+    axis->p_vv = REMEX_PIW_TRACK_INIT_SPEED_SIGMA_MPS * REMEX_PIW_TRACK_INIT_SPEED_SIGMA_MPS;
 }
 
-static void mob_drift_local_xy_m( const mob_drift_fix_t *fix, float ref_lat_rad, float ref_lon_rad,
-                                  float *east_m, float *north_m )
+static void mob_track_axis_predict( mob_track_axis_t *axis, float dt_s )
 {
-    float lat_rad = ((float) fix->latitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
-    float lon_rad = ((float) fix->longitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
-    float mean_lat = ( lat_rad + ref_lat_rad ) * 0.5f;
+    /*
+     * x' = F x, P' = F P F^T + Q with F = [1 dt; 0 1] and the continuous
+     * white-acceleration Q = q * [dt^3/3 dt^2/2; dt^2/2 dt].
+     */
+    float q = REMEX_PIW_TRACK_ACCEL_PSD;
+    float dt2 = dt_s * dt_s;
 
-    *east_m = ( lon_rad - ref_lon_rad ) * cosf( mean_lat ) * MOB_DRIFT_EARTH_RADIUS_M;
-    *north_m = ( lat_rad - ref_lat_rad ) * MOB_DRIFT_EARTH_RADIUS_M;
+    axis->pos_m += axis->vel_mps * dt_s;
+    axis->p_pp += ( 2.0f * dt_s * axis->p_pv ) + ( dt2 * axis->p_vv ) + ( q * dt2 * dt_s / 3.0f );
+    axis->p_pv += ( dt_s * axis->p_vv ) + ( q * dt2 / 2.0f );
+    axis->p_vv += q * dt_s;
 }
 
-static float mob_drift_fit_residual_m( const mob_drift_fit_t *fit, const mob_drift_fix_t *fix )
+static void mob_track_axis_correct( mob_track_axis_t *axis, float innovation_m, float s_m2 )
 {
-    float east_m = 0.0f;
-    float north_m = 0.0f;
-    float dt_s = (float)( fix->timestamp_s - fit->t0_s );
-    mob_drift_local_xy_m( fix, fit->ref_lat_rad, fit->ref_lon_rad, &east_m, &north_m );
-
-    float east_residual = east_m - ( fit->east0_m + ( fit->east_mps * dt_s ));
-    float north_residual = north_m - ( fit->north0_m + ( fit->north_mps * dt_s ));
-    return sqrtf(( east_residual * east_residual ) + ( north_residual * north_residual ));
+    float k_p = axis->p_pp / s_m2;
+    float k_v = axis->p_pv / s_m2;
+
+    axis->pos_m += k_p * innovation_m;
+    axis->vel_mps += k_v * innovation_m;
+    axis->p_vv -= k_v * axis->p_pv;
+    axis->p_pv -= k_p * axis->p_pv;
+    axis->p_pp -= k_p * axis->p_pp;
 }
 
-static bool mob_drift_fit_history( const mob_drift_fit_t *reject_fit, mob_drift_fit_t *fit )
+static void mob_track_start( const gnss_fix_t *fix, uint32_t t_ms, float r_m2 )
 {
-    /*
-     * Weighted straight-line fit in local east/north meters:
-     *   east(t)  = east0  + east_mps  * t
-     *   north(t) = north0 + north_mps * t
-     *
-     * First pass: reject_fit == NULL, use every valid fix with 1/sigma^2 weight.
-     * Second pass: reject fixes whose residual from the first-pass track exceeds
-     * the configurable sigma gate, then fit again. This makes outlier rejection
-     * track-relative instead of previous-fix-relative.
-     */
-    mob_drift_fix_t fixes[REMEX_PIW_DRIFT_FIX_WINDOW];
-    uint8_t total_count = mob_drift_collect_fixes( fixes );
+    float ref_lat_rad = ((float) fix->latitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
+
+    track.ref_latitude = fix->latitude;
+    track.ref_longitude = fix->longitude;
+    track.north_m_per_udeg = MOB_DRIFT_EARTH_RADIUS_M * MOB_DRIFT_DEG_TO_RAD / 1000000.0f;
+    track.east_m_per_udeg = track.north_m_per_udeg * cosf( ref_lat_rad );
+    track.t_ms = t_ms;
+    track.rejects = 0;
+    track.updates = 1;
+    mob_track_axis_start( &track.east, 0.0f, r_m2 );
+    mob_track_axis_start( &track.north, 0.0f, r_m2 );
+    track.valid = true;
+}
 
-    if( fit == NULL || total_count < REMEX_PIW_DRIFT_MIN_FIXES )
+static void mob_track_update( const gnss_fix_t *fix )
+{
+    if( fix == NULL || !fix->valid )
     {
-        return false;
+        return;
     }
 
-    memset( fit, 0, sizeof( *fit ));
-    fit->fix_count = total_count;
-    fit->t0_s = fixes[0].timestamp_s;
-    fit->ref_lat_rad = ((float) fixes[0].latitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
-    fit->ref_lon_rad = ((float) fixes[0].longitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
+    uint32_t t_ms = ( fix->timestamp_ms != 0 ) ? fix->timestamp_ms : hal_rtc_get_time_ms( );
+    float sigma_m = mob_drift_sigma_m( fix );
+    float r_m2 = sigma_m * sigma_m;
 
-    float sw = 0.0f;
-    float swt = 0.0f;
-    float swtt = 0.0f;
-    float swe = 0.0f;
-    float swn = 0.0f;
-    float swte = 0.0f;
-    float swtn = 0.0f;
-
-    for( uint8_t i = 0; i < total_count; i++ )
+    /* Double uplinks and the PIW last-fix fallback resend the same epoch; filter it once. */
+    if( track.valid && fix->timestamp_ms != 0 && fix->timestamp_ms == track.epoch_ms )
     {
-        float residual_m = 0.0f;
-        bool use_fix = true;
-
-        if( reject_fit != NULL && reject_fit->valid )
-        {
-            residual_m = mob_drift_fit_residual_m( reject_fit, &fixes[i] );
-            float allowed_m = ( fixes[i].sigma_m * REMEX_PIW_DRIFT_OUTLIER_SIGMA ) +
-                              REMEX_PIW_DRIFT_OUTLIER_MARGIN_M;
-            use_fix = residual_m <= allowed_m;
-        }
-
-        if( !use_fix )
-        {
-            fit->rejected_count++;
-            continue;
-        }
-
-        float east_m = 0.0f;
-        float north_m = 0.0f;
-        float t_s = (float)( fixes[i].timestamp_s - fit->t0_s );
-        float sigma_m = fixes[i].sigma_m;
-        float w = 1.0f / ( sigma_m * sigma_m );
-
-        mob_drift_local_xy_m( &fixes[i], fit->ref_lat_rad, fit->ref_lon_rad, &east_m, &north_m );
-
-        if( fit->used_count == 0 )
-        {
-            fit->t_first_s = fixes[i].timestamp_s;
-        }
-        fit->t_last_s = fixes[i].timestamp_s;
-        fit->used_count++;
-
-        sw += w;
-        swt += w * t_s;
-        swtt += w * t_s * t_s;
-        swe += w * east_m;
-        swn += w * north_m;
-        swte += w * t_s * east_m;
-        swtn += w * t_s * north_m;
+        return;
     }
+    track.epoch_ms = fix->timestamp_ms;
 
-    if( fit->used_count < REMEX_PIW_DRIFT_MIN_FIXES )
+    if( !track.valid )
     {
-        return false;
+        mob_track_start( fix, t_ms, r_m2 );
+        MOB_TRACE_INFO( "PIW track: started, sigma=%.1f m\n", sigma_m );
+        return;
     }
 
-    float denom = ( sw * swtt ) - ( swt * swt );
-    if( denom <= 0.0001f )
+    float dt_s = (float)((int32_t)( t_ms - track.t_ms )) / 1000.0f;
+    if( dt_s < 0.0f )
     {
-        return false;
+        return;
     }
 
-    fit->east_mps = (( sw * swte ) - ( swt * swe )) / denom;
-    fit->north_mps = (( sw * swtn ) - ( swt * swn )) / denom;
-    fit->east0_m = ( swe - ( fit->east_mps * swt )) / sw;
-    fit->north0_m = ( swn - ( fit->north_mps * swt )) / sw;
-    fit->baseline_s = fit->t_last_s - fit->t_first_s;
+    mob_track_axis_predict( &track.east, dt_s );
+    mob_track_axis_predict( &track.north, dt_s );
+    track.t_ms = t_ms;
 
-    float residual_sq_sum = 0.0f;
-    uint8_t residual_count = 0;
-    for( uint8_t i = 0; i < total_count; i++ )
+    float east_m = (float)( fix->longitude - track.ref_longitude ) * track.east_m_per_udeg;
+    float north_m = (float)( fix->latitude - track.ref_latitude ) * track.north_m_per_udeg;
+    float east_innovation = east_m - track.east.pos_m;
+    float north_innovation = north_m - track.north.pos_m;
+    float east_s = track.east.p_pp + r_m2;
+    float north_s = track.north.p_pp + r_m2;
+    float d2 = (( east_innovation * east_innovation ) / east_s ) + (( north_innovation * north_innovation ) / north_s );
+
+    if( d2 > REMEX_PIW_TRACK_GATE_CHI2 )
     {
-        if( reject_fit != NULL && reject_fit->valid )
+        /* The predicted state is kept; a run of refused fixes means the track itself is wrong. */
+        if( ++track.rejects >= REMEX_PIW_TRACK_RESET_REJECTS )
         {
-            float residual_m = mob_drift_fit_residual_m( reject_fit, &fixes[i] );
-            float allowed_m = ( fixes[i].sigma_m * REMEX_PIW_DRIFT_OUTLIER_SIGMA ) +
-                              REMEX_PIW_DRIFT_OUTLIER_MARGIN_M;
-            if( residual_m > allowed_m )
-            {
-                continue;
-            }
+            MOB_TRACE_WARNING( "PIW track: %u fixes gated, restarting\n", track.rejects );
+            mob_track_start( fix, t_ms, r_m2 );
         }
+        else
+        {
+            MOB_TRACE_INFO( "PIW track: fix gated, d2=%.1f innovation=%.0f m\n", d2,
+                            sqrtf(( east_innovation * east_innovation ) + ( north_innovation * north_innovation )));
+        }
+        return;
+    }
+
+    mob_track_axis_correct( &track.east, east_innovation, east_s );
+    mob_track_axis_correct( &track.north, north_innovation, north_s );
+    track.rejects = 0;
+    track.updates++;
 
-        float residual_m = mob_drift_fit_residual_m( fit, &fixes[i] );
-        residual_sq_sum += residual_m * residual_m;
-        residual_count++;
+    float speed_mps = sqrtf(( track.east.vel_mps * track.east.vel_mps ) + ( track.north.vel_mps * track.north.vel_mps ));
+    if( speed_mps > REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS )
+    {
+        float scale = REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS / speed_mps;
+        track.east.vel_mps *= scale;
+        track.north.vel_mps *= scale;
     }
 
-    fit->rms_residual_m = residual_count > 0 ? sqrtf( residual_sq_sum / (float) residual_count ) : 0.0f;
-    fit->valid = true;
-    return true;
+    MOB_TRACE_INFO( "PIW track: updates=%u pos=(%.1f, %.1f) m vel=(%.2f, %.2f) m/s sigma=%.1f m\n",
+                    track.updates, track.east.pos_m, track.north.pos_m,
+                    track.east.vel_mps, track.north.vel_mps,
+                    sqrtf(( track.east.p_pp + track.north.p_pp ) / 2.0f ));
 }
 
-static void mob_drift_update( const gnss_fix_t *fix )
+static bool mob_track_predict( uint32_t now_ms, mob_track_prediction_t *prediction )
 {
-    if( tracker_state.mode == MOB_MODE_BURST || fix == NULL || !fix->valid )
+    memset( prediction, 0, sizeof( *prediction ));
+    if( !track.valid )
     {
-        return;
+        return false;
     }
 
-    uint32_t now_s = hal_rtc_get_time_s( );
-    /* PIW sends a double uplink from the same GNSS result; keep only one sample. */
-    if( drift_fix_count > 0 )
+    int32_t dt_ms = (int32_t)( now_ms - track.t_ms );
+    if( dt_ms < 0 )
     {
-        uint8_t last_index = ( drift_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
-        if( drift_fixes[last_index].valid &&
-            drift_fixes[last_index].latitude == fix->latitude &&
-            drift_fixes[last_index].longitude == fix->longitude &&
-            ( now_s - drift_fixes[last_index].timestamp_s ) < REMEX_PIW_DRIFT_DUPLICATE_FIX_S )
-        {
-            return;
-        }
+        dt_ms = 0;
     }
-
-    drift_fixes[drift_fix_next].valid = true;
-    drift_fixes[drift_fix_next].latitude = fix->latitude;
-    drift_fixes[drift_fix_next].longitude = fix->longitude;
-    drift_fixes[drift_fix_next].hdop = fix->hdop;
-    drift_fixes[drift_fix_next].hacc = fix->hacc;
-    drift_fixes[drift_fix_next].timestamp_s = now_s;
-    drift_fixes[drift_fix_next].sigma_m = mob_drift_estimate_sigma_m( fix );
-    drift_fix_next = ( drift_fix_next + 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
-    if( drift_fix_count < REMEX_PIW_DRIFT_FIX_WINDOW )
+    if( dt_ms > REMEX_PIW_TRACK_MAX_PREDICT_S * 1000 )
     {
-        drift_fix_count++;
+        return false;
     }
 
-    mob_drift_fit_t provisional_fit;
-    mob_drift_fit_t robust_fit;
-    /* Fit once to define the recent track, then fit again after residual gating. */
-    if( !mob_drift_fit_history( NULL, &provisional_fit ) ||
-        !mob_drift_fit_history( &provisional_fit, &robust_fit ))
-    {
-        return;
-    }
+    /* Dead-reckon a copy, the filter state itself only moves on fixes. */
+    mob_track_axis_t east = track.east;
+    mob_track_axis_t north = track.north;
+    mob_track_axis_predict( &east, (float) dt_ms / 1000.0f );
+    mob_track_axis_predict( &north, (float) dt_ms / 1000.0f );
+
+    prediction->east_m = east.pos_m;
+    prediction->north_m = north.pos_m;
+    prediction->east_mps = east.vel_mps;
+    prediction->north_mps = north.vel_mps;
+    prediction->radius_m = MOB_TRACK_RADIUS95_SCALE * sqrtf(( east.p_pp + north.p_pp ) / 2.0f );
+    prediction->latitude = track.ref_latitude + (int32_t) lroundf( north.pos_m / track.north_m_per_udeg );
+    prediction->longitude = track.ref_longitude + (int32_t) lroundf( east.pos_m / track.east_m_per_udeg );
+    prediction->valid = true;
+    return true;
+}
 
-    float sog_mps = sqrtf(( robust_fit.east_mps * robust_fit.east_mps ) +
-                          ( robust_fit.north_mps * robust_fit.north_mps ));
-    float track_span_m = sog_mps * (float) robust_fit.baseline_s;
-    /*
-     * A vector is only emitted once the fitted history covers enough time and
-     * movement to make COG meaningful. This is a track-level gate, not a
-     * point-to-point distance gate, so older poorer fixes can still help.
-     */
-    if( robust_fit.baseline_s < REMEX_PIW_DRIFT_MIN_BASELINE_S ||
-        track_span_m < REMEX_PIW_DRIFT_MIN_TRACK_SPAN_M ||
-        sog_mps > REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS )
+static uint16_t mob_track_radius_encode( float radius_m )
+{
+    if( radius_m >= (float) MOB_TRACK_SATURATED_RADIUS_M )
     {
-        drift_vector.valid = false;
-        drift_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
-        drift_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
-        return;
+        return MOB_TRACK_SATURATED_RADIUS_M;
     }
 
-    float cog_deg = atan2f( robust_fit.east_mps, robust_fit.north_mps ) * MOB_DRIFT_RAD_TO_DEG;
-    if( cog_deg < 0.0f )
-    {
-        cog_deg += 360.0f;
-    }
+    return (uint16_t)( radius_m + 0.5f );
+}
 
-    uint16_t cog_x2 = (uint16_t)( cog_deg * 2.0f + 0.5f );
-    if( cog_x2 >= 720U )
+static app_mob_dr_policy_t mob_position_policy( void )
+{
+    /* BURST favors temporal density at max DR; PHASE3 mostly persists but periodically probes minimum DR. */
+    if( tracker_state.mode == MOB_MODE_BURST )
     {
-        cog_x2 = 0;
+        return APP_MOB_DR_MAX;
     }
-
-    uint16_t sog_dmps = (uint16_t)( sog_mps * 10.0f + 0.5f );
-    if( sog_dmps >= MOB_DRIFT_SATURATED_SOG_DMPS )
+    else if( tracker_state.mode == MOB_MODE_PIW_PHASE3 )
     {
-        sog_dmps = MOB_DRIFT_SATURATED_SOG_DMPS;
+        return APP_MOB_DR_PHASE3_ALTERNATING;
     }
+    return APP_MOB_DR_PERSISTENCE;
+}
 
-    drift_vector.valid = true;
-    drift_vector.cog_x2 = cog_x2;
-    drift_vector.sog_dmps = (uint8_t) sog_dmps;
-    drift_vector.east_mps = robust_fit.east_mps;
-    drift_vector.north_mps = robust_fit.north_mps;
-    drift_vector.sog_mps = sog_mps;
-    drift_vector.fix_count = robust_fit.fix_count;
-    drift_vector.used_count = robust_fit.used_count;
-    drift_vector.rejected_count = robust_fit.rejected_count;
-    drift_vector.baseline_s = robust_fit.baseline_s;
-    drift_vector.rms_residual_m = robust_fit.rms_residual_m;
-
-    MOB_TRACE_INFO( "PIW drift fit: fixes=%u used=%u rejected=%u baseline=%lu s span=%.1f m RMS=%.1f m COG=%.1f SOG=%.1f\n",
-                    robust_fit.fix_count, robust_fit.used_count, robust_fit.rejected_count,
-                    robust_fit.baseline_s, track_span_m, robust_fit.rms_residual_m,
-                    (float) drift_vector.cog_x2 / 2.0f, sog_mps );
+static bool mob_send_position_uplink( const gnss_fix_t *fix, bool quality_ok, bool confirmed )
+{
+    return mob_send_position_with_policy( fix, quality_ok, confirmed, mob_position_policy( ));
 }
 
-static bool mob_drift_get_vector( uint16_t *cog_x2, uint8_t *sog_dmps )
+static uint32_t mob_duty_cycle_wait_s( void )
 {
-    if( cog_x2 == NULL || sog_dmps == NULL || !drift_vector.valid )
+    int32_t wait_ms = app_mob_airtime_wait_ms( sizeof( mob_position_uplink_t ), 1, mob_position_policy( ));
+    uint32_t interval_s = mob_get_interval_for_mode( tracker_state.mode );
+    uint32_t wait_s;
+
+    if( wait_ms <= 0 )
     {
-        return false;
+        return 0;
     }
 
-    *cog_x2 = drift_vector.cog_x2;
-    *sog_dmps = drift_vector.sog_dmps;
-    return true;
+    // Still wake up at the mode interval for the BLE cancellation scan
+    wait_s = (( uint32_t ) wait_ms + 999 ) / 1000;
+    if( wait_s > interval_s )
+    {
+        wait_s = interval_s;
+    }
+    MOB_TRACE_WARNING( "MOB uplink: duty cycle free in %ld ms, next cycle in %lu s\n", wait_ms, wait_s );
+    return wait_s;
 }
 
-static bool mob_send_position_uplink( const gnss_fix_t *fix, bool quality_ok, bool confirmed )
+static bool mob_double_uplink_fits( void )
 {
-    app_mob_dr_policy_t policy = APP_MOB_DR_PERSISTENCE;
-
-    /* BURST favors temporal density at max DR; PHASE3 mostly persists but periodically probes minimum DR. */
-    if( tracker_state.mode == MOB_MODE_BURST )
-    {
-        policy = APP_MOB_DR_MAX;
-    }
-    else if( tracker_state.mode == MOB_MODE_PIW_PHASE3 )
+    /* Plan the pair up front: a second copy the duty cycle would refuse is not worth the wait. */
+    if( app_mob_frames_fit( sizeof( mob_position_uplink_t ), 2, mob_position_policy( )) >= 2 )
     {
-        policy = APP_MOB_DR_PHASE3_ALTERNATING;
+        return true;
     }
 
-    return mob_send_position_with_policy( fix, quality_ok, confirmed, policy );
+    MOB_TRACE_WARNING( "MOB double uplink: duty cycle allows a single copy\n" );
+    return false;
 }
 
 static bool mob_send_position_with_policy( const gnss_fix_t *fix, bool quality_ok, bool confirmed,
@@ -744,9 +673,22 @@ static bool mob_send_position_with_policy( const gnss_fix_t *fix, bool quality_o
     uint16_t drift_cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
     uint8_t drift_sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
     bool drift_valid;
+    mob_track_prediction_t prediction;
+    bool prediction_valid;
+    float pred_north_m = 0.0f;
+    float pred_east_m = 0.0f;
 
     mob_drift_update( fix );
     drift_valid = fix->valid && mob_drift_get_vector( &drift_cog_x2, &drift_sog_dmps );
+    mob_track_update( fix );
+    prediction_valid = mob_track_predict( hal_rtc_get_time_ms( ), &prediction );
+    if( prediction_valid )
+    {
+        /* Offsets from the reported fix keep the extension at 6 bytes; a stale fix far off the track drops it. */
+        pred_north_m = (float)( prediction.latitude - fix->latitude ) * track.north_m_per_udeg;
+        pred_east_m = (float)( prediction.longitude - fix->longitude ) * track.east_m_per_udeg;
+        prediction_valid = fabsf( pred_north_m ) < 32767.0f && fabsf( pred_east_m ) < 32767.0f;
+    }
 
     memset( &payload, 0, sizeof( payload ));
     
@@ -766,10 +708,14 @@ static bool mob_send_position_with_policy( const gnss_fix_t *fix, bool quality_o
     if( quality_ok ) payload.quality_flags |= 0x02;
     if( on_charge ) payload.quality_flags |= MOB_QUALITY_FLAG_ON_CHARGE;
     if( drift_valid ) payload.quality_flags |= MOB_QUALITY_FLAG_VECTOR;
+    if( prediction_valid ) payload.quality_flags |= MOB_QUALITY_FLAG_PREDICTION;
     
     payload.battery = sensor_bat_sample( );
     payload.cog_x2 = drift_valid ? drift_cog_x2 : MOB_DRIFT_UNKNOWN_COG_X2;
     payload.sog_dmps = drift_valid ? drift_sog_dmps : MOB_DRIFT_UNKNOWN_SOG_DMPS;
+    payload.pred_north_m = prediction_valid ? (int16_t) lroundf( pred_north_m ) : 0;
+    payload.pred_east_m = prediction_valid ? (int16_t) lroundf( pred_east_m ) : 0;
+    payload.pred_radius_m = prediction_valid ? mob_track_radius_encode( prediction.radius_m ) : MOB_TRACK_UNKNOWN_RADIUS_M;
     
     MOB_TRACE_INFO( "MOB uplink: lat=%ld, lon=%ld, HDOP=%.1f, qual=%02X, batt=%d%%, on_charge=%u, drift=%s COG=%.1f SOG=%.1f\n",
                    payload.latitude, payload.longitude, 
@@ -777,6 +723,11 @@ static bool mob_send_position_with_policy( const gnss_fix_t *fix, bool quality_o
                    drift_valid ? "valid" : "unknown",
                    drift_valid ? (float) payload.cog_x2 / 2.0f : -1.0f,
                    drift_valid ? (float) payload.sog_dmps / 10.0f : -1.0f );
+    if( prediction_valid )
+    {
+        MOB_TRACE_INFO( "MOB uplink prediction: N=%d m, E=%d m, radius95=%u m\n",
+                       payload.pred_north_m, payload.pred_east_m, payload.pred_radius_m );
+    }
     
     if( tracker_state.mode == MOB_MODE_BURST && initial_burst_sent == false )
     {
@@ -824,8 +775,10 @@ static void mob_send_no_fix_uplink( void )
 
 static void mob_send_no_fix_with_policy( app_mob_dr_policy_t policy )
 {
-    uint8_t payload[5];
+    uint8_t payload[15];
+    uint8_t len = 5;
     bool on_charge = gateway_assistance_is_charging( );
+    mob_track_prediction_t prediction;
 
     payload[0] = DATA_ID_MOB_NO_FIX;
     payload[1] = (uint8_t)tracker_state.mode;
@@ -836,6 +789,26 @@ static void mob_send_no_fix_with_policy( app_mob_dr_policy_t policy )
     payload[2] = (uint8_t)( tracker_state.elapsed_s >> 8 );
     payload[3] = (uint8_t)( tracker_state.elapsed_s & 0xFF );
     payload[4] = sensor_bat_sample( );
+
+    /* Dead-reckoned track position, same little-endian micro-degree encoding as the position report. */
+    if( mob_track_predict( hal_rtc_get_time_ms( ), &prediction ))
+    {
+        uint16_t radius_m = mob_track_radius_encode( prediction.radius_m );
+        uint32_t latitude = (uint32_t) prediction.latitude;
+        uint32_t longitude = (uint32_t) prediction.longitude;
+
+        for( uint8_t i = 0; i < 4; i++ )
+        {
+            payload[5 + i] = (uint8_t)( latitude >> ( 8 * i ));
+            payload[9 + i] = (uint8_t)( longitude >> ( 8 * i ));
+        }
+        payload[13] = (uint8_t)( radius_m & 0xFF );
+        payload[14] = (uint8_t)( radius_m >> 8 );
+        len = sizeof( payload );
+
+        MOB_TRACE_INFO( "MOB no-fix prediction: lat=%ld, lon=%ld, radius95=%u m\n",
+                       prediction.latitude, prediction.longitude, radius_m );
+    }
     
     MOB_TRACE_INFO( "MOB no-fix uplink: mode=%s, elapsed=%lu s, batt=%d%%, on_charge=%u\n",
                    mob_tracker_mode_str( tracker_state.mode ),
@@ -845,11 +818,11 @@ static void mob_send_no_fix_with_policy( app_mob_dr_policy_t policy )
     {
         /* If GNSS has no fix yet, still send the initial DR burst so the MOB state is announced immediately. */
         initial_burst_sent = true;
-        app_send_mob_initial_burst( payload, sizeof( payload ), false );
+        app_send_mob_initial_burst( payload, len, false );
         return;
     }
 
-    app_send_mob_frame( payload, sizeof( payload ), false, policy );
+    app_send_mob_frame( payload, len, false, policy );
 }
 
 static uint32_t mob_process_burst( void )
@@ -858,19 +831,25 @@ static uint32_t mob_process_burst( void )
     // We check for fix and send double uplinks every 30 seconds
     
     gnss_fix_t fix;
-    bool got_fix = gnss_get_quality_fix( &fix );
+    bool got_fix = gnss_get_quality_fix( &fix ) && ( gnss_fix_age_ms( &fix ) <= MOB_FIX_MAX_AGE_MS );
     
     if( got_fix )
     {
         tracker_state.last_fix = fix;
         tracker_state.last_fix_good = true;  // In burst mode, any fix is acceptable
+        bool double_fits = mob_double_uplink_fits( );
         
         // Send double uplink (first one)
         mob_send_position_uplink( &fix, true, false );
         tracker_state.uplink_count++;
         
+        if( !double_fits )
+        {
+            return MOB_UPLINK_INTERVAL_S;
+        }
+        
         // Wait 6 seconds
-        hal_mcu_wait_ms( MOB_DOUBLE_UPLINK_GAP_S * 1000 );
+        gnss_wait_ms( MOB_DOUBLE_UPLINK_GAP_S * 1000 );
         
         // Check for BLE interrupt during wait
         if( tracker_state.ble_found )
@@ -893,10 +872,17 @@ static uint32_t mob_process_burst( void )
     return MOB_UPLINK_INTERVAL_S - MOB_DOUBLE_UPLINK_GAP_S;
 }
 
+static bool mob_piw_scan_check( uint32_t elapsed_ms, uint32_t max_ms, const gnss_sky_metrics_t *sky )
+{
+    return gnss_fix_predict_update( elapsed_ms, max_ms, sky, NULL );
+}
+
 static uint32_t mob_process_piw( void )
 {
     gnss_fix_t fix;
     bool got_good_fix;
+    uint32_t scan_ms = PIW_GNSS_MAX_SCAN_MS;
+    mob_track_prediction_t prediction;
 
     // Check if background GNSS is already active (charging mode)
     bool background_active = gateway_assistance_is_background_gnss_active();
@@ -904,11 +890,16 @@ static uint32_t mob_process_piw( void )
     if( background_active )
     {
         MOB_TRACE_INFO( "GNSS already running in background mode\n" );
+        // Already tracking, a fix in a few seconds would teach the cold context a budget it cannot meet
+        gnss_ttff_stats_skip_next( );
     }
 
     // Send time to GNSS (module is now powered - either background or will be started by scan)
     gateway_assistance_send_time_to_gnss(true);
     
+    // Unassisted unless the hot start below goes out
+    gnss_ttff_stats_note_start( GNSS_START_COLD );
+
     // Send hot start for PIW phases (PAIR004)
     // Hot start uses ephemeris if available from recent fix
     if( gateway_assistance_is_gnss_ready( ))
@@ -920,16 +911,40 @@ static uint32_t mob_process_piw( void )
     // Log NMEA debug info for Phase 1
     MOB_NMEA_DEBUG(tracker_state.mode, "[PIW Phase 1] Starting quality scan\n");
     
+    // p90 of this device's time to a good fix in the same start/assistance/almanac context
+    scan_ms = gnss_ttff_stats_scan_budget_ms( PIW_GNSS_MAX_SCAN_MS, PIW_GNSS_LEARN_MIN_MS,
+                                              PIW_GNSS_LEARN_MAX_MS );
+    if( scan_ms != PIW_GNSS_MAX_SCAN_MS )
+    {
+        MOB_TRACE_INFO( "PIW scan budget %lu ms from TTFF history\n", scan_ms );
+    }
+
+    // A tight track prediction already locates the PIW, a long scan buys little
+    if( mob_track_predict( hal_rtc_get_time_ms( ), &prediction ) && prediction.radius_m < PIW_TRACK_TIGHT_RADIUS_M &&
+        scan_ms > PIW_GNSS_TIGHT_SCAN_MS )
+    {
+        scan_ms = PIW_GNSS_TIGHT_SCAN_MS;
+        MOB_TRACE_INFO( "PIW track radius95=%.0f m, scan limited to %lu ms\n", prediction.radius_m, scan_ms );
+    }
+
+    // Stop early when the sky is obviously blocked instead of spending the whole budget
+    gnss_set_sky_abort( REMEX_PIW_SKY_CHECK_MS, REMEX_PIW_SKY_MIN_TOP4_CN0 );
+
+    // ...and when the C/N0 trend says a good fix will not come within the budget
+    gnss_fix_predict_start( );
+    gnss_set_scan_check( mob_piw_scan_check );
+
     // Quality-driven scan with early exit
     // When background_active=true, skip power management to keep GNSS running
     got_good_fix = gnss_scan_until_good( 
-        PIW_GNSS_MAX_SCAN_MS,
+        scan_ms,
         PIW_GNSS_MAX_HDOP,
         PIW_GNSS_MAX_HACC_M,
         &fix,
         background_active );  // Skip power management if background GNSS active
     
     // No need to manually stop GNSS - gnss_scan_until_good handles it based on skip_power_management
+    gnss_ttff_stats_record_acquisition( );
     
     // Check for BLE interrupt during scan
     if( tracker_state.ble_found )
@@ -951,14 +966,20 @@ static uint32_t mob_process_piw( void )
             fix.latitude, fix.longitude, fix.hdop, fix.hacc, 
             fix.satellites, got_good_fix ? "GOOD" : "MARGINAL");
         
-        // Send double uplink
+        // Send double uplink, when the duty cycle has room for both
+        bool double_fits = mob_double_uplink_fits( );
         mob_send_position_uplink( &fix, got_good_fix, false );
         
-        hal_mcu_wait_ms( MOB_DOUBLE_UPLINK_GAP_S * 1000 );
-        
-        if( !tracker_state.ble_found )
+        if( double_fits )
         {
-            mob_send_position_uplink( &fix, got_good_fix, false );
+            gnss_wait_ms( MOB_DOUBLE_UPLINK_GAP_S * 1000 );
+        
+            if( !tracker_state.ble_found )
+            {
+                // Same fix as the first copy, the backlog needs it once
+                app_send_mark_repeat( );
+                mob_send_position_uplink( &fix, got_good_fix, false );
+            }
         }
     }
     else
@@ -987,7 +1008,7 @@ static void mob_run_ble_scan( void )
     
     // Wait for scan duration
     MOB_TRACE_INFO( "MOB BLE scan duration %lu s\n", scan_duration_s );
-    hal_mcu_wait_ms( scan_duration_s * 1000 );
+    gnss_wait_ms( scan_duration_s * 1000 );
     
     // Stop scan and check results
     ble_scan_stop( );
@@ -0,0 +1,581 @@
+/*!
+ * @file      mob_drift.c
+ *
+ * @brief     PIW drift vector fitted from running moments of the recent fixes
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "mob_drift.h"
+#include "default_config_settings.h"
+#include "log_filter.h"
+#include <string.h>
+#include <math.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define DRIFT_TRACE_INFO(...)           LOG_GNSS(__VA_ARGS__)
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define MOB_DRIFT_RAD_TO_DEG            57.295779513082320876f
+#define MOB_DRIFT_SATURATED_SOG_DMPS    0xFEU
+
+#if REMEX_PIW_DRIFT_FIX_WINDOW < REMEX_PIW_DRIFT_MIN_FIXES
+#error "REMEX_PIW_DRIFT_FIX_WINDOW must be >= REMEX_PIW_DRIFT_MIN_FIXES"
+#endif
+
+#ifndef REMEX_PIW_DRIFT_REBUILD_UPDATES
+#define REMEX_PIW_DRIFT_REBUILD_UPDATES REMEX_PIW_DRIFT_FIX_WINDOW
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    bool     valid;
+    int32_t  latitude;
+    int32_t  longitude;
+    float    hdop;
+    float    hacc;
+    uint32_t timestamp_s;
+    uint32_t epoch_ms;           // gnss_fix_t timestamp of the source epoch
+    float    sigma_m;
+    float    east_m;             // position in the track frame, set on insert or rebuild
+    float    north_m;
+    float    t_s;                // seconds since the track frame origin
+    bool     inlier;             // counted in the robust sums
+} mob_drift_fix_t;
+
+/*
+ * Running weighted means and centred co-moments of (t, east, north), updated
+ * with West's algorithm. A negative weight is the exact reverse of adding the
+ * same sample, so a fix can leave the window without revisiting the others,
+ * and centring keeps float round-off independent of the track length.
+ */
+typedef struct
+{
+    float    w;
+    float    mean_t;
+    float    mean_e;
+    float    mean_n;
+    float    m_tt;
+    float    m_te;
+    float    m_tn;
+    float    m_ee;
+    float    m_nn;
+} mob_drift_moments_t;
+
+/*
+ * Sufficient statistics of a straight-line fit: 1/sigma^2 weighted moments
+ * give the track, unweighted ones its RMS residual.
+ */
+typedef struct
+{
+    uint8_t             count;
+    mob_drift_moments_t weighted;
+    mob_drift_moments_t plain;
+} mob_drift_sums_t;
+
+/*
+ * Local east/north frame of the current track: fixed between rebuilds so a
+ * fix is projected once, with cos(latitude) computed once per rebuild.
+ */
+typedef struct
+{
+    bool     valid;
+    int32_t  ref_latitude;
+    int32_t  ref_longitude;
+    float    north_m_per_udeg;
+    float    east_m_per_udeg;
+    uint32_t t0_s;
+} mob_drift_frame_t;
+
+typedef struct
+{
+    bool     valid;
+    float    east0_m;
+    float    north0_m;
+    float    east_mps;
+    float    north_mps;
+    float    ref_lat_rad;
+    float    ref_lon_rad;
+    uint32_t t0_s;
+    uint32_t t_first_s;
+    uint32_t t_last_s;
+    uint32_t baseline_s;
+    uint8_t  fix_count;
+    uint8_t  used_count;
+    uint8_t  rejected_count;
+    float    rms_residual_m;
+} mob_drift_fit_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static mob_drift_fix_t drift_fixes[REMEX_PIW_DRIFT_FIX_WINDOW];
+static uint8_t drift_fix_next = 0;
+static uint8_t drift_fix_count = 0;
+static mob_drift_vector_t drift_vector;
+static mob_drift_frame_t drift_frame;
+static mob_drift_sums_t drift_sums_all;      // every fix in the window, provisional track
+static mob_drift_sums_t drift_sums_inlier;   // fixes passing the residual gate, robust track
+static uint8_t drift_updates_since_rebuild = 0;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static float mob_drift_clamp_sigma_m( float sigma_m )
+{
+    if( sigma_m < REMEX_PIW_DRIFT_SIGMA_FLOOR_M )
+    {
+        return REMEX_PIW_DRIFT_SIGMA_FLOOR_M;
+    }
+
+    if( sigma_m > REMEX_PIW_DRIFT_SIGMA_CEILING_M )
+    {
+        return REMEX_PIW_DRIFT_SIGMA_CEILING_M;
+    }
+
+    return sigma_m;
+}
+
+static uint8_t mob_drift_ring_index( uint8_t age )
+{
+    // age 0 is the oldest fix in the window
+    return ( drift_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - drift_fix_count + age ) % REMEX_PIW_DRIFT_FIX_WINDOW;
+}
+
+static void mob_drift_frame_anchor( const mob_drift_fix_t *fix )
+{
+    float ref_lat_rad = ((float) fix->latitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
+
+    drift_frame.ref_latitude = fix->latitude;
+    drift_frame.ref_longitude = fix->longitude;
+    drift_frame.north_m_per_udeg = MOB_DRIFT_EARTH_RADIUS_M * MOB_DRIFT_DEG_TO_RAD / 1000000.0f;
+    drift_frame.east_m_per_udeg = drift_frame.north_m_per_udeg * cosf( ref_lat_rad );
+    drift_frame.t0_s = fix->timestamp_s;
+    drift_frame.valid = true;
+}
+
+static void mob_drift_project( mob_drift_fix_t *fix )
+{
+    // Difference in integer micro-degrees first so float keeps sub-metre resolution
+    fix->east_m = (float)( fix->longitude - drift_frame.ref_longitude ) * drift_frame.east_m_per_udeg;
+    fix->north_m = (float)( fix->latitude - drift_frame.ref_latitude ) * drift_frame.north_m_per_udeg;
+    fix->t_s = (float)( fix->timestamp_s - drift_frame.t0_s );
+}
+
+static void mob_drift_moments_apply( mob_drift_moments_t *m, const mob_drift_fix_t *fix, float w )
+{
+    float total_w = m->w + w;
+
+    if( total_w <= 1e-9f )
+    {
+        memset( m, 0, sizeof( *m ));
+        return;
+    }
+
+    // Deltas against the old means, products with the new ones
+    float dt = fix->t_s - m->mean_t;
+    float de = fix->east_m - m->mean_e;
+    float dn = fix->north_m - m->mean_n;
+    float r = w / total_w;
+
+    m->w = total_w;
+    m->mean_t += dt * r;
+    m->mean_e += de * r;
+    m->mean_n += dn * r;
+    m->m_tt += w * dt * ( fix->t_s - m->mean_t );
+    m->m_te += w * dt * ( fix->east_m - m->mean_e );
+    m->m_tn += w * dt * ( fix->north_m - m->mean_n );
+    m->m_ee += w * de * ( fix->east_m - m->mean_e );
+    m->m_nn += w * dn * ( fix->north_m - m->mean_n );
+}
+
+static void mob_drift_sums_apply( mob_drift_sums_t *sums, const mob_drift_fix_t *fix, float sign )
+{
+    sums->count = ( sign > 0.0f ) ? sums->count + 1 : sums->count - 1;
+    mob_drift_moments_apply( &sums->weighted, fix, sign / ( fix->sigma_m * fix->sigma_m ));
+    mob_drift_moments_apply( &sums->plain, fix, sign );
+}
+
+static bool mob_drift_sums_solve( const mob_drift_sums_t *sums, mob_drift_fit_t *fit )
+{
+    /*
+     * Weighted straight-line fit in local east/north meters:
+     *   east(t)  = east0  + east_mps  * t
+     *   north(t) = north0 + north_mps * t
+     */
+    fit->valid = false;
+    if( sums->count < REMEX_PIW_DRIFT_MIN_FIXES )
+    {
+        return false;
+    }
+
+    // sw * m_tt is the sw * swtt - swt^2 determinant of the normal equations
+    const mob_drift_moments_t *m = &sums->weighted;
+    if(( m->w * m->m_tt ) <= 0.0001f )
+    {
+        return false;
+    }
+
+    fit->east_mps = m->m_te / m->m_tt;
+    fit->north_mps = m->m_tn / m->m_tt;
+    fit->east0_m = m->mean_e - ( fit->east_mps * m->mean_t );
+    fit->north0_m = m->mean_n - ( fit->north_mps * m->mean_t );
+    fit->used_count = sums->count;
+    fit->valid = true;
+    return true;
+}
+
+static float mob_drift_sums_rms_m( const mob_drift_sums_t *sums, const mob_drift_fit_t *fit )
+{
+    /*
+     * sum((p - p0 - v * t)^2) split around the means: the centred part
+     * M_pp - 2 v M_tp + v^2 M_tt plus n times the offset of the mean point
+     * from the track, per axis. Cross terms vanish.
+     */
+    const mob_drift_moments_t *m = &sums->plain;
+    float n = (float) sums->count;
+    float east_offset = m->mean_e - ( fit->east0_m + ( fit->east_mps * m->mean_t ));
+    float north_offset = m->mean_n - ( fit->north0_m + ( fit->north_mps * m->mean_t ));
+    float sq = m->m_ee - ( 2.0f * fit->east_mps * m->m_te ) + ( fit->east_mps * fit->east_mps * m->m_tt ) +
+               m->m_nn - ( 2.0f * fit->north_mps * m->m_tn ) + ( fit->north_mps * fit->north_mps * m->m_tt ) +
+               n * (( east_offset * east_offset ) + ( north_offset * north_offset ));
+
+    if( sums->count == 0 || sq <= 0.0f )
+    {
+        return 0.0f;
+    }
+    return sqrtf( sq / n );
+}
+
+static bool mob_drift_gate( const mob_drift_fit_t *provisional, const mob_drift_fix_t *fix )
+{
+    if( !provisional->valid )
+    {
+        return true;
+    }
+
+    float east_residual = fix->east_m - ( provisional->east0_m + ( provisional->east_mps * fix->t_s ));
+    float north_residual = fix->north_m - ( provisional->north0_m + ( provisional->north_mps * fix->t_s ));
+    float allowed_m = ( fix->sigma_m * REMEX_PIW_DRIFT_OUTLIER_SIGMA ) + REMEX_PIW_DRIFT_OUTLIER_MARGIN_M;
+
+    // Squared compare, no sqrtf per fix
+    return (( east_residual * east_residual ) + ( north_residual * north_residual )) <= ( allowed_m * allowed_m );
+}
+
+static void mob_drift_rebuild( void )
+{
+    /*
+     * Exact two-pass refit of the whole window: re-anchor the frame on the
+     * oldest fix, re-project every fix, then gate each one against the
+     * provisional track. Running this every REMEX_PIW_DRIFT_REBUILD_UPDATES
+     * fixes keeps float round-off in the running sums and stale gate decisions
+     * from accumulating, and keeps t and distance small around the origin.
+     */
+    mob_drift_fit_t provisional;
+
+    memset( &drift_sums_all, 0, sizeof( drift_sums_all ));
+    memset( &drift_sums_inlier, 0, sizeof( drift_sums_inlier ));
+    drift_frame.valid = false;
+    drift_updates_since_rebuild = 0;
+
+    for( uint8_t i = 0; i < drift_fix_count; i++ )
+    {
+        mob_drift_fix_t *fix = &drift_fixes[mob_drift_ring_index( i )];
+        if( !fix->valid )
+        {
+            continue;
+        }
+        if( !drift_frame.valid )
+        {
+            mob_drift_frame_anchor( fix );
+        }
+        mob_drift_project( fix );
+        mob_drift_sums_apply( &drift_sums_all, fix, 1.0f );
+    }
+
+    mob_drift_sums_solve( &drift_sums_all, &provisional );
+    for( uint8_t i = 0; i < drift_fix_count; i++ )
+    {
+        mob_drift_fix_t *fix = &drift_fixes[mob_drift_ring_index( i )];
+        fix->inlier = fix->valid && mob_drift_gate( &provisional, fix );
+        if( fix->inlier )
+        {
+            mob_drift_sums_apply( &drift_sums_inlier, fix, 1.0f );
+        }
+    }
+}
+
+static void mob_drift_regate( const mob_drift_fit_t *provisional )
+{
+    /*
+     * Re-check every stored gate decision against the updated provisional
+     * track. Only fixes whose decision flips touch the inlier sums; this is a
+     * multiply-compare per fix, no projection, trigonometry or square root.
+     */
+    for( uint8_t i = 0; i < drift_fix_count; i++ )
+    {
+        mob_drift_fix_t *fix = &drift_fixes[mob_drift_ring_index( i )];
+        bool inlier = fix->valid && mob_drift_gate( provisional, fix );
+        if( inlier != fix->inlier )
+        {
+            mob_drift_sums_apply( &drift_sums_inlier, fix, inlier ? 1.0f : -1.0f );
+            fix->inlier = inlier;
+        }
+    }
+}
+
+static void mob_drift_insert( const mob_drift_fix_t *sample )
+{
+    /*
+     * Between rebuilds the evicted fix leaves both sums and only the new fix
+     * is projected; the provisional track comes straight from the sums.
+     */
+    mob_drift_fit_t provisional;
+    mob_drift_fix_t *fix = &drift_fixes[drift_fix_next];
+
+    if( drift_fix_count == REMEX_PIW_DRIFT_FIX_WINDOW && fix->valid )
+    {
+        mob_drift_sums_apply( &drift_sums_all, fix, -1.0f );
+        if( fix->inlier )
+        {
+            mob_drift_sums_apply( &drift_sums_inlier, fix, -1.0f );
+        }
+    }
+
+    *fix = *sample;
+    drift_fix_next = ( drift_fix_next + 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
+    if( drift_fix_count < REMEX_PIW_DRIFT_FIX_WINDOW )
+    {
+        drift_fix_count++;
+    }
+
+    if( !drift_frame.valid || ++drift_updates_since_rebuild >= REMEX_PIW_DRIFT_REBUILD_UPDATES )
+    {
+        mob_drift_rebuild( );
+        return;
+    }
+
+    mob_drift_project( fix );
+    mob_drift_sums_apply( &drift_sums_all, fix, 1.0f );
+    mob_drift_sums_solve( &drift_sums_all, &provisional );
+    fix->inlier = false;
+    mob_drift_regate( &provisional );
+}
+
+static bool mob_drift_fit_window( mob_drift_fit_t *fit )
+{
+    /*
+     * The provisional fit over every fix defines the recent track; fixes whose
+     * residual from it exceeds the configurable sigma gate stay out of the
+     * inlier sums. This makes outlier rejection track-relative instead of
+     * previous-fix-relative.
+     */
+    mob_drift_fit_t provisional;
+
+    memset( fit, 0, sizeof( *fit ));
+    if( !mob_drift_sums_solve( &drift_sums_all, &provisional ) ||
+        !mob_drift_sums_solve( &drift_sums_inlier, fit ))
+    {
+        return false;
+    }
+    fit->fix_count = drift_sums_all.count;
+    fit->rejected_count = drift_sums_all.count - drift_sums_inlier.count;
+    fit->ref_lat_rad = ((float) drift_frame.ref_latitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
+    fit->ref_lon_rad = ((float) drift_frame.ref_longitude / 1000000.0f) * MOB_DRIFT_DEG_TO_RAD;
+    fit->t0_s = drift_frame.t0_s;
+
+    // Baseline spans the oldest to the newest inlier, normally one step from each end
+    for( uint8_t i = 0; i < drift_fix_count; i++ )
+    {
+        const mob_drift_fix_t *fix = &drift_fixes[mob_drift_ring_index( i )];
+        if( fix->inlier )
+        {
+            fit->t_first_s = fix->timestamp_s;
+            break;
+        }
+    }
+    for( uint8_t i = drift_fix_count; i > 0; i-- )
+    {
+        const mob_drift_fix_t *fix = &drift_fixes[mob_drift_ring_index( i - 1 )];
+        if( fix->inlier )
+        {
+            fit->t_last_s = fix->timestamp_s;
+            break;
+        }
+    }
+    fit->baseline_s = fit->t_last_s - fit->t_first_s;
+    fit->rms_residual_m = mob_drift_sums_rms_m( &drift_sums_inlier, fit );
+    return true;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void mob_drift_reset( void )
+{
+    memset( drift_fixes, 0, sizeof( drift_fixes ));
+    drift_fix_next = 0;
+    drift_fix_count = 0;
+    memset( &drift_vector, 0, sizeof( drift_vector ));
+    drift_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
+    drift_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
+    memset( &drift_frame, 0, sizeof( drift_frame ));
+    memset( &drift_sums_all, 0, sizeof( drift_sums_all ));
+    memset( &drift_sums_inlier, 0, sizeof( drift_sums_inlier ));
+    drift_updates_since_rebuild = 0;
+}
+
+float mob_drift_sigma_m( const gnss_fix_t* fix )
+{
+    /*
+     * sigma_m is the estimated 1-sigma horizontal position error used for
+     * weighting. Poor fixes are not discarded here; they are kept with lower
+     * weight so an older marginal fix can still improve velocity over a long
+     * baseline.
+     */
+    if( fix->hacc > 0.0f && fix->hacc < 1000.0f )
+    {
+        return mob_drift_clamp_sigma_m( fix->hacc );
+    }
+
+    if( fix->hdop > 0.0f && fix->hdop < 99.0f )
+    {
+        return mob_drift_clamp_sigma_m( fix->hdop * REMEX_PIW_DRIFT_UERE_M );
+    }
+
+    return REMEX_PIW_DRIFT_SIGMA_CEILING_M;
+}
+
+void mob_drift_add_fix( const gnss_fix_t* fix, uint32_t epoch_s )
+{
+    if( fix == NULL || !fix->valid )
+    {
+        return;
+    }
+
+    /* PIW sends a double uplink from the same GNSS result; keep only one sample per epoch. */
+    if( drift_fix_count > 0 )
+    {
+        uint8_t last_index = ( drift_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
+        if( drift_fixes[last_index].valid &&
+            ( drift_fixes[last_index].epoch_ms == fix->timestamp_ms ||
+              ( drift_fixes[last_index].latitude == fix->latitude &&
+                drift_fixes[last_index].longitude == fix->longitude &&
+                ( epoch_s - drift_fixes[last_index].timestamp_s ) < REMEX_PIW_DRIFT_DUPLICATE_FIX_S )))
+        {
+            return;
+        }
+    }
+
+    mob_drift_fix_t sample;
+    memset( &sample, 0, sizeof( sample ));
+    sample.valid = true;
+    sample.latitude = fix->latitude;
+    sample.longitude = fix->longitude;
+    sample.hdop = fix->hdop;
+    sample.hacc = fix->hacc;
+    sample.timestamp_s = epoch_s;
+    sample.epoch_ms = fix->timestamp_ms;
+    sample.sigma_m = mob_drift_sigma_m( fix );
+    mob_drift_insert( &sample );
+
+    mob_drift_fit_t robust_fit;
+    if( !mob_drift_fit_window( &robust_fit ))
+    {
+        return;
+    }
+
+    float sog_mps = sqrtf(( robust_fit.east_mps * robust_fit.east_mps ) +
+                          ( robust_fit.north_mps * robust_fit.north_mps ));
+    float track_span_m = sog_mps * (float) robust_fit.baseline_s;
+    /*
+     * A vector is only emitted once the fitted history covers enough time and
+     * movement to make COG meaningful. This is a track-level gate, not a
+     * point-to-point distance gate, so older poorer fixes can still help.
+     */
+    if( robust_fit.baseline_s < REMEX_PIW_DRIFT_MIN_BASELINE_S ||
+        track_span_m < REMEX_PIW_DRIFT_MIN_TRACK_SPAN_M ||
+        sog_mps > REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS )
+    {
+        drift_vector.valid = false;
+        drift_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
+        drift_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
+        return;
+    }
+
+    float cog_deg = atan2f( robust_fit.east_mps, robust_fit.north_mps ) * MOB_DRIFT_RAD_TO_DEG;
+    if( cog_deg < 0.0f )
+    {
+        cog_deg += 360.0f;
+    }
+
+    uint16_t cog_x2 = (uint16_t)( cog_deg * 2.0f + 0.5f );
+    if( cog_x2 >= 720U )
+    {
+        cog_x2 = 0;
+    }
+
+    uint16_t sog_dmps = (uint16_t)( sog_mps * 10.0f + 0.5f );
+    if( sog_dmps >= MOB_DRIFT_SATURATED_SOG_DMPS )
+    {
+        sog_dmps = MOB_DRIFT_SATURATED_SOG_DMPS;
+    }
+
+    drift_vector.valid = true;
+    drift_vector.cog_x2 = cog_x2;
+    drift_vector.sog_dmps = (uint8_t) sog_dmps;
+    drift_vector.east_mps = robust_fit.east_mps;
+    drift_vector.north_mps = robust_fit.north_mps;
+    drift_vector.sog_mps = sog_mps;
+    drift_vector.fix_count = robust_fit.fix_count;
+    drift_vector.used_count = robust_fit.used_count;
+    drift_vector.rejected_count = robust_fit.rejected_count;
+    drift_vector.baseline_s = robust_fit.baseline_s;
+    drift_vector.rms_residual_m = robust_fit.rms_residual_m;
+
+    DRIFT_TRACE_INFO( "PIW drift fit: fixes=%u used=%u rejected=%u baseline=%lu s span=%.1f m RMS=%.1f m COG=%.1f SOG=%.1f\n",
+                      robust_fit.fix_count, robust_fit.used_count, robust_fit.rejected_count,
+                      robust_fit.baseline_s, track_span_m, robust_fit.rms_residual_m,
+                      (float) drift_vector.cog_x2 / 2.0f, sog_mps );
+}
+
+bool mob_drift_get_vector( uint16_t* cog_x2, uint8_t* sog_dmps )
+{
+    if( cog_x2 == NULL || sog_dmps == NULL || !drift_vector.valid )
+    {
+        return false;
+    }
+
+    *cog_x2 = drift_vector.cog_x2;
+    *sog_dmps = drift_vector.sog_dmps;
+    return true;
+}
+
+void mob_drift_get_result( mob_drift_vector_t* vector )
+{
+    *vector = drift_vector;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,670 @@
+/*!
+ * @file      ble_adv_storm_bench.c
+ *
+ * @brief     Host micro-benchmark of the BLE advertising report path under ADV storms
+ *
+ * A marina is modelled as a fixed population of advertisers: vessel iBeacons
+ * with the approved UUID (more of them than the 32-entry table holds, a few
+ * with a TX power field instead of the Flags so the generic AD walk is
+ * taken), iBeacons of other owners, and phones, tags and chargers without
+ * iBeacon data. Each scan replays a storm of reports drawn at random from
+ * the population, with the RSSI scattered around each advertiser's level.
+ *
+ * Every scan goes through app_ble_beacon_adv_report( ) exactly as the
+ * SoftDevice handler feeds it, then the table is checked against a reference
+ * model: counters, beacons kept and dropped, max / mean / count per beacon
+ * (read back from ble_display_results), the top-5 uplink records and the
+ * strongest DR hint.
+ *
+ * The timing then replays the same storms through the report path and
+ * through the linear scan it replaced (kept below as legacy_report), and
+ * prints the cost per report. Trace output is not formatted while timing,
+ * as with the BLE log filter off.
+ *
+ *   gcc -O2 -Isim -I../inc -I../../peripherals/inc -I../../../smtc_hal/inc -I../../../apps/common \
+ *       ble_adv_storm_bench.c ../src/app_ble_beacon.c -o ble_adv_storm_bench
+ *   ./ble_adv_storm_bench [-s scans] [-r reports] [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "app_ble_beacon.h"
+#include "ble_scan.h"
+#include "log_filter.h"
+#include "crew_dr_strategy_config.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define BENCH_APPROVED              40          // Vessel iBeacons, more than BLE_BEACON_BUF_MAX
+#define BENCH_APPROVED_WALK         4           // Of which without the Flags field first
+#define BENCH_FOREIGN               30          // iBeacons with another UUID
+#define BENCH_OTHER                 130         // Advertisers without iBeacon data
+#define BENCH_ADVERTISERS           ( BENCH_APPROVED + BENCH_FOREIGN + BENCH_OTHER )
+#define BENCH_DEFAULT_SCANS         200
+#define BENCH_DEFAULT_REPORTS       2000        // One 4 s scan at ~500 reports/s
+#define BENCH_RSSI_SPREAD           9           // Report RSSI is the level -4..+4 dB
+#define BENCH_LOG_LINE              256
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct {
+    uint8_t  data[31];
+    uint8_t  len;
+    uint8_t  mac[6];
+    int8_t   level;
+    bool     approved;
+    uint16_t major;
+    uint16_t minor;
+} bench_adv_t;
+
+typedef struct {
+    uint8_t  adv;               // Index into bench_advs
+    int8_t   rssi;
+} bench_report_t;
+
+// Reference model of one beacon in the table
+typedef struct {
+    uint8_t  adv;
+    int8_t   max;
+    uint32_t max_at;            // Report number that first reached max
+    int32_t  sum;
+    uint16_t count;
+} bench_ref_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static bench_adv_t bench_advs[BENCH_ADVERTISERS];
+static bench_report_t* bench_storm = NULL;
+static uint32_t bench_reports = BENCH_DEFAULT_REPORTS;
+static uint32_t bench_scans = BENCH_DEFAULT_SCANS;
+static uint32_t bench_rng = 1;
+static bool bench_verbose = false;
+
+// Trace capture, only while checking
+static bool bench_log_capture = false;
+static char bench_log_lines[BLE_BEACON_BUF_MAX + 4][BENCH_LOG_LINE];
+static uint8_t bench_log_count = 0;
+
+// Table of the replaced report path
+static BleBeacons_t legacy_buf[BLE_BEACON_BUF_MAX];
+static uint8_t legacy_res_num = 0;
+static uint8_t legacy_name_logs = 0;
+
+extern uint8_t ble_uuid_filter_array[16];
+extern uint8_t ble_uuid_filter_num;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+// Trace output of app_ble_beacon.c
+void log_filter_printf( log_filter_category_t category, const char* fmt, ... )
+{
+    va_list args;
+
+    ( void ) category;
+    if( !bench_log_capture )
+    {
+        return;
+    }
+    va_start( args, fmt );
+    if( bench_log_count < ( sizeof( bench_log_lines ) / sizeof( bench_log_lines[0] )))
+    {
+        vsnprintf( bench_log_lines[bench_log_count++], BENCH_LOG_LINE, fmt, args );
+    }
+    va_end( args );
+}
+
+void memcpyr( uint8_t* dst, const uint8_t* src, uint16_t size )
+{
+    dst = dst + ( size - 1 );
+    while( size-- )
+    {
+        *dst-- = *src++;
+    }
+}
+
+static uint32_t bench_random( void )
+{
+    // xorshift32
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+static uint8_t bench_put_flags( uint8_t* data )
+{
+    data[0] = 0x02;
+    data[1] = 0x01;             // Flags
+    data[2] = 0x06;
+    return 3;
+}
+
+static uint8_t bench_put_tx_power( uint8_t* data )
+{
+    data[0] = 0x02;
+    data[1] = 0x0A;             // TX power level
+    data[2] = ( uint8_t ) -4;
+    return 3;
+}
+
+static uint8_t bench_put_name( uint8_t* data, const char* name )
+{
+    uint8_t len = strlen( name );
+
+    data[0] = len + 1;
+    data[1] = 0x09;             // Complete local name
+    memcpy( data + 2, name, len );
+    return len + 2;
+}
+
+static uint8_t bench_put_ibeacon( uint8_t* data, const uint8_t* uuid, uint16_t major, uint16_t minor )
+{
+    data[0] = 0x1A;
+    data[1] = 0xFF;             // Manufacturer specific data
+    data[2] = 0x4C;             // Apple
+    data[3] = 0x00;
+    data[4] = 0x02;             // iBeacon
+    data[5] = 0x15;
+    memcpy( data + 6, uuid, 16 );
+    data[22] = major >> 8;      // Major and Minor are big endian on air
+    data[23] = major & 0xFF;
+    data[24] = minor >> 8;
+    data[25] = minor & 0xFF;
+    data[26] = ( uint8_t ) -59; // Measured power at 1 m
+    return 27;
+}
+
+static void bench_population( void )
+{
+    static const char* names[] = { "Phone", "Watch", "Charger", "TPMS", "Tag" };
+    uint8_t foreign_uuid[16];
+
+    memset( bench_advs, 0, sizeof( bench_advs ));
+    for( uint16_t i = 0; i < BENCH_ADVERTISERS; i++ )
+    {
+        bench_adv_t* adv = &bench_advs[i];
+
+        adv->mac[0] = i & 0xFF;
+        adv->mac[1] = i >> 8;
+        adv->mac[2] = 0x5A;
+        adv->mac[3] = bench_random( ) & 0xFF;
+        adv->mac[4] = bench_random( ) & 0xFF;
+        adv->mac[5] = 0xC0;
+        adv->level = -50 - ( int8_t )( bench_random( ) % 45 );
+
+        if( i < BENCH_APPROVED )
+        {
+            adv->approved = true;
+            adv->major = 0x0100 + i;
+            adv->minor = i % 7;         // Minors 1..5 are DR hints, 0 and 6 are not
+            if( i >= BENCH_APPROVED - BENCH_APPROVED_WALK )
+            {
+                adv->len = bench_put_tx_power( adv->data );
+                adv->len += bench_put_ibeacon( adv->data + adv->len, CREW_DR_BLE_UUID_WHITELIST[0],
+                                               adv->major, adv->minor );
+            }
+            else
+            {
+                adv->len = bench_put_flags( adv->data );
+                adv->len += bench_put_ibeacon( adv->data + adv->len, CREW_DR_BLE_UUID_WHITELIST[0],
+                                               adv->major, adv->minor );
+            }
+        }
+        else if( i < BENCH_APPROVED + BENCH_FOREIGN )
+        {
+            // Same first bytes as the approved UUID for a third of them, so the full compare is taken
+            memcpy( foreign_uuid, CREW_DR_BLE_UUID_WHITELIST[0], 16 );
+            foreign_uuid[( i % 3 ) ? 0 : 15] ^= ( uint8_t )( i | 1 );
+            adv->len = bench_put_flags( adv->data );
+            adv->len += bench_put_ibeacon( adv->data + adv->len, foreign_uuid, i, 1 );
+        }
+        else
+        {
+            adv->len = bench_put_flags( adv->data );
+            adv->data[adv->len++] = 0x03;
+            adv->data[adv->len++] = 0x03;       // Complete 16-bit service UUIDs
+            adv->data[adv->len++] = 0x6F;
+            adv->data[adv->len++] = 0xFD;
+            adv->len += bench_put_name( adv->data + adv->len, names[i % 5] );
+        }
+    }
+}
+
+static void bench_storm_fill( void )
+{
+    for( uint32_t i = 0; i < bench_reports; i++ )
+    {
+        bench_storm[i].adv = bench_random( ) % BENCH_ADVERTISERS;
+        bench_storm[i].rssi = bench_advs[bench_storm[i].adv].level +
+                              ( int8_t )( bench_random( ) % BENCH_RSSI_SPREAD ) - BENCH_RSSI_SPREAD / 2;
+    }
+}
+
+static void bench_replay( void )
+{
+    for( uint32_t i = 0; i < bench_reports; i++ )
+    {
+        const bench_adv_t* adv = &bench_advs[bench_storm[i].adv];
+
+        app_ble_beacon_adv_report( adv->data, adv->len, adv->mac, bench_storm[i].rssi );
+    }
+}
+
+static void bench_fail( uint32_t scan, const char* what )
+{
+    fprintf( stderr, "scan %u: %s\n", scan, what );
+    exit( 1 );
+}
+
+/*!
+ * @brief Check the table after a scan against a model built from the storm
+ */
+static void bench_check( uint32_t scan )
+{
+    bench_ref_t ref[BLE_BEACON_BUF_MAX];
+    uint8_t ref_num = 0;
+    uint16_t ibeacon = 0, approved = 0, drops = 0;
+    uint8_t top[BLE_BEACON_SEND_MUM];
+    uint8_t top_num = 0;
+    int best_hint = -1;
+    app_ble_beacon_stats_t stats;
+    uint8_t result[BLE_BEACON_SEND_MUM * BLE_BEACON_UPLINK_RECORD_LEN];
+    uint8_t size = 0;
+    ble_beacon_hint_t hint;
+
+    // Model
+    for( uint32_t i = 0; i < bench_reports; i++ )
+    {
+        const bench_adv_t* adv = &bench_advs[bench_storm[i].adv];
+        int8_t rssi = bench_storm[i].rssi;
+        uint8_t r = 0;
+
+        if( bench_storm[i].adv < BENCH_APPROVED + BENCH_FOREIGN )
+        {
+            ibeacon++;
+        }
+        if( !adv->approved )
+        {
+            continue;
+        }
+        approved++;
+        while(( r < ref_num ) && ( ref[r].adv != bench_storm[i].adv ))
+        {
+            r++;
+        }
+        if( r == ref_num )
+        {
+            if( ref_num == BLE_BEACON_BUF_MAX )
+            {
+                drops++;
+                continue;
+            }
+            ref[ref_num].adv = bench_storm[i].adv;
+            ref[ref_num].max = rssi;
+            ref[ref_num].max_at = i;
+            ref[ref_num].sum = 0;
+            ref[ref_num].count = 0;
+            ref_num++;
+        }
+        if( rssi > ref[r].max )
+        {
+            ref[r].max = rssi;
+            ref[r].max_at = i;
+        }
+        ref[r].sum += rssi;
+        ref[r].count++;
+    }
+
+    // Top-K by max RSSI, ties to the beacon that reached it first; strongest Minor 1..5
+    for( uint8_t k = 0; k < BLE_BEACON_SEND_MUM && k < ref_num; k++ )
+    {
+        int pick = -1;
+
+        for( uint8_t r = 0; r < ref_num; r++ )
+        {
+            bool taken = false;
+
+            for( uint8_t t = 0; t < top_num; t++ )
+            {
+                taken = taken || ( top[t] == r );
+            }
+            if( !taken && (( pick < 0 ) || ( ref[r].max > ref[pick].max ) ||
+                           (( ref[r].max == ref[pick].max ) && ( ref[r].max_at < ref[pick].max_at ))))
+            {
+                pick = r;
+            }
+        }
+        top[top_num++] = pick;
+    }
+    for( uint8_t r = 0; r < ref_num; r++ )
+    {
+        uint16_t minor = bench_advs[ref[r].adv].minor;
+
+        if(( minor >= 1 ) && ( minor <= 5 ) &&
+           (( best_hint < 0 ) || ( ref[r].max > ref[best_hint].max ) ||
+            (( ref[r].max == ref[best_hint].max ) && ( ref[r].max_at < ref[best_hint].max_at ))))
+        {
+            best_hint = r;
+        }
+    }
+
+    // Counters
+    app_ble_beacon_get_stats( &stats );
+    if(( stats.adv_reports != bench_reports ) || ( stats.ibeacon_reports != ibeacon ) ||
+       ( stats.approved_reports != approved ) || ( stats.unique_approved != ref_num ) ||
+       ( stats.full_drops != drops ))
+    {
+        bench_fail( scan, "counters differ from the model" );
+    }
+
+    // Uplink records: Major, Minor as on air, max RSSI
+    if( !ble_get_results( result, &size ) || ( size != top_num * BLE_BEACON_UPLINK_RECORD_LEN ))
+    {
+        bench_fail( scan, "wrong number of uplink records" );
+    }
+    for( uint8_t t = 0; t < top_num; t++ )
+    {
+        const bench_adv_t* adv = &bench_advs[ref[top[t]].adv];
+        const uint8_t* record = result + t * BLE_BEACON_UPLINK_RECORD_LEN;
+
+        if(( record[0] != adv->major >> 8 ) || ( record[1] != ( adv->major & 0xFF )) ||
+           ( record[2] != adv->minor >> 8 ) || ( record[3] != ( adv->minor & 0xFF )) ||
+           (( int8_t ) record[4] != ref[top[t]].max ))
+        {
+            bench_fail( scan, "uplink record differs from the model ranking" );
+        }
+    }
+
+    // DR hint
+    if( ble_get_strongest_hint( &hint ) != ( best_hint >= 0 ))
+    {
+        bench_fail( scan, "DR hint presence differs" );
+    }
+    if(( best_hint >= 0 ) && (( hint.major != bench_advs[ref[best_hint].adv].major ) ||
+                              ( hint.minor != bench_advs[ref[best_hint].adv].minor ) ||
+                              ( hint.rssi != ref[best_hint].max )))
+    {
+        bench_fail( scan, "DR hint differs from the model" );
+    }
+
+    // Max, mean and count of every beacon from the result display
+    bench_log_count = 0;
+    bench_log_capture = true;
+    ble_display_results( );
+    bench_log_capture = false;
+    for( uint8_t r = 0; r < ref_num; r++ )
+    {
+        bool found = false;
+
+        for( uint8_t l = 0; l < bench_log_count; l++ )
+        {
+            unsigned major, minor, count;
+            int max, mean;
+            const char* stat = strstr( bench_log_lines[l], "rssi max=" );
+            const char* id = strstr( bench_log_lines[l], "major=" );
+
+            if(( stat == NULL ) || ( id == NULL ) ||
+               ( sscanf( id, "major=%u minor=%u", &major, &minor ) != 2 ) ||
+               ( sscanf( stat, "rssi max=%d mean=%d dBm n=%u", &max, &mean, &count ) != 3 ))
+            {
+                continue;
+            }
+            if(( major == bench_advs[ref[r].adv].major ) && ( minor == bench_advs[ref[r].adv].minor ))
+            {
+                found = ( max == ref[r].max ) && ( mean == ref[r].sum / ref[r].count ) && ( count == ref[r].count );
+                break;
+            }
+        }
+        if( !found )
+        {
+            bench_fail( scan, "beacon aggregate differs from the model" );
+        }
+    }
+    if( bench_verbose )
+    {
+        printf( "scan %u: %u reports, %u iBeacon, %u approved, %u beacons, %u dropped\n",
+                scan, bench_reports, ibeacon, approved, ref_num, drops );
+        for( uint8_t l = 0; l < bench_log_count; l++ )
+        {
+            printf( "%s", bench_log_lines[l] );
+        }
+    }
+}
+
+/*
+ * Report path before the hash table, from app_ble_all.c: generic AD walk, UUID
+ * compared against the whitelist and the config UUID on every report, then a
+ * byte-wise compare against every buffered beacon.
+ */
+static bool legacy_cmp_value( uint8_t* a, uint8_t* b, uint8_t len )
+{
+    for( uint8_t i = 0; i < len; i++ )
+    {
+        if( a[i] != b[i] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const uint8_t* legacy_find_ibeacon_payload( const uint8_t* adv_data, uint16_t adv_len )
+{
+    uint16_t offset = 0;
+
+    while( offset < adv_len )
+    {
+        uint8_t field_len = adv_data[offset];
+
+        if(( field_len == 0 ) || (( offset + field_len ) >= adv_len ))
+        {
+            break;
+        }
+
+        uint8_t field_type = adv_data[offset + 1];
+        const uint8_t* field_data = &adv_data[offset + 2];
+        uint8_t field_data_len = field_len - 1;
+
+        if(( field_type == 0xFF ) && ( field_data_len >= ( 2 + 2 + 0x15 )))
+        {
+            uint16_t company_identifier = 0;
+            memcpy(( uint8_t* )( &company_identifier ), field_data, 2 );
+
+            if(( company_identifier == 0x004C ) && ( field_data[2] == 0x02 ) && ( field_data[3] == 0x15 ))
+            {
+                return field_data;
+            }
+        }
+        offset += field_len + 1;
+    }
+    return NULL;
+}
+
+static void legacy_log_local_name_report( const uint8_t* adv_data, uint16_t adv_len )
+{
+    // Called on every report, returns at once when the log budget is spent
+    ( void ) adv_data;
+    ( void ) adv_len;
+    if( legacy_name_logs >= 8 )
+    {
+        return;
+    }
+    legacy_name_logs++;
+}
+
+static bool legacy_uuid_approved( const uint8_t* uuid )
+{
+    bool have_whitelist = false;
+
+    for( uint8_t i = 0; i < CREW_DR_BLE_UUID_WHITELIST_COUNT; i++ )
+    {
+        have_whitelist = true;
+        if( memcmp( uuid, CREW_DR_BLE_UUID_WHITELIST[i], 16 ) == 0 )
+        {
+            return true;
+        }
+    }
+    if( ble_uuid_filter_num == 16 )
+    {
+        have_whitelist = true;
+        if( memcmp( uuid, ble_uuid_filter_array, 16 ) == 0 )
+        {
+            return true;
+        }
+    }
+    return have_whitelist == false;
+}
+
+static void legacy_report( const uint8_t* adv_data, uint16_t adv_len, const uint8_t* mac, int8_t rssi )
+{
+    legacy_log_local_name_report( adv_data, adv_len );
+
+    const uint8_t* p_data = legacy_find_ibeacon_payload( adv_data, adv_len );
+    if(( p_data == NULL ) || !legacy_uuid_approved( p_data + 4 ))
+    {
+        return;
+    }
+    for( uint8_t j = 0; j < BLE_BEACON_BUF_MAX; j++ )
+    {
+        if( legacy_cmp_value( legacy_buf[j].uuid, ( uint8_t* )( p_data + 4 ), 16 ) &&
+            legacy_cmp_value(( uint8_t* )( &legacy_buf[j].major ), ( uint8_t* )( p_data + 20 ), 2 ) &&
+            legacy_cmp_value(( uint8_t* )( &legacy_buf[j].minor ), ( uint8_t* )( p_data + 22 ), 2 ) &&
+            legacy_cmp_value( legacy_buf[j].mac, ( uint8_t* ) mac, 6 ))
+        {
+            return;
+        }
+    }
+    if(( legacy_res_num < BLE_BEACON_BUF_MAX ) && ( legacy_buf[legacy_res_num].company_id == 0 ))
+    {
+        BleBeacons_t* beacon = &legacy_buf[legacy_res_num];
+
+        beacon->company_id = 0x004C;
+        memcpy( beacon->uuid, p_data + 4, 16 );
+        memcpy(( uint8_t* )( &beacon->major ), p_data + 20, 2 );
+        memcpy(( uint8_t* )( &beacon->minor ), p_data + 22, 2 );
+        memcpy(( uint8_t* )( &beacon->rssi ), p_data + 24, 1 );
+        beacon->rssi_ = rssi;
+        memcpy( beacon->mac, mac, 6 );
+        legacy_res_num++;
+    }
+}
+
+static void legacy_replay( void )
+{
+    memset( legacy_buf, 0, sizeof( legacy_buf ));
+    legacy_res_num = 0;
+    legacy_name_logs = 0;
+    for( uint32_t i = 0; i < bench_reports; i++ )
+    {
+        const bench_adv_t* adv = &bench_advs[bench_storm[i].adv];
+
+        legacy_report( adv->data, adv->len, adv->mac, bench_storm[i].rssi );
+    }
+}
+
+static double bench_now_ns( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    double hash_ns = 0, legacy_ns = 0, start;
+    uint32_t seed;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "s:r:v" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 's':
+            bench_scans = atol( optarg );
+            break;
+        case 'r':
+            bench_reports = atol( optarg );
+            break;
+        case 'v':
+            bench_verbose = true;
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-s scans] [-r reports] [-v]\n", argv[0] );
+            return 2;
+        }
+    }
+    if(( bench_scans == 0 ) || ( bench_reports == 0 ) || ( bench_reports > UINT16_MAX ))
+    {
+        fprintf( stderr, "scans and reports must be 1..65535\n" );
+        return 2;
+    }
+    bench_storm = malloc( bench_reports * sizeof( bench_report_t ));
+    bench_population( );
+    seed = bench_rng;
+
+    // Model check, with and without the config app UUID on top of the whitelist
+    for( uint32_t scan = 0; scan < bench_scans; scan++ )
+    {
+        ble_uuid_filter_num = ( scan & 1 ) ? 16 : 0;
+        memset( ble_uuid_filter_array, 0xA5, sizeof( ble_uuid_filter_array ));
+        bench_storm_fill( );
+        app_ble_beacon_scan_reset( );
+        bench_replay( );
+        bench_check( scan );
+    }
+    printf( "model check: %u scans x %u reports from %u advertisers (%u approved iBeacons, table %u): match\n",
+            bench_scans, bench_reports, BENCH_ADVERTISERS, BENCH_APPROVED, BLE_BEACON_BUF_MAX );
+
+    // Timing, same storms through both paths
+    bench_rng = seed;
+    ble_uuid_filter_num = 16;
+    for( uint32_t scan = 0; scan < bench_scans; scan++ )
+    {
+        bench_storm_fill( );
+
+        start = bench_now_ns( );
+        app_ble_beacon_scan_reset( );
+        bench_replay( );
+        hash_ns += bench_now_ns( ) - start;
+
+        start = bench_now_ns( );
+        legacy_replay( );
+        legacy_ns += bench_now_ns( ) - start;
+    }
+    printf( "report path: %.1f ns/report (hash table, max/mean aggregation)\n",
+            hash_ns / (( double ) bench_scans * bench_reports ));
+    printf( "legacy path: %.1f ns/report (linear scan, first RSSI only)\n",
+            legacy_ns / (( double ) bench_scans * bench_reports ));
+
+    free( bench_storm );
+    printf( "PASS\n" );
+    return 0;
+}
@@ -0,0 +1,626 @@
+/*!
+ * @file      drift_fit_replay.c
+ *
+ * @brief     Host replay of synthetic PIW drift tracks through the drift fit
+ *
+ * Each track is a person in the water drifting at a constant velocity (0.1 to
+ * 1.5 m/s, any heading, latitude within +-60 deg), fixed every 60 s as in PIW
+ * phase 2. Fixes carry Gaussian noise of HDOP * REMEX_PIW_DRIFT_UERE_M with
+ * HDOP drawn from 0.7 to 3, and one in 12 is thrown 200 m off the track.
+ *
+ * Every fix goes through mob_drift.c and through a copy of the two-pass fit
+ * it replaced, which collected the window twice per fix and re-projected and
+ * gated every fix with cosf( ) and sqrtf( ). The report compares the two
+ * vectors with each other and with the true heading and speed, counts the
+ * libm calls of each per fix (linker wraps, hence -fno-builtin) and times
+ * each, in TSC cycles on x86 hosts and in ns otherwise. The COG divergence is
+ * bounded on its mean and, above REPLAY_TRUTH_MIN_SPEED_MPS where the heading
+ * is defined, on its maximum.
+ *
+ * The default window is the firmware one; other sizes with
+ * -DREMEX_PIW_DRIFT_FIX_WINDOW=<n>.
+ *
+ *   gcc -O2 -fno-builtin -I../inc -I../../peripherals/inc -I../../../apps/common \
+ *       -Wl,--wrap=cosf,--wrap=sqrtf,--wrap=atan2f drift_fit_replay.c ../src/mob_drift.c -lm -o drift_fit_replay
+ *   ./drift_fit_replay [-n tracks] [-f fixes] [-s seed] [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "mob_drift.h"
+#include "default_config_settings.h"
+#include "log_filter.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define REPLAY_TRACKS               200
+#define REPLAY_FIXES                400
+#define REPLAY_INTERVAL_S           60
+#define REPLAY_OUTLIER_ONE_IN       12
+#define REPLAY_OUTLIER_M            200.0
+#define REPLAY_MIN_SPEED_MPS        0.1
+#define REPLAY_MAX_SPEED_MPS        1.5
+#define REPLAY_TRUTH_MIN_SPEED_MPS  0.3     // Heading error only judged above this drift
+#define REPLAY_MAX_MEAN_COG_DIFF    0.5     // Pass limits against the legacy fit, deg
+#define REPLAY_MAX_COG_DIFF         5.0     // deg, vectors at or above REPLAY_TRUTH_MIN_SPEED_MPS
+#define REPLAY_MAX_MEAN_SOG_DIFF    0.05    // m/s
+#define REPLAY_MAX_VALID_MISMATCH   0.01    // Fraction of fixes
+
+#define LEGACY_DEG_TO_RAD           0.01745329251994329577f
+#define LEGACY_RAD_TO_DEG           57.295779513082320876f
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define REPLAY_UNIT                 "cycles"
+#else
+#define REPLAY_UNIT                 "ns"
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    uint32_t cosf;
+    uint32_t sqrtf;
+    uint32_t atan2f;
+} replay_libm_t;
+
+// Legacy fit, as in marine_gnss.c before the running moments
+typedef struct
+{
+    bool     valid;
+    int32_t  latitude;
+    int32_t  longitude;
+    uint32_t timestamp_s;
+    uint32_t epoch_ms;
+    float    sigma_m;
+} legacy_fix_t;
+
+typedef struct
+{
+    bool     valid;
+    float    east0_m;
+    float    north0_m;
+    float    east_mps;
+    float    north_mps;
+    float    ref_lat_rad;
+    int32_t  ref_latitude;
+    int32_t  ref_longitude;
+    uint32_t t0_s;
+    uint32_t t_first_s;
+    uint32_t t_last_s;
+    uint32_t baseline_s;
+    uint8_t  fix_count;
+    uint8_t  used_count;
+    uint8_t  rejected_count;
+    float    rms_residual_m;
+} legacy_fit_t;
+
+typedef struct
+{
+    gnss_fix_t fix;
+    uint32_t   epoch_s;
+} replay_sample_t;
+
+typedef struct
+{
+    uint32_t both_valid;
+    uint32_t valid_mismatch;
+    double   cog_diff_sum;
+    double   cog_diff_max;         // over the vectors at or above REPLAY_TRUTH_MIN_SPEED_MPS
+    double   sog_diff_sum;
+    uint32_t truth_count[2];        // legacy, new
+    double   truth_cog_sum[2];
+} replay_compare_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static int replay_tracks = REPLAY_TRACKS;
+static int replay_fixes = REPLAY_FIXES;
+static bool replay_verbose = false;
+static uint64_t replay_rng = 0x9E3779B97F4A7C15ull;
+
+static replay_libm_t* replay_libm = NULL;   // counters of the path running, NULL when timing
+static replay_libm_t legacy_libm;
+static replay_libm_t new_libm;
+
+static legacy_fix_t legacy_fixes[REMEX_PIW_DRIFT_FIX_WINDOW];
+static uint8_t legacy_fix_next = 0;
+static uint8_t legacy_fix_count = 0;
+static mob_drift_vector_t legacy_vector;
+
+static replay_sample_t* replay_track;
+static double replay_truth_cog;
+static double replay_truth_sog;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+float __real_cosf( float x );
+float __real_sqrtf( float x );
+float __real_atan2f( float y, float x );
+
+float __wrap_cosf( float x )
+{
+    if( replay_libm != NULL ) replay_libm->cosf++;
+    return __real_cosf( x );
+}
+
+float __wrap_sqrtf( float x )
+{
+    if( replay_libm != NULL ) replay_libm->sqrtf++;
+    return __real_sqrtf( x );
+}
+
+float __wrap_atan2f( float y, float x )
+{
+    if( replay_libm != NULL ) replay_libm->atan2f++;
+    return __real_atan2f( y, x );
+}
+
+void log_filter_printf( log_filter_category_t category, const char* fmt, ... )
+{
+    va_list args;
+
+    ( void ) category;
+    if( replay_verbose )
+    {
+        va_start( args, fmt );
+        vprintf( fmt, args );
+        va_end( args );
+    }
+}
+
+static uint64_t replay_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t ) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static double replay_uniform( void )
+{
+    replay_rng ^= replay_rng << 13;
+    replay_rng ^= replay_rng >> 7;
+    replay_rng ^= replay_rng << 17;
+    return ( replay_rng >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+static double replay_gauss( void )
+{
+    double u = replay_uniform( ) + 1e-12;
+    return sqrt( -2.0 * log( u )) * cos( 2.0 * M_PI * replay_uniform( ));
+}
+
+/*!
+ * @brief Draw one drift track and its fixes
+ */
+static void replay_make_track( void )
+{
+    const double m_per_deg = 6371000.0 * M_PI / 180.0;
+    double lat0 = ( replay_uniform( ) * 120.0 ) - 60.0;
+    double lon0 = ( replay_uniform( ) * 360.0 ) - 180.0;
+    double cog = replay_uniform( ) * 360.0;
+    double sog = REPLAY_MIN_SPEED_MPS + replay_uniform( ) * ( REPLAY_MAX_SPEED_MPS - REPLAY_MIN_SPEED_MPS );
+    uint32_t start_s = 1000 + ( uint32_t )( replay_uniform( ) * 86400.0 );
+
+    replay_truth_cog = cog;
+    replay_truth_sog = sog;
+    for( int i = 0; i < replay_fixes; i++ )
+    {
+        gnss_fix_t* fix = &replay_track[i].fix;
+        double t = ( double ) i * REPLAY_INTERVAL_S;
+        double hdop = 0.7 + replay_uniform( ) * 2.3;
+        double sigma = hdop * REMEX_PIW_DRIFT_UERE_M;
+        double east = sog * sin( cog * M_PI / 180.0 ) * t + sigma * replay_gauss( );
+        double north = sog * cos( cog * M_PI / 180.0 ) * t + sigma * replay_gauss( );
+        double lat;
+
+        if( replay_uniform( ) < 1.0 / REPLAY_OUTLIER_ONE_IN )
+        {
+            double a = replay_uniform( ) * 2.0 * M_PI;
+            east += REPLAY_OUTLIER_M * sin( a );
+            north += REPLAY_OUTLIER_M * cos( a );
+        }
+        lat = lat0 + north / m_per_deg;
+        memset( fix, 0, sizeof( *fix ));
+        fix->latitude = ( int32_t ) lround( lat * 1e6 );
+        fix->longitude = ( int32_t ) lround(( lon0 + east / ( m_per_deg * cos( lat * M_PI / 180.0 ))) * 1e6 );
+        fix->hdop = ( float ) hdop;
+        fix->fix_quality = 1;
+        fix->valid = true;
+        replay_track[i].epoch_s = start_s + ( uint32_t ) t;
+        fix->timestamp_ms = replay_track[i].epoch_s * 1000u;
+    }
+}
+
+static void legacy_reset( void )
+{
+    memset( legacy_fixes, 0, sizeof( legacy_fixes ));
+    legacy_fix_next = 0;
+    legacy_fix_count = 0;
+    memset( &legacy_vector, 0, sizeof( legacy_vector ));
+    legacy_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
+    legacy_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
+}
+
+static uint8_t legacy_collect_fixes( legacy_fix_t* ordered )
+{
+    uint8_t count = 0;
+
+    for( uint8_t i = 0; i < legacy_fix_count; i++ )
+    {
+        uint8_t index = ( legacy_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - legacy_fix_count + i ) %
+                        REMEX_PIW_DRIFT_FIX_WINDOW;
+        if( legacy_fixes[index].valid )
+        {
+            ordered[count++] = legacy_fixes[index];
+        }
+    }
+    return count;
+}
+
+static void legacy_local_xy_m( const legacy_fix_t* fix, const legacy_fit_t* fit, float* east_m, float* north_m )
+{
+    float lat_rad = (( float ) fix->latitude / 1000000.0f ) * LEGACY_DEG_TO_RAD;
+    float mean_lat = ( lat_rad + fit->ref_lat_rad ) * 0.5f;
+    float m_per_udeg = MOB_DRIFT_EARTH_RADIUS_M * LEGACY_DEG_TO_RAD / 1000000.0f;
+
+    /*
+     * Differenced in integer micro-degrees like mob_drift.c. The original took
+     * the difference of two float radians, which rounds by up to 1.5 m and
+     * decided gate calls that sit on the limit by noise, so the two paths
+     * disagreed on them.
+     */
+    *east_m = ( float )( fix->longitude - fit->ref_longitude ) * m_per_udeg * cosf( mean_lat );
+    *north_m = ( float )( fix->latitude - fit->ref_latitude ) * m_per_udeg;
+}
+
+static float legacy_fit_residual_m( const legacy_fit_t* fit, const legacy_fix_t* fix )
+{
+    float east_m = 0.0f;
+    float north_m = 0.0f;
+    float dt_s = ( float )( fix->timestamp_s - fit->t0_s );
+
+    legacy_local_xy_m( fix, fit, &east_m, &north_m );
+
+    float east_residual = east_m - ( fit->east0_m + ( fit->east_mps * dt_s ));
+    float north_residual = north_m - ( fit->north0_m + ( fit->north_mps * dt_s ));
+    return sqrtf(( east_residual * east_residual ) + ( north_residual * north_residual ));
+}
+
+static bool legacy_fit_history( const legacy_fit_t* reject_fit, legacy_fit_t* fit )
+{
+    legacy_fix_t fixes[REMEX_PIW_DRIFT_FIX_WINDOW];
+    uint8_t total_count = legacy_collect_fixes( fixes );
+
+    if( total_count < REMEX_PIW_DRIFT_MIN_FIXES )
+    {
+        return false;
+    }
+
+    memset( fit, 0, sizeof( *fit ));
+    fit->fix_count = total_count;
+    fit->t0_s = fixes[0].timestamp_s;
+    fit->ref_lat_rad = (( float ) fixes[0].latitude / 1000000.0f ) * LEGACY_DEG_TO_RAD;
+    fit->ref_latitude = fixes[0].latitude;
+    fit->ref_longitude = fixes[0].longitude;
+
+    float sw = 0.0f, swt = 0.0f, swtt = 0.0f, swe = 0.0f, swn = 0.0f, swte = 0.0f, swtn = 0.0f;
+
+    for( uint8_t i = 0; i < total_count; i++ )
+    {
+        if( reject_fit != NULL && reject_fit->valid )
+        {
+            float residual_m = legacy_fit_residual_m( reject_fit, &fixes[i] );
+            float allowed_m = ( fixes[i].sigma_m * REMEX_PIW_DRIFT_OUTLIER_SIGMA ) + REMEX_PIW_DRIFT_OUTLIER_MARGIN_M;
+            if( residual_m > allowed_m )
+            {
+                fit->rejected_count++;
+                continue;
+            }
+        }
+
+        float east_m = 0.0f;
+        float north_m = 0.0f;
+        float t_s = ( float )( fixes[i].timestamp_s - fit->t0_s );
+        float w = 1.0f / ( fixes[i].sigma_m * fixes[i].sigma_m );
+
+        legacy_local_xy_m( &fixes[i], fit, &east_m, &north_m );
+        if( fit->used_count == 0 )
+        {
+            fit->t_first_s = fixes[i].timestamp_s;
+        }
+        fit->t_last_s = fixes[i].timestamp_s;
+        fit->used_count++;
+
+        sw += w;
+        swt += w * t_s;
+        swtt += w * t_s * t_s;
+        swe += w * east_m;
+        swn += w * north_m;
+        swte += w * t_s * east_m;
+        swtn += w * t_s * north_m;
+    }
+
+    if( fit->used_count < REMEX_PIW_DRIFT_MIN_FIXES )
+    {
+        return false;
+    }
+
+    float denom = ( sw * swtt ) - ( swt * swt );
+    if( denom <= 0.0001f )
+    {
+        return false;
+    }
+
+    fit->east_mps = (( sw * swte ) - ( swt * swe )) / denom;
+    fit->north_mps = (( sw * swtn ) - ( swt * swn )) / denom;
+    fit->east0_m = ( swe - ( fit->east_mps * swt )) / sw;
+    fit->north0_m = ( swn - ( fit->north_mps * swt )) / sw;
+    fit->baseline_s = fit->t_last_s - fit->t_first_s;
+
+    float residual_sq_sum = 0.0f;
+    uint8_t residual_count = 0;
+    for( uint8_t i = 0; i < total_count; i++ )
+    {
+        if( reject_fit != NULL && reject_fit->valid )
+        {
+            float residual_m = legacy_fit_residual_m( reject_fit, &fixes[i] );
+            float allowed_m = ( fixes[i].sigma_m * REMEX_PIW_DRIFT_OUTLIER_SIGMA ) + REMEX_PIW_DRIFT_OUTLIER_MARGIN_M;
+            if( residual_m > allowed_m )
+            {
+                continue;
+            }
+        }
+
+        float residual_m = legacy_fit_residual_m( fit, &fixes[i] );
+        residual_sq_sum += residual_m * residual_m;
+        residual_count++;
+    }
+
+    fit->rms_residual_m = residual_count > 0 ? sqrtf( residual_sq_sum / ( float ) residual_count ) : 0.0f;
+    fit->valid = true;
+    return true;
+}
+
+static void legacy_add_fix( const gnss_fix_t* fix, uint32_t epoch_s )
+{
+    legacy_fit_t provisional_fit;
+    legacy_fit_t robust_fit;
+
+    if( legacy_fix_count > 0 )
+    {
+        uint8_t last_index = ( legacy_fix_next + REMEX_PIW_DRIFT_FIX_WINDOW - 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
+        if( legacy_fixes[last_index].valid &&
+            ( legacy_fixes[last_index].epoch_ms == fix->timestamp_ms ||
+              ( legacy_fixes[last_index].latitude == fix->latitude &&
+                legacy_fixes[last_index].longitude == fix->longitude &&
+                ( epoch_s - legacy_fixes[last_index].timestamp_s ) < REMEX_PIW_DRIFT_DUPLICATE_FIX_S )))
+        {
+            return;
+        }
+    }
+
+    legacy_fixes[legacy_fix_next].valid = true;
+    legacy_fixes[legacy_fix_next].latitude = fix->latitude;
+    legacy_fixes[legacy_fix_next].longitude = fix->longitude;
+    legacy_fixes[legacy_fix_next].timestamp_s = epoch_s;
+    legacy_fixes[legacy_fix_next].epoch_ms = fix->timestamp_ms;
+    legacy_fixes[legacy_fix_next].sigma_m = mob_drift_sigma_m( fix );
+    legacy_fix_next = ( legacy_fix_next + 1 ) % REMEX_PIW_DRIFT_FIX_WINDOW;
+    if( legacy_fix_count < REMEX_PIW_DRIFT_FIX_WINDOW )
+    {
+        legacy_fix_count++;
+    }
+
+    if( !legacy_fit_history( NULL, &provisional_fit ) || !legacy_fit_history( &provisional_fit, &robust_fit ))
+    {
+        return;
+    }
+
+    float sog_mps = sqrtf(( robust_fit.east_mps * robust_fit.east_mps ) + ( robust_fit.north_mps * robust_fit.north_mps ));
+    float track_span_m = sog_mps * ( float ) robust_fit.baseline_s;
+
+    if( robust_fit.baseline_s < REMEX_PIW_DRIFT_MIN_BASELINE_S || track_span_m < REMEX_PIW_DRIFT_MIN_TRACK_SPAN_M ||
+        sog_mps > REMEX_PIW_DRIFT_MAX_TRACK_SPEED_MPS )
+    {
+        legacy_vector.valid = false;
+        legacy_vector.cog_x2 = MOB_DRIFT_UNKNOWN_COG_X2;
+        legacy_vector.sog_dmps = MOB_DRIFT_UNKNOWN_SOG_DMPS;
+        return;
+    }
+
+    float cog_deg = atan2f( robust_fit.east_mps, robust_fit.north_mps ) * LEGACY_RAD_TO_DEG;
+    if( cog_deg < 0.0f )
+    {
+        cog_deg += 360.0f;
+    }
+    uint16_t cog_x2 = ( uint16_t )( cog_deg * 2.0f + 0.5f );
+    if( cog_x2 >= 720U )
+    {
+        cog_x2 = 0;
+    }
+
+    legacy_vector.valid = true;
+    legacy_vector.cog_x2 = cog_x2;
+    legacy_vector.east_mps = robust_fit.east_mps;
+    legacy_vector.north_mps = robust_fit.north_mps;
+    legacy_vector.sog_mps = sog_mps;
+}
+
+static double replay_angle_diff( double a, double b )
+{
+    double d = fabs( a - b );
+
+    return ( d > 180.0 ) ? 360.0 - d : d;
+}
+
+static void replay_truth( replay_compare_t* compare, int path, const mob_drift_vector_t* vector )
+{
+    if( vector->valid && ( replay_truth_sog >= REPLAY_TRUTH_MIN_SPEED_MPS ))
+    {
+        compare->truth_count[path]++;
+        compare->truth_cog_sum[path] += replay_angle_diff( vector->cog_x2 / 2.0, replay_truth_cog );
+    }
+}
+
+/*!
+ * @brief Time one path over the current track
+ */
+static uint64_t replay_time( void ( *reset )( void ), void ( *add )( const gnss_fix_t*, uint32_t ))
+{
+    uint64_t t0 = replay_ticks( );
+
+    reset( );
+    for( int i = 0; i < replay_fixes; i++ )
+    {
+        add( &replay_track[i].fix, replay_track[i].epoch_s );
+    }
+    return replay_ticks( ) - t0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    replay_compare_t compare;
+    mob_drift_vector_t vector;
+    uint64_t legacy_ticks = 0, new_ticks = 0;
+    uint32_t total;
+    double mean_cog, mean_sog, mismatch;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "n:f:s:v" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            replay_tracks = atoi( optarg );
+            break;
+        case 'f':
+            replay_fixes = atoi( optarg );
+            break;
+        case 's':
+            replay_rng ^= strtoull( optarg, NULL, 0 ) * 0x2545F4914F6CDD1Dull;
+            break;
+        case 'v':
+            replay_verbose = true;
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-n tracks] [-f fixes] [-s seed] [-v]\n", argv[0] );
+            return 2;
+        }
+    }
+    if(( replay_tracks <= 0 ) || ( replay_fixes <= 0 ))
+    {
+        return 2;
+    }
+    replay_track = calloc( replay_fixes, sizeof( replay_sample_t ));
+    memset( &compare, 0, sizeof( compare ));
+
+    for( int track = 0; track < replay_tracks; track++ )
+    {
+        replay_make_track( );
+
+        // Fix by fix, both paths side by side, with their libm calls counted
+        legacy_reset( );
+        mob_drift_reset( );
+        for( int i = 0; i < replay_fixes; i++ )
+        {
+            replay_libm = &legacy_libm;
+            legacy_add_fix( &replay_track[i].fix, replay_track[i].epoch_s );
+            replay_libm = &new_libm;
+            mob_drift_add_fix( &replay_track[i].fix, replay_track[i].epoch_s );
+            replay_libm = NULL;
+
+            mob_drift_get_result( &vector );
+            if( legacy_vector.valid != vector.valid )
+            {
+                compare.valid_mismatch++;
+            }
+            else if( vector.valid )
+            {
+                double d = replay_angle_diff( legacy_vector.cog_x2 / 2.0, vector.cog_x2 / 2.0 );
+                compare.both_valid++;
+                compare.cog_diff_sum += d;
+                if(( legacy_vector.sog_mps >= REPLAY_TRUTH_MIN_SPEED_MPS ) && ( d > compare.cog_diff_max ))
+                {
+                    compare.cog_diff_max = d;
+                }
+                compare.sog_diff_sum += fabs( legacy_vector.sog_mps - vector.sog_mps );
+            }
+            replay_truth( &compare, 0, &legacy_vector );
+            replay_truth( &compare, 1, &vector );
+        }
+
+        // Then each path alone for the timing
+        legacy_ticks += replay_time( legacy_reset, legacy_add_fix );
+        new_ticks += replay_time( mob_drift_reset, mob_drift_add_fix );
+    }
+
+    total = ( uint32_t ) replay_tracks * replay_fixes;
+    mean_cog = compare.both_valid ? compare.cog_diff_sum / compare.both_valid : 0.0;
+    mean_sog = compare.both_valid ? compare.sog_diff_sum / compare.both_valid : 0.0;
+    mismatch = ( double ) compare.valid_mismatch / total;
+
+    printf( "window %d fixes, %d tracks x %d fixes every %d s\n", REMEX_PIW_DRIFT_FIX_WINDOW, replay_tracks,
+            replay_fixes, REPLAY_INTERVAL_S );
+    printf( "vectors         %u on both, %u on one only (%.2f%%)\n", compare.both_valid, compare.valid_mismatch,
+            100.0 * mismatch );
+    printf( "new vs legacy   COG mean %.3f deg, max %.1f deg (drift >= %.1f m/s), SOG mean %.4f m/s\n", mean_cog,
+            compare.cog_diff_max, REPLAY_TRUTH_MIN_SPEED_MPS, mean_sog );
+    printf( "vs true heading legacy %.2f deg, new %.2f deg (drift >= %.1f m/s)\n",
+            compare.truth_count[0] ? compare.truth_cog_sum[0] / compare.truth_count[0] : 0.0,
+            compare.truth_count[1] ? compare.truth_cog_sum[1] / compare.truth_count[1] : 0.0,
+            REPLAY_TRUTH_MIN_SPEED_MPS );
+    printf( "libm per fix    legacy cosf %.1f sqrtf %.1f atan2f %.2f, new cosf %.2f sqrtf %.2f atan2f %.2f\n",
+            ( double ) legacy_libm.cosf / total, ( double ) legacy_libm.sqrtf / total,
+            ( double ) legacy_libm.atan2f / total, ( double ) new_libm.cosf / total,
+            ( double ) new_libm.sqrtf / total, ( double ) new_libm.atan2f / total );
+    printf( "cost per fix    legacy %.0f %s, new %.0f %s\n", ( double ) legacy_ticks / total, REPLAY_UNIT,
+            ( double ) new_ticks / total, REPLAY_UNIT );
+
+    free( replay_track );
+    if(( mean_cog > REPLAY_MAX_MEAN_COG_DIFF ) || ( compare.cog_diff_max > REPLAY_MAX_COG_DIFF ) ||
+       ( mean_sog > REPLAY_MAX_MEAN_SOG_DIFF ) || ( mismatch > REPLAY_MAX_VALID_MISMATCH ))
+    {
+        printf( "FAIL\n" );
+        return 1;
+    }
+    printf( "PASS\n" );
+    return 0;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
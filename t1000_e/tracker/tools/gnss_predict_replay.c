@@ -0,0 +1,396 @@
+/*!
+ * @file      gnss_predict_replay.c
+ *
+ * @brief     Host replay of NMEA captures through the GNSS fix predictor
+ *
+ * Each capture is one scan from power-on: raw AG3335 output as saved from the
+ * 'N' NMEA debug stream or a UART logger, one sentence per line, anything
+ * before '$' ignored. The firmware path is reproduced: nmea_stream tokenizes,
+ * nmea_parse decodes, gnss_sky keeps the sky table and gnss_fix_predict judges
+ * the scan once per epoch. Time advances with the RMC time of day.
+ *
+ * A scan without prediction ends at the first epoch meeting the HDOP/HACC
+ * gates, or at the budget. For each threshold the report shows the fixes the
+ * predictor kept and lost, and the receiver time it saved on scans that would
+ * not have produced a fix anyway.
+ *
+ *   gcc -O2 -I../inc -I../../peripherals/inc -I../../../apps/common \
+ *       gnss_predict_replay.c ../src/gnss_fix_predict.c ../../peripherals/src/gnss_sky.c \
+ *       ../../peripherals/src/nmea_stream.c ../../peripherals/src/nmea_parse.c -lm -o gnss_predict_replay
+ *   ./gnss_predict_replay [-b budget_s] [-d hdop] [-a hacc_m] [-p pct | -s] [-v] capture.nmea...
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "nmea_stream.h"
+#include "nmea_parse.h"
+#include "gnss_sky.h"
+#include "gnss_fix_predict.h"
+#include "log_filter.h"
+#include "default_config_settings.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define REPLAY_DEFAULT_BUDGET_S     20          // PIW_GNSS_MAX_SCAN_MS
+#define REPLAY_DEFAULT_HDOP         3.0f        // PIW_GNSS_MAX_HDOP
+#define REPLAY_DEFAULT_HACC_M       15.0f       // PIW_GNSS_MAX_HACC_M
+#define REPLAY_EPOCH_MS             1000
+#define REPLAY_MAX_EPOCH_GAP_MS     10000       // Longer RMC gaps count as one epoch
+#define REPLAY_DEFAULT_PCT          10          // Candidate threshold, the firmware ships with the predictor off
+#define REPLAY_SWEEP_MAX_PCT        50
+#define REPLAY_SWEEP_STEP_PCT       5
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct {
+    uint32_t ttgf_ms;           // Time to the first quality epoch, 0 if none within the budget
+    uint32_t stop_ms;           // Time the predictor stopped the scan, 0 if it did not
+    uint8_t  stop_prob;         // Probability at that time
+    uint32_t on_ms;             // Receiver time with the predictor
+    uint32_t base_on_ms;        // Receiver time without it
+} replay_result_t;
+
+typedef struct {
+    uint32_t scans;
+    uint32_t fixes;             // Scans with a quality fix within the budget
+    uint32_t kept;
+    uint32_t lost;
+    uint32_t early;             // Scans without a fix stopped early
+    uint64_t on_ms;
+    uint64_t base_on_ms;
+} replay_total_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static bool replay_verbose = false;
+static float replay_max_hdop = REPLAY_DEFAULT_HDOP;
+static float replay_max_hacc = REPLAY_DEFAULT_HACC_M;
+static uint32_t replay_budget_ms = REPLAY_DEFAULT_BUDGET_S * 1000;
+
+// Scan state for the capture being replayed
+static replay_result_t replay;
+static uint32_t replay_now_ms;
+static int32_t replay_rmc_time_ms;
+static bool replay_done;
+static bool replay_gga_good;
+static int32_t replay_hdop_x100;
+static int32_t replay_hacc_cm;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+// Trace output of gnss_fix_predict.c
+void log_filter_printf( log_filter_category_t category, const char* fmt, ... )
+{
+    va_list args;
+
+    ( void ) category;
+    if( !replay_verbose )
+    {
+        return;
+    }
+    va_start( args, fmt );
+    printf( "    " );
+    vprintf( fmt, args );
+    va_end( args );
+}
+
+static void replay_epoch_end( void )
+{
+    gnss_sky_metrics_t sky;
+    gnss_fix_predict_t eval;
+    bool good = false;
+
+    if( replay_done )
+    {
+        return;
+    }
+
+    // Same gates as gnss_scan_until_good( ), HDOP * 5 m when GST is missing
+    if( replay_gga_good )
+    {
+        float hdop = replay_hdop_x100 / 100.0f;
+        float hacc = ( replay_hacc_cm >= 0 ) ? replay_hacc_cm / 100.0f : hdop * 5.0f;
+
+        good = ( hdop <= replay_max_hdop ) && ( hacc <= replay_max_hacc );
+    }
+    if( good )
+    {
+        replay.ttgf_ms = replay_now_ms > 0 ? replay_now_ms : 1;
+        replay_done = true;
+        return;
+    }
+
+    gnss_sky_table_metrics( &sky, replay_now_ms );
+    if( replay.stop_ms == 0 && gnss_fix_predict_update( replay_now_ms, replay_budget_ms, &sky, &eval ))
+    {
+        replay.stop_ms = replay_now_ms;
+        replay.stop_prob = eval.probability;
+    }
+
+    replay_gga_good = false;
+    replay_hacc_cm = -1;
+}
+
+static void replay_sentence( const nmea_sentence_t* sentence )
+{
+    switch( sentence->id )
+    {
+        case NMEA_ID_RMC:
+        {
+            nmea_rmc_t rmc;
+
+            if( !nmea_parse_rmc( sentence, &rmc ) || rmc.time_ms < 0 || rmc.time_ms == replay_rmc_time_ms )
+            {
+                break;
+            }
+            if( replay_rmc_time_ms >= 0 )
+            {
+                int32_t step = rmc.time_ms - replay_rmc_time_ms;
+
+                replay_epoch_end( );
+                replay_now_ms += ( step > 0 && step <= REPLAY_MAX_EPOCH_GAP_MS ) ? step : REPLAY_EPOCH_MS;
+            }
+            replay_rmc_time_ms = rmc.time_ms;
+            break;
+        }
+        case NMEA_ID_GGA:
+        {
+            nmea_gga_t gga;
+
+            if( nmea_parse_gga( sentence, &gga ) && gga.fix_quality > 0 && gga.hdop_x100 != NMEA_PARSE_NONE )
+            {
+                replay_gga_good = true;
+                replay_hdop_x100 = gga.hdop_x100;
+            }
+            break;
+        }
+        case NMEA_ID_GST:
+        {
+            nmea_gst_t gst;
+
+            if( nmea_parse_gst( sentence, &gst ) && gst.latitude_err_cm != NMEA_PARSE_NONE &&
+                gst.longitude_err_cm != NMEA_PARSE_NONE )
+            {
+                replay_hacc_cm = ( int32_t ) sqrtf(( float ) gst.latitude_err_cm * gst.latitude_err_cm +
+                                                   ( float ) gst.longitude_err_cm * gst.longitude_err_cm );
+            }
+            break;
+        }
+        case NMEA_ID_GSV:
+        {
+            nmea_gsv_t gsv;
+
+            if( nmea_parse_gsv( sentence, &gsv ))
+            {
+                gnss_sky_table_update( sentence, &gsv, replay_now_ms );
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static bool replay_capture( const char* path, uint8_t min_prob_pct, replay_result_t* result )
+{
+    nmea_stream_t stream;
+    FILE* file = fopen( path, "rb" );
+    uint8_t buf[256];
+    size_t len = 0;
+
+    if( file == NULL )
+    {
+        perror( path );
+        return false;
+    }
+
+    memset( &replay, 0, sizeof( replay ));
+    replay_now_ms = 0;
+    replay_rmc_time_ms = -1;
+    replay_done = false;
+    replay_gga_good = false;
+    replay_hacc_cm = -1;
+    gnss_sky_table_reset( );
+    gnss_fix_predict_set_threshold( min_prob_pct );
+    gnss_fix_predict_start( );
+    nmea_stream_init( &stream, replay_sentence );
+
+    while( !replay_done && replay_now_ms < replay_budget_ms && ( len = fread( buf, 1, sizeof( buf ), file )) > 0 )
+    {
+        nmea_stream_feed_buffer( &stream, buf, len );
+    }
+    if( !replay_done && replay_now_ms < replay_budget_ms )
+    {
+        replay_epoch_end( );
+    }
+    fclose( file );
+
+    if( replay.ttgf_ms > replay_budget_ms )
+    {
+        replay.ttgf_ms = 0;
+    }
+    replay.base_on_ms = replay.ttgf_ms ? replay.ttgf_ms : replay_budget_ms;
+    replay.on_ms = replay.stop_ms ? replay.stop_ms : replay.base_on_ms;
+    *result = replay;
+    return true;
+}
+
+static void replay_add( replay_total_t* total, const replay_result_t* result )
+{
+    total->scans++;
+    total->on_ms += result->on_ms;
+    total->base_on_ms += result->base_on_ms;
+    if( result->ttgf_ms )
+    {
+        total->fixes++;
+        if( result->stop_ms )
+        {
+            total->lost++;
+        }
+        else
+        {
+            total->kept++;
+        }
+    }
+    else if( result->stop_ms )
+    {
+        total->early++;
+    }
+}
+
+static void replay_print_total( uint8_t min_prob_pct, const replay_total_t* total )
+{
+    double saved = total->base_on_ms ? 100.0 * ( double )( total->base_on_ms - total->on_ms ) / total->base_on_ms : 0.0;
+
+    printf( "%3u %% %6u %6u %6u %6u %6u %10.1f %10.1f %6.1f %%\n", min_prob_pct, total->scans, total->fixes,
+            total->kept, total->lost, total->early, total->base_on_ms / 1000.0, total->on_ms / 1000.0, saved );
+}
+
+static void replay_usage( const char* name )
+{
+    fprintf( stderr,
+             "usage: %s [-b budget_s] [-d hdop] [-a hacc_m] [-p pct | -s] [-v] capture.nmea...\n"
+             "  -b  scan budget, default %u s\n"
+             "  -d  HDOP gate, default %.1f\n"
+             "  -a  HACC gate, default %.1f m\n"
+             "  -p  stop threshold, default %u %%\n"
+             "  -s  sweep thresholds 0..%u %% and print the totals only\n"
+             "  -v  print every predictor evaluation\n",
+             name, REPLAY_DEFAULT_BUDGET_S, REPLAY_DEFAULT_HDOP, REPLAY_DEFAULT_HACC_M,
+             REPLAY_DEFAULT_PCT, REPLAY_SWEEP_MAX_PCT );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char* argv[] )
+{
+    int min_prob_pct = REPLAY_DEFAULT_PCT;
+    bool sweep = false;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "b:d:a:p:sv" )) != -1 )
+    {
+        switch( opt )
+        {
+            case 'b': replay_budget_ms = ( uint32_t )( atof( optarg ) * 1000.0 ); break;
+            case 'd': replay_max_hdop = atof( optarg ); break;
+            case 'a': replay_max_hacc = atof( optarg ); break;
+            case 'p': min_prob_pct = atoi( optarg ); break;
+            case 's': sweep = true; break;
+            case 'v': replay_verbose = true; break;
+            default: replay_usage( argv[0] ); return 2;
+        }
+    }
+    if( optind >= argc || replay_budget_ms == 0 || min_prob_pct < 0 || min_prob_pct > 100 )
+    {
+        replay_usage( argv[0] );
+        return 2;
+    }
+
+    if( !sweep )
+    {
+        replay_total_t total = { 0 };
+
+        for( int i = optind; i < argc; i++ )
+        {
+            replay_result_t result;
+
+            if( replay_verbose )
+            {
+                printf( "%s\n", argv[i] );
+            }
+            if( !replay_capture( argv[i], min_prob_pct, &result ))
+            {
+                return 1;
+            }
+            replay_add( &total, &result );
+
+            printf( "%-40s ", argv[i] );
+            if( result.ttgf_ms && result.stop_ms )
+            {
+                printf( "LOST fix at %.1f s, stopped at %.1f s (p=%u %%)\n", result.ttgf_ms / 1000.0,
+                        result.stop_ms / 1000.0, result.stop_prob );
+            }
+            else if( result.ttgf_ms )
+            {
+                printf( "kept, fix at %.1f s\n", result.ttgf_ms / 1000.0 );
+            }
+            else if( result.stop_ms )
+            {
+                printf( "saved %.1f s, stopped at %.1f s (p=%u %%)\n", ( result.base_on_ms - result.on_ms ) / 1000.0,
+                        result.stop_ms / 1000.0, result.stop_prob );
+            }
+            else
+            {
+                printf( "no fix, ran the whole budget\n" );
+            }
+        }
+        printf( "\nthresh  scans  fixes   kept   lost  early   base on s  pred on s  saved\n" );
+        replay_print_total( min_prob_pct, &total );
+        return 0;
+    }
+
+    printf( "thresh  scans  fixes   kept   lost  early   base on s  pred on s  saved\n" );
+    for( int pct = 0; pct <= REPLAY_SWEEP_MAX_PCT; pct += REPLAY_SWEEP_STEP_PCT )
+    {
+        replay_total_t total = { 0 };
+
+        for( int i = optind; i < argc; i++ )
+        {
+            replay_result_t result;
+
+            if( !replay_capture( argv[i], pct, &result ))
+            {
+                return 1;
+            }
+            replay_add( &total, &result );
+        }
+        replay_print_total( pct, &total );
+    }
+    return 0;
+}
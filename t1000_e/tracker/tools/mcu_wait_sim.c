@@ -0,0 +1,583 @@
+/*!
+ * @file      mcu_wait_sim.c
+ *
+ * @brief     Host check of the hal_mcu_wait_ms timing contract on a simulated RTC2
+ *
+ * The target smtc_hal_mcu.c (not the SMTC_HAL_SIM replacement) is built
+ * against the nRF stand-ins in sim/, and this file provides the hardware it
+ * waits on, all on one simulated clock:
+ * - RTC2 counting 3/32768 s ticks on 24 bits, from a random start so waits
+ *   cross the wrap. A compare written less than 2 ticks ahead of the counter
+ *   never fires (the nRF52840 only says it may not).
+ * - nrf_pwr_mgmt_run( ) sleeping until the next interrupt or the compare,
+ *   and failing the check if there is none left to wake it.
+ * - Interrupts at random times, one of which may set the event flag. They
+ *   are held while the wait runs from an IRQ or with PRIMASK set.
+ * - One NOP loop iteration of hal_mcu_wait_us( ) taking 171 ns, as its
+ *   64 MHz calibration assumes, and every counter read 1 us.
+ *
+ * Each random wait starts at a random point inside a tick, and the check
+ * verifies that:
+ * - without the event (or with it after the deadline), a sleeping delay is
+ *   never shorter than requested and ends within two ticks of it, plus the
+ *   counter reads and interrupts of the spin that ends it;
+ * - the event ends the delay with the wake-up that delivered it, or within
+ *   1 ms on the spinning path;
+ * - 1 ms delays, delays from an IRQ, with PRIMASK set and before
+ *   hal_mcu_init( ) spin and never sleep;
+ * - the sleep / busy accounting matches the path taken.
+ *
+ * The spinning path is as accurate as the NOP calibration, which is not
+ * checked here.
+ *
+ *   gcc -O2 -Isim -I../inc -I../../peripherals/inc -I../../../smtc_hal/inc \
+ *       mcu_wait_sim.c ../../../smtc_hal/src/smtc_hal_mcu.c -o mcu_wait_sim
+ *   ./mcu_wait_sim [-n waits] [-s seed] [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include "smtc_hal.h"
+#include "nrf52840.h"
+#include "nrf_nvic.h"
+#include "nrf_pwr_mgmt.h"
+#include "nrf_drv_clock.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_TICK_HZ_X3              32768ULL    // RTC2 ticks per 3 s (prescaler 2)
+#define SIM_NOP_NS                  171         // One hal_mcu_wait_us loop iteration
+#define SIM_TICK_READ_NS            1000        // Counter read and loop around it
+#define SIM_IRQ_NS                  5000        // Interrupt handler
+#define SIM_MAX_IRQS                4096
+#define SIM_DEFAULT_WAITS           20000
+#define SIM_PRE_INIT_WAITS          50
+#define SIM_EVENT_LATENCY_NS        20000       // Sleeping path, from the event interrupt to the return
+
+#define SIM_TICKS_TO_NS( t )        (( uint64_t )( t ) * 3000000000ULL / SIM_TICK_HZ_X3 )
+#define SIM_NS_PER_TICK             ( 3000000000.0 / SIM_TICK_HZ_X3 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    SIM_CONTEXT_THREAD,
+    SIM_CONTEXT_IRQ,
+    SIM_CONTEXT_PRIMASK,
+} sim_context_t;
+
+typedef struct
+{
+    uint64_t at_ns;
+    bool     sets_event;
+} sim_irq_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint32_t sim_rng = 0x7A17CAFEU;
+static uint32_t sim_waits = SIM_DEFAULT_WAITS;
+static bool sim_verbose = false;
+
+static uint64_t sim_ns = 0;
+static uint32_t sim_tick_base = 0;          // Counter value at time 0
+static sim_context_t sim_context = SIM_CONTEXT_THREAD;
+
+static bool sim_cc2_armed = false;
+static uint64_t sim_cc2_at_tick = 0;        // Absolute tick the compare fires on
+static bool sim_wake_pending = false;       // Event register set by an interrupt, ends the next WFE
+
+static sim_irq_t sim_irqs[SIM_MAX_IRQS];
+static uint32_t sim_irq_count = 0;
+static uint32_t sim_irq_next = 0;
+
+static volatile bool sim_event = false;
+static uint64_t sim_event_ns = 0;           // When the event interrupt ran
+
+static uint32_t sim_sleeps = 0;             // nrf_pwr_mgmt_run( ) calls
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void sim_fail( const char* fmt, ... )
+{
+    va_list args;
+
+    va_start( args, fmt );
+    printf( "FAIL: " );
+    vprintf( fmt, args );
+    printf( "\n" );
+    va_end( args );
+    exit( 1 );
+}
+
+static uint32_t sim_rand( void )
+{
+    sim_rng ^= sim_rng << 13;
+    sim_rng ^= sim_rng >> 17;
+    sim_rng ^= sim_rng << 5;
+    return sim_rng;
+}
+
+static uint64_t sim_abs_tick( uint64_t ns )
+{
+    return ns * SIM_TICK_HZ_X3 / 3000000000ULL;
+}
+
+static uint32_t sim_counter( void )
+{
+    return ( uint32_t )( sim_abs_tick( sim_ns ) + sim_tick_base ) & RTC_2_MAX_TICKS;
+}
+
+static bool sim_irqs_held( void )
+{
+    return sim_context != SIM_CONTEXT_THREAD;
+}
+
+// Moves the clock to to_ns, running the interrupts and the compare that fall before it
+static void sim_advance_to( uint64_t to_ns )
+{
+    while( true )
+    {
+        uint64_t irq_ns = ( !sim_irqs_held( ) && ( sim_irq_next < sim_irq_count )) ?
+                              sim_irqs[sim_irq_next].at_ns : UINT64_MAX;
+        uint64_t cc2_ns = sim_cc2_armed ? SIM_TICKS_TO_NS( sim_cc2_at_tick ) : UINT64_MAX;
+
+        // Tick edges are rounded down to the ns, make sure the counter has moved
+        while(( cc2_ns != UINT64_MAX ) && ( sim_abs_tick( cc2_ns ) < sim_cc2_at_tick ))
+        {
+            cc2_ns++;
+        }
+
+        if(( cc2_ns <= to_ns ) && ( cc2_ns <= irq_ns ))
+        {
+            sim_ns = ( cc2_ns > sim_ns ) ? cc2_ns : sim_ns;
+            sim_cc2_armed = false;
+            sim_wake_pending = true;
+        }
+        else if( irq_ns <= to_ns )
+        {
+            sim_ns = ( irq_ns > sim_ns ) ? irq_ns : sim_ns;
+            if( sim_irqs[sim_irq_next].sets_event )
+            {
+                sim_event = true;
+                sim_event_ns = sim_ns;
+            }
+            sim_irq_next++;
+            sim_ns += SIM_IRQ_NS;
+            sim_wake_pending = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if( to_ns > sim_ns )
+    {
+        sim_ns = to_ns;
+    }
+}
+
+static void sim_advance( uint64_t ns )
+{
+    sim_advance_to( sim_ns + ns );
+}
+
+// Random interrupts over [from, from + span], mean gap mean_ns, one of them setting the event at event_ns
+static void sim_irqs_plan( uint64_t from_ns, uint64_t span_ns, uint64_t mean_ns, uint64_t event_ns )
+{
+    bool event_planned = ( event_ns == UINT64_MAX );
+    uint64_t at_ns = from_ns;
+
+    sim_irq_count = 0;
+    sim_irq_next = 0;
+    while(( mean_ns > 0 ) && ( sim_irq_count < SIM_MAX_IRQS - 1 ))
+    {
+        at_ns += 1 + ( uint64_t )( sim_rand( ) % ( 2 * mean_ns ));
+        if( at_ns > from_ns + span_ns )
+        {
+            break;
+        }
+        if( !event_planned && ( at_ns >= event_ns ))
+        {
+            sim_irqs[sim_irq_count++] = ( sim_irq_t ){ .at_ns = event_ns, .sets_event = true };
+            event_planned = true;
+        }
+        sim_irqs[sim_irq_count++] = ( sim_irq_t ){ .at_ns = at_ns, .sets_event = false };
+    }
+    if( !event_planned )
+    {
+        sim_irqs[sim_irq_count++] = ( sim_irq_t ){ .at_ns = event_ns, .sets_event = true };
+    }
+}
+
+typedef struct
+{
+    uint32_t sleep_waits;
+    uint32_t busy_waits;
+    uint32_t events;
+    uint32_t wakeups;
+    double   max_late_ticks;    // Sleeping delay past the request, in ticks
+    double   min_late_ticks;
+    double   max_event_us;      // Event to return, sleeping path
+    double   max_spin_event_us; // Event to return, spinning path
+} sim_results_t;
+
+static void sim_wait( uint32_t index, bool initialized, sim_results_t* results )
+{
+    uint32_t pick;
+    int32_t ms;
+    bool with_event = ( sim_rand( ) & 1 ) != 0;
+    bool spins, ended_by_event;
+    uint64_t mean_irq_ns, event_ns, start_ns, elapsed_ns;
+    uint32_t sleeps_before;
+    hal_mcu_wait_stats_t before, after;
+
+    pick = sim_rand( ) % 100;
+    sim_context = ( pick < 5 ) ? SIM_CONTEXT_IRQ : ( pick < 10 ) ? SIM_CONTEXT_PRIMASK : SIM_CONTEXT_THREAD;
+
+    // Delay: mostly short sleeps, some 1 ms and non-positive ones, a few across the 60 s chunks when it can sleep
+    pick = sim_rand( ) % 100;
+    if( pick < 5 )
+    {
+        ms = -( int32_t )( sim_rand( ) % 2 );
+    }
+    else if( pick < 15 )
+    {
+        ms = 1;
+    }
+    else if(( pick < 17 ) && initialized && ( sim_context == SIM_CONTEXT_THREAD ))
+    {
+        ms = 59000 + sim_rand( ) % 70000;
+    }
+    else
+    {
+        ms = 2 + sim_rand( ) % 300;
+    }
+
+    switch( sim_rand( ) % 4 )
+    {
+    case 0:
+        mean_irq_ns = 0;
+        break;
+    case 1:
+        mean_irq_ns = 200000;
+        break;
+    case 2:
+        mean_irq_ns = 5000000;
+        break;
+    default:
+        mean_irq_ns = 100000000;
+        break;
+    }
+
+    // Start anywhere inside a tick, now and then just before the 24-bit wrap
+    if( sim_rand( ) % 16 == 0 )
+    {
+        sim_tick_base = ( RTC_2_MAX_TICKS - ( uint32_t ) sim_abs_tick( sim_ns ) - sim_rand( ) % 2000 ) &
+                        RTC_2_MAX_TICKS;
+    }
+    sim_irq_count = 0;
+    sim_irq_next = 0;
+    sim_advance( sim_rand( ) % ( uint32_t )( 2 * SIM_NS_PER_TICK ));
+
+    start_ns = sim_ns;
+    event_ns = with_event ? start_ns + ( uint64_t )( sim_rand( ) % 1500 ) * ( ms > 0 ? ms : 1 ) * 1000 : UINT64_MAX;
+    sim_irqs_plan( start_ns, ( uint64_t )( ms > 0 ? ms : 1 ) * 2000000, mean_irq_ns, event_ns );
+    sim_event = false;
+    sim_wake_pending = false;
+    sleeps_before = sim_sleeps;
+    hal_mcu_get_wait_stats( &before );
+
+    ended_by_event = hal_mcu_wait_ms_or_event( ms, with_event ? &sim_event : NULL );
+
+    elapsed_ns = sim_ns - start_ns;
+    hal_mcu_get_wait_stats( &after );
+    spins = ( ms < HAL_MCU_WAIT_SLEEP_MIN_MS ) || ( sim_context != SIM_CONTEXT_THREAD ) || !initialized;
+
+    if( sim_verbose )
+    {
+        printf( "wait %5u: %6d ms %-7s %-5s %s -> %s after %.3f ms\n", index, ms,
+                ( sim_context == SIM_CONTEXT_IRQ ) ? "in IRQ" : ( sim_context == SIM_CONTEXT_PRIMASK ) ? "masked" : "",
+                spins ? "spin" : "sleep", with_event ? "event" : "", ended_by_event ? "event" : "timeout",
+                elapsed_ns / 1e6 );
+    }
+
+    if( ms <= 0 )
+    {
+        if(( elapsed_ns != 0 ) || ended_by_event || ( memcmp( &before, &after, sizeof( before )) != 0 ))
+        {
+            sim_fail( "wait %u: %d ms took %llu ns or counted", index, ms, ( unsigned long long ) elapsed_ns );
+        }
+        return;
+    }
+
+    // Path taken and its accounting
+    if( spins )
+    {
+        if(( sim_sleeps != sleeps_before ) || ( after.busy_waits != before.busy_waits + 1 ) ||
+           ( after.busy_ms != before.busy_ms + ms ) || ( after.sleep_waits != before.sleep_waits ))
+        {
+            sim_fail( "wait %u: %d ms should spin (context %d, init %d)", index, ms, sim_context, initialized );
+        }
+        results->busy_waits++;
+    }
+    else
+    {
+        if(( after.sleep_waits != before.sleep_waits + 1 ) || ( after.busy_waits != before.busy_waits ) ||
+           ( after.sleep_ms - before.sleep_ms > ( uint32_t ) ms ))
+        {
+            sim_fail( "wait %u: %d ms should sleep, accounting %u ms", index, ms, after.sleep_ms - before.sleep_ms );
+        }
+        results->sleep_waits++;
+        results->wakeups += after.wakeups - before.wakeups;
+    }
+
+    // An event before the deadline must end the delay, one in its last ticks may or may not
+    if(( ended_by_event && !( with_event && sim_event )) ||
+       ( !ended_by_event && with_event && sim_event &&
+         ( spins || ( sim_event_ns < start_ns + ( uint64_t ) ms * 1000000 ))))
+    {
+        sim_fail( "wait %u: returned %d, event %d", index, ended_by_event, sim_event );
+    }
+
+    if( ended_by_event )
+    {
+        double late_us = ( sim_ns - sim_event_ns ) / 1e3;
+
+        if( spins )
+        {
+            // One 1 ms step, stretched by the interrupts it lets through
+            if( late_us > 1000 + sim_irq_next * SIM_IRQ_NS / 1e3 )
+            {
+                sim_fail( "wait %u: spinning delay returned %.1f us after the event", index, late_us );
+            }
+            results->max_spin_event_us = ( late_us > results->max_spin_event_us ) ? late_us
+                                                                                   : results->max_spin_event_us;
+        }
+        else
+        {
+            if( late_us * 1e3 > SIM_EVENT_LATENCY_NS )
+            {
+                sim_fail( "wait %u: sleeping delay returned %.1f us after the event", index, late_us );
+            }
+            results->max_event_us = ( late_us > results->max_event_us ) ? late_us : results->max_event_us;
+        }
+        results->events++;
+        return;
+    }
+
+    if( spins )
+    {
+        // ms iterations of hal_mcu_wait_us( 1000 ), stretched by the interrupts they let through
+        uint64_t loop_ns = ( uint64_t ) ms * ( 1000 * 1000 / SIM_NOP_NS ) * SIM_NOP_NS;
+
+        if(( elapsed_ns < loop_ns ) || ( elapsed_ns > loop_ns + ( uint64_t ) sim_irq_next * SIM_IRQ_NS ))
+        {
+            sim_fail( "wait %u: spinning %d ms took %.3f ms", index, ms, elapsed_ns / 1e6 );
+        }
+    }
+    else
+    {
+        double late_ticks = (( double ) elapsed_ns - ( double ) ms * 1e6 ) / SIM_NS_PER_TICK;
+
+        // Two ticks at most, plus the counter reads and an interrupt in the spin that ends it
+        if(( elapsed_ns < ( uint64_t ) ms * 1000000 ) ||
+           ( late_ticks * SIM_NS_PER_TICK >= 2 * SIM_NS_PER_TICK + 2 * SIM_TICK_READ_NS + SIM_IRQ_NS ))
+        {
+            sim_fail( "wait %u: sleeping %d ms took %.4f ms (%+.2f ticks)", index, ms, elapsed_ns / 1e6, late_ticks );
+        }
+        results->max_late_ticks = ( late_ticks > results->max_late_ticks ) ? late_ticks : results->max_late_ticks;
+        results->min_late_ticks = ( late_ticks < results->min_late_ticks ) ? late_ticks : results->min_late_ticks;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATED HARDWARE ------------------------------------------------------
+ */
+
+void __NOP( void )
+{
+    sim_advance( SIM_NOP_NS );
+}
+
+void __disable_irq( void )
+{
+}
+
+void __enable_irq( void )
+{
+}
+
+uint32_t __get_IPSR( void )
+{
+    return ( sim_context == SIM_CONTEXT_IRQ ) ? 16 + 17 : 0;    // RTC2_IRQn
+}
+
+uint32_t __get_PRIMASK( void )
+{
+    return ( sim_context == SIM_CONTEXT_PRIMASK ) ? 1 : 0;
+}
+
+void NVIC_SystemReset( void )
+{
+    sim_fail( "reset" );
+}
+
+uint32_t sd_nvic_SystemReset( void )
+{
+    sim_fail( "reset" );
+    return 0;
+}
+
+uint32_t nrf_pwr_mgmt_init( void )
+{
+    return 0;
+}
+
+void nrf_pwr_mgmt_run( void )
+{
+    uint64_t irq_ns, cc2_ns;
+
+    sim_sleeps++;
+    if( sim_irqs_held( ))
+    {
+        sim_fail( "sleep from an IRQ or with PRIMASK set" );
+    }
+
+    // WFE returns at once if an interrupt ran since the last one
+    if( !sim_wake_pending )
+    {
+        irq_ns = ( sim_irq_next < sim_irq_count ) ? sim_irqs[sim_irq_next].at_ns : UINT64_MAX;
+        cc2_ns = sim_cc2_armed ? SIM_TICKS_TO_NS( sim_cc2_at_tick ) + 1 : UINT64_MAX;
+        if(( irq_ns == UINT64_MAX ) && ( cc2_ns == UINT64_MAX ))
+        {
+            sim_fail( "sleep with nothing left to wake the core (counter %u)", sim_counter( ));
+        }
+        sim_advance_to(( irq_ns < cc2_ns ) ? irq_ns : cc2_ns );
+    }
+    sim_wake_pending = false;
+}
+
+uint32_t nrf_drv_clock_init( void )
+{
+    return 0;
+}
+
+void nrf_drv_clock_lfclk_request( nrf_drv_clock_handler_item_t* p_handler_item )
+{
+}
+
+uint32_t hal_rtc_get_ticks( void )
+{
+    sim_advance( SIM_TICK_READ_NS );
+    return sim_counter( );
+}
+
+void hal_rtc_cc2_timer_set_ticks( const uint32_t ticks )
+{
+    uint32_t ahead = (( ticks & RTC_2_MAX_TICKS ) - sim_counter( )) & RTC_2_MAX_TICKS;
+
+    // Written N or N+1 with the counter at N: assume the compare is lost
+    sim_cc2_armed = ( ahead >= 2 );
+    sim_cc2_at_tick = sim_abs_tick( sim_ns ) + ahead;
+}
+
+void hal_rtc_cc2_timer_stop( void )
+{
+    sim_cc2_armed = false;
+}
+
+// The rest of the board hal_mcu_init( ) brings up, inert
+
+smtc_hal_status_t hal_flash_init( void ) { return SMTC_HAL_SUCCESS; }
+void hal_gpio_init( void ) { }
+void hal_rtc_init( void ) { }
+void hal_spi_init( void ) { }
+void hal_i2c_init( void ) { }
+void hal_rng_init( void ) { }
+void hal_usb_cdc_init( void ) { }
+void hal_usb_timer_init( void ) { }
+void hal_usb_timer_uninit( void ) { }
+void hal_trace_flush( void ) { }
+void hal_trace_flush_sync( uint32_t timeout_ms ) { }
+void hal_rtc_wakeup_timer_set_ms( const int32_t milliseconds ) { }
+uint32_t hal_rtc_get_time_ms( void ) { return sim_ns / 1000000; }
+uint32_t hal_gpio_get_value( uint32_t pin ) { return 0; }
+void hal_gpio_init_in( uint32_t pin, const hal_gpio_pull_mode_t pull_mode, const hal_gpio_irq_mode_t irq_mode,
+                       hal_gpio_irq_t* irq ) { }
+void hal_trace_print_var( const char* fmt, ... ) { }
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    sim_results_t results = { .min_late_ticks = 1e9 };
+    int opt;
+
+    while(( opt = getopt( argc, argv, "n:s:v" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            sim_waits = atol( optarg );
+            break;
+        case 's':
+            sim_rng ^= strtoul( optarg, NULL, 0 );
+            break;
+        case 'v':
+            sim_verbose = true;
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-n waits] [-s seed] [-v]\n", argv[0] );
+            return 2;
+        }
+    }
+    sim_tick_base = sim_rand( ) & RTC_2_MAX_TICKS;
+
+    // RTC2 is not running yet: every delay spins
+    for( uint32_t i = 0; i < SIM_PRE_INIT_WAITS; i++ )
+    {
+        sim_wait( i, false, &results );
+    }
+    hal_mcu_init( );
+
+    for( uint32_t i = 0; i < sim_waits; i++ )
+    {
+        sim_wait( SIM_PRE_INIT_WAITS + i, true, &results );
+    }
+
+    printf( "%u waits: %u slept (%u wake-ups), %u spun, %u ended by the event\n", SIM_PRE_INIT_WAITS + sim_waits,
+            results.sleep_waits, results.wakeups, results.busy_waits, results.events );
+    printf( "sleeping delay past the request: %+.2f to %+.2f ticks (tick %.1f us)\n", results.min_late_ticks,
+            results.max_late_ticks, SIM_NS_PER_TICK / 1e3 );
+    printf( "event to return: %.1f us sleeping, %.1f us spinning\n", results.max_event_us,
+            results.max_spin_event_us );
+    printf( "PASS\n" );
+    return 0;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
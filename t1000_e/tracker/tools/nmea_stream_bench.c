@@ -0,0 +1,453 @@
+/*!
+ * @file      nmea_stream_bench.c
+ *
+ * @brief     Host benchmark of the AG3335 UART framing: nmea_stream against the line path it replaced
+ *
+ * Both paths take the raw UART bytes one at a time, as the UART0 handler
+ * receives them, and end once every sentence is identified, its checksum
+ * checked and, for $PAIR001 / $PAIR081 acknowledgements, its fields read:
+ *
+ * - legacy: two lines batched in the handler buffer, then gnss_nmea_parse
+ *   (strlen, memset + memcpy of each line, the $PAIR strncmp chain, sscanf)
+ *   and minmea_sentence_id, as in ag3335.c before nmea_stream;
+ * - stream: nmea_stream_feed, then a switch on the resolved ID and
+ *   nmea_stream_field_int for the $PAIR fields, as ag3335.c does now.
+ *
+ * Decoding the positions is left out: it is the same minmea_parse_* call on
+ * both sides, and libraries/minmea/bench.c measures the decoders.
+ *
+ * The input is AG3335 captures, raw output as saved from the 'N' NMEA debug
+ * stream or a UART logger; without one, a built-in 1 Hz epoch with GSV for
+ * four constellations, PAIR acknowledgements and a few corrupted lines. On
+ * the built-in input both paths must find the same sentences and drop the
+ * corrupted ones. Costs are per sentence, in TSC cycles on x86 hosts and in
+ * ns otherwise.
+ *
+ *   gcc -O2 -I../../peripherals/inc -I../../libraries/minmea nmea_stream_bench.c \
+ *       ../../peripherals/src/nmea_stream.c ../../libraries/minmea/minmea.c -o nmea_stream_bench
+ *   ./nmea_stream_bench [-t seconds] [capture.nmea...]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "nmea_stream.h"
+#include "minmea.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define BENCH_DEFAULT_SECONDS       1.0
+#define BENCH_CAPTURE_MAX           ( 4 * 1024 * 1024 )
+#define BENCH_BUILTIN_EPOCHS        60
+#define LEGACY_RX_BUFFER            256     // g_rx1_buffer of smtc_hal_uart.c
+#define LEGACY_LINE                 MINMEA_MAX_SENTENCE_LENGTH
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define BENCH_UNIT                  "cycles"
+#else
+#define BENCH_UNIT                  "ns"
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct {
+    uint32_t sentence[NMEA_ID_PAIR + 1];    // Per nmea_stream_id_t
+    uint32_t pair_ack;                      // $PAIR001 with command and status read
+    uint32_t pair_nav;                      // $PAIR081 with mode read
+    int32_t  sink;
+} bench_count_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// One 1 Hz AG3335 epoch, address and fields only: '$', checksum and CR LF are added
+static const char* bench_epoch[] = {
+    "GNRMC,082153.000,A,2232.6402,N,11355.5826,E,0.36,154.84,170924,,,A,V",
+    "GNGGA,082153.000,2232.6402,N,11355.5826,E,1,14,0.86,52.4,M,-3.2,M,,",
+    "GNGSA,A,3,02,05,10,12,15,18,23,24,25,,,,1.52,0.86,1.25,1",
+    "GNGSA,A,3,70,71,80,,,,,,,,,,1.52,0.86,1.25,2",
+    "GNGSA,A,3,07,10,21,22,34,39,,,,,,,1.52,0.86,1.25,4",
+    "GPGSV,3,1,10,02,50,321,38,05,18,052,31,10,27,187,33,12,78,053,42,1",
+    "GPGSV,3,2,10,15,09,083,26,18,36,023,35,23,31,151,36,24,48,257,40,1",
+    "GPGSV,3,3,10,25,61,346,41,32,12,297,28,1",
+    "GLGSV,2,1,06,70,45,012,34,71,67,230,37,79,12,330,22,80,23,081,30,1",
+    "GLGSV,2,2,06,86,05,140,,87,14,190,19,1",
+    "GAGSV,2,1,05,03,41,075,33,05,22,301,27,13,56,198,36,15,09,040,,7",
+    "GAGSV,2,2,05,26,33,255,31,7",
+    "GBGSV,2,1,06,07,55,190,37,10,59,199,39,21,42,034,35,22,70,305,43,1",
+    "GBGSV,2,2,06,34,34,113,33,39,63,171,38,1",
+    "GNGST,082153.000,7.3,4.1,3.2,35.1,3.9,3.5,6.8",
+    "GNVTG,154.84,T,,M,0.36,N,0.67,K,A",
+    "GNZDA,082153.000,17,09,2024,,",
+};
+
+static const char* bench_epoch_pair[] = {
+    "PAIR001,062,0",
+    "PAIR081,0",
+};
+
+// RMC with one digit flipped after the checksum was computed
+static const char* bench_epoch_corrupt =
+    "$GNRMC,082153.000,A,2232.6402,N,11355.5836,E,0.36,154.84,170924,,,A,V*0C\r\n";
+
+static uint8_t* bench_data = NULL;
+static size_t bench_len = 0;
+static uint32_t bench_corrupt = 0;
+static double bench_seconds = BENCH_DEFAULT_SECONDS;
+
+static bench_count_t legacy_count;
+static bench_count_t stream_count;
+static nmea_stream_t stream;
+
+// Handler state of the legacy path
+static uint8_t legacy_rx_buffer[LEGACY_RX_BUFFER];
+static uint16_t legacy_rx_len = 0;
+static uint8_t legacy_rx_line = 0;
+static char legacy_line[LEGACY_LINE];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint64_t bench_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t ) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static double bench_now_s( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_append( const char* text, size_t len )
+{
+    memcpy( bench_data + bench_len, text, len );
+    bench_len += len;
+}
+
+static void bench_append_sentence( const char* body )
+{
+    char line[NMEA_STREAM_MAX_LENGTH + 8];
+    uint8_t chk = 0;
+
+    for( const char* c = body; *c; c++ )
+    {
+        chk ^= ( uint8_t ) *c;
+    }
+    bench_append( line, snprintf( line, sizeof( line ), "$%s*%02X\r\n", body, chk ));
+}
+
+static void bench_builtin( void )
+{
+    bench_data = malloc( BENCH_BUILTIN_EPOCHS * 2048 );
+    for( int e = 0; e < BENCH_BUILTIN_EPOCHS; e++ )
+    {
+        for( size_t i = 0; i < sizeof( bench_epoch ) / sizeof( bench_epoch[0] ); i++ )
+        {
+            bench_append_sentence( bench_epoch[i] );
+        }
+        // A command acknowledgement and a line hit by UART noise now and then
+        if(( e % 10 ) == 0 )
+        {
+            bench_append_sentence( bench_epoch_pair[( e / 10 ) & 1] );
+            bench_append( bench_epoch_corrupt, strlen( bench_epoch_corrupt ));
+            bench_corrupt++;
+        }
+    }
+}
+
+static void bench_load( const char* path )
+{
+    FILE* file = fopen( path, "rb" );
+    size_t got;
+
+    if( file == NULL )
+    {
+        perror( path );
+        exit( 2 );
+    }
+    if( bench_data == NULL )
+    {
+        bench_data = malloc( BENCH_CAPTURE_MAX );
+    }
+    got = fread( bench_data + bench_len, 1, BENCH_CAPTURE_MAX - bench_len, file );
+    bench_len += got;
+    fclose( file );
+}
+
+/*
+ * Legacy path, from smtc_hal_uart.c and ag3335.c before nmea_stream. Lines
+ * longer than gps_nmea_line are skipped here; the firmware overran it.
+ */
+static void legacy_parse_line( char* line )
+{
+    switch( minmea_sentence_id( line, false ))
+    {
+    case MINMEA_SENTENCE_RMC: legacy_count.sentence[NMEA_ID_RMC]++; break;
+    case MINMEA_SENTENCE_GGA: legacy_count.sentence[NMEA_ID_GGA]++; break;
+    case MINMEA_SENTENCE_GLL: legacy_count.sentence[NMEA_ID_GLL]++; break;
+    case MINMEA_SENTENCE_GSA: legacy_count.sentence[NMEA_ID_GSA]++; break;
+    case MINMEA_SENTENCE_GST: legacy_count.sentence[NMEA_ID_GST]++; break;
+    case MINMEA_SENTENCE_GSV: legacy_count.sentence[NMEA_ID_GSV]++; break;
+    case MINMEA_SENTENCE_VTG: legacy_count.sentence[NMEA_ID_VTG]++; break;
+    case MINMEA_SENTENCE_ZDA: legacy_count.sentence[NMEA_ID_ZDA]++; break;
+    default: break;
+    }
+}
+
+static void legacy_nmea_parse( char* str )
+{
+    uint16_t len = strlen( str );
+    uint16_t begin = 0, end = 0;
+
+    for( uint16_t i = 0; i < len; i++ )
+    {
+        if( str[i] == '$' ) begin = i;
+        if( str[i] == '\r' ) end = i;
+
+        if( end && end > begin )
+        {
+            if( end - begin < LEGACY_LINE )
+            {
+                memset( legacy_line, 0, sizeof( legacy_line ));
+                memcpy( legacy_line, str + begin, end - begin );
+                if( strncmp( legacy_line, "$PAIR", 5 ) == 0 )
+                {
+                    if( strncmp( legacy_line, "$PAIR001", 8 ) == 0 )
+                    {
+                        int cmd_num = 0;
+                        int status = -1;
+                        if( sscanf( legacy_line, "$PAIR001,%d,%d", &cmd_num, &status ) == 2 )
+                        {
+                            legacy_count.pair_ack++;
+                            legacy_count.sink += cmd_num + status;
+                        }
+                    }
+                    else if( strncmp( legacy_line, "$PAIR550", 8 ) == 0 )
+                    {
+                    }
+                    else if( strncmp( legacy_line, "$PAIR081", 8 ) == 0 )
+                    {
+                        int nav_mode = -1;
+                        if( sscanf( legacy_line, "$PAIR081,%d", &nav_mode ) == 1 )
+                        {
+                            legacy_count.pair_nav++;
+                            legacy_count.sink += nav_mode;
+                        }
+                    }
+                    legacy_count.sentence[NMEA_ID_PAIR]++;
+                }
+                else
+                {
+                    legacy_parse_line( legacy_line );
+                }
+            }
+            begin = 0;
+            end = 0;
+        }
+    }
+}
+
+static void legacy_uart_byte( uint8_t c )
+{
+    legacy_rx_buffer[legacy_rx_len++] = c;
+    if(( legacy_rx_len >= sizeof( legacy_rx_buffer )) || ( legacy_rx_buffer[0] != '$' ))
+    {
+        legacy_rx_len = 0;
+    }
+    if(( c == '\n' ) && ( legacy_rx_len != 0 ))
+    {
+        legacy_rx_line++;
+        if( legacy_rx_line >= 2 )
+        {
+            legacy_rx_buffer[legacy_rx_len < sizeof( legacy_rx_buffer ) ? legacy_rx_len : 0] = '\0';
+            legacy_nmea_parse(( char* ) legacy_rx_buffer );
+            memset( legacy_rx_buffer, 0, sizeof( legacy_rx_buffer ));
+            legacy_rx_line = 0;
+            legacy_rx_len = 0;
+        }
+    }
+}
+
+static void legacy_run( void )
+{
+    for( size_t i = 0; i < bench_len; i++ )
+    {
+        legacy_uart_byte( bench_data[i] );
+    }
+}
+
+// Sentence handler of the stream path
+static void stream_sentence( const nmea_sentence_t* sentence )
+{
+    int32_t value = 0, status = 0;
+
+    stream_count.sentence[sentence->id]++;
+    switch( sentence->id )
+    {
+    case NMEA_ID_PAIR:
+        if(( sentence->pair_id == 1 ) && nmea_stream_field_int( sentence, 1, &value ) &&
+           nmea_stream_field_int( sentence, 2, &status ))
+        {
+            stream_count.pair_ack++;
+            stream_count.sink += value + status;
+        }
+        else if(( sentence->pair_id == 81 ) && nmea_stream_field_int( sentence, 1, &value ))
+        {
+            stream_count.pair_nav++;
+            stream_count.sink += value;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void stream_run( void )
+{
+    for( size_t i = 0; i < bench_len; i++ )
+    {
+        nmea_stream_feed( &stream, bench_data[i] );
+    }
+}
+
+static uint32_t bench_total( const bench_count_t* count )
+{
+    uint32_t total = 0;
+
+    for( int id = NMEA_ID_GGA; id <= NMEA_ID_PAIR; id++ )
+    {
+        total += ( id == NMEA_ID_TXT ) ? 0 : count->sentence[id];
+    }
+    return total;
+}
+
+/*!
+ * @brief Run one path until the time budget is spent
+ *
+ * @return Cost per pass over the input
+ */
+static double bench_measure( void ( *run )( void ))
+{
+    double start = bench_now_s( );
+    uint64_t ticks = 0;
+    uint32_t passes = 0;
+
+    do
+    {
+        uint64_t t0 = bench_ticks( );
+        run( );
+        ticks += bench_ticks( ) - t0;
+        passes++;
+    } while( bench_now_s( ) - start < bench_seconds );
+    return ( double ) ticks / passes;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    static const char* names[] = { "?", "GGA", "GLL", "GSA", "GSV", "GST", "RMC", "VTG", "ZDA", "TXT", "PAIR" };
+    uint32_t sentences;
+    double legacy_cost, stream_cost;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "t:" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 't':
+            bench_seconds = atof( optarg );
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-t seconds] [capture.nmea...]\n", argv[0] );
+            return 2;
+        }
+    }
+    if( optind == argc )
+    {
+        bench_builtin( );
+    }
+    for( int i = optind; i < argc; i++ )
+    {
+        bench_load( argv[i] );
+    }
+
+    // One pass each to compare what the paths find
+    memset( &legacy_count, 0, sizeof( legacy_count ));
+    legacy_run( );
+    memset( &stream_count, 0, sizeof( stream_count ));
+    nmea_stream_init( &stream, stream_sentence );
+    stream_run( );
+
+    printf( "input: %zu bytes, %s\n", bench_len, ( optind == argc ) ? "built-in epochs" : "captures" );
+    printf( "%-6s %8s %8s\n", "type", "legacy", "stream" );
+    for( int id = NMEA_ID_GGA; id <= NMEA_ID_PAIR; id++ )
+    {
+        if( legacy_count.sentence[id] || stream_count.sentence[id] )
+        {
+            printf( "%-6s %8u %8u\n", names[id], legacy_count.sentence[id], stream_count.sentence[id] );
+        }
+    }
+    printf( "%-6s %8u %8u\n", "ack", legacy_count.pair_ack + legacy_count.pair_nav,
+            stream_count.pair_ack + stream_count.pair_nav );
+    printf( "stream: %u checksum errors, %u overruns\n", stream.checksum_errors, stream.overruns );
+
+    sentences = bench_total( &stream_count );
+    if( sentences == 0 )
+    {
+        fprintf( stderr, "no sentence in the input\n" );
+        return 1;
+    }
+    if(( optind == argc ) && (( bench_total( &legacy_count ) != sentences ) ||
+                              ( legacy_count.pair_ack != stream_count.pair_ack ) ||
+                              ( legacy_count.pair_nav != stream_count.pair_nav ) ||
+                              ( legacy_count.sink != stream_count.sink ) ||
+                              ( stream.checksum_errors != bench_corrupt )))
+    {
+        fprintf( stderr, "the paths disagree on the built-in epochs\n" );
+        return 1;
+    }
+
+    legacy_cost = bench_measure( legacy_run );
+    stream_cost = bench_measure( stream_run );
+    printf( "legacy: %7.0f %s/sentence, %5.1f %s/byte\n", legacy_cost / sentences, BENCH_UNIT,
+            legacy_cost / bench_len, BENCH_UNIT );
+    printf( "stream: %7.0f %s/sentence, %5.1f %s/byte\n", stream_cost / sentences, BENCH_UNIT,
+            stream_cost / bench_len, BENCH_UNIT );
+    printf( "PASS\n" );
+
+    free( bench_data );
+    return 0;
+}
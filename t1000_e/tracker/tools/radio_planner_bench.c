@@ -0,0 +1,497 @@
+/*
+ * Host test and benchmark of the radio planner arbitration.
+ *
+ * Drives rp_task_enqueue, rp_task_abort, the planner timer and
+ * rp_radio_irq_callback with a random load on every hook: LoRa and FSK TX/RX,
+ * Wi-Fi and GNSS scans, ASAP and scheduled, some at low priority, with aborts
+ * and re-enqueues from the completion callbacks the way the LoRaWAN stack and
+ * the services do. Virtual time starts ten minutes before the 32-bit
+ * millisecond wrap. The radio is a stub that completes each launched task
+ * after its duration (RX with a packet or a timeout).
+ *
+ * Every launch, completion callback and timer arm, and the state of every
+ * task after each step, are folded into a digest. Two planner builds that
+ * arbitrate identically print the same digest. The cost is the time spent in
+ * the planner entry points per call, in TSC cycles on x86 hosts and in ns
+ * otherwise.
+ *
+ * Build against the current planner and against the one before the
+ * incremental ranking, then compare the digests:
+ *
+ *   C=../../../lora_basics_modem/smtc_modem_core
+ *   git show 3ce8d30^:./$C/radio_planner/src/radio_planner.c > /tmp/radio_planner_prev.c
+ *   for rp in $C/radio_planner/src/radio_planner.c /tmp/radio_planner_prev.c; do
+ *       gcc -O2 -I$C/radio_planner/src -I$C/smtc_ral/src -I$C/smtc_ralf/src -I$C/modem_config \
+ *           -I../../../lora_basics_modem/smtc_modem_hal \
+ *           radio_planner_bench.c $rp -o radio_planner_bench && ./radio_planner_bench [steps] [seed]
+ *   done
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "radio_planner.h"
+#include "smtc_modem_hal.h"
+
+#define BENCH_STEPS 300000
+#define BENCH_START_MS ( 0xFFFFFFFFu - 600000u )
+#define BENCH_PAYLOAD_SIZE 255
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+typedef struct
+{
+    uint8_t  id;
+    uint32_t enqueued;
+    uint32_t done;
+    uint32_t aborted;
+} bench_hook_t;
+
+static radio_planner_t planner;
+static ralf_t          radio;
+static bench_hook_t    hooks[RP_NB_HOOKS];
+static uint8_t         payloads[RP_NB_HOOKS][BENCH_PAYLOAD_SIZE];
+
+static uint32_t now_ms = BENCH_START_MS;
+static uint64_t rng    = 0x853C49E6748FEA9Bull;
+static uint64_t digest = 0xCBF29CE484222325ull;
+
+// Planner timer
+static bool     timer_armed;
+static uint32_t timer_at_ms;
+static void ( *timer_callback )( void* );
+static void* timer_context;
+
+// Radio stub: the task launched last completes at radio_at_ms with radio_irq
+static bool      radio_busy;
+static uint32_t  radio_at_ms;
+static ral_irq_t radio_irq;
+
+static uint32_t launches;
+static uint32_t timer_arms;
+static uint32_t planner_calls;
+static uint64_t planner_ticks;
+
+static uint64_t bench_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t ) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static uint32_t bench_rand( uint32_t range )
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return ( uint32_t ) ( ( rng >> 32 ) % range );
+}
+
+static void bench_fold( uint32_t value )
+{
+    for( int i = 0; i < 4; i++ )
+    {
+        digest ^= ( value >> ( 8 * i ) ) & 0xFF;
+        digest *= 0x100000001B3ull;
+    }
+}
+
+/*
+ * Modem HAL and radio planner HAL
+ */
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[32] )
+{
+    fprintf( stderr, "planner panic in %s\n", ( const char* ) crashlog );
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+    ( void ) available;
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    exit( 1 );
+}
+
+void smtc_modem_hal_assert_fail( uint8_t* func, uint32_t line )
+{
+    fprintf( stderr, "planner assert in %s:%u\n", ( const char* ) func, line );
+    exit( 1 );
+}
+
+void smtc_modem_hal_stop_radio_tcxo( void )
+{
+}
+
+void rp_hal_critical_section_begin( void )
+{
+}
+
+void rp_hal_critical_section_end( void )
+{
+}
+
+void rp_hal_timer_stop( void )
+{
+    timer_armed = false;
+}
+
+void rp_hal_timer_start( void* rp, uint32_t alarm_in_ms, void ( *callback )( void* context ) )
+{
+    timer_armed    = true;
+    timer_at_ms    = now_ms + alarm_in_ms;
+    timer_callback = callback;
+    timer_context  = rp;
+    timer_arms++;
+    bench_fold( 0x54000000 | alarm_in_ms );
+}
+
+uint32_t rp_hal_get_time_in_ms( void )
+{
+    return now_ms;
+}
+
+uint32_t rp_hal_get_radio_irq_timestamp_in_100us( void )
+{
+    return now_ms * 10;
+}
+
+void rp_hal_irq_clear_pending( void )
+{
+    radio_busy = false;
+}
+
+void rp_hal_get_gnss_conso_us( uint32_t* p_radio_t, uint32_t* p_arc_process_t )
+{
+    *p_radio_t       = 0;
+    *p_arc_process_t = 0;
+}
+
+void rp_hal_get_wifi_conso_us( uint32_t* p_radio_t, uint32_t* p_arc_process_t )
+{
+    *p_radio_t       = 0;
+    *p_arc_process_t = 0;
+}
+
+static ral_status_t radio_ok( const void* context )
+{
+    ( void ) context;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t radio_set_sleep( const void* context, const bool retain_config )
+{
+    ( void ) retain_config;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    ( void ) standby_cfg;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    ( void ) irq;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    *irq      = radio_irq;
+    radio_irq = 0;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                           uint16_t* size_in_bytes )
+{
+    ( void ) buffer;
+    *size_in_bytes = ( max_size_in_bytes < 12 ) ? max_size_in_bytes : 12;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status )
+{
+    memset( rx_pkt_status, 0, sizeof( *rx_pkt_status ) );
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_gfsk_rx_pkt_status( const void* context, ral_gfsk_rx_pkt_status_t* rx_pkt_status )
+{
+    memset( rx_pkt_status, 0, sizeof( *rx_pkt_status ) );
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_tx_consumption_in_ua( const void* context, const int8_t output_pwr_in_dbm,
+                                                    const uint32_t rf_freq_in_hz, uint32_t* pwr_consumption_in_ua )
+{
+    ( void ) output_pwr_in_dbm;
+    ( void ) rf_freq_in_hz;
+    *pwr_consumption_in_ua = 100000;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_gfsk_rx_consumption_in_ua( const void* context, const uint32_t br_in_bps,
+                                                         const uint32_t bw_dsb_in_hz, const bool rx_boosted,
+                                                         uint32_t* pwr_consumption_in_ua )
+{
+    ( void ) br_in_bps;
+    ( void ) bw_dsb_in_hz;
+    ( void ) rx_boosted;
+    *pwr_consumption_in_ua = 6000;
+    return radio_ok( context );
+}
+
+static ral_status_t radio_get_lora_rx_consumption_in_ua( const void* context, const ral_lora_bw_t bw,
+                                                         const bool rx_boosted, uint32_t* pwr_consumption_in_ua )
+{
+    ( void ) bw;
+    ( void ) rx_boosted;
+    *pwr_consumption_in_ua = 6000;
+    return radio_ok( context );
+}
+
+/*
+ * Load
+ */
+
+static const rp_task_types_t bench_types[] = {
+    RP_TASK_TYPE_TX_LORA, RP_TASK_TYPE_TX_FSK,     RP_TASK_TYPE_RX_LORA,
+    RP_TASK_TYPE_RX_FSK,  RP_TASK_TYPE_WIFI_SNIFF, RP_TASK_TYPE_GNSS_SNIFF,
+};
+
+static void bench_enqueue( uint8_t id );
+
+static uint64_t bench_call_start( void )
+{
+    planner_calls++;
+    return bench_ticks( );
+}
+
+static void bench_call_end( uint64_t start )
+{
+    planner_ticks += bench_ticks( ) - start;
+}
+
+static void bench_launch( void* context )
+{
+    radio_planner_t* rp   = ( radio_planner_t* ) context;
+    uint8_t          id   = rp->radio_task_id;
+    rp_task_t*       task = &rp->tasks[id];
+    uint32_t         duration;
+
+    launches++;
+    bench_fold( 0x4C000000 | ( id << 16 ) | task->type );
+    bench_fold( now_ms );
+
+    switch( task->type )
+    {
+    case RP_TASK_TYPE_TX_LORA:
+    case RP_TASK_TYPE_TX_FSK:
+        radio_irq = RAL_IRQ_TX_DONE;
+        duration  = task->duration_time_ms;
+        break;
+    case RP_TASK_TYPE_RX_LORA:
+    case RP_TASK_TYPE_RX_FSK:
+        radio_irq = ( bench_rand( 4 ) == 0 ) ? RAL_IRQ_RX_DONE : RAL_IRQ_RX_TIMEOUT;
+        duration  = 5 + bench_rand( task->duration_time_ms + 1 );
+        break;
+    default:
+        radio_irq = ( task->type == RP_TASK_TYPE_WIFI_SNIFF ) ? RAL_IRQ_WIFI_SCAN_DONE : RAL_IRQ_GNSS_SCAN_DONE;
+        duration  = task->duration_time_ms;
+        break;
+    }
+    radio_busy  = true;
+    radio_at_ms = now_ms + duration;
+}
+
+static void bench_done( void* context )
+{
+    bench_hook_t* hook = ( bench_hook_t* ) context;
+    uint32_t      irq_timestamp_ms;
+    rp_status_t   status;
+
+    rp_get_status( &planner, hook->id, &irq_timestamp_ms, &status );
+    bench_fold( 0x43000000 | ( hook->id << 16 ) | status );
+    bench_fold( irq_timestamp_ms );
+    if( status == RP_STATUS_TASK_ABORTED )
+    {
+        hook->aborted++;
+    }
+    else
+    {
+        hook->done++;
+    }
+
+    // Stacks re-arm from their callback, as the RX windows follow a TX
+    if( bench_rand( 3 ) == 0 )
+    {
+        bench_enqueue( hook->id );
+    }
+}
+
+static void bench_enqueue( uint8_t id )
+{
+    rp_task_t         task;
+    rp_radio_params_t params;
+
+    memset( &task, 0, sizeof( task ) );
+    memset( &params, 0, sizeof( params ) );
+    task.hook_id                    = id;
+    task.type                       = bench_types[bench_rand( sizeof( bench_types ) / sizeof( bench_types[0] ) )];
+    task.launch_task_callbacks      = bench_launch;
+    task.schedule_task_low_priority = bench_rand( 8 ) == 0;
+    task.state                      = ( bench_rand( 3 ) == 0 ) ? RP_TASK_STATE_ASAP : RP_TASK_STATE_SCHEDULE;
+    task.start_time_ms              = now_ms + 1 + bench_rand( 8000 );
+    task.duration_time_ms           = 10 + bench_rand( ( task.type >= RP_TASK_TYPE_WIFI_SNIFF ) ? 4000 : 1500 );
+    params.pkt_type = ( task.type == RP_TASK_TYPE_TX_FSK || task.type == RP_TASK_TYPE_RX_FSK ) ? RAL_PKT_TYPE_GFSK
+                                                                                              : RAL_PKT_TYPE_LORA;
+    params.rx.timeout_in_ms = task.duration_time_ms;
+
+    hooks[id].enqueued++;
+    bench_fold( rp_task_enqueue( &planner, &task, payloads[id], BENCH_PAYLOAD_SIZE, &params ) );
+}
+
+static void bench_fold_tasks( void )
+{
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        bench_fold( ( planner.tasks[i].state << 8 ) | planner.tasks[i].hook_id );
+        bench_fold( planner.tasks[i].start_time_ms );
+    }
+    bench_fold( timer_armed ? timer_at_ms : 0 );
+}
+
+/*
+ * One step: an enqueue, an abort, or time running to the next timer, radio
+ * completion or a random instant.
+ */
+static void bench_step( void )
+{
+    uint32_t action = bench_rand( 100 );
+    uint64_t start;
+
+    if( action < 35 )
+    {
+        uint8_t id = bench_rand( RP_NB_HOOKS );
+        start      = bench_call_start( );
+        bench_enqueue( id );
+        bench_call_end( start );
+    }
+    else if( action < 42 )
+    {
+        uint8_t id = bench_rand( RP_NB_HOOKS );
+        start      = bench_call_start( );
+        bench_fold( 0x41000000 | rp_task_abort( &planner, id ) );
+        bench_call_end( start );
+    }
+    else
+    {
+        uint32_t next   = now_ms + 1 + bench_rand( 3000 );
+        bool     fire_t = false;
+        bool     fire_r = false;
+
+        if( radio_busy && ( int32_t ) ( radio_at_ms - next ) <= 0 )
+        {
+            next   = radio_at_ms;
+            fire_r = true;
+        }
+        if( timer_armed && ( int32_t ) ( timer_at_ms - next ) <= 0 &&
+            ( !fire_r || ( int32_t ) ( timer_at_ms - radio_at_ms ) < 0 ) )
+        {
+            next   = timer_at_ms;
+            fire_t = true;
+            fire_r = false;
+        }
+        now_ms = next;
+        if( fire_r )
+        {
+            radio_busy = false;
+            start      = bench_call_start( );
+            rp_radio_irq_callback( &planner );
+            bench_call_end( start );
+        }
+        else if( fire_t )
+        {
+            timer_armed = false;
+            start       = bench_call_start( );
+            timer_callback( timer_context );
+            bench_call_end( start );
+        }
+    }
+    bench_fold_tasks( );
+}
+
+int main( int argc, char** argv )
+{
+    uint32_t steps = ( argc > 1 ) ? ( uint32_t ) strtoul( argv[1], NULL, 0 ) : BENCH_STEPS;
+    uint32_t done = 0, aborted = 0, enqueued = 0;
+    bool     wrapped = false;
+
+    if( argc > 2 )
+    {
+        rng ^= strtoull( argv[2], NULL, 0 ) * 0x2545F4914F6CDD1Dull;
+    }
+
+    radio.ral.driver.set_sleep                     = radio_set_sleep;
+    radio.ral.driver.set_standby                   = radio_set_standby;
+    radio.ral.driver.clear_irq_status              = radio_clear_irq_status;
+    radio.ral.driver.get_and_clear_irq_status      = radio_get_and_clear_irq_status;
+    radio.ral.driver.get_pkt_payload               = radio_get_pkt_payload;
+    radio.ral.driver.get_lora_rx_pkt_status        = radio_get_lora_rx_pkt_status;
+    radio.ral.driver.get_gfsk_rx_pkt_status        = radio_get_gfsk_rx_pkt_status;
+    radio.ral.driver.get_tx_consumption_in_ua      = radio_get_tx_consumption_in_ua;
+    radio.ral.driver.get_gfsk_rx_consumption_in_ua = radio_get_gfsk_rx_consumption_in_ua;
+    radio.ral.driver.get_lora_rx_consumption_in_ua = radio_get_lora_rx_consumption_in_ua;
+
+    rp_init( &planner, &radio );
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        hooks[i].id = i;
+        rp_hook_init( &planner, i, bench_done, &hooks[i] );
+    }
+
+    for( uint32_t i = 0; i < steps; i++ )
+    {
+        bench_step( );
+        wrapped = wrapped || ( now_ms < BENCH_START_MS );
+    }
+
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        enqueued += hooks[i].enqueued;
+        done += hooks[i].done;
+        aborted += hooks[i].aborted;
+    }
+    printf( "%u steps over %u s of virtual time, %s the 32-bit ms wrap\n", steps,
+            ( now_ms - BENCH_START_MS ) / 1000, wrapped ? "across" : "NOT across" );
+    printf( "%u enqueues, %u launches, %u completions, %u aborted callbacks, %u timer arms, %u planner errors\n",
+            enqueued, launches, done, aborted, timer_arms, planner.stats.rp_error );
+    printf( "digest %016llx\n", ( unsigned long long ) digest );
+    printf( "planner: %.0f %s per call over %u calls\n", ( double ) planner_ticks / planner_calls, BENCH_UNIT,
+            planner_calls );
+    if( !wrapped || ( launches == 0 ) || ( aborted == 0 ) )
+    {
+        printf( "FAIL\n" );
+        return 1;
+    }
+    printf( "PASS\n" );
+    return 0;
+}
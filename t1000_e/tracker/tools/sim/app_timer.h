@@ -0,0 +1,50 @@
+/*
+ * Host stand-in for the nRF5 SDK app_timer.h, for the tracker host simulation.
+ *
+ * Timers are tracked in sim_softdevice.c and fired from the simulated clock
+ * (hal_sim_advance_ms), as app_timer fires them from RTC1 on the device.
+ */
+
+#ifndef APP_TIMER_H
+#define APP_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fds.h"
+
+#define APP_TIMER_CLOCK_FREQ 32768
+#define APP_TIMER_TICKS( MS ) ( ( uint32_t )( ( ( uint64_t )( MS ) * APP_TIMER_CLOCK_FREQ ) / 1000 ) )
+
+typedef enum
+{
+    APP_TIMER_MODE_SINGLE_SHOT,
+    APP_TIMER_MODE_REPEATED
+} app_timer_mode_t;
+
+typedef void ( *app_timer_timeout_handler_t )( void* p_context );
+
+typedef struct sim_app_timer_s* app_timer_id_t;
+
+#define APP_TIMER_DEF( timer_id )                   \
+    static struct sim_app_timer_s timer_id##_data;  \
+    static app_timer_id_t         timer_id = &timer_id##_data
+
+struct sim_app_timer_s
+{
+    app_timer_mode_t            mode;
+    app_timer_timeout_handler_t handler;
+    void*                       context;
+    uint32_t                    period_ms;
+    uint64_t                    expiry_ms;
+    bool                        running;
+    struct sim_app_timer_s*     next;
+};
+
+ret_code_t app_timer_init( void );
+ret_code_t app_timer_create( app_timer_id_t const* p_timer_id, app_timer_mode_t mode,
+                             app_timer_timeout_handler_t timeout_handler );
+ret_code_t app_timer_start( app_timer_id_t timer_id, uint32_t timeout_ticks, void* p_context );
+ret_code_t app_timer_stop( app_timer_id_t timer_id );
+
+#endif  // APP_TIMER_H
@@ -0,0 +1,40 @@
+/*
+ * Host stand-in for the nRF5 SDK fds.h, for the tracker host simulation.
+ *
+ * Only the types app_at_fds_datas.h exposes; the records themselves live in
+ * RAM in sim_softdevice.c.
+ */
+
+#ifndef FDS_H__
+#define FDS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t ret_code_t;
+
+#define NRF_SUCCESS 0
+#define APP_ERROR_CHECK( ERR_CODE ) ( ( void ) ( ERR_CODE ) )
+
+typedef struct
+{
+    void const* p_data;
+    uint32_t    length_words;
+} fds_record_data_t;
+
+typedef struct
+{
+    uint16_t          file_id;
+    uint16_t          key;
+    fds_record_data_t data;
+} fds_record_t;
+
+typedef struct
+{
+    uint32_t record_id;
+    uint32_t const* p_record;
+    uint16_t gc_run_count;
+    bool     record_is_open;
+} fds_record_desc_t;
+
+#endif  // FDS_H__
@@ -0,0 +1,8 @@
+/*
+ * Host stand-in for the nRF5 SDK hardfault.h, for the MCU wait host check.
+ */
+
+#ifndef HARDFAULT_H__
+#define HARDFAULT_H__
+
+#endif  // HARDFAULT_H__
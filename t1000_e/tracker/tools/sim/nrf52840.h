@@ -0,0 +1,21 @@
+/*
+ * Host stand-in for the nRF MDK nrf52840.h, for the MCU wait host check.
+ *
+ * Only the CMSIS core functions smtc_hal_mcu.c uses. They are implemented by
+ * the check: __NOP( ) advances the simulated clock by one NOP loop iteration,
+ * the IPSR and PRIMASK reads return the context the check sets.
+ */
+
+#ifndef NRF52840_H
+#define NRF52840_H
+
+#include <stdint.h>
+
+void     __NOP( void );
+void     __disable_irq( void );
+void     __enable_irq( void );
+uint32_t __get_IPSR( void );
+uint32_t __get_PRIMASK( void );
+void     NVIC_SystemReset( void );
+
+#endif  // NRF52840_H
@@ -0,0 +1,17 @@
+/*
+ * Host stand-in for the nRF5 SDK nrf_delay.h, for the tracker host simulation.
+ *
+ * Busy delays advance the simulated clock like hal_mcu_wait_us.
+ */
+
+#ifndef NRF_DELAY_H__
+#define NRF_DELAY_H__
+
+#include <stdint.h>
+
+void hal_mcu_wait_us( const int32_t microseconds );
+
+#define nrf_delay_us( US ) hal_mcu_wait_us( ( int32_t )( US ) )
+#define nrf_delay_ms( MS ) hal_mcu_wait_us( ( int32_t )( MS ) * 1000 )
+
+#endif  // NRF_DELAY_H__
@@ -0,0 +1,15 @@
+/*
+ * Host stand-in for the nRF5 SDK nrf_drv_clock.h, for the MCU wait host check.
+ */
+
+#ifndef NRF_DRV_CLOCK_H__
+#define NRF_DRV_CLOCK_H__
+
+#include <stdint.h>
+
+typedef struct nrf_drv_clock_handler_item_s nrf_drv_clock_handler_item_t;
+
+uint32_t nrf_drv_clock_init( void );
+void     nrf_drv_clock_lfclk_request( nrf_drv_clock_handler_item_t* p_handler_item );
+
+#endif  // NRF_DRV_CLOCK_H__
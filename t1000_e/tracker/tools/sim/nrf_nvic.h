@@ -0,0 +1,12 @@
+/*
+ * Host stand-in for the SoftDevice nrf_nvic.h, for the MCU wait host check.
+ */
+
+#ifndef NRF_NVIC_H__
+#define NRF_NVIC_H__
+
+#include <stdint.h>
+
+uint32_t sd_nvic_SystemReset( void );
+
+#endif  // NRF_NVIC_H__
@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for the nRF5 SDK nrf_pwr_mgmt.h, for the MCU wait host check.
+ *
+ * nrf_pwr_mgmt_run( ) is implemented by the check: it advances the simulated
+ * clock to the next wake-up source, as System ON sleep does.
+ */
+
+#ifndef NRF_PWR_MGMT_H__
+#define NRF_PWR_MGMT_H__
+
+#include <stdint.h>
+
+uint32_t nrf_pwr_mgmt_init( void );
+void     nrf_pwr_mgmt_run( void );
+
+#endif  // NRF_PWR_MGMT_H__
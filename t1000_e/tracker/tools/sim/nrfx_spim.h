@@ -0,0 +1,82 @@
+/*
+ * Host stand-in for the nrfx nrfx_spim.h, for the SPI HAL host bench.
+ *
+ * Only what smtc_hal_spi.c uses. The transfers are implemented by the bench,
+ * which records the bytes clocked out and chooses the bytes clocked in.
+ */
+
+#ifndef NRFX_SPIM_H__
+#define NRFX_SPIM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef uint32_t nrfx_err_t;
+
+typedef enum
+{
+    NRF_SPIM_FREQ_4M = 0x40000000UL
+} nrf_spim_frequency_t;
+
+typedef enum
+{
+    NRF_SPIM_MODE_0
+} nrf_spim_mode_t;
+
+typedef enum
+{
+    NRF_SPIM_BIT_ORDER_MSB_FIRST
+} nrf_spim_bit_order_t;
+
+typedef struct
+{
+    uint8_t drv_inst_idx;
+} nrfx_spim_t;
+
+typedef struct
+{
+    uint8_t              sck_pin;
+    uint8_t              mosi_pin;
+    uint8_t              miso_pin;
+    uint8_t              ss_pin;
+    bool                 ss_active_high;
+    uint8_t              irq_priority;
+    uint8_t              orc;
+    nrf_spim_frequency_t frequency;
+    nrf_spim_mode_t      mode;
+    nrf_spim_bit_order_t bit_order;
+    bool                 use_hw_ss;
+} nrfx_spim_config_t;
+
+typedef struct
+{
+    uint8_t const* p_tx_buffer;
+    size_t         tx_length;
+    uint8_t*       p_rx_buffer;
+    size_t         rx_length;
+} nrfx_spim_xfer_desc_t;
+
+typedef void ( *nrfx_spim_evt_handler_t )( void const* p_event, void* p_context );
+
+#define NRFX_SPIM_INSTANCE( id ) { .drv_inst_idx = ( id ) }
+
+#define NRFX_SPIM_DEFAULT_CONFIG { .frequency = NRF_SPIM_FREQ_4M, .orc = 0xFF }
+
+#define NRFX_SPIM_XFER_TRX( p_tx_buf, tx_len, p_rx_buf, rx_len ) \
+    { .p_tx_buffer = ( uint8_t const* ) ( p_tx_buf ), .tx_length = ( tx_len ), \
+      .p_rx_buffer = ( p_rx_buf ), .rx_length = ( rx_len ) }
+
+#define NRFX_SPIM_XFER_TX( p_buf, len ) NRFX_SPIM_XFER_TRX( p_buf, len, NULL, 0 )
+
+#define NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER ( 1UL << 2 )
+
+nrfx_err_t nrfx_spim_init( nrfx_spim_t const* p_instance, nrfx_spim_config_t const* p_config,
+                           nrfx_spim_evt_handler_t handler, void* p_context );
+
+void nrfx_spim_uninit( nrfx_spim_t const* p_instance );
+
+nrfx_err_t nrfx_spim_xfer( nrfx_spim_t const* p_instance, nrfx_spim_xfer_desc_t const* p_xfer_desc,
+                           uint32_t flags );
+
+#endif  // NRFX_SPIM_H__
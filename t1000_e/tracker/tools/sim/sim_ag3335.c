@@ -0,0 +1,408 @@
+/*!
+ * @file      sim_ag3335.c
+ *
+ * @brief     AG3335 side of the tracker host simulation
+ *
+ * Stands in for the ag3335.c API at the fix level instead of NMEA: under open
+ * sky the receiver outputs one epoch per second once its time to fix has
+ * passed, 28 s cold (no fix for 4 h), 20 s warm (no fix for 30 min) and 3 s
+ * hot. Under a blocked sky it tracks nothing. Positions follow the ground
+ * track set by sim_gnss_set_track( ).
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "ag3335.h"
+#include "smtc_hal_mcu.h"
+#include "smtc_hal_rtc.h"
+#include "tracker_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_GNSS_COLD_MS        28000
+#define SIM_GNSS_WARM_MS        20000
+#define SIM_GNSS_HOT_MS         3000
+#define SIM_GNSS_COLD_AGE_MS    ( 4 * 3600000UL )
+#define SIM_GNSS_WARM_AGE_MS    ( 30 * 60000UL )
+#define SIM_GNSS_EPOCH_MS       1000
+#define SIM_GNSS_START_LAT      50.0000f    // English Channel, off Start Point
+#define SIM_GNSS_START_LON      -3.6000f
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static bool     sim_open_sky = true;
+static float    sim_speed_knots = 0.0f;
+static float    sim_course_deg = 0.0f;
+static float    sim_lat = SIM_GNSS_START_LAT;
+static float    sim_lon = SIM_GNSS_START_LON;
+static uint32_t sim_track_ms = 0;
+
+static bool     sim_powered = false;
+static uint32_t sim_on_since_ms = 0;
+static uint32_t sim_fix_ready_ms = 0;       // First epoch with a fix after power on
+static bool     sim_ever_fixed = false;
+static gnss_fix_t sim_last_fix = { 0 };
+
+static gnss_scan_check_t sim_scan_check = NULL;
+static uint32_t          sim_sky_check_ms = 0;
+static uint8_t           sim_sky_min_top4 = 0;
+static volatile bool     sim_ble_found = false;
+static gnss_acq_stats_t  sim_acq_stats = { 0 };
+
+static sim_gnss_stats_t sim_stats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+/*!
+ * @brief Dead-reckon the wearer up to now
+ */
+static void sim_gnss_move( uint32_t now_ms )
+{
+    const float hours = ( now_ms - sim_track_ms ) / 3600000.0f;
+    const float nm    = sim_speed_knots * hours;
+    const float rad   = sim_course_deg * ( float )M_PI / 180.0f;
+
+    sim_lat += nm * cosf( rad ) / 60.0f;
+    sim_lon += nm * sinf( rad ) / ( 60.0f * cosf( sim_lat * ( float )M_PI / 180.0f ));
+    sim_track_ms = now_ms;
+}
+
+/*!
+ * @brief Output the epoch of the current second if the receiver has a fix
+ */
+static void sim_gnss_update( void )
+{
+    uint32_t now = hal_rtc_get_time_ms( );
+    uint32_t epoch_ms;
+
+    if( !sim_powered || !sim_open_sky || ( now < sim_fix_ready_ms ))
+    {
+        return;
+    }
+    epoch_ms = now - ( now % SIM_GNSS_EPOCH_MS );
+    if( sim_last_fix.valid && ( sim_last_fix.timestamp_ms == epoch_ms ))
+    {
+        return;
+    }
+
+    sim_gnss_move( now );
+    sim_last_fix.latitude     = ( int32_t )( sim_lat * 1e6f );
+    sim_last_fix.longitude    = ( int32_t )( sim_lon * 1e6f );
+    sim_last_fix.speed        = ( int32_t )( sim_speed_knots * 1e6f );
+    sim_last_fix.hdop         = 0.9f;
+    sim_last_fix.hacc         = 4.0f;
+    sim_last_fix.fix_quality  = 1;
+    sim_last_fix.satellites   = 10;
+    sim_last_fix.utc_ms       = ( int32_t )( epoch_ms % 86400000UL );
+    sim_last_fix.timestamp_ms = epoch_ms;
+    sim_last_fix.valid        = true;
+    sim_ever_fixed            = true;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATION API ----------------------------------------------------------
+ */
+
+void sim_gnss_set_open_sky( bool open_sky )
+{
+    sim_open_sky = open_sky;
+}
+
+void sim_gnss_set_track( float speed_knots, float course_deg )
+{
+    sim_gnss_move( hal_rtc_get_time_ms( ));
+    sim_speed_knots = speed_knots;
+    sim_course_deg  = course_deg;
+}
+
+void sim_gnss_get_stats( sim_gnss_stats_t* stats )
+{
+    *stats = sim_stats;
+    if( sim_powered )
+    {
+        stats->on_ms += hal_rtc_get_time_ms( ) - sim_on_since_ms;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- AG3335 API --------------------------------------------------------------
+ */
+
+void gnss_init( void )
+{
+    sim_powered = false;
+}
+
+bool gnss_scan_start( void )
+{
+    uint32_t now = hal_rtc_get_time_ms( );
+    uint32_t age = now - sim_last_fix.timestamp_ms;
+    uint32_t ttff;
+
+    if( sim_powered )
+    {
+        return true;
+    }
+
+    if( !sim_ever_fixed || ( age > SIM_GNSS_COLD_AGE_MS ))
+    {
+        ttff = SIM_GNSS_COLD_MS;
+    }
+    else if( age > SIM_GNSS_WARM_AGE_MS )
+    {
+        ttff = SIM_GNSS_WARM_MS;
+    }
+    else
+    {
+        ttff = SIM_GNSS_HOT_MS;
+    }
+
+    sim_powered      = true;
+    sim_on_since_ms  = now;
+    sim_fix_ready_ms = now + ttff;
+    sim_stats.power_ons++;
+    return true;
+}
+
+void gnss_scan_stop( void )
+{
+    if( !sim_powered )
+    {
+        return;
+    }
+    sim_gnss_update( );
+    sim_powered = false;
+    sim_stats.on_ms += hal_rtc_get_time_ms( ) - sim_on_since_ms;
+}
+
+bool gnss_is_active( void )
+{
+    return sim_powered;
+}
+
+void gnss_wait_ms( uint32_t ms )
+{
+    hal_mcu_wait_ms( ms );
+}
+
+bool gnss_get_quality_fix( gnss_fix_t* fix )
+{
+    if( fix == NULL )
+    {
+        return false;
+    }
+    sim_gnss_update( );
+    *fix = sim_last_fix;
+    if( fix->valid )
+    {
+        sim_stats.fixes++;
+    }
+    else
+    {
+        sim_stats.no_fix++;
+    }
+    return fix->valid;
+}
+
+uint32_t gnss_fix_age_ms( const gnss_fix_t* fix )
+{
+    return hal_rtc_get_time_ms( ) - fix->timestamp_ms;
+}
+
+bool gnss_scan_until_good( uint32_t max_ms, float max_hdop, float max_hacc, gnss_fix_t* fix, bool skip_power_management )
+{
+    uint32_t           start_time;
+    uint32_t           elapsed = 0;
+    bool               good    = false;
+    gnss_sky_metrics_t sky;
+    gnss_scan_check_t  check        = sim_scan_check;
+    uint32_t           sky_check_ms = sim_sky_check_ms;
+    uint8_t            sky_min_top4 = sim_sky_min_top4;
+
+    if( fix == NULL )
+    {
+        return false;
+    }
+    memset( fix, 0, sizeof( gnss_fix_t ));
+    sim_ble_found    = false;
+    sim_scan_check   = NULL;
+    sim_sky_check_ms = 0;
+
+    if( !skip_power_management )
+    {
+        gnss_scan_start( );
+    }
+    start_time = hal_rtc_get_time_ms( );
+    memset( &sim_acq_stats, 0, sizeof( sim_acq_stats ));
+    sim_acq_stats.start_ms = start_time;
+
+    while( elapsed < max_ms )
+    {
+        sim_gnss_update( );
+        if( sim_powered && sim_last_fix.valid && ( sim_last_fix.timestamp_ms >= start_time ))
+        {
+            if( sim_acq_stats.ttff_ms == 0 )
+            {
+                sim_acq_stats.ttff_ms = elapsed;
+            }
+            sim_acq_stats.epochs++;
+            if(( sim_last_fix.hdop <= max_hdop ) && ( sim_last_fix.hacc <= max_hacc ))
+            {
+                sim_acq_stats.ttgf_ms = elapsed;
+                *fix = sim_last_fix;
+                good = true;
+                break;
+            }
+        }
+        if( sim_ble_found )
+        {
+            sim_acq_stats.ble_abort = true;
+            break;
+        }
+        gnss_sky_get_metrics( &sky );
+        if(( sky_check_ms > 0 ) && ( elapsed >= sky_check_ms ) && ( sky.top4_cn0 < sky_min_top4 ))
+        {
+            sim_acq_stats.sky_abort = true;
+            break;
+        }
+        if(( check != NULL ) && check( elapsed, max_ms, &sky ))
+        {
+            sim_acq_stats.check_abort = true;
+            break;
+        }
+
+        // One wake-up per NMEA epoch, as the UART sentences wake the target
+        uint32_t remaining = max_ms - elapsed;
+        if( remaining > SIM_GNSS_EPOCH_MS )
+        {
+            remaining = SIM_GNSS_EPOCH_MS;
+        }
+        if( remaining > 50 )
+        {
+            hal_mcu_set_sleep_for_ms( remaining );
+        }
+        else
+        {
+            gnss_wait_ms( remaining );
+        }
+        elapsed = hal_rtc_get_time_ms( ) - start_time;
+    }
+    sim_acq_stats.on_ms = hal_rtc_get_time_ms( ) - start_time;
+
+    if( !skip_power_management )
+    {
+        gnss_scan_stop( );
+    }
+
+    if( good )
+    {
+        sim_stats.fixes++;
+    }
+    else
+    {
+        sim_stats.no_fix++;
+        if( !sim_acq_stats.ble_abort )
+        {
+            *fix = sim_last_fix;
+        }
+    }
+    return good;
+}
+
+void gnss_get_acq_stats( gnss_acq_stats_t* stats )
+{
+    *stats = sim_acq_stats;
+}
+
+void gnss_sky_get_metrics( gnss_sky_metrics_t* metrics )
+{
+    memset( metrics, 0, sizeof( *metrics ));
+    if( !sim_powered )
+    {
+        return;
+    }
+    metrics->in_view = 12;
+    if( sim_open_sky )
+    {
+        metrics->tracked       = 10;
+        metrics->strong        = 8;
+        metrics->top4_cn0      = 42;
+        metrics->quadrant_mask = 0x0F;
+        metrics->quadrants     = 4;
+    }
+    metrics->gsv_count = ( hal_rtc_get_time_ms( ) - sim_on_since_ms ) / SIM_GNSS_EPOCH_MS;
+}
+
+void gnss_set_sky_abort( uint32_t check_ms, uint8_t min_top4_cn0 )
+{
+    sim_sky_check_ms = check_ms;
+    sim_sky_min_top4 = min_top4_cn0;
+}
+
+void gnss_set_scan_check( gnss_scan_check_t check )
+{
+    sim_scan_check = check;
+}
+
+void gnss_set_ble_found( bool found )
+{
+    sim_ble_found = found;
+    if( found )
+    {
+        hal_sleep_exit( );
+    }
+}
+
+void gnss_enable_nmea_debug( bool enable )
+{
+    ( void )enable;
+}
+
+bool gnss_send_command( const char* command )
+{
+    ( void )command;
+    return true;
+}
+
+bool gnss_almanac_is_valid( void )
+{
+    return true;
+}
+
+bool gnss_almanac_needs_maintenance( void )
+{
+    return false;
+}
+
+uint8_t gnss_almanac_get_valid_sv_count( void )
+{
+    return 32;
+}
+
+uint32_t gnss_almanac_get_last_check_time( void )
+{
+    return hal_rtc_get_time_s( );
+}
+
+void gnss_almanac_refresh_status( void )
+{
+}
+
+/* --- EOF ------------------------------------------------------------------ */
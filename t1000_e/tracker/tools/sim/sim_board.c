@@ -0,0 +1,300 @@
+/*!
+ * @file      sim_board.c
+ *
+ * @brief     Board side of the tracker host simulation
+ *
+ * GPIO inputs read back the levels set by sim_board_set_pin( ), with the
+ * charger idle and the button released. The internal flash is a 1 MB RAM
+ * array with 4 KB pages. Trace output goes to stdout with the virtual time
+ * when verbose, the USB CDC link counts as connected only then. LED, buzzer,
+ * accelerometer and battery are inert.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "smtc_hal.h"
+#include "smtc_hal_trace.h"
+#include "smtc_board.h"
+#include "app_led.h"
+#include "app_beep.h"
+#include "tracker_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_GPIO_PINS           48          // P0.00 to P1.15
+#define SIM_FLASH_SIZE          0x100000
+#define SIM_FLASH_PAGE_SIZE     0x1000
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint32_t sim_pins[SIM_GPIO_PINS];
+static bool     sim_pins_ready = false;
+static uint8_t  sim_flash[SIM_FLASH_SIZE];
+static bool     sim_flash_ready = false;
+static bool     sim_verbose = false;
+
+uint8_t app_led_state  = 0;
+uint8_t app_beep_state = 0;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void sim_board_pins_init( void )
+{
+    if( sim_pins_ready )
+    {
+        return;
+    }
+    memset( sim_pins, 0, sizeof( sim_pins ));
+    // Charge status outputs of the charger are open drain, high when idle
+    sim_pins[CHARGER_CHRG] = 1;
+    sim_pins[CHARGER_DONE] = 1;
+    sim_pins_ready = true;
+}
+
+static void sim_board_flash_init( void )
+{
+    if( sim_flash_ready )
+    {
+        return;
+    }
+    memset( sim_flash, 0xFF, sizeof( sim_flash ));
+    sim_flash_ready = true;
+}
+
+static void sim_board_print( const char* text, size_t len )
+{
+    uint32_t now = hal_rtc_get_time_ms( );
+
+    if( !sim_verbose )
+    {
+        return;
+    }
+    printf( "[%02lu:%02lu:%02lu.%03lu] %.*s", ( unsigned long )( now / 3600000 ),
+            ( unsigned long )( now / 60000 % 60 ), ( unsigned long )( now / 1000 % 60 ),
+            ( unsigned long )( now % 1000 ), ( int )len, text );
+    if(( len == 0 ) || ( text[len - 1] != '\n' ))
+    {
+        printf( "\n" );
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATION API ----------------------------------------------------------
+ */
+
+void sim_board_set_verbose( bool verbose )
+{
+    sim_verbose = verbose;
+}
+
+void sim_board_set_pin( uint32_t pin, uint32_t level )
+{
+    sim_board_pins_init( );
+    if( pin < SIM_GPIO_PINS )
+    {
+        sim_pins[pin] = level;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MCU AND BOARD -----------------------------------------------------------
+ */
+
+void hal_mcu_init( void )
+{
+    hal_rtc_init( );
+    sim_board_pins_init( );
+    sim_board_flash_init( );
+}
+
+void smtc_board_init_periph( void )
+{
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- GPIO --------------------------------------------------------------------
+ */
+
+void hal_gpio_init_in( uint32_t pin, const hal_gpio_pull_mode_t pull_mode, const hal_gpio_irq_mode_t irq_mode,
+                       hal_gpio_irq_t* irq )
+{
+    ( void )pin;
+    ( void )pull_mode;
+    ( void )irq_mode;
+    ( void )irq;
+    sim_board_pins_init( );
+}
+
+void hal_gpio_init_out( uint32_t pin, hal_gpio_state_t value )
+{
+    sim_board_set_pin( pin, value );
+}
+
+void hal_gpio_set_value( uint32_t pin, const hal_gpio_state_t value )
+{
+    sim_board_set_pin( pin, value );
+}
+
+uint32_t hal_gpio_get_value( uint32_t pin )
+{
+    sim_board_pins_init( );
+    return ( pin < SIM_GPIO_PINS ) ? sim_pins[pin] : 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- FLASH -------------------------------------------------------------------
+ */
+
+smtc_hal_status_t hal_flash_erase_page( uint32_t addr, uint8_t nb_page )
+{
+    uint32_t start = addr - ( addr % SIM_FLASH_PAGE_SIZE );
+
+    sim_board_flash_init( );
+    if( start + ( uint32_t )nb_page * SIM_FLASH_PAGE_SIZE > SIM_FLASH_SIZE )
+    {
+        return SMTC_HAL_FAILURE;
+    }
+    memset( sim_flash + start, 0xFF, ( uint32_t )nb_page * SIM_FLASH_PAGE_SIZE );
+    sim_periph_stats.flash_erases += nb_page;
+    return SMTC_HAL_SUCCESS;
+}
+
+smtc_hal_status_t hal_flash_write_buffer( uint32_t addr, const uint8_t* buffer, uint32_t size )
+{
+    sim_board_flash_init( );
+    if( addr + size > SIM_FLASH_SIZE )
+    {
+        return SMTC_HAL_FAILURE;
+    }
+    // NOR flash only clears bits
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        sim_flash[addr + i] &= buffer[i];
+    }
+    sim_periph_stats.flash_writes++;
+    return SMTC_HAL_SUCCESS;
+}
+
+void hal_flash_read_buffer( uint32_t addr, uint8_t* buffer, uint32_t size )
+{
+    sim_board_flash_init( );
+    if( addr + size <= SIM_FLASH_SIZE )
+    {
+        memcpy( buffer, sim_flash + addr, size );
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- TRACE AND SERIAL --------------------------------------------------------
+ */
+
+void hal_trace_print_var( const char* fmt, ... )
+{
+    char    text[512];
+    va_list args;
+    int     len;
+
+    if( !sim_verbose )
+    {
+        return;
+    }
+    va_start( args, fmt );
+    len = vsnprintf( text, sizeof( text ), fmt, args );
+    va_end( args );
+    if( len < 0 )
+    {
+        return;
+    }
+    sim_board_print( text, ( size_t )len < sizeof( text ) ? ( size_t )len : sizeof( text ) - 1 );
+}
+
+void hal_trace_write( uint8_t category, const char* text, uint16_t len )
+{
+    ( void )category;
+    sim_board_print( text, len );
+}
+
+void hal_trace_write_binary( uint8_t category, const uint8_t* data, uint16_t len )
+{
+    ( void )category;
+    ( void )data;
+    ( void )len;
+}
+
+bool hal_usb_cdc_is_connected( void )
+{
+    return sim_verbose;
+}
+
+void hal_uart_0_init( void )
+{
+}
+
+void hal_uart_0_deinit( void )
+{
+}
+
+void hal_spi_deinit( void )
+{
+}
+
+void hal_i2c_deinit( void )
+{
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SENSORS, LED AND BUZZER -------------------------------------------------
+ */
+
+void qma6100p_init( void )
+{
+}
+
+int16_t sensor_bat_sample( void )
+{
+    return 80;
+}
+
+void app_led_init( void ) {}
+void app_led_breathe_start( void ) {}
+void app_led_breathe_stop( void ) {}
+void app_led_ble_cfg( void ) {}
+void app_led_lora_joined( void ) {}
+void app_led_sos_run( void ) {}
+void app_led_sos_confirm( void ) {}
+void app_led_lora_downlink( void ) {}
+void app_led_idle( void ) {}
+void app_led_bat_new_detect( uint32_t time ) { ( void )time; }
+
+void app_beep_init( void ) {}
+void app_beep_boot_up( void ) {}
+void app_beep_power_off( void ) {}
+void app_beep_joined( void ) {}
+void app_beep_lora_downlink( void ) {}
+void app_beep_sos( void ) {}
+void app_beep_pos_s( void ) {}
+void app_beep_idle( void ) {}
+
+/* --- EOF ------------------------------------------------------------------ */
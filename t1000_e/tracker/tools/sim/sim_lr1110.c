@@ -0,0 +1,127 @@
+/*!
+ * @file      sim_lr1110.c
+ *
+ * @brief     LR1110 side of the tracker host simulation
+ *
+ * The radio itself is behind the modem model (sim_modem.c); what is left are
+ * the system calls main_lorawan_tracker.c makes directly, the board ralf and
+ * the Wi-Fi scanner, which finds no access point at sea.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "lr11xx_system.h"
+#include "ralf.h"
+#include "smtc_board.h"
+#include "smtc_board_ralf.h"
+#include "wifi_scan.h"
+#include "tracker_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static ralf_t sim_ralf;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- LR11XX SYSTEM -----------------------------------------------------------
+ */
+
+lr11xx_status_t lr11xx_system_cfg_lfclk( const void* context, const lr11xx_system_lfclk_cfg_t lfclock_cfg,
+                                         const bool wait_for_32k_ready )
+{
+    ( void )context;
+    ( void )lfclock_cfg;
+    ( void )wait_for_32k_ready;
+    return LR11XX_STATUS_OK;
+}
+
+lr11xx_status_t lr11xx_system_set_sleep( const void* context, const lr11xx_system_sleep_cfg_t sleep_cfg,
+                                         const uint32_t sleep_time )
+{
+    ( void )context;
+    ( void )sleep_cfg;
+    ( void )sleep_time;
+    return LR11XX_STATUS_OK;
+}
+
+lr11xx_status_t lr11xx_system_read_uid( const void* context, lr11xx_system_uid_t unique_identifier )
+{
+    static const uint8_t uid[LR11XX_SYSTEM_UID_LENGTH] = { 0x00, 0x16, 0xC0, 0x01, 0xF0, 0x00, 0x51, 0x4D };
+
+    ( void )context;
+    memcpy( unique_identifier, uid, LR11XX_SYSTEM_UID_LENGTH );
+    return LR11XX_STATUS_OK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- BOARD RADIO -------------------------------------------------------------
+ */
+
+ralf_t* smtc_board_initialise_and_get_ralf( void )
+{
+    return &sim_ralf;
+}
+
+int smtc_board_get_tx_power_offset( void )
+{
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- WI-FI SCAN --------------------------------------------------------------
+ */
+
+bool wifi_scan_start( ralf_t* modem_radio )
+{
+    ( void )modem_radio;
+    sim_periph_stats.wifi_scans++;
+    return true;
+}
+
+void wifi_scan_stop( ralf_t* modem_radio )
+{
+    ( void )modem_radio;
+}
+
+bool wifi_get_results( ralf_t* modem_radio, uint8_t* result, uint8_t* size )
+{
+    ( void )modem_radio;
+    ( void )result;
+    *size = 0;
+    return false;
+}
+
+bool wifi_scan_should_scan_remainder_channels( void )
+{
+    return false;
+}
+
+void wifi_scan_prepare_remainder_channels( void )
+{
+}
+
+bool wifi_scan_update_adaptive_state( void )
+{
+    return false;
+}
+
+uint8_t wifi_scan_get_next_max_results( void )
+{
+    return 3;
+}
+
+void wifi_display_results( void )
+{
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,846 @@
+/*!
+ * @file      sim_modem.c
+ *
+ * @brief     LoRa Basics Modem model of the tracker host simulation
+ *
+ * Stands in for the modem API the tracker uses. Uplink requests become tasks
+ * in the same slots as the modem supervisor (user, emergency, extended 1 and
+ * 2, link check); a slot already holding a task is replaced. One task is on
+ * air at a time, emergency first, then in request order. A task waits for
+ * the EU868 band duty cycle, kept by the real smtc_duty_cycle.c over the
+ * three default channels, except emergency tasks as with
+ * SMTC_DTC_PARTIAL_DISABLED. Each frame holds the radio for its time on air
+ * plus the two receive windows, then the modem raises the event of the task.
+ *
+ * Out of coverage (sim_modem_set_coverage) uplinks still go out but nothing
+ * answers: link checks end NOT_RECEIVED and confirmed uplinks NOT_SENT.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "smtc_modem_api.h"
+#include "smtc_modem_utilities.h"
+#include "smtc_modem_middleware_advanced_api.h"
+#include "smtc_modem_hal.h"
+#include "smtc_duty_cycle.h"
+#include "lorawan_api.h"
+#include "modem_context.h"
+#include "smtc_hal_rtc.h"
+#include "smtc_hal_sim.h"
+#include "tracker_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_MODEM_EVENT_QUEUE       16
+#define SIM_MODEM_RX_WINDOWS_MS     2200    // RX1 at 1 s, RX2 at 2 s, end of the RX2 preamble search
+#define SIM_MODEM_JOIN_MS           6200    // JoinRequest on air and JoinAccept in RX1
+#define SIM_MODEM_SLEEP_FLOOR_MS    50      // hal_mcu_set_sleep_for_ms( ) returns at once below this
+#define SIM_MODEM_MAX_SLEEP_MS      3600000
+#define SIM_MODEM_PHY_OVERHEAD      13      // MHDR, FHDR without FOpts, FPort, MIC
+#define SIM_MODEM_GPS_EPOCH_S       1400000000UL
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    SIM_TASK_SEND,
+    SIM_TASK_EMERGENCY,
+    SIM_TASK_EXTENDED_1,
+    SIM_TASK_EXTENDED_2,
+    SIM_TASK_LINK_CHECK,
+    SIM_TASK_NUM
+} sim_modem_task_id_t;
+
+typedef struct
+{
+    bool     pending;
+    uint32_t order;
+    uint8_t  port;
+    bool     confirmed;
+    uint8_t  length;
+    uint8_t  dr;
+    void ( *done )( void );
+} sim_modem_task_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const uint32_t sim_modem_freqs[] = { 868100000, 868300000, 868500000 };
+static const uint8_t  sim_modem_max_payload[] = { 51, 51, 51, 115, 222, 222 };
+
+static void ( *sim_event_callback )( void ) = NULL;
+static void ( *sim_engine_hook )( void ) = NULL;
+
+static smtc_modem_event_t sim_events[SIM_MODEM_EVENT_QUEUE];
+static uint8_t            sim_event_first = 0;
+static uint8_t            sim_event_count = 0;
+
+static sim_modem_task_t sim_tasks[SIM_TASK_NUM];
+static uint32_t         sim_task_order = 0;
+static int              sim_on_air = -1;        // Task on air, -1 if the radio is free
+static uint64_t         sim_on_air_end_ms = 0;
+static uint64_t         sim_retry_ms = 0;       // Next duty cycle check of a waiting task, 0 if none
+static uint8_t          sim_channel = 0;
+
+static smtc_dtc_t sim_dtc;
+
+static bool     sim_initialised = false;
+static bool     sim_coverage = true;
+static bool     sim_joined = false;
+static bool     sim_suspended = false;
+static uint64_t sim_join_ms = 0;
+static uint64_t sim_alarm_ms = 0;
+static uint8_t  sim_activation_mode = 0;
+static uint8_t  sim_region = SMTC_MODEM_REGION_EU_868;
+static uint8_t  sim_adr_list[SMTC_MODEM_CUSTOM_ADR_DATA_LENGTH] = { 0 };
+static uint32_t sim_adr_index = 0;
+static bool     sim_forced_dr_enabled = false;
+static uint8_t  sim_forced_dr = 0;
+static bool     sim_time_requested = false;
+static bool     sim_time_valid = false;
+static uint32_t sim_fcnt_down = 0;
+static uint32_t sim_random = 0x2545F491;
+
+static uint8_t sim_deveui[SMTC_MODEM_EUI_LENGTH];
+static uint8_t sim_joineui[SMTC_MODEM_EUI_LENGTH];
+
+static sim_modem_stats_t sim_stats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint64_t sim_modem_now_ms( void )
+{
+    return hal_sim_get_time_ms( );
+}
+
+static void sim_modem_push_event( const smtc_modem_event_t* event )
+{
+    if( sim_event_count >= SIM_MODEM_EVENT_QUEUE )
+    {
+        return;
+    }
+    sim_events[( sim_event_first + sim_event_count ) % SIM_MODEM_EVENT_QUEUE] = *event;
+    sim_event_count++;
+}
+
+static void sim_modem_push_simple_event( uint8_t type )
+{
+    smtc_modem_event_t event;
+
+    memset( &event, 0, sizeof( event ));
+    event.event_type = type;
+    sim_modem_push_event( &event );
+}
+
+/*!
+ * @brief LoRa time on air, BW 125 kHz, CR 4/5, 8 symbols preamble, explicit header, CRC on
+ */
+static uint32_t sim_modem_toa_ms( uint8_t dr, uint8_t phy_size )
+{
+    const int    sf    = 12 - dr;
+    const int    de    = ( sf >= 11 ) ? 1 : 0;
+    const double t_sym = ( double )( 1 << sf ) / 125.0;
+    const double num   = 8.0 * phy_size - 4.0 * sf + 28.0 + 16.0;
+    double       n_payload = 8.0 + fmax( ceil( num / ( 4.0 * ( sf - 2 * de ))) * 5.0, 0.0 );
+
+    return ( uint32_t )ceil(( 12.25 + n_payload ) * t_sym );
+}
+
+static uint8_t sim_modem_task_dr( void )
+{
+    uint8_t dr;
+
+    if( sim_forced_dr_enabled )
+    {
+        sim_forced_dr_enabled = false;
+        return sim_forced_dr;
+    }
+    dr = sim_adr_list[sim_adr_index++ % SMTC_MODEM_CUSTOM_ADR_DATA_LENGTH];
+    return dr <= 5 ? dr : 5;
+}
+
+static smtc_modem_return_code_t sim_modem_add_task( sim_modem_task_id_t id, uint8_t port, bool confirmed,
+                                                    uint8_t length, void ( *done )( void ))
+{
+    sim_modem_task_t* task = &sim_tasks[id];
+
+    if( !sim_joined || sim_suspended )
+    {
+        return SMTC_MODEM_RC_FAIL;
+    }
+    if( sim_on_air == ( int )id )
+    {
+        sim_stats.busy_refusals++;
+        return SMTC_MODEM_RC_BUSY;
+    }
+
+    task->pending   = true;
+    task->order     = sim_task_order++;
+    task->port      = port;
+    task->confirmed = confirmed;
+    task->length    = length;
+    task->dr        = sim_modem_task_dr( );
+    task->done      = done;
+    return SMTC_MODEM_RC_OK;
+}
+
+static int sim_modem_next_task( void )
+{
+    int next = -1;
+
+    if( sim_tasks[SIM_TASK_EMERGENCY].pending )
+    {
+        return SIM_TASK_EMERGENCY;
+    }
+    for( int i = 0; i < SIM_TASK_NUM; i++ )
+    {
+        if( sim_tasks[i].pending && (( next < 0 ) || ( sim_tasks[i].order < sim_tasks[next].order )))
+        {
+            next = i;
+        }
+    }
+    return next;
+}
+
+/*!
+ * @brief Put the next task on air if the radio and its band are free
+ */
+static void sim_modem_radio_start( void )
+{
+    uint64_t          now = sim_modem_now_ms( );
+    int               id;
+    sim_modem_task_t* task;
+    uint32_t          toa;
+    bool              emergency;
+
+    if( sim_on_air >= 0 )
+    {
+        return;
+    }
+    id = sim_modem_next_task( );
+    if( id < 0 )
+    {
+        sim_retry_ms = 0;
+        return;
+    }
+
+    task      = &sim_tasks[id];
+    emergency = ( id == SIM_TASK_EMERGENCY );
+    toa       = sim_modem_toa_ms( task->dr, task->length + SIM_MODEM_PHY_OVERHEAD );
+
+    smtc_duty_cycle_update( &sim_dtc );
+    if( !emergency && !smtc_duty_cycle_is_toa_accepted( &sim_dtc, sim_modem_freqs[sim_channel], toa ))
+    {
+        int32_t wait = smtc_duty_cycle_get_next_free_time_ms( &sim_dtc, 3, ( uint32_t* )sim_modem_freqs );
+
+        if( sim_retry_ms == 0 )
+        {
+            sim_stats.duty_cycle_waits++;
+        }
+        sim_retry_ms = now + ( wait > 0 ? ( uint32_t )wait : 1000 );
+        return;
+    }
+    sim_retry_ms = 0;
+
+    smtc_duty_cycle_sum( &sim_dtc, sim_modem_freqs[sim_channel], toa );
+    sim_channel = ( sim_channel + 1 ) % 3;
+
+    sim_on_air        = id;
+    sim_on_air_end_ms = now + toa + SIM_MODEM_RX_WINDOWS_MS;
+
+    sim_stats.uplinks++;
+    sim_stats.uplinks_by_port[task->port]++;
+    sim_stats.toa_ms += toa;
+    sim_stats.radio_on_ms += toa + SIM_MODEM_RX_WINDOWS_MS;
+    if( emergency )
+    {
+        sim_stats.emergency_uplinks++;
+    }
+}
+
+static void sim_modem_radio_done( void )
+{
+    sim_modem_task_t*  task = &sim_tasks[sim_on_air];
+    smtc_modem_event_t event;
+
+    memset( &event, 0, sizeof( event ));
+    switch( sim_on_air )
+    {
+    case SIM_TASK_EXTENDED_1:
+    case SIM_TASK_EXTENDED_2:
+        if( task->done != NULL )
+        {
+            task->done( );
+        }
+        break;
+
+    case SIM_TASK_LINK_CHECK:
+        sim_stats.link_checks++;
+        event.event_type                         = SMTC_MODEM_EVENT_LINK_CHECK;
+        event.event_data.link_check.status       = sim_coverage ? SMTC_MODEM_EVENT_LINK_CHECK_RECEIVED
+                                                                : SMTC_MODEM_EVENT_LINK_CHECK_NOT_RECEIVED;
+        event.event_data.link_check.margin       = sim_coverage ? 12 : 0;
+        event.event_data.link_check.gw_cnt       = sim_coverage ? 1 : 0;
+        if( !sim_coverage )
+        {
+            sim_stats.link_checks_lost++;
+        }
+        sim_modem_push_event( &event );
+        break;
+
+    default:
+        event.event_type = SMTC_MODEM_EVENT_TXDONE;
+        if( task->confirmed )
+        {
+            event.event_data.txdone.status = sim_coverage ? SMTC_MODEM_EVENT_TXDONE_CONFIRMED
+                                                          : SMTC_MODEM_EVENT_TXDONE_NOT_SENT;
+        }
+        else
+        {
+            event.event_data.txdone.status = SMTC_MODEM_EVENT_TXDONE_SENT;
+        }
+        sim_modem_push_event( &event );
+        break;
+    }
+
+    // DeviceTimeAns rides on the next frame the network hears
+    if( sim_time_requested && sim_coverage )
+    {
+        sim_time_requested = false;
+        sim_time_valid     = true;
+        memset( &event, 0, sizeof( event ));
+        event.event_type            = SMTC_MODEM_EVENT_TIME;
+        event.event_data.time.status = SMTC_MODEM_EVENT_TIME_VALID;
+        sim_modem_push_event( &event );
+    }
+
+    task->pending = false;
+    sim_on_air    = -1;
+}
+
+static void sim_modem_update( void )
+{
+    uint64_t now = sim_modem_now_ms( );
+
+    if(( sim_join_ms != 0 ) && ( now >= sim_join_ms ))
+    {
+        sim_join_ms = 0;
+        sim_joined  = true;
+        sim_modem_push_simple_event( SMTC_MODEM_EVENT_JOINED );
+    }
+    if(( sim_alarm_ms != 0 ) && ( now >= sim_alarm_ms ))
+    {
+        sim_alarm_ms = 0;
+        sim_stats.alarms++;
+        sim_modem_push_simple_event( SMTC_MODEM_EVENT_ALARM );
+    }
+    if(( sim_on_air >= 0 ) && ( now >= sim_on_air_end_ms ))
+    {
+        sim_modem_radio_done( );
+    }
+    sim_modem_radio_start( );
+}
+
+static uint64_t sim_modem_next_deadline( void )
+{
+    uint64_t next = sim_modem_now_ms( ) + SIM_MODEM_MAX_SLEEP_MS;
+
+    if(( sim_join_ms != 0 ) && ( sim_join_ms < next )) next = sim_join_ms;
+    if(( sim_alarm_ms != 0 ) && ( sim_alarm_ms < next )) next = sim_alarm_ms;
+    if(( sim_on_air >= 0 ) && ( sim_on_air_end_ms < next )) next = sim_on_air_end_ms;
+    if(( sim_retry_ms != 0 ) && ( sim_retry_ms < next )) next = sim_retry_ms;
+    return next;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATION API ----------------------------------------------------------
+ */
+
+void sim_modem_set_engine_hook( void ( *hook )( void ))
+{
+    sim_engine_hook = hook;
+}
+
+void sim_modem_set_coverage( bool coverage )
+{
+    sim_coverage = coverage;
+}
+
+void sim_modem_get_stats( sim_modem_stats_t* stats )
+{
+    *stats = sim_stats;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MODEM UTILITIES ---------------------------------------------------------
+ */
+
+void smtc_modem_init( const ralf_t* radio, void ( *event_callback )( void ))
+{
+    ( void )radio;
+
+    sim_event_callback = event_callback;
+    sim_initialised    = true;
+
+    smtc_duty_cycle_init( &sim_dtc );
+    smtc_duty_cycle_config( &sim_dtc, 1, 0, 100, 868000000, 868600000 );
+    smtc_duty_cycle_enable_set( &sim_dtc, SMTC_DTC_ENABLED );
+
+    smtc_modem_event_t event;
+    memset( &event, 0, sizeof( event ));
+    event.event_type             = SMTC_MODEM_EVENT_RESET;
+    event.event_data.reset.count = 1;
+    sim_modem_push_event( &event );
+}
+
+uint32_t smtc_modem_run_engine( void )
+{
+    uint64_t now;
+    uint64_t next;
+
+    if( sim_engine_hook != NULL )
+    {
+        sim_engine_hook( );
+    }
+
+    sim_modem_update( );
+    if(( sim_event_count > 0 ) && ( sim_event_callback != NULL ))
+    {
+        sim_event_callback( );
+    }
+    sim_modem_radio_start( );
+
+    if( sim_event_count > 0 )
+    {
+        return 0;
+    }
+
+    now  = sim_modem_now_ms( );
+    next = sim_modem_next_deadline( );
+    if( next - now <= SIM_MODEM_SLEEP_FLOOR_MS )
+    {
+        // The main loop would spin through these, the engine stays busy until then
+        hal_sim_advance_ms( next - now );
+        return 0;
+    }
+    return ( uint32_t )( next - now );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MODEM API ---------------------------------------------------------------
+ */
+
+smtc_modem_return_code_t smtc_modem_get_event( smtc_modem_event_t* event, uint8_t* event_pending_count )
+{
+    if( sim_event_count == 0 )
+    {
+        memset( event, 0, sizeof( *event ));
+        event->event_type    = SMTC_MODEM_EVENT_NONE;
+        *event_pending_count = 0;
+        return SMTC_MODEM_RC_OK;
+    }
+    *event = sim_events[sim_event_first];
+    sim_event_first = ( sim_event_first + 1 ) % SIM_MODEM_EVENT_QUEUE;
+    sim_event_count--;
+    *event_pending_count = sim_event_count;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_alarm_start_timer( uint32_t alarm_timer_in_s )
+{
+    sim_alarm_ms = sim_modem_now_ms( ) + ( uint64_t )alarm_timer_in_s * 1000;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_alarm_clear_timer( void )
+{
+    sim_alarm_ms = 0;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_join_network( uint8_t stack_id )
+{
+    ( void )stack_id;
+    sim_join_ms = sim_modem_now_ms( ) + SIM_MODEM_JOIN_MS;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_leave_network( uint8_t stack_id )
+{
+    ( void )stack_id;
+    sim_joined  = false;
+    sim_join_ms = 0;
+    memset( sim_tasks, 0, sizeof( sim_tasks ));
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_suspend_radio_communications( bool suspend )
+{
+    sim_suspended = suspend;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_status( uint8_t stack_id, smtc_modem_status_mask_t* status_mask )
+{
+    ( void )stack_id;
+    *status_mask = 0;
+    if( sim_joined ) *status_mask |= SMTC_MODEM_STATUS_JOINED;
+    if( sim_join_ms != 0 ) *status_mask |= SMTC_MODEM_STATUS_JOINING;
+    if( sim_suspended ) *status_mask |= SMTC_MODEM_STATUS_SUSPEND;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_request_uplink( uint8_t stack_id, uint8_t fport, bool confirmed,
+                                                    const uint8_t* payload, uint8_t payload_length )
+{
+    ( void )stack_id;
+    ( void )payload;
+    return sim_modem_add_task( SIM_TASK_SEND, fport, confirmed, payload_length, NULL );
+}
+
+smtc_modem_return_code_t smtc_modem_request_emergency_uplink( uint8_t stack_id, uint8_t fport, bool confirmed,
+                                                              const uint8_t* payload, uint8_t payload_length )
+{
+    ( void )stack_id;
+    ( void )payload;
+    return sim_modem_add_task( SIM_TASK_EMERGENCY, fport, confirmed, payload_length, NULL );
+}
+
+smtc_modem_return_code_t smtc_modem_request_empty_uplink( uint8_t stack_id, bool send_fport, uint8_t fport,
+                                                          bool confirmed )
+{
+    ( void )stack_id;
+    ( void )send_fport;
+    return sim_modem_add_task( SIM_TASK_SEND, fport, confirmed, 0, NULL );
+}
+
+smtc_modem_return_code_t smtc_modem_request_extended_uplink( uint8_t stack_id, uint8_t f_port, bool confirmed,
+                                                             const uint8_t* payload, uint8_t payload_length,
+                                                             uint8_t extended_uplink_id,
+                                                             void ( *lbm_notification_callback )( void ))
+{
+    ( void )stack_id;
+    ( void )payload;
+    if(( extended_uplink_id != 1 ) && ( extended_uplink_id != 2 ))
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+    return sim_modem_add_task( extended_uplink_id == 1 ? SIM_TASK_EXTENDED_1 : SIM_TASK_EXTENDED_2, f_port,
+                               confirmed, payload_length, lbm_notification_callback );
+}
+
+smtc_modem_return_code_t smtc_modem_lorawan_request_link_check( uint8_t stack_id )
+{
+    ( void )stack_id;
+    return sim_modem_add_task( SIM_TASK_LINK_CHECK, 0, false, 0, NULL );
+}
+
+smtc_modem_return_code_t smtc_modem_get_duty_cycle_status( int32_t* duty_cycle_status_ms )
+{
+    smtc_duty_cycle_update( &sim_dtc );
+    *duty_cycle_status_ms = -1 * smtc_duty_cycle_get_next_free_time_ms( &sim_dtc, 3, ( uint32_t* )sim_modem_freqs );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_airtime_plan( uint8_t stack_id, uint8_t datarate, uint8_t payload_length,
+                                                      uint8_t count, smtc_modem_airtime_plan_t* plan )
+{
+    ( void )stack_id;
+    if(( datarate > 5 ) || ( payload_length > sim_modem_max_payload[datarate] ))
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+
+    plan->toa_ms         = sim_modem_toa_ms( datarate, payload_length + SIM_MODEM_PHY_OVERHEAD );
+    plan->burst_toa_ms   = plan->toa_ms * count;
+    plan->frame_gap_ms   = 0;
+    smtc_duty_cycle_update( &sim_dtc );
+    plan->earliest_send_ms = smtc_duty_cycle_plan_burst_ms( &sim_dtc, 3, ( uint32_t* )sim_modem_freqs, plan->toa_ms,
+                                                            count, &plan->band_budget_ms );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_next_tx_max_payload( uint8_t stack_id, uint8_t* tx_max_payload_size )
+{
+    uint8_t dr = sim_forced_dr_enabled ? sim_forced_dr : sim_adr_list[sim_adr_index % SMTC_MODEM_CUSTOM_ADR_DATA_LENGTH];
+
+    ( void )stack_id;
+    *tx_max_payload_size = sim_modem_max_payload[dr <= 5 ? dr : 5];
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_next_uplink_datarate( uint8_t stack_id, uint8_t dr )
+{
+    ( void )stack_id;
+    if( dr > 5 )
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+    sim_forced_dr_enabled = true;
+    sim_forced_dr         = dr;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_adr_set_profile( uint8_t stack_id, smtc_modem_adr_profile_t adr_profile,
+                                                     const uint8_t adr_custom_data[SMTC_MODEM_CUSTOM_ADR_DATA_LENGTH] )
+{
+    ( void )stack_id;
+    if(( adr_profile == SMTC_MODEM_ADR_PROFILE_CUSTOM ) && ( adr_custom_data != NULL ))
+    {
+        memcpy( sim_adr_list, adr_custom_data, sizeof( sim_adr_list ));
+    }
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_time_start_sync_service( uint8_t stack_id,
+                                                             smtc_modem_time_sync_service_t sync_service )
+{
+    ( void )stack_id;
+    ( void )sync_service;
+    return sim_joined ? SMTC_MODEM_RC_OK : SMTC_MODEM_RC_FAIL;
+}
+
+smtc_modem_return_code_t smtc_modem_time_trigger_sync_request( uint8_t stack_id )
+{
+    ( void )stack_id;
+    if( !sim_joined )
+    {
+        return SMTC_MODEM_RC_FAIL;
+    }
+    sim_time_requested = true;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_time( uint32_t* gps_time_s, uint32_t* gps_fractional_s )
+{
+    uint64_t now = sim_modem_now_ms( );
+
+    if( !sim_time_valid )
+    {
+        return SMTC_MODEM_RC_NO_TIME;
+    }
+    *gps_time_s       = SIM_MODEM_GPS_EPOCH_S + ( uint32_t )( now / 1000 );
+    *gps_fractional_s = ( uint32_t )( now % 1000 );
+    return SMTC_MODEM_RC_OK;
+}
+
+uint8_t smtc_modem_get_activation_mode( uint8_t stack_id )
+{
+    ( void )stack_id;
+    return sim_activation_mode;
+}
+
+smtc_modem_return_code_t smtc_modem_set_activation_mode( uint8_t stack_id, uint8_t mode )
+{
+    ( void )stack_id;
+    sim_activation_mode = mode;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_region( uint8_t stack_id, smtc_modem_region_t* region )
+{
+    ( void )stack_id;
+    *region = sim_region;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_region( uint8_t stack_id, smtc_modem_region_t region )
+{
+    ( void )stack_id;
+    // Only the EU868 band plan is modelled
+    return ( region == SMTC_MODEM_REGION_EU_868 ) ? SMTC_MODEM_RC_OK : SMTC_MODEM_RC_INVALID;
+}
+
+smtc_modem_return_code_t smtc_modem_set_region_sub_band( uint8_t stack_id, uint8_t band )
+{
+    ( void )stack_id;
+    ( void )band;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_deveui( uint8_t stack_id, uint8_t deveui[SMTC_MODEM_EUI_LENGTH] )
+{
+    ( void )stack_id;
+    memcpy( deveui, sim_deveui, SMTC_MODEM_EUI_LENGTH );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_deveui( uint8_t stack_id, const uint8_t deveui[SMTC_MODEM_EUI_LENGTH] )
+{
+    ( void )stack_id;
+    memcpy( sim_deveui, deveui, SMTC_MODEM_EUI_LENGTH );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_joineui( uint8_t stack_id, uint8_t joineui[SMTC_MODEM_EUI_LENGTH] )
+{
+    ( void )stack_id;
+    memcpy( joineui, sim_joineui, SMTC_MODEM_EUI_LENGTH );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_joineui( uint8_t stack_id, const uint8_t joineui[SMTC_MODEM_EUI_LENGTH] )
+{
+    ( void )stack_id;
+    memcpy( sim_joineui, joineui, SMTC_MODEM_EUI_LENGTH );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_nwkkey( uint8_t stack_id, const uint8_t nwkkey[SMTC_MODEM_KEY_LENGTH] )
+{
+    ( void )stack_id;
+    ( void )nwkkey;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_appskey( uint8_t stack_id, const uint8_t appskey[SMTC_MODEM_KEY_LENGTH] )
+{
+    ( void )stack_id;
+    ( void )appskey;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_nwkskey( uint8_t stack_id, const uint8_t nwkskey[SMTC_MODEM_KEY_LENGTH] )
+{
+    ( void )stack_id;
+    ( void )nwkskey;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_devaddr( uint8_t stack_id, uint32_t dev_addr )
+{
+    ( void )stack_id;
+    ( void )dev_addr;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_class( uint8_t stack_id, smtc_modem_class_t lorawan_class )
+{
+    ( void )stack_id;
+    ( void )lorawan_class;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_nb_trans( uint8_t stack_id, uint8_t nb_trans )
+{
+    ( void )stack_id;
+    ( void )nb_trans;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_tx_power_offset_db( uint8_t stack_id, int8_t tx_pwr_offset_db )
+{
+    ( void )stack_id;
+    ( void )tx_pwr_offset_db;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_modem_version( smtc_modem_version_t* firmware_version )
+{
+    firmware_version->major = 3;
+    firmware_version->minor = 2;
+    firmware_version->patch = 4;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_lorawan_version( smtc_modem_lorawan_version_t* lorawan_version )
+{
+    lorawan_version->major    = 1;
+    lorawan_version->minor    = 0;
+    lorawan_version->patch    = 4;
+    lorawan_version->revision = 0;
+    return SMTC_MODEM_RC_OK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MODEM INTERNALS USED BY THE APPLICATION ---------------------------------
+ */
+
+void set_modem_status_modem_joined( bool value )
+{
+    sim_joined = value;
+}
+
+uint32_t lorawan_api_fcnt_down_get( void )
+{
+    return sim_fcnt_down;
+}
+
+bool lorawan_api_fcnt_down_sync_pending_get( void )
+{
+    return false;
+}
+
+void memcpy1( uint8_t* dst, const uint8_t* src, uint16_t size )
+{
+    memcpy( dst, src, size );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MODEM HAL ---------------------------------------------------------------
+ */
+
+uint32_t smtc_modem_hal_get_time_in_ms( void )
+{
+    return ( uint32_t )sim_modem_now_ms( );
+}
+
+uint32_t smtc_modem_hal_get_random_nb_in_range( const uint32_t val_1, const uint32_t val_2 )
+{
+    const uint32_t low  = val_1 < val_2 ? val_1 : val_2;
+    const uint32_t high = val_1 < val_2 ? val_2 : val_1;
+
+    // xorshift32, the replay has to be reproducible
+    sim_random ^= sim_random << 13;
+    sim_random ^= sim_random >> 17;
+    sim_random ^= sim_random << 5;
+    return low + sim_random % ( high - low + 1 );
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[32] )
+{
+    ( void )crashlog;
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+    ( void )available;
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    fprintf( stderr, "modem panic at %llu ms\n", ( unsigned long long )sim_modem_now_ms( ));
+    exit( 1 );
+}
+
+void smtc_modem_hal_print_trace( const char* fmt, ... )
+{
+    ( void )fmt;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,329 @@
+/*!
+ * @file      sim_softdevice.c
+ *
+ * @brief     SoftDevice side of the tracker host simulation
+ *
+ * app_timer timers fire from the simulated clock, FDS records live in RAM and
+ * the BLE scanner reports one vessel iBeacon while sim_ble_set_beacon( ) says
+ * it is in reach. The BLE configuration service is never connected.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "app_timer.h"
+#include "app_at_fds_datas.h"
+#include "app_ble_all.h"
+#include "ble_scan.h"
+#include "smtc_hal_sim.h"
+#include "tracker_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_FDS_RECORDS         32
+#define SIM_FDS_RECORD_SIZE     1024
+#define SIM_BLE_UPLINK_RECORD   5       // Major, Minor, RSSI, as app_ble_all.c packs them
+#define SIM_BLE_BEACON_MAJOR    0x0101
+#define SIM_BLE_BEACON_MINOR    0x0000  // Movement only, no DR profile
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef struct
+{
+    bool     used;
+    uint16_t file_id;
+    uint16_t key;
+    uint16_t len;
+    uint8_t  data[SIM_FDS_RECORD_SIZE];
+} sim_fds_record_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static struct sim_app_timer_s* sim_timers = NULL;
+static sim_fds_record_t        sim_fds[SIM_FDS_RECORDS];
+
+static bool     sim_ble_in_reach = false;
+static int8_t   sim_ble_rssi     = -70;
+static bool     sim_ble_scanning = false;
+static bool     sim_ble_seen     = false;
+static uint64_t sim_ble_start_ms = 0;
+
+sim_periph_stats_t sim_periph_stats;
+
+uint8_t ble_uuid_filter_array[16] = { 0 };
+uint8_t ble_uuid_filter_num = 0;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static sim_fds_record_t* sim_fds_find( uint16_t file_id, uint16_t key )
+{
+    for( int i = 0; i < SIM_FDS_RECORDS; i++ )
+    {
+        if( sim_fds[i].used && ( sim_fds[i].file_id == file_id ) && ( sim_fds[i].key == key ))
+        {
+            return &sim_fds[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- SIMULATION API ----------------------------------------------------------
+ */
+
+void sim_app_timer_process( uint64_t now_ms )
+{
+    bool fired;
+
+    // A handler may start or stop timers, rescan the list after each one
+    do
+    {
+        fired = false;
+        for( struct sim_app_timer_s* timer = sim_timers; timer != NULL; timer = timer->next )
+        {
+            if( timer->running && ( timer->expiry_ms <= now_ms ))
+            {
+                if( timer->mode == APP_TIMER_MODE_REPEATED )
+                {
+                    timer->expiry_ms += timer->period_ms;
+                }
+                else
+                {
+                    timer->running = false;
+                }
+                sim_periph_stats.app_timer_fired++;
+                timer->handler( timer->context );
+                fired = true;
+                break;
+            }
+        }
+    } while( fired );
+}
+
+void sim_ble_set_beacon( bool in_reach, int8_t rssi )
+{
+    sim_ble_in_reach = in_reach;
+    sim_ble_rssi     = rssi;
+}
+
+void sim_periph_get_stats( sim_periph_stats_t* stats )
+{
+    *stats = sim_periph_stats;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- APP TIMER ---------------------------------------------------------------
+ */
+
+ret_code_t app_timer_init( void )
+{
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create( app_timer_id_t const* p_timer_id, app_timer_mode_t mode,
+                             app_timer_timeout_handler_t timeout_handler )
+{
+    struct sim_app_timer_s* timer = *p_timer_id;
+
+    timer->mode    = mode;
+    timer->handler = timeout_handler;
+    timer->running = false;
+    for( struct sim_app_timer_s* it = sim_timers; it != NULL; it = it->next )
+    {
+        if( it == timer )
+        {
+            return NRF_SUCCESS;
+        }
+    }
+    timer->next = sim_timers;
+    sim_timers  = timer;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start( app_timer_id_t timer_id, uint32_t timeout_ticks, void* p_context )
+{
+    uint32_t period_ms = ( uint32_t )(( uint64_t )timeout_ticks * 1000 / APP_TIMER_CLOCK_FREQ );
+
+    if( period_ms == 0 )
+    {
+        period_ms = 1;
+    }
+    // Starting a running timer is ignored by app_timer
+    if( timer_id->running )
+    {
+        return NRF_SUCCESS;
+    }
+    timer_id->context   = p_context;
+    timer_id->period_ms = period_ms;
+    timer_id->expiry_ms = hal_sim_get_time_ms( ) + period_ms;
+    timer_id->running   = true;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop( app_timer_id_t timer_id )
+{
+    timer_id->running = false;
+    return NRF_SUCCESS;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- FDS ---------------------------------------------------------------------
+ */
+
+void fds_init_write( void )
+{
+}
+
+bool read_fds_record( uint16_t file_id, uint16_t rec_key, void* data, uint16_t len )
+{
+    sim_fds_record_t* record = sim_fds_find( file_id, rec_key );
+
+    if(( record == NULL ) || ( record->len != len ))
+    {
+        return false;
+    }
+    memcpy( data, record->data, len );
+    return true;
+}
+
+bool write_fds_record( uint16_t file_id, uint16_t rec_key, void const* data, uint16_t len )
+{
+    sim_fds_record_t* record = sim_fds_find( file_id, rec_key );
+
+    if( len > SIM_FDS_RECORD_SIZE )
+    {
+        return false;
+    }
+    for( int i = 0; ( record == NULL ) && ( i < SIM_FDS_RECORDS ); i++ )
+    {
+        if( !sim_fds[i].used )
+        {
+            record          = &sim_fds[i];
+            record->used    = true;
+            record->file_id = file_id;
+            record->key     = rec_key;
+        }
+    }
+    if( record == NULL )
+    {
+        return false;
+    }
+    record->len = len;
+    memcpy( record->data, data, len );
+    sim_periph_stats.fds_writes++;
+    return true;
+}
+
+bool write_current_param_config( void )
+{
+    sim_periph_stats.fds_writes++;
+    return true;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- BLE ---------------------------------------------------------------------
+ */
+
+void app_ble_all_init( void )
+{
+}
+
+void app_ble_advertising_start( void )
+{
+}
+
+void app_ble_advertising_stop( void )
+{
+}
+
+bool app_ble_is_disconnected( void )
+{
+    return true;
+}
+
+void app_ble_disconnect( void )
+{
+}
+
+bool ble_scan_start( void )
+{
+    sim_ble_scanning = true;
+    sim_ble_seen     = false;
+    sim_ble_start_ms = hal_sim_get_time_ms( );
+    sim_periph_stats.ble_scans++;
+    return true;
+}
+
+void ble_scan_stop( void )
+{
+    if( !sim_ble_scanning )
+    {
+        return;
+    }
+    sim_ble_scanning = false;
+    sim_ble_seen     = sim_ble_in_reach;
+    sim_periph_stats.ble_scan_ms += hal_sim_get_time_ms( ) - sim_ble_start_ms;
+    if( sim_ble_seen )
+    {
+        sim_periph_stats.ble_found++;
+    }
+}
+
+bool ble_get_results( uint8_t* result, uint8_t* size )
+{
+    const uint16_t major = SIM_BLE_BEACON_MAJOR;
+    const uint16_t minor = SIM_BLE_BEACON_MINOR;
+
+    *size = 0;
+    if( !sim_ble_seen )
+    {
+        return false;
+    }
+    memcpy( result, &major, 2 );
+    memcpy( result + 2, &minor, 2 );
+    memcpy( result + 4, &sim_ble_rssi, 1 );
+    *size = SIM_BLE_UPLINK_RECORD;
+    return true;
+}
+
+bool ble_get_strongest_approved_beacon( ble_beacon_hint_t* hint )
+{
+    memset( hint, 0, sizeof( *hint ));
+    if( !sim_ble_seen )
+    {
+        return false;
+    }
+    hint->major = SIM_BLE_BEACON_MAJOR;
+    hint->minor = SIM_BLE_BEACON_MINOR;
+    hint->rssi  = sim_ble_rssi;
+    hint->mac[0] = 0xC0;
+    hint->mac[5] = 0x01;
+    return true;
+}
+
+void ble_display_results( void )
+{
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,148 @@
+/*!
+ * @file      tracker_sim.h
+ *
+ * @brief     Peripheral models of the tracker host simulation
+ *
+ * The tracker state machine (main_lorawan_tracker.c and the tracker modules)
+ * is linked unchanged against smtc_hal_sim.c for time and against the models
+ * below for the chips around the nRF52840:
+ *
+ *   sim_modem.c       LoRa Basics Modem API: event queue, alarm, uplink tasks,
+ *                     EU868 duty cycle through smtc_duty_cycle.c, link checks
+ *   sim_lr1110.c      LR1110 system calls, board ralf and the Wi-Fi scanner
+ *   sim_ag3335.c      AG3335 GNSS API: time to fix from the last fix, sky state
+ *   sim_softdevice.c  app_timer, FDS records and the BLE scanner
+ *   sim_board.c       GPIO, flash, trace, LED, buzzer and the other board drivers
+ *
+ * The replay driver sets the scenario through the functions here.
+ */
+
+#ifndef TRACKER_SIM_H
+#define TRACKER_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Radio activity seen by the modem model
+ */
+typedef struct
+{
+    uint32_t uplinks;               // Frames on air, link checks included
+    uint32_t uplinks_by_port[256];
+    uint32_t emergency_uplinks;
+    uint32_t link_checks;
+    uint32_t link_checks_lost;      // Link checks sent out of coverage
+    uint32_t duty_cycle_waits;      // Frames held back by the band duty cycle
+    uint32_t busy_refusals;         // Requests refused because the task slot was taken
+    uint64_t toa_ms;                // Time on air
+    uint64_t radio_on_ms;           // TX plus RX windows
+    uint32_t alarms;
+} sim_modem_stats_t;
+
+/*!
+ * @brief GNSS activity seen by the AG3335 model
+ */
+typedef struct
+{
+    uint32_t power_ons;
+    uint64_t on_ms;                 // Receiver powered time
+    uint32_t fixes;                 // gnss_get_quality_fix / gnss_scan_until_good calls that returned a fix
+    uint32_t no_fix;                // Calls that found no fix
+} sim_gnss_stats_t;
+
+/*!
+ * @brief Radio scans seen by the SoftDevice and LR1110 models
+ */
+typedef struct
+{
+    uint32_t ble_scans;
+    uint64_t ble_scan_ms;
+    uint32_t ble_found;
+    uint32_t wifi_scans;
+    uint32_t app_timer_fired;
+    uint32_t fds_writes;
+    uint32_t flash_erases;
+    uint32_t flash_writes;
+} sim_periph_stats_t;
+
+/*!
+ * @brief Counters of sim_periph_get_stats( ), shared by the SoftDevice, LR1110 and board models
+ */
+extern sim_periph_stats_t sim_periph_stats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Called at the start of every smtc_modem_run_engine( ), the replay ends the run from there
+ */
+void sim_modem_set_engine_hook( void ( *hook )( void ) );
+
+/*!
+ * @brief Gateway in reach: uplinks are received and link checks answered
+ */
+void sim_modem_set_coverage( bool coverage );
+
+void sim_modem_get_stats( sim_modem_stats_t* stats );
+
+/*!
+ * @brief Open sky: the receiver gets a fix, time to fix depending on the age of the last one
+ */
+void sim_gnss_set_open_sky( bool open_sky );
+
+/*!
+ * @brief Ground track of the wearer, from the start position
+ *
+ * @param [in] speed_knots  Speed over ground
+ * @param [in] course_deg   Course over ground, degrees from north
+ */
+void sim_gnss_set_track( float speed_knots, float course_deg );
+
+void sim_gnss_get_stats( sim_gnss_stats_t* stats );
+
+/*!
+ * @brief Vessel iBeacon in reach of the BLE scanner
+ */
+void sim_ble_set_beacon( bool in_reach, int8_t rssi );
+
+void sim_periph_get_stats( sim_periph_stats_t* stats );
+
+/*!
+ * @brief Run the app_timer timers due at now_ms, called from the simulation step hook
+ */
+void sim_app_timer_process( uint64_t now_ms );
+
+/*!
+ * @brief Print the trace output of the firmware to stdout
+ */
+void sim_board_set_verbose( bool verbose );
+
+/*!
+ * @brief Set the level read back from an input pin
+ */
+void sim_board_set_pin( uint32_t pin, uint32_t level );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TRACKER_SIM_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,170 @@
+/*
+ * Host replay of uplink profiles through the duty cycle log.
+ *
+ * Each profile feeds smtc_duty_cycle_sum with the uplinks of one EU868 band
+ * (868.0-868.6 MHz, 1 %) and, every 10 s, compares the TOA the band log
+ * still counts with the exact sum of the uplinks of the last hour. The log
+ * may only over-count (budget under-estimated): the replay fails if it ever
+ * counts less than the exact sum, and reports how far above it goes.
+ *
+ * Profiles:
+ *   mob     MOB burst pairs every 30 s for 20 min, then PIW pairs every 60 s
+ *   steady  one uplink per minute
+ *   sparse  one uplink every 5 min, below the log size over one period
+ *
+ *   C=../../../lora_basics_modem/smtc_modem_core
+ *   gcc -O2 -DMODEM_HAL_DBG_TRACE=0 -I$C/lr1mac/src/services -I../../../lora_basics_modem/smtc_modem_hal \
+ *       -I$C/modem_config smtc_duty_cycle_replay.c $C/lr1mac/src/services/smtc_duty_cycle.c \
+ *       -o smtc_duty_cycle_replay && ./smtc_duty_cycle_replay
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "smtc_duty_cycle.h"
+#include "smtc_modem_hal.h"
+
+#define REPLAY_FREQ_HZ 868100000UL
+#define REPLAY_HOURS 4
+#define REPLAY_STEP_MS 10000UL
+#define REPLAY_MAX_UPLINKS 4096
+
+typedef struct
+{
+    const char* name;
+    uint32_t    pair_period_ms;   // Period of the first phase, 0 if none
+    uint32_t    pair_phase_ms;    // Length of the first phase
+    uint32_t    period_ms;        // Period after the first phase
+    uint8_t     frames;           // Frames per period
+    uint32_t    toa_ms[2];        // TOA of each frame of a period
+} replay_profile_t;
+
+static const replay_profile_t profiles[] = {
+    { "mob", 30000, 20 * 60000, 60000, 2, { 206, 411 } },
+    { "steady", 0, 0, 60000, 1, { 206, 206 } },
+    { "sparse", 0, 0, 300000, 1, { 411, 411 } },
+};
+
+static uint32_t now_ms;
+static uint32_t uplink_ts[REPLAY_MAX_UPLINKS];
+static uint32_t uplink_toa[REPLAY_MAX_UPLINKS];
+static uint32_t uplink_count;
+
+uint32_t smtc_modem_hal_get_time_in_ms( void )
+{
+    return now_ms;
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[32] )
+{
+    ( void ) crashlog;
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+    ( void ) available;
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    fprintf( stderr, "panic\n" );
+    exit( 1 );
+}
+
+static uint32_t exact_sum_ms( void )
+{
+    uint32_t sum = 0;
+
+    for( uint32_t i = 0; i < uplink_count; i++ )
+    {
+        if( ( now_ms - uplink_ts[i] ) < SMTC_DTC_PERIOD_MS )
+        {
+            sum += uplink_toa[i];
+        }
+    }
+    return sum;
+}
+
+static int replay( const replay_profile_t* profile )
+{
+    smtc_dtc_t dtc;
+    uint32_t   next_ms    = 0;
+    uint32_t   frame_ms   = 0;
+    uint8_t    frame      = 0;
+    double     worst      = 1.0;
+    double     ratio_sum  = 0.0;
+    uint32_t   samples    = 0;
+    uint32_t   next_check = REPLAY_STEP_MS;
+
+    smtc_duty_cycle_init( &dtc );
+    smtc_duty_cycle_config( &dtc, 1, 0, 100, 868000000, 868600000 );
+    smtc_duty_cycle_enable_set( &dtc, SMTC_DTC_ENABLED );
+    uplink_count = 0;
+
+    for( now_ms = 0; now_ms < REPLAY_HOURS * SMTC_DTC_PERIOD_MS; now_ms += 100 )
+    {
+        if( now_ms == next_ms )
+        {
+            frame    = 0;
+            frame_ms = now_ms;
+            next_ms  = now_ms + ( ( ( profile->pair_period_ms != 0 ) && ( now_ms < profile->pair_phase_ms ) )
+                                     ? profile->pair_period_ms
+                                     : profile->period_ms );
+        }
+
+        // Frames of a period 3 s apart, as the DR burst jitter spaces them
+        if( ( frame < profile->frames ) && ( now_ms == frame_ms ) )
+        {
+            smtc_duty_cycle_sum( &dtc, REPLAY_FREQ_HZ, profile->toa_ms[frame] );
+            uplink_ts[uplink_count]    = now_ms;
+            uplink_toa[uplink_count++] = profile->toa_ms[frame];
+            frame++;
+            frame_ms += 3000;
+        }
+
+        if( now_ms == next_check )
+        {
+            uint32_t exact;
+            uint32_t tracked;
+
+            smtc_duty_cycle_update( &dtc );
+            exact   = exact_sum_ms( );
+            tracked = dtc.bands[0].toa_sum_ms;
+            if( tracked < exact )
+            {
+                fprintf( stderr, "%s: %u ms counted at %u s, %u ms sent in the last hour\n", profile->name,
+                         tracked, now_ms / 1000, exact );
+                return 1;
+            }
+            if( exact > 0 )
+            {
+                double ratio = ( double ) tracked / exact;
+
+                ratio_sum += ratio;
+                samples++;
+                if( ratio > worst )
+                {
+                    worst = ratio;
+                }
+            }
+            next_check += REPLAY_STEP_MS;
+        }
+    }
+
+    printf( "%-8s %5u uplinks: counted / exact TOA mean %.3f, worst %.3f\n", profile->name, uplink_count,
+            ratio_sum / samples, worst );
+    return 0;
+}
+
+int main( void )
+{
+    int failures = 0;
+
+    for( size_t i = 0; i < sizeof( profiles ) / sizeof( profiles[0] ); i++ )
+    {
+        failures += replay( &profiles[i] );
+    }
+    printf( failures ? "FAIL\n" : "PASS\n" );
+    return failures ? 1 : 0;
+}
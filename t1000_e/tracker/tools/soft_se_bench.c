@@ -0,0 +1,421 @@
+/*
+ * Host test and benchmark of the soft secure element.
+ *
+ * Checks AES (FIPS-197 C.1 to C.3), AES-CMAC (RFC 4493) and a LoRaWAN 1.0.x
+ * uplink (FRMPayload encryption + MIC) and a modem service stream against
+ * vectors computed independently with OpenSSL, including key changes and
+ * key schedule cache evictions. Then measures the AES core alone, and one
+ * 51-byte uplink encrypt + MIC through smtc_modem_crypto against the
+ * previous per-call path, which expanded the key schedule for every 16-byte
+ * block and for the CMAC and derived the CMAC subkeys for every MIC.
+ *
+ * Build once per AES core (AES_ENC_TTABLES in aes.h) to pick the size/speed
+ * trade-off; the table sizes printed are the ROM the core needs:
+ *
+ *   C=../../../lora_basics_modem/smtc_modem_core/smtc_modem_crypto
+ *   for t in 0 1 4; do
+ *       gcc -O2 -DAES_ENC_TTABLES=$t -I$C/soft_secure_element -I$C/smtc_secure_element -I$C \
+ *           -I$C/../modem_config -I../../../lora_basics_modem/smtc_modem_hal soft_se_bench.c \
+ *           $C/soft_secure_element/soft_se.c $C/soft_secure_element/aes.c $C/soft_secure_element/cmac.c \
+ *           $C/smtc_modem_crypto.c -o soft_se_bench && ./soft_se_bench [seconds per measure]
+ *   done
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "aes.h"
+#include "cmac.h"
+#include "smtc_secure_element.h"
+#include "smtc_modem_crypto.h"
+#include "smtc_modem_hal.h"
+
+#define PAYLOAD_SIZE 51
+#define DEV_ADDR 0x260B1234
+#define FCNT 42
+#define FPORT 2
+
+static const uint8_t app_s_key[16]   = { 0xa1, 0xb2, 0xc3, 0xd4, 0xe5, 0xf6, 0x07, 0x18,
+                                         0x29, 0x3a, 0x4b, 0x5c, 0x6d, 0x7e, 0x8f, 0x90 };
+static const uint8_t app_s_key_2[16] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                         0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+static const uint8_t nwk_s_key[16]   = { 0x0f, 0x1e, 0x2d, 0x3c, 0x4b, 0x5a, 0x69, 0x78,
+                                         0x87, 0x96, 0xa5, 0xb4, 0xc3, 0xd2, 0xe1, 0xf0 };
+
+// FRMPayload 00 01 .. 32 under app_s_key, then under app_s_key_2
+static const char* frm_vector =
+    "5197a00003d4ebe5033a820da1172f94dcdb65addbd8f8385f3e4ac47f16e1c2947dbf6136a89e5b05ed9e990050c0196ea84a";
+static const char* frm_vector_2 =
+    "3f2c74b71e85357041065b9247f31927c6b154098c02750239aff582927459f86dddfd0c280153cfb82ab5dfb172c53c36d313";
+// MIC of MHDR 40 | DevAddr | FCtrl 00 | FCnt | FPort | FRMPayload under nwk_s_key
+static const uint32_t mic_vector = 0x1fd2a81d;
+// Service stream: 40 bytes (i * 7), nonce 01 00 00 00 00 40 00 00 00 00 07 00 00 00
+static const char* svc_vector =
+    "c0d3132f101008333bb7b629c770d2d91fab88c8a5a9da82960deb437d621569b4c22ede08e36353";
+
+static int failures;
+
+/*
+ * Modem HAL used by the soft secure element
+ */
+
+static uint8_t context_store[512];
+
+void smtc_modem_hal_context_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+    (void) ctx_type;
+    memcpy( context_store, buffer, size < sizeof( context_store ) ? size : sizeof( context_store ) );
+}
+
+void smtc_modem_hal_context_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size )
+{
+    (void) ctx_type;
+    memcpy( buffer, context_store, size < sizeof( context_store ) ? size : sizeof( context_store ) );
+}
+
+static void unhex( const char* hex, uint8_t* out, size_t len )
+{
+    for( size_t i = 0; i < len; i++ )
+    {
+        sscanf( hex + 2 * i, "%2hhx", &out[i] );
+    }
+}
+
+static void check( const char* name, const uint8_t* got, const uint8_t* expected, size_t len )
+{
+    if( memcmp( got, expected, len ) != 0 )
+    {
+        printf( "FAIL %s\n", name );
+        failures++;
+    }
+    else
+    {
+        printf( "ok   %s\n", name );
+    }
+}
+
+static void check_u32( const char* name, uint32_t got, uint32_t expected )
+{
+    check( name, ( const uint8_t* ) &got, ( const uint8_t* ) &expected, sizeof( got ) );
+}
+
+static uint16_t build_uplink( uint8_t* frame, const uint8_t* payload )
+{
+    frame[0] = 0x40;
+    frame[1] = DEV_ADDR & 0xFF;
+    frame[2] = ( DEV_ADDR >> 8 ) & 0xFF;
+    frame[3] = ( DEV_ADDR >> 16 ) & 0xFF;
+    frame[4] = ( DEV_ADDR >> 24 ) & 0xFF;
+    frame[5] = 0x00;
+    frame[6] = FCNT & 0xFF;
+    frame[7] = ( FCNT >> 8 ) & 0xFF;
+    frame[8] = FPORT;
+    memcpy( &frame[9], payload, PAYLOAD_SIZE );
+    return 9 + PAYLOAD_SIZE;
+}
+
+/*
+ * Uplink through smtc_modem_crypto, as the LoRaWAN MAC does it
+ */
+static uint32_t uplink_current( uint8_t* frame, const uint8_t* payload )
+{
+    uint16_t size = build_uplink( frame, payload );
+    uint32_t mic;
+
+    smtc_modem_crypto_payload_encrypt( payload, PAYLOAD_SIZE, SMTC_SE_APP_S_KEY, DEV_ADDR, 0, FCNT, &frame[9] );
+    smtc_modem_crypto_compute_and_add_mic( frame, size, SMTC_SE_NWK_S_ENC_KEY, DEV_ADDR, 0, FCNT );
+    memcpy( &mic, &frame[size], sizeof( mic ) );
+    return mic;
+}
+
+/*
+ * Same uplink with the previous soft_se.c path: memset + aes_set_key for
+ * every 16-byte block, and AES_CMAC_SetKey for the MIC
+ */
+static void previous_aes_encrypt( const uint8_t* key, const uint8_t* in, uint8_t* out )
+{
+    aes_context aes_ctx;
+
+    memset( &aes_ctx, 0, sizeof( aes_context ) );
+    aes_set_key( key, 16, &aes_ctx );
+    aes_encrypt( in, out, &aes_ctx );
+}
+
+static uint32_t uplink_previous( uint8_t* frame, const uint8_t* payload )
+{
+    uint16_t     size      = build_uplink( frame, payload );
+    uint8_t      a_block[16] = { 0x01, 0, 0, 0, 0, 0 };
+    uint8_t      s_block[16];
+    uint8_t      b0[16] = { 0x49, 0, 0, 0, 0, 0 };
+    uint8_t      digest[16];
+    AES_CMAC_CTX cmac_ctx[1];
+    uint32_t     mic;
+
+    memcpy( &a_block[6], &frame[1], 4 );
+    a_block[10] = FCNT & 0xFF;
+    a_block[11] = ( FCNT >> 8 ) & 0xFF;
+    for( uint16_t index = 0, ctr = 1; index < PAYLOAD_SIZE; index += 16, ctr++ )
+    {
+        a_block[15] = ctr;
+        previous_aes_encrypt( app_s_key, a_block, s_block );
+        for( uint16_t i = 0; i < 16 && index + i < PAYLOAD_SIZE; i++ )
+        {
+            frame[9 + index + i] = payload[index + i] ^ s_block[i];
+        }
+    }
+
+    memcpy( &b0[6], &frame[1], 4 );
+    b0[10] = FCNT & 0xFF;
+    b0[11] = ( FCNT >> 8 ) & 0xFF;
+    b0[15] = size;
+    AES_CMAC_Init( cmac_ctx );
+    AES_CMAC_SetKey( cmac_ctx, nwk_s_key );
+    AES_CMAC_Update( cmac_ctx, b0, 16 );
+    AES_CMAC_Update( cmac_ctx, frame, size );
+    AES_CMAC_Final( digest, cmac_ctx );
+    memcpy( &mic, digest, sizeof( mic ) );
+    memcpy( &frame[size], &mic, sizeof( mic ) );
+    return mic;
+}
+
+static void run_aes_vectors( void )
+{
+    static const char* fips_out[] = { "69c4e0d86a7b0430d8cdb78070b4c55a", "dda97ca4864cdfe06eaf70a0ec0d7191",
+                                      "8ea2b7ca516745bfeafc49904b496089" };
+    AES_CMAC_SUBKEYS   subkeys;
+    aes_context        aes_ctx;
+    uint8_t            key[32];
+    uint8_t            in[16];
+    uint8_t            out[16];
+    uint8_t            expected[32];
+
+    // FIPS-197 C.1 to C.3, the ladder keys also exercise 12 and 14 rounds
+    for( uint8_t i = 0; i < sizeof( key ); i++ )
+    {
+        key[i] = i;
+    }
+    for( uint8_t i = 0; i < sizeof( in ); i++ )
+    {
+        in[i] = i * 0x11;
+    }
+    for( uint8_t i = 0; i < 3; i++ )
+    {
+        char name[40];
+
+        snprintf( name, sizeof( name ), "AES-%u FIPS-197 C.%u", 128 + 64 * i, i + 1 );
+        memset( &aes_ctx, 0, sizeof( aes_ctx ) );
+        aes_set_key( key, 16 + 8 * i, &aes_ctx );
+        aes_encrypt( in, out, &aes_ctx );
+        unhex( fips_out[i], expected, 16 );
+        check( name, out, expected, 16 );
+    }
+
+    // RFC 4493 2.3 subkeys
+    unhex( "2b7e151628aed2a6abf7158809cf4f3c", key, 16 );
+    aes_set_key( key, 16, &aes_ctx );
+    AES_CMAC_Subkeys( &aes_ctx, &subkeys );
+    unhex( "fbeed618357133667c85e08f7236a8def7ddac306ae266ccf90bc11ee46d513b", expected, 32 );
+    check( "AES-CMAC RFC 4493 subkeys K1, K2", ( const uint8_t* ) &subkeys, expected, 32 );
+}
+
+static void run_vectors( const uint8_t* payload )
+{
+    static const uint8_t fips_key[16] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                          0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    static const uint8_t fips_in[16]  = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                          0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff };
+    static const uint8_t rfc_key[16]  = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                          0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+    static const struct
+    {
+        uint16_t len;
+        uint32_t cmac;  // first 4 bytes, little endian as returned by the secure element
+    } rfc_cmac[] = { { 0, 0x29691dbb }, { 16, 0xb4160a07 }, { 40, 0x4767a6df }, { 64, 0xbfbef051 } };
+    uint8_t rfc_msg[64];
+    uint8_t expected[64];
+    uint8_t out[64];
+    uint8_t frame[80];
+    uint8_t nonce[14] = { 0x01, 0, 0, 0, 0, 0x40, 0, 0, 0, 0, 0x07, 0, 0, 0 };
+    uint8_t svc[40];
+
+    unhex( "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+           "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+           rfc_msg, sizeof( rfc_msg ) );
+
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, fips_key );
+    smtc_secure_element_aes_encrypt( fips_in, 16, SMTC_SE_APP_S_KEY, out );
+    unhex( "69c4e0d86a7b0430d8cdb78070b4c55a", expected, 16 );
+    check( "AES-128 FIPS-197 C.1", out, expected, 16 );
+
+    smtc_secure_element_set_key( SMTC_SE_NWK_S_ENC_KEY, rfc_key );
+    for( size_t i = 0; i < sizeof( rfc_cmac ) / sizeof( rfc_cmac[0] ); i++ )
+    {
+        char     name[40];
+        uint32_t cmac = 0;
+
+        snprintf( name, sizeof( name ), "AES-CMAC RFC 4493 %u bytes", rfc_cmac[i].len );
+        smtc_secure_element_compute_aes_cmac( NULL, rfc_msg, rfc_cmac[i].len, SMTC_SE_NWK_S_ENC_KEY, &cmac );
+        check_u32( name, cmac, rfc_cmac[i].cmac );
+    }
+
+    // The cached schedules must follow key changes
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, app_s_key );
+    smtc_secure_element_set_key( SMTC_SE_NWK_S_ENC_KEY, nwk_s_key );
+    check_u32( "LoRaWAN uplink MIC", uplink_current( frame, payload ), mic_vector );
+    unhex( frm_vector, expected, PAYLOAD_SIZE );
+    check( "LoRaWAN uplink FRMPayload", &frame[9], expected, PAYLOAD_SIZE );
+    check_u32( "LoRaWAN uplink MIC, previous path", uplink_previous( frame, payload ), mic_vector );
+    check( "LoRaWAN uplink FRMPayload, previous path", &frame[9], expected, PAYLOAD_SIZE );
+
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, app_s_key_2 );
+    smtc_modem_crypto_payload_encrypt( payload, PAYLOAD_SIZE, SMTC_SE_APP_S_KEY, DEV_ADDR, 0, FCNT, out );
+    unhex( frm_vector_2, expected, PAYLOAD_SIZE );
+    check( "FRMPayload after AppSKey change", out, expected, PAYLOAD_SIZE );
+
+    // More keys than cache entries, then back to AppSKey
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, app_s_key );
+    for( smtc_se_key_identifier_t key_id = SMTC_SE_APP_KEY; key_id <= SMTC_SE_MC_ROOT_KEY; key_id++ )
+    {
+        smtc_secure_element_aes_encrypt( fips_in, 16, key_id, out );
+    }
+    for( uint8_t i = 0; i < sizeof( svc ); i++ )
+    {
+        svc[i] = i * 7;
+    }
+    smtc_modem_crypto_service_encrypt( svc, sizeof( svc ), nonce, out );
+    unhex( svc_vector, expected, sizeof( svc ) );
+    check( "Service stream after cache eviction", out, expected, sizeof( svc ) );
+
+    // In place, as ROSE_cipher does it
+    smtc_modem_crypto_service_encrypt( svc, sizeof( svc ), nonce, svc );
+    check( "Service stream in place", svc, expected, sizeof( svc ) );
+
+    // Context restore may bring other keys
+    smtc_secure_element_store_context( );
+    smtc_secure_element_set_key( SMTC_SE_NWK_S_ENC_KEY, rfc_key );
+    smtc_secure_element_restore_context( );
+    check_u32( "LoRaWAN uplink MIC after context restore", uplink_current( frame, payload ), mic_vector );
+}
+
+static uint64_t now_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ( uint64_t ) ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+static double now_s( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static volatile uint32_t sink;
+
+static double bench_blocks( double seconds )
+{
+    static const uint8_t key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                     0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+    aes_context aes_ctx;
+    uint8_t     block[16] = { 0 };
+    uint64_t    blocks    = 0;
+    uint64_t    ticks;
+    double      start;
+    double      elapsed;
+
+    aes_set_key( key, 16, &aes_ctx );
+    ticks = now_ticks( );
+    start = now_s( );
+    do
+    {
+        for( int i = 0; i < 1000; i++ )
+        {
+            aes_encrypt( block, block, &aes_ctx );
+        }
+        blocks += 1000;
+        elapsed = now_s( ) - start;
+    } while( elapsed < seconds );
+    sink = block[0];
+
+    double per_block = ( double ) ( now_ticks( ) - ticks ) / blocks;
+#if defined( __x86_64__ ) || defined( __i386__ )
+    printf( "%-40s %10.0f cycles per block, %.2f M blocks/s\n", "AES-128 encrypt", per_block, blocks / elapsed * 1e-6 );
+#else
+    printf( "%-40s %10.0f ns per block, %.2f M blocks/s\n", "AES-128 encrypt", per_block, blocks / elapsed * 1e-6 );
+#endif
+    return per_block;
+}
+
+static double bench( const char* name, uint32_t ( *uplink )( uint8_t*, const uint8_t* ), const uint8_t* payload,
+                     double seconds )
+{
+    uint8_t  frame[80];
+    uint64_t uplinks = 0;
+    uint64_t ticks   = now_ticks( );
+    double   start   = now_s( );
+
+    do
+    {
+        for( int i = 0; i < 1000; i++ )
+        {
+            sink = uplink( frame, payload );
+        }
+        uplinks += 1000;
+    } while( now_s( ) - start < seconds );
+
+    double per_uplink = ( double ) ( now_ticks( ) - ticks ) / uplinks;
+#if defined( __x86_64__ ) || defined( __i386__ )
+    printf( "%-40s %10.0f cycles per uplink encrypt + MIC\n", name, per_uplink );
+#else
+    printf( "%-40s %10.0f ns per uplink encrypt + MIC\n", name, per_uplink );
+#endif
+    return per_uplink;
+}
+
+int main( int argc, char* argv[] )
+{
+    double  seconds = argc > 1 ? atof( argv[1] ) : 1.0;
+    uint8_t payload[PAYLOAD_SIZE];
+
+    for( uint8_t i = 0; i < PAYLOAD_SIZE; i++ )
+    {
+        payload[i] = i;
+    }
+
+    smtc_secure_element_init( );
+    run_aes_vectors( );
+    run_vectors( payload );
+    if( failures )
+    {
+        printf( "%d vector(s) failed\n", failures );
+        return 1;
+    }
+
+    // Only aes.c tables count towards ROM: S box plus the round tables
+    printf( "\nAES core AES_ENC_TTABLES=%d: %s\n", AES_ENC_TTABLES,
+            AES_ENC_TTABLES == 0 ? "8-bit rounds" : "32-bit column rounds" );
+    printf( "%-40s %10u bytes\n", "ROM, encryption tables",
+            256 + ( AES_ENC_TTABLES == 0 ? 2 * 256 : AES_ENC_TTABLES * 1024 ) );
+    printf( "%-40s %10u bytes\n", "RAM, key schedule per cached key",
+            ( unsigned ) ( sizeof( aes_context ) + sizeof( AES_CMAC_SUBKEYS ) ) );
+    printf( "%-40s %10u bytes\n", "stack, CMAC context", ( unsigned ) sizeof( AES_CMAC_CTX ) );
+    bench_blocks( seconds );
+
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, app_s_key );
+    smtc_secure_element_set_key( SMTC_SE_NWK_S_ENC_KEY, nwk_s_key );
+    printf( "\n%u-byte FRMPayload, 4 CTR blocks + 5-block CMAC\n", PAYLOAD_SIZE );
+    double before = bench( "previous (key schedule per call)", uplink_previous, payload, seconds );
+    double after  = bench( "cached keys and CMAC subkeys", uplink_current, payload, seconds );
+    printf( "%-40s %10.2fx\n", "speedup", before / after );
+    return 0;
+}
@@ -0,0 +1,626 @@
+/*!
+ * @file      spi_transfer_bench.c
+ *
+ * @brief     Host check of the scatter/gather SPIM transfers against a mock SPIM
+ *
+ * smtc_hal_spi.c is built against the nrfx_spim.h stand-in in sim/, and
+ * nrfx_spim_xfer( ) below records every byte clocked out and clocks in a
+ * pseudo-random MISO stream indexed by the byte position on the bus.
+ *
+ * Random layouts first: up to 8 segments and 0 to 700 bytes per transaction,
+ * each segment with or without tx and rx data, so most transactions span
+ * several staging buffers. For each one the bytes on the wire, the bytes
+ * scattered back (and the guard bytes around them), the number and size of
+ * the EasyDMA transfers and the SPI counters are checked against a reference
+ * model. Every transfer must also come from the staging buffer, never from
+ * the caller's buffers, which may be in flash.
+ *
+ * Then the LR11xx HAL transactions: write, read and direct read, with and
+ * without the CRC byte, are sent both with the segment tables of lr11xx_hal.c
+ * and with the per-byte hal_spi_in_out( ) loops they replaced (both copied
+ * below, lr11xx_hal.c itself needs the nRF timer and DWT registers). Both
+ * must put the same bytes on the wire within the same NSS frames and read
+ * back the same data; the transfers each one needs are printed.
+ *
+ *   gcc -O2 -Isim -I../../../smtc_hal/inc \
+ *       -I../../../lora_basics_modem/smtc_modem_core/radio_drivers/lr11xx_driver/src \
+ *       spi_transfer_bench.c ../../../smtc_hal/src/smtc_hal_spi.c -o spi_transfer_bench
+ *   ./spi_transfer_bench [-n layouts] [-s seed] [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include "nrfx_spim.h"
+#include "smtc_hal_spi.h"
+#include "lr11xx_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define BENCH_DMA_BUF_SIZE          264         // HAL_SPI_DMA_BUF_SIZE in smtc_hal_spi.c
+#define BENCH_MAX_LENGTH            700         // Largest random transaction
+#define BENCH_MAX_SEGMENTS          8
+#define BENCH_DEFAULT_LAYOUTS       20000
+#define BENCH_GUARD                 8           // Guard bytes around each rx segment
+#define BENCH_GUARD_BYTE            0xA5
+#define BENCH_WIRE_SIZE             1024
+#define BENCH_MAX_FRAMES            4           // NSS frames per LR11xx transaction
+#define BENCH_MAX_XFERS             16
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    BENCH_LR11XX_WRITE,
+    BENCH_LR11XX_READ,
+    BENCH_LR11XX_DIRECT_READ,
+} bench_lr11xx_op_t;
+
+typedef struct
+{
+    uint8_t  wire[BENCH_WIRE_SIZE];     // Bytes clocked out since the last bench_bus_reset( )
+    uint16_t wire_len;
+    uint16_t frames[BENCH_MAX_FRAMES];  // Bytes clocked in each NSS frame
+    uint8_t  frame_count;
+    bool     nss_low;
+    uint16_t xfers[BENCH_MAX_XFERS];    // Length of each transfer
+    uint32_t xfer_count;
+} bench_bus_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint32_t bench_rng = 0x5EED5EEDU;
+static uint32_t bench_layouts = BENCH_DEFAULT_LAYOUTS;
+static bool bench_verbose = false;
+
+static bench_bus_t bench_bus;
+static uint32_t bench_clock = 0;        // Bytes clocked since start, indexes the MISO stream
+
+// Caller buffers of the transaction in progress, no transfer may come from them
+static const hal_spi_segment_t* bench_segments = NULL;
+static uint8_t bench_segment_count = 0;
+
+static uint8_t bench_tx_pool[BENCH_MAX_LENGTH];
+static uint8_t bench_rx_pool[BENCH_MAX_LENGTH + ( BENCH_MAX_SEGMENTS + 1 ) * BENCH_GUARD];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void bench_fail( const char* fmt, ... )
+{
+    va_list args;
+
+    va_start( args, fmt );
+    printf( "FAIL: " );
+    vprintf( fmt, args );
+    printf( "\n" );
+    va_end( args );
+    exit( 1 );
+}
+
+static uint32_t bench_rand( void )
+{
+    bench_rng ^= bench_rng << 13;
+    bench_rng ^= bench_rng >> 17;
+    bench_rng ^= bench_rng << 5;
+    return bench_rng;
+}
+
+static uint8_t bench_miso( uint32_t clock )
+{
+    return ( uint8_t )(( clock * 2654435761U ) >> 24 );
+}
+
+static void bench_bus_reset( void )
+{
+    memset( &bench_bus, 0, sizeof( bench_bus ));
+    hal_spi_reset_stats( );
+}
+
+static void bench_nss( uint8_t level )
+{
+    if(( level == 0 ) && !bench_bus.nss_low )
+    {
+        if( bench_bus.frame_count == BENCH_MAX_FRAMES )
+        {
+            bench_fail( "too many NSS frames" );
+        }
+        bench_bus.frames[bench_bus.frame_count++] = 0;
+    }
+    bench_bus.nss_low = ( level == 0 );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- LR11XX TRANSACTIONS -----------------------------------------------------
+ */
+
+// Segment tables as lr11xx_hal.c builds them, bench_nss( ) in place of the NSS pin
+
+static void lr11xx_write( bool crc, const uint8_t* command, uint16_t command_length,
+                          const uint8_t* data, uint16_t data_length )
+{
+    uint8_t cmd_crc = 0x5C;
+    const hal_spi_segment_t segments[] = {
+        { .tx = command, .rx = NULL, .length = command_length },
+        { .tx = data, .rx = NULL, .length = data_length },
+        { .tx = &cmd_crc, .rx = NULL, .length = 1 },
+    };
+
+    bench_nss( 0 );
+    hal_spi_transfer( segments, crc ? 3 : 2, LR11XX_NOP );
+    bench_nss( 1 );
+}
+
+static void lr11xx_read( bool crc, const uint8_t* command, uint16_t command_length,
+                         uint8_t* data, uint16_t data_length, uint8_t* rx_crc )
+{
+    uint8_t cmd_crc = 0x5C;
+    uint8_t dummy = 0;
+    const hal_spi_segment_t cmd_segments[] = {
+        { .tx = command, .rx = NULL, .length = command_length },
+        { .tx = &cmd_crc, .rx = NULL, .length = 1 },
+    };
+    const hal_spi_segment_t data_segments[] = {
+        { .tx = NULL, .rx = &dummy, .length = 1 },
+        { .tx = NULL, .rx = data, .length = data_length },
+        { .tx = NULL, .rx = rx_crc, .length = 1 },
+    };
+
+    bench_nss( 0 );
+    hal_spi_transfer( cmd_segments, crc ? 2 : 1, LR11XX_NOP );
+    bench_nss( 1 );
+
+    if( data_length > 0 )
+    {
+        bench_nss( 0 );
+        hal_spi_transfer( data_segments, crc ? 3 : 2, LR11XX_NOP );
+        bench_nss( 1 );
+    }
+}
+
+static void lr11xx_direct_read( bool crc, uint8_t* data, uint16_t data_length, uint8_t* rx_crc )
+{
+    const hal_spi_segment_t segments[] = {
+        { .tx = NULL, .rx = data, .length = data_length },
+        { .tx = NULL, .rx = rx_crc, .length = 1 },
+    };
+
+    bench_nss( 0 );
+    hal_spi_transfer( segments, crc ? 2 : 1, LR11XX_NOP );
+    bench_nss( 1 );
+}
+
+// The per-byte loops lr11xx_hal.c used before hal_spi_transfer( )
+
+static void legacy_write( bool crc, const uint8_t* command, uint16_t command_length,
+                          const uint8_t* data, uint16_t data_length )
+{
+    bench_nss( 0 );
+    for( uint16_t i = 0; i < command_length; i++ )
+    {
+        hal_spi_in_out( 0, command[i] );
+    }
+    for( uint16_t i = 0; i < data_length; i++ )
+    {
+        hal_spi_in_out( 0, data[i] );
+    }
+    if( crc )
+    {
+        hal_spi_in_out( 0, 0x5C );
+    }
+    bench_nss( 1 );
+}
+
+static void legacy_read( bool crc, const uint8_t* command, uint16_t command_length,
+                         uint8_t* data, uint16_t data_length, uint8_t* rx_crc )
+{
+    bench_nss( 0 );
+    for( uint16_t i = 0; i < command_length; i++ )
+    {
+        hal_spi_in_out( 0, command[i] );
+    }
+    if( crc )
+    {
+        hal_spi_in_out( 0, 0x5C );
+    }
+    bench_nss( 1 );
+
+    if( data_length > 0 )
+    {
+        bench_nss( 0 );
+        hal_spi_in_out( 0, LR11XX_NOP );
+        for( uint16_t i = 0; i < data_length; i++ )
+        {
+            data[i] = hal_spi_in_out( 0, LR11XX_NOP );
+        }
+        if( crc )
+        {
+            *rx_crc = hal_spi_in_out( 0, LR11XX_NOP );
+        }
+        bench_nss( 1 );
+    }
+}
+
+static void legacy_direct_read( bool crc, uint8_t* data, uint16_t data_length, uint8_t* rx_crc )
+{
+    bench_nss( 0 );
+    for( uint16_t i = 0; i < data_length; i++ )
+    {
+        data[i] = hal_spi_in_out( 0, LR11XX_NOP );
+    }
+    if( crc )
+    {
+        *rx_crc = hal_spi_in_out( 0, LR11XX_NOP );
+    }
+    bench_nss( 1 );
+}
+
+static void bench_lr11xx_run( bool legacy, bench_lr11xx_op_t op, bool crc, const uint8_t* command,
+                              uint16_t command_length, uint8_t* data, uint16_t data_length, uint8_t* rx_crc )
+{
+    switch( op )
+    {
+    case BENCH_LR11XX_WRITE:
+        if( legacy )
+        {
+            legacy_write( crc, command, command_length, data, data_length );
+        }
+        else
+        {
+            lr11xx_write( crc, command, command_length, data, data_length );
+        }
+        break;
+    case BENCH_LR11XX_READ:
+        if( legacy )
+        {
+            legacy_read( crc, command, command_length, data, data_length, rx_crc );
+        }
+        else
+        {
+            lr11xx_read( crc, command, command_length, data, data_length, rx_crc );
+        }
+        break;
+    case BENCH_LR11XX_DIRECT_READ:
+        if( legacy )
+        {
+            legacy_direct_read( crc, data, data_length, rx_crc );
+        }
+        else
+        {
+            lr11xx_direct_read( crc, data, data_length, rx_crc );
+        }
+        break;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- CHECKS ------------------------------------------------------------------
+ */
+
+static void bench_check_stats( uint32_t transfers, uint32_t bytes )
+{
+    hal_spi_stats_t stats;
+    uint16_t max_transfer = 0;
+
+    for( uint32_t i = 0; i < bench_bus.xfer_count && i < BENCH_MAX_XFERS; i++ )
+    {
+        if( bench_bus.xfers[i] > max_transfer )
+        {
+            max_transfer = bench_bus.xfers[i];
+        }
+    }
+
+    hal_spi_get_stats( &stats );
+    if(( stats.transfers != transfers ) || ( stats.bytes != bytes ) ||
+       (( transfers <= BENCH_MAX_XFERS ) && ( stats.max_transfer != max_transfer )))
+    {
+        bench_fail( "stats %u transfers %u bytes max %u, expected %u / %u / %u", stats.transfers, stats.bytes,
+                    stats.max_transfer, transfers, bytes, max_transfer );
+    }
+}
+
+static void bench_layout( uint32_t layout, uint32_t* transfers, uint32_t* bytes, uint32_t* multi_chunk )
+{
+    hal_spi_segment_t segments[BENCH_MAX_SEGMENTS];
+    uint8_t expected_wire[BENCH_MAX_LENGTH];
+    uint8_t segment_count = bench_rand( ) % ( BENCH_MAX_SEGMENTS + 1 );
+    uint8_t fill_byte = bench_rand( );
+    uint16_t remaining = ( segment_count > 0 ) ? bench_rand( ) % ( BENCH_MAX_LENGTH + 1 ) : 0;
+    uint16_t total = 0, rx_pos = BENCH_GUARD;
+    uint32_t clock_start = bench_clock;
+
+    for( uint16_t i = 0; i < sizeof( bench_tx_pool ); i++ )
+    {
+        bench_tx_pool[i] = bench_rand( );
+    }
+    memset( bench_rx_pool, BENCH_GUARD_BYTE, sizeof( bench_rx_pool ));
+
+    for( uint8_t i = 0; i < segment_count; i++ )
+    {
+        uint16_t length = ( i == segment_count - 1 ) ? remaining : bench_rand( ) % ( remaining + 1 );
+
+        segments[i].length = length;
+        segments[i].tx = ( bench_rand( ) & 1 ) ? &bench_tx_pool[total] : NULL;
+        segments[i].rx = ( bench_rand( ) & 1 ) ? &bench_rx_pool[rx_pos] : NULL;
+        for( uint16_t j = 0; j < length; j++ )
+        {
+            expected_wire[total + j] = ( segments[i].tx != NULL ) ? segments[i].tx[j] : fill_byte;
+        }
+        total += length;
+        remaining -= length;
+        if( segments[i].rx != NULL )
+        {
+            rx_pos += length + BENCH_GUARD;
+        }
+    }
+
+    bench_bus_reset( );
+    bench_segments = segments;
+    bench_segment_count = segment_count;
+    hal_spi_transfer( segments, segment_count, fill_byte );
+    bench_segments = NULL;
+
+    if(( bench_bus.wire_len != total ) || ( memcmp( bench_bus.wire, expected_wire, total ) != 0 ))
+    {
+        bench_fail( "layout %u: %u bytes on the wire, expected %u, or wrong data", layout, bench_bus.wire_len,
+                    total );
+    }
+
+    // Scattered bytes, the guards around them and the rest of the pool untouched
+    rx_pos = BENCH_GUARD;
+    total = 0;
+    for( uint8_t i = 0; i < segment_count; i++ )
+    {
+        if( segments[i].rx != NULL )
+        {
+            for( uint16_t j = 0; j < segments[i].length; j++ )
+            {
+                if( segments[i].rx[j] != bench_miso( clock_start + total + j ))
+                {
+                    bench_fail( "layout %u: segment %u byte %u not scattered back", layout, i, j );
+                }
+                bench_rx_pool[rx_pos + j] = BENCH_GUARD_BYTE;
+            }
+            rx_pos += segments[i].length + BENCH_GUARD;
+        }
+        total += segments[i].length;
+    }
+    for( uint16_t i = 0; i < sizeof( bench_rx_pool ); i++ )
+    {
+        if( bench_rx_pool[i] != BENCH_GUARD_BYTE )
+        {
+            bench_fail( "layout %u: rx pool byte %u overwritten", layout, i );
+        }
+    }
+
+    // Full staging buffers, then the remainder
+    if( bench_bus.xfer_count != ( uint32_t )( total + BENCH_DMA_BUF_SIZE - 1 ) / BENCH_DMA_BUF_SIZE )
+    {
+        bench_fail( "layout %u: %u transfers for %u bytes", layout, bench_bus.xfer_count, total );
+    }
+    for( uint32_t i = 0; i < bench_bus.xfer_count; i++ )
+    {
+        uint16_t expected = ( total - i * BENCH_DMA_BUF_SIZE > BENCH_DMA_BUF_SIZE ) ?
+                                BENCH_DMA_BUF_SIZE : total - i * BENCH_DMA_BUF_SIZE;
+
+        if( bench_bus.xfers[i] != expected )
+        {
+            bench_fail( "layout %u: transfer %u is %u bytes, expected %u", layout, i, bench_bus.xfers[i], expected );
+        }
+    }
+    bench_check_stats( bench_bus.xfer_count, total );
+
+    if( bench_verbose )
+    {
+        printf( "layout %5u: %u segments, %3u bytes, %u transfers\n", layout, segment_count, total,
+                bench_bus.xfer_count );
+    }
+    *transfers += bench_bus.xfer_count;
+    *bytes += total;
+    *multi_chunk += ( bench_bus.xfer_count > 1 ) ? 1 : 0;
+}
+
+static void bench_lr11xx( bench_lr11xx_op_t op, bool crc, uint16_t command_length, uint16_t data_length,
+                          uint32_t* legacy_transfers, uint32_t* transfers )
+{
+    static const char* names[] = { "write", "read", "direct read" };
+    uint8_t command[4], data[2][BENCH_MAX_LENGTH], rx_crc[2] = { 0, 0 };
+    bench_bus_t legacy_bus;
+    uint32_t clock_start = bench_clock;
+
+    for( uint16_t i = 0; i < command_length; i++ )
+    {
+        command[i] = bench_rand( );
+    }
+    for( uint16_t i = 0; i < data_length; i++ )
+    {
+        data[0][i] = data[1][i] = ( op == BENCH_LR11XX_WRITE ) ? bench_rand( ) : 0;
+    }
+
+    bench_bus_reset( );
+    bench_lr11xx_run( true, op, crc, command, command_length, data[0], data_length, &rx_crc[0] );
+    legacy_bus = bench_bus;
+    bench_check_stats( legacy_bus.xfer_count, legacy_bus.wire_len );
+
+    // Same MISO stream for both
+    bench_clock = clock_start;
+    bench_bus_reset( );
+    bench_lr11xx_run( false, op, crc, command, command_length, data[1], data_length, &rx_crc[1] );
+    bench_check_stats( bench_bus.xfer_count, bench_bus.wire_len );
+
+    if(( legacy_bus.wire_len != bench_bus.wire_len ) ||
+       ( memcmp( legacy_bus.wire, bench_bus.wire, bench_bus.wire_len ) != 0 ) ||
+       ( legacy_bus.frame_count != bench_bus.frame_count ) ||
+       ( memcmp( legacy_bus.frames, bench_bus.frames, sizeof( bench_bus.frames )) != 0 ))
+    {
+        bench_fail( "%s%s of %u bytes: not the same bytes or NSS frames as the per-byte path", names[op],
+                    crc ? " with CRC" : "", data_length );
+    }
+    if(( memcmp( data[0], data[1], data_length ) != 0 ) || ( rx_crc[0] != rx_crc[1] ))
+    {
+        bench_fail( "%s%s of %u bytes: not the same data read back as the per-byte path", names[op],
+                    crc ? " with CRC" : "", data_length );
+    }
+
+    if( bench_verbose || ( data_length == 255 ))
+    {
+        printf( "  %-11s %-8s %3u bytes: %3u transfers per-byte, %u scatter/gather\n", names[op],
+                crc ? "with CRC" : "", data_length, legacy_bus.xfer_count, bench_bus.xfer_count );
+    }
+    *legacy_transfers += legacy_bus.xfer_count;
+    *transfers += bench_bus.xfer_count;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MOCK SPIM ---------------------------------------------------------------
+ */
+
+nrfx_err_t nrfx_spim_init( nrfx_spim_t const* p_instance, nrfx_spim_config_t const* p_config,
+                           nrfx_spim_evt_handler_t handler, void* p_context )
+{
+    ( void ) p_instance;
+    ( void ) p_config;
+    ( void ) handler;
+    ( void ) p_context;
+    return 0;
+}
+
+void nrfx_spim_uninit( nrfx_spim_t const* p_instance )
+{
+    ( void ) p_instance;
+}
+
+nrfx_err_t nrfx_spim_xfer( nrfx_spim_t const* p_instance, nrfx_spim_xfer_desc_t const* p_xfer_desc,
+                           uint32_t flags )
+{
+    size_t length = p_xfer_desc->tx_length;
+
+    ( void ) p_instance;
+
+    if(( length == 0 ) || ( length > BENCH_DMA_BUF_SIZE ) || ( p_xfer_desc->rx_length != length ) ||
+       ( p_xfer_desc->p_rx_buffer == NULL ) || ( flags != NRFX_SPIM_FLAG_NO_XFER_EVT_HANDLER ))
+    {
+        bench_fail( "transfer of %zu bytes out, %zu in", length, p_xfer_desc->rx_length );
+    }
+    if( !bench_bus.nss_low && ( bench_segments == NULL ))
+    {
+        bench_fail( "transfer with NSS high" );
+    }
+    if( bench_bus.wire_len + length > BENCH_WIRE_SIZE )
+    {
+        bench_fail( "transaction too long for the bench" );
+    }
+    for( uint8_t i = 0; i < bench_segment_count && bench_segments != NULL; i++ )
+    {
+        const uint8_t* tx = bench_segments[i].tx;
+
+        if(( tx != NULL ) && ( p_xfer_desc->p_tx_buffer < tx + bench_segments[i].length ) &&
+           ( tx < p_xfer_desc->p_tx_buffer + length ))
+        {
+            bench_fail( "transfer straight from the caller's segment %u", i );
+        }
+    }
+
+    memcpy( &bench_bus.wire[bench_bus.wire_len], p_xfer_desc->p_tx_buffer, length );
+    for( size_t i = 0; i < length; i++ )
+    {
+        p_xfer_desc->p_rx_buffer[i] = bench_miso( bench_clock++ );
+    }
+    bench_bus.wire_len += length;
+    if( bench_bus.frame_count > 0 )
+    {
+        bench_bus.frames[bench_bus.frame_count - 1] += length;
+    }
+    if( bench_bus.xfer_count < BENCH_MAX_XFERS )
+    {
+        bench_bus.xfers[bench_bus.xfer_count] = length;
+    }
+    bench_bus.xfer_count++;
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    static const uint16_t lengths[] = { 0, 1, 2, 16, 64, 255 };
+    uint32_t transfers = 0, bytes = 0, multi_chunk = 0, legacy_transfers = 0;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "n:s:v" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            bench_layouts = atol( optarg );
+            break;
+        case 's':
+            bench_rng ^= strtoul( optarg, NULL, 0 );
+            break;
+        case 'v':
+            bench_verbose = true;
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-n layouts] [-s seed] [-v]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    hal_spi_init( );
+
+    for( uint32_t layout = 0; layout < bench_layouts; layout++ )
+    {
+        bench_layout( layout, &transfers, &bytes, &multi_chunk );
+    }
+    printf( "random layouts: %u transactions, %u bytes in %u transfers (%u multi-chunk): match\n", bench_layouts,
+            bytes, transfers, multi_chunk );
+
+    printf( "LR11xx transactions (2-byte command):\n" );
+    transfers = 0;
+    for( int crc = 0; crc < 2; crc++ )
+    {
+        for( int op = BENCH_LR11XX_WRITE; op <= BENCH_LR11XX_DIRECT_READ; op++ )
+        {
+            for( uint8_t i = 0; i < sizeof( lengths ) / sizeof( lengths[0] ); i++ )
+            {
+                bench_lr11xx( op, crc, 2, lengths[i], &legacy_transfers, &transfers );
+            }
+            for( uint8_t i = 0; i < 20; i++ )
+            {
+                bench_lr11xx( op, crc, 2 + bench_rand( ) % 3, bench_rand( ) % 256, &legacy_transfers, &transfers );
+            }
+        }
+    }
+    printf( "LR11xx transactions: same wire bytes, NSS frames and data as the per-byte path, "
+            "%u transfers instead of %u\n", transfers, legacy_transfers );
+
+    printf( "PASS\n" );
+    return 0;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
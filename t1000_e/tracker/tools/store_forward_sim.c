@@ -0,0 +1,550 @@
+/*!
+ * @file      store_forward_sim.c
+ *
+ * @brief     Host power-loss test of the store-and-forward ring on a simulated flash
+ *
+ * hal_flash_* are replaced by a model of the nRF52840 NVMC over the ring
+ * pages: erase sets a page to 0xFF, writes are word by word and can only
+ * clear bits. A workload appends records, some of them safety records, and
+ * drains backlog frames, wrapping the ring many times.
+ *
+ * The workload is first run to count its flash operations, then re-run once
+ * per operation with the power cut at that operation: the word being written
+ * is left half programmed, a page being erased is left half erased. After
+ * each cut the ring is mounted again and fully drained, and the test checks
+ * that every record appended before the cut and not yet sent comes back
+ * exactly once and intact, that nothing sent comes back, and that the ring
+ * keeps working afterwards. A last run without cuts checks wear levelling.
+ *
+ *   gcc -O2 -I../inc -I../../../smtc_hal/inc -I../../../apps/common \
+ *       store_forward_sim.c ../src/crew_store_forward.c -o store_forward_sim
+ *   ./store_forward_sim [-n operations] [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <unistd.h>
+
+#include "crew_store_forward.h"
+#include "smtc_hal_def.h"
+#include "smtc_hal_flash.h"
+#include "crew_payload_schema.h"
+#include "crew_lorawan_ports.h"
+#include "log_filter.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define SIM_FLASH_SIZE          ( ADDR_FLASH_STORE_FORWARD_PAGES * ADDR_FLASH_PAGE_SIZE )
+#define SIM_DEFAULT_OPERATIONS  600
+#define SIM_MAX_RECORDS         4096
+#define SIM_FRAME_MAX           242
+#define SIM_PENDING_HIGH        120     // Drain above this, below the ring capacity
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum {
+    SIM_RECORD_NONE = 0,
+    SIM_RECORD_APPENDING,               // append started, not returned
+    SIM_RECORD_PENDING,
+    SIM_RECORD_SENDING,                 // in a batch whose commit started, not returned
+    SIM_RECORD_SENT,
+} sim_record_state_t;
+
+typedef struct {
+    sim_record_state_t state;
+    uint32_t timestamp_s;
+    uint8_t  port;
+    uint8_t  len;
+    bool     safety;
+    bool     seen;
+} sim_record_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t sim_flash[SIM_FLASH_SIZE];
+static uint32_t sim_erases[ADDR_FLASH_STORE_FORWARD_PAGES];
+static long sim_ops = 0;                // Flash operations so far
+static long sim_cut_at = -1;            // Operation that loses power, -1 none
+static jmp_buf sim_power_loss;
+static bool sim_verbose = false;
+static long sim_operations = SIM_DEFAULT_OPERATIONS;
+
+static sim_record_t sim_records[SIM_MAX_RECORDS];
+static uint32_t sim_record_count = 0;
+static uint32_t sim_batch_ids[CREW_STORE_BATCH_MAX];
+static uint8_t sim_batch_count = 0;
+static uint32_t sim_rng = 1;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+void log_filter_printf( log_filter_category_t category, const char* fmt, ... )
+{
+    va_list args;
+
+    ( void ) category;
+    if( !sim_verbose )
+    {
+        return;
+    }
+    va_start( args, fmt );
+    printf( "    " );
+    vprintf( fmt, args );
+    va_end( args );
+}
+
+static uint32_t sim_random( void )
+{
+    sim_rng ^= sim_rng << 13;
+    sim_rng ^= sim_rng >> 17;
+    sim_rng ^= sim_rng << 5;
+    return sim_rng;
+}
+
+static uint8_t* sim_flash_at( uint32_t addr, uint32_t size )
+{
+    if(( addr < ADDR_FLASH_STORE_FORWARD ) || ( addr + size > ADDR_FLASH_STORE_FORWARD + SIM_FLASH_SIZE ))
+    {
+        fprintf( stderr, "flash access out of the ring: 0x%08x+%u\n", addr, size );
+        exit( 2 );
+    }
+    return sim_flash + ( addr - ADDR_FLASH_STORE_FORWARD );
+}
+
+// Count one operation, true if the power goes at this one
+static bool sim_flash_op( void )
+{
+    return sim_ops++ == sim_cut_at;
+}
+
+smtc_hal_status_t hal_flash_erase_page( uint32_t addr, uint8_t nb_page )
+{
+    for( uint8_t page = 0; page < nb_page; page++ )
+    {
+        uint8_t* p = sim_flash_at( addr + page * ADDR_FLASH_PAGE_SIZE, ADDR_FLASH_PAGE_SIZE );
+
+        if( sim_flash_op( ))
+        {
+            memset( p, 0xFF, ADDR_FLASH_PAGE_SIZE / 2 );
+            longjmp( sim_power_loss, 1 );
+        }
+        memset( p, 0xFF, ADDR_FLASH_PAGE_SIZE );
+        sim_erases[( addr - ADDR_FLASH_STORE_FORWARD ) / ADDR_FLASH_PAGE_SIZE + page]++;
+    }
+    return SMTC_HAL_SUCCESS;
+}
+
+smtc_hal_status_t hal_flash_write_buffer( uint32_t addr, const uint8_t* buffer, uint32_t size )
+{
+    uint8_t* p = sim_flash_at( addr, size );
+
+    if(( addr % 4 ) || ( size % 4 ))
+    {
+        fprintf( stderr, "unaligned flash write: 0x%08x+%u\n", addr, size );
+        exit( 2 );
+    }
+    for( uint32_t i = 0; i < size; i += 4 )
+    {
+        if( sim_flash_op( ))
+        {
+            p[i] &= buffer[i];
+            p[i + 1] &= buffer[i + 1];
+            longjmp( sim_power_loss, 1 );
+        }
+        for( uint8_t b = 0; b < 4; b++ )
+        {
+            p[i + b] &= buffer[i + b];
+        }
+    }
+    return SMTC_HAL_SUCCESS;
+}
+
+void hal_flash_read_buffer( uint32_t addr, uint8_t* buffer, uint32_t size )
+{
+    memcpy( buffer, sim_flash_at( addr, size ), size );
+}
+
+static void sim_record_payload( uint32_t id, uint8_t len, uint8_t* data )
+{
+    for( uint8_t i = 0; i < len; i++ )
+    {
+        data[i] = ( i < 4 ) ? ( uint8_t )( id >> ( 8 * i )) : ( uint8_t )( id * 31 + i );
+    }
+}
+
+static void sim_append( uint32_t now_s )
+{
+    uint8_t data[CREW_STORE_RECORD_MAX_LEN];
+    uint32_t id = sim_record_count;
+    sim_record_t* rec = &sim_records[id];
+
+    if( id >= SIM_MAX_RECORDS )
+    {
+        return;
+    }
+    rec->safety = ( sim_random( ) % 4 ) == 0;
+    rec->port = rec->safety ? CREW_ALERT_APP_PORT : CREW_ROUTINE_APP_PORT;
+    rec->len = 4 + sim_random( ) % ( CREW_STORE_RECORD_MAX_LEN - 3 );
+    rec->timestamp_s = now_s;
+    sim_record_payload( id, rec->len, data );
+
+    sim_record_count++;
+    rec->state = SIM_RECORD_APPENDING;
+    if( !crew_store_append( rec->port, data, rec->len, rec->timestamp_s, rec->safety ))
+    {
+        fprintf( stderr, "append refused\n" );
+        exit( 1 );
+    }
+    rec->state = SIM_RECORD_PENDING;
+}
+
+// Decode one backlog frame, check each record and note it; returns the records found
+static uint8_t sim_check_frame( const uint8_t* frame, uint8_t len, uint32_t* ids )
+{
+    uint32_t timestamp_s = frame[0] | ( frame[1] << 8 ) | ( frame[2] << 16 ) | (( uint32_t ) frame[3] << 24 );
+    uint8_t offset = CREW_BACKLOG_HEADER_LEN;
+    uint8_t count = 0;
+    bool routine_seen = false;
+    uint32_t last_safety = 0, last_routine = 0;
+
+    while( offset < len )
+    {
+        uint8_t port = CREW_PACKED_RECORD_PORT_GET( frame[offset] );
+        uint8_t record_len = CREW_PACKED_RECORD_LEN_GET( frame[offset] );
+        uint32_t zigzag = 0;
+        uint8_t shift = 0;
+        uint8_t expected[CREW_STORE_RECORD_MAX_LEN];
+        uint32_t id;
+
+        offset++;
+        do
+        {
+            zigzag |= ( uint32_t )( frame[offset] & 0x7F ) << shift;
+            shift += 7;
+        } while( frame[offset++] & 0x80 );
+        timestamp_s += ( int32_t )(( zigzag >> 1 ) ^ -( int32_t )( zigzag & 1 ));
+
+        id = frame[offset] | ( frame[offset + 1] << 8 ) | ( frame[offset + 2] << 16 ) | (( uint32_t ) frame[offset + 3] << 24 );
+        if( id >= sim_record_count )
+        {
+            fprintf( stderr, "unknown record id %u\n", id );
+            exit( 1 );
+        }
+        sim_record_payload( id, record_len, expected );
+        if(( port != sim_records[id].port ) || ( record_len != sim_records[id].len ) ||
+           ( timestamp_s != sim_records[id].timestamp_s ) || memcmp( expected, frame + offset, record_len ))
+        {
+            fprintf( stderr, "record %u corrupted\n", id );
+            exit( 1 );
+        }
+        if( sim_records[id].safety )
+        {
+            if( routine_seen || (( count > 0 ) && ( id > last_safety )))
+            {
+                fprintf( stderr, "safety record %u out of order\n", id );
+                exit( 1 );
+            }
+            last_safety = id;
+        }
+        else
+        {
+            if( routine_seen && ( id < last_routine ))
+            {
+                fprintf( stderr, "routine record %u out of order\n", id );
+                exit( 1 );
+            }
+            routine_seen = true;
+            last_routine = id;
+        }
+        ids[count++] = id;
+        offset += record_len;
+    }
+    if( offset != len )
+    {
+        fprintf( stderr, "frame overrun\n" );
+        exit( 1 );
+    }
+    return count;
+}
+
+static void sim_drain_batch( uint8_t max_len )
+{
+    uint8_t frame[SIM_FRAME_MAX];
+    uint8_t len = crew_store_build_batch( max_len, frame );
+
+    if( len == 0 )
+    {
+        return;
+    }
+    sim_batch_count = sim_check_frame( frame, len, sim_batch_ids );
+    for( uint8_t i = 0; i < sim_batch_count; i++ )
+    {
+        if( sim_records[sim_batch_ids[i]].state != SIM_RECORD_PENDING )
+        {
+            fprintf( stderr, "record %u sent while not pending\n", sim_batch_ids[i] );
+            exit( 1 );
+        }
+        sim_records[sim_batch_ids[i]].state = SIM_RECORD_SENDING;
+    }
+    crew_store_commit_batch( );
+    for( uint8_t i = 0; i < sim_batch_count; i++ )
+    {
+        sim_records[sim_batch_ids[i]].state = SIM_RECORD_SENT;
+    }
+    sim_batch_count = 0;
+}
+
+static void sim_workload( long operations )
+{
+    uint32_t now_s = 1700000000;
+
+    for( long op = 0; op < operations; op++ )
+    {
+        now_s += 30 + sim_random( ) % 600;
+        if(( crew_store_pending( ) > SIM_PENDING_HIGH ) || ( sim_random( ) % 5 == 0 ))
+        {
+            sim_drain_batch( 51 + sim_random( ) % ( SIM_FRAME_MAX - 50 ));
+        }
+        else
+        {
+            sim_append( now_s );
+        }
+    }
+}
+
+static void sim_reset( void )
+{
+    memset( sim_flash, 0xFF, sizeof( sim_flash ));
+    memset( sim_erases, 0, sizeof( sim_erases ));
+    memset( sim_records, 0, sizeof( sim_records ));
+    sim_record_count = 0;
+    sim_batch_count = 0;
+    sim_ops = 0;
+    sim_rng = 1;
+}
+
+// After a cut: mount again, drain everything and compare with what the workload saw
+static void sim_check_recovery( long cut )
+{
+    uint8_t frame[SIM_FRAME_MAX];
+    uint32_t ids[CREW_STORE_BATCH_MAX];
+    crew_store_stats_t stats;
+
+    crew_store_init( );
+    for( uint32_t i = 0; i < sim_record_count; i++ )
+    {
+        sim_records[i].seen = false;
+    }
+
+    for( ;; )
+    {
+        uint8_t len = crew_store_build_batch( SIM_FRAME_MAX, frame );
+        uint8_t count;
+
+        if( len == 0 )
+        {
+            break;
+        }
+        count = sim_check_frame( frame, len, ids );
+        for( uint8_t i = 0; i < count; i++ )
+        {
+            sim_record_t* rec = &sim_records[ids[i]];
+
+            if( rec->seen || ( rec->state == SIM_RECORD_SENT ))
+            {
+                fprintf( stderr, "cut %ld: record %u back after being %s\n", cut, ids[i], rec->seen ? "drained" : "sent" );
+                exit( 1 );
+            }
+            rec->seen = true;
+        }
+        crew_store_commit_batch( );
+    }
+
+    for( uint32_t i = 0; i < sim_record_count; i++ )
+    {
+        if(( sim_records[i].state == SIM_RECORD_PENDING ) && !sim_records[i].seen )
+        {
+            fprintf( stderr, "cut %ld: pending record %u lost\n", cut, i );
+            exit( 1 );
+        }
+    }
+
+    crew_store_get_stats( &stats );
+    if( stats.pending != 0 || stats.dropped != 0 )
+    {
+        fprintf( stderr, "cut %ld: %u pending, %u dropped after a full drain\n", cut, stats.pending, stats.dropped );
+        exit( 1 );
+    }
+
+    // The ring must keep working after recovery
+    sim_cut_at = -1;
+    for( uint32_t i = 0; i < sim_record_count; i++ )
+    {
+        sim_records[i].state = SIM_RECORD_SENT;
+    }
+    sim_append( 1800000000 );
+    sim_drain_batch( SIM_FRAME_MAX );
+    if( crew_store_pending( ) != 0 || sim_records[sim_record_count - 1].state != SIM_RECORD_SENT )
+    {
+        fprintf( stderr, "cut %ld: ring unusable after recovery\n", cut );
+        exit( 1 );
+    }
+}
+
+// A batch committed after its page was erased and refilled must leave the newer records pending
+static void sim_check_reuse( void )
+{
+    uint8_t frame[SIM_FRAME_MAX];
+    uint16_t pending;
+
+    sim_reset( );
+    sim_cut_at = -1;
+    crew_store_init( );
+    for( uint8_t i = 0; i < 10; i++ )
+    {
+        sim_append( 1700000000 + i );
+    }
+    if( crew_store_build_batch( SIM_FRAME_MAX, frame ) == 0 )
+    {
+        fprintf( stderr, "reuse: no batch\n" );
+        exit( 1 );
+    }
+    while( sim_erases[0] < 2 )
+    {
+        sim_append( 1700001000 + sim_record_count );
+    }
+    for( uint8_t i = 0; i < 10; i++ )
+    {
+        sim_append( 1700100000 + sim_record_count );
+    }
+    pending = crew_store_pending( );
+    crew_store_commit_batch( );
+    if( crew_store_pending( ) != pending )
+    {
+        fprintf( stderr, "reuse: stale batch marked %u newer records sent\n", pending - crew_store_pending( ));
+        exit( 1 );
+    }
+}
+
+// The second copy of a double uplink must not take a slot, the same record later must
+static void sim_check_repeat( void )
+{
+    uint8_t data[CREW_STORE_RECORD_MAX_LEN];
+    crew_store_stats_t stats;
+
+    sim_reset( );
+    sim_cut_at = -1;
+    crew_store_init( );
+    sim_record_payload( 1, 20, data );
+    crew_store_append( CREW_ALERT_APP_PORT, data, 20, 1700000000, true );
+    crew_store_append( CREW_ROUTINE_APP_PORT, data, 20, 1700000001, false );
+    crew_store_append( CREW_ALERT_APP_PORT, data, 20, 1700000006, true );
+    crew_store_get_stats( &stats );
+    if( stats.pending != 2 || stats.repeats != 1 )
+    {
+        fprintf( stderr, "repeat: %u pending, %u repeats after a double uplink\n", stats.pending, stats.repeats );
+        exit( 1 );
+    }
+    crew_store_append( CREW_ALERT_APP_PORT, data, 20, 1700000060, true );
+    crew_store_get_stats( &stats );
+    if( stats.pending != 3 )
+    {
+        fprintf( stderr, "repeat: record a minute later not stored\n" );
+        exit( 1 );
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    long total_ops;
+    crew_store_stats_t stats;
+    int opt;
+
+    while(( opt = getopt( argc, argv, "n:v" )) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            sim_operations = atol( optarg );
+            break;
+        case 'v':
+            sim_verbose = true;
+            break;
+        default:
+            fprintf( stderr, "usage: %s [-n operations] [-v]\n", argv[0] );
+            return 2;
+        }
+    }
+
+    // Reference run: count the flash operations of the workload
+    sim_reset( );
+    sim_cut_at = -1;
+    crew_store_init( );
+    sim_workload( sim_operations );
+    total_ops = sim_ops;
+    crew_store_get_stats( &stats );
+    printf( "workload: %ld operations, %u records, %ld flash operations, pending %u, erases %u-%u\n",
+            sim_operations, sim_record_count, total_ops, stats.pending, stats.erase_min, stats.erase_max );
+
+    for( long cut = 0; cut < total_ops; cut++ )
+    {
+        sim_reset( );
+        sim_cut_at = cut;
+        if( setjmp( sim_power_loss ) == 0 )
+        {
+            crew_store_init( );
+            sim_workload( sim_operations );
+            fprintf( stderr, "cut %ld never reached\n", cut );
+            return 1;
+        }
+        sim_cut_at = -1;
+        sim_check_recovery( cut );
+    }
+    printf( "power loss at each of %ld flash operations: recovered\n", total_ops );
+
+    sim_check_reuse( );
+    printf( "batch committed after its page was reused: newer records kept\n" );
+
+    sim_check_repeat( );
+    printf( "double uplink copy stored once\n" );
+
+    // Wear: a long run without cuts must spread erases evenly
+    sim_reset( );
+    sim_cut_at = -1;
+    crew_store_init( );
+    sim_workload( SIM_MAX_RECORDS );
+    crew_store_get_stats( &stats );
+    printf( "wear: %u-%u erases per page, %u dropped\n", stats.erase_min, stats.erase_max, stats.dropped );
+    if( stats.erase_max - stats.erase_min > 1 || stats.dropped != 0 )
+    {
+        fprintf( stderr, "uneven wear or records dropped\n" );
+        return 1;
+    }
+
+    printf( "PASS\n" );
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*!
+ * @file      tracker_sim_replay.c
+ *
+ * @brief     Host replay of 24 h of tracker operation on the simulated HAL
+ *
+ * main_lorawan_tracker.c and the tracker modules are built unchanged with
+ * SMTC_HAL_SIM: time comes from smtc_hal_sim.c, the chips around the nRF52840
+ * from the models in sim/ (see sim/tracker_sim.h). The firmware main( ) runs
+ * as tracker_main( ) from the default configuration (ABP, EU868, BLE then
+ * GNSS positioning, 1 min uplinks); the replay ends it after 24 h of virtual
+ * time from the modem engine hook.
+ *
+ * Scenario, wearer aboard a vessel with an iBeacon:
+ *   00:00  aboard, beacon in reach, gateway in reach
+ *   06:00  away from the beacon for 2 h, positions from GNSS
+ *   12:00  overboard: beacon lost, SOS raised, drifting 1.5 kn east
+ *   12:30  recovered: beacon back, SOS cleared
+ *   16:00  out of gateway coverage for 2 h, then back
+ *
+ * The report gives the uplinks per port, time on air, GNSS and BLE activity
+ * and how the 24 h split between sleep and busy waits.
+ *
+ * From the repository root:
+ *   C=lora_basics_modem/smtc_modem_core
+ *   T=t1000_e/tracker
+ *   gcc -O2 -DAPP_TRACKER -DSMTC_HAL_SIM -DLR11XX -DLR11XX_TRANSCEIVER -DREGION_EU_868 -DRP2_103 \
+ *       -DHAL_DBG_TRACE=1 -DMODEM_HAL_DBG_TRACE=1 -Dmain=tracker_main \
+ *       -I$T/tools/sim -I$T/inc -It1000_e/peripherals/inc -It1000_e/interface -Ismtc_hal/inc -Iapps/common \
+ *       -Ilora_basics_modem/smtc_modem_api -Ilora_basics_modem/smtc_modem_hal -I$C/device_management \
+ *       -I$C/lorawan_api -I$C/lr1mac/src -I$C/lr1mac/src/lr1mac_class_b -I$C/lr1mac/src/services \
+ *       -I$C/lr1mac/src/smtc_real/src -I$C/modem_config -I$C/modem_services -I$C/radio_planner/src \
+ *       -I$C/radio_drivers/lr11xx_driver/src -I$C/smtc_modem_crypto/smtc_secure_element \
+ *       -I$C/smtc_modem_crypto/soft_secure_element -I$C/smtc_modem_services/headers -I$C/smtc_ral/src \
+ *       -I$C/smtc_ralf/src \
+ *       $T/tools/tracker_sim_replay.c $T/tools/sim/sim_modem.c $T/tools/sim/sim_lr1110.c \
+ *       $T/tools/sim/sim_ag3335.c $T/tools/sim/sim_softdevice.c $T/tools/sim/sim_board.c \
+ *       apps/examples/11_lorawan_tracker/main_lorawan_tracker.c apps/common/apps_modem_event.c \
+ *       apps/common/apps_modem_common_ex.c apps/common/apps_utilities.c apps/common/smtc_modem_api_str.c \
+ *       apps/common/remex_abp_derive.c $C/smtc_modem_crypto/soft_secure_element/aes.c \
+ *       $C/smtc_modem_crypto/soft_secure_element/cmac.c $C/lr1mac/src/services/smtc_duty_cycle.c \
+ *       smtc_hal/src/smtc_hal_sim.c smtc_hal/src/smtc_hal_mcu.c smtc_hal/src/smtc_hal_rtc.c \
+ *       smtc_hal/src/smtc_hal_lp_time.c $T/src/app_board.c $T/src/app_button.c $T/src/app_config_param.c \
+ *       $T/src/app_lora_packet.c $T/src/crew_store_forward.c $T/src/crew_uplink_packer.c \
+ *       $T/src/gateway_assistance.c $T/src/gnss_fix_predict.c $T/src/gnss_ttff_stats.c $T/src/log_filter.c \
+ *       $T/src/marine_gnss.c $T/src/mob_drift.c -lm -o tracker_sim_replay
+ *   ./tracker_sim_replay [-v]
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+
+#include "smtc_hal_mcu.h"
+#include "smtc_hal_sim.h"
+#include "smtc_hal_rtc.h"
+#include "app_user_timer.h"
+#include "app_button.h"
+#include "tracker_sim.h"
+
+// The firmware main( ) is built as tracker_main( ), this file provides the host one
+#undef main
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+#define REPLAY_HOUR_MS      3600000ULL
+#define REPLAY_END_MS       ( 24 * REPLAY_HOUR_MS )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    REPLAY_BEACON_LOST,
+    REPLAY_BEACON_BACK,
+    REPLAY_OVERBOARD,
+    REPLAY_SOS_ON,
+    REPLAY_SOS_OFF,
+    REPLAY_COVERAGE_LOST,
+    REPLAY_COVERAGE_BACK,
+} replay_action_t;
+
+typedef struct
+{
+    uint64_t        at_ms;
+    replay_action_t action;
+    const char*     name;
+} replay_step_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const replay_step_t replay_steps[] = {
+    { 6 * REPLAY_HOUR_MS, REPLAY_BEACON_LOST, "away from the beacon" },
+    { 8 * REPLAY_HOUR_MS, REPLAY_BEACON_BACK, "back at the beacon" },
+    { 12 * REPLAY_HOUR_MS, REPLAY_OVERBOARD, "overboard" },
+    { 12 * REPLAY_HOUR_MS + 5000, REPLAY_SOS_ON, "SOS raised" },
+    { 12 * REPLAY_HOUR_MS + 30 * 60000, REPLAY_BEACON_BACK, "recovered" },
+    { 12 * REPLAY_HOUR_MS + 31 * 60000, REPLAY_SOS_OFF, "SOS cleared" },
+    { 16 * REPLAY_HOUR_MS, REPLAY_COVERAGE_LOST, "out of coverage" },
+    { 18 * REPLAY_HOUR_MS, REPLAY_COVERAGE_BACK, "back in coverage" },
+};
+
+#define REPLAY_STEPS ( sizeof( replay_steps ) / sizeof( replay_steps[0] ))
+
+static jmp_buf  replay_end;
+static uint32_t replay_next_step = 0;       // Next step of the environment, applied from the step hook
+static uint32_t replay_next_firmware = 0;   // Next step of the firmware, applied in main context
+static bool     replay_verbose = false;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool replay_step_is_firmware( const replay_step_t* step )
+{
+    return ( step->action == REPLAY_SOS_ON ) || ( step->action == REPLAY_SOS_OFF );
+}
+
+/*!
+ * @brief Environment changes, applied as time passes whatever the firmware is doing
+ */
+static void replay_step_hook( uint64_t now_ms )
+{
+    while(( replay_next_step < REPLAY_STEPS ) && ( replay_steps[replay_next_step].at_ms <= now_ms ))
+    {
+        const replay_step_t* step = &replay_steps[replay_next_step++];
+
+        switch( step->action )
+        {
+        case REPLAY_BEACON_LOST:
+            sim_ble_set_beacon( false, 0 );
+            break;
+        case REPLAY_OVERBOARD:
+            sim_ble_set_beacon( false, 0 );
+            sim_gnss_set_track( 1.5f, 90.0f );
+            break;
+        case REPLAY_BEACON_BACK:
+            sim_ble_set_beacon( true, -65 );
+            sim_gnss_set_track( 0.0f, 0.0f );
+            break;
+        case REPLAY_COVERAGE_LOST:
+            sim_modem_set_coverage( false );
+            break;
+        case REPLAY_COVERAGE_BACK:
+            sim_modem_set_coverage( true );
+            break;
+        default:
+            break;
+        }
+        if( !replay_step_is_firmware( step ))
+        {
+            printf( "%02u:%02u  %s\n", ( unsigned )( step->at_ms / REPLAY_HOUR_MS ),
+                    ( unsigned )( step->at_ms / 60000 % 60 ), step->name );
+        }
+    }
+    sim_app_timer_process( now_ms );
+}
+
+/*!
+ * @brief Ends the replay from the main loop once the 24 h have passed
+ */
+static void replay_engine_hook( void )
+{
+    if( hal_sim_get_time_ms( ) >= REPLAY_END_MS )
+    {
+        longjmp( replay_end, 1 );
+    }
+}
+
+static void replay_report( double wall_s )
+{
+    sim_modem_stats_t    modem;
+    sim_gnss_stats_t     gnss;
+    sim_periph_stats_t   periph;
+    hal_sim_stats_t      hal;
+    hal_mcu_wait_stats_t wait;
+
+    sim_modem_get_stats( &modem );
+    sim_gnss_get_stats( &gnss );
+    sim_periph_get_stats( &periph );
+    hal_sim_get_stats( &hal );
+    hal_mcu_get_wait_stats( &wait );
+
+    printf( "\n24 h replayed in %.2f s\n\n", wall_s );
+    printf( "uplinks       %u (%u emergency), %llu ms on air, radio on %llu ms\n", modem.uplinks,
+            modem.emergency_uplinks, ( unsigned long long )modem.toa_ms, ( unsigned long long )modem.radio_on_ms );
+    for( int port = 0; port < 256; port++ )
+    {
+        if( modem.uplinks_by_port[port] != 0 )
+        {
+            printf( "  port %3d    %u\n", port, modem.uplinks_by_port[port] );
+        }
+    }
+    printf( "link checks   %u (%u unanswered)\n", modem.link_checks, modem.link_checks_lost );
+    printf( "duty cycle    %u frames held back, %u requests refused busy\n", modem.duty_cycle_waits,
+            modem.busy_refusals );
+    printf( "alarms        %u\n", modem.alarms );
+    printf( "GNSS          %u power-ons, %llu s on, %u fixes, %u without fix\n", gnss.power_ons,
+            ( unsigned long long )( gnss.on_ms / 1000 ), gnss.fixes, gnss.no_fix );
+    printf( "BLE scans     %u, %llu s scanning, beacon found %u times\n", periph.ble_scans,
+            ( unsigned long long )( periph.ble_scan_ms / 1000 ), periph.ble_found );
+    printf( "Wi-Fi scans   %u\n", periph.wifi_scans );
+    printf( "flash         %u page erases, %u writes, %u FDS writes\n", periph.flash_erases, periph.flash_writes,
+            periph.fds_writes );
+    printf( "sleep         %llu s in %u sleeps (%u cut short), %llu s in waits (%llu s of it asleep)\n",
+            ( unsigned long long )( hal.sleep_ms / 1000 ), hal.sleep_count, hal.sleep_breaks,
+            ( unsigned long long )( hal.busy_ms / 1000 ), ( unsigned long long )( hal.wait_sleep_ms / 1000 ));
+    printf( "waits         %u sleeping, %u spinning (%u ms)\n", wait.sleep_waits, wait.busy_waits, wait.busy_ms );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- APP USER TIMER (app_user_timer.c) ---------------------------------------
+ */
+
+void app_user_timers_init( void )
+{
+}
+
+/*!
+ * @brief Button work of the main loop, where the scripted SOS presses land
+ */
+void app_user_run_process( void )
+{
+    uint64_t now = hal_sim_get_time_ms( );
+
+    while( replay_next_firmware < REPLAY_STEPS )
+    {
+        const replay_step_t* step = &replay_steps[replay_next_firmware];
+
+        if( !replay_step_is_firmware( step ))
+        {
+            replay_next_firmware++;
+            continue;
+        }
+        if( step->at_ms > now )
+        {
+            break;
+        }
+        replay_next_firmware++;
+        printf( "%02u:%02u  %s\n", ( unsigned )( step->at_ms / REPLAY_HOUR_MS ),
+                ( unsigned )( step->at_ms / 60000 % 60 ), step->name );
+        if( step->action == REPLAY_SOS_ON )
+        {
+            app_sos_continuous_toggle_on( );
+        }
+        else
+        {
+            app_sos_continuous_toggle_off( );
+        }
+    }
+    app_user_button_det( );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- MAIN --------------------------------------------------------------------
+ */
+
+int tracker_main( void );
+
+int main( int argc, char** argv )
+{
+    clock_t start = clock( );
+
+    replay_verbose = ( argc > 1 ) && ( strcmp( argv[1], "-v" ) == 0 );
+    sim_board_set_verbose( replay_verbose );
+    sim_ble_set_beacon( true, -65 );
+    sim_gnss_set_open_sky( true );
+    sim_modem_set_coverage( true );
+    hal_sim_set_step_hook( replay_step_hook );
+    sim_modem_set_engine_hook( replay_engine_hook );
+
+    printf( "00:00  aboard\n" );
+    if( setjmp( replay_end ) == 0 )
+    {
+        tracker_main( );
+    }
+
+    replay_report(( double )( clock( ) - start ) / CLOCKS_PER_SEC );
+    return 0;
+}
+
+/* --- EOF ------------------------------------------------------------------ */